@@ -0,0 +1,193 @@
+/* Equal-time quality comparison of the two SSAO engines on the skull scene of Benchmark, headless on the
+ * software backend:
+ *   g++ -O2 -std=c++17 AoQualityBenchmark.cpp Gtao.cpp DepthPyramid.cpp SoftwareRenderer.cpp MeshData.cpp
+ *       Culling.cpp Mat4.cpp Timer.cpp -o AoQualityBenchmark
+ *   ./AoQualityBenchmark [--model models/skull.txt] [--width 640] [--height 360]
+ *
+ * The hemisphere kernel at every sample count up to SSAO_SAMPLE_COUNT and every GTAO preset are timed and
+ * compared against what their engine converges to: the hemisphere kernel averaged over many seeds of its offsets
+ * and random vectors, and GTAO with far more slices and steps than any preset. References and timed runs read
+ * the depth pyramid alike. The error is what a frame pays for its sample count, noise and bias together, so it
+ * is the number to compare at equal time: every preset is paired with the hemisphere sample count whose time is
+ * nearest to its own. The two engines estimate different integrals, so their mean accessibility is printed as
+ * well but their references are not compared to each other. Times are the software backend's, the gpu's ratio
+ * between the engines will differ.
+ * The exit code is 1 if any accessibility is outside [0, 1] or more GTAO samples do not lower the error.
+ */
+
+#include "Gtao.h"
+#include "Mat4.h"
+#include "MeshData.h"
+#include "SoftwareRenderer.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t AO_SCENE_FRAMES = {2};
+static constexpr uint32_t AO_TIMED_ITERATIONS = {3}; // Fastest of these counts.
+static constexpr uint32_t AO_HEMISPHERE_REFERENCE_SEEDS = {32};
+static constexpr uint32_t AO_GTAO_REFERENCE_SLICES = {32};
+static constexpr uint32_t AO_GTAO_REFERENCE_STEPS = {16};
+// NOTE(pf): The hemisphere kernel with 1 to SSAO_SAMPLE_COUNT samples, then the GTAO presets.
+static constexpr uint32_t AO_HEMISPHERE_CONFIGS = {SSAO_SAMPLE_COUNT};
+static constexpr uint32_t AO_CONFIG_COUNT = {AO_HEMISPHERE_CONFIGS + GTAO_QUALITY_COUNT};
+
+struct AoResult {
+    double ms = 0.0;
+    double squaredError = 0.0;
+    double accessibility = 0.0;
+    bool   outOfRange = false;
+};
+
+static void BuildScene(double time, uint32_t width, uint32_t height, Mat4 &world, Mat4 &view, Mat4 &proj) {
+    float angle = ConvertToRadians(fmodf((float)(time * 90.0), 360.0f));
+    world = Mat4RotationAxis(0.0f, 1.0f, 1.0f, angle);
+
+    const float eye[3] = {0.0f, 5.0f, -25.0f};
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    view = Mat4LookAtLH(eye, focus, up);
+    proj = Mat4PerspectiveFovLH(ConvertToRadians(45.0f), width / (float)height, 1.0f, 1000.0f);
+}
+
+static bool IsHemisphere(uint32_t config) {
+    return config < AO_HEMISPHERE_CONFIGS;
+}
+
+static void ApplyConfig(SoftwareRenderer &renderer, uint32_t config) {
+    if (IsHemisphere(config)) {
+        renderer.ssaoSettings.engine = SSAO_ENGINE_HEMISPHERE;
+        renderer.ssaoSettings.sampleCount = config + 1;
+        return;
+    }
+    renderer.ssaoSettings.engine = SSAO_ENGINE_GTAO;
+    renderer.ssaoSettings.gtao.sliceCount = GTAO_PRESETS[config - AO_HEMISPHERE_CONFIGS].sliceCount;
+    renderer.ssaoSettings.gtao.stepCount = GTAO_PRESETS[config - AO_HEMISPHERE_CONFIGS].stepCount;
+}
+
+static const char *ConfigName(uint32_t config) {
+    return IsHemisphere(config) ? "hemisphere" : GTAO_PRESETS[config - AO_HEMISPHERE_CONFIGS].name;
+}
+
+// NOTE(pf): Taps per pixel, reads of the pixel's own depth and normal not included.
+static uint32_t ConfigTaps(uint32_t config) {
+    if (IsHemisphere(config))
+        return config + 1;
+    const GtaoPreset &preset = GTAO_PRESETS[config - AO_HEMISPHERE_CONFIGS];
+    return 2 * preset.sliceCount * preset.stepCount;
+}
+
+int main(int argc, char **argv) {
+    const char *modelPath = "models/skull.txt";
+    uint32_t    width = 640, height = 360;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+        else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+            width = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc)
+            height = (uint32_t)atoi(argv[++i]);
+    }
+
+    MeshData mesh;
+    if (!LoadTextMesh(modelPath, mesh) || width == 0 || height == 0) {
+        fprintf(stderr, "Failed to load %s\n", modelPath);
+        return 1;
+    }
+
+    SoftwareRenderer renderer, referenceRenderer;
+    renderer.Initialize(width, height);
+    AoResult           results[AO_CONFIG_COUNT];
+    std::vector<float> reference[2]; // Hemisphere and GTAO.
+    double             coveredPixels = 0.0;
+    for (uint32_t frame = 0; frame < AO_SCENE_FRAMES; ++frame) {
+        Mat4 world, view, proj;
+        BuildScene(frame * 0.25, width, height, world, view, proj);
+        renderer.BeginFrame();
+        renderer.DrawMeshInstances(mesh, &world, 1, view, proj);
+        for (float d : renderer.depth)
+            coveredPixels += d < 1.0f;
+
+        // .. what each engine converges to, the hemisphere kernel needs its offsets reseeded to get there ..
+        reference[0].assign((size_t)width * height, 0.0f);
+        for (uint32_t seed = 0; seed < AO_HEMISPHERE_REFERENCE_SEEDS; ++seed) {
+            referenceRenderer.Initialize(width, height, 1000 + seed);
+            referenceRenderer.BeginFrame();
+            referenceRenderer.DrawMeshInstances(mesh, &world, 1, view, proj);
+            referenceRenderer.ComputeSsao(proj);
+            for (size_t i = 0; i < reference[0].size(); ++i)
+                reference[0][i] += referenceRenderer.ambient[i] / AO_HEMISPHERE_REFERENCE_SEEDS;
+        }
+        referenceRenderer.ssaoSettings.engine = SSAO_ENGINE_GTAO;
+        referenceRenderer.ssaoSettings.gtao.sliceCount = AO_GTAO_REFERENCE_SLICES;
+        referenceRenderer.ssaoSettings.gtao.stepCount = AO_GTAO_REFERENCE_STEPS;
+        referenceRenderer.ComputeSsao(proj);
+        reference[1] = referenceRenderer.ambient;
+        referenceRenderer.ssaoSettings.engine = SSAO_ENGINE_HEMISPHERE;
+
+        for (uint32_t config = 0; config < AO_CONFIG_COUNT; ++config) {
+            AoResult &result = results[config];
+            ApplyConfig(renderer, config);
+            double bestMs = 0.0;
+            for (uint32_t i = 0; i < AO_TIMED_ITERATIONS; ++i) {
+                int64_t start = HiResPerformanceQuery();
+                renderer.ComputeSsao(proj);
+                double ms = HiResMilliseconds(HiResPerformanceQuery() - start);
+                bestMs = (i == 0 || ms < bestMs) ? ms : bestMs;
+            }
+            result.ms += bestMs / AO_SCENE_FRAMES;
+
+            const std::vector<float> &expected = reference[IsHemisphere(config) ? 0 : 1];
+            for (size_t i = 0; i < expected.size(); ++i) {
+                if (renderer.depth[i] >= 1.0f)
+                    continue;
+                float value = renderer.ambient[i];
+                result.outOfRange |= !(value >= 0.0f && value <= 1.0f);
+                result.squaredError += ((double)value - expected[i]) * ((double)value - expected[i]);
+                result.accessibility += value;
+            }
+        }
+    }
+
+    // NOTE(pf): Errors and means are over the pixels the skull covers, the cleared background is unoccluded for both.
+    double pixels = coveredPixels > 0.0 ? coveredPixels : 1.0;
+    bool   outOfRange = false;
+    printf("{\"benchmark\": \"ao_quality\", \"width\": %u, \"height\": %u, \"frames\": %u, \"covered_pixels\": %.0f,\n"
+           "  \"engines\": [",
+           width, height, AO_SCENE_FRAMES, coveredPixels);
+    for (uint32_t config = 0; config < AO_CONFIG_COUNT; ++config) {
+        const AoResult &result = results[config];
+        outOfRange |= result.outOfRange;
+        printf("%s\n    {\"engine\": \"%s\", \"preset\": \"%s\", \"taps_per_pixel\": %u, \"ms\": %.3f, \"rmse\": %.5f, "
+               "\"mean_accessibility\": %.4f}",
+               config == 0 ? "" : ",", IsHemisphere(config) ? "hemisphere" : "gtao", ConfigName(config), ConfigTaps(config),
+               result.ms, sqrt(result.squaredError / pixels), result.accessibility / pixels);
+    }
+    printf("\n  ]");
+
+    // .. every preset against the hemisphere sample count that takes the nearest time ..
+    printf(",\n  \"equal_time\": [");
+    for (uint32_t config = AO_HEMISPHERE_CONFIGS; config < AO_CONFIG_COUNT; ++config) {
+        uint32_t matched = 0;
+        for (uint32_t hemisphere = 1; hemisphere < AO_HEMISPHERE_CONFIGS; ++hemisphere) {
+            if (fabs(results[hemisphere].ms - results[config].ms) < fabs(results[matched].ms - results[config].ms))
+                matched = hemisphere;
+        }
+        printf("%s\n    {\"gtao_preset\": \"%s\", \"gtao_ms\": %.3f, \"gtao_rmse\": %.5f, \"hemisphere_samples\": %u, "
+               "\"hemisphere_ms\": %.3f, \"hemisphere_rmse\": %.5f}",
+               config == AO_HEMISPHERE_CONFIGS ? "" : ",", ConfigName(config), results[config].ms,
+               sqrt(results[config].squaredError / pixels), ConfigTaps(matched), results[matched].ms,
+               sqrt(results[matched].squaredError / pixels));
+    }
+    printf("\n  ]\n}\n");
+
+    bool converges = results[AO_CONFIG_COUNT - 1].squaredError < results[AO_HEMISPHERE_CONFIGS].squaredError;
+    if (outOfRange || !converges) {
+        fprintf(stderr, "%s\n", outOfRange ? "Accessibility outside [0, 1]" : "GTAO's error does not drop with more samples");
+        return 1;
+    }
+    return 0;
+}
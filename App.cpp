@@ -1,11 +1,14 @@
 #include "App.h"
 #include "Input.h"
+#include "Platform.h"
+#include "Profiler.h"
+#include <cmath>
+#include <string.h>
 const float Pi = 3.1415926535f;
 
 using namespace DirectX;
 
 App::App(const HWND &hwnd, uint32_t wWidth, uint32_t wHeight) : dx12(hwnd, wWidth, wHeight),
-                                                                modelMatrix(XMMatrixIdentity()),
                                                                 viewMatrix(XMMatrixIdentity()),
                                                                 projectionMatrix(XMMatrixIdentity()) {
 }
@@ -16,36 +19,221 @@ App::~App() {
 void App::Init() {
     dx12.Initialize();
     //dx12.LoadContent();
+    taskPool.Initialize();
+
+    // NOTE(pf): Every skull spins the same way, laid out on a grid in the xz plane around the origin.
+    float gridOffset = 0.5f * (instanceGridSize - 1) * instanceSpacing;
+    for (uint32_t i = 0; i < instanceCount; ++i) {
+        int         x = (int)i % instanceGridSize;
+        int         z = (int)i / instanceGridSize;
+        SceneEntity cell = scene.CreateEntity(SCENE_NO_ENTITY, Mat4Translation(x * instanceSpacing - gridOffset, 0.0f,
+                                                                               z * instanceSpacing - gridOffset));
+        skullEntities.push_back(scene.CreateEntity(cell, Mat4Identity(), DX12_MESH_SKULL));
+    }
+    SetLightCount(lightCount);
+}
+
+void App::SetInstanceCount(uint32_t count) {
+    instanceCount = count < 1 ? 1 : count < MAX_MESH_INSTANCES ? count : MAX_MESH_INSTANCES;
+    instanceGridSize = 1;
+    while ((uint32_t)(instanceGridSize * instanceGridSize) < instanceCount)
+        ++instanceGridSize;
+}
+
+void App::SetMemoryBudget(uint32_t localMb, uint32_t cpuMb) {
+    dx12.memoryBudget.settings.budgets[MEMORY_SEGMENT_LOCAL] = (uint64_t)localMb * 1024 * 1024;
+    dx12.memoryBudget.settings.budgets[MEMORY_SEGMENT_CPU] = (uint64_t)cpuMb * 1024 * 1024;
+}
+
+void App::SetLightCount(uint32_t count) {
+    lightCount = count < LIGHT_CULL_MAX_LIGHTS ? count : LIGHT_CULL_MAX_LIGHTS;
+
+    // NOTE(pf): Same seed every run, so captures and gpu timings compare between runs.
+    uint32_t state = 1;
+    auto     random = [&state](float low, float high) {
+        state = state * 1664525u + 1013904223u;
+        return low + (high - low) * ((state >> 8) * (1.0f / 16777216.0f));
+    };
+    float halfSize = 0.5f * instanceGridSize * instanceSpacing;
+    dx12.sceneLights.resize(lightCount);
+    for (PointLight &light : dx12.sceneLights) {
+        light.position[0] = random(-halfSize, halfSize);
+        light.position[1] = random(-4.0f, 6.0f);
+        light.position[2] = random(-halfSize, halfSize);
+        light.radius = random(1.0f, 4.0f);
+        light.color[0] = random(0.2f, 1.0f);
+        light.color[1] = random(0.2f, 1.0f);
+        light.color[2] = random(0.2f, 1.0f);
+        light.intensity = random(2.0f, 6.0f);
+    }
+}
+
+bool App::Step(double dt, int64_t inputTicks) {
+    PROFILE_FUNCTION();
+    previousState = currentState;
+    return Simulate(currentState, dt, inputTicks);
+}
+
+void App::Render(double alpha) {
+    PROFILE_FUNCTION();
+    RenderState(previousState, currentState, alpha);
 }
 
-bool App::Update(double dt, double totalTime) {
+bool App::Simulate(SimulationState &state, double dt, int64_t inputTicks) {
 
     // INPUT:
-    if (Input::Instance->KeyDown(KEY_ESCAPE)) {
+    input.Update(inputTicks);
+    if (input.KeyDown(KEY_ESCAPE)) {
         return false;
     }
 
     // LOGIC:
-    
-    float angle = totalTime * 90.0;
-    const XMVECTOR rotationAxis = XMVectorSet(0, 1, 1, 0);
+    state.time += dt;
+    state.skullAngle = fmodf(state.skullAngle + (float)(dt * 90.0), 360.0f);
+
+    return true;
+}
 
-    modelMatrix = XMMatrixRotationAxis(rotationAxis, XMConvertToRadians(angle));
+#if defined(_DEBUG)
+// NOTE(pf): Mat4 promises DirectXMath's bits for the matrices the renderer builds, checked once per debug run.
+static void CheckPortableMath(const Mat4 &model, float angle, float fov, float aspectRatio, float nearPlane,
+                              float farPlane, XMMATRIX view, XMMATRIX projection) {
+    static bool checked = false;
+    if (checked)
+        return;
+    checked = true;
+
+    const float eye[3] = {0, 5, -25}, focus[3] = {0, 0, 0}, up[3] = {0, 1, 0};
+    Mat4        actual[3] = {model, Mat4LookAtLH(eye, focus, up),
+                             Mat4PerspectiveFovLH(ConvertToRadians(fov), aspectRatio, nearPlane, farPlane)};
+    XMFLOAT4X4  expected[3];
+    XMStoreFloat4x4(&expected[0], XMMatrixRotationAxis(XMVectorSet(0, 1, 1, 0), XMConvertToRadians(angle)));
+    XMStoreFloat4x4(&expected[1], view);
+    XMStoreFloat4x4(&expected[2], projection);
+    bool matches = memcmp(actual, expected, sizeof(expected)) == 0;
+    if (!matches)
+        OutputDebugStringA("Mat4 differs from DirectXMath, run MathBenchmark.\n");
+    assert(matches && "Mat4 differs from DirectXMath.");
+}
+#endif
+
+void App::RenderState(const SimulationState &previous, const SimulationState &current, double alpha) {
+
+    // NOTE(pf): Interpolate between the last two simulation steps, the angle wraps so take the short way around.
+    float angleDelta = current.skullAngle - previous.skullAngle;
+    if (angleDelta < -180.0f)
+        angleDelta += 360.0f;
+    float angle = previous.skullAngle + angleDelta * (float)alpha;
+    Mat4 model = Mat4RotationAxis(0.0f, 1.0f, 1.0f, ConvertToRadians(angle));
+    for (SceneEntity skull : skullEntities) {
+        scene.SetLocal(skull, model);
+    }
+    scene.UpdateWorlds(&taskPool);
+    scene.ExtractDrawList(drawList);
 
     const XMVECTOR eyePos = XMVectorSet(0, 5, -25, 1);
     const XMVECTOR focusPos = XMVectorSet(0, 0, 0, 1);
     CONST XMVECTOR upDir = XMVectorSet(0, 1, 0, 0);
     viewMatrix = XMMatrixLookAtLH(eyePos, focusPos, upDir);
     float aspectRatio = dx12.windowWidth / (float)dx12.windowHeight;
-    float locfov = 0.25f * Pi;
     float calcfov = XMConvertToRadians(fov);
-    projectionMatrix = XMMatrixPerspectiveFovLH(locfov, aspectRatio, nearPlane, farPlane);
+    projectionMatrix = XMMatrixPerspectiveFovLH(calcfov, aspectRatio, nearPlane, farPlane);
+#if defined(_DEBUG)
+    CheckPortableMath(model, angle, fov, aspectRatio, nearPlane, farPlane, viewMatrix, projectionMatrix);
+#endif
 
-    dx12.UpdateAndRender(modelMatrix, viewMatrix, projectionMatrix);
+    // NOTE(pf): Instances are culled against the frustum and pick their LOD from the projection's fov.
+    dx12.UpdateAndRender(drawList, viewMatrix, projectionMatrix);
+}
 
-    return true;
+void App::StartSimulationThread(const FrameClock &clock, double fixedStep) {
+    renderClock = clock;
+    fixedStepTicks = (int64_t)(fixedStep * clock.frequency + 0.5);
+    fixedStepTicks = fixedStepTicks > 0 ? fixedStepTicks : 1;
+    renderSnapshot.previous = currentState;
+    renderSnapshot.current = currentState;
+    renderSnapshot.ticks = clock.Now();
+    simulationRunning.store(true, std::memory_order_release);
+    simulationThread = std::thread(&App::SimulationThread, this, clock, fixedStep);
+}
+
+void App::StopSimulationThread() {
+    simulationRunning.store(false, std::memory_order_release);
+    if (simulationThread.joinable())
+        simulationThread.join();
+}
+
+bool App::IsSimulationRunning() const {
+    return simulationRunning.load(std::memory_order_acquire);
+}
+
+void App::SimulationThread(FrameClock clock, double fixedStep) {
+    ProfilerSetThreadName("Simulation");
+    PlatformSetThreadName("Simulation");
+    FixedStepLoop loop;
+    loop.Initialize(clock, fixedStep);
+    SimulationState previous = renderSnapshot.previous;
+    SimulationState current = renderSnapshot.current;
+
+    while (simulationRunning.load(std::memory_order_acquire)) {
+        int steps = loop.BeginFrame();
+        for (int i = 0; i < steps; ++i) {
+            PROFILE_ZONE("Simulate");
+            previous = current;
+            if (!Simulate(current, loop.fixedStep, loop.StepEndTicks(i, steps)))
+                simulationRunning.store(false, std::memory_order_release);
+        }
+
+        if (steps > 0) {
+            SimulationSnapshot &snapshot = simulationSnapshots.Back();
+            snapshot.previous = previous;
+            snapshot.current = current;
+            snapshot.ticks = loop.lastTicks - loop.accumulatorTicks;
+            simulationSnapshots.Publish();
+        }
+
+        // NOTE(pf): Sleep until the next step is due instead of spinning.
+        double untilNextStep = (loop.fixedStepTicks - loop.accumulatorTicks) / (double)clock.frequency;
+        std::this_thread::sleep_for(std::chrono::duration<double>(untilNextStep));
+    }
+}
+
+void App::PushInput(const PlatformWindowEvent &event) {
+    switch (event.type) {
+    case PLATFORM_WINDOW_EVENT_KEY: {
+        input.PushKey(event.ticks, event.keyCode, event.isDown);
+    } break;
+    case PLATFORM_WINDOW_EVENT_MOUSE_MOVE: {
+        input.PushMouseMove(event.ticks, event.x, event.y);
+    } break;
+    case PLATFORM_WINDOW_EVENT_MOUSE_WHEEL: {
+        input.PushMouseWheel(event.ticks, event.y);
+    } break;
+    default:
+        break;
+    }
+}
+
+void App::RenderLatest() {
+    PROFILE_FUNCTION();
+    if (simulationSnapshots.Acquire())
+        renderSnapshot = simulationSnapshots.Front();
+
+    // NOTE(pf): The renderer runs one step behind the simulation, alpha is how far into the next step we are.
+    double alpha = (renderClock.Now() - renderSnapshot.ticks) / (double)fixedStepTicks;
+    RenderState(renderSnapshot.previous, renderSnapshot.current, Clamp((float)alpha, 0.0f, 1.0f));
 }
 
 void App::CleanUp() {
+    taskPool.CleanUp();
     dx12.CleanUp();
 }
+
+void App::CaptureNextFrame() {
+    dx12.commandCapture = &commandCapture;
+    dx12.captureNextFrame = true;
+}
+
+bool App::WriteCommandCapture(const char *path) const {
+    return commandCapture.commandCount > 0 && commandCapture.WriteToFile(path);
+}
@@ -2,6 +2,26 @@
 #define _APP_H_
 
 #include "DX12.h"
+#include "FrameLoop.h"
+#include "Input.h"
+#include "Platform.h"
+#include "Scene.h"
+#include "TaskPool.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// NOTE(pf): Everything the renderer needs to interpolate between two simulation steps.
+struct SimulationState {
+    double time;
+    float  skullAngle;
+};
+
+struct SimulationSnapshot {
+    SimulationState previous;
+    SimulationState current;
+    int64_t         ticks; // Clock time at which current became the newest state.
+};
 
 class App {
   public:
@@ -9,19 +29,89 @@ class App {
     ~App();
 
     void Init();
-    bool Update(double dt, double totalTime);
+    // NOTE(pf): Advances the simulation by one fixed step, returns false when the app should quit. The step sees
+    // the input queued up to inputTicks, see FixedStepLoop::StepEndTicks.
+    bool Step(double dt, int64_t inputTicks);
+    void Render(double alpha);
     void CleanUp();
 
+    // NOTE(pf): Threaded mode, the simulation runs its own fixed step loop and publishes snapshots
+    // that the render thread picks up in RenderLatest.
+    void StartSimulationThread(const FrameClock &clock, double fixedStep);
+    void StopSimulationThread();
+    bool IsSimulationRunning() const;
+    void RenderLatest();
+
+    // NOTE(pf): Called from the thread that pumps window events only, whichever thread steps the simulation
+    // drains them.
+    void PushInput(const PlatformWindowEvent &event);
+
+    // NOTE(pf): Gpu time of the newest completed frame and how long the last Present and fence wait took.
+    double GpuFrameMs() const { return dx12.gpuFrameMs; }
+    double PresentWaitMs() const { return dx12.presentWaitMs; }
+    // NOTE(pf): Dynamic resolution is on by default, see DynamicResolution.h.
+    void   SetDynamicResolution(bool enabled) { dx12.dynamicResolutionEnabled = enabled; }
+    float  RenderScale() const { return (float)dx12.renderWidth / dx12.windowWidth; }
+    // NOTE(pf): Hemisphere SSAO by default, the quality only applies to GTAO. Picked up by the next frame.
+    void   SetSsaoEngine(SSAO_ENGINE engine, GTAO_QUALITY quality) {
+        dx12.ssaoEngine = engine;
+        dx12.gtaoQuality = quality;
+    }
+    // NOTE(pf): Before Init only, the normal pass, its target and the SSAO shaders are built for it.
+    void   SetSsaoNormalSource(SSAO_NORMAL_SOURCE source) { dx12.ssaoNormalSource = source; }
+    // NOTE(pf): Before Init only. Skulls on a square grid, 1 to MAX_MESH_INSTANCES.
+    void   SetInstanceCount(uint32_t count);
+    // NOTE(pf): Point lights scattered over the skull grid, 0 shows the ambient map alone. See LightCulling.h.
+    void   SetLightCount(uint32_t count);
+    // NOTE(pf): In MB, 0 leaves a segment to what the OS grants, see MemoryBudget.h.
+    void   SetMemoryBudget(uint32_t localMb, uint32_t cpuMb);
+    const MemoryBudgetStats &MemoryStats() const { return dx12.memoryBudget.stats; }
+    // NOTE(pf): Rebuilds pipelines and meshes as their files under shaders/ and models/ change, see HotReload.h.
+    void   SetHotReload(bool enabled) {
+        if (enabled)
+            dx12.EnableHotReload();
+    }
+
+    // NOTE(pf): Records the next rendered frame as a command stream, see CommandStreamTool for inspecting it.
+    void CaptureNextFrame();
+    bool WriteCommandCapture(const char *path) const;
+
   private:
-    DX12 dx12;
+    bool Simulate(SimulationState &state, double dt, int64_t inputTicks);
+    void RenderState(const SimulationState &previous, const SimulationState &current, double alpha);
+    void SimulationThread(FrameClock clock, double fixedStep);
+
+    DX12                    dx12;
+    GfxRecordingCommandList commandCapture;
 
-    DirectX::XMMATRIX modelMatrix;
     DirectX::XMMATRIX viewMatrix;
     DirectX::XMMATRIX projectionMatrix;
 
+    // NOTE(pf): A root per grid cell holds the cell's translation, the spinning skull is its child.
+    Scene                    scene;
+    SceneDrawList            drawList;
+    TaskPool                 taskPool;
+    std::vector<SceneEntity> skullEntities;
+    uint32_t                 instanceCount = {1};
+    int                      instanceGridSize = {1}; // Skulls per side, the last row may be partial.
+    float                    instanceSpacing = {12.0f};
+    uint32_t                 lightCount = {1024};
+
     float fov = {45.0f};
     float nearPlane = {1.0f};
     float farPlane = {1000.0f};
+
+    Input input;
+
+    SimulationState previousState = {};
+    SimulationState currentState = {};
+
+    std::thread                      simulationThread;
+    std::atomic<bool>                simulationRunning = {false};
+    TripleBuffer<SimulationSnapshot> simulationSnapshots;
+    SimulationSnapshot               renderSnapshot = {};
+    FrameClock                       renderClock;
+    int64_t                          fixedStepTicks = {1};
 };
 
 #endif //!_APP_H_
@@ -0,0 +1,410 @@
+#include "AssetArchive.h"
+#include "MeshCodec.h"
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+static constexpr uint32_t LZ_MIN_MATCH = {4};
+static constexpr uint32_t LZ_LAST_LITERALS = {5}; // A block always ends in literals,
+static constexpr uint32_t LZ_MATCH_LIMIT = {12};  // and no match starts this close to its end.
+static constexpr uint32_t LZ_MAX_OFFSET = {65535};
+static constexpr uint32_t LZ_HASH_LOG2 = {14};
+static constexpr uint32_t LZ_SKIP_LOG2 = {6}; // Every 64 misses in a row the search steps one byte further.
+static constexpr uint32_t ASSET_BLOCK_ALIGNMENT = {16};
+
+static_assert(sizeof(AssetArchiveHeader) == 40 && sizeof(AssetEntry) == 32 && sizeof(AssetBlock) == 16,
+              "The archive is read in place, the tables must not have padding.");
+
+uint64_t AssetNameHash(const char *name) {
+    // .. FNV-1a ..
+    uint64_t hash = 14695981039346656037ull;
+    for (const uint8_t *c = (const uint8_t *)name; *c; ++c)
+        hash = (hash ^ *c) * 1099511628211ull;
+    return hash;
+}
+
+std::string NormalizeAssetName(const char *path) {
+    std::string result = path;
+    std::replace(result.begin(), result.end(), '\\', '/');
+    while (result.compare(0, 2, "./") == 0)
+        result.erase(0, 2);
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Compression
+
+static uint32_t Load32(const uint8_t *p) {
+    uint32_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+static uint8_t *WriteLength(uint8_t *out, size_t length) {
+    for (; length >= 255; length -= 255)
+        *out++ = 255;
+    *out++ = (uint8_t)length;
+    return out;
+}
+
+static uint8_t *WriteSequence(uint8_t *out, uint8_t *outEnd, const uint8_t *literals, size_t literalCount,
+                              uint32_t offset, size_t matchLength) {
+    size_t extra = matchLength ? 2 + (matchLength - LZ_MIN_MATCH) / 255 + 1 : 0;
+    if ((size_t)(outEnd - out) < 1 + literalCount / 255 + 1 + literalCount + extra)
+        return nullptr;
+
+    size_t   matchCode = matchLength ? matchLength - LZ_MIN_MATCH : 0;
+    uint8_t *token = out++;
+    *token = (uint8_t)((std::min(literalCount, (size_t)15) << 4) | std::min(matchCode, (size_t)15));
+    if (literalCount >= 15)
+        out = WriteLength(out, literalCount - 15);
+    memcpy(out, literals, literalCount);
+    out += literalCount;
+    if (matchLength) {
+        *out++ = (uint8_t)offset;
+        *out++ = (uint8_t)(offset >> 8);
+        if (matchCode >= 15)
+            out = WriteLength(out, matchCode - 15);
+    }
+    return out;
+}
+
+size_t AssetCompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstCapacity) {
+    uint32_t table[1u << LZ_HASH_LOG2];
+    memset(table, 0xff, sizeof(table));
+
+    uint8_t     *out = dst;
+    uint8_t     *outEnd = dst + dstCapacity;
+    size_t       anchor = 0;
+    size_t       pos = 0;
+    const size_t limit = srcSize > LZ_MATCH_LIMIT ? srcSize - LZ_MATCH_LIMIT : 0;
+    while (pos < limit) {
+        uint32_t sequence = Load32(src + pos);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_LOG2);
+        uint32_t candidate = table[hash];
+        table[hash] = (uint32_t)pos;
+        if (candidate == 0xffffffffu || pos - candidate > LZ_MAX_OFFSET || Load32(src + candidate) != sequence) {
+            pos += 1 + ((pos - anchor) >> LZ_SKIP_LOG2);
+            continue;
+        }
+
+        size_t length = LZ_MIN_MATCH;
+        size_t maxLength = srcSize - LZ_LAST_LITERALS - pos;
+        while (length < maxLength && src[candidate + length] == src[pos + length])
+            length++;
+        out = WriteSequence(out, outEnd, src + anchor, pos - anchor, (uint32_t)(pos - candidate), length);
+        if (!out)
+            return 0;
+        pos += length;
+        anchor = pos;
+    }
+
+    out = WriteSequence(out, outEnd, src + anchor, srcSize - anchor, 0, 0);
+    return out ? (size_t)(out - dst) : 0;
+}
+
+static bool ReadLength(const uint8_t *&in, const uint8_t *inEnd, size_t &length) {
+    uint8_t next;
+    do {
+        if (in == inEnd)
+            return false;
+        next = *in++;
+        length += next;
+    } while (next == 255);
+    return true;
+}
+
+bool AssetDecompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize) {
+    const uint8_t *in = src;
+    const uint8_t *inEnd = src + srcSize;
+    uint8_t       *out = dst;
+    uint8_t       *outEnd = dst + dstSize;
+    while (in < inEnd) {
+        uint8_t token = *in++;
+        size_t  literals = token >> 4;
+        if (literals == 15 && !ReadLength(in, inEnd, literals))
+            return false;
+        if (literals > (size_t)(inEnd - in) || literals > (size_t)(outEnd - out))
+            return false;
+        // NOTE(pf): Short runs are copied 16 bytes at a time where both sides have room, it writes past the run
+        // into what the next sequence overwrites.
+        if (literals <= 16 && inEnd - in >= 16 && outEnd - out >= 16)
+            memcpy(out, in, 16);
+        else
+            memcpy(out, in, literals);
+        in += literals;
+        out += literals;
+        if (in == inEnd)
+            break;
+
+        if (inEnd - in < 2)
+            return false;
+        size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !ReadLength(in, inEnd, length))
+            return false;
+        length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(out - dst) || length > (size_t)(outEnd - out))
+            return false;
+
+        // NOTE(pf): A match closer than its length repeats itself, it has to be copied in order.
+        const uint8_t *match = out - offset;
+        if (offset >= 16 && length <= 16 && outEnd - out >= 16) {
+            memcpy(out, match, 16);
+        } else if (offset >= length) {
+            memcpy(out, match, length);
+        } else {
+            for (size_t i = 0; i < length; ++i)
+                out[i] = match[i];
+        }
+        out += length;
+    }
+    return out == outEnd;
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Reading
+
+bool AssetArchive::Open(const char *path) {
+    Close();
+    if (!PlatformMapFile(path, mapping))
+        return false;
+
+    header = (const AssetArchiveHeader *)mapping.data;
+    if (mapping.size < sizeof(AssetArchiveHeader)) {
+        Close();
+        return false;
+    }
+    bool valid = header->magic == ASSET_ARCHIVE_MAGIC &&
+                 header->version == ASSET_ARCHIVE_VERSION && header->blockSize == ASSET_BLOCK_SIZE &&
+                 header->fileSize == mapping.size && header->namesSize > 0;
+    const uint64_t tablesEnd = sizeof(AssetArchiveHeader) + (uint64_t)header->entryCount * sizeof(AssetEntry) +
+                               (uint64_t)header->blockCount * sizeof(AssetBlock) + header->namesSize;
+    valid = valid && tablesEnd <= header->dataOffset && header->dataOffset <= header->fileSize;
+    if (!valid) {
+        Close();
+        return false;
+    }
+
+    entries = (const AssetEntry *)(mapping.data + sizeof(AssetArchiveHeader));
+    blocks = (const AssetBlock *)(entries + header->entryCount);
+    names = (const char *)(blocks + header->blockCount);
+    valid = names[header->namesSize - 1] == '\0';
+
+    // .. every entry's blocks cover exactly its bytes and lie in the data ..
+    for (uint32_t i = 0; valid && i < header->entryCount; ++i) {
+        const AssetEntry &entry = entries[i];
+        valid = entry.nameOffset < header->namesSize && AssetNameHash(Name(entry)) == entry.nameHash &&
+                (i == 0 || entries[i - 1].nameHash < entry.nameHash) &&
+                entry.blockCount == (entry.size + ASSET_BLOCK_SIZE - 1) / ASSET_BLOCK_SIZE &&
+                (uint64_t)entry.firstBlock + entry.blockCount <= header->blockCount;
+        for (uint32_t b = 0; valid && b < entry.blockCount; ++b) {
+            const AssetBlock &block = blocks[entry.firstBlock + b];
+            valid = block.size == std::min((uint64_t)ASSET_BLOCK_SIZE, entry.size - (uint64_t)b * ASSET_BLOCK_SIZE) &&
+                    block.storedSize <= block.size && block.offset >= header->dataOffset &&
+                    block.offset + block.storedSize <= header->fileSize;
+        }
+    }
+    if (!valid)
+        Close();
+    return valid;
+}
+
+void AssetArchive::Close() {
+    PlatformUnmapFile(mapping);
+    header = nullptr;
+    entries = nullptr;
+    blocks = nullptr;
+    names = nullptr;
+}
+
+const AssetEntry *AssetArchive::Find(const char *name) const {
+    if (!IsOpen())
+        return nullptr;
+    uint64_t          hash = AssetNameHash(name);
+    const AssetEntry *end = entries + header->entryCount;
+    const AssetEntry *entry = std::lower_bound(entries, end, hash, [](const AssetEntry &e, uint64_t h) { return e.nameHash < h; });
+    return entry != end && entry->nameHash == hash && strcmp(Name(*entry), name) == 0 ? entry : nullptr;
+}
+
+const uint8_t *AssetArchive::View(const AssetEntry &entry) const {
+    for (uint32_t b = 0; b < entry.blockCount; ++b) {
+        const AssetBlock &block = blocks[entry.firstBlock + b];
+        if (block.storedSize != block.size || (b > 0 && blocks[entry.firstBlock + b - 1].offset + ASSET_BLOCK_SIZE != block.offset))
+            return nullptr;
+    }
+    return mapping.data + (entry.blockCount ? blocks[entry.firstBlock].offset : header->dataOffset);
+}
+
+bool AssetArchive::Read(const AssetEntry &entry, std::vector<uint8_t> &data, TaskPool *pool) const {
+    const AssetEntry *assets[] = {&entry};
+    return ReadMany(assets, 1, &data, pool);
+}
+
+bool AssetArchive::ReadMany(const AssetEntry *const *assets, uint32_t count, std::vector<uint8_t> *data, TaskPool *pool) const {
+    struct Job {
+        uint32_t asset;
+        uint32_t block;
+    };
+    std::vector<Job> jobs;
+    for (uint32_t i = 0; i < count; ++i) {
+        data[i].resize((size_t)assets[i]->size);
+        for (uint32_t b = 0; b < assets[i]->blockCount; ++b)
+            jobs.push_back({i, b});
+    }
+
+    // NOTE(pf): Blocks of all assets go into one loop, so a few large assets keep every thread busy as well.
+    std::atomic<bool> result = {true};
+    auto              decompress = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t j = begin; j < end; ++j) {
+            const AssetBlock &block = blocks[assets[jobs[j].asset]->firstBlock + jobs[j].block];
+            const uint8_t    *src = mapping.data + block.offset;
+            uint8_t          *dst = data[jobs[j].asset].data() + (size_t)jobs[j].block * ASSET_BLOCK_SIZE;
+            if (block.storedSize == block.size)
+                memcpy(dst, src, block.size);
+            else if (!AssetDecompress(src, block.storedSize, dst, block.size))
+                result = false;
+        }
+    };
+    if (pool)
+        pool->ParallelFor((uint32_t)jobs.size(), 1, decompress);
+    else
+        decompress(0, (uint32_t)jobs.size());
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Writing
+
+bool AssetArchiveBuilder::Add(const char *name, ASSET_TYPE type, const void *data, size_t size) {
+    Asset asset;
+    asset.name = NormalizeAssetName(name);
+    asset.nameHash = AssetNameHash(asset.name.c_str());
+    asset.type = type;
+    for (const Asset &other : assets) {
+        if (other.nameHash == asset.nameHash)
+            return false;
+    }
+    asset.data.assign((const uint8_t *)data, (const uint8_t *)data + size);
+    assets.push_back(std::move(asset));
+    return true;
+}
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool AssetArchiveBuilder::Write(const char *path, TaskPool *pool) const {
+    std::vector<const Asset *> sorted;
+    for (const Asset &asset : assets)
+        sorted.push_back(&asset);
+    std::sort(sorted.begin(), sorted.end(), [](const Asset *a, const Asset *b) { return a->nameHash < b->nameHash; });
+
+    // .. cut every asset into blocks ..
+    struct PendingBlock {
+        const uint8_t       *data;
+        uint32_t             size;
+        std::vector<uint8_t> compressed; // Empty when stored as is.
+    };
+    std::vector<AssetEntry>   entries(sorted.size());
+    std::vector<PendingBlock> pending;
+    std::string               names;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const Asset &asset = *sorted[i];
+        AssetEntry  &entry = entries[i];
+        entry.nameHash = asset.nameHash;
+        entry.size = asset.data.size();
+        entry.nameOffset = (uint32_t)names.size();
+        entry.type = asset.type;
+        entry.firstBlock = (uint32_t)pending.size();
+        entry.blockCount = (uint32_t)((asset.data.size() + ASSET_BLOCK_SIZE - 1) / ASSET_BLOCK_SIZE);
+        for (uint32_t b = 0; b < entry.blockCount; ++b) {
+            size_t first = (size_t)b * ASSET_BLOCK_SIZE;
+            pending.push_back({asset.data.data() + first, (uint32_t)std::min((size_t)ASSET_BLOCK_SIZE, asset.data.size() - first), {}});
+        }
+        names.append(asset.name.c_str(), asset.name.size() + 1);
+    }
+
+    // .. compress them, a block that would not shrink is stored ..
+    auto compress = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t b = begin; b < end; ++b) {
+            PendingBlock &block = pending[b];
+            block.compressed.resize(block.size);
+            size_t size = AssetCompress(block.data, block.size, block.compressed.data(), block.size - 1);
+            block.compressed.resize(size);
+            block.compressed.shrink_to_fit();
+        }
+    };
+    if (pool)
+        pool->ParallelFor((uint32_t)pending.size(), 1, compress);
+    else
+        compress(0, (uint32_t)pending.size());
+
+    AssetArchiveHeader header = {};
+    header.magic = ASSET_ARCHIVE_MAGIC;
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.blockCount = (uint32_t)pending.size();
+    header.blockSize = ASSET_BLOCK_SIZE;
+    header.namesSize = (uint32_t)names.size() + (names.empty() ? 1 : 0);
+    header.dataOffset = AlignUp(sizeof(header) + entries.size() * sizeof(AssetEntry) + pending.size() * sizeof(AssetBlock) +
+                                    header.namesSize,
+                                ASSET_ARCHIVE_ALIGNMENT);
+
+    // .. and lay them out one after the other ..
+    std::vector<AssetBlock> blocks(pending.size());
+    uint64_t                offset = header.dataOffset;
+    for (size_t b = 0; b < pending.size(); ++b) {
+        offset = AlignUp(offset, ASSET_BLOCK_ALIGNMENT);
+        blocks[b].offset = offset;
+        blocks[b].size = pending[b].size;
+        blocks[b].storedSize = pending[b].compressed.empty() ? pending[b].size : (uint32_t)pending[b].compressed.size();
+        offset += blocks[b].storedSize;
+    }
+    header.fileSize = offset;
+
+    std::vector<uint8_t> file((size_t)header.fileSize, 0);
+    uint8_t             *out = file.data();
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    memcpy(out, entries.data(), entries.size() * sizeof(AssetEntry));
+    out += entries.size() * sizeof(AssetEntry);
+    memcpy(out, blocks.data(), blocks.size() * sizeof(AssetBlock));
+    out += blocks.size() * sizeof(AssetBlock);
+    memcpy(out, names.data(), names.size());
+    for (size_t b = 0; b < pending.size(); ++b) {
+        const uint8_t *data = pending[b].compressed.empty() ? pending[b].data : pending[b].compressed.data();
+        memcpy(file.data() + blocks[b].offset, data, blocks[b].storedSize);
+    }
+    return PlatformWriteFile(path, file.data(), file.size());
+}
+
+static bool HasExtension(const std::string &name, const char *extension) {
+    size_t length = strlen(extension);
+    return name.size() >= length && name.compare(name.size() - length, length, extension) == 0;
+}
+
+bool AddAssetFile(AssetArchiveBuilder &builder, const char *path) {
+    std::vector<uint8_t> data;
+    if (!PlatformReadFile(path, data))
+        return false;
+
+    std::string name = NormalizeAssetName(path);
+    if (HasExtension(name, ".txt")) {
+        MeshData mesh;
+        if (LoadTextMesh(path, mesh)) {
+            std::vector<uint8_t> encoded;
+            EncodeMesh(mesh, MeshCodecSettings(), encoded);
+            name = name.substr(0, name.size() - 4) + ".mesh";
+            return builder.Add(name.c_str(), ASSET_MESH, encoded.data(), encoded.size());
+        }
+    }
+
+    ASSET_TYPE type = ASSET_RAW;
+    if (HasExtension(name, ".hlsl") || HasExtension(name, ".h"))
+        type = ASSET_SHADER_SOURCE;
+    else if (HasExtension(name, ".cso"))
+        type = ASSET_SHADER_BYTECODE;
+    return builder.Add(name.c_str(), type, data.data(), data.size());
+}
@@ -0,0 +1,117 @@
+#ifndef _ASSET_ARCHIVE_H_
+#define _ASSET_ARCHIVE_H_
+
+/* Packed assets, one file that the app maps instead of opening every shader and model through a path relative to
+ * the working directory. AssetPacker builds it from the loose files.
+ *
+ * Layout: AssetArchiveHeader, the AssetEntry table sorted by name hash, the AssetBlock table, the names and then,
+ * from a multiple of ASSET_ARCHIVE_ALIGNMENT on, the blocks' data. Every asset is cut into blocks of
+ * ASSET_BLOCK_SIZE bytes that are compressed independently, an asset never shares a block with another, so any
+ * block of any asset decompresses on its own and ReadMany spreads all of them over the TaskPool. A block that does
+ * not get smaller is stored as is, an asset whose blocks are all stored can be used straight from the mapping.
+ *
+ * NOTE(pf): The compression is LZ4's block format: a token of literal and match length nibbles, the literals, a
+ * 16 bit offset back into the block. It is a byte level LZ, so it takes a fifth off what MeshCodec already
+ * packed and about 40% off the shader sources, but it decompresses at GB/s on one thread. The decoder checks every length and
+ * offset against the block, a damaged archive fails to read and never reads or writes out of bounds.
+ *
+ * Names are case sensitive with forward slashes and no leading "./", like "shaders/Common.hlsl". The format is
+ * little endian.
+ */
+
+#include "Platform.h"
+#include "TaskPool.h"
+#include <string>
+#include <vector>
+
+static constexpr uint32_t ASSET_ARCHIVE_MAGIC = {0x4b415045}; // "EPAK"
+static constexpr uint32_t ASSET_ARCHIVE_VERSION = {1};
+static constexpr uint32_t ASSET_BLOCK_SIZE = {64 * 1024};
+static constexpr uint32_t ASSET_ARCHIVE_ALIGNMENT = {64 * 1024}; // Of the data, blocks in it are 16 byte aligned.
+
+enum ASSET_TYPE {
+    ASSET_RAW = 0,
+    ASSET_SHADER_SOURCE = 1,
+    ASSET_SHADER_BYTECODE = 2,
+    ASSET_MESH = 3, // MeshCodec.h.
+};
+
+struct AssetArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t blockCount;
+    uint32_t blockSize;
+    uint32_t namesSize;
+    uint64_t dataOffset;
+    uint64_t fileSize;
+};
+
+struct AssetEntry {
+    uint64_t nameHash; // AssetNameHash.
+    uint64_t size;     // Uncompressed.
+    uint32_t nameOffset;
+    uint32_t type; // ASSET_TYPE.
+    uint32_t firstBlock;
+    uint32_t blockCount;
+};
+
+struct AssetBlock {
+    uint64_t offset; // From the start of the file.
+    uint32_t storedSize;
+    uint32_t size; // Uncompressed, ASSET_BLOCK_SIZE but for an asset's last block. Stored as is when equal to storedSize.
+};
+
+uint64_t AssetNameHash(const char *name);
+std::string NormalizeAssetName(const char *path);
+
+// NOTE(pf): Compress returns the compressed size, 0 when it does not fit dstCapacity. Decompress returns false
+// unless the data decodes to exactly dstSize bytes.
+size_t AssetCompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstCapacity);
+bool   AssetDecompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize);
+
+struct AssetArchive {
+    // NOTE(pf): Maps the file and validates all tables against it, false for anything that is not a whole archive
+    // of this version.
+    bool Open(const char *path);
+    void Close();
+    bool IsOpen() const { return mapping.data != nullptr; }
+
+    const AssetEntry *Find(const char *name) const; // Null when missing, name normalized.
+    const char       *Name(const AssetEntry &entry) const { return names + entry.nameOffset; }
+    uint32_t          EntryCount() const { return header->entryCount; }
+    const AssetEntry &Entry(uint32_t index) const { return entries[index]; }
+
+    // NOTE(pf): The asset in the mapping, valid until Close. Null when any of its blocks is compressed.
+    const uint8_t *View(const AssetEntry &entry) const;
+    // NOTE(pf): pool may be null. False when a block does not decompress.
+    bool Read(const AssetEntry &entry, std::vector<uint8_t> &data, TaskPool *pool) const;
+    bool ReadMany(const AssetEntry *const *assets, uint32_t count, std::vector<uint8_t> *data, TaskPool *pool) const;
+
+    PlatformFileMapping       mapping;
+    const AssetArchiveHeader *header = nullptr;
+    const AssetEntry         *entries = nullptr;
+    const AssetBlock         *blocks = nullptr;
+    const char               *names = nullptr;
+};
+
+struct AssetArchiveBuilder {
+    // NOTE(pf): Copies data. False when the name, or another one with the same hash, was added before.
+    bool Add(const char *name, ASSET_TYPE type, const void *data, size_t size);
+    // NOTE(pf): Compresses the blocks on the pool, which may be null.
+    bool Write(const char *path, TaskPool *pool) const;
+
+    struct Asset {
+        std::string          name;
+        uint64_t             nameHash;
+        ASSET_TYPE           type;
+        std::vector<uint8_t> data;
+    };
+    std::vector<Asset> assets;
+};
+
+// NOTE(pf): Adds a loose file under its normalized path: .hlsl and .h as shader source, .cso as bytecode and a
+// .txt mesh that LoadTextMesh reads encoded with MeshCodec as "<name>.mesh". Anything else is raw.
+bool AddAssetFile(AssetArchiveBuilder &builder, const char *path);
+
+#endif //!_ASSET_ARCHIVE_H_
@@ -0,0 +1,235 @@
+/* Measures loading the app's assets from loose files against loading them from an archive of AssetArchive.h,
+ * portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread -ffp-contract=off AssetArchiveBenchmark.cpp AssetArchive.cpp MeshCodec.cpp
+ *       MeshData.cpp MeshSimplifier.cpp Culling.cpp SsaoNormals.cpp TaskPool.cpp Platform_Posix.cpp Profiler.cpp
+ *       Timer.cpp -o AssetArchiveBenchmark
+ *   ./AssetArchiveBenchmark [--shaders shaders] [--model models/skull.txt] [--archive AssetArchiveBenchmark.pak]
+ *
+ * The loose load reads every shader and parses the text mesh like DX12::Initialize did, the archive load opens
+ * the archive, reads all assets with ReadMany and decodes the mesh, on one thread and on the TaskPool. Both are
+ * measured warm, repeated with everything in the page cache, and cold, with PlatformDropFileCache on every file
+ * before each run, "cold" in the output says whether the OS let it. Everything read from the archive has to
+ * match the loose files, the mesh has to decode to what MeshCodec makes of the text, and archives that are
+ * truncated or not archives have to fail to open. The exit code is 1 if a check fails.
+ */
+
+#include "AssetArchive.h"
+#include "MeshCodec.h"
+#include "Timer.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+static constexpr uint32_t WARM_ITERATIONS = {20};
+static constexpr uint32_t COLD_ITERATIONS = {5};
+static constexpr uint32_t TEXT_ITERATIONS = {3};
+
+template <typename F> static double MeasureMs(uint32_t iterations, F run) {
+    int64_t start = HiResPerformanceQuery();
+    for (uint32_t i = 0; i < iterations; ++i)
+        run();
+    return HiResMilliseconds(HiResPerformanceQuery() - start) / iterations;
+}
+
+static bool SameMesh(const MeshData &a, const MeshData &b) {
+    return a.vertices.size() == b.vertices.size() && a.indices == b.indices && a.lodCount == b.lodCount &&
+           memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(MeshVertex)) == 0;
+}
+
+static bool DropCaches(const std::vector<std::string> &paths) {
+    bool result = true;
+    for (const std::string &path : paths)
+        result = PlatformDropFileCache(path.c_str()) && result;
+    return result;
+}
+
+// .. an archive cut short or with a damaged header must not open ..
+static bool RejectsDamaged(const char *archivePath, const char *damagedPath) {
+    std::vector<uint8_t> file;
+    if (!PlatformReadFile(archivePath, file))
+        return false;
+
+    bool                 result = true;
+    AssetArchive         archive;
+    const size_t         truncatedSizes[] = {1, sizeof(AssetArchiveHeader) - 1, sizeof(AssetArchiveHeader), file.size() / 2, file.size() - 1};
+    std::vector<uint8_t> damaged;
+    for (size_t size : truncatedSizes) {
+        damaged.assign(file.begin(), file.begin() + size);
+        result = result && PlatformWriteFile(damagedPath, damaged.data(), damaged.size()) && !archive.Open(damagedPath);
+    }
+    const size_t damagedBytes[] = {0, offsetof(AssetArchiveHeader, entryCount), offsetof(AssetArchiveHeader, dataOffset) + 3,
+                                   sizeof(AssetArchiveHeader) + offsetof(AssetEntry, size) + 4};
+    for (size_t byte : damagedBytes) {
+        damaged = file;
+        damaged[byte] ^= 0x80;
+        result = result && PlatformWriteFile(damagedPath, damaged.data(), damaged.size()) && !archive.Open(damagedPath);
+    }
+    remove(damagedPath);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    const char *shaderPath = "shaders";
+    const char *modelPath = "models/skull.txt";
+    const char *archivePath = "AssetArchiveBenchmark.pak";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--shaders") == 0 && i + 1 < argc)
+            shaderPath = argv[++i];
+        else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+        else if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc)
+            archivePath = argv[++i];
+    }
+
+    std::vector<std::string> shaders;
+    if (!PlatformListDirectory(shaderPath, shaders)) {
+        fprintf(stderr, "Failed to list %s\n", shaderPath);
+        return 1;
+    }
+    for (std::string &shader : shaders)
+        shader = std::string(shaderPath) + "/" + shader;
+    std::vector<std::string> loosePaths = shaders;
+    loosePaths.push_back(modelPath);
+
+    AssetArchiveBuilder builder;
+    for (const std::string &path : loosePaths) {
+        if (!AddAssetFile(builder, path.c_str())) {
+            fprintf(stderr, "Failed to pack %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    TaskPool pool;
+    pool.Initialize();
+    double packMs = MeasureMs(1, [&]() { builder.Write(archivePath, &pool); });
+
+    AssetArchive archive;
+    if (!archive.Open(archivePath)) {
+        fprintf(stderr, "Failed to open %s\n", archivePath);
+        return 1;
+    }
+    std::vector<const AssetEntry *> entries;
+    for (uint32_t i = 0; i < archive.EntryCount(); ++i)
+        entries.push_back(&archive.Entry(i));
+    std::string       meshName = NormalizeAssetName(modelPath);
+    const AssetEntry *meshEntry = archive.Find((meshName.substr(0, meshName.size() - 4) + ".mesh").c_str());
+    if (!meshEntry) {
+        fprintf(stderr, "%s is not a mesh\n", modelPath);
+        return 1;
+    }
+    const size_t meshIndex = meshEntry - entries[0];
+
+    // .. sizes by type ..
+    uint64_t rawBytes[4] = {}, storedBytes[4] = {}, totalBytes = 0;
+    for (const AssetEntry *entry : entries) {
+        rawBytes[entry->type] += entry->size;
+        totalBytes += entry->size;
+        for (uint32_t b = 0; b < entry->blockCount; ++b)
+            storedBytes[entry->type] += archive.blocks[entry->firstBlock + b].storedSize;
+    }
+    uint64_t looseBytes = 0;
+    for (const std::string &path : loosePaths) {
+        std::vector<uint8_t> data;
+        PlatformReadFile(path.c_str(), data);
+        looseBytes += data.size();
+    }
+
+    // .. the loads ..
+    std::vector<std::vector<uint8_t>> looseData(shaders.size());
+    MeshData                          looseMesh;
+    auto                              loadLoose = [&]() {
+        for (size_t i = 0; i < shaders.size(); ++i)
+            PlatformReadFile(shaders[i].c_str(), looseData[i]);
+        LoadTextMesh(modelPath, looseMesh);
+    };
+    std::vector<std::vector<uint8_t>> archiveData(entries.size());
+    MeshData                          archiveMesh;
+    bool                              archiveLoaded = true;
+    auto                              loadArchive = [&](TaskPool *threads) {
+        AssetArchive                    loaded;
+        std::vector<const AssetEntry *> loadedEntries;
+        bool                            result = loaded.Open(archivePath) && loaded.EntryCount() == entries.size();
+        for (uint32_t i = 0; result && i < loaded.EntryCount(); ++i)
+            loadedEntries.push_back(&loaded.Entry(i));
+        result = result && loaded.ReadMany(loadedEntries.data(), (uint32_t)loadedEntries.size(), archiveData.data(), threads) &&
+                 DecodeMesh(archiveData[meshIndex].data(), archiveData[meshIndex].size(), archiveMesh, threads);
+        archiveLoaded = archiveLoaded && result;
+        loaded.Close();
+    };
+    std::vector<std::string> archivePaths = {archivePath};
+
+    double looseWarmMs = MeasureMs(TEXT_ITERATIONS, loadLoose);
+    bool   cold = true;
+    double looseColdMs = MeasureMs(TEXT_ITERATIONS, [&]() {
+        cold = DropCaches(loosePaths) && cold;
+        loadLoose();
+    });
+    double archiveWarmMs = MeasureMs(WARM_ITERATIONS, [&]() { loadArchive(nullptr); });
+    double archiveWarmThreadedMs = MeasureMs(WARM_ITERATIONS, [&]() { loadArchive(&pool); });
+    double archiveColdMs = MeasureMs(COLD_ITERATIONS, [&]() {
+        cold = DropCaches(archivePaths) && cold;
+        loadArchive(nullptr);
+    });
+    double archiveColdThreadedMs = MeasureMs(COLD_ITERATIONS, [&]() {
+        cold = DropCaches(archivePaths) && cold;
+        loadArchive(&pool);
+    });
+    double readManyMs = MeasureMs(WARM_ITERATIONS, [&]() {
+        archive.ReadMany(entries.data(), (uint32_t)entries.size(), archiveData.data(), nullptr);
+    });
+    double readManyThreadedMs = MeasureMs(WARM_ITERATIONS, [&]() {
+        archive.ReadMany(entries.data(), (uint32_t)entries.size(), archiveData.data(), &pool);
+    });
+
+    // .. checks ..
+    bool matches = archiveLoaded;
+    for (size_t i = 0; matches && i < shaders.size(); ++i) {
+        const AssetEntry *entry = archive.Find(NormalizeAssetName(shaders[i].c_str()).c_str());
+        matches = entry && archiveData[entry - entries[0]] == looseData[i];
+    }
+    std::vector<uint8_t> encoded;
+    MeshData             expected;
+    EncodeMesh(looseMesh, MeshCodecSettings(), encoded);
+    bool meshMatches = matches && DecodeMesh(encoded.data(), encoded.size(), expected, nullptr) && SameMesh(expected, archiveMesh) &&
+                       memcmp(expected.lods, looseMesh.lods, sizeof(looseMesh.lods)) == 0;
+    bool viewsMatch = true;
+    for (uint32_t i = 0; i < (uint32_t)entries.size(); ++i) {
+        const uint8_t *view = archive.View(*entries[i]);
+        viewsMatch = viewsMatch && (!view || memcmp(view, archiveData[i].data(), archiveData[i].size()) == 0);
+    }
+    uint64_t fileSize = archive.header->fileSize;
+    archive.Close();
+    bool rejectsDamaged = RejectsDamaged(archivePath, (std::string(archivePath) + ".damaged").c_str());
+    remove(archivePath);
+    pool.CleanUp();
+
+    double gb = totalBytes / 1e9;
+    printf("{\"benchmark\": \"asset_archive\", \"assets\": %zu, \"threads\": %u, \"loose_bytes\": %llu, \"archive_bytes\": %llu, "
+           "\"uncompressed_bytes\": %llu, \"pack_ms\": %.3f,\n",
+           entries.size(), pool.ThreadCount(), (unsigned long long)looseBytes, (unsigned long long)fileSize,
+           (unsigned long long)totalBytes, packMs);
+    printf(" \"shader_source_bytes\": %llu, \"shader_source_stored\": %llu, \"shader_source_ratio\": %.2f, \"mesh_bytes\": %llu, "
+           "\"mesh_stored\": %llu, \"mesh_ratio\": %.2f,\n",
+           (unsigned long long)rawBytes[ASSET_SHADER_SOURCE], (unsigned long long)storedBytes[ASSET_SHADER_SOURCE],
+           (double)rawBytes[ASSET_SHADER_SOURCE] / Max(1.0f, (float)storedBytes[ASSET_SHADER_SOURCE]),
+           (unsigned long long)rawBytes[ASSET_MESH], (unsigned long long)storedBytes[ASSET_MESH],
+           (double)rawBytes[ASSET_MESH] / Max(1.0f, (float)storedBytes[ASSET_MESH]));
+    printf(" \"cold\": %s, \"loose_warm_ms\": %.3f, \"loose_cold_ms\": %.3f, \"archive_warm_ms\": %.3f, "
+           "\"archive_warm_threaded_ms\": %.3f, \"archive_cold_ms\": %.3f, \"archive_cold_threaded_ms\": %.3f,\n",
+           cold ? "true" : "false", looseWarmMs, looseColdMs, archiveWarmMs, archiveWarmThreadedMs, archiveColdMs,
+           archiveColdThreadedMs);
+    printf(" \"read_many_ms\": %.3f, \"read_many_threaded_ms\": %.3f, \"read_many_gb_per_s\": %.2f, "
+           "\"read_many_threaded_gb_per_s\": %.2f, \"speedup_warm\": %.1f, \"speedup_cold\": %.1f,\n",
+           readManyMs, readManyThreadedMs, gb / (readManyMs * 1e-3), gb / (readManyThreadedMs * 1e-3),
+           looseWarmMs / archiveWarmThreadedMs, looseColdMs / archiveColdThreadedMs);
+    printf(" \"matches_loose\": %s, \"mesh_matches\": %s, \"views_match\": %s, \"rejects_damaged\": %s}\n",
+           matches ? "true" : "false", meshMatches ? "true" : "false", viewsMatch ? "true" : "false",
+           rejectsDamaged ? "true" : "false");
+
+    uint32_t failures = !matches + !meshMatches + !viewsMatch + !rejectsDamaged;
+    if (failures) {
+        fprintf(stderr, "%u checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
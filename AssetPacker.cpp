@@ -0,0 +1,78 @@
+/* Packs loose assets into an archive of AssetArchive.h, the assets.pak the app loads next to its executable.
+ *
+ *   AssetPacker [--output assets.pak] [file or directory ...]
+ *
+ * Without paths it packs shaders and models, run it from the repository root. Directories are packed without
+ * their subdirectories, every file under its path as given, so "shaders" becomes "shaders/Common.hlsl" and so
+ * on. Text meshes are stored encoded with MeshCodec. The archive is read back and every asset compared to what
+ * went in, the exit code is 1 if anything could not be packed or does not match.
+ */
+
+#include "AssetArchive.h"
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char **argv) {
+    const char               *outputPath = "assets.pak";
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.empty())
+        paths = {"shaders", "models"};
+
+    AssetArchiveBuilder builder;
+    for (const std::string &path : paths) {
+        std::vector<std::string> files;
+        if (PlatformListDirectory(path.c_str(), files)) {
+            for (std::string &file : files)
+                file = path + "/" + file;
+        } else {
+            files.push_back(path);
+        }
+
+        for (const std::string &file : files) {
+            if (!AddAssetFile(builder, file.c_str())) {
+                fprintf(stderr, "Failed to pack %s\n", file.c_str());
+                return 1;
+            }
+        }
+    }
+
+    TaskPool pool;
+    pool.Initialize();
+    bool written = builder.Write(outputPath, &pool);
+
+    // .. read it back ..
+    AssetArchive archive;
+    uint32_t     failures = written && archive.Open(outputPath) ? 0 : 1;
+    for (size_t i = 0; !failures && i < builder.assets.size(); ++i) {
+        const AssetArchiveBuilder::Asset &asset = builder.assets[i];
+        const AssetEntry                 *entry = archive.Find(asset.name.c_str());
+        std::vector<uint8_t>              data;
+        if (!entry || entry->type != (uint32_t)asset.type || !archive.Read(*entry, data, &pool) || data != asset.data) {
+            fprintf(stderr, "%s does not match in %s\n", asset.name.c_str(), outputPath);
+            failures++;
+            continue;
+        }
+
+        uint64_t stored = 0;
+        for (uint32_t b = 0; b < entry->blockCount; ++b)
+            stored += archive.blocks[entry->firstBlock + b].storedSize;
+        printf("  %-32s %9llu -> %9llu bytes, %u blocks\n", asset.name.c_str(), (unsigned long long)entry->size,
+               (unsigned long long)stored, entry->blockCount);
+    }
+    pool.CleanUp();
+
+    if (!written || failures) {
+        fprintf(stderr, "Failed to write %s\n", outputPath);
+        return 1;
+    }
+    printf("Packed %zu assets, %llu bytes to %s\n", builder.assets.size(), (unsigned long long)archive.header->fileSize,
+           outputPath);
+    archive.Close();
+    return 0;
+}
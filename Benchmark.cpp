@@ -0,0 +1,330 @@
+/* Headless benchmark of the frame in App/DX12 on the software backend, see SoftwareRenderer.h.
+ *
+ *   Benchmark [--frames N] [--warmup N] [--filter substring] [--model path] [--out results.json]
+ *             [--save-baseline baseline.csv] [--baseline baseline.csv] [--threshold 0.10] [--dump frame.ppm] [--list]
+ *
+ * Every scenario renders a fixed number of frames of the spinning skull scene with a fixed timestep, so runs
+ * are repeatable. Results are JSON with mean/p50/p95/p99/max per pass. With --baseline, p50 and p95 of every
+ * pass are compared against the stored values and the exit code is 2 if any got slower than the threshold.
+ *
+ * Build, from the repository root, along with the core library it links:
+ *   cmake -S . -B build && cmake --build build --target Benchmark
+ */
+
+#include "Mat4.h"
+#include "MeshData.h"
+#include "SoftwareRenderer.h"
+#include "Timer.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct BenchmarkScenario {
+    const char *name;
+    uint32_t    width;
+    uint32_t    height;
+    int         instanceGridSize;
+    bool        ssao;
+};
+
+// NOTE(pf): Names are the keys of the baseline, renaming a scenario drops its history.
+static const BenchmarkScenario scenarios[] = {
+    {"skull_rotation_720p", 1280, 720, 1, true},
+    {"instances_16_360p", 640, 360, 4, false},
+    {"instances_256_360p", 640, 360, 16, false},
+    {"instances_1024_360p", 640, 360, 32, false},
+    {"ssao_off_360p", 640, 360, 1, false},
+    {"ssao_on_360p", 640, 360, 1, true},
+    {"ssao_off_720p", 1280, 720, 1, false},
+    {"ssao_on_720p", 1280, 720, 1, true},
+    {"ssao_off_1080p", 1920, 1080, 1, false},
+    {"ssao_on_1080p", 1920, 1080, 1, true},
+};
+
+enum BENCHMARK_METRIC {
+    BENCHMARK_METRIC_FRAME = 0,
+    BENCHMARK_METRIC_GEOMETRY = 1,
+    BENCHMARK_METRIC_SSAO = 2,
+    BENCHMARK_METRIC_COMPOSITE = 3,
+    BENCHMARK_METRIC_COUNT,
+};
+
+static const char *metricNames[BENCHMARK_METRIC_COUNT] = {"frame", "geometry", "ssao", "composite"};
+
+struct BenchmarkSummary {
+    double mean, p50, p95, p99, max;
+};
+
+struct BenchmarkResult {
+    const BenchmarkScenario *scenario;
+    uint32_t                 frames;
+    uint64_t                 instancesDrawn;
+    uint64_t                 trianglesDrawn;
+    BenchmarkSummary         metrics[BENCHMARK_METRIC_COUNT];
+};
+
+struct BaselineEntry {
+    std::string scenario;
+    std::string metric;
+    double      p50;
+    double      p95;
+};
+
+static BenchmarkSummary Summarize(std::vector<double> samples) {
+    BenchmarkSummary result = {};
+    if (samples.empty())
+        return result;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples)
+        sum += s;
+
+    // NOTE(pf): Nearest rank percentiles, exact since every sample is kept.
+    auto Rank = [&](double p) {
+        size_t rank = (size_t)(p * samples.size() + 0.5);
+        rank = rank < 1 ? 1 : (rank > samples.size() ? samples.size() : rank);
+        return samples[rank - 1];
+    };
+    result.mean = sum / samples.size();
+    result.p50 = Rank(0.50);
+    result.p95 = Rank(0.95);
+    result.p99 = Rank(0.99);
+    result.max = samples.back();
+    return result;
+}
+
+// NOTE(pf): Same scene as App::Step/RenderState, 90 degrees a second around (0, 1, 1) on a grid in the xz plane.
+static void BuildScene(const BenchmarkScenario &scenario, double time, std::vector<Mat4> &instances, Mat4 &view, Mat4 &proj) {
+    const float instanceSpacing = 12.0f;
+    float       angle = ConvertToRadians(fmodf((float)(time * 90.0), 360.0f));
+    Mat4        model = Mat4RotationAxis(0.0f, 1.0f, 1.0f, angle);
+
+    int   gridSize = scenario.instanceGridSize;
+    float gridOffset = 0.5f * (gridSize - 1) * instanceSpacing;
+    instances.resize(gridSize * gridSize);
+    for (int z = 0; z < gridSize; ++z) {
+        for (int x = 0; x < gridSize; ++x) {
+            Mat4 translation = Mat4Translation(x * instanceSpacing - gridOffset, 0.0f, z * instanceSpacing - gridOffset);
+            instances[z * gridSize + x] = Mat4Multiply(model, translation);
+        }
+    }
+
+    const float eye[3] = {0.0f, 5.0f, -25.0f};
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    view = Mat4LookAtLH(eye, focus, up);
+    proj = Mat4PerspectiveFovLH(ConvertToRadians(45.0f), scenario.width / (float)scenario.height, 1.0f, 1000.0f);
+}
+
+static BenchmarkResult RunScenario(const BenchmarkScenario &scenario, const MeshData &mesh, uint32_t frames, uint32_t warmupFrames,
+                                   const char *dumpPath) {
+    const double fixedStep = 1.0 / 60.0;
+
+    SoftwareRenderer renderer;
+    renderer.Initialize(scenario.width, scenario.height);
+
+    std::vector<Mat4>   instances;
+    Mat4                view, proj;
+    std::vector<double> samples[BENCHMARK_METRIC_COUNT];
+    BenchmarkResult     result = {};
+    result.scenario = &scenario;
+    result.frames = frames;
+
+    for (uint32_t frame = 0; frame < warmupFrames + frames; ++frame) {
+        BuildScene(scenario, frame * fixedStep, instances, view, proj);
+
+        int64_t frameStart = HiResPerformanceQuery();
+        renderer.BeginFrame();
+        renderer.DrawMeshInstances(mesh, instances.data(), (uint32_t)instances.size(), view, proj);
+        int64_t geometryEnd = HiResPerformanceQuery();
+        if (scenario.ssao)
+            renderer.ComputeSsao(proj);
+        int64_t ssaoEnd = HiResPerformanceQuery();
+        renderer.Composite(scenario.ssao);
+        int64_t frameEnd = HiResPerformanceQuery();
+
+        if (frame < warmupFrames)
+            continue;
+        samples[BENCHMARK_METRIC_FRAME].push_back(HiResMilliseconds(frameEnd - frameStart));
+        samples[BENCHMARK_METRIC_GEOMETRY].push_back(HiResMilliseconds(geometryEnd - frameStart));
+        samples[BENCHMARK_METRIC_SSAO].push_back(HiResMilliseconds(ssaoEnd - geometryEnd));
+        samples[BENCHMARK_METRIC_COMPOSITE].push_back(HiResMilliseconds(frameEnd - ssaoEnd));
+        result.instancesDrawn += renderer.instancesDrawn;
+        result.trianglesDrawn += renderer.trianglesDrawn;
+    }
+
+    for (int m = 0; m < BENCHMARK_METRIC_COUNT; ++m)
+        result.metrics[m] = Summarize(samples[m]);
+
+    // NOTE(pf): Binary PPM of the last frame, handy to eyeball that the backend still draws the right thing.
+    if (dumpPath) {
+        FILE *file = fopen(dumpPath, "wb");
+        if (file) {
+            fprintf(file, "P6\n%u %u\n255\n", renderer.width, renderer.height);
+            for (uint32_t c : renderer.color) {
+                uint8_t rgb[3] = {(uint8_t)(c & 0xFF), (uint8_t)((c >> 8) & 0xFF), (uint8_t)((c >> 16) & 0xFF)};
+                fwrite(rgb, 1, 3, file);
+            }
+            fclose(file);
+        }
+    }
+    return result;
+}
+
+static bool LoadBaseline(const char *path, std::vector<BaselineEntry> &entries) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char   scenario[128], metric[64];
+        double p50, p95;
+        if (sscanf(line, "%127[^,],%63[^,],%lf,%lf", scenario, metric, &p50, &p95) == 4)
+            entries.push_back({scenario, metric, p50, p95});
+    }
+    fclose(file);
+    return true;
+}
+
+static bool SaveBaseline(const char *path, const std::vector<BenchmarkResult> &results) {
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "scenario,metric,p50_ms,p95_ms\n");
+    for (const BenchmarkResult &result : results) {
+        for (int m = 0; m < BENCHMARK_METRIC_COUNT; ++m)
+            fprintf(file, "%s,%s,%.4f,%.4f\n", result.scenario->name, metricNames[m], result.metrics[m].p50, result.metrics[m].p95);
+    }
+    fclose(file);
+    return true;
+}
+
+static void WriteResults(FILE *file, const std::vector<BenchmarkResult> &results, const std::vector<BaselineEntry> &baseline,
+                         double threshold, bool compare, int &regressionCount) {
+    regressionCount = 0;
+    fprintf(file, "{\n  \"backend\": \"software\",\n  \"scenarios\": [\n");
+    for (size_t r = 0; r < results.size(); ++r) {
+        const BenchmarkResult   &result = results[r];
+        const BenchmarkScenario &scenario = *result.scenario;
+        fprintf(file, "    {\"name\": \"%s\", \"width\": %u, \"height\": %u, \"instances\": %d, \"ssao\": %s, \"frames\": %u,\n",
+                scenario.name, scenario.width, scenario.height, scenario.instanceGridSize * scenario.instanceGridSize,
+                scenario.ssao ? "true" : "false", result.frames);
+        fprintf(file, "     \"instances_drawn_per_frame\": %.1f, \"triangles_per_frame\": %.1f,\n     \"metrics\": {",
+                result.instancesDrawn / Max((double)result.frames, 1.0), result.trianglesDrawn / Max((double)result.frames, 1.0));
+
+        for (int m = 0; m < BENCHMARK_METRIC_COUNT; ++m) {
+            const BenchmarkSummary &s = result.metrics[m];
+            fprintf(file, "%s\n       \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f",
+                    m ? "," : "", metricNames[m], s.mean, s.p50, s.p95, s.p99, s.max);
+
+            if (compare) {
+                const BaselineEntry *entry = nullptr;
+                for (const BaselineEntry &e : baseline) {
+                    if (e.scenario == scenario.name && e.metric == metricNames[m])
+                        entry = &e;
+                }
+                if (entry) {
+                    // NOTE(pf): Sub 0.05 ms metrics are noise, they never count as regressions.
+                    bool regressed = (s.p50 > entry->p50 * (1.0 + threshold) && s.p50 - entry->p50 > 0.05) ||
+                                     (s.p95 > entry->p95 * (1.0 + threshold) && s.p95 - entry->p95 > 0.05);
+                    regressionCount += regressed ? 1 : 0;
+                    fprintf(file, ", \"baseline_p50\": %.4f, \"baseline_p95\": %.4f, \"regressed\": %s",
+                            entry->p50, entry->p95, regressed ? "true" : "false");
+                }
+            }
+            fprintf(file, "}");
+        }
+        fprintf(file, "\n     }}%s\n", r + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]");
+    if (compare)
+        fprintf(file, ",\n  \"threshold\": %.4f,\n  \"regressions\": %d", threshold, regressionCount);
+    fprintf(file, "\n}\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t    frames = 30;
+    uint32_t    warmupFrames = 3;
+    const char *filter = nullptr;
+    const char *modelPath = "models/skull.txt";
+    const char *outPath = nullptr;
+    const char *baselinePath = nullptr;
+    const char *saveBaselinePath = nullptr;
+    const char *dumpPath = nullptr;
+    double      threshold = 0.10;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && hasValue)
+            frames = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+            warmupFrames = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && hasValue)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--model") == 0 && hasValue)
+            modelPath = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && hasValue)
+            outPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && hasValue)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--save-baseline") == 0 && hasValue)
+            saveBaselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && hasValue)
+            threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--dump") == 0 && hasValue)
+            dumpPath = argv[++i];
+        else if (strcmp(argv[i], "--list") == 0) {
+            for (const BenchmarkScenario &scenario : scenarios)
+                printf("%s\n", scenario.name);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    MeshData mesh;
+    if (!LoadTextMesh(modelPath, mesh)) {
+        fprintf(stderr, "Failed to load %s\n", modelPath);
+        return 1;
+    }
+
+    std::vector<BaselineEntry> baseline;
+    if (baselinePath && !LoadBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "Failed to read baseline %s\n", baselinePath);
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkScenario &scenario : scenarios) {
+        if (filter && !strstr(scenario.name, filter))
+            continue;
+        fprintf(stderr, "Running %s..\n", scenario.name);
+        results.push_back(RunScenario(scenario, mesh, frames, warmupFrames, results.empty() ? dumpPath : nullptr));
+    }
+
+    int   regressionCount = 0;
+    FILE *out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Failed to write %s\n", outPath);
+        return 1;
+    }
+    WriteResults(out, results, baseline, threshold, baselinePath != nullptr, regressionCount);
+    if (out != stdout)
+        fclose(out);
+
+    if (saveBaselinePath && !SaveBaseline(saveBaselinePath, results)) {
+        fprintf(stderr, "Failed to write baseline %s\n", saveBaselinePath);
+        return 1;
+    }
+    if (regressionCount > 0) {
+        fprintf(stderr, "%d metric(s) regressed by more than %.0f%%\n", regressionCount, threshold * 100.0);
+        return 2;
+    }
+    return 0;
+}
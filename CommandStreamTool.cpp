@@ -0,0 +1,264 @@
+/* Records, prints and compares command streams of the renderer's frame, see GfxRecorder.h.
+ *
+ *   CommandStreamTool record out.gfx [--width W] [--height H] [--batches N] [--no-state-cache] [--gtao]
+ *                            [--normals float|octahedral|depth] [--lights]
+ *   CommandStreamTool dump capture.gfx
+ *   CommandStreamTool stats capture.gfx
+ *   CommandStreamTool diff a.gfx b.gfx
+ *
+ * record runs RecordFrame with placeholder handles laid out like DX12's, so the stream matches a capture made
+ * by App --capture-commands up to resource ids. Like App it records through GfxStateCache unless
+ * --no-state-cache is given, --gtao records the frame App draws with the GTAO engine. --normals picks the SSAO
+ * normal source of SsaoNormals.h, float by default. --lights adds the light culling dispatch and the forward
+ * pass of LightCulling.h, which App draws whenever it has lights. stats prints JSON with the number of calls and
+ * of redundant state calls per command. diff exits with 1 if the streams differ.
+ */
+
+#include "DepthPyramid.h"
+#include "FramePasses.h"
+#include "GfxRecorder.h"
+#include "GfxStateCache.h"
+#include "LightCulling.h"
+#include "SsaoNormals.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// NOTE(pf): Placeholder handles, only their identity matters to the recorder.
+enum PLACEHOLDER : GfxHandle {
+    PLACEHOLDER_SRV_HEAP = 0x1000,
+    PLACEHOLDER_ROOT_SIGNATURE,
+    PLACEHOLDER_SSAO_ROOT_SIGNATURE,
+    PLACEHOLDER_NORMAL_PSO,
+    PLACEHOLDER_SSAO_PSO,
+    PLACEHOLDER_COMPOSITE_PSO,
+    PLACEHOLDER_BACK_BUFFER,
+    PLACEHOLDER_DEPTH_BUFFER,
+    PLACEHOLDER_NORMAL_MAP,
+    PLACEHOLDER_AMBIENT_MAP,
+    PLACEHOLDER_RANDOM_VECTOR_MAP,
+    PLACEHOLDER_COMMAND_SIGNATURE,
+    PLACEHOLDER_INDIRECT_ARGUMENTS,
+    PLACEHOLDER_DEPTH_PYRAMID_ROOT_SIGNATURE,
+    PLACEHOLDER_DEPTH_PYRAMID_PSO,
+    PLACEHOLDER_DEPTH_PYRAMID,
+    PLACEHOLDER_DEPTH_PYRAMID_SCRATCH,
+    PLACEHOLDER_GTAO_PSO,
+    PLACEHOLDER_LIGHT_CULL_ROOT_SIGNATURE,
+    PLACEHOLDER_LIGHT_CULL_PSO,
+    PLACEHOLDER_FORWARD_PSO,
+    PLACEHOLDER_LIT_COMPOSITE_PSO,
+    PLACEHOLDER_TILE_LIGHTS,
+    PLACEHOLDER_LIT_COLOR,
+};
+
+static constexpr GfxHandle PLACEHOLDER_RTV_HEAP_START = {0x10000};
+static constexpr GfxHandle PLACEHOLDER_DSV_HEAP_START = {0x20000};
+static constexpr GfxHandle PLACEHOLDER_SRV_CPU_START = {0x30000};
+static constexpr GfxHandle PLACEHOLDER_SRV_GPU_START = {0x40000};
+static constexpr GfxHandle PLACEHOLDER_GPU_ADDRESS = {0x100000000ull};
+static constexpr uint32_t  PLACEHOLDER_DESCRIPTOR_SIZE = {32};
+static constexpr uint32_t  PLACEHOLDER_NUM_FRAMES = {3};
+
+static FrameBindings PlaceholderFrame(uint32_t width, uint32_t height, uint32_t batchCount, bool useGtao,
+                                      SSAO_NORMAL_SOURCE normalSource, bool useLighting) {
+    GfxViewport viewport = {0.0f, 0.0f, (float)width, (float)height, 0.0f, 1.0f};
+    GfxRect     scissorRect = {0, 0, (int32_t)width, (int32_t)height};
+
+    FrameBindings frame = {};
+    frame.descriptorHeap = PLACEHOLDER_SRV_HEAP;
+    frame.rootSignature = PLACEHOLDER_ROOT_SIGNATURE;
+    frame.ssaoRootSignature = PLACEHOLDER_SSAO_ROOT_SIGNATURE;
+    frame.depthPyramidRootSignature = PLACEHOLDER_DEPTH_PYRAMID_ROOT_SIGNATURE;
+    frame.lightCullRootSignature = PLACEHOLDER_LIGHT_CULL_ROOT_SIGNATURE;
+    frame.normalPipelineState = PLACEHOLDER_NORMAL_PSO;
+    frame.compositePipelineState = PLACEHOLDER_COMPOSITE_PSO;
+    frame.viewport = viewport;
+    frame.scissorRect = scissorRect;
+    frame.renderViewport = viewport;
+    frame.renderScissorRect = scissorRect;
+    frame.backBuffer = PLACEHOLDER_BACK_BUFFER;
+    frame.backBufferRtv = PLACEHOLDER_RTV_HEAP_START;
+    frame.dsv = PLACEHOLDER_DSV_HEAP_START;
+    frame.frameConstants = PLACEHOLDER_GPU_ADDRESS;
+    frame.ambientMapGpuSrv = PLACEHOLDER_SRV_GPU_START;
+
+    // .. same descriptor layout as DX12::Initialize, back buffer rtvs first then normal and ambient ..
+    SsaoPassBindings &ssao = frame.ssao;
+    ssao.viewport = viewport;
+    ssao.scissorRect = scissorRect;
+    ssao.pipelineState = useGtao ? PLACEHOLDER_GTAO_PSO : PLACEHOLDER_SSAO_PSO;
+    ssao.passConstants = PLACEHOLDER_GPU_ADDRESS + 0x10000;
+    ssao.staticConstants = PLACEHOLDER_GPU_ADDRESS + 0x10100;
+    ssao.normalMap = PLACEHOLDER_NORMAL_MAP;
+    ssao.writeNormalMap = normalSource != SSAO_NORMALS_FROM_DEPTH;
+    ssao.depthMap = PLACEHOLDER_DEPTH_BUFFER;
+    ssao.randomVectorMap = PLACEHOLDER_RANDOM_VECTOR_MAP;
+    ssao.ambientMap = PLACEHOLDER_AMBIENT_MAP;
+    ssao.depthPyramidPipelineState = PLACEHOLDER_DEPTH_PYRAMID_PSO;
+    ssao.depthPyramid = PLACEHOLDER_DEPTH_PYRAMID;
+    ssao.depthPyramidScratch = PLACEHOLDER_DEPTH_PYRAMID_SCRATCH;
+    ssao.depthPyramidGroups[0] = (width + DEPTH_PYRAMID_TILE_SIZE - 1) / DEPTH_PYRAMID_TILE_SIZE;
+    ssao.depthPyramidGroups[1] = (height + DEPTH_PYRAMID_TILE_SIZE - 1) / DEPTH_PYRAMID_TILE_SIZE;
+    ssao.depthPyramidScratchElements = DEPTH_PYRAMID_SCRATCH_HEADER + 2 * ssao.depthPyramidGroups[0] * ssao.depthPyramidGroups[1];
+    ssao.useDepthPyramid = !useGtao;
+    ssao.ambientMapCpuSrv = PLACEHOLDER_SRV_CPU_START;
+    ssao.normalMapCpuSrv = PLACEHOLDER_SRV_CPU_START + 1 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.depthMapCpuSrv = PLACEHOLDER_SRV_CPU_START + 2 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.randomVectorMapCpuSrv = PLACEHOLDER_SRV_CPU_START + 3 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.depthPyramidCpuSrv = PLACEHOLDER_SRV_CPU_START + 4 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.depthPyramidCpuUav = PLACEHOLDER_SRV_CPU_START + 5 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.depthPyramidScratchCpuUav = PLACEHOLDER_SRV_CPU_START + 6 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.normalMapGpuSrv = PLACEHOLDER_SRV_GPU_START + 1 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.depthMapGpuSrv = PLACEHOLDER_SRV_GPU_START + 2 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.randomVectorMapGpuSrv = PLACEHOLDER_SRV_GPU_START + 3 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.depthPyramidGpuUav = PLACEHOLDER_SRV_GPU_START + 5 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.normalMapRtv = PLACEHOLDER_RTV_HEAP_START + PLACEHOLDER_NUM_FRAMES * PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.ambientMapRtv = ssao.normalMapRtv + PLACEHOLDER_DESCRIPTOR_SIZE;
+    ssao.normalMapFormat = normalSource == SSAO_NORMALS_FLOAT ? GFX_FORMAT_R16G16B16A16_FLOAT : GFX_FORMAT_R16G16_SNORM;
+    ssao.depthMapFormat = GFX_FORMAT_R24_UNORM_X8_TYPELESS;
+    ssao.randomVectorMapFormat = GFX_FORMAT_R8G8B8A8_UNORM;
+    ssao.ambientMapFormat = GFX_FORMAT_R16_UNORM;
+    ssao.depthPyramidFormat = GFX_FORMAT_R32G32_FLOAT;
+
+    // .. the lighting pass' uav and srv follow the ssao descriptors, its rtv follows the ambient map's ..
+    LightingPassBindings &lighting = frame.lighting;
+    lighting.enabled = useLighting;
+    lighting.cullPipelineState = PLACEHOLDER_LIGHT_CULL_PSO;
+    lighting.forwardPipelineState = PLACEHOLDER_FORWARD_PSO;
+    lighting.compositePipelineState = PLACEHOLDER_LIT_COMPOSITE_PSO;
+    lighting.constants = PLACEHOLDER_GPU_ADDRESS + 0x50000;
+    lighting.lights = PLACEHOLDER_GPU_ADDRESS + 0x60000;
+    lighting.tileLights = PLACEHOLDER_TILE_LIGHTS;
+    lighting.tileLightsAddress = PLACEHOLDER_GPU_ADDRESS + 0x70000;
+    lighting.tileGroups[0] = (width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    lighting.tileGroups[1] = (height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    lighting.tileLightsElements = lighting.tileGroups[0] * lighting.tileGroups[1] * LIGHT_TILE_STRIDE;
+    lighting.litColor = PLACEHOLDER_LIT_COLOR;
+    lighting.tileLightsCpuUav = PLACEHOLDER_SRV_CPU_START + 7 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    lighting.litColorCpuSrv = PLACEHOLDER_SRV_CPU_START + 8 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    lighting.tileLightsGpuUav = PLACEHOLDER_SRV_GPU_START + 7 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    lighting.litColorGpuSrv = PLACEHOLDER_SRV_GPU_START + 8 * PLACEHOLDER_DESCRIPTOR_SIZE;
+    lighting.litColorRtv = ssao.ambientMapRtv + PLACEHOLDER_DESCRIPTOR_SIZE;
+    lighting.litColorFormat = GFX_FORMAT_R16G16B16A16_FLOAT;
+
+    MeshBatchBindings &batches = frame.meshBatches;
+    batches.vertexBuffer = {PLACEHOLDER_GPU_ADDRESS + 0x20000, 31931 * 44, 44};
+    batches.instanceBuffer = PLACEHOLDER_GPU_ADDRESS + 0x30000;
+    batches.indexBuffer = {PLACEHOLDER_GPU_ADDRESS + 0x40000, 60339 * 3 * 4, GFX_FORMAT_R32_UINT};
+    batches.topology = GFX_TOPOLOGY_TRIANGLELIST;
+    batches.commandSignature = PLACEHOLDER_COMMAND_SIGNATURE;
+    batches.argumentBuffer = PLACEHOLDER_INDIRECT_ARGUMENTS;
+    batches.batchCount = batchCount;
+    return frame;
+}
+
+static bool ReadOrReport(const char *path, std::vector<uint8_t> &stream) {
+    if (GfxReadCommandStream(path, stream))
+        return true;
+    fprintf(stderr, "Failed to read command stream %s\n", path);
+    return false;
+}
+
+static void PrintStats(const char *path, const GfxCommandStreamStats &stats) {
+    printf("{\n  \"stream\": \"%s\",\n", path);
+    printf("  \"commands\": %u, \"redundant\": %u, \"draws\": %u, \"dispatches\": %u, \"barriers\": %u, \"zones\": %u,\n",
+           stats.totalCommands, stats.totalRedundant, stats.draws, stats.dispatches, stats.barriers, stats.zones);
+    printf("  \"per_command\": {");
+    bool first = true;
+    for (uint16_t i = 0; i < GFX_CMD_COUNT; ++i) {
+        if (stats.commands[i] == 0)
+            continue;
+        printf("%s\n    \"%s\": {\"calls\": %u, \"redundant\": %u}", first ? "" : ",", GfxCommandName(i),
+               stats.commands[i], stats.redundant[i]);
+        first = false;
+    }
+    printf("\n  }\n}\n");
+}
+
+static void PrintUsage() {
+    fprintf(stderr, "usage: CommandStreamTool record out.gfx [--width W] [--height H] [--batches N] [--no-state-cache] [--gtao]\n"
+                    "                         [--normals float|octahedral|depth] [--lights]\n"
+                    "       CommandStreamTool dump|stats capture.gfx\n"
+                    "       CommandStreamTool diff a.gfx b.gfx\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        PrintUsage();
+        return 1;
+    }
+
+    const char *command = argv[1];
+    if (strcmp(command, "record") == 0) {
+        uint32_t           width = 1200, height = 720, batchCount = 3;
+        bool               useStateCache = true, useGtao = false, useLighting = false;
+        SSAO_NORMAL_SOURCE normalSource = SSAO_NORMALS_FLOAT;
+        for (int i = 3; i < argc; ++i) {
+            bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--width") == 0 && hasValue)
+                width = (uint32_t)atoi(argv[++i]);
+            else if (strcmp(argv[i], "--height") == 0 && hasValue)
+                height = (uint32_t)atoi(argv[++i]);
+            else if (strcmp(argv[i], "--batches") == 0 && hasValue)
+                batchCount = (uint32_t)atoi(argv[++i]);
+            else if (strcmp(argv[i], "--no-state-cache") == 0)
+                useStateCache = false;
+            else if (strcmp(argv[i], "--gtao") == 0)
+                useGtao = true;
+            else if (strcmp(argv[i], "--lights") == 0)
+                useLighting = true;
+            else if (strcmp(argv[i], "--normals") == 0 && hasValue) {
+                const char *source = argv[++i];
+                normalSource = strcmp(source, "octahedral") == 0 ? SSAO_NORMALS_OCTAHEDRAL
+                               : strcmp(source, "depth") == 0    ? SSAO_NORMALS_FROM_DEPTH
+                                                                 : SSAO_NORMALS_FLOAT;
+            }
+        }
+
+        FrameBindings           frame = PlaceholderFrame(width, height, batchCount, useGtao, normalSource, useLighting);
+        GfxRecordingCommandList recorder;
+        GfxStateCache           stateCache(recorder);
+        GfxCommandList         &cmdList = useStateCache ? (GfxCommandList &)stateCache : recorder;
+        RecordSsaoDescriptorWrites(cmdList, frame.ssao);
+        RecordLightingDescriptorWrites(cmdList, frame.lighting);
+        RecordFrame(cmdList, frame);
+        if (!recorder.WriteToFile(argv[2])) {
+            fprintf(stderr, "Failed to write command stream %s\n", argv[2]);
+            return 1;
+        }
+        printf("Recorded %u commands, %zu bytes to %s\n", recorder.commandCount, recorder.stream.size(), argv[2]);
+        if (useStateCache) {
+            for (uint16_t i = 0; i < GFX_CMD_COUNT; ++i) {
+                if (stateCache.stats.dropped[i])
+                    printf("  dropped %u redundant %s\n", stateCache.stats.dropped[i], GfxCommandName(i));
+            }
+        }
+        return 0;
+    }
+
+    if (strcmp(command, "dump") == 0 || strcmp(command, "stats") == 0) {
+        std::vector<uint8_t> stream;
+        if (!ReadOrReport(argv[2], stream))
+            return 1;
+        if (strcmp(command, "dump") == 0)
+            return GfxDisassembleCommandStream(stream.data(), stream.size(), stdout) ? 0 : 1;
+
+        GfxCommandStreamStats stats;
+        bool                  valid = GfxAnalyzeCommandStream(stream.data(), stream.size(), stats);
+        PrintStats(argv[2], stats);
+        return valid ? 0 : 1;
+    }
+
+    if (strcmp(command, "diff") == 0 && argc >= 4) {
+        std::vector<uint8_t> a, b;
+        if (!ReadOrReport(argv[2], a) || !ReadOrReport(argv[3], b))
+            return 1;
+        uint32_t differences = GfxDiffCommandStreams(a.data(), a.size(), b.data(), b.size(), stdout);
+        printf("%u differing commands\n", differences);
+        return differences == 0 ? 0 : 1;
+    }
+
+    PrintUsage();
+    return 1;
+}
@@ -2,8 +2,21 @@
 #define _COMMON_H_
 
 #include <cassert>
+#include <stddef.h>
 #include <stdint.h>
 
+// NOTE(pf): SIMD paths. AVX2 only when the compiler targets it (/arch:AVX2, -mavx2), SSE2 is the x64 baseline
+// and NEON the arm64 one.
+#if defined(__AVX2__)
+#define SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define SIMD_SSE2 1
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON 1
+#endif
+
 inline int Wrap(int x, int xMax) {
     int result = (x + xMax) % xMax;
     return result;
@@ -17,4 +30,12 @@ inline float Max(float a, float b) {
     return a > b ? a : b;
 }
 
+inline float Min(float a, float b) {
+    return a < b ? a : b;
+}
+
+inline float Clamp(float x, float lo, float hi) {
+    return Min(Max(x, lo), hi);
+}
+
 #endif //!_COMMON_H_
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define _COMMON_DX_12_H_
 
 #include "Common.h"
+#include "Mat4.h"
+#include "Platform.h"
 #include <DirectXMath.h>
 #include <DirectXPackedVector.h>
 #include <d3d12.h>
@@ -9,9 +11,9 @@
 #include <d3dx12.h>
 #include <dxgi1_6.h>
 
-#define DX12_HR(a, msg)                       \
-    if (FAILED((a))) {                        \
-        MessageBoxW(0, msg, L"Error", MB_OK); \
+#define DX12_HR(a, msg)           \
+    if (FAILED((a))) {            \
+        PlatformReportError(msg); \
     }
 #define DX12_RELEASE(a) \
     if (a) {            \
@@ -20,19 +22,19 @@
     }
 
 struct Vertex {
-    DirectX::XMFLOAT3 Pos;
-    DirectX::XMFLOAT3 Normal;
-    DirectX::XMFLOAT2 TexC;
-    DirectX::XMFLOAT3 TangentU;
+    Float3 Pos;
+    Float3 Normal;
+    Float2 TexC;
+    Float3 TangentU;
     Vertex() {}
     Vertex(
         float px, float py, float pz,
         float nx, float ny, float nz,
         float tx, float ty, float tz,
-        float u, float v) : Pos(px, py, pz),
-                            Normal(nx, ny, nz),
-                            TangentU(tx, ty, tz),
-                            TexC(u, v) {}
+        float u, float v) : Pos{px, py, pz},
+                            Normal{nx, ny, nz},
+                            TexC{u, v},
+                            TangentU{tx, ty, tz} {}
 };
 
 #endif //!_COMMON_DX_12_H_
\ No newline at end of file
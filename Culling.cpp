@@ -0,0 +1,308 @@
+#include "Culling.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(SIMD_SSE2) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+void CullSphereSoA::Resize(size_t count) {
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    radius.resize(count);
+}
+
+void CullAabbSoA::Resize(size_t count) {
+    centerX.resize(count);
+    centerY.resize(count);
+    centerZ.resize(count);
+    extentX.resize(count);
+    extentY.resize(count);
+    extentZ.resize(count);
+}
+
+void CullAabbSoA::Set(size_t index, const float aabbMin[3], const float aabbMax[3]) {
+    centerX[index] = 0.5f * (aabbMin[0] + aabbMax[0]);
+    centerY[index] = 0.5f * (aabbMin[1] + aabbMax[1]);
+    centerZ[index] = 0.5f * (aabbMin[2] + aabbMax[2]);
+    extentX[index] = 0.5f * (aabbMax[0] - aabbMin[0]);
+    extentY[index] = 0.5f * (aabbMax[1] - aabbMin[1]);
+    extentZ[index] = 0.5f * (aabbMax[2] - aabbMin[2]);
+}
+
+void CullAabbSoA::Get(size_t index, float aabbMin[3], float aabbMax[3]) const {
+    aabbMin[0] = centerX[index] - extentX[index];
+    aabbMin[1] = centerY[index] - extentY[index];
+    aabbMin[2] = centerZ[index] - extentZ[index];
+    aabbMax[0] = centerX[index] + extentX[index];
+    aabbMax[1] = centerY[index] + extentY[index];
+    aabbMax[2] = centerZ[index] + extentZ[index];
+}
+
+void CompactCullAabbs(CullAabbSoA &aabbs, const uint32_t *visibleIndices, size_t count) {
+    // NOTE(pf): Indices increase, so every box moves towards the front over one that is already done with.
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t from = visibleIndices[i];
+        aabbs.centerX[i] = aabbs.centerX[from];
+        aabbs.centerY[i] = aabbs.centerY[from];
+        aabbs.centerZ[i] = aabbs.centerZ[from];
+        aabbs.extentX[i] = aabbs.extentX[from];
+        aabbs.extentY[i] = aabbs.extentY[from];
+        aabbs.extentZ[i] = aabbs.extentZ[from];
+    }
+    aabbs.Resize(count);
+}
+
+static const float *StridedPosition(const float *positions, size_t stride, size_t index) {
+    return (const float *)((const uint8_t *)positions + stride * index);
+}
+
+void ComputeCullBounds(const float *positions, size_t vertexStride, const uint32_t *indices, size_t count, CullBounds &bounds) {
+    for (int k = 0; k < 3; ++k) {
+        bounds.aabbMin[k] = FLT_MAX;
+        bounds.aabbMax[k] = -FLT_MAX;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const float *p = StridedPosition(positions, vertexStride, indices ? indices[i] : i);
+        for (int k = 0; k < 3; ++k) {
+            bounds.aabbMin[k] = Min(bounds.aabbMin[k], p[k]);
+            bounds.aabbMax[k] = Max(bounds.aabbMax[k], p[k]);
+        }
+    }
+
+    // NOTE(pf): Sphere around the box center, tightened to the farthest vertex instead of the box corner.
+    float radiusSq = 0.0f;
+    for (int k = 0; k < 3; ++k)
+        bounds.center[k] = 0.5f * (bounds.aabbMin[k] + bounds.aabbMax[k]);
+    for (size_t i = 0; i < count; ++i) {
+        const float *p = StridedPosition(positions, vertexStride, indices ? indices[i] : i);
+        float        dx = p[0] - bounds.center[0];
+        float        dy = p[1] - bounds.center[1];
+        float        dz = p[2] - bounds.center[2];
+        radiusSq = Max(radiusSq, dx * dx + dy * dy + dz * dz);
+    }
+    bounds.radius = sqrtf(radiusSq);
+}
+
+void TransformAabb(const float aabbMin[3], const float aabbMax[3], const float m[16], float outMin[3], float outMax[3]) {
+    for (int j = 0; j < 3; ++j) {
+        outMin[j] = outMax[j] = m[12 + j];
+        for (int i = 0; i < 3; ++i) {
+            float a = m[i * 4 + j] * aabbMin[i];
+            float b = m[i * 4 + j] * aabbMax[i];
+            outMin[j] += Min(a, b);
+            outMax[j] += Max(a, b);
+        }
+    }
+}
+
+static void NormalizePlane(float *plane) {
+    float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+    for (int i = 0; i < 4; ++i)
+        plane[i] *= invLength;
+}
+
+void BuildCullFrustum(const float m[16], CullFrustum &frustum) {
+    // NOTE(pf): Gribb & Hartmann, with row vectors the planes come from the matrix columns.
+    for (int i = 0; i < 4; ++i) {
+        float c0 = m[i * 4 + 0];
+        float c1 = m[i * 4 + 1];
+        float c2 = m[i * 4 + 2];
+        float c3 = m[i * 4 + 3];
+        frustum.planes[0][i] = c3 + c0; // Left.
+        frustum.planes[1][i] = c3 - c0; // Right.
+        frustum.planes[2][i] = c3 + c1; // Bottom.
+        frustum.planes[3][i] = c3 - c1; // Top.
+        frustum.planes[4][i] = c2;      // Near.
+        frustum.planes[5][i] = c3 - c2; // Far.
+    }
+
+    for (int p = 0; p < 6; ++p)
+        NormalizePlane(frustum.planes[p]);
+}
+
+// NOTE(pf): Sums in the order the SIMD lanes do, so every path gives the same visible set bit for bit.
+static bool SphereInFrustum(const CullFrustum &frustum, float x, float y, float z, float radius) {
+    for (int p = 0; p < 6; ++p) {
+        const float *plane = frustum.planes[p];
+        float        d = x * plane[0] + plane[3];
+        d += y * plane[1];
+        d += z * plane[2];
+        if (!(d >= 0.0f - radius))
+            return false;
+    }
+    return true;
+}
+
+size_t CullSpheres(const CullFrustum &frustum, const CullSphereSoA &spheres, uint32_t *visibleIndices) {
+    return CullSpheres(frustum, spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data(),
+                       spheres.Count(), visibleIndices);
+}
+
+size_t CullSpheres(const CullFrustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                   size_t count, uint32_t *visibleIndices) {
+    size_t visibleCount = 0;
+    size_t i = 0;
+
+    // NOTE(pf): Compaction is branchless, every lane is written and the cursor only advances for
+    // visible lanes, so the output buffer must hold count entries.
+#if defined(SIMD_AVX2)
+    for (; i + 8 <= count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const float *plane = frustum.planes[p];
+            __m256       d = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane[0])), _mm256_set1_ps(plane[3]));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cy, _mm256_set1_ps(plane[1])));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cz, _mm256_set1_ps(plane[2])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negR, _CMP_GE_OQ));
+        }
+        int mask = _mm256_movemask_ps(inside);
+        for (int k = 0; k < 8; ++k) {
+            visibleIndices[visibleCount] = (uint32_t)(i + k);
+            visibleCount += (mask >> k) & 1;
+        }
+    }
+#endif
+#if defined(SIMD_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const float *plane = frustum.planes[p];
+            __m128       d = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane[0])), _mm_set1_ps(plane[3]));
+            d = _mm_add_ps(d, _mm_mul_ps(cy, _mm_set1_ps(plane[1])));
+            d = _mm_add_ps(d, _mm_mul_ps(cz, _mm_set1_ps(plane[2])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int k = 0; k < 4; ++k) {
+            visibleIndices[visibleCount] = (uint32_t)(i + k);
+            visibleCount += (mask >> k) & 1;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        visibleIndices[visibleCount] = (uint32_t)i;
+        visibleCount += SphereInFrustum(frustum, x[i], y[i], z[i], radius[i]) ? 1 : 0;
+    }
+
+    return visibleCount;
+}
+
+size_t CullSpheresScalar(const CullFrustum &frustum, const CullSphereSoA &spheres, uint32_t *visibleIndices) {
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < spheres.Count(); ++i) {
+        visibleIndices[visibleCount] = (uint32_t)i;
+        visibleCount += SphereInFrustum(frustum, spheres.x[i], spheres.y[i], spheres.z[i], spheres.radius[i]) ? 1 : 0;
+    }
+    return visibleCount;
+}
+
+// NOTE(pf): Same order as the SIMD lanes, like SphereInFrustum.
+static bool AabbInFrustum(const CullFrustum &frustum, float cx, float cy, float cz, float ex, float ey, float ez) {
+    for (int p = 0; p < 6; ++p) {
+        const float *plane = frustum.planes[p];
+        float        d = cx * plane[0] + plane[3];
+        d += cy * plane[1];
+        d += cz * plane[2];
+        d += ex * fabsf(plane[0]);
+        d += ey * fabsf(plane[1]);
+        d += ez * fabsf(plane[2]);
+        if (!(d >= 0.0f))
+            return false;
+    }
+    return true;
+}
+
+size_t CullAabbsScalar(const CullFrustum &frustum, const CullAabbSoA &aabbs, uint32_t *visibleIndices) {
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < aabbs.Count(); ++i) {
+        visibleIndices[visibleCount] = (uint32_t)i;
+        visibleCount += AabbInFrustum(frustum, aabbs.centerX[i], aabbs.centerY[i], aabbs.centerZ[i], aabbs.extentX[i],
+                                      aabbs.extentY[i], aabbs.extentZ[i])
+                            ? 1
+                            : 0;
+    }
+    return visibleCount;
+}
+
+size_t CullAabbs(const CullFrustum &frustum, const CullAabbSoA &aabbs, uint32_t *visibleIndices) {
+    const float *cx = aabbs.centerX.data();
+    const float *cy = aabbs.centerY.data();
+    const float *cz = aabbs.centerZ.data();
+    const float *ex = aabbs.extentX.data();
+    const float *ey = aabbs.extentY.data();
+    const float *ez = aabbs.extentZ.data();
+    size_t       count = aabbs.Count();
+    size_t       visibleCount = 0;
+    size_t       i = 0;
+
+    // NOTE(pf): A box is outside a plane when its center is further out than its projected radius |n|.e.
+#if defined(SIMD_AVX2)
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(cx + i);
+        __m256 y = _mm256_loadu_ps(cy + i);
+        __m256 z = _mm256_loadu_ps(cz + i);
+        __m256 extX = _mm256_loadu_ps(ex + i);
+        __m256 extY = _mm256_loadu_ps(ey + i);
+        __m256 extZ = _mm256_loadu_ps(ez + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const float *plane = frustum.planes[p];
+            __m256       d = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane[0])), _mm256_set1_ps(plane[3]));
+            d = _mm256_add_ps(d, _mm256_mul_ps(y, _mm256_set1_ps(plane[1])));
+            d = _mm256_add_ps(d, _mm256_mul_ps(z, _mm256_set1_ps(plane[2])));
+            d = _mm256_add_ps(d, _mm256_mul_ps(extX, _mm256_set1_ps(fabsf(plane[0]))));
+            d = _mm256_add_ps(d, _mm256_mul_ps(extY, _mm256_set1_ps(fabsf(plane[1]))));
+            d = _mm256_add_ps(d, _mm256_mul_ps(extZ, _mm256_set1_ps(fabsf(plane[2]))));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        int mask = _mm256_movemask_ps(inside);
+        for (int k = 0; k < 8; ++k) {
+            visibleIndices[visibleCount] = (uint32_t)(i + k);
+            visibleCount += (mask >> k) & 1;
+        }
+    }
+#endif
+#if defined(SIMD_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(cx + i);
+        __m128 y = _mm_loadu_ps(cy + i);
+        __m128 z = _mm_loadu_ps(cz + i);
+        __m128 extX = _mm_loadu_ps(ex + i);
+        __m128 extY = _mm_loadu_ps(ey + i);
+        __m128 extZ = _mm_loadu_ps(ez + i);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const float *plane = frustum.planes[p];
+            __m128       d = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane[0])), _mm_set1_ps(plane[3]));
+            d = _mm_add_ps(d, _mm_mul_ps(y, _mm_set1_ps(plane[1])));
+            d = _mm_add_ps(d, _mm_mul_ps(z, _mm_set1_ps(plane[2])));
+            d = _mm_add_ps(d, _mm_mul_ps(extX, _mm_set1_ps(fabsf(plane[0]))));
+            d = _mm_add_ps(d, _mm_mul_ps(extY, _mm_set1_ps(fabsf(plane[1]))));
+            d = _mm_add_ps(d, _mm_mul_ps(extZ, _mm_set1_ps(fabsf(plane[2]))));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_setzero_ps()));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int k = 0; k < 4; ++k) {
+            visibleIndices[visibleCount] = (uint32_t)(i + k);
+            visibleCount += (mask >> k) & 1;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        visibleIndices[visibleCount] = (uint32_t)i;
+        visibleCount += AabbInFrustum(frustum, cx[i], cy[i], cz[i], ex[i], ey[i], ez[i]) ? 1 : 0;
+    }
+
+    return visibleCount;
+}
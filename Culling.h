@@ -0,0 +1,72 @@
+#ifndef _CULLING_H_
+#define _CULLING_H_
+
+/* CPU visibility culling over structure-of-arrays bounding volumes.
+ * NOTE(pf): Matrices are row-major with row vectors (v * M), the same convention DirectXMath uses,
+ * so an XMFLOAT4X4 can be passed as &m._11.
+ */
+
+#include "Common.h"
+#include <vector>
+
+struct CullFrustum {
+    // Normalized planes (nx, ny, nz, d), a point p is inside when dot(n, p) + d >= 0.
+    float planes[6][4];
+};
+
+struct CullBounds {
+    float center[3];
+    float radius;
+    float aabbMin[3];
+    float aabbMax[3];
+};
+
+struct CullSphereSoA {
+    void   Resize(size_t count);
+    size_t Count() const { return x.size(); }
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radius;
+};
+
+// NOTE(pf): Boxes are kept as center and half extents, which is what the plane test wants.
+struct CullAabbSoA {
+    void   Resize(size_t count);
+    void   Set(size_t index, const float aabbMin[3], const float aabbMax[3]);
+    void   Get(size_t index, float aabbMin[3], float aabbMax[3]) const;
+    size_t Count() const { return centerX.size(); }
+
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+};
+
+// NOTE(pf): Bounds of the vertices referenced by indices, or of all count vertices when indices is null.
+void ComputeCullBounds(const float *positions, size_t vertexStride, const uint32_t *indices, size_t count, CullBounds &bounds);
+// NOTE(pf): Arvo's method, world is row-major with row vectors.
+void TransformAabb(const float aabbMin[3], const float aabbMax[3], const float world[16], float outMin[3], float outMax[3]);
+
+// NOTE(pf): Extracts the planes from a D3D style (z in [0, 1]) view projection matrix.
+void BuildCullFrustum(const float viewProj[16], CullFrustum &frustum);
+
+// NOTE(pf): Writes the indices of spheres intersecting the frustum to visibleIndices (room for count
+// entries) and returns how many there were. Indices are written in increasing order.
+size_t CullSpheres(const CullFrustum &frustum, const CullSphereSoA &spheres, uint32_t *visibleIndices);
+size_t CullSpheres(const CullFrustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                   size_t count, uint32_t *visibleIndices);
+// NOTE(pf): One sphere at a time, the reference the SIMD paths of CullSpheres have to match exactly.
+size_t CullSpheresScalar(const CullFrustum &frustum, const CullSphereSoA &spheres, uint32_t *visibleIndices);
+size_t CullAabbs(const CullFrustum &frustum, const CullAabbSoA &aabbs, uint32_t *visibleIndices);
+// NOTE(pf): One box at a time, the reference the SIMD paths of CullAabbs have to match exactly.
+size_t CullAabbsScalar(const CullFrustum &frustum, const CullAabbSoA &aabbs, uint32_t *visibleIndices);
+
+// NOTE(pf): Moves the boxes at the count visibleIndices a cull wrote to the front, in order, and drops the rest,
+// so a later stage reads the box of survivor i at i.
+void CompactCullAabbs(CullAabbSoA &aabbs, const uint32_t *visibleIndices, size_t count);
+
+#endif //!_CULLING_H_
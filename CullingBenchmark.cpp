@@ -0,0 +1,483 @@
+/* Checks and times the frustum culling of Culling.h and the masked occlusion buffer, portable so it runs on the
+ * Linux build farm:
+ *   g++ -O2 -std=c++17 -ffp-contract=off CullingBenchmark.cpp Culling.cpp MaskedOcclusionBuffer.cpp Mat4.cpp
+ *       Timer.cpp Platform_Posix.cpp -o CullingBenchmark
+ *   ./CullingBenchmark
+ *
+ * BuildCullFrustum's planes are compared against the closed form ones of the camera, and points just inside and
+ * just outside the view volume of a turned camera have to land on the right side of them. Instance spheres and
+ * boxes scattered around the frustum, a share of them nudged onto its planes, are culled by the SIMD paths of
+ * CullSpheres and CullAabbs and by their scalar references, and the visible sets have to be identical, at counts
+ * that are not a multiple of the lane widths so the SSE2 block and the scalar tail run after the AVX2 loop.
+ * Spheres straddling each plane have to be kept and ones just past it culled. The AVX2 path is compiled in with
+ * -mavx2 (-DEDAN35_AVX2=ON), SSE2 is the x64 baseline, the JSON reports which ran.
+ *
+ * The occlusion buffer is checked to be conservative: with nothing rendered no box on screen is rejected, with
+ * a partial occluder no box in front of it or beside it is rejected while boxes behind its inside are, and
+ * behind a full screen occluder every box is. Chained after the frustum culling, with boxes it rejects in between,
+ * every survivor has to be tested against its own box. Then everything is timed, instances culled per second for the
+ * spheres and objects per second for boxes and occlusion queries. The exit code is 1 if a check fails.
+ */
+
+#include "Culling.h"
+#include "MaskedOcclusionBuffer.h"
+#include "Mat4.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t CHECK_COUNTS[] = {0, 1, 3, 4, 5, 7, 8, 9, 12, 13, 15, 17, 31, 1000, 4099, 65543};
+static constexpr uint32_t TIMING_COUNTS[] = {10000, 100000, 1000000};
+static constexpr uint32_t TIMING_OBJECTS = {20000000}; // Objects culled per timing, spread over iterations.
+static constexpr float    CAMERA_FOV_Y = {60.0f};
+static constexpr float    CAMERA_NEAR = {1.0f};
+static constexpr float    CAMERA_FAR = {100.0f};
+static constexpr float    SCATTER_HALF_SIZE = {80.0f}; // Objects are spread over a box around the frustum..
+static constexpr float    SCATTER_MIN_Z = {-20.0f};
+static constexpr float    SCATTER_MAX_Z = {120.0f};
+static constexpr float    MIN_EXTENT = {0.05f}; // .. with radii or half extents in [min, max).
+static constexpr float    MAX_EXTENT = {4.0f};
+static constexpr uint32_t OCCLUSION_WIDTH = {640};
+static constexpr uint32_t OCCLUSION_HEIGHT = {360};
+static constexpr uint32_t OCCLUSION_BOXES = {10000};
+static constexpr float    OCCLUDER_Z = {30.0f};    // View depth of the occluders..
+static constexpr float    OCCLUDER_HALF_X = {6.0f}; // .. and the half size of the partial one.
+static constexpr float    OCCLUDER_HALF_Y = {4.0f};
+static constexpr float    OCCLUDER_DEPTH_MARGIN = {0.01f};
+static constexpr float    PLANE_TOLERANCE = {1e-5f};
+static constexpr float    NDC_MARGIN = {0.01f}; // How far inside or outside the view volume the plane checks go.
+
+static uint32_t        failures = 0;
+static volatile size_t sink = 0;
+
+static void Check(bool condition, const char *what) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+static float RandomRange(uint32_t &state, float low, float high) {
+    return low + (high - low) * NextRandom(state);
+}
+
+// .. the camera at the origin looking down +z, so view depth is world z ..
+static Mat4 BuildViewProj(uint32_t width, uint32_t height) {
+    const float eye[3] = {0.0f, 0.0f, 0.0f};
+    const float focus[3] = {0.0f, 0.0f, 1.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    Mat4        view = Mat4LookAtLH(eye, focus, up);
+    Mat4        proj = Mat4PerspectiveFovLH(ConvertToRadians(CAMERA_FOV_Y), width / (float)height, CAMERA_NEAR, CAMERA_FAR);
+    return Mat4Multiply(view, proj);
+}
+
+static float PlaneDistance(const float plane[4], const float p[3]) {
+    return plane[0] * p[0] + plane[1] * p[1] + plane[2] * p[2] + plane[3];
+}
+
+static void CheckFrustumPlanes(const CullFrustum &frustum) {
+    // .. planes through the eye at the origin, leaning out by the half fov, and the near and far planes ..
+    float tanHalfY = tanf(ConvertToRadians(CAMERA_FOV_Y) * 0.5f);
+    float tanHalfX = tanHalfY * OCCLUSION_WIDTH / (float)OCCLUSION_HEIGHT;
+    float invX = 1.0f / sqrtf(1.0f + tanHalfX * tanHalfX);
+    float invY = 1.0f / sqrtf(1.0f + tanHalfY * tanHalfY);
+    const float expected[6][4] = {
+        {invX, 0.0f, tanHalfX * invX, 0.0f},  {-invX, 0.0f, tanHalfX * invX, 0.0f},
+        {0.0f, invY, tanHalfY * invY, 0.0f},  {0.0f, -invY, tanHalfY * invY, 0.0f},
+        {0.0f, 0.0f, 1.0f, -CAMERA_NEAR},     {0.0f, 0.0f, -1.0f, CAMERA_FAR},
+    };
+    float maxError = 0.0f;
+    for (int p = 0; p < 6; ++p) {
+        for (int i = 0; i < 4; ++i)
+            maxError = Max(maxError, fabsf(frustum.planes[p][i] - expected[p][i]) / Max(1.0f, fabsf(expected[p][i])));
+    }
+    Check(maxError < PLANE_TOLERANCE, "BuildCullFrustum gives the camera's planes");
+
+    // .. a turned and moved camera, points are unprojected from just inside and just outside each face ..
+    const float eye[3] = {3.0f, 2.0f, -10.0f};
+    const float focus[3] = {-4.0f, 1.0f, 6.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    Mat4        viewProj = Mat4Multiply(Mat4LookAtLH(eye, focus, up),
+                                        Mat4PerspectiveFovLH(ConvertToRadians(CAMERA_FOV_Y), 1.5f, CAMERA_NEAR, CAMERA_FAR));
+    Mat4        inverse;
+    Check(Mat4Inverse(viewProj, inverse), "the turned camera's view projection inverts");
+    CullFrustum turned;
+    BuildCullFrustum(viewProj.m, turned);
+
+    uint32_t state = 5, misplaced = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        float ndc[3] = {RandomRange(state, -1.0f + NDC_MARGIN, 1.0f - NDC_MARGIN),
+                        RandomRange(state, -1.0f + NDC_MARGIN, 1.0f - NDC_MARGIN), RandomRange(state, NDC_MARGIN, 1.0f - NDC_MARGIN)};
+        // .. plane p bounds ndc axis p / 2 from below (even p) or above (odd p), z only from [0, 1] ..
+        int p = i % 7;
+        if (p < 6)
+            ndc[p / 2] = (p & 1) ? 1.0f + NDC_MARGIN : (p < 4 ? -1.0f - NDC_MARGIN : -NDC_MARGIN);
+        const float *m = inverse.m;
+        float        w = ndc[0] * m[3] + ndc[1] * m[7] + ndc[2] * m[11] + m[15];
+        float        world[3];
+        for (int k = 0; k < 3; ++k)
+            world[k] = (ndc[0] * m[k] + ndc[1] * m[4 + k] + ndc[2] * m[8 + k] + m[12 + k]) / w;
+        for (int q = 0; q < 6; ++q) {
+            bool shouldBeOutside = q == p;
+            misplaced += (PlaneDistance(turned.planes[q], world) < 0.0f) != shouldBeOutside;
+        }
+    }
+    Check(misplaced == 0, "points inside the view volume are inside every plane and points past a face outside its plane");
+    printf("\"frustum_plane_error\": %g, ", maxError);
+}
+
+// NOTE(pf): Every fourth sphere is moved along a plane's normal until it touches the plane from outside.
+static void BuildSpheres(uint32_t count, uint32_t seed, const CullFrustum &frustum, CullSphereSoA &spheres) {
+    spheres.Resize(count);
+    uint32_t state = seed;
+    for (uint32_t i = 0; i < count; ++i) {
+        float center[3] = {RandomRange(state, -SCATTER_HALF_SIZE, SCATTER_HALF_SIZE),
+                           RandomRange(state, -SCATTER_HALF_SIZE, SCATTER_HALF_SIZE),
+                           RandomRange(state, SCATTER_MIN_Z, SCATTER_MAX_Z)};
+        float radius = RandomRange(state, MIN_EXTENT, MAX_EXTENT);
+        if ((i & 3) == 0) {
+            const float *plane = frustum.planes[i / 4 % 6];
+            float        d = PlaneDistance(plane, center);
+            for (int k = 0; k < 3; ++k)
+                center[k] -= plane[k] * (d + radius);
+        }
+        spheres.x[i] = center[0];
+        spheres.y[i] = center[1];
+        spheres.z[i] = center[2];
+        spheres.radius[i] = radius;
+    }
+}
+
+static void CheckSpherePaths(const CullFrustum &frustum) {
+    std::vector<uint32_t> simdVisible, scalarVisible;
+    for (size_t c = 0; c < sizeof(CHECK_COUNTS) / sizeof(CHECK_COUNTS[0]); ++c) {
+        uint32_t      count = CHECK_COUNTS[c];
+        CullSphereSoA spheres;
+        BuildSpheres(count, 11 + count, frustum, spheres);
+        simdVisible.assign(count + 1, 0);
+        scalarVisible.assign(count + 1, 0);
+        size_t simdCount = CullSpheres(frustum, spheres, simdVisible.data());
+        size_t scalarCount = CullSpheresScalar(frustum, spheres, scalarVisible.data());
+        bool   identical = simdCount == scalarCount &&
+                         memcmp(simdVisible.data(), scalarVisible.data(), simdCount * sizeof(uint32_t)) == 0;
+        if (!identical)
+            fprintf(stderr, "%u spheres: %zu visible with SIMD, %zu with the scalar reference\n", count, simdCount, scalarCount);
+        Check(identical, "the SIMD paths of CullSpheres give the scalar reference's visible set");
+    }
+}
+
+// .. per plane a sphere straddling it, kept, and one just past it, culled, both next to the middle of the face ..
+static void CheckStraddlingSpheres(const CullFrustum &frustum) {
+    static constexpr float RADIUS = {2.0f};
+    const float            inside[3] = {0.0f, 0.0f, 0.5f * (CAMERA_NEAR + CAMERA_FAR)};
+    CullSphereSoA          spheres;
+    std::vector<bool>      expected;
+    for (int p = 0; p < 6; ++p) {
+        const float *plane = frustum.planes[p];
+        float        d = PlaneDistance(plane, inside);
+        for (float out : {0.5f * RADIUS, 1.5f * RADIUS}) {
+            spheres.x.push_back(inside[0] - plane[0] * (d + out));
+            spheres.y.push_back(inside[1] - plane[1] * (d + out));
+            spheres.z.push_back(inside[2] - plane[2] * (d + out));
+            spheres.radius.push_back(RADIUS);
+            expected.push_back(out < RADIUS);
+        }
+    }
+    // .. and one well inside so the batch is no lane multiple ..
+    spheres.x.push_back(inside[0]);
+    spheres.y.push_back(inside[1]);
+    spheres.z.push_back(inside[2]);
+    spheres.radius.push_back(RADIUS);
+    expected.push_back(true);
+
+    uint32_t visible[16], scalarVisible[16];
+    size_t   count = CullSpheres(frustum, spheres, visible);
+    size_t   scalarCount = CullSpheresScalar(frustum, spheres, scalarVisible);
+    bool     matches = count == scalarCount;
+    size_t   v = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        bool found = v < count && visible[v] == i;
+        matches = matches && found == expected[i] && (!found || scalarVisible[v] == i);
+        v += found ? 1 : 0;
+    }
+    Check(matches && v == count, "spheres straddling a plane are kept and spheres past it culled");
+}
+
+// NOTE(pf): Every fourth box is moved along a plane's normal until its corner lies on the plane, where a path
+// that rounds differently from the reference would disagree.
+static void BuildBoxes(uint32_t count, uint32_t seed, const CullFrustum &frustum, CullAabbSoA &boxes) {
+    boxes.Resize(count);
+    uint32_t state = seed;
+    for (uint32_t i = 0; i < count; ++i) {
+        float center[3] = {RandomRange(state, -SCATTER_HALF_SIZE, SCATTER_HALF_SIZE),
+                           RandomRange(state, -SCATTER_HALF_SIZE, SCATTER_HALF_SIZE),
+                           RandomRange(state, SCATTER_MIN_Z, SCATTER_MAX_Z)};
+        float extent[3] = {RandomRange(state, MIN_EXTENT, MAX_EXTENT), RandomRange(state, MIN_EXTENT, MAX_EXTENT),
+                           RandomRange(state, MIN_EXTENT, MAX_EXTENT)};
+        if ((i & 3) == 0) {
+            const float *plane = frustum.planes[i / 4 % 6];
+            float        d = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+            float        r = fabsf(plane[0]) * extent[0] + fabsf(plane[1]) * extent[1] + fabsf(plane[2]) * extent[2];
+            for (int k = 0; k < 3; ++k)
+                center[k] -= plane[k] * (d + r);
+        }
+        float aabbMin[3], aabbMax[3];
+        for (int k = 0; k < 3; ++k) {
+            aabbMin[k] = center[k] - extent[k];
+            aabbMax[k] = center[k] + extent[k];
+        }
+        boxes.Set(i, aabbMin, aabbMax);
+    }
+}
+
+static void CheckAabbPaths(const CullFrustum &frustum) {
+    std::vector<uint32_t> simdVisible, scalarVisible;
+    for (size_t c = 0; c < sizeof(CHECK_COUNTS) / sizeof(CHECK_COUNTS[0]); ++c) {
+        uint32_t    count = CHECK_COUNTS[c];
+        CullAabbSoA boxes;
+        BuildBoxes(count, 7 + count, frustum, boxes);
+        simdVisible.assign(count + 1, 0);
+        scalarVisible.assign(count + 1, 0);
+        size_t simdCount = CullAabbs(frustum, boxes, simdVisible.data());
+        size_t scalarCount = CullAabbsScalar(frustum, boxes, scalarVisible.data());
+        bool   identical = simdCount == scalarCount &&
+                         memcmp(simdVisible.data(), scalarVisible.data(), simdCount * sizeof(uint32_t)) == 0;
+        if (!identical)
+            fprintf(stderr, "%u boxes: %zu visible with SIMD, %zu with the scalar reference\n", count, simdCount, scalarCount);
+        Check(identical, "the SIMD paths of CullAabbs give the scalar reference's visible set");
+    }
+}
+
+struct ScreenRect {
+    float minX, minY, maxX, maxY;
+    float minDepth; // View depth of the nearest corner.
+};
+
+static ScreenRect ProjectBox(const float aabbMin[3], const float aabbMax[3], const Mat4 &viewProj) {
+    const float *m = viewProj.m;
+    ScreenRect   rect = {1e30f, 1e30f, -1e30f, -1e30f, aabbMin[2]};
+    for (int corner = 0; corner < 8; ++corner) {
+        float p[3] = {(corner & 1) ? aabbMax[0] : aabbMin[0], (corner & 2) ? aabbMax[1] : aabbMin[1],
+                      (corner & 4) ? aabbMax[2] : aabbMin[2]};
+        float cw = p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + m[15];
+        float x = (p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12]) / cw;
+        float y = (p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13]) / cw;
+        x = (x * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+        y = (0.5f - y * 0.5f) * OCCLUSION_HEIGHT;
+        rect.minX = Min(rect.minX, x);
+        rect.maxX = Max(rect.maxX, x);
+        rect.minY = Min(rect.minY, y);
+        rect.maxY = Max(rect.maxY, y);
+    }
+    return rect;
+}
+
+static void RenderQuad(MaskedOcclusionBuffer &buffer, float halfX, float halfY, const Mat4 &viewProj) {
+    const float    positions[] = {-halfX, -halfY, OCCLUDER_Z, halfX, -halfY, OCCLUDER_Z,
+                                  halfX,  halfY,  OCCLUDER_Z, -halfX, halfY, OCCLUDER_Z};
+    const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+    buffer.RenderOccluder(positions, 3 * sizeof(float), indices, 6, viewProj.m);
+}
+
+// .. boxes inside the frustum, in front of the camera so every corner projects ..
+static void BuildOcclusionBoxes(uint32_t count, std::vector<float> &aabbs) {
+    aabbs.resize(count * 6);
+    uint32_t state = 99;
+    float    tanHalfY = tanf(ConvertToRadians(30.0f));
+    float    tanHalfX = tanHalfY * OCCLUSION_WIDTH / (float)OCCLUSION_HEIGHT;
+    for (uint32_t i = 0; i < count; ++i) {
+        float z = RandomRange(state, 5.0f, 90.0f);
+        float center[3] = {RandomRange(state, -tanHalfX, tanHalfX) * z, RandomRange(state, -tanHalfY, tanHalfY) * z, z};
+        float extent = RandomRange(state, 0.1f, 3.0f);
+        for (int k = 0; k < 3; ++k) {
+            aabbs[i * 6 + k] = center[k] - extent;
+            aabbs[i * 6 + 3 + k] = center[k] + extent;
+        }
+    }
+}
+
+static void CheckOcclusion(const Mat4 &viewProj, const std::vector<float> &aabbs) {
+    uint32_t              count = (uint32_t)(aabbs.size() / 6);
+    MaskedOcclusionBuffer buffer;
+    buffer.Initialize(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+
+    uint32_t rejected = 0;
+    for (uint32_t i = 0; i < count; ++i)
+        rejected += !buffer.IsAabbVisible(&aabbs[i * 6], &aabbs[i * 6 + 3], viewProj.m);
+    Check(rejected == 0, "an empty occlusion buffer rejects nothing on screen");
+
+    // .. a partial occluder, boxes clear of it in depth or on screen must pass, boxes well inside it must not ..
+    RenderQuad(buffer, OCCLUDER_HALF_X, OCCLUDER_HALF_Y, viewProj);
+    float      occluderMin[3] = {-OCCLUDER_HALF_X, -OCCLUDER_HALF_Y, OCCLUDER_Z};
+    float      occluderMax[3] = {OCCLUDER_HALF_X, OCCLUDER_HALF_Y, OCCLUDER_Z};
+    ScreenRect occluder = ProjectBox(occluderMin, occluderMax, viewProj);
+    uint32_t   free = 0, freeRejected = 0, hidden = 0, hiddenVisible = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const float *aabbMin = &aabbs[i * 6];
+        const float *aabbMax = &aabbs[i * 6 + 3];
+        ScreenRect   rect = ProjectBox(aabbMin, aabbMax, viewProj);
+        bool         visible = buffer.IsAabbVisible(aabbMin, aabbMax, viewProj.m);
+        bool         inFront = rect.minDepth < OCCLUDER_Z - OCCLUDER_DEPTH_MARGIN;
+        bool         behind = rect.minDepth > OCCLUDER_Z + OCCLUDER_DEPTH_MARGIN;
+        bool beside = rect.maxX < occluder.minX - 1.0f || rect.minX > occluder.maxX + 1.0f || rect.maxY < occluder.minY - 1.0f ||
+                      rect.minY > occluder.maxY + 1.0f;
+        bool inside = rect.minX > occluder.minX + OCCLUSION_TILE_WIDTH && rect.maxX < occluder.maxX - OCCLUSION_TILE_WIDTH &&
+                      rect.minY > occluder.minY + OCCLUSION_TILE_HEIGHT && rect.maxY < occluder.maxY - OCCLUSION_TILE_HEIGHT;
+        if (inFront || beside) {
+            free++;
+            freeRejected += !visible;
+        } else if (behind && inside) {
+            hidden++;
+            hiddenVisible += visible;
+        }
+    }
+    Check(freeRejected == 0, "no box in front of or beside the occluder is rejected");
+    Check(hidden > 0 && hiddenVisible == 0, "boxes behind the inside of the occluder are rejected");
+
+    // .. a full screen occluder hides everything behind it ..
+    buffer.Clear();
+    RenderQuad(buffer, 1000.0f, 1000.0f, viewProj);
+    uint32_t behindFull = 0, behindFullVisible = 0, inFrontFullRejected = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const float *aabbMin = &aabbs[i * 6];
+        const float *aabbMax = &aabbs[i * 6 + 3];
+        bool         visible = buffer.IsAabbVisible(aabbMin, aabbMax, viewProj.m);
+        if (aabbMin[2] > OCCLUDER_Z + OCCLUDER_DEPTH_MARGIN) {
+            behindFull++;
+            behindFullVisible += visible;
+        } else if (aabbMin[2] < OCCLUDER_Z - OCCLUDER_DEPTH_MARGIN) {
+            inFrontFullRejected += !visible;
+        }
+    }
+    Check(behindFull > 0 && behindFullVisible == 0, "every box behind a full screen occluder is rejected");
+    Check(inFrontFullRejected == 0, "no box reaching in front of a full screen occluder is rejected");
+    printf("\"occlusion\": {\"boxes\": %u, \"free\": %u, \"free_rejected\": %u, \"hidden\": %u, \"hidden_visible\": %u, "
+           "\"behind_full_screen\": %u, \"behind_full_screen_visible\": %u}, ",
+           count, free, freeRejected, hidden, hiddenVisible, behindFull, behindFullVisible);
+}
+
+// .. the frustum and occlusion stages chained as CullAndUploadInstances runs them, every third box pushed out of the
+// frustum so the survivors' boxes have to be compacted before the occlusion test reads them ..
+static void CheckCulledOcclusion(const CullFrustum &frustum, const Mat4 &viewProj, const std::vector<float> &aabbs) {
+    uint32_t    count = (uint32_t)(aabbs.size() / 6);
+    CullAabbSoA boxes;
+    boxes.Resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        float aabbMin[3] = {aabbs[i * 6], aabbs[i * 6 + 1], aabbs[i * 6 + 2]};
+        float aabbMax[3] = {aabbs[i * 6 + 3], aabbs[i * 6 + 4], aabbs[i * 6 + 5]};
+        if (i % 3 == 1) {
+            aabbMin[0] += 1000.0f;
+            aabbMax[0] += 1000.0f;
+        }
+        boxes.Set(i, aabbMin, aabbMax);
+    }
+    MaskedOcclusionBuffer buffer;
+    buffer.Initialize(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+    RenderQuad(buffer, OCCLUDER_HALF_X, OCCLUDER_HALF_Y, viewProj);
+
+    std::vector<uint32_t> survivors(count);
+    size_t                survivorCount = CullAabbs(frustum, boxes, survivors.data());
+    std::vector<uint8_t>  expected(count, 0);
+    for (size_t i = 0; i < survivorCount; ++i) {
+        float aabbMin[3], aabbMax[3];
+        boxes.Get(survivors[i], aabbMin, aabbMax);
+        expected[survivors[i]] = buffer.IsAabbVisible(aabbMin, aabbMax, viewProj.m);
+    }
+
+    CompactCullAabbs(boxes, survivors.data(), survivorCount);
+    std::vector<uint8_t> chained(count, 0);
+    uint32_t             occluded = 0;
+    for (size_t i = 0; i < survivorCount; ++i) {
+        float aabbMin[3], aabbMax[3];
+        boxes.Get(i, aabbMin, aabbMax);
+        chained[survivors[i]] = buffer.IsAabbVisible(aabbMin, aabbMax, viewProj.m);
+        occluded += !chained[survivors[i]];
+    }
+    Check(survivorCount < count && occluded > 0 && boxes.Count() == survivorCount,
+          "the frustum rejects the boxes pushed out of it and the occluder some of the rest");
+    Check(chained == expected, "the occlusion stage tests every frustum survivor against its own box");
+}
+
+template <typename F> static double MeasureSeconds(uint32_t iterations, F run) {
+    int64_t start = HiResPerformanceQuery();
+    for (uint32_t i = 0; i < iterations; ++i)
+        run();
+    return HiResSeconds(HiResPerformanceQuery() - start);
+}
+
+int main() {
+    Mat4        viewProj = BuildViewProj(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+    CullFrustum frustum;
+    BuildCullFrustum(viewProj.m, frustum);
+
+#if defined(SIMD_AVX2)
+    const char *paths = "[\"avx2\", \"sse2\", \"scalar\"]";
+#elif defined(SIMD_SSE2)
+    const char *paths = "[\"sse2\", \"scalar\"]";
+#else
+    const char *paths = "[\"scalar\"]";
+#endif
+    printf("{\"benchmark\": \"culling\", \"simd_paths\": %s, ", paths);
+    CheckFrustumPlanes(frustum);
+    CheckSpherePaths(frustum);
+    CheckStraddlingSpheres(frustum);
+    CheckAabbPaths(frustum);
+
+    std::vector<float> occlusionBoxes;
+    BuildOcclusionBoxes(OCCLUSION_BOXES, occlusionBoxes);
+    CheckOcclusion(viewProj, occlusionBoxes);
+    CheckCulledOcclusion(frustum, viewProj, occlusionBoxes);
+
+    printf("\"sphere_runs\": [");
+    std::vector<uint32_t> visible;
+    for (size_t c = 0; c < sizeof(TIMING_COUNTS) / sizeof(TIMING_COUNTS[0]); ++c) {
+        uint32_t      count = TIMING_COUNTS[c];
+        uint32_t      iterations = TIMING_OBJECTS / count;
+        CullSphereSoA spheres;
+        BuildSpheres(count, 5 + count, frustum, spheres);
+        visible.resize(count);
+        size_t visibleCount = 0;
+        double simdSeconds =
+            MeasureSeconds(iterations, [&]() { sink = sink + (visibleCount = CullSpheres(frustum, spheres, visible.data())); });
+        double scalarSeconds = MeasureSeconds(iterations, [&]() { sink = sink + CullSpheresScalar(frustum, spheres, visible.data()); });
+        printf("%s\n  {\"instances\": %u, \"visible\": %zu, \"simd_instances_per_second\": %.0f, "
+               "\"scalar_instances_per_second\": %.0f}",
+               c == 0 ? "" : ",", count, visibleCount, (double)count * iterations / simdSeconds,
+               (double)count * iterations / scalarSeconds);
+    }
+    printf("\n], \"aabb_runs\": [");
+    for (size_t c = 0; c < sizeof(TIMING_COUNTS) / sizeof(TIMING_COUNTS[0]); ++c) {
+        uint32_t    count = TIMING_COUNTS[c];
+        uint32_t    iterations = TIMING_OBJECTS / count;
+        CullAabbSoA boxes;
+        BuildBoxes(count, 3 + count, frustum, boxes);
+        visible.resize(count);
+        size_t visibleCount = 0;
+        double simdSeconds = MeasureSeconds(iterations, [&]() { sink = sink + (visibleCount = CullAabbs(frustum, boxes, visible.data())); });
+        double scalarSeconds = MeasureSeconds(iterations, [&]() { sink = sink + CullAabbsScalar(frustum, boxes, visible.data()); });
+        printf("%s\n  {\"objects\": %u, \"visible\": %zu, \"simd_objects_per_second\": %.0f, \"scalar_objects_per_second\": %.0f}",
+               c == 0 ? "" : ",", count, visibleCount, (double)count * iterations / simdSeconds,
+               (double)count * iterations / scalarSeconds);
+    }
+    printf("\n], ");
+
+    // .. occlusion queries against the partial occluder, the buffer's per object cost ..
+    MaskedOcclusionBuffer buffer;
+    buffer.Initialize(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+    RenderQuad(buffer, OCCLUDER_HALF_X, OCCLUDER_HALF_Y, viewProj);
+    uint32_t iterations = TIMING_OBJECTS / 10 / OCCLUSION_BOXES;
+    double   occlusionSeconds = MeasureSeconds(iterations, [&]() {
+        for (uint32_t i = 0; i < OCCLUSION_BOXES; ++i)
+            sink = sink + buffer.IsAabbVisible(&occlusionBoxes[i * 6], &occlusionBoxes[i * 6 + 3], viewProj.m);
+    });
+    printf("\"occlusion_objects_per_second\": %.0f, \"failures\": %u}\n",
+           (double)OCCLUSION_BOXES * iterations / occlusionSeconds, failures);
+    return failures ? 1 : 0;
+}
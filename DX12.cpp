@@ -1,8 +1,9 @@
 #include "DX12.h"
+#include "MeshCodec.h"
+#include <algorithm>
 #include <array>
 #include <d3dcompiler.h>
 #include <dxgidebug.h>
-#include <fstream>
 #include <iostream>
 
 #pragma comment(lib, "windowscodecs.lib")
@@ -14,6 +15,15 @@ DX12::DX12(const HWND &_hwnd, uint32_t w, uint32_t h) : hwnd(_hwnd),
                                                         viewPort(CD3DX12_VIEWPORT(0.0f, 0.0f, (FLOAT)(w), (FLOAT)(h))) {
     windowWidth = w;
     windowHeight = h;
+    renderWidth = w;
+    renderHeight = h;
+    renderViewPort = viewPort;
+    renderScissorRect = scissorRect;
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+        frameRenderScales[i] = 1.0f;
+    }
+    dynamicResolution.Initialize(DynamicResolutionSettings());
+    memoryBudget.Initialize(MemoryBudgetSettings());
 }
 
 DX12::~DX12() {
@@ -81,11 +91,10 @@ void DX12::Initialize() {
         return;
     }
 
-    IDXGIAdapter4 *adapter4;
-    bestAdapter->QueryInterface(__uuidof(IDXGIAdapter4), (LPVOID *)&adapter4);
+    // NOTE(pf): The adapter is kept for its memory budgets, see UpdateMemoryBudget.
+    bestAdapter->QueryInterface(__uuidof(IDXGIAdapter4), (LPVOID *)&dxgiAdapter);
     // .. create the device..
-    DX12_HR(D3D12CreateDevice(adapter4, MINIMUM_FEATURE_LEVEL, IID_PPV_ARGS(&device)), L"Failed to create a DX12 Device");
-    DX12_RELEASE(adapter4);
+    DX12_HR(D3D12CreateDevice(dxgiAdapter, MINIMUM_FEATURE_LEVEL, IID_PPV_ARGS(&device)), L"Failed to create a DX12 Device");
     DX12_RELEASE(bestAdapter);
 
 #if defined(_DEBUG)
@@ -149,7 +158,7 @@ void DX12::Initialize() {
 
     // .. create the descriptor heap ..
     D3D12_DESCRIPTOR_HEAP_DESC rtv_desc = {};
-    rtv_desc.NumDescriptors = NUM_FRAMES + 2; // Backbuffers, Normal and SSAO map.
+    rtv_desc.NumDescriptors = NUM_FRAMES + 3; // Backbuffers, Normal, SSAO map and lit color.
     rtv_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
     rtv_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     rtv_desc.NodeMask = 0;
@@ -196,100 +205,51 @@ void DX12::Initialize() {
 
     device->CreateDepthStencilView(depthBuffer, &dsv, dsvHeap->GetCPUDescriptorHandleForHeapStart());
 
-    // .. create a mapping to our constant buffer on the gpu ..
-    heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-    auto init_state = CD3DX12_RESOURCE_DESC::Buffer(sizeof(CBConstants));
-    DX12_HR(device->CreateCommittedResource(
-                &heap_prop,
-                D3D12_HEAP_FLAG_NONE,
-                &init_state,
-                D3D12_RESOURCE_STATE_GENERIC_READ,
-                nullptr,
-                IID_PPV_ARGS(&cbConstantUploadBuffer)),
-            L"");
-
-    DX12_HR(cbConstantUploadBuffer->Map(0, nullptr, reinterpret_cast<void **>(&cbDataMapping)), L"");
-
-    // .. load model ..
-    {
-        std::ifstream fin("models/skull.txt");
-
-        UINT        vCount = 0;
-        UINT        tCount = 0;
-        std::string ignore;
-        fin >> ignore >> vCount;
-        fin >> ignore >> tCount;
-        fin >> ignore >> ignore >> ignore >> ignore;
-
-        XMFLOAT3 vMinf3(FLT_MAX, FLT_MAX, FLT_MAX);
-        XMFLOAT3 vMaxf3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
-
-        XMVECTOR vMin = XMLoadFloat3(&vMinf3);
-        XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
-
-        std::vector<Vertex> vertices(vCount);
-        for (UINT i = 0; i < vCount; ++i) {
-            fin >> vertices[i].Pos.x >> vertices[i].Pos.y >> vertices[i].Pos.z;
-            fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
-
-            vertices[i].TexC = {0.0f, 0.0f};
-
-            XMVECTOR P = XMLoadFloat3(&vertices[i].Pos);
-
-            XMVECTOR N = XMLoadFloat3(&vertices[i].Normal);
-
-            XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-            if (fabsf(XMVectorGetX(XMVector3Dot(N, up))) < 1.0f - 0.001f) {
-                XMVECTOR T = XMVector3Normalize(XMVector3Cross(up, N));
-                XMStoreFloat3(&vertices[i].TangentU, T);
-            } else {
-                up = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
-                XMVECTOR T = XMVector3Normalize(XMVector3Cross(N, up));
-                XMStoreFloat3(&vertices[i].TangentU, T);
-            }
-
-            vMin = XMVectorMin(vMin, P);
-            vMax = XMVectorMax(vMax, P);
-        }
-
-        fin >> ignore;
-        fin >> ignore;
-        fin >> ignore;
-
-        std::vector<std::int32_t> indices(3 * tCount);
-        for (UINT i = 0; i < tCount; ++i) {
-            fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
-        }
-
-        fin.close();
+    // .. per frame constants, a slice per frame in flight ..
+    frameConstants.Initialize(device, sizeof(FrameConstants), NUM_FRAMES);
 
-        const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-        const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
-        DX12_HR(D3DCreateBlob(vbByteSize, &renderSkull.vertexBufferCPU), L"Failed to initialize rendermesh vertex buffer");
-        CopyMemory(renderSkull.vertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
+    // .. per frame instance buffers and indirect arguments, one draw per LOD at most ..
+    heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+        auto instanceDesc = CD3DX12_RESOURCE_DESC::Buffer(MAX_MESH_INSTANCES * sizeof(InstanceData));
+        DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &instanceDesc,
+                                                D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&instanceUploadBuffers[i])),
+                L"Failed to create instance buffer.");
+        DX12_HR(instanceUploadBuffers[i]->Map(0, nullptr, reinterpret_cast<void **>(&instanceMappings[i])), L"");
+
+        auto argsDesc = CD3DX12_RESOURCE_DESC::Buffer(MESH_MAX_LODS * sizeof(MeshDrawArguments));
+        DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &argsDesc,
+                                                D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&indirectArgsUploadBuffers[i])),
+                L"Failed to create indirect argument buffer.");
+        DX12_HR(indirectArgsUploadBuffers[i]->Map(0, nullptr, reinterpret_cast<void **>(&indirectArgsMappings[i])), L"");
+    }
 
-        DX12_HR(D3DCreateBlob(ibByteSize, &renderSkull.indexBufferCPU), L"");
-        CopyMemory(renderSkull.indexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+    occlusionBuffer.Initialize(windowWidth / 4, windowHeight / 4);
 
-        renderSkull.vertexBufferGPU = CreateDefaultBuffer(device, commandList, vertices.data(), vbByteSize, &renderSkull.vertexBufferUploader);
+    // .. timestamp queries for the gpu passes ..
+    gpuProfiler.Initialize(device, directCQ->GetCommandQueue(), NUM_FRAMES);
 
-        renderSkull.indexBufferGPU = CreateDefaultBuffer(device, commandList, indices.data(), ibByteSize, &renderSkull.indexBufferUploader);
+    // .. every mesh lives in the geometry buffer ..
+    geometry.Initialize(device, GEOMETRY_VERTEX_CAPACITY, GEOMETRY_INDEX_CAPACITY, GEOMETRY_MAX_MESHES, GEOMETRY_DEFRAG_BYTES);
 
-        renderSkull.vertexByteStride = sizeof(Vertex);
-        renderSkull.vertexBufferByteSize = vbByteSize;
-        renderSkull.indexFormat = DXGI_FORMAT_R32_UINT;
-        renderSkull.indexBufferByteSize = ibByteSize;
-        renderSkull.indexCount = (UINT)indices.size();
-        renderSkull.startIndexLoc = 0;
-        renderSkull.baseVertexLoc = 0;
-    }
+    // .. load model, from the archive if there is one ..
+    assets.Open((PlatformExecutableDirectory() + "assets.pak").c_str());
+    if (!LoadSkull(commandList))
+        PlatformReportError(L"Failed to load the skull.");
 
     CD3DX12_DESCRIPTOR_RANGE ssaoTex;
     ssaoTex.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
-    CD3DX12_ROOT_PARAMETER rootParameters[3];
-    rootParameters[0].InitAsConstantBufferView(0);
-    rootParameters[1].InitAsShaderResourceView(0, 1);
-    rootParameters[2].InitAsDescriptorTable(1, &ssaoTex, D3D12_SHADER_VISIBILITY_PIXEL);
+    CD3DX12_DESCRIPTOR_RANGE litTex;
+    litTex.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 1);
+    CD3DX12_ROOT_PARAMETER rootParameters[8];
+    rootParameters[ROOT_FRAME_CONSTANTS].InitAsConstantBufferView(0);
+    rootParameters[ROOT_INSTANCES].InitAsShaderResourceView(0, 1, D3D12_SHADER_VISIBILITY_VERTEX);
+    rootParameters[ROOT_AMBIENT_MAP].InitAsDescriptorTable(1, &ssaoTex, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[ROOT_DRAW_CONSTANTS].InitAsConstants(1, 1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+    rootParameters[ROOT_LIGHTING].InitAsConstantBufferView(2, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[ROOT_LIGHTS].InitAsShaderResourceView(1, 1, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[ROOT_TILE_LIGHTS].InitAsShaderResourceView(2, 1, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[ROOT_LIT_COLOR].InitAsDescriptorTable(1, &litTex, D3D12_SHADER_VISIBILITY_PIXEL);
 
     CD3DX12_STATIC_SAMPLER_DESC sampler(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR,
                                         D3D12_TEXTURE_ADDRESS_MODE_WRAP,
@@ -308,17 +268,32 @@ void DX12::Initialize() {
     DX12_HR(D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1, &rootSignatureBlob, &errorBlob), L"");
     DX12_HR(device->CreateRootSignature(0, rootSignatureBlob->GetBufferPointer(), rootSignatureBlob->GetBufferSize(), IID_PPV_ARGS(&rootSignature)), L"Failed to create root signature.");
 
+    // .. every indirect draw sets its first instance and then draws ..
+    D3D12_INDIRECT_ARGUMENT_DESC drawArguments[2] = {};
+    drawArguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+    drawArguments[0].Constant.RootParameterIndex = ROOT_DRAW_CONSTANTS;
+    drawArguments[0].Constant.DestOffsetIn32BitValues = 0;
+    drawArguments[0].Constant.Num32BitValuesToSet = 1;
+    drawArguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+    D3D12_COMMAND_SIGNATURE_DESC drawIndexedSignatureDesc = {};
+    drawIndexedSignatureDesc.ByteStride = sizeof(MeshDrawArguments);
+    drawIndexedSignatureDesc.NumArgumentDescs = _countof(drawArguments);
+    drawIndexedSignatureDesc.pArgumentDescs = drawArguments;
+    DX12_HR(device->CreateCommandSignature(&drawIndexedSignatureDesc, rootSignature, IID_PPV_ARGS(&drawIndexedSignature)),
+            L"Failed to create draw indexed command signature.");
+
     // SSAO root:
     CD3DX12_DESCRIPTOR_RANGE texTable0;
     texTable0.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 2, 0, 0);
 
     CD3DX12_DESCRIPTOR_RANGE texTable1;
-    texTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 2, 0);
+    texTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 2, 2, 0);
 
-    CD3DX12_ROOT_PARAMETER ssaoRootParameters[3];
-    ssaoRootParameters[0].InitAsConstantBufferView(0);
-    ssaoRootParameters[1].InitAsDescriptorTable(1, &texTable0, D3D12_SHADER_VISIBILITY_PIXEL);
-    ssaoRootParameters[2].InitAsDescriptorTable(1, &texTable1, D3D12_SHADER_VISIBILITY_PIXEL);
+    CD3DX12_ROOT_PARAMETER ssaoRootParameters[4];
+    ssaoRootParameters[SSAO_ROOT_PASS_CONSTANTS].InitAsConstantBufferView(0);
+    ssaoRootParameters[SSAO_ROOT_NORMAL_DEPTH].InitAsDescriptorTable(1, &texTable0, D3D12_SHADER_VISIBILITY_PIXEL);
+    ssaoRootParameters[SSAO_ROOT_RANDOM_VECTORS].InitAsDescriptorTable(1, &texTable1, D3D12_SHADER_VISIBILITY_PIXEL);
+    ssaoRootParameters[SSAO_ROOT_STATIC_CONSTANTS].InitAsConstantBufferView(1, 0, D3D12_SHADER_VISIBILITY_PIXEL);
 
     CD3DX12_STATIC_SAMPLER_DESC pointClampSampler = {};
     pointClampSampler.ShaderRegister = 0;
@@ -368,122 +343,68 @@ void DX12::Initialize() {
                 IID_PPV_ARGS(&ssaoRootSignature)),
             L"");
 
-    D3D12_DESCRIPTOR_HEAP_DESC srvDesc = {};
-    srvDesc.NumDescriptors = 4;
-    srvDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    srvDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    DX12_HR(device->CreateDescriptorHeap(&srvDesc, IID_PPV_ARGS(&srvDescriptorHeap)), L"");
-    cbvSrvUavDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    // Depth pyramid root, compute only:
+    CD3DX12_DESCRIPTOR_RANGE depthTable;
+    depthTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 1, 0);
 
-#if 0
-    // Vertex Shader:
-    ID3DBlob *ssaoVSBlob;
-    DX12_HR(D3DReadFileToBlob(L"x64/Debug/SSAOVS.cso", &ssaoVSBlob), L"Failed to load vertex shader cso");
-    ID3DBlob *normalsVSBlob;
-    DX12_HR(D3DReadFileToBlob(L"x64/Debug/NormalsVS.cso", &normalsVSBlob), L"Failed to load vertex shader cso");
-    ID3DBlob *drawSSAOVSBlob;
-    DX12_HR(D3DReadFileToBlob(L"x64/Debug/DrawSSAOVS.cso", &drawSSAOVSBlob), L"Failed to load vertex shader cso.");
-    ID3DBlob *ssaoPSBlob;
-    DX12_HR(D3DReadFileToBlob(L"x64/Debug/SSAOPS.cso", &ssaoPSBlob), L"Failed to load pixel shader cso.");
-    ID3DBlob *normalsPSBlob;
-    DX12_HR(D3DReadFileToBlob(L"x64/Debug/NormalsPS.cso", &normalsPSBlob), L"Failed to load pixel shader cso.");
-    ID3DBlob *drawSSAOPSBlob;
-    DX12_HR(D3DReadFileToBlob(L"x64/Debug/DrawSSAOPS.cso", &drawSSAOPSBlob), L"Failed to load pixel shader cso.");
-#else
-    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
-#if defined(DEBUG) || defined(_DEBUG)
-    flags |= D3DCOMPILE_DEBUG;
-#endif
+    CD3DX12_DESCRIPTOR_RANGE pyramidTable;
+    pyramidTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 2, 0, 0);
 
-    ID3DBlob *ssaoVSBlob;
-    ID3DBlob *ssaoPSBlob;
-    ID3DBlob *normalsVSBlob;
-    ID3DBlob *normalsPSBlob;
-    ID3DBlob *drawSSAOVSBlob;
-    ID3DBlob *drawSSAOPSBlob;
-    DX12_HR(D3DCompileFromFile(L"shaders/SSAOVS.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                               "main", "vs_5_1", flags, 0, &ssaoVSBlob, &errorBlob),
-            L"");
-    if (errorBlob != nullptr)
-        OutputDebugStringA((char *)errorBlob->GetBufferPointer());
-    DX12_HR(D3DCompileFromFile(L"shaders/SSAOPS.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                               "main", "ps_5_1", flags, 0, &ssaoPSBlob, &errorBlob),
-            L"");
-    if (errorBlob != nullptr)
-        OutputDebugStringA((char *)errorBlob->GetBufferPointer());
-    DX12_HR(D3DCompileFromFile(L"shaders/NormalsVS.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                               "main", "vs_5_1", flags, 0, &normalsVSBlob, &errorBlob),
+    CD3DX12_ROOT_PARAMETER depthPyramidRootParameters[3];
+    depthPyramidRootParameters[DEPTH_PYRAMID_ROOT_PASS_CONSTANTS].InitAsConstantBufferView(0);
+    depthPyramidRootParameters[DEPTH_PYRAMID_ROOT_DEPTH].InitAsDescriptorTable(1, &depthTable);
+    depthPyramidRootParameters[DEPTH_PYRAMID_ROOT_OUTPUTS].InitAsDescriptorTable(1, &pyramidTable);
+
+    CD3DX12_ROOT_SIGNATURE_DESC depthPyramidRootDesc(_countof(depthPyramidRootParameters), depthPyramidRootParameters);
+    DX12_RELEASE(serializedRootSig);
+    DX12_HR(D3D12SerializeRootSignature(&depthPyramidRootDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+                                        &serializedRootSig, &errorBlob),
             L"");
-    if (errorBlob != nullptr)
-        OutputDebugStringA((char *)errorBlob->GetBufferPointer());
-    DX12_HR(D3DCompileFromFile(L"shaders/NormalsPS.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                               "main", "ps_5_1", flags, 0, &normalsPSBlob, &errorBlob),
+    DX12_HR(device->CreateRootSignature(
+                0,
+                serializedRootSig->GetBufferPointer(),
+                serializedRootSig->GetBufferSize(),
+                IID_PPV_ARGS(&depthPyramidRootSignature)),
             L"");
-    if (errorBlob != nullptr)
-        OutputDebugStringA((char *)errorBlob->GetBufferPointer());
-    DX12_HR(D3DCompileFromFile(L"shaders/DrawSSAOVS.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                               "main", "vs_5_1", flags, 0, &drawSSAOVSBlob, &errorBlob),
+
+    // Light cull root, compute only:
+    CD3DX12_DESCRIPTOR_RANGE cullDepthTable;
+    cullDepthTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0);
+
+    CD3DX12_DESCRIPTOR_RANGE tileLightsTable;
+    tileLightsTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0);
+
+    CD3DX12_ROOT_PARAMETER lightCullRootParameters[4];
+    lightCullRootParameters[LIGHT_CULL_ROOT_LIGHTING].InitAsConstantBufferView(2);
+    lightCullRootParameters[LIGHT_CULL_ROOT_DEPTH].InitAsDescriptorTable(1, &cullDepthTable);
+    lightCullRootParameters[LIGHT_CULL_ROOT_LIGHTS].InitAsShaderResourceView(1, 1);
+    lightCullRootParameters[LIGHT_CULL_ROOT_TILE_LIGHTS].InitAsDescriptorTable(1, &tileLightsTable);
+
+    CD3DX12_ROOT_SIGNATURE_DESC lightCullRootDesc(_countof(lightCullRootParameters), lightCullRootParameters);
+    DX12_RELEASE(serializedRootSig);
+    DX12_HR(D3D12SerializeRootSignature(&lightCullRootDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+                                        &serializedRootSig, &errorBlob),
             L"");
-    if (errorBlob != nullptr)
-        OutputDebugStringA((char *)errorBlob->GetBufferPointer());
-    DX12_HR(D3DCompileFromFile(L"shaders/DrawSSAOPS.hlsl", nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                               "main", "ps_5_1", flags, 0, &drawSSAOPSBlob, &errorBlob),
+    DX12_HR(device->CreateRootSignature(
+                0,
+                serializedRootSig->GetBufferPointer(),
+                serializedRootSig->GetBufferSize(),
+                IID_PPV_ARGS(&lightCullRootSignature)),
             L"");
-    if (errorBlob != nullptr)
-        OutputDebugStringA((char *)errorBlob->GetBufferPointer());
-#endif
 
-    D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
-        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-        {"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-        {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-        {"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-    };
+    // .. ambient, normal, depth, random vectors, depth pyramid, then the pyramid's two uavs, then the tile
+    // lists' uav and the lit color ..
+    D3D12_DESCRIPTOR_HEAP_DESC srvDesc = {};
+    srvDesc.NumDescriptors = 9;
+    srvDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    srvDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    DX12_HR(device->CreateDescriptorHeap(&srvDesc, IID_PPV_ARGS(&srvDescriptorHeap)), L"");
+    cbvSrvUavDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC sharedPSODesc;
-
-    ZeroMemory(&sharedPSODesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
-    sharedPSODesc.InputLayout = {inputLayout, (UINT)_countof(inputLayout)};
-    sharedPSODesc.pRootSignature = rootSignature;
-    sharedPSODesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-    sharedPSODesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
-    sharedPSODesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-    sharedPSODesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
-    sharedPSODesc.SampleMask = UINT_MAX;
-    sharedPSODesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-    sharedPSODesc.NumRenderTargets = 1;
-    sharedPSODesc.RTVFormats[0] = mBackBufferFormat;
-    sharedPSODesc.DSVFormat = mDepthStencilFormat;
-
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC drawSSAOPSODesc = sharedPSODesc;
-    drawSSAOPSODesc.pRootSignature = rootSignature;
-    drawSSAOPSODesc.VS = CD3DX12_SHADER_BYTECODE(drawSSAOVSBlob);
-    drawSSAOPSODesc.PS = CD3DX12_SHADER_BYTECODE(drawSSAOPSBlob);
-    drawSSAOPSODesc.SampleDesc.Count = 1;
-    drawSSAOPSODesc.SampleDesc.Quality = 0;
-    DX12_HR(device->CreateGraphicsPipelineState(&drawSSAOPSODesc, IID_PPV_ARGS(&drawSSAOPSO)), L"");
-
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC normalsPSODesc = sharedPSODesc;
-    normalsPSODesc.VS = CD3DX12_SHADER_BYTECODE(normalsVSBlob);
-    normalsPSODesc.PS = CD3DX12_SHADER_BYTECODE(normalsPSBlob);
-    normalsPSODesc.RTVFormats[0] = DX12SSAOPass::normalMapFormat;
-    normalsPSODesc.SampleDesc.Count = 1;
-    normalsPSODesc.SampleDesc.Quality = 0;
-    normalsPSODesc.DSVFormat = mDepthStencilFormat;
-    DX12_HR(device->CreateGraphicsPipelineState(&normalsPSODesc, IID_PPV_ARGS(&normalPSO)), L"");
-
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC ssaoPSODesc = sharedPSODesc;
-    ssaoPSODesc.InputLayout = {nullptr, 0};
-    ssaoPSODesc.pRootSignature = ssaoRootSignature;
-    ssaoPSODesc.VS = CD3DX12_SHADER_BYTECODE(ssaoVSBlob);
-    ssaoPSODesc.PS = CD3DX12_SHADER_BYTECODE(ssaoPSBlob);
-    ssaoPSODesc.DepthStencilState.DepthEnable = false;
-    ssaoPSODesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
-    ssaoPSODesc.RTVFormats[0] = DX12SSAOPass::ambientMapFormat;
-    ssaoPSODesc.SampleDesc.Count = 1;
-    ssaoPSODesc.SampleDesc.Quality = 0;
-    ssaoPSODesc.DSVFormat = DXGI_FORMAT_UNKNOWN;
-    DX12_HR(device->CreateGraphicsPipelineState(&ssaoPSODesc, IID_PPV_ARGS(&ssaoPSO)), L"");
+    for (uint32_t i = 0; i < FRAME_SHADER_COUNT; ++i)
+        DX12_HR(CompileFrameShader((FRAME_SHADER)i, &shaderBlobs[i]), L"Failed to compile a shader.");
+    for (uint32_t i = 0; i < FRAME_PIPELINE_COUNT; ++i)
+        DX12_HR(CreatePipeline((FRAME_PIPELINE)i, &pipelines[i]), L"Failed to create a pipeline state.");
 
     auto srvCPUDescHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
     auto srvGPUDescHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
@@ -491,95 +412,97 @@ void DX12::Initialize() {
     rtvCPUDescHandle.Offset(NUM_FRAMES, rtvDescriptorSize);
 
     // .. initialize our ssao pass ..
-    ssaoPass.Initialize(device, commandList, windowWidth, windowHeight, viewPort, scissorRect);
+    ssaoPass.Initialize(device, commandList, windowWidth, windowHeight, viewPort, scissorRect, NUM_FRAMES, ssaoNormalSource);
     ssaoPass.BuildDescriptors(depthBuffer, srvCPUDescHandle, srvGPUDescHandle, rtvCPUDescHandle, cbvSrvUavDescriptorSize, rtvDescriptorSize);
-    ssaoPass.SetPSOs(ssaoPSO);
+
+    // .. and the lighting pass, its descriptors follow the ssao pass' 7 srvs and 2 rtvs ..
+    lightingPass.Initialize(device, windowWidth, windowHeight, NUM_FRAMES);
+    lightingPass.BuildDescriptors(CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCPUDescHandle, 7, cbvSrvUavDescriptorSize),
+                                  CD3DX12_GPU_DESCRIPTOR_HANDLE(srvGPUDescHandle, 7, cbvSrvUavDescriptorSize),
+                                  CD3DX12_CPU_DESCRIPTOR_HANDLE(rtvCPUDescHandle, 2, rtvDescriptorSize), cbvSrvUavDescriptorSize);
+    SetPassPipelines();
 
     uint64_t fenceValue = directCQ->ExecuteCommandList(commandList);
+    TrackMemory(fenceValue);
     directCQ->WaitForFenceValue(fenceValue);
 
     Flush();
 
-    DX12_RELEASE(ssaoVSBlob);
-    DX12_RELEASE(drawSSAOVSBlob);
-    DX12_RELEASE(normalsVSBlob);
-    DX12_RELEASE(ssaoPSBlob);
-    DX12_RELEASE(drawSSAOPSBlob);
-    DX12_RELEASE(normalsPSBlob);
     DX12_RELEASE(rootSignatureBlob);
     DX12_RELEASE(errorBlob);
 }
 
-void DX12::UpdateAndRender(DirectX::XMMATRIX modelMatrix, DirectX::XMMATRIX viewMatrix, DirectX::XMMATRIX projectionMatrix) {
+void DX12::UpdateAndRender(const SceneDrawList &drawList, XMMATRIX viewMatrix, XMMATRIX projectionMatrix) {
+    PROFILE_FUNCTION();
     // UPDATE:
 
     auto                        commandQueue = directCQ;
     ID3D12GraphicsCommandList2 *commandList = commandQueue->GetCommandList();
-
-    UploadConstantBuffer(modelMatrix, viewMatrix, projectionMatrix);
-    ssaoPass.UploadConstants(projectionMatrix);
+    gpuProfiler.BeginFrame(commandList, currentBackBufferIndex);
+
+    // NOTE(pf): The frame's working set is marked before the budget updates so it is never evicted only to be
+    // made resident again, a reloaded mesh's upload and the defrag copy into the geometry buffers too.
+    UseMemory(geometryVertexMemory, geometry.vertexBuffer);
+    UseMemory(geometryIndexMemory, geometry.indexBuffer);
+    UseMemory(randomVectorMapMemory, ssaoPass.mRandomVectorMap);
+    UpdateMemoryBudget();
+    if (hotReloadEnabled)
+        UpdateHotReload(commandList);
+
+    // NOTE(pf): Before the draw arguments are built, they read the meshes' new locations.
+    if (geometry.Fragmentation() > GEOMETRY_DEFRAG_THRESHOLD)
+        geometry.Defragment(commandList, GEOMETRY_DEFRAG_BYTES);
+
+    UpdateRenderScale();
+
+    // NOTE(pf): Constants are only rebuilt when their inputs changed and only copied into a frame's slice
+    // when that slice is stale, instance worlds are uploaded every frame.
+    UploadConstantBuffer(viewMatrix, projectionMatrix);
+    // NOTE(pf): The skull is the only mesh so far, its worlds are a contiguous range of the draw list.
+    const SceneDrawBatch *skulls = drawList.FindBatch(DX12_MESH_SKULL);
+    const XMFLOAT4X4     *skullWorlds = skulls ? (const XMFLOAT4X4 *)&drawList.worlds[skulls->firstInstance] : nullptr;
+    UINT                  skullBatchCount = CullAndUploadInstances(renderSkull, skullWorlds, skulls ? skulls->instanceCount : 0,
+                                                                   viewMatrix, projectionMatrix);
+    ssaoPass.SetEngine(ssaoEngine, gtaoQuality);
+    ssaoPass.UploadConstants(projectionMatrix, currentBackBufferIndex);
+    lightingPass.enabled = lightingEnabled && !sceneLights.empty();
+    lightingPass.UploadLights(sceneLights.data(), (UINT)sceneLights.size(), viewMatrix, projectionMatrix, currentBackBufferIndex);
 
     // RENDER:
-    auto                          backBuffer = backBuffers[currentBackBufferIndex];
-    CD3DX12_CPU_DESCRIPTOR_HANDLE rtv(rtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), currentBackBufferIndex, rtvDescriptorSize);
-    auto                          dsv = dsvHeap->GetCPUDescriptorHandleForHeapStart();
-
-    ID3D12DescriptorHeap *descriptorHeaps[] = {srvDescriptorHeap};
-    commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-    commandList->SetGraphicsRootSignature(rootSignature);
-
-    // Draw Normals..
-    commandList->RSSetViewports(1, &viewPort);
-    commandList->RSSetScissorRects(1, &scissorRect);
-
-    auto normalMap = ssaoPass.GetNormalMap();
-    auto normalMapRtv = ssaoPass.GetNormalMapRTV();
-    TransitionResource(commandList, normalMap, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET);
-
-    float clearValue[] = {0.0f, 0.0f, 1.0f, 0.0f};
-    commandList->ClearRenderTargetView(normalMapRtv, clearValue, 0, nullptr);
-    commandList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
-
-    commandList->OMSetRenderTargets(1, &normalMapRtv, true, &dsv);
-    commandList->SetPipelineState(normalPSO);
-    DrawRenderMesh(commandList, renderSkull);
-
-    TransitionResource(commandList, normalMap, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ);
-
-    // .. draw SSAO.
-    commandList->SetGraphicsRootSignature(ssaoRootSignature);
-    ssaoPass.ComputeSsao(commandList);
-
-    commandList->SetGraphicsRootSignature(rootSignature);
-    commandList->RSSetViewports(1, &viewPort);
-    commandList->RSSetScissorRects(1, &scissorRect);
-
-    TransitionResource(commandList, backBuffer, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-
-    float clearColor[] = {0.4f, 0.6f, 0.9f, 1.0f};
-    ClearRTV(commandList, rtv, clearColor);
-
-    commandList->OMSetRenderTargets(1, &rtv, true, &dsv);
-
-    commandList->SetGraphicsRootConstantBufferView(0, cbConstantUploadBuffer->GetGPUVirtualAddress());
-    CD3DX12_GPU_DESCRIPTOR_HANDLE ssaoDescriptor(srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-    ssaoDescriptor.Offset(0, cbvSrvUavDescriptorSize);
-    commandList->SetGraphicsRootDescriptorTable(2, ssaoDescriptor);
-
-    // .. sample ssao onto a fullscreen effect.
-    commandList->SetPipelineState(drawSSAOPSO);
-    commandList->IASetVertexBuffers(0, 0, nullptr);
-    commandList->IASetIndexBuffer(nullptr);
-    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    commandList->DrawInstanced(6, 1, 0, 0);
+    PROFILE_ZONE("Render");
+    FrameBindings      frame = BuildFrameBindings(skullBatchCount);
+    DX12GfxCommandList gfx(device, commandList, &gpuProfiler);
+    GfxStateCache      stateCache(gfx);
+    RecordFrame(stateCache, frame);
+    stateCacheStats = stateCache.stats;
+
+    // NOTE(pf): The capture gets the ssao descriptor writes followed by the frame, handles are renumbered by
+    // the recorder so captures of the same frame compare equal between runs.
+    if (commandCapture && captureNextFrame) {
+        commandCapture->Reset();
+        GfxStateCache captureCache(*commandCapture);
+        RecordSsaoDescriptorWrites(captureCache, frame.ssao);
+        RecordLightingDescriptorWrites(captureCache, frame.lighting);
+        RecordFrame(captureCache, frame);
+        captureNextFrame = false;
+    }
 
-    TransitionResource(commandList, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+    gpuProfiler.EndFrame(commandList);
 
     frameFenceValues[currentBackBufferIndex] = commandQueue->ExecuteCommandList(commandList);
 
-    DX12_HR(swapChain->Present(0, 0), L"Failed to swap back buffers.");
-    currentBackBufferIndex = swapChain->GetCurrentBackBufferIndex();
-    commandQueue->WaitForFenceValue(frameFenceValues[currentBackBufferIndex]);
+    int64_t presentStart = HiResPerformanceQuery();
+    {
+        PROFILE_ZONE("Present");
+        DX12_HR(swapChain->Present(0, 0), L"Failed to swap back buffers.");
+        currentBackBufferIndex = swapChain->GetCurrentBackBufferIndex();
+        commandQueue->WaitForFenceValue(frameFenceValues[currentBackBufferIndex]);
+    }
+    presentWaitMs = HiResMilliseconds(HiResPerformanceQuery() - presentStart);
+
+    // .. the frame that last used this back buffer is done, collect its gpu zones.
+    gpuProfiler.CollectFrame(currentBackBufferIndex);
+    gpuFrameMs = gpuProfiler.lastFrameMs;
 }
 
 void DX12::CleanUp() {
@@ -589,6 +512,33 @@ void DX12::CleanUp() {
     delete directCQ;
     directCQ = nullptr;
 
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+        DX12_RELEASE(instanceUploadBuffers[i]);
+        DX12_RELEASE(indirectArgsUploadBuffers[i]);
+    }
+    DX12_RELEASE(drawIndexedSignature);
+    frameConstants.CleanUp();
+    ssaoPass.CleanUp();
+    lightingPass.CleanUp();
+    gpuProfiler.CleanUp();
+
+    DX12_RELEASE(renderSkull.vertexBufferCPU);
+    DX12_RELEASE(renderSkull.indexBufferCPU);
+    DX12_RELEASE(renderSkull.uploadBuffer);
+    geometry.RemoveMesh(renderSkull);
+    geometry.CleanUp();
+    assets.Close();
+
+    for (uint32_t i = 0; i < FRAME_PIPELINE_COUNT; ++i)
+        DX12_RELEASE(pipelines[i]);
+    for (uint32_t i = 0; i < FRAME_SHADER_COUNT; ++i)
+        DX12_RELEASE(shaderBlobs[i]);
+    for (RetiredObject &retired : retiredObjects)
+        DX12_RELEASE(retired.object);
+    retiredObjects.clear();
+    PlatformCloseDirectoryWatch(shaderWatch);
+    PlatformCloseDirectoryWatch(modelWatch);
+
     DX12_RELEASE(rootSignature);
     DX12_RELEASE(dsvHeap);
     DX12_RELEASE(depthBuffer);
@@ -599,6 +549,7 @@ void DX12::CleanUp() {
     DX12_RELEASE(rtvDescriptorHeap);
     DX12_RELEASE(swapChain);
     DX12_RELEASE(device);
+    DX12_RELEASE(dxgiAdapter);
 }
 
 void DX12::TransitionResource(ID3D12GraphicsCommandList2 *commandList, ID3D12Resource *resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after) {
@@ -658,31 +609,297 @@ ID3D12Resource *DX12::CreateDefaultBuffer(
     return defaultBuffer;
 }
 
+void DX12::TrackMemory(uint64_t uploadFence) {
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+        TrackResource(&backBuffers[i], "BackBuffer", MEMORY_RENDER_TARGET);
+        TrackResource(&instanceUploadBuffers[i], "InstanceUpload", MEMORY_UPLOAD);
+        TrackResource(&indirectArgsUploadBuffers[i], "IndirectArgsUpload", MEMORY_UPLOAD);
+    }
+    TrackResource(&depthBuffer, "DepthBuffer", MEMORY_RENDER_TARGET);
+    TrackResource(&frameConstants.buffer, "FrameConstants", MEMORY_UPLOAD);
+    TrackResource(&gpuProfiler.readbackBuffer, "TimestampReadback", MEMORY_READBACK);
+
+    TrackResource(&ssaoPass.mNormalMap, "NormalMap", MEMORY_RENDER_TARGET);
+    TrackResource(&ssaoPass.mAmbientMap0, "AmbientMap", MEMORY_RENDER_TARGET);
+    TrackResource(&ssaoPass.mDepthPyramid, "DepthPyramid", MEMORY_GPU_BUFFER);
+    TrackResource(&ssaoPass.mDepthPyramidScratch, "DepthPyramidScratch", MEMORY_GPU_BUFFER);
+    randomVectorMapMemory = TrackResource(&ssaoPass.mRandomVectorMap, "RandomVectorMap", MEMORY_TEXTURE, uploadFence);
+    TrackResource(&ssaoPass.mRandomVectorMapUploadBuffer, "RandomVectorMapUpload", MEMORY_STAGING, uploadFence);
+    TrackResource(&ssaoPass.passConstants.buffer, "SsaoPassConstants", MEMORY_UPLOAD);
+    TrackResource(&ssaoPass.staticConstants.buffer, "SsaoStaticConstants", MEMORY_UPLOAD);
+
+    TrackResource(&lightingPass.mLitColor, "LitColor", MEMORY_RENDER_TARGET);
+    TrackResource(&lightingPass.mTileLights, "TileLights", MEMORY_GPU_BUFFER);
+    for (ID3D12Resource *&buffer : lightingPass.lightUploadBuffers)
+        TrackResource(&buffer, "LightUpload", MEMORY_UPLOAD);
+    TrackResource(&lightingPass.constants.buffer, "LightingConstants", MEMORY_UPLOAD);
+
+    geometryVertexMemory = TrackResource(&geometry.vertexBuffer, "GeometryVertices", MEMORY_MESH, uploadFence);
+    geometryIndexMemory = TrackResource(&geometry.indexBuffer, "GeometryIndices", MEMORY_MESH, uploadFence);
+    TrackResource(&geometry.scratchBuffer, "GeometryScratch", MEMORY_GPU_BUFFER);
+    TrackSkullMemory(uploadFence);
+}
+
+void DX12::TrackSkullMemory(uint64_t uploadFence) {
+    TrackResource(&renderSkull.uploadBuffer, "SkullUpload", MEMORY_STAGING, uploadFence);
+    renderSkull.vertexBufferCPUMemory = memoryBudget.Track("SkullVerticesCPU", MEMORY_CPU_SHADOW, renderSkull.vertexBufferCPU->GetBufferSize(),
+                                                           &renderSkull.vertexBufferCPU);
+    renderSkull.indexBufferCPUMemory = memoryBudget.Track("SkullIndicesCPU", MEMORY_CPU_SHADOW, renderSkull.indexBufferCPU->GetBufferSize(),
+                                                          &renderSkull.indexBufferCPU);
+}
+
+uint32_t DX12::TrackResource(ID3D12Resource **resource, const char *name, MEMORY_CATEGORY category, uint64_t fence) {
+    D3D12_RESOURCE_DESC            desc = (*resource)->GetDesc();
+    D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &desc);
+    return memoryBudget.Track(name, category, info.SizeInBytes, resource, fence);
+}
+
+void DX12::UpdateMemoryBudget() {
+    PROFILE_FUNCTION();
+    DXGI_QUERY_VIDEO_MEMORY_INFO info;
+    if (SUCCEEDED(dxgiAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+        memoryBudget.SetOsBudget(MEMORY_SEGMENT_LOCAL, info.Budget);
+    if (SUCCEEDED(dxgiAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &info)))
+        memoryBudget.SetOsBudget(MEMORY_SEGMENT_NON_LOCAL, info.Budget);
+
+    memoryActions.clear();
+    memoryBudget.Update(directCQ->CompletedFenceValue(), memoryActions);
+    for (const MemoryAction &action : memoryActions) {
+        if (action.category == MEMORY_CPU_SHADOW) {
+            ID3DBlob *&blob = *(ID3DBlob **)action.owner;
+            DX12_RELEASE(blob);
+        } else if (action.type == MEMORY_ACTION_RELEASE) {
+            ID3D12Resource *&resource = *(ID3D12Resource **)action.owner;
+            DX12_RELEASE(resource);
+        } else {
+            ID3D12Pageable *pageable = *(ID3D12Resource **)action.owner;
+            DX12_HR(device->Evict(1, &pageable), L"Failed to evict a resource.");
+        }
+    }
+}
+
+void DX12::UseMemory(uint32_t id, ID3D12Resource *resource) {
+    if (memoryBudget.Use(id, directCQ->NextFenceValue())) {
+        ID3D12Pageable *pageable = resource;
+        DX12_HR(device->MakeResident(1, &pageable), L"Failed to make a resource resident.");
+    }
+}
+
 void DX12::LoadContent() {
     // .. fetch our commandqueue ..
     auto commandQueue = directCQ;
     auto commandList = commandQueue->GetCommandList();
 }
 
-void DX12::UploadConstantBuffer(DirectX::XMMATRIX world, DirectX::XMMATRIX view, DirectX::XMMATRIX proj) {
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+void DX12::UpdateRenderScale() {
+    // .. gpuFrameMs belongs to the frame that last used this back buffer, collected after the last present ..
+    if (dynamicResolutionEnabled) {
+        dynamicResolution.Update(gpuFrameMs, frameRenderScales[currentBackBufferIndex]);
+        dynamicResolution.RenderSize(windowWidth, windowHeight, renderWidth, renderHeight);
+        frameRenderScales[currentBackBufferIndex] = dynamicResolution.Scale();
+    } else {
+        renderWidth = windowWidth;
+        renderHeight = windowHeight;
+        frameRenderScales[currentBackBufferIndex] = 1.0f;
+    }
+    renderViewPort = CD3DX12_VIEWPORT(0.0f, 0.0f, (FLOAT)renderWidth, (FLOAT)renderHeight);
+    renderScissorRect = CD3DX12_RECT(0, 0, (LONG)renderWidth, (LONG)renderHeight);
+    ssaoPass.SetRenderSize(renderWidth, renderHeight);
+    lightingPass.SetRenderSize(renderWidth, renderHeight);
+}
 
-    CBConstants constantCB = {};
-    constantCB.World = XMMatrixTranspose(world);
-    constantCB.View = XMMatrixTranspose(view);
-    constantCB.ViewProj = XMMatrixTranspose(viewProj);
-    memcpy(cbDataMapping, &constantCB, sizeof(constantCB));
+void DX12::UploadConstantBuffer(DirectX::XMMATRIX view, DirectX::XMMATRIX proj) {
+    FrameConstants constantCB;
+    XMStoreFloat4x4(&constantCB.View, XMMatrixTranspose(view));
+    XMStoreFloat4x4(&constantCB.ViewProj, XMMatrixTranspose(XMMatrixMultiply(view, proj)));
+    constantCB.RenderScale = XMFLOAT4((float)renderWidth / windowWidth, (float)renderHeight / windowHeight,
+                                      (renderWidth - 0.5f) / windowWidth, (renderHeight - 0.5f) / windowHeight);
+    frameConstants.Write(&constantCB);
+    frameConstants.Upload(currentBackBufferIndex);
 }
 
-void DX12::DrawRenderMesh(ID3D12GraphicsCommandList2 *cmdList, DX12RenderMesh rm) {
+void DX12::DrawRenderMesh(ID3D12GraphicsCommandList2 *cmdList, const DX12RenderMesh &rm) {
 
-    auto vbv = rm.VertexBufferView();
+    auto vbv = geometry.VertexBufferView();
     cmdList->IASetVertexBuffers(0, 1, &vbv);
-    auto ibv = rm.IndexBufferView();
+    auto ibv = geometry.IndexBufferView();
     cmdList->IASetIndexBuffer(&ibv);
     cmdList->IASetPrimitiveTopology(rm.primitiveType);
 
-    cmdList->DrawIndexedInstanced(rm.indexCount, 1, rm.startIndexLoc, rm.baseVertexLoc, 0);
+    const MeshLod &lod = rm.lods[rm.activeLod];
+    cmdList->DrawIndexedInstanced(lod.indexCount, 1, rm.startIndexLoc + lod.startIndexLoc, rm.baseVertexLoc, 0);
+}
+
+UINT DX12::CullAndUploadInstances(const DX12RenderMesh &rm, const XMFLOAT4X4 *instanceWorlds, UINT instanceCount,
+                                  XMMATRIX viewMatrix, XMMATRIX projectionMatrix) {
+    PROFILE_FUNCTION();
+    instanceCount = instanceCount < MAX_MESH_INSTANCES ? instanceCount : MAX_MESH_INSTANCES;
+
+    // .. world space bounding spheres, SoA for the culler ..
+    // NOTE(pf): XMFLOAT4X4 and Mat4 share their layout, the kernel matches XMVector3Transform bit for bit.
+    instanceSpheres.Resize(instanceCount);
+    TransformBoundingSpheres((const Mat4 *)instanceWorlds, instanceCount, rm.bounds.center, rm.bounds.radius,
+                             instanceSpheres.x.data(), instanceSpheres.y.data(), instanceSpheres.z.data(),
+                             instanceSpheres.radius.data());
+
+    XMFLOAT4X4 viewProj;
+    XMStoreFloat4x4(&viewProj, XMMatrixMultiply(viewMatrix, projectionMatrix));
+    CullFrustum frustum;
+    BuildCullFrustum(&viewProj._11, frustum);
+
+    visibleInstances.resize(instanceCount);
+    size_t visibleCount = CullSpheres(frustum, instanceSpheres, visibleInstances.data());
+
+    // .. spheres are loose, refine the survivors with their world space boxes ..
+    visibleInstanceAabbs.Resize(visibleCount);
+    for (size_t i = 0; i < visibleCount; ++i) {
+        float aabbMin[3], aabbMax[3];
+        TransformAabb(rm.bounds.aabbMin, rm.bounds.aabbMax, &instanceWorlds[visibleInstances[i]]._11, aabbMin, aabbMax);
+        visibleInstanceAabbs.Set(i, aabbMin, aabbMax);
+    }
+    visibleAabbSurvivors.resize(visibleCount);
+    size_t aabbVisibleCount = CullAabbs(frustum, visibleInstanceAabbs, visibleAabbSurvivors.data());
+    for (size_t i = 0; i < aabbVisibleCount; ++i) {
+        visibleInstances[i] = visibleInstances[visibleAabbSurvivors[i]];
+    }
+    // NOTE(pf): The occlusion test reads the boxes by the same compacted index as visibleInstances.
+    CompactCullAabbs(visibleInstanceAabbs, visibleAabbSurvivors.data(), aabbVisibleCount);
+    visibleCount = aabbVisibleCount;
+
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&proj, projectionMatrix);
+    XMFLOAT4X4 view;
+    XMStoreFloat4x4(&view, viewMatrix);
+    float fovY = 2.0f * atanf(1.0f / proj._22);
+
+    visibleInstanceDistances.resize(visibleCount);
+    for (size_t i = 0; i < visibleCount; ++i) {
+        uint32_t instance = visibleInstances[i];
+        float    viewZ = instanceSpheres.x[instance] * view._13 + instanceSpheres.y[instance] * view._23 +
+                         instanceSpheres.z[instance] * view._33 + view._43;
+        visibleInstanceDistances[i] = Max(viewZ - instanceSpheres.radius[instance], 1e-3f);
+    }
+
+    // .. occlusion, the nearest instances occlude the rest ..
+    // NOTE(pf): Without the cpu copies, dropped to stay within the cpu budget, there is nothing to rasterize.
+    if (occlusionCulling && visibleCount > 1 && rm.vertexBufferCPU && rm.indexBufferCPU) {
+        PROFILE_ZONE("OcclusionCulling");
+        memoryBudget.Use(rm.vertexBufferCPUMemory, directCQ->NextFenceValue());
+        memoryBudget.Use(rm.indexBufferCPUMemory, directCQ->NextFenceValue());
+        occlusionBuffer.Clear();
+
+        UINT occluderCount = visibleCount < MAX_OCCLUDERS ? (UINT)visibleCount : MAX_OCCLUDERS;
+        occluderOrder.resize(visibleCount);
+        for (size_t i = 0; i < visibleCount; ++i)
+            occluderOrder[i] = (uint32_t)i;
+        std::partial_sort(occluderOrder.begin(), occluderOrder.begin() + occluderCount, occluderOrder.end(),
+                          [this](uint32_t l, uint32_t r) { return visibleInstanceDistances[l] < visibleInstanceDistances[r]; });
+
+        const float    *positions = (const float *)rm.vertexBufferCPU->GetBufferPointer();
+        const uint32_t *indices = (const uint32_t *)rm.indexBufferCPU->GetBufferPointer();
+        for (UINT i = 0; i < occluderCount; ++i) {
+            uint32_t   visible = occluderOrder[i];
+            UINT       lod = rm.SelectLod(visibleInstanceDistances[visible], fovY, (float)occlusionBuffer.height);
+            XMFLOAT4X4 modelViewProj;
+            XMStoreFloat4x4(&modelViewProj, XMMatrixMultiply(XMLoadFloat4x4(&instanceWorlds[visibleInstances[visible]]),
+                                                             XMLoadFloat4x4(&viewProj)));
+            occlusionBuffer.RenderOccluder(positions, rm.vertexByteStride, indices + rm.lods[lod].startIndexLoc,
+                                           rm.lods[lod].indexCount, &modelViewProj._11);
+        }
+
+        size_t occlusionVisibleCount = 0;
+        for (size_t i = 0; i < visibleCount; ++i) {
+            float aabbMin[3], aabbMax[3];
+            visibleInstanceAabbs.Get(i, aabbMin, aabbMax);
+            if (occlusionBuffer.IsAabbVisible(aabbMin, aabbMax, &viewProj._11)) {
+                visibleInstances[occlusionVisibleCount] = visibleInstances[i];
+                visibleInstanceDistances[occlusionVisibleCount] = visibleInstanceDistances[i];
+                occlusionVisibleCount++;
+            }
+        }
+        visibleCount = occlusionVisibleCount;
+    }
+
+    // .. pick a LOD per visible instance from its projected error and count the buckets ..
+    UINT lodCounts[MESH_MAX_LODS] = {};
+    visibleInstanceLods.resize(visibleCount);
+    for (size_t i = 0; i < visibleCount; ++i) {
+        UINT lod = rm.SelectLod(visibleInstanceDistances[i], fovY, (float)renderHeight);
+        visibleInstanceLods[i] = (uint8_t)lod;
+        lodCounts[lod]++;
+    }
+
+    // .. one indirect draw per non-empty LOD, instances written contiguously per bucket ..
+    UINT                          lodOffsets[MESH_MAX_LODS];
+    UINT                          batchCount = 0;
+    UINT                          offset = 0;
+    MeshDrawArguments *args = (MeshDrawArguments *)indirectArgsMappings[currentBackBufferIndex];
+    for (UINT lod = 0; lod < rm.lodCount; ++lod) {
+        lodOffsets[lod] = offset;
+        if (lodCounts[lod] == 0)
+            continue;
+
+        MeshDrawArguments &arg = args[batchCount++];
+        arg.InstanceOffset = offset;
+        arg.Draw.IndexCountPerInstance = rm.lods[lod].indexCount;
+        arg.Draw.InstanceCount = lodCounts[lod];
+        arg.Draw.StartIndexLocation = rm.startIndexLoc + rm.lods[lod].startIndexLoc;
+        arg.Draw.BaseVertexLocation = rm.baseVertexLoc;
+        arg.Draw.StartInstanceLocation = 0;
+        offset += lodCounts[lod];
+    }
+
+    InstanceData *instances = instanceMappings[currentBackBufferIndex];
+    for (size_t i = 0; i < visibleCount; ++i) {
+        const XMFLOAT4X4 &world = instanceWorlds[visibleInstances[i]];
+        InstanceData     &instance = instances[lodOffsets[visibleInstanceLods[i]]++];
+        instance.World[0] = XMFLOAT4(world._11, world._21, world._31, world._41);
+        instance.World[1] = XMFLOAT4(world._12, world._22, world._32, world._42);
+        instance.World[2] = XMFLOAT4(world._13, world._23, world._33, world._43);
+    }
+
+    return batchCount;
+}
+
+MeshBatchBindings DX12::MeshBatches(const DX12RenderMesh &rm, UINT batchCount) const {
+    MeshBatchBindings result = {};
+    // NOTE(pf): Every mesh shares the geometry buffer, the state cache drops the rebinds between meshes.
+    result.vertexBuffer = GfxVertexBufferViewOf(geometry.VertexBufferView());
+    result.instanceBuffer = instanceUploadBuffers[currentBackBufferIndex]->GetGPUVirtualAddress();
+    result.indexBuffer = GfxIndexBufferViewOf(geometry.IndexBufferView());
+    result.topology = (uint32_t)rm.primitiveType;
+    result.commandSignature = GfxHandleOf(drawIndexedSignature);
+    result.argumentBuffer = GfxHandleOf(indirectArgsUploadBuffers[currentBackBufferIndex]);
+    result.batchCount = batchCount;
+    return result;
+}
+
+FrameBindings DX12::BuildFrameBindings(UINT skullBatchCount) const {
+    CD3DX12_CPU_DESCRIPTOR_HANDLE rtv(rtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart(), currentBackBufferIndex, rtvDescriptorSize);
+    CD3DX12_GPU_DESCRIPTOR_HANDLE ssaoDescriptor(srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    ssaoDescriptor.Offset(0, cbvSrvUavDescriptorSize);
+
+    FrameBindings result = {};
+    result.descriptorHeap = GfxHandleOf(srvDescriptorHeap);
+    result.rootSignature = GfxHandleOf(rootSignature);
+    result.ssaoRootSignature = GfxHandleOf(ssaoRootSignature);
+    result.depthPyramidRootSignature = GfxHandleOf(depthPyramidRootSignature);
+    result.lightCullRootSignature = GfxHandleOf(lightCullRootSignature);
+    result.normalPipelineState = GfxHandleOf(pipelines[FRAME_PIPELINE_NORMALS]);
+    result.compositePipelineState = GfxHandleOf(pipelines[FRAME_PIPELINE_DRAW_SSAO]);
+    result.viewport = GfxViewportOf(viewPort);
+    result.scissorRect = GfxRectOf(scissorRect);
+    result.renderViewport = GfxViewportOf(renderViewPort);
+    result.renderScissorRect = GfxRectOf(renderScissorRect);
+    result.backBuffer = GfxHandleOf(backBuffers[currentBackBufferIndex]);
+    result.backBufferRtv = GfxHandleOf(rtv);
+    result.dsv = GfxHandleOf(dsvHeap->GetCPUDescriptorHandleForHeapStart());
+    result.frameConstants = frameConstants.Address(currentBackBufferIndex);
+    result.ambientMapGpuSrv = GfxHandleOf(ssaoDescriptor);
+    result.meshBatches = MeshBatches(renderSkull, skullBatchCount);
+    result.ssao = ssaoPass.Bindings();
+    result.lighting = lightingPass.Bindings();
+    return result;
 }
 
 void DX12::Flush() {
@@ -690,4 +907,299 @@ void DX12::Flush() {
 }
 
 void DX12::CreateShadersAndPSOs() {
-}
\ No newline at end of file
+}
+
+// NOTE(pf): The shaders only include their neighbours by file name, an include lives as long as the compile.
+struct ArchiveShaderInclude : ID3DInclude {
+    const AssetArchive               *archive = nullptr;
+    std::vector<std::vector<uint8_t>> reads;
+
+    HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR fileName, LPCVOID, LPCVOID *data, UINT *bytes) override {
+        const AssetEntry *entry = archive->Find(("shaders/" + NormalizeAssetName(fileName)).c_str());
+        if (!entry)
+            return E_FAIL;
+        *data = archive->View(*entry);
+        if (!*data) {
+            reads.emplace_back();
+            if (!archive->Read(*entry, reads.back(), nullptr))
+                return E_FAIL;
+            *data = reads.back().data();
+        }
+        *bytes = (UINT)entry->size;
+        return S_OK;
+    }
+    HRESULT __stdcall Close(LPCVOID) override { return S_OK; }
+};
+
+HRESULT DX12::CompileShader(const char *name, const D3D_SHADER_MACRO *defines, const char *target, UINT flags,
+                            ID3DBlob **blob, ID3DBlob **errorBlob) {
+    std::string       path = std::string("shaders/") + name;
+    const AssetEntry *entry = assets.Find(path.c_str());
+    if (!entry) {
+        std::wstring widePath(path.begin(), path.end());
+        return D3DCompileFromFile(widePath.c_str(), defines, D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", target, flags, 0,
+                                  blob, errorBlob);
+    }
+
+    ArchiveShaderInclude include;
+    include.archive = &assets;
+    std::vector<uint8_t> source;
+    if (!assets.Read(*entry, source, nullptr))
+        return E_FAIL;
+    return D3DCompile(source.data(), source.size(), path.c_str(), defines, &include, "main", target, flags, 0, blob,
+                      errorBlob);
+}
+HRESULT DX12::CompileFrameShader(FRAME_SHADER shader, ID3DBlob **blob) {
+    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#if defined(DEBUG) || defined(_DEBUG)
+    flags |= D3DCOMPILE_DEBUG;
+#endif
+    // .. the shaders reading or writing normals are built for ssaoNormalSource, see NormalEncoding.hlsl ..
+    char                   normalSourceValue[2] = {(char)('0' + ssaoNormalSource), 0};
+    const D3D_SHADER_MACRO normalSourceDefines[] = {{"SSAO_NORMAL_SOURCE", normalSourceValue}, {nullptr, nullptr}};
+
+    const FrameShaderDesc &desc = FRAME_SHADERS[shader];
+    ID3DBlob              *errorBlob = nullptr;
+    HRESULT hr = CompileShader(desc.file, desc.normalSource ? normalSourceDefines : nullptr, desc.target, flags, blob, &errorBlob);
+    if (errorBlob != nullptr)
+        OutputDebugStringA((char *)errorBlob->GetBufferPointer());
+    DX12_RELEASE(errorBlob);
+    return hr;
+}
+
+HRESULT DX12::CreatePipeline(FRAME_PIPELINE pipeline, ID3D12PipelineState **pso) {
+    const FramePipelineDesc &desc = FRAME_PIPELINES[pipeline];
+    ID3DBlob                *first = shaderBlobs[desc.shaders[0]];
+    ID3DBlob                *second = desc.shaderCount > 1 ? shaderBlobs[desc.shaders[1]] : nullptr;
+
+    if (pipeline == FRAME_PIPELINE_DEPTH_PYRAMID || pipeline == FRAME_PIPELINE_LIGHT_CULL) {
+        D3D12_COMPUTE_PIPELINE_STATE_DESC computePSODesc = {};
+        computePSODesc.pRootSignature = pipeline == FRAME_PIPELINE_DEPTH_PYRAMID ? depthPyramidRootSignature : lightCullRootSignature;
+        computePSODesc.CS = CD3DX12_SHADER_BYTECODE(first);
+        return device->CreateComputePipelineState(&computePSODesc, IID_PPV_ARGS(pso));
+    }
+
+    D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+        {"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+        {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+        {"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+    };
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc;
+
+    ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
+    psoDesc.InputLayout = {inputLayout, (UINT)_countof(inputLayout)};
+    psoDesc.pRootSignature = rootSignature;
+    psoDesc.VS = CD3DX12_SHADER_BYTECODE(first);
+    psoDesc.PS = CD3DX12_SHADER_BYTECODE(second);
+    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = mBackBufferFormat;
+    psoDesc.DSVFormat = mDepthStencilFormat;
+    psoDesc.SampleDesc.Count = 1;
+    psoDesc.SampleDesc.Quality = 0;
+
+    switch (pipeline) {
+    case FRAME_PIPELINE_NORMALS:
+        psoDesc.RTVFormats[0] = DX12SSAOPass::NormalMapFormat(ssaoNormalSource);
+        if (ssaoNormalSource == SSAO_NORMALS_FROM_DEPTH) {
+            // NOTE(pf): Depth only, SSAO reconstructs the normals from it.
+            psoDesc.PS = {nullptr, 0};
+            psoDesc.NumRenderTargets = 0;
+            psoDesc.RTVFormats[0] = DXGI_FORMAT_UNKNOWN;
+        }
+        break;
+    case FRAME_PIPELINE_FORWARD:
+        // .. the forward pass draws the meshes again over the prepass depth, without writing it ..
+        psoDesc.RTVFormats[0] = DX12LightingPass::litColorFormat;
+        psoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+        psoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+        break;
+    case FRAME_PIPELINE_SSAO:
+    case FRAME_PIPELINE_GTAO:
+        // .. GTAO shares the fullscreen quad, root signature and targets ..
+        psoDesc.InputLayout = {nullptr, 0};
+        psoDesc.pRootSignature = ssaoRootSignature;
+        psoDesc.DepthStencilState.DepthEnable = false;
+        psoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+        psoDesc.RTVFormats[0] = DX12SSAOPass::ambientMapFormat;
+        psoDesc.DSVFormat = DXGI_FORMAT_UNKNOWN;
+        break;
+    default:
+        // .. the composites draw to the back buffer ..
+        break;
+    }
+    return device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(pso));
+}
+
+void DX12::SetPassPipelines() {
+    ssaoPass.SetPSOs(pipelines[FRAME_PIPELINE_SSAO], pipelines[FRAME_PIPELINE_GTAO], pipelines[FRAME_PIPELINE_DEPTH_PYRAMID]);
+    lightingPass.SetPSOs(pipelines[FRAME_PIPELINE_LIGHT_CULL], pipelines[FRAME_PIPELINE_FORWARD], pipelines[FRAME_PIPELINE_DRAW_LIT]);
+}
+
+bool DX12::LoadSkull(ID3D12GraphicsCommandList2 *cmdList) {
+    MeshData             mesh;
+    std::vector<uint8_t> meshData;
+    const AssetEntry    *meshEntry = assets.Find("models/skull.mesh");
+    bool loaded = meshEntry && assets.Read(*meshEntry, meshData, nullptr) && DecodeMesh(meshData.data(), meshData.size(), mesh, nullptr);
+    if (!loaded && !LoadTextMesh("models/skull.txt", mesh))
+        return false;
+
+    std::vector<Vertex> vertices(mesh.vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i].Pos = {mesh.vertices[i].position[0], mesh.vertices[i].position[1], mesh.vertices[i].position[2]};
+        vertices[i].Normal = {mesh.vertices[i].normal[0], mesh.vertices[i].normal[1], mesh.vertices[i].normal[2]};
+        vertices[i].TexC = {0.0f, 0.0f};
+
+        XMVECTOR N = XMLoadFloat3((const XMFLOAT3 *)&vertices[i].Normal);
+
+        XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+        if (fabsf(XMVectorGetX(XMVector3Dot(N, up))) < 1.0f - 0.001f) {
+            XMVECTOR T = XMVector3Normalize(XMVector3Cross(up, N));
+            XMStoreFloat3((XMFLOAT3 *)&vertices[i].TangentU, T);
+        } else {
+            up = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+            XMVECTOR T = XMVector3Normalize(XMVector3Cross(N, up));
+            XMStoreFloat3((XMFLOAT3 *)&vertices[i].TangentU, T);
+        }
+    }
+    const std::vector<uint32_t> &indices = mesh.indices;
+
+    // NOTE(pf): The old allocations are freed once the new ones exist, a mesh that does not fit keeps the old one.
+    // Frames still reading them were submitted before the copy into their place.
+    DX12RenderMesh previous;
+    previous.vertexAllocation = renderSkull.vertexAllocation;
+    previous.indexAllocation = renderSkull.indexAllocation;
+    if (!geometry.AddMesh(cmdList, vertices.data(), (UINT)vertices.size(), indices.data(), (UINT)indices.size(),
+                          renderSkull, &renderSkull.uploadBuffer)) {
+        PlatformReportError(L"The skull does not fit the geometry buffer.");
+        return false;
+    }
+    geometry.RemoveMesh(previous);
+
+    // .. bounds and the LOD chain come with the mesh ..
+    renderSkull.bounds = mesh.bounds;
+    renderSkull.lodCount = mesh.lodCount;
+    memcpy(renderSkull.lods, mesh.lods, sizeof(mesh.lods));
+
+    const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
+    const UINT ibByteSize = (UINT)indices.size() * sizeof(uint32_t);
+    DX12_RELEASE(renderSkull.vertexBufferCPU);
+    DX12_HR(D3DCreateBlob(vbByteSize, &renderSkull.vertexBufferCPU), L"Failed to initialize rendermesh vertex buffer");
+    CopyMemory(renderSkull.vertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
+
+    DX12_RELEASE(renderSkull.indexBufferCPU);
+    DX12_HR(D3DCreateBlob(ibByteSize, &renderSkull.indexBufferCPU), L"");
+    CopyMemory(renderSkull.indexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+
+    renderSkull.vertexByteStride = sizeof(Vertex);
+    renderSkull.indexCount = renderSkull.lods[0].indexCount;
+    return true;
+}
+
+void DX12::EnableHotReload() {
+    if (hotReloadEnabled)
+        return;
+    // NOTE(pf): Rebuilds read the loose files, what came from the archive is replaced once its file changes.
+    assets.Close();
+    if (!PlatformWatchDirectory("shaders", shaderWatch) || !PlatformWatchDirectory("models", modelWatch)) {
+        PlatformReportError(L"Failed to watch shaders and models, hot reload is off.");
+        PlatformCloseDirectoryWatch(shaderWatch);
+        return;
+    }
+
+    std::vector<std::string> names;
+    PlatformListDirectory("shaders", names);
+    for (const std::string &name : names)
+        hotReload.AddFile(("shaders/" + name).c_str());
+    for (uint32_t file = 0; file < (uint32_t)hotReload.files.size(); ++file)
+        hotReload.ScanIncludes(file);
+
+    // .. target ids are the pipelines, the skull comes last ..
+    for (uint32_t p = 0; p < FRAME_PIPELINE_COUNT; ++p) {
+        uint32_t target = hotReload.AddTarget();
+        for (uint32_t s = 0; s < FRAME_PIPELINES[p].shaderCount; ++s) {
+            std::string path = std::string("shaders/") + FRAME_SHADERS[FRAME_PIPELINES[p].shaders[s]].file;
+            hotReload.AddDependency(target, hotReload.AddFile(path.c_str()));
+        }
+    }
+    skullTarget = hotReload.AddTarget();
+    hotReload.AddDependency(skullTarget, hotReload.AddFile("models/skull.txt"));
+    hotReloadEnabled = true;
+}
+
+void DX12::UpdateHotReload(ID3D12GraphicsCommandList2 *cmdList) {
+    PROFILE_FUNCTION();
+    // .. objects retired by earlier reloads go once the frames using them are done ..
+    for (size_t i = 0; i < retiredObjects.size();) {
+        if (directCQ->IsFenceComplete(retiredObjects[i].fence)) {
+            DX12_RELEASE(retiredObjects[i].object);
+            retiredObjects[i] = retiredObjects.back();
+            retiredObjects.pop_back();
+        } else {
+            ++i;
+        }
+    }
+
+    double timeMs = HiResMilliseconds(HiResPerformanceQuery());
+    changedNames.clear();
+    PlatformPollDirectoryWatch(shaderWatch, changedNames);
+    for (const std::string &name : changedNames)
+        hotReload.FileChanged(("shaders/" + name).c_str(), timeMs);
+    changedNames.clear();
+    PlatformPollDirectoryWatch(modelWatch, changedNames);
+    for (const std::string &name : changedNames)
+        hotReload.FileChanged(("models/" + name).c_str(), timeMs);
+
+    if (!hotReload.Collect(timeMs, hotReloadBatch))
+        return;
+    for (uint32_t file : hotReloadBatch.changed) {
+        if (hotReload.files[file].name.compare(0, 8, "shaders/") == 0)
+            hotReload.ScanIncludes(file);
+    }
+
+    // .. recompile the shaders of dirty files, a shader that fails keeps its last blob ..
+    const uint64_t lastFence = directCQ->NextFenceValue() - 1;
+    for (uint32_t s = 0; s < FRAME_SHADER_COUNT; ++s) {
+        std::string path = std::string("shaders/") + FRAME_SHADERS[s].file;
+        if (!std::binary_search(hotReloadBatch.dirty.begin(), hotReloadBatch.dirty.end(), hotReload.FindFile(path.c_str())))
+            continue;
+        ID3DBlob *blob = nullptr;
+        if (FAILED(CompileFrameShader((FRAME_SHADER)s, &blob)))
+            continue;
+        DX12_RELEASE(shaderBlobs[s]);
+        shaderBlobs[s] = blob;
+    }
+
+    // .. and rebuild the pipelines using them, the old ones are retired until the gpu is past them ..
+    for (uint32_t target : hotReloadBatch.targets) {
+        if (target == skullTarget)
+            continue;
+        ID3D12PipelineState *pso = nullptr;
+        if (FAILED(CreatePipeline((FRAME_PIPELINE)target, &pso)))
+            continue;
+        retiredObjects.push_back({pipelines[target], lastFence});
+        pipelines[target] = pso;
+    }
+    SetPassPipelines();
+
+    if (std::binary_search(hotReloadBatch.targets.begin(), hotReloadBatch.targets.end(), skullTarget)) {
+        // NOTE(pf): One upload at a time, a change that comes in while the last one is in flight waits for it.
+        bool shadowsLive[2] = {renderSkull.vertexBufferCPU != nullptr, renderSkull.indexBufferCPU != nullptr};
+        if (renderSkull.uploadBuffer) {
+            hotReload.FileChanged("models/skull.txt", timeMs);
+        } else if (LoadSkull(cmdList)) {
+            if (shadowsLive[0])
+                memoryBudget.Untrack(renderSkull.vertexBufferCPUMemory);
+            if (shadowsLive[1])
+                memoryBudget.Untrack(renderSkull.indexBufferCPUMemory);
+            TrackSkullMemory(directCQ->NextFenceValue());
+        }
+    }
+}
@@ -5,19 +5,57 @@
  * SOURCE: https://www.3dgep.com/learning-directx-12-1
  */
 
+#include "AssetArchive.h"
 #include "Common_DX12.h"
+#include "Culling.h"
+#include "DX12ConstantBuffer.h"
+#include "DX12GeometryBuffer.h"
+#include "DX12GfxCommandList.h"
+#include "DX12GpuProfiler.h"
+#include "DX12LightingPass.h"
 #include "DX12RenderMesh.h"
 #include "DX12SSAOPass.h"
+#include "DynamicResolution.h"
+#include "FramePasses.h"
+#include "GfxRecorder.h"
+#include "GfxStateCache.h"
+#include "HotReload.h"
+#include "MaskedOcclusionBuffer.h"
+#include "MemoryBudget.h"
+#include "Scene.h"
+#include "Timer.h"
 
 #include "DX12CommandQueue.h"
 
 static constexpr uint8_t           NUM_FRAMES = {3};
 static constexpr D3D_FEATURE_LEVEL MINIMUM_FEATURE_LEVEL = D3D_FEATURE_LEVEL::D3D_FEATURE_LEVEL_12_1;
+static constexpr UINT              MAX_MESH_INSTANCES = {16384};
+static constexpr UINT              MAX_OCCLUDERS = {16};
+static constexpr uint32_t          DX12_MESH_SKULL = {0}; // Scene mesh id of renderSkull.
+static constexpr UINT              GEOMETRY_VERTEX_CAPACITY = {1u << 20};
+static constexpr UINT              GEOMETRY_INDEX_CAPACITY = {1u << 22};
+static constexpr UINT              GEOMETRY_MAX_MESHES = {4096};
+static constexpr UINT64            GEOMETRY_DEFRAG_BYTES = {4ull << 20}; // Moved per frame at most, also the scratch size.
+static constexpr float             GEOMETRY_DEFRAG_THRESHOLD = {0.5f};   // Of DX12GeometryBuffer::Fragmentation.
 
-struct CBConstants {
-    DirectX::XMMATRIX World;
-    DirectX::XMMATRIX View;
-    DirectX::XMMATRIX ViewProj;
+// NOTE(pf): cbFrame in Common.hlsl, world transforms travel per instance.
+struct FrameConstants {
+    DirectX::XMFLOAT4X4 View;
+    DirectX::XMFLOAT4X4 ViewProj;
+    DirectX::XMFLOAT4   RenderScale; // xy rendered part of the targets, zw largest uv the composite samples.
+};
+
+// NOTE(pf): Read from a structured buffer in NormalsVS. Instance worlds are affine, so only their first
+// three columns are stored, as rows: 48 bytes per instance instead of 64.
+struct InstanceData {
+    DirectX::XMFLOAT4 World[3];
+};
+
+// NOTE(pf): SV_InstanceID does not include StartInstanceLocation, so the command signature also sets the
+// batch's first instance as the ROOT_DRAW_CONSTANTS root constant.
+struct MeshDrawArguments {
+    UINT                         InstanceOffset;
+    D3D12_DRAW_INDEXED_ARGUMENTS Draw;
 };
 
 struct DX12 {
@@ -26,9 +64,28 @@ struct DX12 {
 
     void Initialize();
     void CreateShadersAndPSOs();
-    void UploadConstantBuffer(DirectX::XMMATRIX world, DirectX::XMMATRIX view, DirectX::XMMATRIX viewProj);
-    void DrawRenderMesh(ID3D12GraphicsCommandList2 *commandList, DX12RenderMesh rm);
-    void UpdateAndRender(DirectX::XMMATRIX modelMatrix,
+    // NOTE(pf): Compiles shaders/<name> from the archive, includes resolve to its neighbours there. Without an
+    // archive, or when it lacks the shader, from the loose file.
+    HRESULT CompileShader(const char *name, const D3D_SHADER_MACRO *defines, const char *target, UINT flags,
+                          ID3DBlob **blob, ID3DBlob **errorBlob);
+    HRESULT CompileFrameShader(FRAME_SHADER shader, ID3DBlob **blob);
+    // NOTE(pf): From the current shaderBlobs, the caller owns the pipeline state.
+    HRESULT CreatePipeline(FRAME_PIPELINE pipeline, ID3D12PipelineState **pso);
+    void    SetPassPipelines();
+    // NOTE(pf): Records the upload of the skull into cmdList and replaces the previous one. False when it could not
+    // be loaded or does not fit, the previous one stays.
+    bool LoadSkull(ID3D12GraphicsCommandList2 *cmdList);
+    // NOTE(pf): Watches shaders/ and models/ from now on and rebuilds what their changes reach, see HotReload.h.
+    void EnableHotReload();
+    void UpdateHotReload(ID3D12GraphicsCommandList2 *cmdList);
+    void UpdateRenderScale();
+    void UploadConstantBuffer(DirectX::XMMATRIX view, DirectX::XMMATRIX proj);
+    void DrawRenderMesh(ID3D12GraphicsCommandList2 *commandList, const DX12RenderMesh &rm);
+    UINT CullAndUploadInstances(const DX12RenderMesh &rm, const DirectX::XMFLOAT4X4 *instanceWorlds, UINT instanceCount,
+                                DirectX::XMMATRIX viewMatrix, DirectX::XMMATRIX projectionMatrix);
+    MeshBatchBindings MeshBatches(const DX12RenderMesh &rm, UINT batchCount) const;
+    FrameBindings     BuildFrameBindings(UINT skullBatchCount) const;
+    void UpdateAndRender(const SceneDrawList &drawList,
                          DirectX::XMMATRIX viewMatrix,
                          DirectX::XMMATRIX projectionMatrix);
     void CleanUp();
@@ -40,11 +97,19 @@ struct DX12 {
     void ClearDepth(ID3D12GraphicsCommandList2 *commandList, D3D12_CPU_DESCRIPTOR_HANDLE dsv, float depth = 1.0f);
     void LoadContent();
     void Flush();
+    // NOTE(pf): Tracks everything Initialize created, uploadFence is the submission of its copies.
+    void TrackMemory(uint64_t uploadFence);
+    void TrackSkullMemory(uint64_t uploadFence);
+    uint32_t TrackResource(ID3D12Resource **resource, const char *name, MEMORY_CATEGORY category, uint64_t fence = 0);
+    // NOTE(pf): Reads the OS budgets and carries out what the memory budget asks for.
+    void UpdateMemoryBudget();
+    void UseMemory(uint32_t id, ID3D12Resource *resource);
 
     ID3D12Resource *CreateDefaultBuffer(ID3D12Device *device, ID3D12GraphicsCommandList *cmdList, const void *initData, UINT64 byteSize, ID3D12Resource **uploadBuffer);
 
     const HWND           &hwnd;
     uint32_t              windowWidth, windowHeight;
+    IDXGIAdapter4        *dxgiAdapter = {nullptr};
     ID3D12Device5        *device = {nullptr};
     IDXGISwapChain4      *swapChain = {nullptr};
     ID3D12DescriptorHeap *rtvDescriptorHeap = {nullptr};
@@ -59,17 +124,95 @@ struct DX12 {
     D3D12_VIEWPORT        viewPort;
     D3D12_RECT            scissorRect;
     ID3D12RootSignature  *ssaoRootSignature = {nullptr};
+    ID3D12RootSignature  *depthPyramidRootSignature = {nullptr};
+    ID3D12RootSignature  *lightCullRootSignature = {nullptr};
     DX12CommandQueue     *directCQ;
+    AssetArchive          assets; // assets.pak next to the executable, closed when missing.
+    DX12GeometryBuffer    geometry;
+    uint32_t              geometryVertexMemory = {0};
+    uint32_t              geometryIndexMemory = {0};
     DX12RenderMesh        renderSkull;
     ID3D12DescriptorHeap *srvDescriptorHeap;
     DX12SSAOPass          ssaoPass;
-    ID3D12PipelineState  *normalPSO;
-    ID3D12PipelineState  *ssaoPSO;
-    ID3D12PipelineState  *drawSSAOPSO;
+    ID3D12PipelineState  *pipelines[FRAME_PIPELINE_COUNT] = {};
+    ID3DBlob             *shaderBlobs[FRAME_SHADER_COUNT] = {}; // Kept for the pipelines rebuilt by hot reload.
     DXGI_FORMAT           mBackBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
     DXGI_FORMAT           mDepthStencilFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
-    ID3D12Resource       *cbConstantUploadBuffer;
-    BYTE                 *cbDataMapping = nullptr;
+    DX12ConstantBuffer    frameConstants;
+
+    // NOTE(pf): Instances are culled on the CPU and bucketed per LOD, every bucket is one indirect draw.
+    ID3D12CommandSignature *drawIndexedSignature = {nullptr};
+    ID3D12Resource         *instanceUploadBuffers[NUM_FRAMES] = {};
+    InstanceData           *instanceMappings[NUM_FRAMES] = {};
+    ID3D12Resource         *indirectArgsUploadBuffers[NUM_FRAMES] = {};
+    BYTE                   *indirectArgsMappings[NUM_FRAMES] = {};
+    CullSphereSoA           instanceSpheres;
+    std::vector<uint32_t>   visibleInstances;
+    std::vector<uint8_t>    visibleInstanceLods;
+    std::vector<float>      visibleInstanceDistances;
+    CullAabbSoA             visibleInstanceAabbs;
+    std::vector<uint32_t>   visibleAabbSurvivors;
+
+    // NOTE(pf): The nearest visible instances are rasterized into a low resolution buffer at the LOD that
+    // is accurate to one of its pixels, then every visible instance's box is tested against it.
+    MaskedOcclusionBuffer occlusionBuffer;
+    bool                  occlusionCulling = {false};
+    std::vector<uint32_t> occluderOrder;
+
+    // NOTE(pf): Gpu zones are read back once the fence of their back buffer has passed, so gpuFrameMs
+    // lags NUM_FRAMES frames behind.
+    DX12GpuProfiler gpuProfiler;
+    double          gpuFrameMs = {0.0};
+    double          presentWaitMs = {0.0};
+
+    // NOTE(pf): The targets keep the window's size, dynamic resolution only renders into part of them. The
+    // controller is fed every gpu time along with the scale its frame was rendered at.
+    DynamicResolution dynamicResolution;
+    bool              dynamicResolutionEnabled = {true};
+    float             frameRenderScales[NUM_FRAMES];
+    uint32_t          renderWidth, renderHeight;
+    D3D12_VIEWPORT    renderViewPort;
+    D3D12_RECT        renderScissorRect;
+
+    // NOTE(pf): Hemisphere SSAO or GTAO at one of its presets, picked up by the next frame.
+    SSAO_ENGINE  ssaoEngine = {SSAO_ENGINE_HEMISPHERE};
+    GTAO_QUALITY gtaoQuality = {GTAO_QUALITY_MEDIUM};
+    // NOTE(pf): Fixed at Initialize, the normal pass, its target and the SSAO shaders are built for it.
+    SSAO_NORMAL_SOURCE ssaoNormalSource = {SSAO_NORMALS_FLOAT};
+
+    // NOTE(pf): Tiled forward+ lighting over the ambient map, the lights are in world space. Without lights or
+    // with lighting off the composite shows the ambient map.
+    DX12LightingPass        lightingPass;
+    std::vector<PointLight> sceneLights;
+    bool                    lightingEnabled = {true};
+
+    // NOTE(pf): Every resource and cpu copy by category, see MemoryBudget.h. The configured budgets are capped by
+    // what DXGI grants the process.
+    MemoryBudget              memoryBudget;
+    std::vector<MemoryAction> memoryActions;
+    uint32_t                  randomVectorMapMemory = {0};
+
+    // NOTE(pf): Passes bind everything they use, the state cache drops what is already bound.
+    GfxStateCacheStats stateCacheStats;
+
+    // NOTE(pf): Off unless enabled, see EnableHotReload. Replaced pipelines are released once the fence of the
+    // last frame that may have used them has passed, no frame waits for a reload.
+    struct RetiredObject {
+        IUnknown *object;
+        uint64_t  fence;
+    };
+    bool                       hotReloadEnabled = {false};
+    HotReloadTracker           hotReload;
+    HotReloadBatch             hotReloadBatch;
+    PlatformDirectoryWatch     shaderWatch;
+    PlatformDirectoryWatch     modelWatch;
+    uint32_t                   skullTarget = {HOT_RELOAD_NONE};
+    std::vector<std::string>   changedNames;
+    std::vector<RetiredObject> retiredObjects;
+
+    // NOTE(pf): When set, the next frame is also recorded into commandCapture, see GfxRecorder.h.
+    GfxRecordingCommandList *commandCapture = {nullptr};
+    bool                     captureNextFrame = {false};
 };
 
 #endif //!_DX12_H_
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "DX12CommandQueue.h"
 #include "Common_DX12.h"
-#include <BaseTsd.h>
 
 DX12CommandQueue::DX12CommandQueue(ID3D12Device5 *device, D3D12_COMMAND_LIST_TYPE type) : device(device), commandListType(type), fenceValue(0) {
     D3D12_COMMAND_QUEUE_DESC desc = {};
@@ -12,8 +11,8 @@ DX12CommandQueue::DX12CommandQueue(ID3D12Device5 *device, D3D12_COMMAND_LIST_TYP
     DX12_HR(device->CreateCommandQueue(&desc, IID_PPV_ARGS(&commandQueue)), L"Failed to create command queue");
     DX12_HR(device->CreateFence(fenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)), L"Failed to create a fence.");
 
-    fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
-    assert(fenceEvent && "Failed to create fence event.");
+    bool eventCreated = PlatformCreateEvent(fenceEvent);
+    assert(eventCreated && "Failed to create fence event.");
 }
 
 DX12CommandQueue::~DX12CommandQueue() {
@@ -30,7 +29,7 @@ DX12CommandQueue::~DX12CommandQueue() {
         commandAllocatorQueue.pop();
     }
 
-    ::CloseHandle(fenceEvent);
+    PlatformDestroyEvent(fenceEvent);
     DX12_RELEASE(fence);
     DX12_RELEASE(commandQueue);
 }
@@ -45,12 +44,20 @@ bool DX12CommandQueue::IsFenceComplete(uint64_t fenceValue) {
     return fence->GetCompletedValue() >= fenceValue;
 }
 
-static constexpr DWORD SOME_MAGIC_WAIT_VALUE = {100000};
+uint64_t DX12CommandQueue::CompletedFenceValue() {
+    return fence->GetCompletedValue();
+}
+
+uint64_t DX12CommandQueue::NextFenceValue() const {
+    return fenceValue + 1;
+}
+
+static constexpr uint32_t SOME_MAGIC_WAIT_VALUE = {100000};
 
 void DX12CommandQueue::WaitForFenceValue(uint64_t fenceValue) {
     if (!IsFenceComplete(fenceValue)) {
-        fence->SetEventOnCompletion(fenceValue, fenceEvent);
-        ::WaitForSingleObject(fenceEvent, SOME_MAGIC_WAIT_VALUE);
+        fence->SetEventOnCompletion(fenceValue, (HANDLE)fenceEvent.handle);
+        PlatformWaitEvent(fenceEvent, SOME_MAGIC_WAIT_VALUE);
     }
 }
 
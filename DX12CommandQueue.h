@@ -1,6 +1,7 @@
 #ifndef _DX12_COMMAND_QUEUE_H_
 #define _DX12_COMMAND_QUEUE_H_
 
+#include "Platform.h"
 #include <d3d12.h>
 #include <queue>
 
@@ -10,6 +11,9 @@ class DX12CommandQueue {
     ~DX12CommandQueue();
     uint64_t                    Signal();
     bool                        IsFenceComplete(uint64_t fenceValue);
+    uint64_t                    CompletedFenceValue();
+    // NOTE(pf): The value the next Signal or ExecuteCommandList will signal.
+    uint64_t                    NextFenceValue() const;
     void                        WaitForFenceValue(uint64_t fenceValue);
     void                        Flush();
     ID3D12GraphicsCommandList2 *GetCommandList(ID3D12PipelineState *init_state = nullptr);
@@ -30,7 +34,7 @@ class DX12CommandQueue {
     ID3D12Device5              *device;
     ID3D12CommandQueue         *commandQueue;
     ID3D12Fence                *fence;
-    HANDLE                      fenceEvent;
+    PlatformEvent               fenceEvent;
     uint64_t                    fenceValue;
     CommandAllocatorQueue       commandAllocatorQueue;
     CommandListQueue            commandListQueue;
@@ -0,0 +1,48 @@
+#include "DX12ConstantBuffer.h"
+#include <string.h>
+
+void DX12ConstantBuffer::Initialize(ID3D12Device *device, UINT _size, UINT sliceCount) {
+    const UINT alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+    size = _size;
+    sliceSize = (_size + alignment - 1) & ~(alignment - 1);
+    version = 0;
+    sliceVersions.assign(sliceCount, 0);
+    contents.assign(_size, 0);
+
+    auto heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer((UINT64)sliceSize * sliceCount);
+    DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+                                            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer)),
+            L"Failed to create constant buffer.");
+    DX12_HR(buffer->Map(0, nullptr, reinterpret_cast<void **>(&mapping)), L"");
+}
+
+bool DX12ConstantBuffer::Write(const void *data) {
+    // NOTE(pf): Version 0 is never uploaded, the first write always counts as a change.
+    if (version != 0 && memcmp(contents.data(), data, size) == 0)
+        return false;
+    memcpy(contents.data(), data, size);
+    version++;
+    return true;
+}
+
+void DX12ConstantBuffer::Upload(UINT slice) {
+    assert(slice < sliceVersions.size() && "Constant buffer slice out of range.");
+    assert(version != 0 && "Constant buffer uploaded before it was written.");
+    if (sliceVersions[slice] == version)
+        return;
+    memcpy(mapping + (size_t)slice * sliceSize, contents.data(), size);
+    sliceVersions[slice] = version;
+    uploads++;
+}
+
+uint64_t DX12ConstantBuffer::Address(UINT slice) const {
+    return buffer ? buffer->GetGPUVirtualAddress() + (uint64_t)slice * sliceSize : 0;
+}
+
+void DX12ConstantBuffer::CleanUp() {
+    if (buffer)
+        buffer->Unmap(0, nullptr);
+    mapping = nullptr;
+    DX12_RELEASE(buffer);
+}
@@ -0,0 +1,31 @@
+#ifndef _DX12_CONSTANT_BUFFER_H_
+#define _DX12_CONSTANT_BUFFER_H_
+
+#include "Common_DX12.h"
+#include <vector>
+
+/* Constants in an upload heap, one 256 byte aligned slice per frame in flight so the cpu never writes a
+ * slice the gpu may still be reading.
+ *
+ * NOTE(pf): Write keeps the contents on the cpu and only bumps the version when they changed. Upload copies
+ * them into a slice when that slice holds an older version, so constants that stay the same are copied once
+ * per slice and then never again.
+ */
+struct DX12ConstantBuffer {
+    void     Initialize(ID3D12Device *device, UINT size, UINT sliceCount);
+    bool     Write(const void *data); // Returns true when the contents changed.
+    void     Upload(UINT slice);
+    uint64_t Address(UINT slice) const;
+    void     CleanUp();
+
+    ID3D12Resource       *buffer = {nullptr};
+    BYTE                 *mapping = {nullptr};
+    UINT                  size = {0};
+    UINT                  sliceSize = {0};
+    uint32_t              version = {0};
+    std::vector<uint32_t> sliceVersions;
+    std::vector<uint8_t>  contents;
+    uint32_t              uploads = {0}; // Slice copies so far, stays flat while nothing changes.
+};
+
+#endif //!_DX12_CONSTANT_BUFFER_H_
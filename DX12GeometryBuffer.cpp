@@ -0,0 +1,195 @@
+#include "DX12GeometryBuffer.h"
+
+void DX12GeometryBuffer::Initialize(ID3D12Device *_device, UINT vertexCapacity, UINT indexCapacity, UINT maxMeshes, UINT64 scratchBytes) {
+    device = _device;
+    scratchSize = scratchBytes;
+    vertexAllocator.Initialize(vertexCapacity, maxMeshes);
+    indexAllocator.Initialize(indexCapacity, maxMeshes);
+    vertexOwners.assign(vertexAllocator.nodes.size(), nullptr);
+    indexOwners.assign(indexAllocator.nodes.size(), nullptr);
+
+    auto heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    auto vertexDesc = CD3DX12_RESOURCE_DESC::Buffer((UINT64)vertexCapacity * sizeof(Vertex));
+    DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &vertexDesc,
+                                            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&vertexBuffer)),
+            L"Failed to create the geometry vertex buffer.");
+    auto indexDesc = CD3DX12_RESOURCE_DESC::Buffer((UINT64)indexCapacity * sizeof(uint32_t));
+    DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &indexDesc,
+                                            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&indexBuffer)),
+            L"Failed to create the geometry index buffer.");
+    auto scratchDesc = CD3DX12_RESOURCE_DESC::Buffer(scratchBytes);
+    DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &scratchDesc,
+                                            D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&scratchBuffer)),
+            L"Failed to create the geometry scratch buffer.");
+}
+
+void DX12GeometryBuffer::CleanUp() {
+    DX12_RELEASE(vertexBuffer);
+    DX12_RELEASE(indexBuffer);
+    DX12_RELEASE(scratchBuffer);
+}
+
+bool DX12GeometryBuffer::AddMesh(ID3D12GraphicsCommandList *cmdList, const Vertex *vertices, UINT vertexCount, const uint32_t *indices,
+                                 UINT indexCount, DX12RenderMesh &mesh, ID3D12Resource **uploadBuffer) {
+    uint32_t vertexAllocation = vertexAllocator.Allocate(vertexCount);
+    if (vertexAllocation == TLSF_NONE)
+        return false;
+    uint32_t indexAllocation = indexAllocator.Allocate(indexCount);
+    if (indexAllocation == TLSF_NONE) {
+        vertexAllocator.Free(vertexAllocation);
+        return false;
+    }
+    mesh.vertexAllocation = vertexAllocation;
+    mesh.indexAllocation = indexAllocation;
+    mesh.baseVertexLoc = (int)vertexAllocator.Offset(vertexAllocation);
+    mesh.startIndexLoc = indexAllocator.Offset(indexAllocation);
+    vertexOwners[vertexAllocation] = &mesh;
+    indexOwners[indexAllocation] = &mesh;
+
+    // .. vertices then indices in one upload buffer ..
+    const UINT64 vbByteSize = (UINT64)vertexCount * sizeof(Vertex);
+    const UINT64 ibByteSize = (UINT64)indexCount * sizeof(uint32_t);
+    auto         heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto         uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(vbByteSize + ibByteSize);
+    DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &uploadDesc,
+                                            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(uploadBuffer)),
+            L"Failed to create a mesh upload buffer.");
+    BYTE *mapped = nullptr;
+    DX12_HR((*uploadBuffer)->Map(0, nullptr, reinterpret_cast<void **>(&mapped)), L"");
+    memcpy(mapped, vertices, vbByteSize);
+    memcpy(mapped + vbByteSize, indices, ibByteSize);
+    (*uploadBuffer)->Unmap(0, nullptr);
+
+    CD3DX12_RESOURCE_BARRIER toCopy[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(vertexBuffer, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST),
+        CD3DX12_RESOURCE_BARRIER::Transition(indexBuffer, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_DEST),
+    };
+    cmdList->ResourceBarrier(_countof(toCopy), toCopy);
+    cmdList->CopyBufferRegion(vertexBuffer, (UINT64)mesh.baseVertexLoc * sizeof(Vertex), *uploadBuffer, 0, vbByteSize);
+    cmdList->CopyBufferRegion(indexBuffer, (UINT64)mesh.startIndexLoc * sizeof(uint32_t), *uploadBuffer, vbByteSize, ibByteSize);
+    CD3DX12_RESOURCE_BARRIER toRead[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(vertexBuffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ),
+        CD3DX12_RESOURCE_BARRIER::Transition(indexBuffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ),
+    };
+    cmdList->ResourceBarrier(_countof(toRead), toRead);
+    return true;
+}
+
+void DX12GeometryBuffer::RemoveMesh(DX12RenderMesh &mesh) {
+    if (mesh.vertexAllocation != TLSF_NONE) {
+        vertexOwners[mesh.vertexAllocation] = nullptr;
+        vertexAllocator.Free(mesh.vertexAllocation);
+        mesh.vertexAllocation = TLSF_NONE;
+    }
+    if (mesh.indexAllocation != TLSF_NONE) {
+        indexOwners[mesh.indexAllocation] = nullptr;
+        indexAllocator.Free(mesh.indexAllocation);
+        mesh.indexAllocation = TLSF_NONE;
+    }
+}
+
+UINT64 DX12GeometryBuffer::Defragment(ID3D12GraphicsCommandList *cmdList, UINT64 maxBytes) {
+    UINT64 moved = 0;
+
+    moves.clear();
+    moved += (UINT64)vertexAllocator.Defragment((uint32_t)(maxBytes / sizeof(Vertex)), moves) * sizeof(Vertex);
+    for (const TlsfMove &move : moves)
+        vertexOwners[move.allocation]->baseVertexLoc = (int)move.to;
+    CopyMoves(cmdList, vertexBuffer, sizeof(Vertex));
+
+    moves.clear();
+    moved += (UINT64)indexAllocator.Defragment((uint32_t)(maxBytes / sizeof(uint32_t)), moves) * sizeof(uint32_t);
+    for (const TlsfMove &move : moves)
+        indexOwners[move.allocation]->startIndexLoc = move.to;
+    CopyMoves(cmdList, indexBuffer, sizeof(uint32_t));
+
+    return moved;
+}
+
+void DX12GeometryBuffer::CopyMoves(ID3D12GraphicsCommandList *cmdList, ID3D12Resource *buffer, UINT stride) {
+    if (moves.empty())
+        return;
+
+    // NOTE(pf): Moves slide down in address order, so copying them in pieces front to back never reads what an
+    // earlier piece wrote. Pieces go through the scratch buffer a scratch full at a time: all reads, then all
+    // writes, which is what makes a move that overlaps itself safe.
+    auto toSource = CD3DX12_RESOURCE_BARRIER::Transition(buffer, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    cmdList->ResourceBarrier(1, &toSource);
+
+    size_t move = 0;
+    UINT64 moveDone = 0;
+    while (move < moves.size()) {
+        // .. gather into scratch ..
+        size_t firstMove = move;
+        UINT64 firstDone = moveDone;
+        UINT64 used = 0;
+        while (move < moves.size() && used < scratchSize) {
+            UINT64 bytes = (UINT64)moves[move].size * stride - moveDone;
+            UINT64 piece = bytes < scratchSize - used ? bytes : scratchSize - used;
+            cmdList->CopyBufferRegion(scratchBuffer, used, buffer, (UINT64)moves[move].from * stride + moveDone, piece);
+            used += piece;
+            moveDone += piece;
+            if (moveDone == (UINT64)moves[move].size * stride) {
+                move++;
+                moveDone = 0;
+            }
+        }
+
+        CD3DX12_RESOURCE_BARRIER toWrite[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(scratchBuffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(buffer, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_DEST),
+        };
+        cmdList->ResourceBarrier(_countof(toWrite), toWrite);
+
+        // .. and scatter the same pieces to their new places ..
+        UINT64 read = 0;
+        size_t m = firstMove;
+        UINT64 done = firstDone;
+        while (read < used) {
+            UINT64 bytes = (UINT64)moves[m].size * stride - done;
+            UINT64 piece = bytes < used - read ? bytes : used - read;
+            cmdList->CopyBufferRegion(buffer, (UINT64)moves[m].to * stride + done, scratchBuffer, read, piece);
+            read += piece;
+            done += piece;
+            if (done == (UINT64)moves[m].size * stride) {
+                m++;
+                done = 0;
+            }
+        }
+
+        CD3DX12_RESOURCE_BARRIER toRead[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(scratchBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_DEST),
+            CD3DX12_RESOURCE_BARRIER::Transition(buffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE),
+        };
+        cmdList->ResourceBarrier(_countof(toRead), toRead);
+    }
+
+    auto toGeneric = CD3DX12_RESOURCE_BARRIER::Transition(buffer, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_GENERIC_READ);
+    cmdList->ResourceBarrier(1, &toGeneric);
+}
+
+float DX12GeometryBuffer::Fragmentation() const {
+    float result = 0.0f;
+    const TlsfAllocator *allocators[] = {&vertexAllocator, &indexAllocator};
+    for (const TlsfAllocator *allocator : allocators) {
+        if (allocator->FreeUnits() > 0)
+            result = Max(result, 1.0f - (float)allocator->LargestFree() / allocator->FreeUnits());
+    }
+    return result;
+}
+
+D3D12_VERTEX_BUFFER_VIEW DX12GeometryBuffer::VertexBufferView() const {
+    D3D12_VERTEX_BUFFER_VIEW result;
+    result.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
+    result.StrideInBytes = sizeof(Vertex);
+    result.SizeInBytes = vertexAllocator.size * sizeof(Vertex);
+    return result;
+}
+
+D3D12_INDEX_BUFFER_VIEW DX12GeometryBuffer::IndexBufferView() const {
+    D3D12_INDEX_BUFFER_VIEW result;
+    result.BufferLocation = indexBuffer->GetGPUVirtualAddress();
+    result.Format = DXGI_FORMAT_R32_UINT;
+    result.SizeInBytes = indexAllocator.size * sizeof(uint32_t);
+    return result;
+}
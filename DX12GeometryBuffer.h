@@ -0,0 +1,47 @@
+#ifndef _DX12_GEOMETRY_BUFFER_H_
+#define _DX12_GEOMETRY_BUFFER_H_
+
+#include "Common_DX12.h"
+#include "DX12RenderMesh.h"
+#include "TlsfAllocator.h"
+
+// NOTE(pf): One vertex and one index buffer that every mesh is sub-allocated from with TlsfAllocator, so a frame
+// binds them once and meshes only differ in BaseVertexLocation and StartIndexLocation. Vertices are allocated
+// in Vertex units, indices in 32 bit ones. The buffers stay in GENERIC_READ outside of the copies.
+//
+// Copies are recorded on the direct queue like the frames, which is what makes freeing and moving safe while
+// frames are in flight: a frame that still reads the old place runs before the copy that overwrites it.
+struct DX12GeometryBuffer {
+    void Initialize(ID3D12Device *device, UINT vertexCapacity, UINT indexCapacity, UINT maxMeshes, UINT64 scratchBytes);
+    void CleanUp();
+
+    // NOTE(pf): Records the copy from a new upload buffer into cmdList and sets the mesh's locations, the caller
+    // releases uploadBuffer once cmdList has run. Returns false when either buffer has no room.
+    bool AddMesh(ID3D12GraphicsCommandList *cmdList, const Vertex *vertices, UINT vertexCount, const uint32_t *indices,
+                 UINT indexCount, DX12RenderMesh &mesh, ID3D12Resource **uploadBuffer);
+    void RemoveMesh(DX12RenderMesh &mesh);
+
+    // NOTE(pf): Slides meshes towards the start of the buffers until about maxBytes have moved, through the
+    // scratch buffer since a move may overlap itself, and updates their locations. Returns the bytes moved.
+    UINT64 Defragment(ID3D12GraphicsCommandList *cmdList, UINT64 maxBytes);
+    // NOTE(pf): 1 - largest free block / free space of the worse of the two buffers.
+    float  Fragmentation() const;
+
+    D3D12_VERTEX_BUFFER_VIEW VertexBufferView() const;
+    D3D12_INDEX_BUFFER_VIEW  IndexBufferView() const;
+
+    void CopyMoves(ID3D12GraphicsCommandList *cmdList, ID3D12Resource *buffer, UINT stride);
+
+    ID3D12Device                 *device = nullptr;
+    ID3D12Resource               *vertexBuffer = nullptr;
+    ID3D12Resource               *indexBuffer = nullptr;
+    ID3D12Resource               *scratchBuffer = nullptr;
+    UINT64                        scratchSize = 0;
+    TlsfAllocator                 vertexAllocator;
+    TlsfAllocator                 indexAllocator;
+    std::vector<DX12RenderMesh *> vertexOwners; // Per allocation id.
+    std::vector<DX12RenderMesh *> indexOwners;
+    std::vector<TlsfMove>         moves;
+};
+
+#endif //!_DX12_GEOMETRY_BUFFER_H_
@@ -0,0 +1,198 @@
+#include "DX12GfxCommandList.h"
+
+static_assert(GFX_RESOURCE_STATE_GENERIC_READ == D3D12_RESOURCE_STATE_GENERIC_READ, "Resource states must match D3D12.");
+static_assert(GFX_RESOURCE_STATE_RENDER_TARGET == D3D12_RESOURCE_STATE_RENDER_TARGET, "Resource states must match D3D12.");
+static_assert(GFX_RESOURCE_STATE_COPY_DEST == D3D12_RESOURCE_STATE_COPY_DEST, "Resource states must match D3D12.");
+static_assert(GFX_RESOURCE_STATE_UNORDERED_ACCESS == D3D12_RESOURCE_STATE_UNORDERED_ACCESS, "Resource states must match D3D12.");
+static_assert(GFX_FORMAT_R16G16B16A16_FLOAT == DXGI_FORMAT_R16G16B16A16_FLOAT, "Formats must match DXGI.");
+static_assert(GFX_FORMAT_R24_UNORM_X8_TYPELESS == DXGI_FORMAT_R24_UNORM_X8_TYPELESS, "Formats must match DXGI.");
+static_assert(GFX_FORMAT_R16_UNORM == DXGI_FORMAT_R16_UNORM, "Formats must match DXGI.");
+static_assert(GFX_FORMAT_R32G32_FLOAT == DXGI_FORMAT_R32G32_FLOAT, "Formats must match DXGI.");
+static_assert(GFX_FORMAT_R32_TYPELESS == DXGI_FORMAT_R32_TYPELESS, "Formats must match DXGI.");
+static_assert(GFX_TOPOLOGY_TRIANGLELIST == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, "Topologies must match D3D12.");
+static_assert(GFX_CLEAR_STENCIL == D3D12_CLEAR_FLAG_STENCIL, "Clear flags must match D3D12.");
+static_assert(sizeof(GfxViewport) == sizeof(D3D12_VIEWPORT), "GfxViewport must match D3D12_VIEWPORT.");
+static_assert(sizeof(GfxRect) == sizeof(D3D12_RECT), "GfxRect must match D3D12_RECT.");
+static_assert(sizeof(GfxVertexBufferView) == sizeof(D3D12_VERTEX_BUFFER_VIEW), "Vertex buffer views must match.");
+static_assert(sizeof(GfxIndexBufferView) == sizeof(D3D12_INDEX_BUFFER_VIEW), "Index buffer views must match.");
+
+static D3D12_CPU_DESCRIPTOR_HANDLE CpuDescriptor(GfxHandle handle) {
+    D3D12_CPU_DESCRIPTOR_HANDLE result;
+    result.ptr = (SIZE_T)handle;
+    return result;
+}
+
+static D3D12_GPU_DESCRIPTOR_HANDLE GpuDescriptor(GfxHandle handle) {
+    D3D12_GPU_DESCRIPTOR_HANDLE result;
+    result.ptr = (UINT64)handle;
+    return result;
+}
+
+void DX12GfxCommandList::Barrier(GfxHandle resource, uint32_t before, uint32_t after) {
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition((ID3D12Resource *)resource,
+                                                                            (D3D12_RESOURCE_STATES)before, (D3D12_RESOURCE_STATES)after);
+    cmdList->ResourceBarrier(1, &barrier);
+}
+
+void DX12GfxCommandList::ClearRenderTarget(GfxHandle rtv, const float color[4]) {
+    cmdList->ClearRenderTargetView(CpuDescriptor(rtv), color, 0, nullptr);
+}
+
+void DX12GfxCommandList::ClearDepthStencil(GfxHandle dsv, uint32_t flags, float depth, uint8_t stencil) {
+    cmdList->ClearDepthStencilView(CpuDescriptor(dsv), (D3D12_CLEAR_FLAGS)flags, depth, stencil, 0, nullptr);
+}
+
+void DX12GfxCommandList::SetDescriptorHeaps(uint32_t count, const GfxHandle *heaps) {
+    assert(count <= GFX_MAX_DESCRIPTOR_HEAPS && "Too many descriptor heaps.");
+    ID3D12DescriptorHeap *descriptorHeaps[GFX_MAX_DESCRIPTOR_HEAPS];
+    for (uint32_t i = 0; i < count; ++i)
+        descriptorHeaps[i] = (ID3D12DescriptorHeap *)heaps[i];
+    cmdList->SetDescriptorHeaps(count, descriptorHeaps);
+}
+
+void DX12GfxCommandList::SetGraphicsRootSignature(GfxHandle rootSignature) {
+    cmdList->SetGraphicsRootSignature((ID3D12RootSignature *)rootSignature);
+}
+
+void DX12GfxCommandList::SetPipelineState(GfxHandle pipelineState) {
+    cmdList->SetPipelineState((ID3D12PipelineState *)pipelineState);
+}
+
+void DX12GfxCommandList::SetViewport(const GfxViewport &viewport) {
+    cmdList->RSSetViewports(1, (const D3D12_VIEWPORT *)&viewport);
+}
+
+void DX12GfxCommandList::SetScissorRect(const GfxRect &rect) {
+    D3D12_RECT scissorRect = {rect.left, rect.top, rect.right, rect.bottom};
+    cmdList->RSSetScissorRects(1, &scissorRect);
+}
+
+void DX12GfxCommandList::SetRenderTargets(uint32_t count, const GfxHandle *rtvs, const GfxHandle *dsv) {
+    assert(count <= GFX_MAX_RENDER_TARGETS && "Too many render targets.");
+    D3D12_CPU_DESCRIPTOR_HANDLE renderTargets[GFX_MAX_RENDER_TARGETS];
+    for (uint32_t i = 0; i < count; ++i)
+        renderTargets[i] = CpuDescriptor(rtvs[i]);
+    D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = dsv ? CpuDescriptor(*dsv) : D3D12_CPU_DESCRIPTOR_HANDLE{};
+    cmdList->OMSetRenderTargets(count, renderTargets, false, dsv ? &depthStencil : nullptr);
+}
+
+void DX12GfxCommandList::SetPrimitiveTopology(uint32_t topology) {
+    cmdList->IASetPrimitiveTopology((D3D12_PRIMITIVE_TOPOLOGY)topology);
+}
+
+void DX12GfxCommandList::SetVertexBuffers(uint32_t startSlot, uint32_t count, const GfxVertexBufferView *views) {
+    cmdList->IASetVertexBuffers(startSlot, count, count ? (const D3D12_VERTEX_BUFFER_VIEW *)views : nullptr);
+}
+
+void DX12GfxCommandList::SetIndexBuffer(const GfxIndexBufferView *view) {
+    cmdList->IASetIndexBuffer((const D3D12_INDEX_BUFFER_VIEW *)view);
+}
+
+void DX12GfxCommandList::SetGraphicsRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) {
+    cmdList->SetGraphicsRootConstantBufferView(parameter, (D3D12_GPU_VIRTUAL_ADDRESS)gpuAddress);
+}
+
+void DX12GfxCommandList::SetGraphicsRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) {
+    cmdList->SetGraphicsRootShaderResourceView(parameter, (D3D12_GPU_VIRTUAL_ADDRESS)gpuAddress);
+}
+
+void DX12GfxCommandList::SetGraphicsRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) {
+    cmdList->SetGraphicsRootDescriptorTable(parameter, GpuDescriptor(gpuDescriptor));
+}
+
+void DX12GfxCommandList::SetGraphicsRoot32BitConstants(uint32_t parameter, uint32_t count, const void *data, uint32_t offset) {
+    cmdList->SetGraphicsRoot32BitConstants(parameter, count, data, offset);
+}
+
+void DX12GfxCommandList::SetComputeRootSignature(GfxHandle rootSignature) {
+    cmdList->SetComputeRootSignature((ID3D12RootSignature *)rootSignature);
+}
+
+void DX12GfxCommandList::SetComputeRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) {
+    cmdList->SetComputeRootConstantBufferView(parameter, (D3D12_GPU_VIRTUAL_ADDRESS)gpuAddress);
+}
+
+void DX12GfxCommandList::SetComputeRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) {
+    cmdList->SetComputeRootShaderResourceView(parameter, (D3D12_GPU_VIRTUAL_ADDRESS)gpuAddress);
+}
+
+void DX12GfxCommandList::SetComputeRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) {
+    cmdList->SetComputeRootDescriptorTable(parameter, GpuDescriptor(gpuDescriptor));
+}
+
+void DX12GfxCommandList::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) {
+    cmdList->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void DX12GfxCommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                                              uint32_t startInstance) {
+    cmdList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void DX12GfxCommandList::ExecuteIndirect(GfxHandle commandSignature, uint32_t maxCommandCount, GfxHandle argumentBuffer,
+                                         uint64_t argumentOffset) {
+    cmdList->ExecuteIndirect((ID3D12CommandSignature *)commandSignature, maxCommandCount, (ID3D12Resource *)argumentBuffer,
+                             argumentOffset, nullptr, 0);
+}
+
+void DX12GfxCommandList::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    cmdList->Dispatch(groupsX, groupsY, groupsZ);
+}
+
+void DX12GfxCommandList::WriteDescriptor(const GfxDescriptorWrite &write) {
+    ID3D12Resource *resource = (ID3D12Resource *)write.resource;
+    switch (write.type) {
+    case GFX_DESCRIPTOR_SRV_TEXTURE2D: {
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Format = (DXGI_FORMAT)write.format;
+        srvDesc.Texture2D.MostDetailedMip = 0;
+        srvDesc.Texture2D.MipLevels = 1;
+        device->CreateShaderResourceView(resource, &srvDesc, CpuDescriptor(write.cpuDescriptor));
+    } break;
+    case GFX_DESCRIPTOR_RTV_TEXTURE2D: {
+        D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+        rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+        rtvDesc.Format = (DXGI_FORMAT)write.format;
+        rtvDesc.Texture2D.MipSlice = 0;
+        rtvDesc.Texture2D.PlaneSlice = 0;
+        device->CreateRenderTargetView(resource, &rtvDesc, CpuDescriptor(write.cpuDescriptor));
+    } break;
+    case GFX_DESCRIPTOR_DSV_TEXTURE2D: {
+        D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+        dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+        dsvDesc.Format = (DXGI_FORMAT)write.format;
+        dsvDesc.Texture2D.MipSlice = 0;
+        dsvDesc.Flags = D3D12_DSV_FLAG_NONE;
+        device->CreateDepthStencilView(resource, &dsvDesc, CpuDescriptor(write.cpuDescriptor));
+    } break;
+    case GFX_DESCRIPTOR_UAV_TEXTURE2D: {
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+        uavDesc.Format = (DXGI_FORMAT)write.format;
+        uavDesc.Texture2D.MipSlice = 0;
+        uavDesc.Texture2D.PlaneSlice = 0;
+        device->CreateUnorderedAccessView(resource, nullptr, &uavDesc, CpuDescriptor(write.cpuDescriptor));
+    } break;
+    case GFX_DESCRIPTOR_UAV_RAW_BUFFER: {
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+        uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = write.elementCount;
+        uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+        device->CreateUnorderedAccessView(resource, nullptr, &uavDesc, CpuDescriptor(write.cpuDescriptor));
+    } break;
+    }
+}
+
+void DX12GfxCommandList::BeginZone(const char *name) {
+    if (profiler)
+        profiler->BeginZone(cmdList, name);
+}
+
+void DX12GfxCommandList::EndZone() {
+    if (profiler)
+        profiler->EndZone(cmdList);
+}
@@ -0,0 +1,73 @@
+#ifndef _DX12_GFX_COMMAND_LIST_H_
+#define _DX12_GFX_COMMAND_LIST_H_
+
+#include "Common_DX12.h"
+#include "DX12GpuProfiler.h"
+#include "GfxCommandList.h"
+
+// NOTE(pf): Forwards to a D3D12 command list. Descriptor writes only need the device, so a list without
+// cmdList can be used for them outside of a frame. Zones go to the gpu profiler when there is one.
+struct DX12GfxCommandList : GfxCommandList {
+    DX12GfxCommandList(ID3D12Device *_device, ID3D12GraphicsCommandList2 *_cmdList, DX12GpuProfiler *_profiler = nullptr)
+        : device(_device), cmdList(_cmdList), profiler(_profiler) {}
+
+    void Barrier(GfxHandle resource, uint32_t before, uint32_t after) override;
+    void ClearRenderTarget(GfxHandle rtv, const float color[4]) override;
+    void ClearDepthStencil(GfxHandle dsv, uint32_t flags, float depth, uint8_t stencil) override;
+    void SetDescriptorHeaps(uint32_t count, const GfxHandle *heaps) override;
+    void SetGraphicsRootSignature(GfxHandle rootSignature) override;
+    void SetPipelineState(GfxHandle pipelineState) override;
+    void SetViewport(const GfxViewport &viewport) override;
+    void SetScissorRect(const GfxRect &rect) override;
+    void SetRenderTargets(uint32_t count, const GfxHandle *rtvs, const GfxHandle *dsv) override;
+    void SetPrimitiveTopology(uint32_t topology) override;
+    void SetVertexBuffers(uint32_t startSlot, uint32_t count, const GfxVertexBufferView *views) override;
+    void SetIndexBuffer(const GfxIndexBufferView *view) override;
+    void SetGraphicsRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetGraphicsRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetGraphicsRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) override;
+    void SetGraphicsRoot32BitConstants(uint32_t parameter, uint32_t count, const void *data, uint32_t offset) override;
+    void SetComputeRootSignature(GfxHandle rootSignature) override;
+    void SetComputeRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetComputeRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetComputeRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                              uint32_t startInstance) override;
+    void ExecuteIndirect(GfxHandle commandSignature, uint32_t maxCommandCount, GfxHandle argumentBuffer,
+                         uint64_t argumentOffset) override;
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void WriteDescriptor(const GfxDescriptorWrite &write) override;
+    void BeginZone(const char *name) override;
+    void EndZone() override;
+
+    ID3D12Device               *device;
+    ID3D12GraphicsCommandList2 *cmdList;
+    DX12GpuProfiler            *profiler;
+};
+
+inline GfxHandle GfxHandleOf(D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+    return (GfxHandle)handle.ptr;
+}
+
+inline GfxHandle GfxHandleOf(D3D12_GPU_DESCRIPTOR_HANDLE handle) {
+    return (GfxHandle)handle.ptr;
+}
+
+inline GfxViewport GfxViewportOf(const D3D12_VIEWPORT &viewport) {
+    return {viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth};
+}
+
+inline GfxRect GfxRectOf(const D3D12_RECT &rect) {
+    return {(int32_t)rect.left, (int32_t)rect.top, (int32_t)rect.right, (int32_t)rect.bottom};
+}
+
+inline GfxVertexBufferView GfxVertexBufferViewOf(const D3D12_VERTEX_BUFFER_VIEW &view) {
+    return {view.BufferLocation, view.SizeInBytes, view.StrideInBytes};
+}
+
+inline GfxIndexBufferView GfxIndexBufferViewOf(const D3D12_INDEX_BUFFER_VIEW &view) {
+    return {view.BufferLocation, view.SizeInBytes, (uint32_t)view.Format};
+}
+
+#endif //!_DX12_GFX_COMMAND_LIST_H_
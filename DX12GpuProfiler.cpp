@@ -0,0 +1,102 @@
+#include "DX12GpuProfiler.h"
+#include "Timer.h"
+
+void DX12GpuProfiler::Initialize(ID3D12Device *device, ID3D12CommandQueue *_queue, UINT _framesInFlight) {
+    queue = _queue;
+    framesInFlight = _framesInFlight;
+    frameZones.resize(framesInFlight * GPU_PROFILER_MAX_ZONES);
+    frameZoneCounts.assign(framesInFlight, 0);
+
+    D3D12_QUERY_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    heapDesc.Count = framesInFlight * GPU_PROFILER_MAX_ZONES * 2;
+    DX12_HR(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&queryHeap)), L"Failed to create timestamp query heap.");
+
+    auto readbackHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+    auto readbackDesc = CD3DX12_RESOURCE_DESC::Buffer(heapDesc.Count * sizeof(uint64_t));
+    DX12_HR(device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &readbackDesc,
+                                            D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&readbackBuffer)),
+            L"Failed to create timestamp readback buffer.");
+    DX12_HR(queue->GetTimestampFrequency(&timestampFrequency), L"Failed to query timestamp frequency.");
+
+    track = ProfilerRegisterTrack("GPU");
+}
+
+void DX12GpuProfiler::CleanUp() {
+    DX12_RELEASE(queryHeap);
+    DX12_RELEASE(readbackBuffer);
+}
+
+void DX12GpuProfiler::BeginFrame(ID3D12GraphicsCommandList *cmdList, UINT frameIndex) {
+    currentFrame = frameIndex;
+    frameZoneCounts[currentFrame] = 0;
+    openDepth = 0;
+    BeginZone(cmdList, "Frame");
+}
+
+void DX12GpuProfiler::BeginZone(ID3D12GraphicsCommandList *cmdList, const char *name) {
+    UINT &count = frameZoneCounts[currentFrame];
+    assert(count < GPU_PROFILER_MAX_ZONES && openDepth < GPU_PROFILER_MAX_ZONES);
+    UINT zone = count++;
+
+    DX12GpuZone &entry = frameZones[currentFrame * GPU_PROFILER_MAX_ZONES + zone];
+    entry.name = name;
+    entry.depth = openDepth;
+    entry.ms = 0.0;
+    openZones[openDepth++] = zone;
+
+    UINT query = (currentFrame * GPU_PROFILER_MAX_ZONES + zone) * 2;
+    cmdList->EndQuery(queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, query);
+}
+
+void DX12GpuProfiler::EndZone(ID3D12GraphicsCommandList *cmdList) {
+    assert(openDepth > 0);
+    UINT zone = openZones[--openDepth];
+    UINT query = (currentFrame * GPU_PROFILER_MAX_ZONES + zone) * 2 + 1;
+    cmdList->EndQuery(queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, query);
+}
+
+void DX12GpuProfiler::EndFrame(ID3D12GraphicsCommandList *cmdList) {
+    EndZone(cmdList);
+    assert(openDepth == 0);
+
+    UINT first = currentFrame * GPU_PROFILER_MAX_ZONES * 2;
+    UINT count = frameZoneCounts[currentFrame] * 2;
+    cmdList->ResolveQueryData(queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, first, count, readbackBuffer, first * sizeof(uint64_t));
+}
+
+void DX12GpuProfiler::CollectFrame(UINT frameIndex) {
+    UINT count = frameZoneCounts[frameIndex];
+    if (count == 0)
+        return;
+
+    UINT        first = frameIndex * GPU_PROFILER_MAX_ZONES * 2;
+    D3D12_RANGE readRange = {first * sizeof(uint64_t), (first + count * 2) * sizeof(uint64_t)};
+    D3D12_RANGE writeRange = {0, 0};
+    uint64_t   *timestamps = nullptr;
+    DX12_HR(readbackBuffer->Map(0, &readRange, reinterpret_cast<void **>(&timestamps)), L"");
+
+    // NOTE(pf): Maps gpu ticks onto the QueryPerformanceCounter timeline the cpu zones use.
+    uint64_t gpuCalibration = 0, cpuCalibration = 0;
+    bool     calibrated = ProfilerIsEnabled() && SUCCEEDED(queue->GetClockCalibration(&gpuCalibration, &cpuCalibration));
+    double   gpuToCpu = HiResPerformanceFreq() / (double)timestampFrequency;
+
+    const DX12GpuZone *zones = &frameZones[frameIndex * GPU_PROFILER_MAX_ZONES];
+    for (UINT i = 0; i < count; ++i) {
+        uint64_t begin = timestamps[first + i * 2];
+        uint64_t end = timestamps[first + i * 2 + 1];
+        lastZones[i] = zones[i];
+        lastZones[i].ms = (end - begin) * 1000.0 / (double)timestampFrequency;
+
+        if (calibrated) {
+            int64_t cpuBegin = (int64_t)cpuCalibration + (int64_t)(((int64_t)begin - (int64_t)gpuCalibration) * gpuToCpu);
+            int64_t cpuEnd = (int64_t)cpuCalibration + (int64_t)(((int64_t)end - (int64_t)gpuCalibration) * gpuToCpu);
+            ProfilerRecord(track, zones[i].name, cpuBegin, cpuEnd, zones[i].depth);
+        }
+    }
+    readbackBuffer->Unmap(0, &writeRange);
+
+    lastZoneCount = count;
+    lastFrameMs = lastZones[0].ms;
+    frameZoneCounts[frameIndex] = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef _DX12_GPU_PROFILER_H_
+#define _DX12_GPU_PROFILER_H_
+
+#include "Common_DX12.h"
+#include "Profiler.h"
+#include <vector>
+
+static constexpr UINT GPU_PROFILER_MAX_ZONES = {32};
+
+struct DX12GpuZone {
+    const char *name;
+    UINT        depth;
+    double      ms;
+};
+
+// NOTE(pf): Timestamp pairs per zone and per frame in flight. A frame's zones are resolved at the end of
+// its command list and collected once its fence has passed, then they are also recorded on the profiler's
+// "GPU" track, mapped onto the cpu clock with the queue's clock calibration.
+struct DX12GpuProfiler {
+    void Initialize(ID3D12Device *device, ID3D12CommandQueue *queue, UINT framesInFlight);
+    void CleanUp();
+
+    void BeginFrame(ID3D12GraphicsCommandList *cmdList, UINT frameIndex);
+    void BeginZone(ID3D12GraphicsCommandList *cmdList, const char *name);
+    void EndZone(ID3D12GraphicsCommandList *cmdList);
+    void EndFrame(ID3D12GraphicsCommandList *cmdList);
+
+    // Call once the fence of the frame that last used frameIndex has passed.
+    void CollectFrame(UINT frameIndex);
+
+    ID3D12CommandQueue  *queue = nullptr;
+    ID3D12QueryHeap     *queryHeap = nullptr;
+    ID3D12Resource      *readbackBuffer = nullptr;
+    uint64_t             timestampFrequency = 0;
+    ProfileThreadBuffer *track = nullptr;
+    UINT                 framesInFlight = 0;
+    UINT                 currentFrame = 0;
+    UINT                 openZones[GPU_PROFILER_MAX_ZONES] = {};
+    UINT                 openDepth = 0;
+
+    std::vector<DX12GpuZone> frameZones; // framesInFlight * GPU_PROFILER_MAX_ZONES.
+    std::vector<UINT>        frameZoneCounts;
+
+    // NOTE(pf): Results of the newest collected frame, zone 0 spans the whole frame.
+    DX12GpuZone lastZones[GPU_PROFILER_MAX_ZONES] = {};
+    UINT        lastZoneCount = 0;
+    double      lastFrameMs = 0.0;
+};
+
+struct DX12GpuProfileZone {
+    DX12GpuProfileZone(DX12GpuProfiler &_profiler, ID3D12GraphicsCommandList *_cmdList, const char *name) : profiler(_profiler), cmdList(_cmdList) {
+        profiler.BeginZone(cmdList, name);
+    }
+    ~DX12GpuProfileZone() {
+        profiler.EndZone(cmdList);
+    }
+    DX12GpuProfiler           &profiler;
+    ID3D12GraphicsCommandList *cmdList;
+};
+
+#endif //!_DX12_GPU_PROFILER_H_
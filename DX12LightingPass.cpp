@@ -0,0 +1,130 @@
+#include "DX12LightingPass.h"
+#include "DX12GfxCommandList.h"
+#include "Profiler.h"
+
+using namespace DirectX;
+
+void DX12LightingPass::Initialize(ID3D12Device *_device, UINT width, UINT height, UINT frameCount) {
+    device = _device;
+    mRenderTargetWidth = width;
+    mRenderTargetHeight = height;
+    mRenderWidth = width;
+    mRenderHeight = height;
+
+    // .. the lit color, alpha 0 where nothing was drawn ..
+    auto texDesc = CD3DX12_RESOURCE_DESC::Tex2D(litColorFormat, width, height, 1, 1, 1, 0,
+                                                D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+    float               litClearColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    CD3DX12_CLEAR_VALUE optClear(litColorFormat, litClearColor);
+    auto                heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &texDesc,
+                                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &optClear, IID_PPV_ARGS(&mLitColor)),
+            L"Failed to create the lit color target.");
+
+    // .. the tile lists, sized for the full targets so dynamic resolution never has to resize them ..
+    UINT tiles = ((width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE) * ((height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE);
+    mTileLightsElements = tiles * LIGHT_TILE_STRIDE;
+    auto tileDesc = CD3DX12_RESOURCE_DESC::Buffer(mTileLightsElements * sizeof(UINT), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &tileDesc,
+                                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr, IID_PPV_ARGS(&mTileLights)),
+            L"Failed to create the tile light lists.");
+
+    heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    lightUploadBuffers.assign(frameCount, nullptr);
+    lightMappings.assign(frameCount, nullptr);
+    for (UINT i = 0; i < frameCount; ++i) {
+        auto lightDesc = CD3DX12_RESOURCE_DESC::Buffer(LIGHT_CULL_MAX_LIGHTS * sizeof(PointLight));
+        DX12_HR(device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &lightDesc,
+                                                D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&lightUploadBuffers[i])),
+                L"Failed to create light buffer.");
+        DX12_HR(lightUploadBuffers[i]->Map(0, nullptr, reinterpret_cast<void **>(&lightMappings[i])), L"");
+    }
+
+    constants.Initialize(device, sizeof(LightingConstants), frameCount);
+}
+
+void DX12LightingPass::CleanUp() {
+    for (ID3D12Resource *&buffer : lightUploadBuffers) {
+        DX12_RELEASE(buffer);
+    }
+    DX12_RELEASE(mTileLights);
+    DX12_RELEASE(mLitColor);
+    constants.CleanUp();
+}
+
+void DX12LightingPass::BuildDescriptors(CD3DX12_CPU_DESCRIPTOR_HANDLE hCpuSrv, CD3DX12_GPU_DESCRIPTOR_HANDLE hGpuSrv,
+                                        CD3DX12_CPU_DESCRIPTOR_HANDLE hCpuRtv, UINT cbvSrvUavDescriptorSize) {
+    mhTileLightsCpuUav = hCpuSrv;
+    mhLitColorCpuSrv = hCpuSrv.Offset(1, cbvSrvUavDescriptorSize);
+    mhTileLightsGpuUav = hGpuSrv;
+    mhLitColorGpuSrv = hGpuSrv.Offset(1, cbvSrvUavDescriptorSize);
+    mhLitColorCpuRtv = hCpuRtv;
+
+    DX12GfxCommandList gfx(device, nullptr);
+    RecordLightingDescriptorWrites(gfx, Bindings());
+}
+
+void DX12LightingPass::SetPSOs(ID3D12PipelineState *cullPso, ID3D12PipelineState *forwardPso, ID3D12PipelineState *compositePso) {
+    mCullPso = cullPso;
+    mForwardPso = forwardPso;
+    mCompositePso = compositePso;
+}
+
+void DX12LightingPass::SetRenderSize(UINT width, UINT height) {
+    mRenderWidth = width;
+    mRenderHeight = height;
+}
+
+void DX12LightingPass::UploadLights(const PointLight *worldLights, UINT lightCount, XMMATRIX view, XMMATRIX proj, UINT frameIndex) {
+    PROFILE_FUNCTION();
+    mFrameIndex = frameIndex;
+    lightCount = lightCount < LIGHT_CULL_MAX_LIGHTS ? lightCount : LIGHT_CULL_MAX_LIGHTS;
+
+    // .. the culling and shading passes work in view space ..
+    PointLight *lights = lightMappings[frameIndex];
+    for (UINT i = 0; i < lightCount; ++i) {
+        XMVECTOR position = XMVector3TransformCoord(XMLoadFloat3((const XMFLOAT3 *)worldLights[i].position), view);
+        lights[i] = worldLights[i];
+        XMStoreFloat3((XMFLOAT3 *)lights[i].position, position);
+    }
+
+    XMFLOAT4X4 projValues;
+    XMStoreFloat4x4(&projValues, proj);
+    LightingConstants lightingCB;
+    lightingCB.LightCount = lightCount;
+    lightingCB.TilesX = (mRenderWidth + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    lightingCB.TilesY = (mRenderHeight + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    lightingCB.RenderSize = XMUINT2(mRenderWidth, mRenderHeight);
+    lightingCB.Proj00 = projValues._11;
+    lightingCB.Proj11 = projValues._22;
+    lightingCB.ProjA = projValues._33;
+    lightingCB.ProjB = projValues._43;
+    constants.Write(&lightingCB);
+    constants.Upload(frameIndex);
+}
+
+LightingPassBindings DX12LightingPass::Bindings() const {
+    LightingPassBindings result = {};
+    result.enabled = enabled;
+    result.cullPipelineState = GfxHandleOf(mCullPso);
+    result.forwardPipelineState = GfxHandleOf(mForwardPso);
+    result.compositePipelineState = GfxHandleOf(mCompositePso);
+    result.constants = constants.Address(mFrameIndex);
+    result.lights = lightUploadBuffers.empty() ? 0 : lightUploadBuffers[mFrameIndex]->GetGPUVirtualAddress();
+
+    result.tileLights = GfxHandleOf(mTileLights);
+    result.tileLightsAddress = mTileLights ? mTileLights->GetGPUVirtualAddress() : 0;
+    result.tileLightsElements = mTileLightsElements;
+    result.tileGroups[0] = (mRenderWidth + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    result.tileGroups[1] = (mRenderHeight + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    result.litColor = GfxHandleOf(mLitColor);
+
+    result.tileLightsCpuUav = GfxHandleOf(mhTileLightsCpuUav);
+    result.litColorCpuSrv = GfxHandleOf(mhLitColorCpuSrv);
+    result.tileLightsGpuUav = GfxHandleOf(mhTileLightsGpuUav);
+    result.litColorGpuSrv = GfxHandleOf(mhLitColorGpuSrv);
+    result.litColorRtv = GfxHandleOf(mhLitColorCpuRtv);
+
+    result.litColorFormat = (GFX_FORMAT)litColorFormat;
+    return result;
+}
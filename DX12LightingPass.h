@@ -0,0 +1,67 @@
+#ifndef _DX12_LIGHTING_PASS_H_
+#define _DX12_LIGHTING_PASS_H_
+
+#include "Common_DX12.h"
+#include "DX12ConstantBuffer.h"
+#include "FramePasses.h"
+#include "LightCulling.h"
+
+// NOTE(pf): Depends on the light count, the projection and the render size, cbLighting in Lighting.hlsl.
+struct LightingConstants {
+    UINT              LightCount = 0;
+    UINT              TilesX = 0;
+    UINT              TilesY = 0;
+    UINT              Pad0 = 0;
+    DirectX::XMUINT2  RenderSize = {0, 0};
+    DirectX::XMUINT2  Pad1 = {0, 0};
+    float             Proj00 = 1.0f;
+    float             Proj11 = 1.0f;
+    float             ProjA = 0.0f;
+    float             ProjB = 0.0f;
+};
+
+// NOTE(pf): The tile lists, the lit color target and the lights of every frame in flight. DX12 builds the
+// root signatures and pipelines, FramePasses records the passes from Bindings.
+struct DX12LightingPass {
+    void Initialize(ID3D12Device *device, UINT width, UINT height, UINT frameCount);
+    void CleanUp();
+
+    static const DXGI_FORMAT litColorFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+    // NOTE(pf): Reserves the tile lists' uav and the lit color's srv, then one rtv.
+    void                 BuildDescriptors(CD3DX12_CPU_DESCRIPTOR_HANDLE hCpuSrv, CD3DX12_GPU_DESCRIPTOR_HANDLE hGpuSrv,
+                                          CD3DX12_CPU_DESCRIPTOR_HANDLE hCpuRtv, UINT cbvSrvUavDescriptorSize);
+    void                 SetPSOs(ID3D12PipelineState *cullPso, ID3D12PipelineState *forwardPso, ID3D12PipelineState *compositePso);
+    // NOTE(pf): Dynamic resolution, the tiles cover the top left width x height of the targets.
+    void                 SetRenderSize(UINT width, UINT height);
+    // NOTE(pf): World space lights, transformed into view space in the frame's slice. At most LIGHT_CULL_MAX_LIGHTS.
+    void                 UploadLights(const PointLight *worldLights, UINT lightCount, DirectX::XMMATRIX view,
+                                      DirectX::XMMATRIX proj, UINT frameIndex);
+    LightingPassBindings Bindings() const;
+
+    ID3D12Device                 *device = nullptr;
+    ID3D12PipelineState          *mCullPso = nullptr;
+    ID3D12PipelineState          *mForwardPso = nullptr;
+    ID3D12PipelineState          *mCompositePso = nullptr;
+    ID3D12Resource               *mTileLights = nullptr;
+    ID3D12Resource               *mLitColor = nullptr;
+    CD3DX12_CPU_DESCRIPTOR_HANDLE mhTileLightsCpuUav;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE mhTileLightsGpuUav;
+    CD3DX12_CPU_DESCRIPTOR_HANDLE mhLitColorCpuSrv;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE mhLitColorGpuSrv;
+    CD3DX12_CPU_DESCRIPTOR_HANDLE mhLitColorCpuRtv;
+    UINT                          mRenderTargetWidth = 0;
+    UINT                          mRenderTargetHeight = 0;
+    UINT                          mRenderWidth = 0;
+    UINT                          mRenderHeight = 0;
+    UINT                          mTileLightsElements = 0;
+    UINT                          mFrameIndex = 0;
+    bool                          enabled = true;
+
+    // NOTE(pf): One upload buffer of LIGHT_CULL_MAX_LIGHTS lights per frame in flight, rewritten every frame.
+    std::vector<ID3D12Resource *> lightUploadBuffers;
+    std::vector<PointLight *>     lightMappings;
+    DX12ConstantBuffer            constants;
+};
+
+#endif //!_DX12_LIGHTING_PASS_H_
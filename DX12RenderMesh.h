@@ -3,45 +3,40 @@
 
 #include "Common.h"
 #include "Common_DX12.h"
+#include "Culling.h"
+#include "MeshSimplifier.h"
+#include "TlsfAllocator.h"
 
 struct DX12RenderMesh {
-    inline D3D12_VERTEX_BUFFER_VIEW VertexBufferView() const {
-        D3D12_VERTEX_BUFFER_VIEW result;
-
-        result.BufferLocation = vertexBufferGPU->GetGPUVirtualAddress();
-        result.StrideInBytes = vertexByteStride;
-        result.SizeInBytes = vertexBufferByteSize;
-
-        return result;
-    }
-
-    inline D3D12_INDEX_BUFFER_VIEW IndexBufferView() const {
-        D3D12_INDEX_BUFFER_VIEW result;
-
-        result.BufferLocation = indexBufferGPU->GetGPUVirtualAddress();
-        result.Format = indexFormat;
-        result.SizeInBytes = indexBufferByteSize;
-
-        return result;
+    inline UINT SelectLod(float distance, float fovY, float viewportHeight, float pixelThreshold = 1.0f) const {
+        return SelectMeshLod(lods, lodCount, distance, fovY, viewportHeight, pixelThreshold);
     }
 
     D3D12_PRIMITIVE_TOPOLOGY primitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
     UINT                     indexCount;
-    UINT                     startIndexLoc;
+    UINT                     startIndexLoc; // Locations in DX12GeometryBuffer, they change when it defragments.
     int                      baseVertexLoc;
+    uint32_t                 vertexAllocation = {TLSF_NONE};
+    uint32_t                 indexAllocation = {TLSF_NONE};
+
+    // NOTE(pf): Object space bounds of the whole mesh.
+    CullBounds bounds = {};
+
+    // NOTE(pf): LOD index ranges live after LOD 0 in the same index buffer.
+    MeshLod lods[MESH_MAX_LODS];
+    UINT    lodCount = 0;
+    UINT    activeLod = 0;
 
-    ID3DBlob       *vertexBufferCPU;
-    ID3D12Resource *vertexBufferGPU;
-    ID3D12Resource *vertexBufferUploader;
+    ID3DBlob       *vertexBufferCPU = {nullptr};
+    ID3DBlob       *indexBufferCPU = {nullptr};
+    ID3D12Resource *uploadBuffer = {nullptr};
 
-    ID3DBlob       *indexBufferCPU;
-    ID3D12Resource *indexBufferGPU;
-    ID3D12Resource *indexBufferUploader;
+    // NOTE(pf): MemoryBudget ids. The upload buffer is released once the upload has run, the cpu copies, which
+    // only occlusion culling reads, may be dropped to stay within the cpu budget.
+    uint32_t vertexBufferCPUMemory = {0};
+    uint32_t indexBufferCPUMemory = {0};
 
-    UINT        vertexByteStride;
-    UINT        vertexBufferByteSize;
-    DXGI_FORMAT indexFormat;
-    UINT        indexBufferByteSize;
+    UINT vertexByteStride;
 };
 
 #endif //!_DX12_RENDER_MESH_H_
\ No newline at end of file
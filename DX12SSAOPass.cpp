@@ -1,4 +1,5 @@
 #include "DX12SSAOPass.h"
+#include "DX12GfxCommandList.h"
 
 using namespace DirectX;
 using namespace DirectX::PackedVector;
@@ -18,10 +19,14 @@ DX12SSAOPass::DX12SSAOPass() {
 DX12SSAOPass::~DX12SSAOPass() {
 }
 
-void DX12SSAOPass::Initialize(ID3D12Device *_device, ID3D12GraphicsCommandList2 *cmdList, UINT width, UINT height, D3D12_VIEWPORT viewPort, D3D12_RECT scissorRect) {
+void DX12SSAOPass::Initialize(ID3D12Device *_device, ID3D12GraphicsCommandList2 *cmdList, UINT width, UINT height, D3D12_VIEWPORT viewPort, D3D12_RECT scissorRect,
+                              UINT frameCount, SSAO_NORMAL_SOURCE normalSource) {
     device = _device;
+    mNormalSource = normalSource;
     mRenderTargetWidth = width;
     mRenderTargetHeight = height;
+    mRenderWidth = width;
+    mRenderHeight = height;
     mViewport = viewPort;
     mScissorRect = scissorRect;
 
@@ -29,24 +34,36 @@ void DX12SSAOPass::Initialize(ID3D12Device *_device, ID3D12GraphicsCommandList2
     BuildOffsetVectors();
     BuildRandomVectorTexture(cmdList);
 
-    auto heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-    auto init_state = CD3DX12_RESOURCE_DESC::Buffer((sizeof(SsaoConstants) + 255) & ~255);
-    DX12_HR(device->CreateCommittedResource(
-                &heap_prop,
-                D3D12_HEAP_FLAG_NONE,
-                &init_state,
-                D3D12_RESOURCE_STATE_GENERIC_READ,
-                nullptr,
-                IID_PPV_ARGS(&cbSSAOUploadBuffer)),
-            L"");
+    passConstants.Initialize(device, sizeof(SsaoPassConstants), frameCount);
+    mHasPassProj = false;
 
-    DX12_HR(cbSSAOUploadBuffer->Map(0, nullptr, reinterpret_cast<void **>(&cbSSAOMapping)), L"");
+    // .. the offsets and occlusion parameters are uploaded once ..
+    SsaoStaticConstants staticCB;
+    GetOffsetVectors(staticCB.OffsetVectors);
+    staticConstants.Initialize(device, sizeof(SsaoStaticConstants), 1);
+    staticConstants.Write(&staticCB);
+    staticConstants.Upload(0);
+}
+
+void DX12SSAOPass::CleanUp() {
+    DX12_RELEASE(mRandomVectorMap);
+    DX12_RELEASE(mRandomVectorMapUploadBuffer);
+    DX12_RELEASE(mNormalMap);
+    DX12_RELEASE(mAmbientMap0);
+    DX12_RELEASE(mDepthPyramid);
+    DX12_RELEASE(mDepthPyramidScratch);
+    passConstants.CleanUp();
+    staticConstants.CleanUp();
 }
 
 void DX12SSAOPass::GetOffsetVectors(DirectX::XMFLOAT4 offsets[14]) {
     std::copy(&mOffsets[0], &mOffsets[14], &offsets[0]);
 }
 
+DXGI_FORMAT DX12SSAOPass::NormalMapFormat(SSAO_NORMAL_SOURCE normalSource) {
+    return normalSource == SSAO_NORMALS_FLOAT ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R16G16_SNORM;
+}
+
 ID3D12Resource *DX12SSAOPass::GetNormalMap() {
     return mNormalMap;
 }
@@ -58,17 +75,21 @@ CD3DX12_CPU_DESCRIPTOR_HANDLE DX12SSAOPass::GetNormalMapRTV() const {
 
 void DX12SSAOPass::BuildDescriptors(ID3D12Resource *depthStencilBuffer, CD3DX12_CPU_DESCRIPTOR_HANDLE hCpuSrv, CD3DX12_GPU_DESCRIPTOR_HANDLE hGpuSrv, CD3DX12_CPU_DESCRIPTOR_HANDLE hCpuRtv, UINT cbvSrvUavDescriptorSize, UINT rtvDescriptorSize) {
     // Save references to the descriptors.  The Ssao reserves heap space
-    // for 5 contiguous Srvs.
+    // for 5 contiguous Srvs followed by the 2 Uavs of the depth pyramid.
 
     mhAmbientMap0CpuSrv = hCpuSrv;
     mhNormalMapCpuSrv = hCpuSrv.Offset(1, cbvSrvUavDescriptorSize);
     mhDepthMapCpuSrv = hCpuSrv.Offset(1, cbvSrvUavDescriptorSize);
     mhRandomVectorMapCpuSrv = hCpuSrv.Offset(1, cbvSrvUavDescriptorSize);
+    mhDepthPyramidCpuSrv = hCpuSrv.Offset(1, cbvSrvUavDescriptorSize);
+    mhDepthPyramidCpuUav = hCpuSrv.Offset(1, cbvSrvUavDescriptorSize);
+    mhDepthPyramidScratchCpuUav = hCpuSrv.Offset(1, cbvSrvUavDescriptorSize);
 
     mhAmbientMap0GpuSrv = hGpuSrv;
     mhNormalMapGpuSrv = hGpuSrv.Offset(1, cbvSrvUavDescriptorSize);
     mhDepthMapGpuSrv = hGpuSrv.Offset(1, cbvSrvUavDescriptorSize);
     mhRandomVectorMapGpuSrv = hGpuSrv.Offset(1, cbvSrvUavDescriptorSize);
+    mhDepthPyramidGpuUav = hGpuSrv.Offset(2, cbvSrvUavDescriptorSize);
 
     mhNormalMapCpuRtv = hCpuRtv;
     mhAmbientMap0CpuRtv = hCpuRtv.Offset(1, rtvDescriptorSize);
@@ -78,101 +99,98 @@ void DX12SSAOPass::BuildDescriptors(ID3D12Resource *depthStencilBuffer, CD3DX12_
 }
 
 void DX12SSAOPass::RebuildDescriptors(ID3D12Resource *depthStencilBuffer) {
-    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Format = normalMapFormat;
-    srvDesc.Texture2D.MostDetailedMip = 0;
-    srvDesc.Texture2D.MipLevels = 1;
-    device->CreateShaderResourceView(mNormalMap, &srvDesc, mhNormalMapCpuSrv);
-
-    srvDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
-    // srvDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-    device->CreateShaderResourceView(depthStencilBuffer, &srvDesc, mhDepthMapCpuSrv);
-
-    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    device->CreateShaderResourceView(mRandomVectorMap, &srvDesc, mhRandomVectorMapCpuSrv);
-
-    srvDesc.Format = ambientMapFormat;
-    device->CreateShaderResourceView(mAmbientMap0, &srvDesc, mhAmbientMap0CpuSrv);
-
-    D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
-    rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
-    rtvDesc.Format = normalMapFormat;
-    rtvDesc.Texture2D.MipSlice = 0;
-    rtvDesc.Texture2D.PlaneSlice = 0;
-    device->CreateRenderTargetView(mNormalMap, &rtvDesc, mhNormalMapCpuRtv);
-
-    rtvDesc.Format = ambientMapFormat;
-    device->CreateRenderTargetView(mAmbientMap0, &rtvDesc, mhAmbientMap0CpuRtv);
+    mDepthStencilBuffer = depthStencilBuffer;
+    DX12GfxCommandList gfx(device, nullptr);
+    RecordSsaoDescriptorWrites(gfx, Bindings());
 }
 
-void DX12SSAOPass::SetPSOs(ID3D12PipelineState *ssaoPso) {
-    mSsaoPso = ssaoPso;
+SsaoPassBindings DX12SSAOPass::Bindings() const {
+    SsaoPassBindings result = {};
+    result.viewport = GfxViewportOf(mViewport);
+    result.scissorRect = GfxRectOf(mScissorRect);
+    result.pipelineState = GfxHandleOf(mEngine == SSAO_ENGINE_GTAO ? mGtaoPso : mSsaoPso);
+    result.passConstants = passConstants.Address(mFrameIndex);
+    result.staticConstants = staticConstants.Address(0);
+
+    result.normalMap = GfxHandleOf(mNormalMap);
+    result.writeNormalMap = mNormalSource != SSAO_NORMALS_FROM_DEPTH;
+    result.depthMap = GfxHandleOf(mDepthStencilBuffer);
+    result.randomVectorMap = GfxHandleOf(mRandomVectorMap);
+    result.ambientMap = GfxHandleOf(mAmbientMap0);
+
+    result.depthPyramidPipelineState = GfxHandleOf(mDepthPyramidPso);
+    result.depthPyramid = GfxHandleOf(mDepthPyramid);
+    result.depthPyramidScratch = GfxHandleOf(mDepthPyramidScratch);
+    result.depthPyramidGroups[0] = (mRenderWidth + DEPTH_PYRAMID_TILE_SIZE - 1) / DEPTH_PYRAMID_TILE_SIZE;
+    result.depthPyramidGroups[1] = (mRenderHeight + DEPTH_PYRAMID_TILE_SIZE - 1) / DEPTH_PYRAMID_TILE_SIZE;
+    result.depthPyramidScratchElements = mPyramidScratchElements;
+    result.useDepthPyramid = mEngine == SSAO_ENGINE_HEMISPHERE;
+
+    result.ambientMapCpuSrv = GfxHandleOf(mhAmbientMap0CpuSrv);
+    result.normalMapCpuSrv = GfxHandleOf(mhNormalMapCpuSrv);
+    result.depthMapCpuSrv = GfxHandleOf(mhDepthMapCpuSrv);
+    result.randomVectorMapCpuSrv = GfxHandleOf(mhRandomVectorMapCpuSrv);
+    result.depthPyramidCpuSrv = GfxHandleOf(mhDepthPyramidCpuSrv);
+    result.depthPyramidCpuUav = GfxHandleOf(mhDepthPyramidCpuUav);
+    result.depthPyramidScratchCpuUav = GfxHandleOf(mhDepthPyramidScratchCpuUav);
+    result.normalMapGpuSrv = GfxHandleOf(mhNormalMapGpuSrv);
+    result.depthMapGpuSrv = GfxHandleOf(mhDepthMapGpuSrv);
+    result.randomVectorMapGpuSrv = GfxHandleOf(mhRandomVectorMapGpuSrv);
+    result.depthPyramidGpuUav = GfxHandleOf(mhDepthPyramidGpuUav);
+    result.normalMapRtv = GfxHandleOf(mhNormalMapCpuRtv);
+    result.ambientMapRtv = GfxHandleOf(mhAmbientMap0CpuRtv);
+
+    result.normalMapFormat = (GFX_FORMAT)NormalMapFormat(mNormalSource);
+    result.depthMapFormat = GFX_FORMAT_R24_UNORM_X8_TYPELESS;
+    result.randomVectorMapFormat = GFX_FORMAT_R8G8B8A8_UNORM;
+    result.ambientMapFormat = (GFX_FORMAT)ambientMapFormat;
+    result.depthPyramidFormat = (GFX_FORMAT)depthPyramidFormat;
+    return result;
 }
 
-void DX12SSAOPass::ComputeSsao(ID3D12GraphicsCommandList *cmdList) {
-    cmdList->RSSetViewports(1, &mViewport);
-    cmdList->RSSetScissorRects(1, &mScissorRect);
-
-    // We compute the initial SSAO to AmbientMap0.
-
-    // Change to RENDER_TARGET.
-    auto pass0_transition0 = CD3DX12_RESOURCE_BARRIER::Transition(mAmbientMap0,
-                                                                  D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET);
-    cmdList->ResourceBarrier(1, &pass0_transition0);
-
-    float clearValue[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    cmdList->ClearRenderTargetView(mhAmbientMap0CpuRtv, clearValue, 0, nullptr);
-
-    // Specify the buffers we are going to render to.
-    cmdList->OMSetRenderTargets(1, &mhAmbientMap0CpuRtv, true, nullptr);
-
-    // Bind the constant buffer for this pass.
-    auto ssaoCBAddress = cbSSAOUploadBuffer->GetGPUVirtualAddress();
-    cmdList->SetGraphicsRootConstantBufferView(0, ssaoCBAddress);
-
-    // Bind the normal and depth maps.
-    cmdList->SetGraphicsRootDescriptorTable(1, mhNormalMapGpuSrv);
-
-    // Bind the random vector map.
-    cmdList->SetGraphicsRootDescriptorTable(2, mhRandomVectorMapGpuSrv);
-
-    cmdList->SetPipelineState(mSsaoPso);
+void DX12SSAOPass::SetPSOs(ID3D12PipelineState *ssaoPso, ID3D12PipelineState *gtaoPso, ID3D12PipelineState *depthPyramidPso) {
+    mSsaoPso = ssaoPso;
+    mGtaoPso = gtaoPso;
+    mDepthPyramidPso = depthPyramidPso;
+}
 
-    // Draw fullscreen quad.
-    cmdList->IASetVertexBuffers(0, 0, nullptr);
-    cmdList->IASetIndexBuffer(nullptr);
-    cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    cmdList->DrawInstanced(6, 1, 0, 0);
+void DX12SSAOPass::SetEngine(SSAO_ENGINE engine, GTAO_QUALITY quality) {
+    if (quality != mGtaoQuality)
+        mHasPassProj = false;
+    mEngine = engine;
+    mGtaoQuality = quality;
+}
 
-    // Change back to GENERIC_READ so we can read the texture in a shader.
-    auto pass1_transition0 = CD3DX12_RESOURCE_BARRIER::Transition(mAmbientMap0,
-                                                                  D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ);
-    cmdList->ResourceBarrier(1, &pass1_transition0);
+void DX12SSAOPass::ComputeSsao(GfxCommandList &cmdList) {
+    RecordSsaoPass(cmdList, Bindings());
 }
 
 void DX12SSAOPass::BuildResources() {
     // Free the old resources if they exist.
     mNormalMap = nullptr;
     mAmbientMap0 = nullptr;
+    mDepthPyramid = nullptr;
+    mDepthPyramidScratch = nullptr;
 
     D3D12_RESOURCE_DESC texDesc;
     ZeroMemory(&texDesc, sizeof(D3D12_RESOURCE_DESC));
     texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
     texDesc.Alignment = 0;
-    texDesc.Width = mRenderTargetWidth;
-    texDesc.Height = mRenderTargetHeight;
+    // NOTE(pf): Nothing writes or reads the normal target when normals come from depth, a 1x1 one keeps the
+    // descriptor layout.
+    bool normalsFromDepth = mNormalSource == SSAO_NORMALS_FROM_DEPTH;
+    texDesc.Width = normalsFromDepth ? 1 : mRenderTargetWidth;
+    texDesc.Height = normalsFromDepth ? 1 : mRenderTargetHeight;
     texDesc.DepthOrArraySize = 1;
     texDesc.MipLevels = 1;
-    texDesc.Format = normalMapFormat;
+    texDesc.Format = NormalMapFormat(mNormalSource);
     texDesc.SampleDesc.Count = 1;
     texDesc.SampleDesc.Quality = 0;
     texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
     texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
 
     float               normalClearColor[] = {0.0f, 0.0f, 1.0f, 0.0f};
-    CD3DX12_CLEAR_VALUE optClear(normalMapFormat, normalClearColor);
+    CD3DX12_CLEAR_VALUE optClear(texDesc.Format, normalClearColor);
     auto                heap_prop = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
     DX12_HR(device->CreateCommittedResource(
                 &heap_prop,
@@ -197,6 +215,36 @@ void DX12SSAOPass::BuildResources() {
                 &optClear,
                 IID_PPV_ARGS(&mAmbientMap0)),
             L"");
+
+    // .. the depth pyramid atlas, written by DepthPyramidCS and read by SSAOPS ..
+    mPyramidLayout.Initialize(mRenderTargetWidth, mRenderTargetHeight);
+    texDesc.Width = mPyramidLayout.width > 0 ? mPyramidLayout.width : 1; // A 1x1 target has no levels past 0.
+    texDesc.Height = mPyramidLayout.height > 0 ? mPyramidLayout.height : 1;
+    texDesc.Format = depthPyramidFormat;
+    texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+    DX12_HR(device->CreateCommittedResource(
+                &heap_prop,
+                D3D12_HEAP_FLAG_NONE,
+                &texDesc,
+                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                nullptr,
+                IID_PPV_ARGS(&mDepthPyramid)),
+            L"");
+
+    // NOTE(pf): Committed resources start zeroed, which is the group counter DepthPyramidCS expects. The
+    // last group resets it, so the buffer stays in UNORDERED_ACCESS for good.
+    UINT tiles = ((mRenderTargetWidth + DEPTH_PYRAMID_TILE_SIZE - 1) / DEPTH_PYRAMID_TILE_SIZE) *
+                 ((mRenderTargetHeight + DEPTH_PYRAMID_TILE_SIZE - 1) / DEPTH_PYRAMID_TILE_SIZE);
+    mPyramidScratchElements = DEPTH_PYRAMID_SCRATCH_HEADER + 2 * tiles;
+    auto scratchDesc = CD3DX12_RESOURCE_DESC::Buffer(mPyramidScratchElements * sizeof(UINT), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    DX12_HR(device->CreateCommittedResource(
+                &heap_prop,
+                D3D12_HEAP_FLAG_NONE,
+                &scratchDesc,
+                D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+                nullptr,
+                IID_PPV_ARGS(&mDepthPyramidScratch)),
+            L"");
 }
 
 void DX12SSAOPass::BuildRandomVectorTexture(ID3D12GraphicsCommandList *cmdList) {
@@ -310,30 +358,56 @@ void DX12SSAOPass::BuildOffsetVectors() {
     }
 }
 
-void DX12SSAOPass::UploadConstants(XMMATRIX proj) {
-    SsaoConstants ssaoCB;
-    // Transform NDC space [-1,+1]^2 to texture space [0,1]^2
-    XMMATRIX T(
-        0.5f, 0.0f, 0.0f, 0.0f,
-        0.0f, -0.5f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.0f, 1.0f);
-
-    XMVECTOR projDet = XMMatrixDeterminant(proj);
-    XMMATRIX invProj = XMMatrixInverse(&projDet, proj);
-    XMStoreFloat4x4(&ssaoCB.Proj, XMMatrixTranspose(proj));
-    XMStoreFloat4x4(&ssaoCB.InvProj, XMMatrixTranspose(invProj));
-    XMStoreFloat4x4(&ssaoCB.ProjTex, XMMatrixTranspose(proj * T));
-
-    GetOffsetVectors(ssaoCB.OffsetVectors);
-
-    ssaoCB.InvRenderTargetSize = XMFLOAT2(1.0f / mRenderTargetWidth, 1.0f / mRenderTargetHeight);
+void DX12SSAOPass::SetRenderSize(UINT width, UINT height) {
+    if (width == mRenderWidth && height == mRenderHeight)
+        return;
+    mRenderWidth = width;
+    mRenderHeight = height;
+    mViewport = CD3DX12_VIEWPORT(0.0f, 0.0f, (FLOAT)width, (FLOAT)height);
+    mScissorRect = CD3DX12_RECT(0, 0, (LONG)width, (LONG)height);
+    mHasPassProj = false;
+}
 
-    // Coordinates given in view space.
-    ssaoCB.OcclusionRadius = 0.5f;
-    ssaoCB.OcclusionFadeStart = 0.2f;
-    ssaoCB.OcclusionFadeEnd = 1.0f;
-    ssaoCB.SurfaceEpsilon = 0.05f;
+void DX12SSAOPass::UploadConstants(XMMATRIX proj, UINT frameIndex) {
+    mFrameIndex = frameIndex;
+
+    // .. the inverse is only needed again when the projection, the render size or the GTAO quality changed ..
+    XMFLOAT4X4 projValues;
+    XMStoreFloat4x4(&projValues, proj);
+    if (!mHasPassProj || memcmp(&projValues, &mPassProj, sizeof(projValues)) != 0) {
+        mPassProj = projValues;
+        mHasPassProj = true;
+
+        SsaoPassConstants ssaoCB;
+        ssaoCB.RenderScale = XMFLOAT2((float)mRenderWidth / mRenderTargetWidth, (float)mRenderHeight / mRenderTargetHeight);
+        // Transform NDC space [-1,+1]^2 to the rendered part of texture space, [0,1]^2 at full resolution.
+        float    sx = ssaoCB.RenderScale.x;
+        float    sy = ssaoCB.RenderScale.y;
+        XMMATRIX T(
+            0.5f * sx, 0.0f, 0.0f, 0.0f,
+            0.0f, -0.5f * sy, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.5f * sx, 0.5f * sy, 0.0f, 1.0f);
+
+        XMVECTOR projDet = XMMatrixDeterminant(proj);
+        XMMATRIX invProj = XMMatrixInverse(&projDet, proj);
+        XMStoreFloat4x4(&ssaoCB.Proj, XMMatrixTranspose(proj));
+        XMStoreFloat4x4(&ssaoCB.InvProj, XMMatrixTranspose(invProj));
+        XMStoreFloat4x4(&ssaoCB.ProjTex, XMMatrixTranspose(proj * T));
+        ssaoCB.InvRenderTargetSize = XMFLOAT2(1.0f / mRenderTargetWidth, 1.0f / mRenderTargetHeight);
+
+        // .. the rendered part of the depth map has its own, smaller chain of levels in the same atlas ..
+        DepthPyramidLayout renderLayout;
+        renderLayout.Initialize(mRenderWidth, mRenderHeight);
+        for (UINT level = 0; level < DEPTH_PYRAMID_MAX_LEVELS; ++level) {
+            const DepthPyramidLevel &rect = renderLayout.levels[level];
+            ssaoCB.PyramidLevels[level] = XMUINT4(rect.x, rect.y, rect.width, rect.height);
+        }
+        ssaoCB.PyramidLevelCount = renderLayout.levelCount;
+        ssaoCB.GtaoSliceCount = GTAO_PRESETS[mGtaoQuality].sliceCount;
+        ssaoCB.GtaoStepCount = GTAO_PRESETS[mGtaoQuality].stepCount;
+        passConstants.Write(&ssaoCB);
+    }
 
-    memcpy(cbSSAOMapping, &ssaoCB, sizeof(ssaoCB));
+    passConstants.Upload(frameIndex);
 }
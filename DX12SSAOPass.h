@@ -3,32 +3,58 @@
 
 #include "Common_DX12.h"
 #include "DX12CommandQueue.h"
+#include "DX12ConstantBuffer.h"
+#include "DepthPyramid.h"
+#include "FramePasses.h"
+#include "Gtao.h"
+#include "SsaoNormals.h"
 
-struct SsaoConstants {
+// NOTE(pf): Depends on the projection and the render target size, cbSsaoPass in CommonSSAO.hlsl.
+struct SsaoPassConstants {
     DirectX::XMFLOAT4X4 Proj;
     DirectX::XMFLOAT4X4 InvProj;
     DirectX::XMFLOAT4X4 ProjTex;
-    DirectX::XMFLOAT4   OffsetVectors[14];
+    DirectX::XMFLOAT2   InvRenderTargetSize = {0.0f, 0.0f};
+    DirectX::XMFLOAT2   RenderScale = {1.0f, 1.0f}; // Part of the targets rendered to.
+    DirectX::XMUINT4    PyramidLevels[DEPTH_PYRAMID_MAX_LEVELS]; // Atlas rectangles, level 0 is the rendered depth.
+    UINT                PyramidLevelCount = 0;
+    UINT                PyramidMipBias = DEPTH_PYRAMID_MIP_BIAS;
+    UINT                GtaoSliceCount = 0; // GTAO_PRESETS entry of the selected quality.
+    UINT                GtaoStepCount = 0;
+};
 
-    DirectX::XMFLOAT2 InvRenderTargetSize = {0.0f, 0.0f};
+// NOTE(pf): Never changes after Initialize, cbSsaoStatic in CommonSSAO.hlsl.
+struct SsaoStaticConstants {
+    DirectX::XMFLOAT4 OffsetVectors[14];
 
     // Coordinates given in view space.
     float OcclusionRadius = 0.5f;
     float OcclusionFadeStart = 0.2f;
-    float OcclusionFadeEnd = 2.0f;
+    float OcclusionFadeEnd = 1.0f;
     float SurfaceEpsilon = 0.05f;
+
+    // NOTE(pf): GtaoPS, same values as GtaoSettings.
+    float GtaoRadius = 0.5f;
+    float GtaoFalloffRange = 0.3f;
+    float GtaoSampleDistributionPower = 2.0f;
+    float GtaoMinStepPixels = 1.3f;
 };
 
 struct DX12SSAOPass {
     DX12SSAOPass();
     ~DX12SSAOPass();
 
-    void Initialize(ID3D12Device *device, ID3D12GraphicsCommandList2 *cmdList, UINT width, UINT height, D3D12_VIEWPORT viewPort, D3D12_RECT scissorRect);
+    void Initialize(ID3D12Device *device, ID3D12GraphicsCommandList2 *cmdList, UINT width, UINT height, D3D12_VIEWPORT viewPort, D3D12_RECT scissorRect,
+                    UINT frameCount, SSAO_NORMAL_SOURCE normalSource);
+    void CleanUp();
 
     static const DXGI_FORMAT ambientMapFormat = DXGI_FORMAT_R16_UNORM;
-    static const DXGI_FORMAT normalMapFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+    static const DXGI_FORMAT depthPyramidFormat = DXGI_FORMAT_R32G32_FLOAT;
     static const int         maxBlurRadius = 5;
 
+    // NOTE(pf): Format of the normal target NormalsPS writes for normalSource, see SsaoNormals.h.
+    static DXGI_FORMAT            NormalMapFormat(SSAO_NORMAL_SOURCE normalSource);
+
     void                          GetOffsetVectors(DirectX::XMFLOAT4 offsets[14]);
     ID3D12Resource               *GetNormalMap();
     CD3DX12_CPU_DESCRIPTOR_HANDLE GetNormalMapRTV() const;
@@ -38,20 +64,30 @@ struct DX12SSAOPass {
                                                    UINT                          cbvSrvUavDescriptorSize,
                                                    UINT                          rtvDescriptorSize);
     void                          RebuildDescriptors(ID3D12Resource *depthStencilBuffer);
-    void                          SetPSOs(ID3D12PipelineState *ssaoPso);
-    void                          ComputeSsao(ID3D12GraphicsCommandList *cmdList);
+    void                          SetPSOs(ID3D12PipelineState *ssaoPso, ID3D12PipelineState *gtaoPso, ID3D12PipelineState *depthPyramidPso);
+    // NOTE(pf): GTAO draws with gtaoPso and skips the depth pyramid, only the hemisphere kernel reads it.
+    void                          SetEngine(SSAO_ENGINE engine, GTAO_QUALITY quality);
+    void                          ComputeSsao(GfxCommandList &cmdList);
+    SsaoPassBindings              Bindings() const;
     void                          BuildResources();
     void                          BuildRandomVectorTexture(ID3D12GraphicsCommandList *cmdList);
     void                          BuildOffsetVectors();
-    void                          UploadConstants(DirectX::XMMATRIX proj);
+    // NOTE(pf): Dynamic resolution, the pass renders into the top left width x height of its targets.
+    void                          SetRenderSize(UINT width, UINT height);
+    void                          UploadConstants(DirectX::XMMATRIX proj, UINT frameIndex);
 
     ID3D12Device                 *device = nullptr;
     ID3D12RootSignature          *rootSignature = nullptr;
     ID3D12PipelineState          *mSsaoPso = nullptr;
-    ID3D12Resource               *mRandomVectorMap;
-    ID3D12Resource               *mRandomVectorMapUploadBuffer;
-    ID3D12Resource               *mNormalMap;
-    ID3D12Resource               *mAmbientMap0;
+    ID3D12PipelineState          *mGtaoPso = nullptr;
+    ID3D12PipelineState          *mDepthPyramidPso = nullptr;
+    ID3D12Resource               *mRandomVectorMap = nullptr;
+    ID3D12Resource               *mRandomVectorMapUploadBuffer = nullptr;
+    ID3D12Resource               *mNormalMap = nullptr;
+    ID3D12Resource               *mAmbientMap0 = nullptr;
+    ID3D12Resource               *mDepthPyramid = nullptr;
+    ID3D12Resource               *mDepthPyramidScratch = nullptr;
+    ID3D12Resource               *mDepthStencilBuffer = nullptr;
     CD3DX12_CPU_DESCRIPTOR_HANDLE mhNormalMapCpuSrv;
     CD3DX12_GPU_DESCRIPTOR_HANDLE mhNormalMapGpuSrv;
     CD3DX12_CPU_DESCRIPTOR_HANDLE mhNormalMapCpuRtv;
@@ -62,13 +98,31 @@ struct DX12SSAOPass {
     CD3DX12_CPU_DESCRIPTOR_HANDLE mhAmbientMap0CpuSrv;
     CD3DX12_GPU_DESCRIPTOR_HANDLE mhAmbientMap0GpuSrv;
     CD3DX12_CPU_DESCRIPTOR_HANDLE mhAmbientMap0CpuRtv;
+    CD3DX12_CPU_DESCRIPTOR_HANDLE mhDepthPyramidCpuSrv;
+    CD3DX12_CPU_DESCRIPTOR_HANDLE mhDepthPyramidCpuUav;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE mhDepthPyramidGpuUav;
+    CD3DX12_CPU_DESCRIPTOR_HANDLE mhDepthPyramidScratchCpuUav;
     UINT                          mRenderTargetWidth;
     UINT                          mRenderTargetHeight;
+    UINT                          mRenderWidth;
+    UINT                          mRenderHeight;
     DirectX::XMFLOAT4             mOffsets[14];
+    SSAO_NORMAL_SOURCE            mNormalSource = SSAO_NORMALS_FLOAT;
+    SSAO_ENGINE                   mEngine = SSAO_ENGINE_HEMISPHERE;
+    GTAO_QUALITY                  mGtaoQuality = GTAO_QUALITY_MEDIUM;
+    // NOTE(pf): The atlas is sized for the full targets, the levels dispatched and read follow the render size.
+    DepthPyramidLayout            mPyramidLayout;
+    UINT                          mPyramidScratchElements;
     D3D12_VIEWPORT                mViewport;
     D3D12_RECT                    mScissorRect;
-    ID3D12Resource               *cbSSAOUploadBuffer;
-    BYTE                         *cbSSAOMapping = nullptr;
+
+    // NOTE(pf): Pass constants are rebuilt only when the projection, the render size or the GTAO quality
+    // changes, one slice per frame in flight.
+    DX12ConstantBuffer  passConstants;
+    DX12ConstantBuffer  staticConstants;
+    DirectX::XMFLOAT4X4 mPassProj;
+    bool                mHasPassProj = false;
+    UINT                mFrameIndex = 0;
 };
 
 #endif //!_DX12SSAO_PASS_H_
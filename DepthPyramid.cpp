@@ -0,0 +1,224 @@
+#include "DepthPyramid.h"
+
+#if defined(SIMD_SSE2) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+void DepthPyramidLayout::Initialize(uint32_t _width, uint32_t _height) {
+    assert(_width <= (1u << (DEPTH_PYRAMID_MAX_LEVELS - 1)) && _height <= (1u << (DEPTH_PYRAMID_MAX_LEVELS - 1)) &&
+           "Depth pyramid too large.");
+    levels[0] = {0, 0, _width, _height};
+    levelCount = 1;
+    uint32_t columnHeight = 0;
+    while (levelCount < DEPTH_PYRAMID_MAX_LEVELS && (levels[levelCount - 1].width > 1 || levels[levelCount - 1].height > 1)) {
+        const DepthPyramidLevel &previous = levels[levelCount - 1];
+        DepthPyramidLevel       &level = levels[levelCount];
+        level.width = (previous.width + 1) / 2;
+        level.height = (previous.height + 1) / 2;
+
+        // .. level 1 at the origin, the smaller ones stacked in a column to its right ..
+        level.x = levelCount == 1 ? 0 : levels[1].width;
+        level.y = levelCount == 1 ? 0 : columnHeight;
+        columnHeight += levelCount == 1 ? 0 : level.height;
+        levelCount++;
+    }
+    for (uint32_t i = levelCount; i < DEPTH_PYRAMID_MAX_LEVELS; ++i)
+        levels[i] = {};
+
+    width = levelCount > 1 ? levels[1].width + (levelCount > 2 ? levels[2].width : 0) : 0;
+    height = levelCount > 1 ? (levels[1].height > columnHeight ? levels[1].height : columnHeight) : 0;
+}
+
+uint32_t DepthPyramidLayout::LevelForDistance(float pixels, uint32_t mipBias) const {
+    // .. floor(log2(pixels)) - mipBias, what firstbithigh gives SSAOPS ..
+    uint32_t distance = pixels >= 65536.0f ? 65535u : (pixels > 0.0f ? (uint32_t)pixels : 0u);
+    uint32_t level = 0;
+    while (level + 1 < levelCount && (distance >> (level + mipBias + 1)) != 0)
+        level++;
+    return level;
+}
+
+void DepthPyramid::Initialize(uint32_t width, uint32_t height) {
+    layout.Initialize(width, height);
+    texels.assign((size_t)layout.width * layout.height * 2, 0.0f);
+}
+
+// NOTE(pf): Level 1 is reduced in NDC and only its nearest and farthest values are linearized, a quarter of the
+// divisions. The mapping is monotonic, min and max of NDC depth are the min and max of view depth in some order.
+static void LinearizeTexel(const float *row0, const float *row1, uint32_t x0, uint32_t x1, float projA, float projB,
+                           float *out) {
+    float nearest = Min(Min(row0[x0], row1[x0]), Min(row0[x1], row1[x1]));
+    float farthest = Max(Max(row0[x0], row1[x0]), Max(row0[x1], row1[x1]));
+    float z0 = projB / (nearest - projA);
+    float z1 = projB / (farthest - projA);
+    out[0] = Min(z0, z1);
+    out[1] = Max(z0, z1);
+}
+
+// NOTE(pf): Full pairs of columns, returns the first level 1 texel left to the scalar loop.
+static uint32_t LinearizeRowSimd(const float *row0, const float *row1, uint32_t pairs, float projA, float projB,
+                                 float *out) {
+    uint32_t x = 0;
+#if defined(SIMD_AVX2)
+    __m256 a = _mm256_set1_ps(projA);
+    __m256 b = _mm256_set1_ps(projB);
+    for (; x + 8 <= pairs; x += 8) {
+        __m256 nearest0 = _mm256_min_ps(_mm256_loadu_ps(row0 + 2 * x), _mm256_loadu_ps(row1 + 2 * x));
+        __m256 nearest1 = _mm256_min_ps(_mm256_loadu_ps(row0 + 2 * x + 8), _mm256_loadu_ps(row1 + 2 * x + 8));
+        __m256 farthest0 = _mm256_max_ps(_mm256_loadu_ps(row0 + 2 * x), _mm256_loadu_ps(row1 + 2 * x));
+        __m256 farthest1 = _mm256_max_ps(_mm256_loadu_ps(row0 + 2 * x + 8), _mm256_loadu_ps(row1 + 2 * x + 8));
+
+        // .. even and odd columns per 128 bit lane, the texels come out as 0 1 4 5 | 2 3 6 7 ..
+        __m256 nearest = _mm256_min_ps(_mm256_shuffle_ps(nearest0, nearest1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                       _mm256_shuffle_ps(nearest0, nearest1, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m256 farthest = _mm256_max_ps(_mm256_shuffle_ps(farthest0, farthest1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                        _mm256_shuffle_ps(farthest0, farthest1, _MM_SHUFFLE(3, 1, 3, 1)));
+        nearest = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(nearest), _MM_SHUFFLE(3, 1, 2, 0)));
+        farthest = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(farthest), _MM_SHUFFLE(3, 1, 2, 0)));
+
+        __m256 z0 = _mm256_div_ps(b, _mm256_sub_ps(nearest, a));
+        __m256 z1 = _mm256_div_ps(b, _mm256_sub_ps(farthest, a));
+        __m256 lo = _mm256_min_ps(z0, z1);
+        __m256 hi = _mm256_max_ps(z0, z1);
+        __m256 pairs0 = _mm256_unpacklo_ps(lo, hi);
+        __m256 pairs1 = _mm256_unpackhi_ps(lo, hi);
+        _mm256_storeu_ps(out + 2 * x, _mm256_permute2f128_ps(pairs0, pairs1, 0x20));
+        _mm256_storeu_ps(out + 2 * x + 8, _mm256_permute2f128_ps(pairs0, pairs1, 0x31));
+    }
+#endif
+#if defined(SIMD_SSE2)
+    __m128 a4 = _mm_set1_ps(projA);
+    __m128 b4 = _mm_set1_ps(projB);
+    for (; x + 4 <= pairs; x += 4) {
+        __m128 r00 = _mm_loadu_ps(row0 + 2 * x), r01 = _mm_loadu_ps(row0 + 2 * x + 4);
+        __m128 r10 = _mm_loadu_ps(row1 + 2 * x), r11 = _mm_loadu_ps(row1 + 2 * x + 4);
+        __m128 nearest0 = _mm_min_ps(r00, r10), nearest1 = _mm_min_ps(r01, r11);
+        __m128 farthest0 = _mm_max_ps(r00, r10), farthest1 = _mm_max_ps(r01, r11);
+        __m128 nearest = _mm_min_ps(_mm_shuffle_ps(nearest0, nearest1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                    _mm_shuffle_ps(nearest0, nearest1, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128 farthest = _mm_max_ps(_mm_shuffle_ps(farthest0, farthest1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                     _mm_shuffle_ps(farthest0, farthest1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        __m128 z0 = _mm_div_ps(b4, _mm_sub_ps(nearest, a4));
+        __m128 z1 = _mm_div_ps(b4, _mm_sub_ps(farthest, a4));
+        __m128 lo = _mm_min_ps(z0, z1);
+        __m128 hi = _mm_max_ps(z0, z1);
+        _mm_storeu_ps(out + 2 * x, _mm_unpacklo_ps(lo, hi));
+        _mm_storeu_ps(out + 2 * x + 4, _mm_unpackhi_ps(lo, hi));
+    }
+#elif defined(SIMD_NEON)
+    float32x4_t a4 = vdupq_n_f32(projA);
+    float32x4_t b4 = vdupq_n_f32(projB);
+    for (; x + 4 <= pairs; x += 4) {
+        float32x4_t r00 = vld1q_f32(row0 + 2 * x), r01 = vld1q_f32(row0 + 2 * x + 4);
+        float32x4_t r10 = vld1q_f32(row1 + 2 * x), r11 = vld1q_f32(row1 + 2 * x + 4);
+        float32x4_t nearest = vpminq_f32(vminq_f32(r00, r10), vminq_f32(r01, r11));
+        float32x4_t farthest = vpmaxq_f32(vmaxq_f32(r00, r10), vmaxq_f32(r01, r11));
+
+        float32x4_t   z0 = vdivq_f32(b4, vsubq_f32(nearest, a4));
+        float32x4_t   z1 = vdivq_f32(b4, vsubq_f32(farthest, a4));
+        float32x4x2_t texels = {{vminq_f32(z0, z1), vmaxq_f32(z0, z1)}};
+        vst2q_f32(out + 2 * x, texels);
+    }
+#endif
+    return x;
+}
+
+static void ReduceTexel(const float *row0, const float *row1, uint32_t x0, uint32_t x1, float *out) {
+    out[0] = Min(Min(row0[x0 * 2], row1[x0 * 2]), Min(row0[x1 * 2], row1[x1 * 2]));
+    out[1] = Max(Max(row0[x0 * 2 + 1], row1[x0 * 2 + 1]), Max(row0[x1 * 2 + 1], row1[x1 * 2 + 1]));
+}
+
+// NOTE(pf): Texels are (min, max) pairs, the min lanes of the source reduce into the min lane of the result.
+static uint32_t ReduceRowSimd(const float *row0, const float *row1, uint32_t pairs, float *out) {
+    uint32_t x = 0;
+#if defined(SIMD_AVX2)
+    for (; x + 4 <= pairs; x += 4) {
+        __m256 a0 = _mm256_loadu_ps(row0 + 4 * x), a1 = _mm256_loadu_ps(row0 + 4 * x + 8);
+        __m256 b0 = _mm256_loadu_ps(row1 + 4 * x), b1 = _mm256_loadu_ps(row1 + 4 * x + 8);
+        __m256 mins = _mm256_shuffle_ps(_mm256_min_ps(a0, b0), _mm256_min_ps(a1, b1), _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 maxs = _mm256_shuffle_ps(_mm256_max_ps(a0, b0), _mm256_max_ps(a1, b1), _MM_SHUFFLE(3, 1, 3, 1));
+
+        // .. texels come out as 0 2 | 1 3, swapped back as 64 bit pairs ..
+        __m256 lo = _mm256_min_ps(_mm256_shuffle_ps(mins, mins, _MM_SHUFFLE(2, 0, 2, 0)),
+                                  _mm256_shuffle_ps(mins, mins, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m256 hi = _mm256_max_ps(_mm256_shuffle_ps(maxs, maxs, _MM_SHUFFLE(2, 0, 2, 0)),
+                                  _mm256_shuffle_ps(maxs, maxs, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m256 texels = _mm256_unpacklo_ps(lo, hi);
+        texels = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(texels), _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm256_storeu_ps(out + 2 * x, texels);
+    }
+#endif
+#if defined(SIMD_SSE2)
+    for (; x + 4 <= pairs; x += 4) {
+        __m128 mins[2], maxs[2];
+        for (int half = 0; half < 2; ++half) {
+            const float *r0 = row0 + 4 * x + 8 * half;
+            const float *r1 = row1 + 4 * x + 8 * half;
+            __m128       a0 = _mm_loadu_ps(r0), a1 = _mm_loadu_ps(r0 + 4);
+            __m128       b0 = _mm_loadu_ps(r1), b1 = _mm_loadu_ps(r1 + 4);
+            mins[half] = _mm_shuffle_ps(_mm_min_ps(a0, b0), _mm_min_ps(a1, b1), _MM_SHUFFLE(2, 0, 2, 0));
+            maxs[half] = _mm_shuffle_ps(_mm_max_ps(a0, b0), _mm_max_ps(a1, b1), _MM_SHUFFLE(3, 1, 3, 1));
+        }
+        __m128 lo = _mm_min_ps(_mm_shuffle_ps(mins[0], mins[1], _MM_SHUFFLE(2, 0, 2, 0)),
+                               _mm_shuffle_ps(mins[0], mins[1], _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128 hi = _mm_max_ps(_mm_shuffle_ps(maxs[0], maxs[1], _MM_SHUFFLE(2, 0, 2, 0)),
+                               _mm_shuffle_ps(maxs[0], maxs[1], _MM_SHUFFLE(3, 1, 3, 1)));
+        _mm_storeu_ps(out + 2 * x, _mm_unpacklo_ps(lo, hi));
+        _mm_storeu_ps(out + 2 * x + 4, _mm_unpackhi_ps(lo, hi));
+    }
+#elif defined(SIMD_NEON)
+    for (; x + 4 <= pairs; x += 4) {
+        float32x4x2_t a0 = vld2q_f32(row0 + 4 * x), a1 = vld2q_f32(row0 + 4 * x + 8);
+        float32x4x2_t b0 = vld2q_f32(row1 + 4 * x), b1 = vld2q_f32(row1 + 4 * x + 8);
+        float32x4x2_t texels = {{vpminq_f32(vminq_f32(a0.val[0], b0.val[0]), vminq_f32(a1.val[0], b1.val[0])),
+                                 vpmaxq_f32(vmaxq_f32(a0.val[1], b0.val[1]), vmaxq_f32(a1.val[1], b1.val[1]))}};
+        vst2q_f32(out + 2 * x, texels);
+    }
+#endif
+    return x;
+}
+
+static void BuildLevels(DepthPyramid &pyramid, const float *ndcDepth, float projA, float projB, bool useSimd) {
+    const DepthPyramidLayout &layout = pyramid.layout;
+    size_t                    pitch = (size_t)layout.width * 2;
+    uint32_t                  width = layout.levels[0].width;
+    uint32_t                  height = layout.levels[0].height;
+
+    // .. level 1 straight from the depth buffer, reads past the last row and column are clamped ..
+    if (layout.levelCount > 1) {
+        const DepthPyramidLevel &level = layout.levels[1];
+        for (uint32_t y = 0; y < level.height; ++y) {
+            const float *row0 = ndcDepth + (size_t)(2 * y) * width;
+            const float *row1 = ndcDepth + (size_t)(2 * y + 1 < height ? 2 * y + 1 : height - 1) * width;
+            float       *out = &pyramid.texels[(level.y + y) * pitch + level.x * 2];
+            uint32_t     x = useSimd ? LinearizeRowSimd(row0, row1, width / 2, projA, projB, out) : 0;
+            for (; x < level.width; ++x)
+                LinearizeTexel(row0, row1, 2 * x, 2 * x + 1 < width ? 2 * x + 1 : width - 1, projA, projB, &out[x * 2]);
+        }
+    }
+
+    for (uint32_t k = 2; k < layout.levelCount; ++k) {
+        const DepthPyramidLevel &source = layout.levels[k - 1];
+        const DepthPyramidLevel &level = layout.levels[k];
+        for (uint32_t y = 0; y < level.height; ++y) {
+            const float *row0 = &pyramid.texels[(source.y + 2 * y) * pitch + source.x * 2];
+            const float *row1 = &pyramid.texels[(source.y + (2 * y + 1 < source.height ? 2 * y + 1 : source.height - 1)) * pitch +
+                                                source.x * 2];
+            float       *out = &pyramid.texels[(level.y + y) * pitch + level.x * 2];
+            uint32_t     x = useSimd ? ReduceRowSimd(row0, row1, source.width / 2, out) : 0;
+            for (; x < level.width; ++x)
+                ReduceTexel(row0, row1, 2 * x, 2 * x + 1 < source.width ? 2 * x + 1 : source.width - 1, &out[x * 2]);
+        }
+    }
+}
+
+void DepthPyramid::Build(const float *ndcDepth, float projA, float projB) {
+    BuildLevels(*this, ndcDepth, projA, projB, true);
+}
+
+void DepthPyramid::BuildScalar(const float *ndcDepth, float projA, float projB) {
+    BuildLevels(*this, ndcDepth, projA, projB, false);
+}
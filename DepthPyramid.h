@@ -0,0 +1,60 @@
+#ifndef _DEPTH_PYRAMID_H_
+#define _DEPTH_PYRAMID_H_
+
+/* Min/max pyramid of linear view depth, the CPU reference of shaders/DepthPyramidCS.hlsl. SSAO taps far from
+ * their pixel read a coarser level, so the taps of neighbouring pixels land in the same few texels instead of
+ * being spread over the whole depth buffer.
+ *
+ * NOTE(pf): Level 0 is the depth buffer itself, read and linearized by the taps that stay close. Levels 1 and
+ * up hold (nearest, farthest) view depth and are packed into one two channel atlas instead of a mip chain:
+ * level 1 at the origin, the rest in a column to its right. Level k is ceil(size / 2^k) texels so texel x
+ * covers exactly the pixels [x * 2^k, (x + 1) * 2^k), D3D12's mips round down and would drop the last row and
+ * column of odd sizes. Reads past the end of a level are clamped to its last texel, which only repeats depths
+ * that are already part of the footprint, so every texel is the exact min and max of its pixels.
+ */
+
+#include "Common.h"
+#include <vector>
+
+static constexpr uint32_t DEPTH_PYRAMID_MAX_LEVELS = {13}; // Up to 4096 pixels per side, down to 1.
+static constexpr uint32_t DEPTH_PYRAMID_TILE_LEVELS = {6}; // Levels a DepthPyramidCS group reduces its tile by.
+static constexpr uint32_t DEPTH_PYRAMID_TILE_SIZE = {1 << DEPTH_PYRAMID_TILE_LEVELS};
+static constexpr uint32_t DEPTH_PYRAMID_MIP_BIAS = {3}; // Taps closer than 2^(bias + 1) pixels read level 0.
+static constexpr uint32_t DEPTH_PYRAMID_SCRATCH_HEADER = {4}; // 32 bit values before DepthPyramidCS's tile texels.
+
+struct DepthPyramidLevel {
+    uint32_t x, y; // Origin in the atlas, unused for level 0.
+    uint32_t width, height;
+};
+
+// NOTE(pf): Same rectangles DX12SSAOPass uploads to cbSsaoPass, levels past levelCount are empty.
+struct DepthPyramidLayout {
+    void     Initialize(uint32_t width, uint32_t height);
+    uint32_t LevelForDistance(float pixels, uint32_t mipBias = DEPTH_PYRAMID_MIP_BIAS) const;
+
+    uint32_t          width = 0, height = 0; // Atlas, in texels.
+    uint32_t          levelCount = 0;
+    DepthPyramidLevel levels[DEPTH_PYRAMID_MAX_LEVELS] = {};
+};
+
+struct DepthPyramid {
+    void Initialize(uint32_t width, uint32_t height);
+
+    // NOTE(pf): ndcDepth is the width x height depth buffer, view depth is projB / (ndc - projA) as in SSAOPS.
+    // Build uses the SIMD paths, BuildScalar is the reference they have to match bit for bit.
+    void Build(const float *ndcDepth, float projA, float projB);
+    void BuildScalar(const float *ndcDepth, float projA, float projB);
+
+    // Level 1 and up.
+    const float *Texel(uint32_t level, uint32_t x, uint32_t y) const {
+        const DepthPyramidLevel &rect = layout.levels[level];
+        return &texels[((size_t)(rect.y + y) * layout.width + rect.x + x) * 2];
+    }
+    float MinDepth(uint32_t level, uint32_t x, uint32_t y) const { return Texel(level, x, y)[0]; }
+    float MaxDepth(uint32_t level, uint32_t x, uint32_t y) const { return Texel(level, x, y)[1]; }
+
+    DepthPyramidLayout layout;
+    std::vector<float> texels; // (min, max) pairs, layout.width * layout.height of them.
+};
+
+#endif //!_DEPTH_PYRAMID_H_
@@ -0,0 +1,253 @@
+/* Checks and times the depth pyramid's CPU reference and measures what it saves SSAO, portable so it runs on
+ * the Linux build farm:
+ *   g++ -O2 -std=c++17 DepthPyramidBenchmark.cpp DepthPyramid.cpp SoftwareRenderer.cpp MeshData.cpp Culling.cpp
+ *       Mat4.cpp Timer.cpp -o DepthPyramidBenchmark
+ *   ./DepthPyramidBenchmark [--model models/skull.txt]
+ *
+ * Every texel of every level is compared against the min and max of its pixels computed the slow way, on random
+ * depth at odd and even sizes, and the SIMD build has to give the same bits as the scalar one. The skull scene of
+ * Benchmark is then shaded with and without the pyramid: every depth read of the SSAO pass goes through a small
+ * texture cache model, walked in 8x8 pixel tiles like a gpu's waves, and the bytes it misses are the bandwidth.
+ * The exit code is 1 if any texel or bit differs.
+ */
+
+#include "DepthPyramid.h"
+#include "Mat4.h"
+#include "MeshData.h"
+#include "SoftwareRenderer.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t PYRAMID_BUILD_ITERATIONS = {50};
+static constexpr uint32_t PYRAMID_SCENE_FRAMES = {4};
+static constexpr uint32_t PYRAMID_TILE = {8};              // Pixels per side shaded together.
+static constexpr uint32_t PYRAMID_READS_PER_PIXEL = {1 + SSAO_SAMPLE_COUNT};
+static constexpr uint32_t CACHE_LINE_BYTES = {64};
+static constexpr uint32_t CACHE_SETS = {64};
+static constexpr uint32_t CACHE_WAYS = {4}; // 16 KB, about an L1 texture cache.
+
+struct PyramidSize {
+    uint32_t width, height;
+};
+
+static const PyramidSize checkSizes[] = {{1, 1}, {2, 1}, {3, 5}, {17, 9}, {64, 64}, {65, 63}, {640, 360}, {1279, 719}, {1280, 720}};
+static const PyramidSize timedSizes[] = {{1280, 720}, {1920, 1080}};
+
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// NOTE(pf): Blocks of constant depth with noise on top, so neighbouring texels have both equal and differing
+// values, and some cleared pixels at 1.
+static void BuildRandomDepth(uint32_t width, uint32_t height, uint32_t seed, std::vector<float> &depth) {
+    uint32_t state = seed;
+    depth.resize((size_t)width * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t block = ((y / 7) * 31 + (x / 5)) * 2654435761u;
+            float    base = (block >> 8) * (1.0f / 16777216.0f);
+            float    value = NextRandom(state) < 0.05f ? 1.0f : 0.9f + 0.09f * base + 0.001f * NextRandom(state);
+            depth[(size_t)y * width + x] = value;
+        }
+    }
+}
+
+// .. the slow way: linearize every pixel of the texel's footprint ..
+static uint32_t CheckAgainstPixels(const DepthPyramid &pyramid, const float *depth, float projA, float projB) {
+    const DepthPyramidLayout &layout = pyramid.layout;
+    uint32_t                  width = layout.levels[0].width, height = layout.levels[0].height;
+    uint32_t                  mismatches = 0;
+    for (uint32_t k = 1; k < layout.levelCount; ++k) {
+        const DepthPyramidLevel &level = layout.levels[k];
+        for (uint32_t y = 0; y < level.height; ++y) {
+            for (uint32_t x = 0; x < level.width; ++x) {
+                float nearest = 1e30f, farthest = -1e30f;
+                for (uint32_t py = y << k; py < ((y + 1) << k) && py < height; ++py) {
+                    for (uint32_t px = x << k; px < ((x + 1) << k) && px < width; ++px) {
+                        float z = projB / (depth[(size_t)py * width + px] - projA);
+                        nearest = z < nearest ? z : nearest;
+                        farthest = z > farthest ? z : farthest;
+                    }
+                }
+                mismatches += pyramid.MinDepth(k, x, y) != nearest || pyramid.MaxDepth(k, x, y) != farthest;
+            }
+        }
+    }
+    return mismatches;
+}
+
+struct TextureCache {
+    uint32_t tags[CACHE_SETS][CACHE_WAYS];
+    uint32_t ages[CACHE_SETS][CACHE_WAYS];
+    uint32_t clock;
+    uint64_t misses;
+
+    void Reset() {
+        memset(tags, 0xFF, sizeof(tags));
+        memset(ages, 0, sizeof(ages));
+        clock = 0;
+        misses = 0;
+    }
+
+    void Read(uint32_t address) {
+        uint32_t line = address / CACHE_LINE_BYTES;
+        uint32_t set = line % CACHE_SETS;
+        uint32_t oldest = 0;
+        clock++;
+        for (uint32_t way = 0; way < CACHE_WAYS; ++way) {
+            if (tags[set][way] == line) {
+                ages[set][way] = clock;
+                return;
+            }
+            oldest = ages[set][way] < ages[set][oldest] ? way : oldest;
+        }
+        tags[set][oldest] = line;
+        ages[set][oldest] = clock;
+        misses++;
+    }
+};
+
+// NOTE(pf): ComputeSsao reads in rows, the gpu shades tile by tile. Reads of a pixel stay together.
+static uint64_t MissedBytes(const std::vector<uint32_t> &reads, uint32_t width, uint32_t height, TextureCache &cache) {
+    cache.Reset();
+    for (uint32_t tileY = 0; tileY < height; tileY += PYRAMID_TILE) {
+        for (uint32_t tileX = 0; tileX < width; tileX += PYRAMID_TILE) {
+            for (uint32_t y = tileY; y < tileY + PYRAMID_TILE && y < height; ++y) {
+                for (uint32_t x = tileX; x < tileX + PYRAMID_TILE && x < width; ++x) {
+                    const uint32_t *pixelReads = &reads[((size_t)y * width + x) * PYRAMID_READS_PER_PIXEL];
+                    for (uint32_t i = 0; i < PYRAMID_READS_PER_PIXEL; ++i)
+                        cache.Read(pixelReads[i]);
+                }
+            }
+        }
+    }
+    return cache.misses * CACHE_LINE_BYTES;
+}
+
+// NOTE(pf): Same scene and camera as Benchmark's skull_rotation_720p.
+static void BuildScene(double time, uint32_t width, uint32_t height, Mat4 &world, Mat4 &view, Mat4 &proj) {
+    float angle = ConvertToRadians(fmodf((float)(time * 90.0), 360.0f));
+    world = Mat4RotationAxis(0.0f, 1.0f, 1.0f, angle);
+
+    const float eye[3] = {0.0f, 5.0f, -25.0f};
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    view = Mat4LookAtLH(eye, focus, up);
+    proj = Mat4PerspectiveFovLH(ConvertToRadians(45.0f), width / (float)height, 1.0f, 1000.0f);
+}
+
+int main(int argc, char **argv) {
+    const char *modelPath = "models/skull.txt";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+    }
+
+    // .. projection of the scene below, A = f / (f - n) and B = -n * f / (f - n) ..
+    const float projA = 1000.0f / 999.0f;
+    const float projB = -1000.0f / 999.0f;
+
+    uint32_t           texelMismatches = 0, simdMismatches = 0;
+    std::vector<float> depth;
+    for (const PyramidSize &size : checkSizes) {
+        BuildRandomDepth(size.width, size.height, size.width * 7919u + size.height, depth);
+        DepthPyramid simd, scalar;
+        simd.Initialize(size.width, size.height);
+        scalar.Initialize(size.width, size.height);
+        simd.Build(depth.data(), projA, projB);
+        scalar.BuildScalar(depth.data(), projA, projB);
+        simdMismatches += memcmp(simd.texels.data(), scalar.texels.data(), simd.texels.size() * sizeof(float)) != 0;
+        texelMismatches += CheckAgainstPixels(scalar, depth.data(), projA, projB);
+    }
+
+    printf("{\"benchmark\": \"depth_pyramid\", \"texel_mismatches\": %u, \"simd_mismatches\": %u,\n  \"builds\": [",
+           texelMismatches, simdMismatches);
+    for (size_t s = 0; s < sizeof(timedSizes) / sizeof(timedSizes[0]); ++s) {
+        const PyramidSize &size = timedSizes[s];
+        BuildRandomDepth(size.width, size.height, 1, depth);
+        DepthPyramid pyramid;
+        pyramid.Initialize(size.width, size.height);
+
+        double ms[2];
+        for (int useSimd = 0; useSimd < 2; ++useSimd) {
+            int64_t start = HiResPerformanceQuery();
+            for (uint32_t i = 0; i < PYRAMID_BUILD_ITERATIONS; ++i) {
+                if (useSimd)
+                    pyramid.Build(depth.data(), projA, projB);
+                else
+                    pyramid.BuildScalar(depth.data(), projA, projB);
+            }
+            ms[useSimd] = HiResMilliseconds(HiResPerformanceQuery() - start) / PYRAMID_BUILD_ITERATIONS;
+        }
+        printf("%s\n    {\"width\": %u, \"height\": %u, \"levels\": %u, \"atlas_texels\": %u, \"scalar_ms\": %.3f, "
+               "\"simd_ms\": %.3f}",
+               s == 0 ? "" : ",", size.width, size.height, pyramid.layout.levelCount,
+               pyramid.layout.width * pyramid.layout.height, ms[0], ms[1]);
+    }
+    printf("\n  ]");
+
+    MeshData mesh;
+    if (LoadTextMesh(modelPath, mesh)) {
+        const uint32_t width = 1280, height = 720;
+        SoftwareRenderer renderer;
+        renderer.Initialize(width, height);
+
+        std::vector<uint32_t> reads;
+        std::vector<float>    referenceAmbient;
+        TextureCache         *cache = new TextureCache();
+        uint64_t              depthBytes[2] = {}, buildBytes = 0;
+        double                ambientError = 0.0, maxAmbientError = 0.0;
+        renderer.ssaoDepthReads = &reads;
+        for (uint32_t frame = 0; frame < PYRAMID_SCENE_FRAMES; ++frame) {
+            Mat4 world, view, proj;
+            BuildScene(frame * 0.25, width, height, world, view, proj);
+            renderer.BeginFrame();
+            renderer.DrawMeshInstances(mesh, &world, 1, view, proj);
+
+            for (int usePyramid = 0; usePyramid < 2; ++usePyramid) {
+                reads.clear();
+                reads.reserve((size_t)width * height * PYRAMID_READS_PER_PIXEL);
+                renderer.ssaoSettings.useDepthPyramid = usePyramid != 0;
+                renderer.ComputeSsao(proj);
+                depthBytes[usePyramid] += MissedBytes(reads, width, height, *cache);
+                if (!usePyramid) {
+                    referenceAmbient = renderer.ambient;
+                    continue;
+                }
+                for (size_t i = 0; i < referenceAmbient.size(); ++i) {
+                    double error = fabs((double)renderer.ambient[i] - referenceAmbient[i]);
+                    ambientError += error;
+                    maxAmbientError = error > maxAmbientError ? error : maxAmbientError;
+                }
+            }
+
+            // .. building it reads the depth buffer once and writes every atlas texel ..
+            const DepthPyramidLayout &layout = renderer.depthPyramid.layout;
+            buildBytes += (uint64_t)width * height * 4;
+            for (uint32_t k = 1; k < layout.levelCount; ++k)
+                buildBytes += (uint64_t)layout.levels[k].width * layout.levels[k].height * 8;
+        }
+        delete cache;
+
+        double pixels = (double)width * height * PYRAMID_SCENE_FRAMES;
+        printf(",\n  \"ssao\": {\"width\": %u, \"height\": %u, \"frames\": %u, \"depth_bytes_per_pixel\": %.3f, "
+               "\"pyramid_bytes_per_pixel\": %.3f, \"pyramid_build_bytes_per_pixel\": %.3f, "
+               "\"mean_ambient_error\": %.5f, \"max_ambient_error\": %.4f}",
+               width, height, PYRAMID_SCENE_FRAMES, depthBytes[0] / pixels, depthBytes[1] / pixels, buildBytes / pixels,
+               ambientError / (double)(pixels), maxAmbientError);
+    } else {
+        fprintf(stderr, "Failed to load %s, skipping the ssao comparison\n", modelPath);
+    }
+    printf("\n}\n");
+
+    if (texelMismatches || simdMismatches) {
+        fprintf(stderr, "%u texels differ from their pixels, %u sizes differ between the SIMD and scalar builds\n",
+                texelMismatches, simdMismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "DynamicResolution.h"
+#include <math.h>
+
+void DynamicResolution::Initialize(const DynamicResolutionSettings &_settings) {
+    settings = _settings;
+    scale = settings.maxScale;
+    logArea = 2.0 * log((double)scale);
+    errors[0] = 0.0;
+    errors[1] = 0.0;
+    updates = 0;
+    scaleChanges = 0;
+}
+
+float DynamicResolution::Update(double gpuMs, float measuredScale) {
+    if (gpuMs <= 0.0 || measuredScale <= 0.0f)
+        return scale;
+
+    // .. positive when there is time left, zero on target ..
+    // NOTE(pf): The frames still in flight already render at the current scale, the error is moved by the
+    // difference so the latency does not wind the controller up.
+    double target = settings.budgetMs * (1.0 - settings.headroom);
+    double error = log(target / gpuMs) - 2.0 * (log((double)scale) - log((double)measuredScale));
+    if (updates == 0)
+        errors[0] = errors[1] = error;
+    double delta = settings.kp * (error - errors[0]) + settings.ki * error +
+                   settings.kd * (error - 2.0 * errors[0] + errors[1]);
+    errors[1] = errors[0];
+    errors[0] = error;
+    updates++;
+
+    // .. clamping the integral is the anti-windup ..
+    double minLogArea = 2.0 * log((double)settings.minScale);
+    double maxLogArea = 2.0 * log((double)settings.maxScale);
+    logArea += delta;
+    logArea = logArea < minLogArea ? minLogArea : (logArea > maxLogArea ? maxLogArea : logArea);
+
+    // .. quantize, the current step is kept until the wanted scale is far enough from it ..
+    float wanted = (float)exp(0.5 * logArea);
+    if (fabsf(wanted - scale) < settings.hysteresis * settings.scaleStep)
+        return scale;
+    float quantized = floorf(wanted / settings.scaleStep + 0.5f) * settings.scaleStep;
+    quantized = Clamp(quantized, settings.minScale, settings.maxScale);
+
+    // NOTE(pf): A target between two steps would otherwise make the scale cycle between them. Going up has to
+    // be predicted to fit, until then the integral is held at the current step.
+    if (quantized > scale && error < 2.0 * log((double)quantized / scale)) {
+        logArea = 2.0 * log((double)scale);
+        return scale;
+    }
+    if (quantized != scale) {
+        scale = quantized;
+        scaleChanges++;
+    }
+    return scale;
+}
+
+void DynamicResolution::RenderSize(uint32_t width, uint32_t height, uint32_t &renderWidth,
+                                   uint32_t &renderHeight) const {
+    renderWidth = (uint32_t)(width * scale + 0.5f);
+    renderHeight = (uint32_t)(height * scale + 0.5f);
+    renderWidth = renderWidth > 0 ? renderWidth : 1;
+    renderHeight = renderHeight > 0 ? renderHeight : 1;
+}
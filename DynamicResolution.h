@@ -0,0 +1,46 @@
+#ifndef _DYNAMIC_RESOLUTION_H_
+#define _DYNAMIC_RESOLUTION_H_
+
+/* Picks the render scale from measured gpu frame times so the gpu stays within a budget.
+ *
+ * NOTE(pf): Gpu cost is close to proportional to the pixel count, so the controller integrates the log of the
+ * time under the target into the log of the rendered area. Gpu times arrive frames after the frame was
+ * submitted, the error is predicted forward to the current scale first (a Smith predictor), which keeps the
+ * latency from winding the controller up. Scales are quantized and only change once the wanted scale has
+ * moved most of a step away, so noise does not make the resolution flicker.
+ */
+
+#include "Common.h"
+
+struct DynamicResolutionSettings {
+    double budgetMs = {1000.0 / 60.0};
+    double headroom = {0.1}; // Fraction of the budget kept free for spikes.
+    float  minScale = {0.5f}; // Per axis.
+    float  maxScale = {1.0f};
+    float  scaleStep = {1.0f / 32.0f};
+    float  hysteresis = {1.0f}; // In steps.
+
+    // .. incremental gains on the log error ..
+    double kp = {0.1};
+    double ki = {0.2};
+    double kd = {0.0};
+};
+
+struct DynamicResolution {
+    void Initialize(const DynamicResolutionSettings &settings);
+
+    // NOTE(pf): gpuMs is the gpu time of a frame rendered at measuredScale, times of zero or less are ignored.
+    // Returns the scale for the next frame.
+    float Update(double gpuMs, float measuredScale);
+    float Scale() const { return scale; }
+    void  RenderSize(uint32_t width, uint32_t height, uint32_t &renderWidth, uint32_t &renderHeight) const;
+
+    DynamicResolutionSettings settings;
+    float                     scale = {1.0f};
+    double                    logArea = {0.0};  // Integral, unquantized, of the full resolution's area.
+    double                    errors[2] = {};   // Previous two log errors, newest first.
+    uint32_t                  updates = {0};
+    uint32_t                  scaleChanges = {0};
+};
+
+#endif //!_DYNAMIC_RESOLUTION_H_
@@ -0,0 +1,197 @@
+/* Replays synthetic gpu frame time traces through the dynamic resolution controller, portable so it runs on
+ * the Linux build farm:
+ *   g++ -O2 -std=c++17 DynamicResolutionTool.cpp DynamicResolution.cpp -o DynamicResolutionTool
+ *   ./DynamicResolutionTool [--trace stats.csv]
+ *
+ * The gpu is modelled as a fixed cost plus a cost per rendered pixel, its times reach the controller
+ * DYNRES_LATENCY_FRAMES late like the timestamps the renderer reads back. Every scenario reports how long the
+ * controller took to settle, how often the budget was missed after that and how often the scale changed. The
+ * exit code is 1 if a scenario does not settle or misses the budget more often than it allows.
+ *
+ * --trace replays the gpu_ms column of an App --stats-csv export instead, the recorded frames are taken as
+ * full resolution costs.
+ */
+
+#include "DynamicResolution.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t DYNRES_FRAMES = {1200};
+static constexpr uint32_t DYNRES_LATENCY_FRAMES = {3}; // NUM_FRAMES in DX12.h.
+static constexpr double   DYNRES_FIXED_MS = {1.5};     // Composite and clears, independent of the scale.
+static constexpr double   DYNRES_SETTLED_BAND = {0.1}; // Mean within 10% of the target.
+static constexpr uint32_t DYNRES_MEAN_FRAMES = {8};
+static constexpr uint32_t DYNRES_SETTLED_FRAMES = {30};
+
+struct DynresScenario {
+    const char *name;
+    double      fullMs;    // Scaled part at full resolution.
+    double      stepMs;    // Scaled part from stepFrame on, 0 for none.
+    uint32_t    stepFrame;
+    double      noise;     // Relative, uniform.
+    double      spikeRate; // Frames that cost spikeScale times as much.
+    double      spikeScale;
+    uint32_t    maxSettleFrames;
+    double      maxMissRate; // Of the frames after settling.
+};
+
+static const DynresScenario scenarios[] = {
+    {"light", 8.0, 0.0, 0, 0.0, 0.0, 1.0, 10, 0.0},
+    {"heavy", 30.0, 0.0, 0, 0.0, 0.0, 1.0, 30, 0.0},
+    {"step_up", 8.0, 30.0, 400, 0.0, 0.0, 1.0, 30, 0.0},
+    {"step_down", 30.0, 8.0, 400, 0.0, 0.0, 1.0, 60, 0.0},
+    {"noisy", 24.0, 0.0, 0, 0.1, 0.0, 1.0, 60, 0.05},
+    {"spikes", 24.0, 0.0, 0, 0.03, 0.03, 2.0, 60, 0.05},
+    {"over_min_scale", 80.0, 0.0, 0, 0.0, 0.0, 1.0, 30, 1.0},
+};
+
+struct DynresResult {
+    uint32_t settleFrame; // First frame of the last streak that stayed settled, DYNRES_FRAMES if none.
+    double   missRate;    // Over budget after settling.
+    double   meanScale;
+    double   maxMs;
+    uint32_t scaleChanges;
+};
+
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// NOTE(pf): fullMs[i] is the scaled cost of frame i at full resolution, a step in it restarts the settle count.
+static DynresResult Simulate(const std::vector<double> &fullMs, uint32_t settleFrom) {
+    DynamicResolution controller;
+    controller.Initialize(DynamicResolutionSettings());
+    double target = controller.settings.budgetMs * (1.0 - controller.settings.headroom);
+
+    std::vector<double> gpuMs(fullMs.size());
+    std::vector<float>  scales(fullMs.size());
+    DynresResult        result = {(uint32_t)fullMs.size(), 0.0, 0.0, 0.0, 0};
+    uint32_t            settledStreak = 0;
+    uint32_t            misses = 0, framesAfterSettle = 0;
+    for (size_t i = 0; i < fullMs.size(); ++i) {
+        if (i >= DYNRES_LATENCY_FRAMES) {
+            size_t measured = i - DYNRES_LATENCY_FRAMES;
+            controller.Update(gpuMs[measured], scales[measured]);
+        }
+        scales[i] = controller.Scale();
+        gpuMs[i] = DYNRES_FIXED_MS + fullMs[i] * scales[i] * scales[i];
+        result.meanScale += scales[i];
+        result.maxMs = gpuMs[i] > result.maxMs ? gpuMs[i] : result.maxMs;
+
+        // .. settled once the time stays near the target, or the scale stays at a bound it has to be at ..
+        bool atBound = (scales[i] == controller.settings.maxScale && gpuMs[i] < target) ||
+                       (scales[i] == controller.settings.minScale && gpuMs[i] > target);
+        double meanMs = 0.0;
+        for (size_t k = i + 1 - (i < DYNRES_MEAN_FRAMES ? i + 1 : DYNRES_MEAN_FRAMES); k <= i; ++k)
+            meanMs += gpuMs[k];
+        meanMs /= i < DYNRES_MEAN_FRAMES ? i + 1 : DYNRES_MEAN_FRAMES;
+        bool nearTarget = fabs(meanMs - target) <= DYNRES_SETTLED_BAND * target;
+        if (i < settleFrom) {
+            settledStreak = 0;
+        } else if (atBound || nearTarget) {
+            settledStreak++;
+            if (settledStreak == DYNRES_SETTLED_FRAMES && result.settleFrame == fullMs.size())
+                result.settleFrame = (uint32_t)(i + 1 - DYNRES_SETTLED_FRAMES);
+        } else if (result.settleFrame == fullMs.size()) {
+            settledStreak = 0;
+        }
+        if (result.settleFrame != fullMs.size()) {
+            framesAfterSettle++;
+            misses += gpuMs[i] > controller.settings.budgetMs;
+        }
+    }
+    result.missRate = framesAfterSettle ? misses / (double)framesAfterSettle : 0.0;
+    result.meanScale /= fullMs.size();
+    result.scaleChanges = controller.scaleChanges;
+    return result;
+}
+
+static void BuildTrace(const DynresScenario &scenario, std::vector<double> &fullMs) {
+    uint32_t state = 1;
+    fullMs.resize(DYNRES_FRAMES);
+    for (uint32_t i = 0; i < DYNRES_FRAMES; ++i) {
+        double ms = scenario.stepMs > 0.0 && i >= scenario.stepFrame ? scenario.stepMs : scenario.fullMs;
+        ms *= 1.0 + scenario.noise * (2.0 * NextRandom(state) - 1.0);
+        if (NextRandom(state) < scenario.spikeRate)
+            ms *= scenario.spikeScale;
+        fullMs[i] = ms;
+    }
+}
+
+// NOTE(pf): FrameStats::ExportCsv, the header names the columns.
+static bool LoadTrace(const char *path, std::vector<double> &fullMs) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+    char line[512];
+    int  gpuColumn = -1;
+    if (fgets(line, sizeof(line), file)) {
+        int column = 0;
+        for (char *token = strtok(line, ",\r\n"); token; token = strtok(nullptr, ",\r\n"), ++column) {
+            if (strcmp(token, "gpu_ms") == 0)
+                gpuColumn = column;
+        }
+    }
+    while (gpuColumn >= 0 && fgets(line, sizeof(line), file)) {
+        int column = 0;
+        for (char *token = strtok(line, ",\r\n"); token; token = strtok(nullptr, ",\r\n"), ++column) {
+            if (column == gpuColumn) {
+                double ms = atof(token) - DYNRES_FIXED_MS;
+                fullMs.push_back(ms > 0.0 ? ms : 0.0);
+            }
+        }
+    }
+    fclose(file);
+    return gpuColumn >= 0 && !fullMs.empty();
+}
+
+static void PrintResult(const char *name, const DynresResult &result, uint32_t frames, bool first) {
+    printf("%s\n  {\"name\": \"%s\", \"settle_frame\": %d, \"miss_rate\": %.4f, \"mean_scale\": %.3f, "
+           "\"max_ms\": %.2f, \"scale_changes\": %u}",
+           first ? "" : ",", name, result.settleFrame < frames ? (int)result.settleFrame : -1, result.missRate,
+           result.meanScale, result.maxMs, result.scaleChanges);
+}
+
+int main(int argc, char **argv) {
+    const char *tracePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+    }
+
+    if (tracePath) {
+        std::vector<double> fullMs;
+        if (!LoadTrace(tracePath, fullMs)) {
+            fprintf(stderr, "Failed to read a gpu_ms column from %s\n", tracePath);
+            return 1;
+        }
+        printf("{\"benchmark\": \"dynamic_resolution\", \"scenarios\": [");
+        PrintResult(tracePath, Simulate(fullMs, 0), (uint32_t)fullMs.size(), true);
+        printf("\n]}\n");
+        return 0;
+    }
+
+    uint32_t failures = 0;
+    printf("{\"benchmark\": \"dynamic_resolution\", \"scenarios\": [");
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); ++s) {
+        const DynresScenario &scenario = scenarios[s];
+        std::vector<double>   fullMs;
+        BuildTrace(scenario, fullMs);
+        DynresResult result = Simulate(fullMs, scenario.stepMs > 0.0 ? scenario.stepFrame : 0);
+        PrintResult(scenario.name, result, DYNRES_FRAMES, s == 0);
+
+        uint32_t settleFrames = result.settleFrame - (scenario.stepMs > 0.0 ? scenario.stepFrame : 0);
+        if (result.settleFrame >= DYNRES_FRAMES || settleFrames > scenario.maxSettleFrames ||
+            result.missRate > scenario.maxMissRate) {
+            fprintf(stderr, "%s: settled after %u frames, missed %.1f%% of the budget\n", scenario.name,
+                    settleFrames, 100.0 * result.missRate);
+            failures++;
+        }
+    }
+    printf("\n]}\n");
+    return failures ? 1 : 0;
+}
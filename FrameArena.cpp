@@ -0,0 +1,140 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr size_t FRAME_ARENA_GRANULARITY = {64u << 10}; // A grown block is rounded up to it.
+
+static std::atomic<FrameArenaThread *> frameArenaThreads = {nullptr};
+static thread_local FrameArenaThread  *frameArenaThread = nullptr;
+static std::atomic<uint64_t>           frameArenaFrame = {1};
+static uint32_t                        frameArenaFrameCount = {1};
+static size_t                          frameArenaCapacity = {FRAME_ARENA_DEFAULT_CAPACITY};
+
+void LinearArena::Initialize(size_t capacity) {
+    CleanUp();
+    blocks.push_back({(uint8_t *)malloc(capacity), capacity, 0});
+}
+
+void LinearArena::CleanUp() {
+    for (Block &block : blocks)
+        free(block.data);
+    blocks.clear();
+    current = 0;
+    used = 0;
+    highWater = 0;
+    chainedBlocks = 0;
+}
+
+void *LinearArena::Allocate(size_t bytes, size_t alignment) {
+    if (blocks.empty())
+        Initialize();
+
+    Block    *block = &blocks[current];
+    uintptr_t start = ((uintptr_t)block->data + block->top + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (start + bytes > (uintptr_t)block->data + block->size) {
+        // .. reuse the block chained after this one when it fits, otherwise chain one that does ..
+        size_t needed = bytes + alignment;
+        if (current + 1 >= blocks.size() || blocks[current + 1].size < needed) {
+            for (size_t b = current + 1; b < blocks.size(); ++b)
+                free(blocks[b].data);
+            blocks.resize(current + 1);
+            size_t size = std::max(blocks[0].size, needed);
+            blocks.push_back({(uint8_t *)malloc(size), size, 0});
+            chainedBlocks++;
+        }
+        block = &blocks[++current];
+        start = ((uintptr_t)block->data + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    used += start - ((uintptr_t)block->data + block->top) + bytes;
+    highWater = std::max(highWater, used);
+    block->top = start + bytes - (uintptr_t)block->data;
+    if (poison)
+        memset((void *)start, FRAME_ARENA_ALLOCATED_BYTE, bytes);
+    return (void *)start;
+}
+
+void LinearArena::Rewind(const ArenaMarker &marker) {
+    if (blocks.empty())
+        return;
+    for (uint32_t b = current; b > marker.block; --b) {
+        if (poison)
+            memset(blocks[b].data, FRAME_ARENA_FREED_BYTE, blocks[b].top);
+        blocks[b].top = 0;
+    }
+    Block &block = blocks[marker.block];
+    if (poison)
+        memset(block.data + marker.offset, FRAME_ARENA_FREED_BYTE, block.top - marker.offset);
+    block.top = marker.offset;
+    current = marker.block;
+    used = marker.used;
+}
+
+void LinearArena::Reset() {
+    Rewind({0, 0, 0});
+    if (blocks.size() > 1) {
+        // NOTE(pf): Alignment padding depends on where the block lands, the rounding leaves room for it.
+        size_t size = std::max(blocks[0].size, (highWater + FRAME_ARENA_GRANULARITY) & ~(FRAME_ARENA_GRANULARITY - 1));
+        for (Block &block : blocks)
+            free(block.data);
+        blocks.clear();
+        blocks.push_back({(uint8_t *)malloc(size), size, 0});
+    }
+}
+
+void FrameArenaInitialize(uint32_t frameCount, size_t capacity) {
+    frameArenaFrameCount = std::min(std::max(frameCount, 1u), FRAME_ARENA_MAX_FRAMES);
+    frameArenaCapacity = capacity;
+}
+
+void FrameArenaBeginFrame() {
+    frameArenaFrame.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t FrameArenaFrame() {
+    return frameArenaFrame.load(std::memory_order_acquire);
+}
+
+LinearArena &FrameArena() {
+    if (!frameArenaThread) {
+        // NOTE(pf): Never freed, like the profiler's buffers, threads come and go rarely.
+        FrameArenaThread *thread = new FrameArenaThread();
+        FrameArenaThread *head = frameArenaThreads.load(std::memory_order_relaxed);
+        do {
+            thread->next = head;
+        } while (!frameArenaThreads.compare_exchange_weak(head, thread, std::memory_order_release, std::memory_order_relaxed));
+        frameArenaThread = thread;
+    }
+
+    uint64_t     frame = FrameArenaFrame();
+    uint32_t     slot = (uint32_t)(frame % frameArenaFrameCount);
+    LinearArena &arena = frameArenaThread->arenas[slot];
+    if (frameArenaThread->frames[slot] != frame) {
+        if (arena.blocks.empty())
+            arena.Initialize(frameArenaCapacity);
+        else
+            arena.Reset();
+        frameArenaThread->frames[slot] = frame;
+    }
+    return arena;
+}
+
+FrameArenaStats FrameArenaCollectStats() {
+    FrameArenaStats stats = {};
+    uint64_t        frame = FrameArenaFrame();
+    uint32_t        slot = (uint32_t)(frame % frameArenaFrameCount);
+    for (FrameArenaThread *thread = frameArenaThreads.load(std::memory_order_acquire); thread; thread = thread->next) {
+        stats.threads++;
+        if (thread->frames[slot] == frame)
+            stats.used += thread->arenas[slot].used;
+        for (const LinearArena &arena : thread->arenas) {
+            stats.highWater = std::max(stats.highWater, arena.highWater);
+            stats.chainedBlocks += arena.chainedBlocks;
+            for (const LinearArena::Block &block : arena.blocks)
+                stats.reserved += block.size;
+        }
+    }
+    return stats;
+}
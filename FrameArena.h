@@ -0,0 +1,125 @@
+#ifndef _FRAME_ARENA_H_
+#define _FRAME_ARENA_H_
+
+/* Linear arenas for transient cpu allocations, one per thread and frame in flight, and an allocator adapter so
+ * std containers can live in them.
+ *
+ * NOTE(pf): An allocation bumps an offset into the arena's current block and is never freed on its own, the
+ * whole arena is rewound to a marker or reset. When a block runs out a new one is chained on, big enough for
+ * the request, and the next Reset replaces the chain by one block that covers the high water, so a frame that
+ * once needed more only pays for it once. Debug builds poison what is handed out and what is given back, so
+ * reads of uninitialized or stale frame memory stand out.
+ *
+ * FrameArena() is the calling thread's arena of the current frame. Threads register theirs on first use, like
+ * the profiler's buffers. FrameArenaBeginFrame advances the frame, every thread's arena of the new frame is
+ * reset the first time that thread asks for it, so what a frame allocated stays valid until frameCount frames
+ * later. A renderer that hands frame memory to the gpu begins a frame once the fence of the frame that last used
+ * its back buffer has passed and uses NUM_FRAMES. DX12 does not use them, its per frame vectors are members that
+ * keep their capacity, see FrameArenaBenchmark for where an arena beats malloc.
+ */
+
+#include "Common.h"
+#include <vector>
+
+static constexpr size_t   FRAME_ARENA_DEFAULT_CAPACITY = {1u << 20}; // Bytes of an arena's first block.
+static constexpr size_t   FRAME_ARENA_DEFAULT_ALIGNMENT = {16};
+static constexpr uint32_t FRAME_ARENA_MAX_FRAMES = {4};
+static constexpr uint8_t  FRAME_ARENA_ALLOCATED_BYTE = {0xcd};
+static constexpr uint8_t  FRAME_ARENA_FREED_BYTE = {0xdd};
+#if defined(DEBUG) || defined(_DEBUG)
+static constexpr bool FRAME_ARENA_POISON = {true};
+#else
+static constexpr bool FRAME_ARENA_POISON = {false};
+#endif
+
+struct ArenaMarker {
+    uint32_t block;
+    size_t   offset;
+    size_t   used;
+};
+
+struct LinearArena {
+    void  Initialize(size_t capacity = FRAME_ARENA_DEFAULT_CAPACITY);
+    void  CleanUp();
+    // NOTE(pf): alignment is a power of two. Never fails, a request that does not fit chains a block.
+    void *Allocate(size_t bytes, size_t alignment = FRAME_ARENA_DEFAULT_ALIGNMENT);
+    template <typename T> T *AllocateArray(size_t count) { return (T *)Allocate(count * sizeof(T), alignof(T)); }
+
+    // NOTE(pf): Everything allocated after the marker is given back, chained blocks stay until the next Reset.
+    ArenaMarker Mark() const { return {current, blocks.empty() ? 0 : blocks[current].top, used}; }
+    void        Rewind(const ArenaMarker &marker);
+    // NOTE(pf): Gives everything back and, when blocks were chained, replaces them by one of the high water.
+    void        Reset();
+
+    struct Block {
+        uint8_t *data;
+        size_t   size;
+        size_t   top;
+    };
+    std::vector<Block> blocks;
+    uint32_t           current = {0};
+    size_t             used = {0};      // Bytes handed out since the last Reset, alignment padding included.
+    size_t             highWater = {0}; // Most used at once since Initialize.
+    uint32_t           chainedBlocks = {0}; // Blocks chained since Initialize.
+    bool               poison = {FRAME_ARENA_POISON};
+};
+
+// NOTE(pf): Rewinds the arena when it goes out of scope, for scratch that does not outlive a function.
+struct ArenaScope {
+    explicit ArenaScope(LinearArena &_arena) : arena(_arena), marker(_arena.Mark()) {}
+    ~ArenaScope() { arena.Rewind(marker); }
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+    LinearArena &arena;
+    ArenaMarker  marker;
+};
+
+struct FrameArenaThread {
+    LinearArena       arenas[FRAME_ARENA_MAX_FRAMES];
+    uint64_t          frames[FRAME_ARENA_MAX_FRAMES] = {}; // Frame each arena was last reset for.
+    FrameArenaThread *next = nullptr;
+};
+
+struct FrameArenaStats {
+    uint32_t threads;
+    size_t   used;      // Of the current frame, over every thread.
+    size_t   highWater; // Largest of any one arena.
+    size_t   reserved;  // Bytes of every block.
+    uint32_t chainedBlocks;
+};
+
+// NOTE(pf): Before any thread allocates, frameCount at most FRAME_ARENA_MAX_FRAMES. Without it every thread gets
+// one arena of FRAME_ARENA_DEFAULT_CAPACITY, reset every frame.
+void             FrameArenaInitialize(uint32_t frameCount, size_t capacity = FRAME_ARENA_DEFAULT_CAPACITY);
+void             FrameArenaBeginFrame();
+uint64_t         FrameArenaFrame();
+LinearArena     &FrameArena();
+// NOTE(pf): Reads every thread's arenas, meant for while the other threads do not allocate, like the end of a frame.
+FrameArenaStats  FrameArenaCollectStats();
+
+// NOTE(pf): deallocate is a no-op, the memory comes back with the arena's Rewind or Reset. Containers must not
+// outlive that. Default constructed adapters allocate from the calling thread's frame arena.
+template <typename T> struct ArenaAllocator {
+    typedef T value_type;
+
+    ArenaAllocator() : arena(&FrameArena()) {}
+    ArenaAllocator(LinearArena &_arena) : arena(&_arena) {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T   *allocate(size_t count) { return arena->AllocateArray<T>(count); }
+    void deallocate(T *, size_t) {}
+
+    LinearArena *arena;
+};
+
+template <typename T, typename U> bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena == b.arena;
+}
+template <typename T, typename U> bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena != b.arena;
+}
+
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif //!_FRAME_ARENA_H_
@@ -0,0 +1,296 @@
+/* Frame arenas of FrameArena.h against malloc for the engine's transient allocations, portable so it runs on the
+ * Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread FrameArenaBenchmark.cpp FrameArena.cpp TaskPool.cpp Timer.cpp Platform_Posix.cpp \
+ *       -o FrameArenaBenchmark
+ *   ./FrameArenaBenchmark
+ *
+ * Every pattern runs for FRAME_ARENA_BENCH_FRAMES frames, once through malloc and free and once through the
+ * frame arenas with a frame begun between frames:
+ *   small      draw records and barrier batches, thousands of 16 to 256 byte allocations freed at frame end.
+ *   vectors    culling output, vectors of indices grown by push_back without a reserve.
+ *   mesh       a model load's temporaries, the skull's vertices and indices, every page touched.
+ *   threaded   scratch of every chunk of a task pool loop, from every worker at once.
+ * The times are per frame. Alongside, the arena is checked for alignment, poisoning, rewinding, growing after a
+ * frame that chained blocks, frame arenas that keep what a frame allocated for NUM_FRAMES frames and threads
+ * that never share one. The exit code is 1 if a check fails.
+ */
+
+#include "FrameArena.h"
+#include "TaskPool.h"
+#include "Timer.h"
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t FRAME_ARENA_BENCH_FRAMES = {1000};
+static constexpr uint32_t FRAME_ARENA_BENCH_FRAME_COUNT = {3}; // NUM_FRAMES of DX12.h.
+static constexpr uint32_t SMALL_ALLOCATIONS = {4096};
+static constexpr uint32_t VECTOR_COUNT = {8};
+static constexpr uint32_t VECTOR_MAX_LENGTH = {16384};
+static constexpr uint32_t MESH_VERTICES = {31076}; // The skull's.
+static constexpr uint32_t MESH_VERTEX_BYTES = {44}; // sizeof(Vertex).
+static constexpr uint32_t MESH_INDICES = {60339 * 3};
+static constexpr uint32_t THREADED_ITEMS = {1u << 16};
+static constexpr uint32_t THREADED_CHUNK = {256};
+static constexpr uint32_t THREADED_PIECES = {8}; // Allocations per chunk.
+
+static uint32_t          failures = 0;
+static volatile uint64_t sink = 0;
+
+static void Check(bool condition, const char *what) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+struct PatternResult {
+    double mallocMs;
+    double arenaMs;
+};
+
+template <typename F> static double TimeFrames(bool arena, const F &frame) {
+    int64_t start = HiResPerformanceQuery();
+    for (uint32_t f = 0; f < FRAME_ARENA_BENCH_FRAMES; ++f) {
+        frame(f);
+        if (arena)
+            FrameArenaBeginFrame();
+    }
+    return HiResMilliseconds(HiResPerformanceQuery() - start) / FRAME_ARENA_BENCH_FRAMES;
+}
+
+// .. thousands of small records, all freed at the end of the frame ..
+static PatternResult BenchSmall() {
+    std::vector<void *> pointers(SMALL_ALLOCATIONS);
+    PatternResult       result;
+    result.mallocMs = TimeFrames(false, [&](uint32_t f) {
+        uint32_t state = 1 + f;
+        for (uint32_t i = 0; i < SMALL_ALLOCATIONS; ++i) {
+            size_t size = 16 + (NextRandom(state) & 0xf0);
+            pointers[i] = malloc(size);
+            *(uint64_t *)pointers[i] = i;
+        }
+        for (uint32_t i = 0; i < SMALL_ALLOCATIONS; ++i) {
+            sink = sink + *(uint64_t *)pointers[i];
+            free(pointers[i]);
+        }
+    });
+    result.arenaMs = TimeFrames(true, [&](uint32_t f) {
+        uint32_t     state = 1 + f;
+        LinearArena &arena = FrameArena();
+        for (uint32_t i = 0; i < SMALL_ALLOCATIONS; ++i) {
+            size_t size = 16 + (NextRandom(state) & 0xf0);
+            pointers[i] = arena.Allocate(size);
+            *(uint64_t *)pointers[i] = i;
+        }
+        for (uint32_t i = 0; i < SMALL_ALLOCATIONS; ++i)
+            sink = sink + *(uint64_t *)pointers[i];
+    });
+    return result;
+}
+
+// .. visible lists grown without knowing their length up front ..
+static PatternResult BenchVectors() {
+    PatternResult result;
+    result.mallocMs = TimeFrames(false, [&](uint32_t f) {
+        uint32_t state = 1 + f;
+        for (uint32_t v = 0; v < VECTOR_COUNT; ++v) {
+            std::vector<uint32_t> visible;
+            uint32_t              length = NextRandom(state) % VECTOR_MAX_LENGTH;
+            for (uint32_t i = 0; i < length; ++i)
+                visible.push_back(i * 3);
+            sink = sink + (visible.empty() ? 0 : visible.back());
+        }
+    });
+    result.arenaMs = TimeFrames(true, [&](uint32_t f) {
+        uint32_t state = 1 + f;
+        for (uint32_t v = 0; v < VECTOR_COUNT; ++v) {
+            ArenaVector<uint32_t> visible;
+            uint32_t              length = NextRandom(state) % VECTOR_MAX_LENGTH;
+            for (uint32_t i = 0; i < length; ++i)
+                visible.push_back(i * 3);
+            sink = sink + (visible.empty() ? 0 : visible.back());
+        }
+    });
+
+    // .. same contents either way ..
+    uint32_t              state = 7;
+    std::vector<uint32_t> expected;
+    ArenaVector<uint32_t> arenaVector;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        uint32_t value = NextRandom(state);
+        expected.push_back(value);
+        arenaVector.push_back(value);
+    }
+    Check(arenaVector.size() == expected.size() && memcmp(arenaVector.data(), expected.data(), expected.size() * 4) == 0,
+          "an arena vector holds what a std::vector does");
+    return result;
+}
+
+static void TouchPages(uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i += 4096)
+        data[i] = (uint8_t)i;
+    sink = sink + data[size - 1];
+}
+
+// .. a model load, far bigger than the small allocations, every page written once ..
+static PatternResult BenchMesh() {
+    const size_t  vertexBytes = (size_t)MESH_VERTICES * MESH_VERTEX_BYTES;
+    const size_t  indexBytes = (size_t)MESH_INDICES * sizeof(uint32_t);
+    PatternResult result;
+    result.mallocMs = TimeFrames(false, [&](uint32_t) {
+        uint8_t *vertices = (uint8_t *)malloc(vertexBytes);
+        uint8_t *indices = (uint8_t *)malloc(indexBytes);
+        TouchPages(vertices, vertexBytes);
+        TouchPages(indices, indexBytes);
+        free(vertices);
+        free(indices);
+    });
+    result.arenaMs = TimeFrames(true, [&](uint32_t) {
+        LinearArena &arena = FrameArena();
+        ArenaScope   scratch(arena);
+        TouchPages((uint8_t *)arena.Allocate(vertexBytes), vertexBytes);
+        TouchPages((uint8_t *)arena.Allocate(indexBytes), indexBytes);
+    });
+    return result;
+}
+
+// .. every chunk of a loop allocates scratch, from whichever thread runs it ..
+static PatternResult BenchThreaded(TaskPool &pool) {
+    std::vector<uint64_t> sums(THREADED_ITEMS / THREADED_CHUNK);
+    auto                  chunk = [&](bool arena, uint32_t begin, uint32_t end) {
+        uint64_t sum = 0;
+        for (uint32_t piece = 0; piece < THREADED_PIECES; ++piece) {
+            size_t    count = (end - begin) * 8 / THREADED_PIECES;
+            uint64_t *scratch = arena ? FrameArena().AllocateArray<uint64_t>(count) : (uint64_t *)malloc(count * 8);
+            for (size_t i = 0; i < count; ++i)
+                scratch[i] = begin + i;
+            sum += scratch[count - 1];
+            if (!arena)
+                free(scratch);
+        }
+        sums[begin / THREADED_CHUNK] = sum;
+    };
+    PatternResult result;
+    result.mallocMs = TimeFrames(false, [&](uint32_t) {
+        pool.ParallelFor(THREADED_ITEMS, THREADED_CHUNK, [&](uint32_t begin, uint32_t end) { chunk(false, begin, end); });
+    });
+    result.arenaMs = TimeFrames(true, [&](uint32_t) {
+        pool.ParallelFor(THREADED_ITEMS, THREADED_CHUNK, [&](uint32_t begin, uint32_t end) { chunk(true, begin, end); });
+    });
+    for (uint64_t sum : sums)
+        sink = sink + sum;
+
+    // .. no two threads ever share an arena ..
+    std::mutex                                        lock;
+    std::vector<std::pair<std::thread::id, void *>>   seen;
+    bool                                              shared = false;
+    pool.ParallelFor(THREADED_ITEMS, THREADED_CHUNK, [&](uint32_t, uint32_t) {
+        void                       *arena = &FrameArena();
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto &entry : seen) {
+            if ((entry.first == std::this_thread::get_id()) != (entry.second == arena))
+                shared = true;
+        }
+        seen.push_back({std::this_thread::get_id(), arena});
+    });
+    Check(!shared, "every thread has its own frame arena");
+    return result;
+}
+
+static void CheckArena() {
+    LinearArena arena;
+    arena.Initialize(64u << 10);
+    arena.poison = true;
+
+    // .. alignment, and poisoned memory going out and coming back ..
+    for (size_t alignment = 1; alignment <= 256; alignment *= 2) {
+        uint8_t *p = (uint8_t *)arena.Allocate(3, alignment);
+        Check(((uintptr_t)p & (alignment - 1)) == 0, "allocations are aligned");
+        Check(p[0] == FRAME_ARENA_ALLOCATED_BYTE && p[2] == FRAME_ARENA_ALLOCATED_BYTE, "allocations are poisoned");
+    }
+    ArenaMarker marker = arena.Mark();
+    size_t      usedAtMarker = arena.used;
+    uint8_t    *scratch = nullptr;
+    {
+        ArenaScope scope(arena);
+        scratch = (uint8_t *)arena.Allocate(1000);
+        memset(scratch, 0, 1000);
+    }
+    Check(arena.used == usedAtMarker && arena.Mark().offset == marker.offset, "a scope rewinds the arena");
+    Check(scratch[0] == FRAME_ARENA_FREED_BYTE && scratch[999] == FRAME_ARENA_FREED_BYTE, "rewound memory is poisoned");
+    Check(arena.Allocate(1000) == scratch, "rewound memory is handed out again");
+
+    // .. a frame that outgrows the block chains more, the next one gets a block that covers it ..
+    arena.Reset();
+    for (uint32_t i = 0; i < 50; ++i)
+        memset(arena.Allocate(4000), 1, 4000);
+    Check(arena.chainedBlocks > 0 && arena.blocks.size() > 1, "a full block chains another");
+    uint32_t chained = arena.chainedBlocks;
+    size_t   highWater = arena.highWater;
+    arena.Reset();
+    Check(arena.blocks.size() == 1 && arena.blocks[0].size >= highWater && arena.used == 0, "a reset grows to the high water");
+    for (uint32_t i = 0; i < 50; ++i)
+        arena.Allocate(4000);
+    Check(arena.chainedBlocks == chained, "the same frame again fits one block");
+    uint8_t *big = (uint8_t *)arena.Allocate(1u << 20);
+    Check(big && arena.chainedBlocks == chained + 1, "a request larger than a block gets a block of its own");
+    arena.CleanUp();
+}
+
+static void CheckFrameArenas() {
+    // .. what a frame allocated lives until FRAME_ARENA_BENCH_FRAME_COUNT frames later ..
+    FrameArenaBeginFrame();
+    uint32_t *kept = FrameArena().AllocateArray<uint32_t>(256);
+    for (uint32_t i = 0; i < 256; ++i)
+        kept[i] = i * 7;
+    LinearArena *first = &FrameArena();
+    bool         intact = true;
+    for (uint32_t f = 1; f < FRAME_ARENA_BENCH_FRAME_COUNT; ++f) {
+        FrameArenaBeginFrame();
+        Check(&FrameArena() != first, "the frames in flight have arenas of their own");
+        memset(FrameArena().Allocate(4096), 0xff, 4096);
+        for (uint32_t i = 0; i < 256; ++i)
+            intact = intact && kept[i] == i * 7;
+    }
+    Check(intact, "allocations survive the frames in flight");
+    FrameArenaBeginFrame();
+    Check(&FrameArena() == first && first->used == 0, "the arena is reset once its frame comes around");
+}
+
+int main() {
+    FrameArenaInitialize(FRAME_ARENA_BENCH_FRAME_COUNT);
+    TaskPool pool;
+    pool.Initialize();
+
+    CheckArena();
+    CheckFrameArenas();
+
+    PatternResult small = BenchSmall();
+    PatternResult vectors = BenchVectors();
+    PatternResult mesh = BenchMesh();
+    PatternResult threaded = BenchThreaded(pool);
+    FrameArenaStats stats = FrameArenaCollectStats();
+    pool.CleanUp();
+
+    printf("{\"benchmark\": \"frame_arena\", \"frames\": %u, \"threads\": %u,\n", FRAME_ARENA_BENCH_FRAMES, stats.threads);
+    const struct {
+        const char   *name;
+        PatternResult result;
+    } patterns[] = {{"small", small}, {"vectors", vectors}, {"mesh", mesh}, {"threaded", threaded}};
+    for (const auto &pattern : patterns) {
+        printf("  \"%s\": {\"malloc_ms\": %.4f, \"arena_ms\": %.4f, \"speedup\": %.2f},\n", pattern.name,
+               pattern.result.mallocMs, pattern.result.arenaMs, pattern.result.mallocMs / pattern.result.arenaMs);
+    }
+    printf("  \"high_water_kb\": %.1f, \"reserved_kb\": %.1f, \"chained_blocks\": %u, \"failures\": %u}\n",
+           stats.highWater / 1024.0, stats.reserved / 1024.0, stats.chainedBlocks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,42 @@
+#include "FrameLoop.h"
+
+void FixedStepLoop::Initialize(const FrameClock &_clock, double _fixedStep, int _maxStepsPerFrame) {
+    clock = _clock;
+    fixedStep = _fixedStep;
+    fixedStepTicks = (int64_t)(fixedStep * clock.frequency + 0.5);
+    fixedStepTicks = fixedStepTicks > 0 ? fixedStepTicks : 1;
+    maxStepsPerFrame = _maxStepsPerFrame;
+    lastTicks = clock.Now();
+    accumulatorTicks = 0;
+    droppedTicks = 0;
+    frameTime = 0.0;
+    simulationSteps = 0;
+    frameIndex = 0;
+}
+
+int FixedStepLoop::BeginFrame() {
+    int64_t now = clock.Now();
+    int64_t elapsed = now - lastTicks;
+    elapsed = elapsed > 0 ? elapsed : 0;
+    lastTicks = now;
+
+    frameTime = elapsed / (double)clock.frequency;
+    accumulatorTicks += elapsed;
+    frameIndex++;
+
+    // NOTE(pf): Avoid the spiral of death, if we fall too far behind the excess time is dropped.
+    int64_t maxAccumulated = maxStepsPerFrame * fixedStepTicks;
+    if (accumulatorTicks > maxAccumulated) {
+        droppedTicks += accumulatorTicks - maxAccumulated;
+        accumulatorTicks = maxAccumulated;
+    }
+
+    int steps = (int)(accumulatorTicks / fixedStepTicks);
+    accumulatorTicks -= steps * fixedStepTicks;
+    simulationSteps += steps;
+    return steps;
+}
+
+double FixedStepLoop::Alpha() const {
+    return accumulatorTicks / (double)fixedStepTicks;
+}
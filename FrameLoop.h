@@ -0,0 +1,83 @@
+#ifndef _FRAME_LOOP_H_
+#define _FRAME_LOOP_H_
+
+/* Fixed timestep simulation with render interpolation, based on $SOURCE
+ * SOURCE: https://gafferongames.com/post/fix_your_timestep/
+ */
+
+#include "Common.h"
+#include <atomic>
+
+// NOTE(pf): Clock is injected so the loop can be driven by a fake clock, query returns ticks and
+// frequency is ticks per second.
+struct FrameClock {
+    int64_t (*query)(void *user) = nullptr;
+    void   *user = nullptr;
+    int64_t frequency = 1;
+
+    int64_t Now() const { return query(user); }
+};
+
+struct FixedStepLoop {
+    void Initialize(const FrameClock &clock, double fixedStep, int maxStepsPerFrame = 8);
+
+    // NOTE(pf): Measures the time since the previous BeginFrame, so present and vsync waits of the last
+    // frame are included, and returns how many fixed steps the simulation should run this frame.
+    int BeginFrame();
+
+    // NOTE(pf): How far between the previous and current simulation state the renderer is, in [0, 1].
+    double Alpha() const;
+
+    // NOTE(pf): Accumulation happens in integer ticks so a fake clock gives exact step counts.
+    FrameClock clock;
+    double     fixedStep = 1.0 / 120.0;
+    int64_t    fixedStepTicks = 1;
+    int        maxStepsPerFrame = 8;
+    int64_t    lastTicks = 0;
+    int64_t    accumulatorTicks = 0;
+    int64_t    droppedTicks = 0; // Time thrown away because the simulation could not keep up.
+    double     frameTime = 0.0;  // Wall time of the last frame in seconds.
+    uint64_t   simulationSteps = 0;
+    uint64_t   frameIndex = 0;
+
+    double SimulationTime() const { return simulationSteps * fixedStep; }
+    // NOTE(pf): Clock time that step [0, steps) of this frame simulates up to, the last one ends accumulatorTicks
+    // before lastTicks.
+    int64_t StepEndTicks(int step, int steps) const {
+        return lastTicks - accumulatorTicks - (steps - 1 - step) * fixedStepTicks;
+    }
+};
+
+// NOTE(pf): Single producer, single consumer mailbox of the latest T. The producer fills Back() and
+// publishes it, the consumer acquires the newest published value into Front(). Neither side blocks
+// and the consumer always sees a complete value, older unread values are overwritten.
+template <typename T>
+struct TripleBuffer {
+    T &Back() { return slots[back]; }
+
+    void Publish() {
+        uint32_t previous = ready.exchange(back | NEW_BIT, std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    // Returns true if a new value was published since the last call.
+    bool Acquire() {
+        if ((ready.load(std::memory_order_relaxed) & NEW_BIT) == 0)
+            return false;
+        uint32_t previous = ready.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T &Front() const { return slots[front]; }
+
+    static constexpr uint32_t NEW_BIT = {4};
+    static constexpr uint32_t INDEX_MASK = {3};
+
+    T                     slots[3] = {};
+    std::atomic<uint32_t> ready = {1};
+    uint32_t              back = {0};
+    uint32_t              front = {2};
+};
+
+#endif //!_FRAME_LOOP_H_
@@ -0,0 +1,153 @@
+/* Checks FixedStepLoop and TripleBuffer of FrameLoop.h headless, driven by a fake clock, portable so it runs on the
+ * Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread FrameLoopTool.cpp FrameLoop.cpp -o FrameLoopTool
+ *   ./FrameLoopTool
+ *
+ * The clock runs at FAKE_FREQUENCY ticks per second with steps of FAKE_STEP_TICKS, every frame advances it by a
+ * chosen number of ticks and the steps, Alpha and StepEndTicks of the frame are compared against what the ticks
+ * work out to: frames shorter than a step, fractional and multi-step frames, a clock that goes backwards and a
+ * hitch that hits the max steps limit. The triple buffer is checked for its handoff on one thread, then a
+ * producer and a consumer thread hammer it and every value the consumer sees has to be complete and newer than
+ * the last. Prints JSON, the exit code is 1 if a check fails.
+ */
+
+#include "FrameLoop.h"
+#include <stdio.h>
+#include <thread>
+
+static constexpr int64_t  FAKE_FREQUENCY = {1200};
+static constexpr int64_t  FAKE_STEP_TICKS = {10}; // 1 / 120 s.
+static constexpr int      FAKE_MAX_STEPS = {8};
+static constexpr uint32_t HANDOFF_VALUES = {200000};
+
+static uint32_t failures = 0;
+static uint32_t checks = 0;
+
+static void Check(bool condition, const char *what) {
+    checks++;
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static int64_t QueryFakeClock(void *user) {
+    return *(int64_t *)user;
+}
+
+struct FakeFrame {
+    int64_t     advance; // Ticks since the previous frame.
+    int         steps;
+    int64_t     accumulator;
+    const char *what;
+};
+
+static void CheckFixedStepLoop() {
+    int64_t    now = 1000;
+    FrameClock clock;
+    clock.query = QueryFakeClock;
+    clock.user = &now;
+    clock.frequency = FAKE_FREQUENCY;
+
+    FixedStepLoop loop;
+    loop.Initialize(clock, 1.0 / 120.0, FAKE_MAX_STEPS);
+    Check(loop.fixedStepTicks == FAKE_STEP_TICKS && loop.lastTicks == 1000, "the step is converted to ticks");
+
+    const FakeFrame frames[] = {
+        {5, 0, 5, "a frame shorter than a step runs none"},
+        {7, 1, 2, "the remainder carries over into the next frame"},
+        {35, 3, 7, "a long frame runs several steps"},
+        {3, 1, 0, "a frame that ends on a step boundary leaves nothing"},
+        {-20, 0, 0, "a clock that goes backwards runs none"},
+        {16, 1, 6, "fractional frames keep the fraction"},
+    };
+    uint64_t totalSteps = 0;
+    for (const FakeFrame &frame : frames) {
+        now += frame.advance;
+        int steps = loop.BeginFrame();
+        totalSteps += steps;
+        Check(steps == frame.steps && loop.accumulatorTicks == frame.accumulator, frame.what);
+        Check(loop.Alpha() == frame.accumulator / (double)FAKE_STEP_TICKS, "alpha is the fraction of a step left");
+        Check(loop.lastTicks == now, "the frame starts at the clock's time");
+        // .. step s of the frame simulates up to the tick its step ended at, the last one accumulator ago ..
+        for (int s = 0; s < steps; ++s) {
+            int64_t expected = now - frame.accumulator - (steps - 1 - s) * FAKE_STEP_TICKS;
+            Check(loop.StepEndTicks(s, steps) == expected, "steps end a step apart, the last accumulator ago");
+        }
+    }
+    Check(loop.frameIndex == sizeof(frames) / sizeof(frames[0]) && loop.simulationSteps == totalSteps,
+          "frames and steps are counted");
+    Check(loop.frameTime == 16.0 / FAKE_FREQUENCY, "the frame time is the last frame's");
+    Check(loop.droppedTicks == 0, "nothing is dropped while the simulation keeps up");
+
+    // .. a hitch far longer than the max steps, the rest of it is dropped instead of spiraling ..
+    now += 1000;
+    int steps = loop.BeginFrame();
+    Check(steps == FAKE_MAX_STEPS, "a hitch runs the max steps");
+    Check(loop.accumulatorTicks == 0 && loop.Alpha() == 0.0, "a hitch leaves nothing accumulated");
+    Check(loop.droppedTicks == 6 + 1000 - FAKE_MAX_STEPS * FAKE_STEP_TICKS, "the excess of a hitch is dropped");
+    Check(loop.StepEndTicks(FAKE_MAX_STEPS - 1, FAKE_MAX_STEPS) == now &&
+              loop.StepEndTicks(0, FAKE_MAX_STEPS) == now - (FAKE_MAX_STEPS - 1) * FAKE_STEP_TICKS,
+          "the steps of a hitch end at the frame");
+    now += 9;
+    Check(loop.BeginFrame() == 0 && loop.Alpha() == 0.9, "the loop runs on normally after a hitch");
+}
+
+struct HandoffValue {
+    uint32_t value;
+    uint32_t check; // value * 3, a torn read shows as a mismatch.
+};
+
+static void CheckTripleBuffer() {
+    TripleBuffer<int> buffer;
+    Check(!buffer.Acquire(), "nothing to acquire before a publish");
+    buffer.Back() = 1;
+    buffer.Publish();
+    Check(buffer.Acquire() && buffer.Front() == 1, "a published value is acquired");
+    Check(!buffer.Acquire() && buffer.Front() == 1, "acquiring again finds nothing new and keeps the front");
+
+    buffer.Back() = 2;
+    buffer.Publish();
+    buffer.Back() = 3;
+    buffer.Publish();
+    Check(buffer.Acquire() && buffer.Front() == 3, "the newest value wins over unread ones");
+    Check(!buffer.Acquire(), "an overwritten value is not handed out later");
+    Check(buffer.back != buffer.front && (buffer.ready.load() & TripleBuffer<int>::INDEX_MASK) != buffer.back &&
+              (buffer.ready.load() & TripleBuffer<int>::INDEX_MASK) != buffer.front,
+          "the three slots stay distinct");
+
+    // .. a producer and a consumer thread, the consumer must never see a torn or older value ..
+    TripleBuffer<HandoffValue> handoff;
+    std::thread                producer([&]() {
+        for (uint32_t i = 1; i <= HANDOFF_VALUES; ++i) {
+            handoff.Back() = {i, i * 3};
+            handoff.Publish();
+            // NOTE(pf): Otherwise the producer can be done before the consumer is scheduled.
+            if ((i & 63) == 0)
+                std::this_thread::yield();
+        }
+    });
+    uint32_t last = 0, acquired = 0;
+    bool     ordered = true, complete = true;
+    while (last < HANDOFF_VALUES) {
+        if (!handoff.Acquire())
+            continue;
+        const HandoffValue &value = handoff.Front();
+        complete = complete && value.check == value.value * 3;
+        ordered = ordered && value.value > last;
+        last = value.value;
+        acquired++;
+    }
+    producer.join();
+    Check(complete, "the consumer never sees a torn value");
+    Check(ordered, "every acquired value is newer than the last");
+    printf("\"handoff_values\": %u, \"handoff_acquired\": %u, ", HANDOFF_VALUES, acquired);
+}
+
+int main() {
+    printf("{\"tool\": \"frame_loop\", ");
+    CheckFixedStepLoop();
+    CheckTripleBuffer();
+    printf("\"checks\": %u, \"failures\": %u}\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+#include "FramePasses.h"
+
+const FrameShaderDesc FRAME_SHADERS[FRAME_SHADER_COUNT] = {
+    {"SSAOVS.hlsl", "vs_5_1", false},
+    {"SSAOPS.hlsl", "ps_5_1", true},
+    {"NormalsVS.hlsl", "vs_5_1", false},
+    {"NormalsPS.hlsl", "ps_5_1", true},
+    {"DrawSSAOVS.hlsl", "vs_5_1", false},
+    {"DrawSSAOPS.hlsl", "ps_5_1", false},
+    {"DepthPyramidCS.hlsl", "cs_5_1", false},
+    {"GtaoPS.hlsl", "ps_5_1", true},
+    {"LightCullCS.hlsl", "cs_5_1", false},
+    {"ForwardVS.hlsl", "vs_5_1", false},
+    {"ForwardPS.hlsl", "ps_5_1", false},
+    {"DrawLitPS.hlsl", "ps_5_1", false},
+};
+
+const FramePipelineDesc FRAME_PIPELINES[FRAME_PIPELINE_COUNT] = {
+    {"Normals", 2, {FRAME_SHADER_NORMALS_VS, FRAME_SHADER_NORMALS_PS}},
+    {"SSAO", 2, {FRAME_SHADER_SSAO_VS, FRAME_SHADER_SSAO_PS}},
+    {"GTAO", 2, {FRAME_SHADER_SSAO_VS, FRAME_SHADER_GTAO_PS}},
+    {"DepthPyramid", 1, {FRAME_SHADER_DEPTH_PYRAMID_CS}},
+    {"DrawSSAO", 2, {FRAME_SHADER_DRAW_SSAO_VS, FRAME_SHADER_DRAW_SSAO_PS}},
+    {"LightCull", 1, {FRAME_SHADER_LIGHT_CULL_CS}},
+    {"Forward", 2, {FRAME_SHADER_FORWARD_VS, FRAME_SHADER_FORWARD_PS}},
+    {"DrawLit", 2, {FRAME_SHADER_DRAW_SSAO_VS, FRAME_SHADER_DRAW_LIT_PS}},
+};
+
+void RecordSsaoDescriptorWrites(GfxCommandList &cmdList, const SsaoPassBindings &ssao) {
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_SRV_TEXTURE2D, ssao.normalMapFormat, ssao.normalMap, ssao.normalMapCpuSrv});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_SRV_TEXTURE2D, ssao.depthMapFormat, ssao.depthMap, ssao.depthMapCpuSrv});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_SRV_TEXTURE2D, ssao.randomVectorMapFormat, ssao.randomVectorMap, ssao.randomVectorMapCpuSrv});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_SRV_TEXTURE2D, ssao.ambientMapFormat, ssao.ambientMap, ssao.ambientMapCpuSrv});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_SRV_TEXTURE2D, ssao.depthPyramidFormat, ssao.depthPyramid, ssao.depthPyramidCpuSrv});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_UAV_TEXTURE2D, ssao.depthPyramidFormat, ssao.depthPyramid, ssao.depthPyramidCpuUav});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_UAV_RAW_BUFFER, GFX_FORMAT_R32_TYPELESS, ssao.depthPyramidScratch,
+                             ssao.depthPyramidScratchCpuUav, ssao.depthPyramidScratchElements});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_RTV_TEXTURE2D, ssao.normalMapFormat, ssao.normalMap, ssao.normalMapRtv});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_RTV_TEXTURE2D, ssao.ambientMapFormat, ssao.ambientMap, ssao.ambientMapRtv});
+}
+
+void RecordDepthPyramidPass(GfxCommandList &cmdList, const SsaoPassBindings &ssao) {
+    cmdList.Barrier(ssao.depthPyramid, GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, GFX_RESOURCE_STATE_UNORDERED_ACCESS);
+
+    // Bind the pass constants, the depth map and the pyramid with its scratch buffer.
+    cmdList.SetComputeRootConstantBufferView(DEPTH_PYRAMID_ROOT_PASS_CONSTANTS, ssao.passConstants);
+    cmdList.SetComputeRootDescriptorTable(DEPTH_PYRAMID_ROOT_DEPTH, ssao.depthMapGpuSrv);
+    cmdList.SetComputeRootDescriptorTable(DEPTH_PYRAMID_ROOT_OUTPUTS, ssao.depthPyramidGpuUav);
+    cmdList.SetPipelineState(ssao.depthPyramidPipelineState);
+
+    // One group per 64x64 tile, the last one to finish reduces the tiles' results into the remaining levels.
+    cmdList.Dispatch(ssao.depthPyramidGroups[0], ssao.depthPyramidGroups[1], 1);
+
+    cmdList.Barrier(ssao.depthPyramid, GFX_RESOURCE_STATE_UNORDERED_ACCESS, GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+}
+
+void RecordSsaoPass(GfxCommandList &cmdList, const SsaoPassBindings &ssao) {
+    cmdList.SetViewport(ssao.viewport);
+    cmdList.SetScissorRect(ssao.scissorRect);
+
+    // We compute the initial SSAO to AmbientMap0.
+    cmdList.Barrier(ssao.ambientMap, GFX_RESOURCE_STATE_GENERIC_READ, GFX_RESOURCE_STATE_RENDER_TARGET);
+
+    float clearValue[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    cmdList.ClearRenderTarget(ssao.ambientMapRtv, clearValue);
+    cmdList.SetRenderTargets(1, &ssao.ambientMapRtv, nullptr);
+
+    // Bind the constant buffers, the normal and depth maps and the random vector map.
+    cmdList.SetGraphicsRootConstantBufferView(SSAO_ROOT_PASS_CONSTANTS, ssao.passConstants);
+    cmdList.SetGraphicsRootConstantBufferView(SSAO_ROOT_STATIC_CONSTANTS, ssao.staticConstants);
+    cmdList.SetGraphicsRootDescriptorTable(SSAO_ROOT_NORMAL_DEPTH, ssao.normalMapGpuSrv);
+    cmdList.SetGraphicsRootDescriptorTable(SSAO_ROOT_RANDOM_VECTORS, ssao.randomVectorMapGpuSrv);
+    cmdList.SetPipelineState(ssao.pipelineState);
+
+    // Draw fullscreen quad.
+    cmdList.SetVertexBuffers(0, 0, nullptr);
+    cmdList.SetIndexBuffer(nullptr);
+    cmdList.SetPrimitiveTopology(GFX_TOPOLOGY_TRIANGLELIST);
+    cmdList.DrawInstanced(6, 1, 0, 0);
+
+    // Change back to GENERIC_READ so we can read the texture in a shader.
+    cmdList.Barrier(ssao.ambientMap, GFX_RESOURCE_STATE_RENDER_TARGET, GFX_RESOURCE_STATE_GENERIC_READ);
+}
+
+void RecordLightingDescriptorWrites(GfxCommandList &cmdList, const LightingPassBindings &lighting) {
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_UAV_RAW_BUFFER, GFX_FORMAT_R32_TYPELESS, lighting.tileLights,
+                             lighting.tileLightsCpuUav, lighting.tileLightsElements});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_SRV_TEXTURE2D, lighting.litColorFormat, lighting.litColor, lighting.litColorCpuSrv});
+    cmdList.WriteDescriptor({GFX_DESCRIPTOR_RTV_TEXTURE2D, lighting.litColorFormat, lighting.litColor, lighting.litColorRtv});
+}
+
+void RecordLightCullPass(GfxCommandList &cmdList, const LightingPassBindings &lighting, GfxHandle depthMapGpuSrv) {
+    cmdList.Barrier(lighting.tileLights, GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, GFX_RESOURCE_STATE_UNORDERED_ACCESS);
+
+    // Bind the lighting constants, the depth map, the lights and the tile lists.
+    cmdList.SetComputeRootConstantBufferView(LIGHT_CULL_ROOT_LIGHTING, lighting.constants);
+    cmdList.SetComputeRootDescriptorTable(LIGHT_CULL_ROOT_DEPTH, depthMapGpuSrv);
+    cmdList.SetComputeRootShaderResourceView(LIGHT_CULL_ROOT_LIGHTS, lighting.lights);
+    cmdList.SetComputeRootDescriptorTable(LIGHT_CULL_ROOT_TILE_LIGHTS, lighting.tileLightsGpuUav);
+    cmdList.SetPipelineState(lighting.cullPipelineState);
+
+    // One group per tile, it reduces the tile's depth and then tests every light against it.
+    cmdList.Dispatch(lighting.tileGroups[0], lighting.tileGroups[1], 1);
+
+    cmdList.Barrier(lighting.tileLights, GFX_RESOURCE_STATE_UNORDERED_ACCESS, GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+}
+
+void RecordForwardPass(GfxCommandList &cmdList, const FrameBindings &frame) {
+    const LightingPassBindings &lighting = frame.lighting;
+    cmdList.SetViewport(frame.renderViewport);
+    cmdList.SetScissorRect(frame.renderScissorRect);
+
+    cmdList.Barrier(lighting.litColor, GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, GFX_RESOURCE_STATE_RENDER_TARGET);
+
+    // NOTE(pf): Alpha stays 0 where no mesh was drawn, the composite shows the sky there.
+    float clearValue[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    cmdList.ClearRenderTarget(lighting.litColorRtv, clearValue);
+    cmdList.SetRenderTargets(1, &lighting.litColorRtv, &frame.dsv);
+
+    // Bind the frame and lighting constants, the ambient map, the lights and the tile lists.
+    cmdList.SetGraphicsRootConstantBufferView(ROOT_FRAME_CONSTANTS, frame.frameConstants);
+    cmdList.SetGraphicsRootConstantBufferView(ROOT_LIGHTING, lighting.constants);
+    cmdList.SetGraphicsRootDescriptorTable(ROOT_AMBIENT_MAP, frame.ambientMapGpuSrv);
+    cmdList.SetGraphicsRootShaderResourceView(ROOT_LIGHTS, lighting.lights);
+    cmdList.SetGraphicsRootShaderResourceView(ROOT_TILE_LIGHTS, lighting.tileLightsAddress);
+    cmdList.SetPipelineState(lighting.forwardPipelineState);
+    RecordMeshBatches(cmdList, frame.meshBatches);
+
+    cmdList.Barrier(lighting.litColor, GFX_RESOURCE_STATE_RENDER_TARGET, GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+}
+
+void RecordMeshBatches(GfxCommandList &cmdList, const MeshBatchBindings &batches) {
+    if (batches.batchCount == 0)
+        return;
+
+    cmdList.SetGraphicsRootShaderResourceView(ROOT_INSTANCES, batches.instanceBuffer);
+    cmdList.SetVertexBuffers(0, 1, &batches.vertexBuffer);
+    cmdList.SetIndexBuffer(&batches.indexBuffer);
+    cmdList.SetPrimitiveTopology(batches.topology);
+    cmdList.ExecuteIndirect(batches.commandSignature, batches.batchCount, batches.argumentBuffer, 0);
+}
+
+void RecordFrame(GfxCommandList &cmdList, const FrameBindings &frame) {
+    cmdList.SetDescriptorHeaps(1, &frame.descriptorHeap);
+    cmdList.SetGraphicsRootSignature(frame.rootSignature);
+
+    // Draw Normals, only depth when SSAO reconstructs them from it..
+    {
+        GfxZone zone(cmdList, "Normals");
+        cmdList.SetViewport(frame.renderViewport);
+        cmdList.SetScissorRect(frame.renderScissorRect);
+
+        if (frame.ssao.writeNormalMap) {
+            cmdList.Barrier(frame.ssao.normalMap, GFX_RESOURCE_STATE_GENERIC_READ, GFX_RESOURCE_STATE_RENDER_TARGET);
+
+            float clearValue[] = {0.0f, 0.0f, 1.0f, 0.0f};
+            cmdList.ClearRenderTarget(frame.ssao.normalMapRtv, clearValue);
+        }
+        cmdList.ClearDepthStencil(frame.dsv, GFX_CLEAR_DEPTH | GFX_CLEAR_STENCIL, 1.0f, 0);
+
+        cmdList.SetRenderTargets(frame.ssao.writeNormalMap ? 1 : 0, frame.ssao.writeNormalMap ? &frame.ssao.normalMapRtv : nullptr,
+                                 &frame.dsv);
+        cmdList.SetGraphicsRootConstantBufferView(ROOT_FRAME_CONSTANTS, frame.frameConstants);
+        cmdList.SetPipelineState(frame.normalPipelineState);
+        RecordMeshBatches(cmdList, frame.meshBatches);
+
+        if (frame.ssao.writeNormalMap)
+            cmdList.Barrier(frame.ssao.normalMap, GFX_RESOURCE_STATE_RENDER_TARGET, GFX_RESOURCE_STATE_GENERIC_READ);
+    }
+
+    // .. reduce depth into the pyramid the far SSAO taps read ..
+    static constexpr uint32_t DEPTH_READ_STATES = GFX_RESOURCE_STATE_DEPTH_READ | GFX_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+                                                  GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    if (frame.ssao.useDepthPyramid) {
+        GfxZone zone(cmdList, "DepthPyramid");
+        cmdList.Barrier(frame.ssao.depthMap, GFX_RESOURCE_STATE_DEPTH_WRITE, DEPTH_READ_STATES);
+        cmdList.SetComputeRootSignature(frame.depthPyramidRootSignature);
+        RecordDepthPyramidPass(cmdList, frame.ssao);
+    } else {
+        cmdList.Barrier(frame.ssao.depthMap, GFX_RESOURCE_STATE_DEPTH_WRITE, DEPTH_READ_STATES);
+    }
+
+    // .. cull the lights against the tiles of the depth ..
+    if (frame.lighting.enabled) {
+        GfxZone zone(cmdList, "LightCull");
+        cmdList.SetComputeRootSignature(frame.lightCullRootSignature);
+        RecordLightCullPass(cmdList, frame.lighting, frame.ssao.depthMapGpuSrv);
+    }
+
+    // .. draw SSAO ..
+    {
+        GfxZone zone(cmdList, "SSAO");
+        cmdList.SetGraphicsRootSignature(frame.ssaoRootSignature);
+        RecordSsaoPass(cmdList, frame.ssao);
+        cmdList.Barrier(frame.ssao.depthMap, DEPTH_READ_STATES, GFX_RESOURCE_STATE_DEPTH_WRITE);
+    }
+
+    // .. shade the meshes with the lights of their tiles and the ambient map.
+    if (frame.lighting.enabled) {
+        GfxZone zone(cmdList, "Forward");
+        cmdList.SetGraphicsRootSignature(frame.rootSignature);
+        RecordForwardPass(cmdList, frame);
+    }
+
+    GfxZone zone(cmdList, "Composite");
+    cmdList.SetGraphicsRootSignature(frame.rootSignature);
+    cmdList.SetViewport(frame.viewport);
+    cmdList.SetScissorRect(frame.scissorRect);
+
+    cmdList.Barrier(frame.backBuffer, GFX_RESOURCE_STATE_PRESENT, GFX_RESOURCE_STATE_RENDER_TARGET);
+
+    float clearColor[] = {0.4f, 0.6f, 0.9f, 1.0f};
+    cmdList.ClearRenderTarget(frame.backBufferRtv, clearColor);
+    cmdList.SetRenderTargets(1, &frame.backBufferRtv, &frame.dsv);
+
+    cmdList.SetGraphicsRootDescriptorTable(ROOT_AMBIENT_MAP, frame.ambientMapGpuSrv);
+    if (frame.lighting.enabled)
+        cmdList.SetGraphicsRootDescriptorTable(ROOT_LIT_COLOR, frame.lighting.litColorGpuSrv);
+
+    // .. sample ssao, or the lit color, onto a fullscreen effect.
+    cmdList.SetPipelineState(frame.lighting.enabled ? frame.lighting.compositePipelineState : frame.compositePipelineState);
+    cmdList.SetVertexBuffers(0, 0, nullptr);
+    cmdList.SetIndexBuffer(nullptr);
+    cmdList.SetPrimitiveTopology(GFX_TOPOLOGY_TRIANGLELIST);
+    cmdList.DrawInstanced(6, 1, 0, 0);
+
+    cmdList.Barrier(frame.backBuffer, GFX_RESOURCE_STATE_RENDER_TARGET, GFX_RESOURCE_STATE_PRESENT);
+}
@@ -0,0 +1,206 @@
+#ifndef _FRAME_PASSES_H_
+#define _FRAME_PASSES_H_
+
+/* The renderer's frame as a sequence of GfxCommandList calls. DX12 fills the bindings with its resources
+ * and records through DX12GfxCommandList, CommandStreamTool fills them with placeholder handles and records
+ * through GfxRecordingCommandList, so the command stream can be checked without a GPU.
+ */
+
+#include "GfxCommandList.h"
+
+// NOTE(pf): Root parameter slots, DX12::Initialize builds the root signatures in this order.
+enum ROOT_PARAMETER : uint32_t {
+    ROOT_FRAME_CONSTANTS,   // CBV b0, FrameConstants.
+    ROOT_INSTANCES,         // SRV t0 space1, InstanceData of the current frame.
+    ROOT_AMBIENT_MAP,       // Table t0, ambient map for the composite.
+    ROOT_DRAW_CONSTANTS,    // Constants b1, set per indirect draw by the command signature.
+    ROOT_LIGHTING,          // CBV b2, LightingConstants.
+    ROOT_LIGHTS,            // SRV t1 space1, PointLights of the current frame.
+    ROOT_TILE_LIGHTS,       // SRV t2 space1, the light lists LightCullCS wrote.
+    ROOT_LIT_COLOR,         // Table t1, lit color for the composite.
+};
+
+enum SSAO_ROOT_PARAMETER : uint32_t {
+    SSAO_ROOT_PASS_CONSTANTS,   // CBV b0, SsaoPassConstants.
+    SSAO_ROOT_NORMAL_DEPTH,     // Table t0-t1.
+    SSAO_ROOT_RANDOM_VECTORS,   // Table t2-t3, random vectors and the depth pyramid.
+    SSAO_ROOT_STATIC_CONSTANTS, // CBV b1, SsaoStaticConstants.
+};
+
+enum DEPTH_PYRAMID_ROOT_PARAMETER : uint32_t {
+    DEPTH_PYRAMID_ROOT_PASS_CONSTANTS, // CBV b0, SsaoPassConstants.
+    DEPTH_PYRAMID_ROOT_DEPTH,          // Table t1.
+    DEPTH_PYRAMID_ROOT_OUTPUTS,        // Table u0-u1, the pyramid and its scratch buffer.
+};
+
+enum LIGHT_CULL_ROOT_PARAMETER : uint32_t {
+    LIGHT_CULL_ROOT_LIGHTING,    // CBV b2, LightingConstants.
+    LIGHT_CULL_ROOT_DEPTH,       // Table t0.
+    LIGHT_CULL_ROOT_LIGHTS,      // SRV t1 space1.
+    LIGHT_CULL_ROOT_TILE_LIGHTS, // Table u0.
+};
+
+// NOTE(pf): The shaders DX12 compiles, all from shaders/ with entry point main, and the pipelines it builds from
+// them. Hot reload rebuilds a pipeline when one of its shaders or a file they include changed.
+enum FRAME_SHADER : uint32_t {
+    FRAME_SHADER_SSAO_VS,
+    FRAME_SHADER_SSAO_PS,
+    FRAME_SHADER_NORMALS_VS,
+    FRAME_SHADER_NORMALS_PS,
+    FRAME_SHADER_DRAW_SSAO_VS,
+    FRAME_SHADER_DRAW_SSAO_PS,
+    FRAME_SHADER_DEPTH_PYRAMID_CS,
+    FRAME_SHADER_GTAO_PS,
+    FRAME_SHADER_LIGHT_CULL_CS,
+    FRAME_SHADER_FORWARD_VS,
+    FRAME_SHADER_FORWARD_PS,
+    FRAME_SHADER_DRAW_LIT_PS,
+    FRAME_SHADER_COUNT,
+};
+
+enum FRAME_PIPELINE : uint32_t {
+    FRAME_PIPELINE_NORMALS,
+    FRAME_PIPELINE_SSAO,
+    FRAME_PIPELINE_GTAO,
+    FRAME_PIPELINE_DEPTH_PYRAMID,
+    FRAME_PIPELINE_DRAW_SSAO,
+    FRAME_PIPELINE_LIGHT_CULL,
+    FRAME_PIPELINE_FORWARD,
+    FRAME_PIPELINE_DRAW_LIT,
+    FRAME_PIPELINE_COUNT,
+};
+
+struct FrameShaderDesc {
+    const char *file;
+    const char *target;
+    bool        normalSource; // Compiled for the SSAO_NORMAL_SOURCE DX12 was initialized with, see NormalEncoding.hlsl.
+};
+
+struct FramePipelineDesc {
+    const char  *name;
+    uint32_t     shaderCount;
+    FRAME_SHADER shaders[2]; // Vertex and pixel shader, or the compute shader.
+};
+
+extern const FrameShaderDesc   FRAME_SHADERS[FRAME_SHADER_COUNT];
+extern const FramePipelineDesc FRAME_PIPELINES[FRAME_PIPELINE_COUNT];
+
+struct SsaoPassBindings {
+    GfxViewport viewport;
+    GfxRect     scissorRect;
+    GfxHandle   pipelineState;
+    uint64_t    passConstants;   // Gpu address of SsaoPassConstants.
+    uint64_t    staticConstants; // Gpu address of SsaoStaticConstants.
+
+    GfxHandle normalMap;
+    bool      writeNormalMap; // False when the SSAO shaders reconstruct normals from depth.
+    GfxHandle depthMap;
+    GfxHandle randomVectorMap;
+    GfxHandle ambientMap;
+
+    // NOTE(pf): Min/max view depth atlas of DepthPyramid.h, built by one dispatch of DepthPyramidCS. The
+    // scratch buffer holds the group counter and the last level every group reduced its tile to.
+    GfxHandle depthPyramidPipelineState;
+    GfxHandle depthPyramid;
+    GfxHandle depthPyramidScratch;
+    uint32_t  depthPyramidGroups[2];
+    uint32_t  depthPyramidScratchElements; // 32 bit values.
+    bool      useDepthPyramid;             // Only the hemisphere kernel reads it, GTAO skips the dispatch.
+
+    // NOTE(pf): Srvs are contiguous in the order ambient, normal, depth, random vectors, depth pyramid, followed
+    // by the uavs of the pyramid and its scratch buffer.
+    GfxHandle ambientMapCpuSrv;
+    GfxHandle normalMapCpuSrv;
+    GfxHandle depthMapCpuSrv;
+    GfxHandle randomVectorMapCpuSrv;
+    GfxHandle depthPyramidCpuSrv;
+    GfxHandle depthPyramidCpuUav;
+    GfxHandle depthPyramidScratchCpuUav;
+    GfxHandle normalMapGpuSrv;
+    GfxHandle depthMapGpuSrv;
+    GfxHandle randomVectorMapGpuSrv;
+    GfxHandle depthPyramidGpuUav;
+    GfxHandle normalMapRtv;
+    GfxHandle ambientMapRtv;
+
+    GFX_FORMAT normalMapFormat;
+    GFX_FORMAT depthMapFormat;
+    GFX_FORMAT randomVectorMapFormat;
+    GFX_FORMAT ambientMapFormat;
+    GFX_FORMAT depthPyramidFormat;
+};
+
+// NOTE(pf): Tiled forward+, see LightCulling.h. LightCullCS writes a light list per 16x16 tile of the rendered
+// depth, the forward pass shades the meshes again with the lights of their pixel's tile and the ambient map
+// into the lit color target, which the composite upscales. Without it the composite shows the ambient map.
+struct LightingPassBindings {
+    bool      enabled;
+    GfxHandle cullPipelineState;
+    GfxHandle forwardPipelineState;
+    GfxHandle compositePipelineState;
+    uint64_t  constants; // Gpu address of LightingConstants.
+    uint64_t  lights;    // Gpu address of the frame's PointLights.
+
+    GfxHandle tileLights;         // Raw buffer, LIGHT_TILE_STRIDE values per tile of the full targets.
+    uint64_t  tileLightsAddress;  // Gpu address of the same buffer, read through a root srv.
+    uint32_t  tileLightsElements; // 32 bit values.
+    uint32_t  tileGroups[2];      // Tiles of the rendered part, one group each.
+    GfxHandle litColor;
+
+    // NOTE(pf): Follow the ssao descriptors, the tile lists' uav then the lit color's srv.
+    GfxHandle tileLightsCpuUav;
+    GfxHandle litColorCpuSrv;
+    GfxHandle tileLightsGpuUav;
+    GfxHandle litColorGpuSrv;
+    GfxHandle litColorRtv;
+
+    GFX_FORMAT litColorFormat;
+};
+
+// NOTE(pf): Instances are read from a structured buffer, one indirect draw per LOD batch.
+struct MeshBatchBindings {
+    GfxVertexBufferView vertexBuffer;
+    uint64_t            instanceBuffer; // Gpu address of InstanceData.
+    GfxIndexBufferView  indexBuffer;
+    uint32_t            topology;
+    GfxHandle           commandSignature;
+    GfxHandle           argumentBuffer;
+    uint32_t            batchCount;
+};
+
+struct FrameBindings {
+    GfxHandle   descriptorHeap;
+    GfxHandle   rootSignature;
+    GfxHandle   ssaoRootSignature;
+    GfxHandle   depthPyramidRootSignature;
+    GfxHandle   lightCullRootSignature;
+    GfxHandle   normalPipelineState;
+    GfxHandle   compositePipelineState;
+    GfxViewport viewport;
+    GfxRect     scissorRect;
+    // NOTE(pf): Dynamic resolution renders normals and ssao into the top left of their targets, the composite
+    // upscales it to the full viewport.
+    GfxViewport renderViewport;
+    GfxRect     renderScissorRect;
+
+    GfxHandle backBuffer;
+    GfxHandle backBufferRtv;
+    GfxHandle dsv;
+    uint64_t  frameConstants; // Gpu address of FrameConstants.
+    GfxHandle ambientMapGpuSrv;
+
+    MeshBatchBindings    meshBatches;
+    SsaoPassBindings     ssao;
+    LightingPassBindings lighting;
+};
+
+void RecordSsaoDescriptorWrites(GfxCommandList &cmdList, const SsaoPassBindings &ssao);
+void RecordDepthPyramidPass(GfxCommandList &cmdList, const SsaoPassBindings &ssao);
+void RecordSsaoPass(GfxCommandList &cmdList, const SsaoPassBindings &ssao);
+void RecordLightingDescriptorWrites(GfxCommandList &cmdList, const LightingPassBindings &lighting);
+void RecordLightCullPass(GfxCommandList &cmdList, const LightingPassBindings &lighting, GfxHandle depthMapGpuSrv);
+void RecordForwardPass(GfxCommandList &cmdList, const FrameBindings &frame);
+void RecordMeshBatches(GfxCommandList &cmdList, const MeshBatchBindings &batches);
+void RecordFrame(GfxCommandList &cmdList, const FrameBindings &frame);
+
+#endif //!_FRAME_PASSES_H_
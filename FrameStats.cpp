@@ -0,0 +1,133 @@
+#include "FrameStats.h"
+#include <stdio.h>
+
+static const char *frameStatNames[FRAME_STAT_COUNT] = {"total", "cpu", "gpu", "present_wait"};
+
+const char *FrameStatName(FRAME_STAT stat) {
+    return frameStatNames[stat];
+}
+
+static uint32_t BucketIndex(double ms) {
+    double bucket = ms / FRAME_STATS_BUCKET_MS;
+    if (bucket < 0.0)
+        return 0;
+    if (bucket >= (double)(FRAME_STATS_BUCKETS - 1))
+        return FRAME_STATS_BUCKETS - 1;
+    return (uint32_t)bucket;
+}
+
+void FrameTimeHistogram::Add(double ms) {
+    counts[BucketIndex(ms)]++;
+    sampleCount++;
+    sum += ms;
+}
+
+void FrameTimeHistogram::Remove(double ms) {
+    counts[BucketIndex(ms)]--;
+    sampleCount--;
+    sum -= ms;
+}
+
+double FrameTimeHistogram::Percentile(double p) const {
+    if (sampleCount == 0)
+        return 0.0;
+
+    // NOTE(pf): Nearest rank, the smallest bucket with at least p of the samples at or below it.
+    uint32_t rank = (uint32_t)(p * sampleCount + 0.5);
+    rank = rank < 1 ? 1 : (rank > sampleCount ? sampleCount : rank);
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < FRAME_STATS_BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return (i + 1) * FRAME_STATS_BUCKET_MS;
+    }
+    return FRAME_STATS_BUCKETS * FRAME_STATS_BUCKET_MS;
+}
+
+void FrameStats::AddFrame(const FrameTiming &timing) {
+    FrameTiming &slot = samples[frameCount % FRAME_STATS_WINDOW];
+    for (int s = 0; s < FRAME_STAT_COUNT; ++s) {
+        if (frameCount >= FRAME_STATS_WINDOW)
+            histograms[s].Remove(slot.ms[s]);
+        histograms[s].Add(timing.ms[s]);
+    }
+    slot = timing;
+    frameCount++;
+}
+
+uint32_t FrameStats::SampleCount() const {
+    return frameCount < FRAME_STATS_WINDOW ? (uint32_t)frameCount : FRAME_STATS_WINDOW;
+}
+
+FrameStatSummary FrameStats::Summarize(FRAME_STAT stat) const {
+    FrameStatSummary          result = {};
+    uint32_t                  count = SampleCount();
+    const FrameTimeHistogram &histogram = histograms[stat];
+    if (count == 0)
+        return result;
+
+    // NOTE(pf): The exact max comes from the window itself, the histogram only has bucket resolution.
+    for (uint32_t i = 0; i < count; ++i)
+        result.max = Max(result.max, samples[i].ms[stat]);
+
+    result.mean = histogram.sum / count;
+    result.p50 = histogram.Percentile(0.50);
+    result.p95 = histogram.Percentile(0.95);
+    result.p99 = histogram.Percentile(0.99);
+    result.p50 = result.p50 < result.max ? result.p50 : result.max;
+    result.p95 = result.p95 < result.max ? result.p95 : result.max;
+    result.p99 = result.p99 < result.max ? result.p99 : result.max;
+    return result;
+}
+
+bool FrameStats::ExportCsv(const char *path) const {
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "frame");
+    for (int s = 0; s < FRAME_STAT_COUNT; ++s)
+        fprintf(file, ",%s_ms", FrameStatName((FRAME_STAT)s));
+    fprintf(file, "\n");
+
+    uint32_t count = SampleCount();
+    uint64_t first = frameCount - count;
+    for (uint64_t f = first; f < frameCount; ++f) {
+        const FrameTiming &timing = samples[f % FRAME_STATS_WINDOW];
+        fprintf(file, "%llu", (unsigned long long)f);
+        for (int s = 0; s < FRAME_STAT_COUNT; ++s)
+            fprintf(file, ",%.4f", timing.ms[s]);
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool FrameStats::ExportJson(const char *path) const {
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    uint32_t count = SampleCount();
+    fprintf(file, "{\n  \"frames\": %llu,\n  \"window\": %u,\n  \"summary\": {\n", (unsigned long long)frameCount, count);
+    for (int s = 0; s < FRAME_STAT_COUNT; ++s) {
+        FrameStatSummary summary = Summarize((FRAME_STAT)s);
+        fprintf(file, "    \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+                FrameStatName((FRAME_STAT)s), summary.mean, summary.p50, summary.p95, summary.p99, summary.max,
+                s + 1 < FRAME_STAT_COUNT ? "," : "");
+    }
+    fprintf(file, "  },\n  \"samples\": {\n");
+
+    uint64_t first = frameCount - count;
+    for (int s = 0; s < FRAME_STAT_COUNT; ++s) {
+        fprintf(file, "    \"%s\": [", FrameStatName((FRAME_STAT)s));
+        for (uint64_t f = first; f < frameCount; ++f)
+            fprintf(file, "%s%.4f", f == first ? "" : ", ", samples[f % FRAME_STATS_WINDOW].ms[s]);
+        fprintf(file, "]%s\n", s + 1 < FRAME_STAT_COUNT ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+
+    fclose(file);
+    return true;
+}
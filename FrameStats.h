@@ -0,0 +1,58 @@
+#ifndef _FRAME_STATS_H_
+#define _FRAME_STATS_H_
+
+#include "Common.h"
+
+// NOTE(pf): Rolling window of frame timings. Each stat keeps a fixed bucket histogram that samples are
+// added to and removed from as they enter and leave the window, so percentiles never need a sort.
+static constexpr uint32_t FRAME_STATS_WINDOW = {1024};
+static constexpr uint32_t FRAME_STATS_BUCKETS = {2048};
+static constexpr double   FRAME_STATS_BUCKET_MS = {0.05}; // 0.05 ms resolution, the last bucket collects everything above ~102 ms.
+
+enum FRAME_STAT {
+    FRAME_STAT_TOTAL = 0,        // Wall time from one frame start to the next.
+    FRAME_STAT_CPU = 1,          // Total minus present wait, simulation, culling and command recording.
+    FRAME_STAT_GPU = 2,          // Timestamp delta of the frame's command list.
+    FRAME_STAT_PRESENT_WAIT = 3, // Present plus waiting on the fence of the next back buffer.
+    FRAME_STAT_COUNT,
+};
+
+struct FrameTiming {
+    double ms[FRAME_STAT_COUNT];
+};
+
+struct FrameStatSummary {
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
+struct FrameTimeHistogram {
+    void   Add(double ms);
+    void   Remove(double ms);
+    double Percentile(double p) const; // p in [0, 1], returns the upper edge of the bucket, capped at max.
+
+    uint32_t counts[FRAME_STATS_BUCKETS] = {};
+    uint32_t sampleCount = 0;
+    double   sum = 0.0;
+};
+
+struct FrameStats {
+    void             AddFrame(const FrameTiming &timing);
+    FrameStatSummary Summarize(FRAME_STAT stat) const;
+    uint32_t         SampleCount() const;
+
+    // NOTE(pf): CSV has one row per frame in the window, JSON has the summaries followed by the samples.
+    bool ExportCsv(const char *path) const;
+    bool ExportJson(const char *path) const;
+
+    FrameTiming        samples[FRAME_STATS_WINDOW] = {};
+    FrameTimeHistogram histograms[FRAME_STAT_COUNT];
+    uint64_t           frameCount = 0;
+};
+
+const char *FrameStatName(FRAME_STAT stat);
+
+#endif //!_FRAME_STATS_H_
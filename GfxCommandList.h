@@ -0,0 +1,187 @@
+#ifndef _GFX_COMMAND_LIST_H_
+#define _GFX_COMMAND_LIST_H_
+
+/* Backend independent command recording. The DX12 renderer records its frame through GfxCommandList,
+ * DX12GfxCommandList forwards to an ID3D12GraphicsCommandList and GfxRecordingCommandList serializes the
+ * calls into a binary stream that can be inspected and diffed without a GPU.
+ *
+ * NOTE(pf): Handles are opaque 64 bit values: resource, heap, root signature and pipeline pointers,
+ * descriptor handle pointers and gpu virtual addresses. States, formats and topologies use the D3D12
+ * values so the DX12 backend only has to cast them.
+ */
+
+#include "Common.h"
+
+typedef uint64_t GfxHandle;
+
+template <typename T>
+inline GfxHandle GfxHandleOf(T *pointer) {
+    return (GfxHandle)(uintptr_t)pointer;
+}
+
+// NOTE(pf): Same values as D3D12_RESOURCE_STATES.
+enum GFX_RESOURCE_STATE : uint32_t {
+    GFX_RESOURCE_STATE_COMMON = 0x0,
+    GFX_RESOURCE_STATE_PRESENT = 0x0,
+    GFX_RESOURCE_STATE_RENDER_TARGET = 0x4,
+    GFX_RESOURCE_STATE_UNORDERED_ACCESS = 0x8,
+    GFX_RESOURCE_STATE_DEPTH_WRITE = 0x10,
+    GFX_RESOURCE_STATE_DEPTH_READ = 0x20,
+    GFX_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE = 0x40,
+    GFX_RESOURCE_STATE_PIXEL_SHADER_RESOURCE = 0x80,
+    GFX_RESOURCE_STATE_COPY_DEST = 0x400,
+    GFX_RESOURCE_STATE_COPY_SOURCE = 0x800,
+    GFX_RESOURCE_STATE_GENERIC_READ = 0xAC3,
+};
+
+// NOTE(pf): Same values as DXGI_FORMAT, only the ones the renderer uses.
+enum GFX_FORMAT : uint32_t {
+    GFX_FORMAT_UNKNOWN = 0,
+    GFX_FORMAT_R16G16B16A16_FLOAT = 10,
+    GFX_FORMAT_R32G32_FLOAT = 16,
+    GFX_FORMAT_R10G10B10A2_UNORM = 24,
+    GFX_FORMAT_R8G8B8A8_UNORM = 28,
+    GFX_FORMAT_R16G16_UNORM = 35,
+    GFX_FORMAT_R16G16_SNORM = 37,
+    GFX_FORMAT_R32_TYPELESS = 39,
+    GFX_FORMAT_R32_FLOAT = 41,
+    GFX_FORMAT_R32_UINT = 42,
+    GFX_FORMAT_D24_UNORM_S8_UINT = 45,
+    GFX_FORMAT_R24_UNORM_X8_TYPELESS = 46,
+    GFX_FORMAT_R16_UNORM = 56,
+};
+
+// NOTE(pf): Same values as D3D_PRIMITIVE_TOPOLOGY and D3D12_CLEAR_FLAGS.
+static constexpr uint32_t GFX_TOPOLOGY_TRIANGLELIST = {4};
+static constexpr uint32_t GFX_CLEAR_DEPTH = {0x1};
+static constexpr uint32_t GFX_CLEAR_STENCIL = {0x2};
+
+static constexpr uint32_t GFX_MAX_RENDER_TARGETS = {8};
+static constexpr uint32_t GFX_MAX_VERTEX_BUFFERS = {4};
+static constexpr uint32_t GFX_MAX_DESCRIPTOR_HEAPS = {2};
+static constexpr uint32_t GFX_MAX_ROOT_CONSTANTS = {64};
+
+// NOTE(pf): Layouts match D3D12_VIEWPORT, D3D12_RECT, D3D12_VERTEX_BUFFER_VIEW and D3D12_INDEX_BUFFER_VIEW.
+struct GfxViewport {
+    float x, y, width, height, minDepth, maxDepth;
+};
+
+struct GfxRect {
+    int32_t left, top, right, bottom;
+};
+
+struct GfxVertexBufferView {
+    uint64_t location;
+    uint32_t sizeInBytes;
+    uint32_t strideInBytes;
+};
+
+struct GfxIndexBufferView {
+    uint64_t location;
+    uint32_t sizeInBytes;
+    uint32_t format;
+};
+
+enum GFX_DESCRIPTOR_TYPE : uint32_t {
+    GFX_DESCRIPTOR_SRV_TEXTURE2D,
+    GFX_DESCRIPTOR_RTV_TEXTURE2D,
+    GFX_DESCRIPTOR_DSV_TEXTURE2D,
+    GFX_DESCRIPTOR_UAV_TEXTURE2D,
+    GFX_DESCRIPTOR_UAV_RAW_BUFFER,
+};
+
+// NOTE(pf): A view of mip 0 of a 2D texture written into a cpu descriptor, or of the first elementCount 32 bit
+// values of a buffer for raw views. elementCount is ignored for textures.
+struct GfxDescriptorWrite {
+    GFX_DESCRIPTOR_TYPE type;
+    GFX_FORMAT          format;
+    GfxHandle           resource;
+    GfxHandle           cpuDescriptor;
+    uint32_t            elementCount;
+};
+
+// NOTE(pf): One per GfxCommandList method, used by the recorder and for per-command counters.
+enum GFX_CMD : uint16_t {
+    GFX_CMD_BARRIER,
+    GFX_CMD_CLEAR_RENDER_TARGET,
+    GFX_CMD_CLEAR_DEPTH_STENCIL,
+    GFX_CMD_SET_DESCRIPTOR_HEAPS,
+    GFX_CMD_SET_ROOT_SIGNATURE,
+    GFX_CMD_SET_PIPELINE_STATE,
+    GFX_CMD_SET_VIEWPORT,
+    GFX_CMD_SET_SCISSOR_RECT,
+    GFX_CMD_SET_RENDER_TARGETS,
+    GFX_CMD_SET_PRIMITIVE_TOPOLOGY,
+    GFX_CMD_SET_VERTEX_BUFFERS,
+    GFX_CMD_SET_INDEX_BUFFER,
+    GFX_CMD_SET_ROOT_CBV,
+    GFX_CMD_SET_ROOT_SRV,
+    GFX_CMD_SET_ROOT_DESCRIPTOR_TABLE,
+    GFX_CMD_SET_ROOT_CONSTANTS,
+    GFX_CMD_SET_COMPUTE_ROOT_SIGNATURE,
+    GFX_CMD_SET_COMPUTE_ROOT_CBV,
+    GFX_CMD_SET_COMPUTE_ROOT_SRV,
+    GFX_CMD_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE,
+    GFX_CMD_DRAW_INSTANCED,
+    GFX_CMD_DRAW_INDEXED_INSTANCED,
+    GFX_CMD_EXECUTE_INDIRECT,
+    GFX_CMD_DISPATCH,
+    GFX_CMD_WRITE_DESCRIPTOR,
+    GFX_CMD_BEGIN_ZONE,
+    GFX_CMD_END_ZONE,
+    GFX_CMD_COUNT,
+};
+
+struct GfxCommandList {
+    virtual ~GfxCommandList() {}
+
+    virtual void Barrier(GfxHandle resource, uint32_t before, uint32_t after) = 0;
+    virtual void ClearRenderTarget(GfxHandle rtv, const float color[4]) = 0;
+    virtual void ClearDepthStencil(GfxHandle dsv, uint32_t flags, float depth, uint8_t stencil) = 0;
+
+    virtual void SetDescriptorHeaps(uint32_t count, const GfxHandle *heaps) = 0;
+    virtual void SetGraphicsRootSignature(GfxHandle rootSignature) = 0;
+    virtual void SetPipelineState(GfxHandle pipelineState) = 0;
+    virtual void SetViewport(const GfxViewport &viewport) = 0;
+    virtual void SetScissorRect(const GfxRect &rect) = 0;
+    virtual void SetRenderTargets(uint32_t count, const GfxHandle *rtvs, const GfxHandle *dsv) = 0;
+    virtual void SetPrimitiveTopology(uint32_t topology) = 0;
+    virtual void SetVertexBuffers(uint32_t startSlot, uint32_t count, const GfxVertexBufferView *views) = 0;
+    virtual void SetIndexBuffer(const GfxIndexBufferView *view) = 0;
+
+    virtual void SetGraphicsRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) = 0;
+    virtual void SetGraphicsRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) = 0;
+    virtual void SetGraphicsRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) = 0;
+    virtual void SetGraphicsRoot32BitConstants(uint32_t parameter, uint32_t count, const void *data, uint32_t offset) = 0;
+
+    // NOTE(pf): Compute root arguments are bound separately from the graphics ones, like in D3D12.
+    virtual void SetComputeRootSignature(GfxHandle rootSignature) = 0;
+    virtual void SetComputeRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) = 0;
+    virtual void SetComputeRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) = 0;
+    virtual void SetComputeRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) = 0;
+
+    virtual void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) = 0;
+    virtual void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                                      uint32_t startInstance) = 0;
+    virtual void ExecuteIndirect(GfxHandle commandSignature, uint32_t maxCommandCount, GfxHandle argumentBuffer,
+                                 uint64_t argumentOffset) = 0;
+    virtual void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) = 0;
+
+    // NOTE(pf): Descriptor writes happen on the cpu timeline, they are here so captures include them.
+    virtual void WriteDescriptor(const GfxDescriptorWrite &write) = 0;
+
+    virtual void BeginZone(const char *name) = 0;
+    virtual void EndZone() = 0;
+};
+
+struct GfxZone {
+    GfxZone(GfxCommandList &_cmdList, const char *name) : cmdList(_cmdList) {
+        cmdList.BeginZone(name);
+    }
+    ~GfxZone() {
+        cmdList.EndZone();
+    }
+    GfxCommandList &cmdList;
+};
+
+#endif //!_GFX_COMMAND_LIST_H_
@@ -0,0 +1,575 @@
+#include "GfxRecorder.h"
+#include "Platform.h"
+#include <string.h>
+#include <string>
+
+struct GfxStreamFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t commandCount;
+};
+
+static const char *GFX_COMMAND_NAMES[GFX_CMD_COUNT] = {
+    "Barrier",
+    "ClearRenderTarget",
+    "ClearDepthStencil",
+    "SetDescriptorHeaps",
+    "SetGraphicsRootSignature",
+    "SetPipelineState",
+    "SetViewport",
+    "SetScissorRect",
+    "SetRenderTargets",
+    "SetPrimitiveTopology",
+    "SetVertexBuffers",
+    "SetIndexBuffer",
+    "SetGraphicsRootConstantBufferView",
+    "SetGraphicsRootShaderResourceView",
+    "SetGraphicsRootDescriptorTable",
+    "SetGraphicsRoot32BitConstants",
+    "SetComputeRootSignature",
+    "SetComputeRootConstantBufferView",
+    "SetComputeRootShaderResourceView",
+    "SetComputeRootDescriptorTable",
+    "DrawInstanced",
+    "DrawIndexedInstanced",
+    "ExecuteIndirect",
+    "Dispatch",
+    "WriteDescriptor",
+    "BeginZone",
+    "EndZone",
+};
+
+const char *GfxCommandName(uint16_t opcode) {
+    return opcode < GFX_CMD_COUNT ? GFX_COMMAND_NAMES[opcode] : "Unknown";
+}
+
+// .. recording ..
+
+void GfxRecordingCommandList::Reset() {
+    stream.clear();
+    handleIds.clear();
+    commandCount = 0;
+}
+
+void GfxRecordingCommandList::Begin(GFX_CMD opcode) {
+    commandStart = stream.size();
+    GfxCommandHeader header = {opcode, 0};
+    Write(&header, sizeof(header));
+}
+
+void GfxRecordingCommandList::End() {
+    GfxCommandHeader *header = (GfxCommandHeader *)&stream[commandStart];
+    size_t            size = stream.size() - commandStart - sizeof(GfxCommandHeader);
+    assert(size <= 0xFFFF && "Command payload too large.");
+    header->size = (uint16_t)size;
+    commandCount++;
+}
+
+void GfxRecordingCommandList::Write(const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    stream.insert(stream.end(), bytes, bytes + size);
+}
+
+void GfxRecordingCommandList::WriteHandle(GfxHandle handle) {
+    if (handle == 0) {
+        Write32(0);
+        return;
+    }
+    auto it = handleIds.find(handle);
+    if (it == handleIds.end())
+        it = handleIds.insert({handle, (uint32_t)handleIds.size() + 1}).first;
+    Write32(it->second);
+}
+
+void GfxRecordingCommandList::Barrier(GfxHandle resource, uint32_t before, uint32_t after) {
+    Begin(GFX_CMD_BARRIER);
+    WriteHandle(resource);
+    Write32(before);
+    Write32(after);
+    End();
+}
+
+void GfxRecordingCommandList::ClearRenderTarget(GfxHandle rtv, const float color[4]) {
+    Begin(GFX_CMD_CLEAR_RENDER_TARGET);
+    WriteHandle(rtv);
+    Write(color, 4 * sizeof(float));
+    End();
+}
+
+void GfxRecordingCommandList::ClearDepthStencil(GfxHandle dsv, uint32_t flags, float depth, uint8_t stencil) {
+    Begin(GFX_CMD_CLEAR_DEPTH_STENCIL);
+    WriteHandle(dsv);
+    Write32(flags);
+    WriteFloat(depth);
+    Write32(stencil);
+    End();
+}
+
+void GfxRecordingCommandList::SetDescriptorHeaps(uint32_t count, const GfxHandle *heaps) {
+    Begin(GFX_CMD_SET_DESCRIPTOR_HEAPS);
+    Write32(count);
+    for (uint32_t i = 0; i < count; ++i)
+        WriteHandle(heaps[i]);
+    End();
+}
+
+void GfxRecordingCommandList::SetGraphicsRootSignature(GfxHandle rootSignature) {
+    Begin(GFX_CMD_SET_ROOT_SIGNATURE);
+    WriteHandle(rootSignature);
+    End();
+}
+
+void GfxRecordingCommandList::SetPipelineState(GfxHandle pipelineState) {
+    Begin(GFX_CMD_SET_PIPELINE_STATE);
+    WriteHandle(pipelineState);
+    End();
+}
+
+void GfxRecordingCommandList::SetViewport(const GfxViewport &viewport) {
+    Begin(GFX_CMD_SET_VIEWPORT);
+    Write(&viewport, sizeof(viewport));
+    End();
+}
+
+void GfxRecordingCommandList::SetScissorRect(const GfxRect &rect) {
+    Begin(GFX_CMD_SET_SCISSOR_RECT);
+    Write(&rect, sizeof(rect));
+    End();
+}
+
+void GfxRecordingCommandList::SetRenderTargets(uint32_t count, const GfxHandle *rtvs, const GfxHandle *dsv) {
+    Begin(GFX_CMD_SET_RENDER_TARGETS);
+    Write32(count);
+    for (uint32_t i = 0; i < count; ++i)
+        WriteHandle(rtvs[i]);
+    WriteHandle(dsv ? *dsv : 0);
+    End();
+}
+
+void GfxRecordingCommandList::SetPrimitiveTopology(uint32_t topology) {
+    Begin(GFX_CMD_SET_PRIMITIVE_TOPOLOGY);
+    Write32(topology);
+    End();
+}
+
+void GfxRecordingCommandList::SetVertexBuffers(uint32_t startSlot, uint32_t count, const GfxVertexBufferView *views) {
+    Begin(GFX_CMD_SET_VERTEX_BUFFERS);
+    Write32(startSlot);
+    Write32(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        WriteHandle(views[i].location);
+        Write32(views[i].sizeInBytes);
+        Write32(views[i].strideInBytes);
+    }
+    End();
+}
+
+void GfxRecordingCommandList::SetIndexBuffer(const GfxIndexBufferView *view) {
+    Begin(GFX_CMD_SET_INDEX_BUFFER);
+    WriteHandle(view ? view->location : 0);
+    Write32(view ? view->sizeInBytes : 0);
+    Write32(view ? view->format : 0);
+    End();
+}
+
+void GfxRecordingCommandList::SetGraphicsRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) {
+    Begin(GFX_CMD_SET_ROOT_CBV);
+    Write32(parameter);
+    WriteHandle(gpuAddress);
+    End();
+}
+
+void GfxRecordingCommandList::SetGraphicsRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) {
+    Begin(GFX_CMD_SET_ROOT_SRV);
+    Write32(parameter);
+    WriteHandle(gpuAddress);
+    End();
+}
+
+void GfxRecordingCommandList::SetGraphicsRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) {
+    Begin(GFX_CMD_SET_ROOT_DESCRIPTOR_TABLE);
+    Write32(parameter);
+    WriteHandle(gpuDescriptor);
+    End();
+}
+
+void GfxRecordingCommandList::SetGraphicsRoot32BitConstants(uint32_t parameter, uint32_t count, const void *data, uint32_t offset) {
+    assert(count <= GFX_MAX_ROOT_CONSTANTS && "Too many root constants.");
+    Begin(GFX_CMD_SET_ROOT_CONSTANTS);
+    Write32(parameter);
+    Write32(offset);
+    Write32(count);
+    Write(data, count * sizeof(uint32_t));
+    End();
+}
+
+void GfxRecordingCommandList::SetComputeRootSignature(GfxHandle rootSignature) {
+    Begin(GFX_CMD_SET_COMPUTE_ROOT_SIGNATURE);
+    WriteHandle(rootSignature);
+    End();
+}
+
+void GfxRecordingCommandList::SetComputeRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) {
+    Begin(GFX_CMD_SET_COMPUTE_ROOT_CBV);
+    Write32(parameter);
+    WriteHandle(gpuAddress);
+    End();
+}
+
+void GfxRecordingCommandList::SetComputeRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) {
+    Begin(GFX_CMD_SET_COMPUTE_ROOT_SRV);
+    Write32(parameter);
+    WriteHandle(gpuAddress);
+    End();
+}
+
+void GfxRecordingCommandList::SetComputeRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) {
+    Begin(GFX_CMD_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE);
+    Write32(parameter);
+    WriteHandle(gpuDescriptor);
+    End();
+}
+
+void GfxRecordingCommandList::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) {
+    Begin(GFX_CMD_DRAW_INSTANCED);
+    Write32(vertexCount);
+    Write32(instanceCount);
+    Write32(startVertex);
+    Write32(startInstance);
+    End();
+}
+
+void GfxRecordingCommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                                                   uint32_t startInstance) {
+    Begin(GFX_CMD_DRAW_INDEXED_INSTANCED);
+    Write32(indexCount);
+    Write32(instanceCount);
+    Write32(startIndex);
+    Write32((uint32_t)baseVertex);
+    Write32(startInstance);
+    End();
+}
+
+void GfxRecordingCommandList::ExecuteIndirect(GfxHandle commandSignature, uint32_t maxCommandCount, GfxHandle argumentBuffer,
+                                              uint64_t argumentOffset) {
+    Begin(GFX_CMD_EXECUTE_INDIRECT);
+    WriteHandle(commandSignature);
+    Write32(maxCommandCount);
+    WriteHandle(argumentBuffer);
+    Write64(argumentOffset);
+    End();
+}
+
+void GfxRecordingCommandList::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    Begin(GFX_CMD_DISPATCH);
+    Write32(groupsX);
+    Write32(groupsY);
+    Write32(groupsZ);
+    End();
+}
+
+void GfxRecordingCommandList::WriteDescriptor(const GfxDescriptorWrite &write) {
+    Begin(GFX_CMD_WRITE_DESCRIPTOR);
+    Write32(write.type);
+    Write32(write.format);
+    WriteHandle(write.resource);
+    WriteHandle(write.cpuDescriptor);
+    Write32(write.elementCount);
+    End();
+}
+
+void GfxRecordingCommandList::BeginZone(const char *name) {
+    char fixedName[GFX_STREAM_MAX_ZONE_NAME] = {};
+    strncpy(fixedName, name, GFX_STREAM_MAX_ZONE_NAME - 1);
+    Begin(GFX_CMD_BEGIN_ZONE);
+    Write(fixedName, sizeof(fixedName));
+    End();
+}
+
+void GfxRecordingCommandList::EndZone() {
+    Begin(GFX_CMD_END_ZONE);
+    End();
+}
+
+bool GfxRecordingCommandList::WriteToFile(const char *path) const {
+    GfxStreamFileHeader  header = {GFX_STREAM_MAGIC, GFX_STREAM_VERSION, (uint32_t)stream.size(), commandCount};
+    std::vector<uint8_t> file(sizeof(header) + stream.size());
+    memcpy(file.data(), &header, sizeof(header));
+    if (!stream.empty())
+        memcpy(file.data() + sizeof(header), stream.data(), stream.size());
+    return PlatformWriteFile(path, file.data(), file.size());
+}
+
+bool GfxReadCommandStream(const char *path, std::vector<uint8_t> &stream) {
+    std::vector<uint8_t> file;
+    if (!PlatformReadFile(path, file) || file.size() < sizeof(GfxStreamFileHeader))
+        return false;
+
+    GfxStreamFileHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != GFX_STREAM_MAGIC || header.version != GFX_STREAM_VERSION ||
+        header.size != file.size() - sizeof(header))
+        return false;
+
+    stream.assign(file.begin() + sizeof(header), file.end());
+    return true;
+}
+
+// .. reading ..
+
+struct GfxCommandReader {
+    bool Next() {
+        if (offset + sizeof(GfxCommandHeader) > size)
+            return false;
+        memcpy(&header, stream + offset, sizeof(header));
+        payload = stream + offset + sizeof(header);
+        if (offset + sizeof(header) + header.size > size)
+            return false;
+        offset += sizeof(header) + header.size;
+        cursor = 0;
+        return true;
+    }
+
+    uint32_t Read32() {
+        uint32_t value = 0;
+        if (cursor + sizeof(value) <= header.size)
+            memcpy(&value, payload + cursor, sizeof(value));
+        cursor += sizeof(value);
+        return value;
+    }
+
+    uint64_t Read64() {
+        uint64_t value = 0;
+        if (cursor + sizeof(value) <= header.size)
+            memcpy(&value, payload + cursor, sizeof(value));
+        cursor += sizeof(value);
+        return value;
+    }
+
+    float ReadFloat() {
+        uint32_t bits = Read32();
+        float    value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    const uint8_t   *stream;
+    size_t           size;
+    size_t           offset = 0;
+    GfxCommandHeader header = {};
+    const uint8_t   *payload = nullptr;
+    uint32_t         cursor = 0;
+};
+
+static bool IsStateCommand(uint16_t opcode) {
+    return opcode >= GFX_CMD_SET_DESCRIPTOR_HEAPS && opcode <= GFX_CMD_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE;
+}
+
+static bool IsRootParameterCommand(uint16_t opcode) {
+    return opcode == GFX_CMD_SET_ROOT_CBV || opcode == GFX_CMD_SET_ROOT_SRV || opcode == GFX_CMD_SET_ROOT_DESCRIPTOR_TABLE ||
+           opcode == GFX_CMD_SET_ROOT_CONSTANTS;
+}
+
+static bool IsComputeRootParameterCommand(uint16_t opcode) {
+    return opcode == GFX_CMD_SET_COMPUTE_ROOT_CBV || opcode == GFX_CMD_SET_COMPUTE_ROOT_SRV ||
+           opcode == GFX_CMD_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE;
+}
+
+bool GfxAnalyzeCommandStream(const uint8_t *stream, size_t size, GfxCommandStreamStats &stats) {
+    static constexpr uint32_t MAX_ROOT_PARAMETERS = {16};
+    static constexpr uint16_t TABLE_OPCODE = {GFX_CMD_SET_ROOT_DESCRIPTOR_TABLE};
+    static constexpr uint16_t COMPUTE_TABLE_OPCODE = {GFX_CMD_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE};
+
+    stats = GfxCommandStreamStats();
+    std::string boundState[GFX_CMD_COUNT];
+    std::string boundRootParameters[MAX_ROOT_PARAMETERS];
+    std::string boundComputeRootParameters[MAX_ROOT_PARAMETERS];
+
+    GfxCommandReader reader = {stream, size};
+    while (reader.Next()) {
+        uint16_t opcode = reader.header.opcode;
+        if (opcode >= GFX_CMD_COUNT)
+            return false;
+        stats.commands[opcode]++;
+        stats.totalCommands++;
+
+        std::string payload((const char *)reader.payload, reader.header.size);
+        if (IsRootParameterCommand(opcode) || IsComputeRootParameterCommand(opcode)) {
+            // NOTE(pf): The opcode is part of the key so a table and a cbv on the same slot never compare equal.
+            std::string *bound = IsRootParameterCommand(opcode) ? boundRootParameters : boundComputeRootParameters;
+            uint32_t     parameter = reader.Read32();
+            payload.insert(0, (const char *)&opcode, sizeof(opcode));
+            if (parameter < MAX_ROOT_PARAMETERS) {
+                if (bound[parameter] == payload) {
+                    stats.redundant[opcode]++;
+                    stats.totalRedundant++;
+                }
+                bound[parameter] = payload;
+            }
+        } else if (IsStateCommand(opcode)) {
+            if (boundState[opcode] == payload) {
+                stats.redundant[opcode]++;
+                stats.totalRedundant++;
+            } else if (opcode == GFX_CMD_SET_ROOT_SIGNATURE) {
+                for (uint32_t i = 0; i < MAX_ROOT_PARAMETERS; ++i)
+                    boundRootParameters[i].clear();
+            } else if (opcode == GFX_CMD_SET_COMPUTE_ROOT_SIGNATURE) {
+                for (uint32_t i = 0; i < MAX_ROOT_PARAMETERS; ++i)
+                    boundComputeRootParameters[i].clear();
+            } else if (opcode == GFX_CMD_SET_DESCRIPTOR_HEAPS) {
+                for (uint32_t i = 0; i < MAX_ROOT_PARAMETERS; ++i) {
+                    if (boundRootParameters[i].compare(0, sizeof(uint16_t), (const char *)&TABLE_OPCODE, sizeof(uint16_t)) == 0)
+                        boundRootParameters[i].clear();
+                    if (boundComputeRootParameters[i].compare(0, sizeof(uint16_t), (const char *)&COMPUTE_TABLE_OPCODE,
+                                                              sizeof(uint16_t)) == 0)
+                        boundComputeRootParameters[i].clear();
+                }
+            }
+            boundState[opcode] = payload;
+        }
+
+        // NOTE(pf): Command signatures may set buffers and root arguments, what they leave bound is not known here.
+        if (opcode == GFX_CMD_EXECUTE_INDIRECT) {
+            boundState[GFX_CMD_SET_VERTEX_BUFFERS].clear();
+            boundState[GFX_CMD_SET_INDEX_BUFFER].clear();
+            for (uint32_t i = 0; i < MAX_ROOT_PARAMETERS; ++i) {
+                boundRootParameters[i].clear();
+                boundComputeRootParameters[i].clear();
+            }
+        }
+
+        if (opcode == GFX_CMD_DRAW_INSTANCED || opcode == GFX_CMD_DRAW_INDEXED_INSTANCED || opcode == GFX_CMD_EXECUTE_INDIRECT)
+            stats.draws++;
+        else if (opcode == GFX_CMD_DISPATCH)
+            stats.dispatches++;
+        else if (opcode == GFX_CMD_BARRIER)
+            stats.barriers++;
+        else if (opcode == GFX_CMD_BEGIN_ZONE)
+            stats.zones++;
+    }
+    return reader.offset == size;
+}
+
+static std::string DisassembleCommand(GfxCommandReader &reader) {
+    char     line[512];
+    uint16_t opcode = reader.header.opcode;
+    int      length = snprintf(line, sizeof(line), "%s", GfxCommandName(opcode));
+
+    switch (opcode) {
+    case GFX_CMD_BEGIN_ZONE: {
+        char name[GFX_STREAM_MAX_ZONE_NAME] = {};
+        memcpy(name, reader.payload, reader.header.size < sizeof(name) ? reader.header.size : sizeof(name));
+        name[GFX_STREAM_MAX_ZONE_NAME - 1] = 0;
+        length += snprintf(line + length, sizeof(line) - length, " \"%s\"", name);
+    } break;
+    case GFX_CMD_SET_VIEWPORT:
+    case GFX_CMD_CLEAR_RENDER_TARGET: {
+        uint32_t floatStart = opcode == GFX_CMD_CLEAR_RENDER_TARGET ? 1 : 0;
+        if (floatStart)
+            length += snprintf(line + length, sizeof(line) - length, " #%u", reader.Read32());
+        while (reader.cursor + sizeof(float) <= reader.header.size && length < (int)sizeof(line))
+            length += snprintf(line + length, sizeof(line) - length, " %g", reader.ReadFloat());
+    } break;
+    case GFX_CMD_CLEAR_DEPTH_STENCIL: {
+        uint32_t dsv = reader.Read32();
+        uint32_t flags = reader.Read32();
+        float    depth = reader.ReadFloat();
+        length += snprintf(line + length, sizeof(line) - length, " #%u flags=%u depth=%g stencil=%u", dsv, flags, depth, reader.Read32());
+    } break;
+    case GFX_CMD_EXECUTE_INDIRECT: {
+        uint32_t signature = reader.Read32();
+        uint32_t maxCount = reader.Read32();
+        uint32_t buffer = reader.Read32();
+        length += snprintf(line + length, sizeof(line) - length, " #%u count=%u #%u offset=%llu", signature, maxCount, buffer,
+                           (unsigned long long)reader.Read64());
+    } break;
+    default:
+        // NOTE(pf): Everything else is a list of 32 bit values, handles print as their id.
+        while (reader.cursor + sizeof(uint32_t) <= reader.header.size && length < (int)sizeof(line))
+            length += snprintf(line + length, sizeof(line) - length, " %u", reader.Read32());
+        break;
+    }
+    return std::string(line);
+}
+
+static bool DisassembleLines(const uint8_t *stream, size_t size, std::vector<std::string> &lines) {
+    GfxCommandReader reader = {stream, size};
+    uint32_t         depth = 0;
+    while (reader.Next()) {
+        if (reader.header.opcode == GFX_CMD_END_ZONE && depth > 0)
+            depth--;
+        lines.push_back(std::string(depth * 2, ' ') + DisassembleCommand(reader));
+        if (reader.header.opcode == GFX_CMD_BEGIN_ZONE)
+            depth++;
+    }
+    return reader.offset == size;
+}
+
+bool GfxDisassembleCommandStream(const uint8_t *stream, size_t size, FILE *out) {
+    std::vector<std::string> lines;
+    bool                     result = DisassembleLines(stream, size, lines);
+    for (size_t i = 0; i < lines.size(); ++i)
+        fprintf(out, "%5zu %s\n", i, lines[i].c_str());
+    return result;
+}
+
+uint32_t GfxDiffCommandStreams(const uint8_t *a, size_t aSize, const uint8_t *b, size_t bSize, FILE *out) {
+    static constexpr uint32_t MAX_REPORTED = {32};
+    static constexpr size_t   MAX_LCS_CELLS = {1 << 24};
+
+    std::vector<std::string> linesA, linesB;
+    DisassembleLines(a, aSize, linesA);
+    DisassembleLines(b, bSize, linesB);
+    size_t n = linesA.size(), m = linesB.size();
+
+    // NOTE(pf): Longest common subsequence so an inserted command shows up as one difference instead of
+    // shifting everything after it, captures are a few hundred commands. Huge ones fall back to position.
+    std::vector<uint32_t> lcs;
+    if ((n + 1) * (m + 1) <= MAX_LCS_CELLS) {
+        lcs.resize((n + 1) * (m + 1), 0);
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = m; j-- > 0;) {
+                uint32_t &cell = lcs[i * (m + 1) + j];
+                if (linesA[i] == linesB[j])
+                    cell = lcs[(i + 1) * (m + 1) + j + 1] + 1;
+                else {
+                    uint32_t skipA = lcs[(i + 1) * (m + 1) + j];
+                    uint32_t skipB = lcs[i * (m + 1) + j + 1];
+                    cell = skipA > skipB ? skipA : skipB;
+                }
+            }
+        }
+    }
+
+    uint32_t differences = 0;
+    size_t   i = 0, j = 0;
+    while (i < n || j < m) {
+        bool same = i < n && j < m && linesA[i] == linesB[j];
+        if (same) {
+            i++, j++;
+            continue;
+        }
+
+        bool removeFromA;
+        if (lcs.empty())
+            removeFromA = i < n && (j >= m || i <= j);
+        else
+            removeFromA = i < n && (j >= m || lcs[(i + 1) * (m + 1) + j] >= lcs[i * (m + 1) + j + 1]);
+
+        if (differences < MAX_REPORTED) {
+            if (removeFromA)
+                fprintf(out, "- %5zu %s\n", i, linesA[i].c_str());
+            else
+                fprintf(out, "+ %5zu %s\n", j, linesB[j].c_str());
+        }
+        differences++;
+        if (removeFromA)
+            i++;
+        else
+            j++;
+    }
+    if (differences > MAX_REPORTED)
+        fprintf(out, "... %u more\n", differences - MAX_REPORTED);
+    return differences;
+}
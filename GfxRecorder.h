@@ -0,0 +1,100 @@
+#ifndef _GFX_RECORDER_H_
+#define _GFX_RECORDER_H_
+
+/* Recording backend, serializes every GfxCommandList call into a compact binary command stream.
+ *
+ * NOTE(pf): Every command is a GfxCommandHeader followed by its payload. Handles are replaced by small ids
+ * in order of first use, so two captures of the same frame are byte identical even though the pointers and
+ * gpu addresses behind them differ between runs. A change that adds or removes a handle renumbers the ones
+ * first used after it.
+ */
+
+#include "GfxCommandList.h"
+#include <stdio.h>
+#include <unordered_map>
+#include <vector>
+
+struct GfxCommandHeader {
+    uint16_t opcode;
+    uint16_t size; // Payload bytes following the header.
+};
+
+static constexpr uint32_t GFX_STREAM_MAGIC = {0x43584647}; // 'GFXC'
+static constexpr uint32_t GFX_STREAM_VERSION = {4};
+static constexpr uint32_t GFX_STREAM_MAX_ZONE_NAME = {32};
+
+struct GfxRecordingCommandList : GfxCommandList {
+    void Reset();
+
+    void Barrier(GfxHandle resource, uint32_t before, uint32_t after) override;
+    void ClearRenderTarget(GfxHandle rtv, const float color[4]) override;
+    void ClearDepthStencil(GfxHandle dsv, uint32_t flags, float depth, uint8_t stencil) override;
+    void SetDescriptorHeaps(uint32_t count, const GfxHandle *heaps) override;
+    void SetGraphicsRootSignature(GfxHandle rootSignature) override;
+    void SetPipelineState(GfxHandle pipelineState) override;
+    void SetViewport(const GfxViewport &viewport) override;
+    void SetScissorRect(const GfxRect &rect) override;
+    void SetRenderTargets(uint32_t count, const GfxHandle *rtvs, const GfxHandle *dsv) override;
+    void SetPrimitiveTopology(uint32_t topology) override;
+    void SetVertexBuffers(uint32_t startSlot, uint32_t count, const GfxVertexBufferView *views) override;
+    void SetIndexBuffer(const GfxIndexBufferView *view) override;
+    void SetGraphicsRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetGraphicsRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetGraphicsRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) override;
+    void SetGraphicsRoot32BitConstants(uint32_t parameter, uint32_t count, const void *data, uint32_t offset) override;
+    void SetComputeRootSignature(GfxHandle rootSignature) override;
+    void SetComputeRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetComputeRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetComputeRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                              uint32_t startInstance) override;
+    void ExecuteIndirect(GfxHandle commandSignature, uint32_t maxCommandCount, GfxHandle argumentBuffer,
+                         uint64_t argumentOffset) override;
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void WriteDescriptor(const GfxDescriptorWrite &write) override;
+    void BeginZone(const char *name) override;
+    void EndZone() override;
+
+    bool WriteToFile(const char *path) const;
+
+    std::vector<uint8_t> stream;
+    uint32_t             commandCount = 0;
+
+  private:
+    void Begin(GFX_CMD opcode);
+    void End();
+    void Write(const void *data, size_t size);
+    void Write32(uint32_t value) { Write(&value, sizeof(value)); }
+    void Write64(uint64_t value) { Write(&value, sizeof(value)); }
+    void WriteFloat(float value) { Write(&value, sizeof(value)); }
+    void WriteHandle(GfxHandle handle);
+
+    size_t                                  commandStart = 0;
+    std::unordered_map<GfxHandle, uint32_t> handleIds;
+};
+
+// NOTE(pf): A state command is redundant when it sets what is already bound. Root parameter bindings are
+// tracked per parameter, separately for graphics and compute, and forgotten when the root signature they
+// belong to changes, like D3D12 does. Descriptor tables are also forgotten with new descriptor heaps, buffers
+// and root arguments after ExecuteIndirect, the same rules GfxStateCache follows.
+struct GfxCommandStreamStats {
+    uint32_t commands[GFX_CMD_COUNT] = {};
+    uint32_t redundant[GFX_CMD_COUNT] = {};
+    uint32_t totalCommands = 0;
+    uint32_t totalRedundant = 0;
+    uint32_t draws = 0; // Including indirect draws.
+    uint32_t dispatches = 0;
+    uint32_t barriers = 0;
+    uint32_t zones = 0;
+};
+
+const char *GfxCommandName(uint16_t opcode);
+bool        GfxReadCommandStream(const char *path, std::vector<uint8_t> &stream);
+bool        GfxAnalyzeCommandStream(const uint8_t *stream, size_t size, GfxCommandStreamStats &stats);
+// NOTE(pf): One line per command, meant for diffing two captures with any text diff tool.
+bool GfxDisassembleCommandStream(const uint8_t *stream, size_t size, FILE *out);
+// Returns the number of differing commands, prints the first few with their position.
+uint32_t GfxDiffCommandStreams(const uint8_t *a, size_t aSize, const uint8_t *b, size_t bSize, FILE *out);
+
+#endif //!_GFX_RECORDER_H_
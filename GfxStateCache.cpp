@@ -0,0 +1,295 @@
+#include "GfxStateCache.h"
+#include <string.h>
+
+void GfxStateCache::Invalidate() {
+    hasDescriptorHeaps = false;
+    hasRootSignature = false;
+    hasPipelineState = false;
+    hasViewport = false;
+    hasScissorRect = false;
+    hasTopology = false;
+    hasVertexBuffers = false;
+    hasIndexBuffer = false;
+    hasComputeRootSignature = false;
+    ForgetRootParameters(rootParameters, false);
+    ForgetRootParameters(computeRootParameters, false);
+}
+
+bool GfxStateCache::Keep(GFX_CMD command, bool redundant) {
+    if (redundant) {
+        stats.dropped[command]++;
+        stats.totalDropped++;
+        return false;
+    }
+    stats.forwarded[command]++;
+    stats.totalForwarded++;
+    return true;
+}
+
+void GfxStateCache::ForgetRootParameters(RootParameter *parameters, bool tablesOnly) {
+    for (uint32_t i = 0; i < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS; ++i) {
+        RootParameter &parameter = parameters[i];
+        if (!tablesOnly || parameter.kind == ROOT_BINDING_TABLE) {
+            parameter.kind = ROOT_BINDING_NONE;
+            parameter.validMask = 0;
+        }
+    }
+}
+
+// .. not state, always forwarded ..
+
+void GfxStateCache::Barrier(GfxHandle resource, uint32_t before, uint32_t after) {
+    Keep(GFX_CMD_BARRIER, false);
+    target.Barrier(resource, before, after);
+}
+
+void GfxStateCache::ClearRenderTarget(GfxHandle rtv, const float color[4]) {
+    Keep(GFX_CMD_CLEAR_RENDER_TARGET, false);
+    target.ClearRenderTarget(rtv, color);
+}
+
+void GfxStateCache::ClearDepthStencil(GfxHandle dsv, uint32_t flags, float depth, uint8_t stencil) {
+    Keep(GFX_CMD_CLEAR_DEPTH_STENCIL, false);
+    target.ClearDepthStencil(dsv, flags, depth, stencil);
+}
+
+void GfxStateCache::SetRenderTargets(uint32_t count, const GfxHandle *rtvs, const GfxHandle *dsv) {
+    Keep(GFX_CMD_SET_RENDER_TARGETS, false);
+    target.SetRenderTargets(count, rtvs, dsv);
+}
+
+void GfxStateCache::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) {
+    Keep(GFX_CMD_DRAW_INSTANCED, false);
+    target.DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void GfxStateCache::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                                         uint32_t startInstance) {
+    Keep(GFX_CMD_DRAW_INDEXED_INSTANCED, false);
+    target.DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void GfxStateCache::ExecuteIndirect(GfxHandle commandSignature, uint32_t maxCommandCount, GfxHandle argumentBuffer,
+                                    uint64_t argumentOffset) {
+    Keep(GFX_CMD_EXECUTE_INDIRECT, false);
+    // NOTE(pf): The command signature is opaque here, forget everything one can overwrite.
+    hasVertexBuffers = false;
+    hasIndexBuffer = false;
+    ForgetRootParameters(rootParameters, false);
+    ForgetRootParameters(computeRootParameters, false);
+    target.ExecuteIndirect(commandSignature, maxCommandCount, argumentBuffer, argumentOffset);
+}
+
+void GfxStateCache::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    Keep(GFX_CMD_DISPATCH, false);
+    target.Dispatch(groupsX, groupsY, groupsZ);
+}
+
+void GfxStateCache::WriteDescriptor(const GfxDescriptorWrite &write) {
+    Keep(GFX_CMD_WRITE_DESCRIPTOR, false);
+    target.WriteDescriptor(write);
+}
+
+void GfxStateCache::BeginZone(const char *name) {
+    Keep(GFX_CMD_BEGIN_ZONE, false);
+    target.BeginZone(name);
+}
+
+void GfxStateCache::EndZone() {
+    Keep(GFX_CMD_END_ZONE, false);
+    target.EndZone();
+}
+
+// .. state ..
+
+void GfxStateCache::SetDescriptorHeaps(uint32_t count, const GfxHandle *heaps) {
+    assert(count <= GFX_MAX_DESCRIPTOR_HEAPS && "Too many descriptor heaps.");
+    bool redundant = hasDescriptorHeaps && descriptorHeapCount == count &&
+                     memcmp(descriptorHeaps, heaps, count * sizeof(GfxHandle)) == 0;
+    if (!Keep(GFX_CMD_SET_DESCRIPTOR_HEAPS, redundant))
+        return;
+
+    hasDescriptorHeaps = true;
+    descriptorHeapCount = count;
+    memcpy(descriptorHeaps, heaps, count * sizeof(GfxHandle));
+    ForgetRootParameters(rootParameters, true);
+    ForgetRootParameters(computeRootParameters, true);
+    target.SetDescriptorHeaps(count, heaps);
+}
+
+void GfxStateCache::SetGraphicsRootSignature(GfxHandle _rootSignature) {
+    if (!Keep(GFX_CMD_SET_ROOT_SIGNATURE, hasRootSignature && rootSignature == _rootSignature))
+        return;
+
+    hasRootSignature = true;
+    rootSignature = _rootSignature;
+    ForgetRootParameters(rootParameters, false);
+    target.SetGraphicsRootSignature(_rootSignature);
+}
+
+void GfxStateCache::SetPipelineState(GfxHandle _pipelineState) {
+    if (!Keep(GFX_CMD_SET_PIPELINE_STATE, hasPipelineState && pipelineState == _pipelineState))
+        return;
+
+    hasPipelineState = true;
+    pipelineState = _pipelineState;
+    target.SetPipelineState(_pipelineState);
+}
+
+void GfxStateCache::SetViewport(const GfxViewport &_viewport) {
+    if (!Keep(GFX_CMD_SET_VIEWPORT, hasViewport && memcmp(&viewport, &_viewport, sizeof(viewport)) == 0))
+        return;
+
+    hasViewport = true;
+    viewport = _viewport;
+    target.SetViewport(_viewport);
+}
+
+void GfxStateCache::SetScissorRect(const GfxRect &rect) {
+    if (!Keep(GFX_CMD_SET_SCISSOR_RECT, hasScissorRect && memcmp(&scissorRect, &rect, sizeof(rect)) == 0))
+        return;
+
+    hasScissorRect = true;
+    scissorRect = rect;
+    target.SetScissorRect(rect);
+}
+
+void GfxStateCache::SetPrimitiveTopology(uint32_t _topology) {
+    if (!Keep(GFX_CMD_SET_PRIMITIVE_TOPOLOGY, hasTopology && topology == _topology))
+        return;
+
+    hasTopology = true;
+    topology = _topology;
+    target.SetPrimitiveTopology(_topology);
+}
+
+void GfxStateCache::SetVertexBuffers(uint32_t startSlot, uint32_t count, const GfxVertexBufferView *views) {
+    assert(count <= GFX_MAX_VERTEX_BUFFERS && "Too many vertex buffers.");
+    bool redundant = hasVertexBuffers && vertexBufferStart == startSlot && vertexBufferCount == count &&
+                     (count == 0 || memcmp(vertexBuffers, views, count * sizeof(GfxVertexBufferView)) == 0);
+    if (!Keep(GFX_CMD_SET_VERTEX_BUFFERS, redundant))
+        return;
+
+    hasVertexBuffers = true;
+    vertexBufferStart = startSlot;
+    vertexBufferCount = count;
+    if (count)
+        memcpy(vertexBuffers, views, count * sizeof(GfxVertexBufferView));
+    target.SetVertexBuffers(startSlot, count, views);
+}
+
+void GfxStateCache::SetIndexBuffer(const GfxIndexBufferView *view) {
+    bool redundant = hasIndexBuffer && (view ? !indexBufferIsNull && memcmp(&indexBuffer, view, sizeof(indexBuffer)) == 0
+                                             : indexBufferIsNull);
+    if (!Keep(GFX_CMD_SET_INDEX_BUFFER, redundant))
+        return;
+
+    hasIndexBuffer = true;
+    indexBufferIsNull = view == nullptr;
+    if (view)
+        indexBuffer = *view;
+    target.SetIndexBuffer(view);
+}
+
+void GfxStateCache::SetGraphicsRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) {
+    RootParameter *bound = parameter < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS ? &rootParameters[parameter] : nullptr;
+    if (!Keep(GFX_CMD_SET_ROOT_CBV, bound && bound->kind == ROOT_BINDING_CBV && bound->value == gpuAddress))
+        return;
+
+    if (bound) {
+        bound->kind = ROOT_BINDING_CBV;
+        bound->value = gpuAddress;
+    }
+    target.SetGraphicsRootConstantBufferView(parameter, gpuAddress);
+}
+
+void GfxStateCache::SetGraphicsRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) {
+    RootParameter *bound = parameter < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS ? &rootParameters[parameter] : nullptr;
+    if (!Keep(GFX_CMD_SET_ROOT_SRV, bound && bound->kind == ROOT_BINDING_SRV && bound->value == gpuAddress))
+        return;
+
+    if (bound) {
+        bound->kind = ROOT_BINDING_SRV;
+        bound->value = gpuAddress;
+    }
+    target.SetGraphicsRootShaderResourceView(parameter, gpuAddress);
+}
+
+void GfxStateCache::SetGraphicsRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) {
+    RootParameter *bound = parameter < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS ? &rootParameters[parameter] : nullptr;
+    if (!Keep(GFX_CMD_SET_ROOT_DESCRIPTOR_TABLE, bound && bound->kind == ROOT_BINDING_TABLE && bound->value == gpuDescriptor))
+        return;
+
+    if (bound) {
+        bound->kind = ROOT_BINDING_TABLE;
+        bound->value = gpuDescriptor;
+    }
+    target.SetGraphicsRootDescriptorTable(parameter, gpuDescriptor);
+}
+
+void GfxStateCache::SetGraphicsRoot32BitConstants(uint32_t parameter, uint32_t count, const void *data, uint32_t offset) {
+    assert(offset + count <= GFX_MAX_ROOT_CONSTANTS && "Too many root constants.");
+    RootParameter *bound = parameter < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS ? &rootParameters[parameter] : nullptr;
+    uint64_t       rangeMask = (count >= 64 ? ~0ull : ((1ull << count) - 1)) << offset;
+
+    bool redundant = bound && bound->kind == ROOT_BINDING_CONSTANTS && (bound->validMask & rangeMask) == rangeMask &&
+                     memcmp(&bound->constants[offset], data, count * sizeof(uint32_t)) == 0;
+    if (!Keep(GFX_CMD_SET_ROOT_CONSTANTS, redundant))
+        return;
+
+    if (bound) {
+        if (bound->kind != ROOT_BINDING_CONSTANTS)
+            bound->validMask = 0;
+        bound->kind = ROOT_BINDING_CONSTANTS;
+        bound->validMask |= rangeMask;
+        memcpy(&bound->constants[offset], data, count * sizeof(uint32_t));
+    }
+    target.SetGraphicsRoot32BitConstants(parameter, count, data, offset);
+}
+
+void GfxStateCache::SetComputeRootSignature(GfxHandle _rootSignature) {
+    if (!Keep(GFX_CMD_SET_COMPUTE_ROOT_SIGNATURE, hasComputeRootSignature && computeRootSignature == _rootSignature))
+        return;
+
+    hasComputeRootSignature = true;
+    computeRootSignature = _rootSignature;
+    ForgetRootParameters(computeRootParameters, false);
+    target.SetComputeRootSignature(_rootSignature);
+}
+
+void GfxStateCache::SetComputeRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) {
+    RootParameter *bound = parameter < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS ? &computeRootParameters[parameter] : nullptr;
+    if (!Keep(GFX_CMD_SET_COMPUTE_ROOT_CBV, bound && bound->kind == ROOT_BINDING_CBV && bound->value == gpuAddress))
+        return;
+
+    if (bound) {
+        bound->kind = ROOT_BINDING_CBV;
+        bound->value = gpuAddress;
+    }
+    target.SetComputeRootConstantBufferView(parameter, gpuAddress);
+}
+
+void GfxStateCache::SetComputeRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) {
+    RootParameter *bound = parameter < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS ? &computeRootParameters[parameter] : nullptr;
+    if (!Keep(GFX_CMD_SET_COMPUTE_ROOT_SRV, bound && bound->kind == ROOT_BINDING_SRV && bound->value == gpuAddress))
+        return;
+
+    if (bound) {
+        bound->kind = ROOT_BINDING_SRV;
+        bound->value = gpuAddress;
+    }
+    target.SetComputeRootShaderResourceView(parameter, gpuAddress);
+}
+
+void GfxStateCache::SetComputeRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) {
+    RootParameter *bound = parameter < GFX_STATE_CACHE_MAX_ROOT_PARAMETERS ? &computeRootParameters[parameter] : nullptr;
+    if (!Keep(GFX_CMD_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE,
+              bound && bound->kind == ROOT_BINDING_TABLE && bound->value == gpuDescriptor))
+        return;
+
+    if (bound) {
+        bound->kind = ROOT_BINDING_TABLE;
+        bound->value = gpuDescriptor;
+    }
+    target.SetComputeRootDescriptorTable(parameter, gpuDescriptor);
+}
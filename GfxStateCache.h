@@ -0,0 +1,109 @@
+#ifndef _GFX_STATE_CACHE_H_
+#define _GFX_STATE_CACHE_H_
+
+/* Redundant state filtering in front of another GfxCommandList. Passes are recorded self-contained, every
+ * one binds everything it needs, and the cache drops the calls that set what is already bound.
+ *
+ * NOTE(pf): Follows D3D12's rules for what survives: a new root signature forgets all root parameter
+ * bindings of its kind, graphics or compute, new descriptor heaps forget the descriptor tables of both. Everything else stays bound until it is
+ * set again or Invalidate is called, which has to happen whenever the target list is reset. Command
+ * signatures can set vertex and index buffers and graphics or compute root arguments, so all of those are
+ * also forgotten after ExecuteIndirect.
+ */
+
+#include "GfxCommandList.h"
+
+static constexpr uint32_t GFX_STATE_CACHE_MAX_ROOT_PARAMETERS = {16};
+
+struct GfxStateCacheStats {
+    uint32_t forwarded[GFX_CMD_COUNT] = {};
+    uint32_t dropped[GFX_CMD_COUNT] = {};
+    uint32_t totalForwarded = 0;
+    uint32_t totalDropped = 0;
+};
+
+struct GfxStateCache : GfxCommandList {
+    GfxStateCache(GfxCommandList &_target) : target(_target) { Invalidate(); }
+
+    void Invalidate();
+
+    void Barrier(GfxHandle resource, uint32_t before, uint32_t after) override;
+    void ClearRenderTarget(GfxHandle rtv, const float color[4]) override;
+    void ClearDepthStencil(GfxHandle dsv, uint32_t flags, float depth, uint8_t stencil) override;
+    void SetDescriptorHeaps(uint32_t count, const GfxHandle *heaps) override;
+    void SetGraphicsRootSignature(GfxHandle rootSignature) override;
+    void SetPipelineState(GfxHandle pipelineState) override;
+    void SetViewport(const GfxViewport &viewport) override;
+    void SetScissorRect(const GfxRect &rect) override;
+    void SetRenderTargets(uint32_t count, const GfxHandle *rtvs, const GfxHandle *dsv) override;
+    void SetPrimitiveTopology(uint32_t topology) override;
+    void SetVertexBuffers(uint32_t startSlot, uint32_t count, const GfxVertexBufferView *views) override;
+    void SetIndexBuffer(const GfxIndexBufferView *view) override;
+    void SetGraphicsRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetGraphicsRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetGraphicsRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) override;
+    void SetGraphicsRoot32BitConstants(uint32_t parameter, uint32_t count, const void *data, uint32_t offset) override;
+    void SetComputeRootSignature(GfxHandle rootSignature) override;
+    void SetComputeRootConstantBufferView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetComputeRootShaderResourceView(uint32_t parameter, uint64_t gpuAddress) override;
+    void SetComputeRootDescriptorTable(uint32_t parameter, GfxHandle gpuDescriptor) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                              uint32_t startInstance) override;
+    void ExecuteIndirect(GfxHandle commandSignature, uint32_t maxCommandCount, GfxHandle argumentBuffer,
+                         uint64_t argumentOffset) override;
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+    void WriteDescriptor(const GfxDescriptorWrite &write) override;
+    void BeginZone(const char *name) override;
+    void EndZone() override;
+
+    GfxCommandList    &target;
+    GfxStateCacheStats stats;
+
+  private:
+    enum ROOT_BINDING : uint8_t {
+        ROOT_BINDING_NONE,
+        ROOT_BINDING_CBV,
+        ROOT_BINDING_SRV,
+        ROOT_BINDING_TABLE,
+        ROOT_BINDING_CONSTANTS,
+    };
+
+    // NOTE(pf): Constants are shadowed per 32 bit value, validMask has a bit per value that is known.
+    struct RootParameter {
+        ROOT_BINDING kind;
+        uint64_t     value;
+        uint64_t     validMask;
+        uint32_t     constants[GFX_MAX_ROOT_CONSTANTS];
+    };
+
+    bool Keep(GFX_CMD command, bool redundant);
+    void ForgetRootParameters(RootParameter *parameters, bool tablesOnly);
+
+    bool                hasDescriptorHeaps;
+    uint32_t            descriptorHeapCount;
+    GfxHandle           descriptorHeaps[GFX_MAX_DESCRIPTOR_HEAPS];
+    bool                hasRootSignature;
+    GfxHandle           rootSignature;
+    bool                hasPipelineState;
+    GfxHandle           pipelineState;
+    bool                hasViewport;
+    GfxViewport         viewport;
+    bool                hasScissorRect;
+    GfxRect             scissorRect;
+    bool                hasTopology;
+    uint32_t            topology;
+    bool                hasVertexBuffers;
+    uint32_t            vertexBufferStart;
+    uint32_t            vertexBufferCount;
+    GfxVertexBufferView vertexBuffers[GFX_MAX_VERTEX_BUFFERS];
+    bool                hasIndexBuffer;
+    bool                indexBufferIsNull;
+    GfxIndexBufferView  indexBuffer;
+    RootParameter       rootParameters[GFX_STATE_CACHE_MAX_ROOT_PARAMETERS];
+    bool                hasComputeRootSignature;
+    GfxHandle           computeRootSignature;
+    RootParameter       computeRootParameters[GFX_STATE_CACHE_MAX_ROOT_PARAMETERS];
+};
+
+#endif //!_GFX_STATE_CACHE_H_
@@ -0,0 +1,283 @@
+/* Checks GfxStateCache against a recording command list behind it, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 GfxStateCacheTool.cpp GfxStateCache.cpp GfxRecorder.cpp -o GfxStateCacheTool
+ *   ./GfxStateCacheTool
+ *
+ * Every state command is set twice and the second must be dropped and counted, then the cases where D3D12
+ * forgets bindings: a new root signature forgets the root arguments of its kind, new descriptor heaps forget
+ * the descriptor tables of both, ExecuteIndirect forgets what a command signature can overwrite, and
+ * Invalidate forgets everything. Whether a call was forwarded is read from the recorder's command count, and
+ * the recorded stream must have no redundant command left by GfxAnalyzeCommandStream's rules. Prints JSON,
+ * the exit code is 1 if a check fails.
+ */
+
+#include "GfxRecorder.h"
+#include "GfxStateCache.h"
+#include <stdio.h>
+
+static uint32_t failures = 0;
+static uint32_t checks = 0;
+
+static void Check(bool condition, const char *what) {
+    checks++;
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+struct CacheUnderTest {
+    CacheUnderTest() : cache(recorder) {}
+
+    // NOTE(pf): True when the calls since the last one reached the recorder.
+    bool Forwarded() {
+        bool forwarded = recorder.commandCount > lastCount;
+        lastCount = recorder.commandCount;
+        return forwarded;
+    }
+
+    GfxRecordingCommandList recorder;
+    GfxStateCache           cache;
+    uint32_t                lastCount = 0;
+};
+
+static constexpr GfxHandle ROOT_SIGNATURE_A = {0x100};
+static constexpr GfxHandle ROOT_SIGNATURE_B = {0x200};
+static constexpr uint64_t  CBV_ADDRESS = {0x10000};
+static constexpr uint64_t  SRV_ADDRESS = {0x20000};
+static constexpr GfxHandle TABLE_DESCRIPTOR = {0x30000};
+
+static void CheckRedundantSets() {
+    CacheUnderTest      test;
+    GfxStateCache      &cache = test.cache;
+    GfxHandle           heaps[2] = {0x1, 0x2};
+    GfxViewport         viewport = {0.0f, 0.0f, 640.0f, 360.0f, 0.0f, 1.0f};
+    GfxRect             rect = {0, 0, 640, 360};
+    GfxVertexBufferView vertexBuffer = {0x4000, 1024, 32};
+    GfxIndexBufferView  indexBuffer = {0x8000, 512, GFX_FORMAT_R32_UINT};
+    uint32_t            constants[4] = {1, 2, 3, 4};
+    float               color[4] = {};
+
+    // .. each set twice in a row, the first reaches the recorder and the second is dropped ..
+    for (int pass = 0; pass < 2; ++pass) {
+        bool first = pass == 0;
+        cache.SetDescriptorHeaps(2, heaps);
+        Check(test.Forwarded() == first, "descriptor heaps");
+        cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+        Check(test.Forwarded() == first, "root signature");
+        cache.SetPipelineState(0x300);
+        Check(test.Forwarded() == first, "pipeline state");
+        cache.SetViewport(viewport);
+        Check(test.Forwarded() == first, "viewport");
+        cache.SetScissorRect(rect);
+        Check(test.Forwarded() == first, "scissor rect");
+        cache.SetPrimitiveTopology(GFX_TOPOLOGY_TRIANGLELIST);
+        Check(test.Forwarded() == first, "primitive topology");
+        cache.SetVertexBuffers(0, 1, &vertexBuffer);
+        Check(test.Forwarded() == first, "vertex buffers");
+        cache.SetIndexBuffer(&indexBuffer);
+        Check(test.Forwarded() == first, "index buffer");
+        cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+        Check(test.Forwarded() == first, "root cbv");
+        cache.SetGraphicsRootShaderResourceView(1, SRV_ADDRESS);
+        Check(test.Forwarded() == first, "root srv");
+        cache.SetGraphicsRootDescriptorTable(2, TABLE_DESCRIPTOR);
+        Check(test.Forwarded() == first, "root descriptor table");
+        cache.SetGraphicsRoot32BitConstants(3, 4, constants, 0);
+        Check(test.Forwarded() == first, "root constants");
+        cache.SetComputeRootSignature(ROOT_SIGNATURE_B);
+        Check(test.Forwarded() == first, "compute root signature");
+        cache.SetComputeRootConstantBufferView(0, CBV_ADDRESS);
+        Check(test.Forwarded() == first, "compute root cbv");
+        cache.SetComputeRootShaderResourceView(1, SRV_ADDRESS);
+        Check(test.Forwarded() == first, "compute root srv");
+        cache.SetComputeRootDescriptorTable(2, TABLE_DESCRIPTOR);
+        Check(test.Forwarded() == first, "compute root descriptor table");
+
+        // .. not state, never dropped ..
+        cache.ClearRenderTarget(0x500, color);
+        cache.DrawInstanced(3, 1, 0, 0);
+        cache.Dispatch(1, 1, 1);
+        Check(test.recorder.commandCount == test.lastCount + 3, "draws, dispatches and clears are always forwarded");
+        test.Forwarded();
+    }
+
+    for (uint16_t command = GFX_CMD_SET_DESCRIPTOR_HEAPS; command <= GFX_CMD_SET_COMPUTE_ROOT_DESCRIPTOR_TABLE; ++command) {
+        if (command == GFX_CMD_SET_RENDER_TARGETS)
+            continue;
+        Check(cache.stats.forwarded[command] == 1 && cache.stats.dropped[command] == 1, GfxCommandName(command));
+    }
+    Check(cache.stats.totalDropped == 16 && cache.stats.totalForwarded == test.recorder.commandCount,
+          "the totals count every dropped and forwarded call");
+
+    // .. a different value, a different kind on the same slot and a null index buffer are not redundant ..
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS + 256);
+    Check(test.Forwarded(), "a new cbv address is forwarded");
+    cache.SetGraphicsRootShaderResourceView(0, CBV_ADDRESS + 256);
+    Check(test.Forwarded(), "a srv where a cbv was bound is forwarded");
+    cache.SetIndexBuffer(nullptr);
+    Check(test.Forwarded(), "unbinding the index buffer is forwarded");
+    cache.SetIndexBuffer(nullptr);
+    Check(!test.Forwarded(), "unbinding it again is dropped");
+
+    // .. constants are tracked per value, a range is only redundant when all of it is known ..
+    uint32_t inner[2] = {2, 3};
+    cache.SetGraphicsRoot32BitConstants(3, 2, inner, 1);
+    Check(!test.Forwarded(), "constants inside a known range are dropped");
+    uint32_t overlapping[4] = {3, 4, 5, 6};
+    cache.SetGraphicsRoot32BitConstants(3, 4, overlapping, 2);
+    Check(test.Forwarded(), "constants reaching past the known range are forwarded");
+    uint32_t all[6] = {1, 2, 3, 4, 5, 6};
+    cache.SetGraphicsRoot32BitConstants(3, 6, all, 0);
+    Check(!test.Forwarded(), "the union of both ranges is known");
+
+    GfxCommandStreamStats streamStats;
+    Check(GfxAnalyzeCommandStream(test.recorder.stream.data(), test.recorder.stream.size(), streamStats),
+          "the recorded stream is valid");
+    Check(streamStats.totalRedundant == 0, "nothing redundant reaches the recorder");
+    printf("\"forwarded\": %u, \"dropped\": %u, ", cache.stats.totalForwarded, cache.stats.totalDropped);
+}
+
+static void CheckRootSignatureChange() {
+    CacheUnderTest test;
+    GfxStateCache &cache = test.cache;
+    uint32_t       constants[2] = {7, 8};
+
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    cache.SetGraphicsRoot32BitConstants(1, 2, constants, 0);
+    cache.SetComputeRootSignature(ROOT_SIGNATURE_A);
+    cache.SetComputeRootConstantBufferView(0, CBV_ADDRESS);
+    test.Forwarded();
+
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    Check(!test.Forwarded(), "the same root signature keeps the root arguments");
+
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_B);
+    Check(test.Forwarded(), "a new root signature is forwarded");
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    Check(test.Forwarded(), "a new root signature forgets root cbvs");
+    cache.SetGraphicsRoot32BitConstants(1, 2, constants, 0);
+    Check(test.Forwarded(), "a new root signature forgets root constants");
+    cache.SetComputeRootConstantBufferView(0, CBV_ADDRESS);
+    Check(!test.Forwarded(), "a new graphics root signature keeps the compute root arguments");
+
+    cache.SetComputeRootSignature(ROOT_SIGNATURE_B);
+    Check(test.Forwarded(), "a new compute root signature is forwarded");
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    Check(!test.Forwarded(), "a new compute root signature keeps the graphics root arguments");
+    cache.SetComputeRootConstantBufferView(0, CBV_ADDRESS);
+    Check(test.Forwarded(), "a new compute root signature forgets the compute root arguments");
+}
+
+static void CheckDescriptorHeapChange() {
+    CacheUnderTest test;
+    GfxStateCache &cache = test.cache;
+    GfxHandle      heapsA[2] = {0x1, 0x2};
+    GfxHandle      heapsB[2] = {0x3, 0x2};
+
+    cache.SetDescriptorHeaps(2, heapsA);
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    cache.SetGraphicsRootDescriptorTable(0, TABLE_DESCRIPTOR);
+    cache.SetGraphicsRootConstantBufferView(1, CBV_ADDRESS);
+    cache.SetComputeRootSignature(ROOT_SIGNATURE_B);
+    cache.SetComputeRootDescriptorTable(0, TABLE_DESCRIPTOR);
+    cache.SetComputeRootShaderResourceView(1, SRV_ADDRESS);
+    test.Forwarded();
+
+    cache.SetDescriptorHeaps(2, heapsA);
+    cache.SetGraphicsRootDescriptorTable(0, TABLE_DESCRIPTOR);
+    cache.SetComputeRootDescriptorTable(0, TABLE_DESCRIPTOR);
+    Check(!test.Forwarded(), "the same descriptor heaps keep the descriptor tables");
+
+    cache.SetDescriptorHeaps(2, heapsB);
+    Check(test.Forwarded(), "new descriptor heaps are forwarded");
+    cache.SetGraphicsRootDescriptorTable(0, TABLE_DESCRIPTOR);
+    Check(test.Forwarded(), "new descriptor heaps forget the graphics descriptor tables");
+    cache.SetComputeRootDescriptorTable(0, TABLE_DESCRIPTOR);
+    Check(test.Forwarded(), "new descriptor heaps forget the compute descriptor tables");
+    cache.SetGraphicsRootConstantBufferView(1, CBV_ADDRESS);
+    cache.SetComputeRootShaderResourceView(1, SRV_ADDRESS);
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    Check(!test.Forwarded(), "new descriptor heaps keep root descriptors and the root signature");
+}
+
+static void CheckExecuteIndirect() {
+    CacheUnderTest      test;
+    GfxStateCache      &cache = test.cache;
+    GfxViewport         viewport = {0.0f, 0.0f, 640.0f, 360.0f, 0.0f, 1.0f};
+    GfxVertexBufferView vertexBuffer = {0x4000, 1024, 32};
+    GfxIndexBufferView  indexBuffer = {0x8000, 512, GFX_FORMAT_R32_UINT};
+    uint32_t            constants[2] = {7, 8};
+
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    cache.SetPipelineState(0x300);
+    cache.SetViewport(viewport);
+    cache.SetPrimitiveTopology(GFX_TOPOLOGY_TRIANGLELIST);
+    cache.SetVertexBuffers(0, 1, &vertexBuffer);
+    cache.SetIndexBuffer(&indexBuffer);
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    cache.SetGraphicsRoot32BitConstants(1, 2, constants, 0);
+    cache.SetComputeRootSignature(ROOT_SIGNATURE_B);
+    cache.SetComputeRootConstantBufferView(0, CBV_ADDRESS);
+    test.Forwarded();
+
+    cache.ExecuteIndirect(0x600, 16, 0x700, 0);
+    Check(test.Forwarded(), "ExecuteIndirect is forwarded");
+
+    cache.SetVertexBuffers(0, 1, &vertexBuffer);
+    Check(test.Forwarded(), "ExecuteIndirect forgets the vertex buffers");
+    cache.SetIndexBuffer(&indexBuffer);
+    Check(test.Forwarded(), "ExecuteIndirect forgets the index buffer");
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    Check(test.Forwarded(), "ExecuteIndirect forgets the graphics root descriptors");
+    cache.SetGraphicsRoot32BitConstants(1, 2, constants, 0);
+    Check(test.Forwarded(), "ExecuteIndirect forgets the root constants");
+    cache.SetComputeRootConstantBufferView(0, CBV_ADDRESS);
+    Check(test.Forwarded(), "ExecuteIndirect forgets the compute root arguments");
+
+    // .. what a command signature cannot change stays bound ..
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    cache.SetComputeRootSignature(ROOT_SIGNATURE_B);
+    cache.SetPipelineState(0x300);
+    cache.SetViewport(viewport);
+    cache.SetPrimitiveTopology(GFX_TOPOLOGY_TRIANGLELIST);
+    Check(!test.Forwarded(), "ExecuteIndirect keeps root signatures, pipeline, viewport and topology");
+
+    GfxCommandStreamStats streamStats;
+    GfxAnalyzeCommandStream(test.recorder.stream.data(), test.recorder.stream.size(), streamStats);
+    Check(streamStats.totalRedundant == 0, "the analyzer forgets the same state after ExecuteIndirect");
+}
+
+static void CheckInvalidate() {
+    CacheUnderTest test;
+    GfxStateCache &cache = test.cache;
+    GfxHandle      heaps[1] = {0x1};
+
+    cache.SetDescriptorHeaps(1, heaps);
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    cache.SetPipelineState(0x300);
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    cache.SetComputeRootSignature(ROOT_SIGNATURE_B);
+    test.Forwarded();
+
+    cache.Invalidate();
+    uint32_t before = test.recorder.commandCount;
+    cache.SetDescriptorHeaps(1, heaps);
+    cache.SetGraphicsRootSignature(ROOT_SIGNATURE_A);
+    cache.SetPipelineState(0x300);
+    cache.SetGraphicsRootConstantBufferView(0, CBV_ADDRESS);
+    cache.SetComputeRootSignature(ROOT_SIGNATURE_B);
+    Check(test.recorder.commandCount == before + 5, "Invalidate forgets everything");
+}
+
+int main() {
+    printf("{\"tool\": \"gfx_state_cache\", ");
+    CheckRedundantSets();
+    CheckRootSignatureChange();
+    CheckDescriptorHeapChange();
+    CheckExecuteIndirect();
+    CheckInvalidate();
+    printf("\"checks\": %u, \"failures\": %u}\n", checks, failures);
+    return failures ? 1 : 0;
+}
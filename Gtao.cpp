@@ -0,0 +1,114 @@
+#include "Gtao.h"
+#include <cmath>
+
+static constexpr float PI = {3.14159265f};
+static constexpr float HALF_PI = {0.5f * PI};
+
+// NOTE(pf): View position of the center of texel (x, y), reads outside the depth buffer are clamped to its
+// edge like gsamDepthMap.
+static void TexelViewPosition(const GtaoView &view, int x, int y, float out[3]) {
+    x = x < 0 ? 0 : (x >= (int)view.width ? (int)view.width - 1 : x);
+    y = y < 0 ? 0 : (y >= (int)view.height ? (int)view.height - 1 : y);
+    float ndcX = 2.0f * (x + 0.5f) / view.width - 1.0f;
+    float ndcY = 1.0f - 2.0f * (y + 0.5f) / view.height;
+    float z = view.projB / (view.ndcDepth[y * view.width + x] - view.projA);
+    out[0] = ndcX * z / view.proj00;
+    out[1] = ndcY * z / view.proj11;
+    out[2] = z;
+}
+
+static float Dot3(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static float Length3(const float v[3]) {
+    return sqrtf(Dot3(v, v));
+}
+
+// Cosine of the angle between the view vector and the direction to the tap, faded out towards the radius.
+static float HorizonCos(const GtaoView &view, const GtaoSettings &settings, const float p[3], const float viewVec[3],
+                        float tapX, float tapY, float lowHorizonCos) {
+    float q[3];
+    TexelViewPosition(view, (int)floorf(tapX), (int)floorf(tapY), q);
+    float delta[3] = {q[0] - p[0], q[1] - p[1], q[2] - p[2]};
+    float distance = Length3(delta);
+    if (distance <= 0.0f)
+        return lowHorizonCos;
+
+    float cosine = Dot3(delta, viewVec) / distance;
+    float weight = Clamp((settings.radius - distance) / (settings.falloffRange * settings.radius), 0.0f, 1.0f);
+    return lowHorizonCos + (cosine - lowHorizonCos) * weight;
+}
+
+float GtaoVisibility(const GtaoView &view, const GtaoSettings &settings, uint32_t x, uint32_t y, float sliceNoise,
+                     float stepNoise) {
+    float p[3];
+    TexelViewPosition(view, (int)x, (int)y, p);
+
+    // .. radius in pixels, a pixel whose radius covers less than a texel has nothing to search ..
+    float radiusPixels = settings.radius * view.proj11 * 0.5f * view.height / p[2];
+    if (radiusPixels < 1.0f || settings.sliceCount == 0 || settings.stepCount == 0)
+        return 1.0f;
+    float minStep = settings.minStepPixels / radiusPixels;
+
+    const float *normal = &view.normals[(y * view.width + x) * 3];
+    float        n[3] = {normal[0], normal[1], normal[2]};
+    float        invLength = 1.0f / Max(Length3(n), 1e-6f);
+    n[0] *= invLength;
+    n[1] *= invLength;
+    n[2] *= invLength;
+    float invDistance = 1.0f / Length3(p);
+    float viewVec[3] = {-p[0] * invDistance, -p[1] * invDistance, -p[2] * invDistance};
+
+    float visibility = 0.0f;
+    for (uint32_t slice = 0; slice < settings.sliceCount; ++slice) {
+        float phi = (slice + sliceNoise) / settings.sliceCount * PI;
+        float cosPhi = cosf(phi), sinPhi = sinf(phi);
+
+        // .. project the normal into the slice plane, n is its angle from the view vector ..
+        float direction[3] = {cosPhi, sinPhi, 0.0f};
+        float d = Dot3(direction, viewVec);
+        float orthoDirection[3] = {direction[0] - d * viewVec[0], direction[1] - d * viewVec[1], direction[2] - d * viewVec[2]};
+        float axis[3] = {orthoDirection[1] * viewVec[2] - orthoDirection[2] * viewVec[1],
+                         orthoDirection[2] * viewVec[0] - orthoDirection[0] * viewVec[2],
+                         orthoDirection[0] * viewVec[1] - orthoDirection[1] * viewVec[0]};
+        float axisLength = Length3(axis);
+        if (axisLength <= 0.0f)
+            continue;
+        float a = Dot3(n, axis) / (axisLength * axisLength);
+        float projectedNormal[3] = {n[0] - a * axis[0], n[1] - a * axis[1], n[2] - a * axis[2]};
+        float projectedLength = Length3(projectedNormal);
+        if (projectedLength <= 0.0f)
+            continue;
+        float signNormal = Dot3(orthoDirection, projectedNormal) < 0.0f ? -1.0f : 1.0f;
+        float cosNormal = Clamp(Dot3(projectedNormal, viewVec) / projectedLength, 0.0f, 1.0f);
+        float angleNormal = signNormal * acosf(cosNormal);
+
+        // .. the tangent plane is the lowest each horizon can be, march both sides for anything higher ..
+        float lowHorizonCos0 = cosf(angleNormal + HALF_PI);
+        float lowHorizonCos1 = cosf(angleNormal - HALF_PI);
+        float horizonCos0 = lowHorizonCos0;
+        float horizonCos1 = lowHorizonCos1;
+        for (uint32_t step = 0; step < settings.stepCount; ++step) {
+            float s = (step + stepNoise) / settings.stepCount;
+            s = powf(s, settings.sampleDistributionPower) + minStep;
+            float offsetX = s * radiusPixels * cosPhi;
+            float offsetY = -s * radiusPixels * sinPhi;
+
+            float pixelX = x + 0.5f, pixelY = y + 0.5f;
+            horizonCos0 = Max(horizonCos0, HorizonCos(view, settings, p, viewVec, pixelX + offsetX, pixelY + offsetY, lowHorizonCos0));
+            horizonCos1 = Max(horizonCos1, HorizonCos(view, settings, p, viewVec, pixelX - offsetX, pixelY - offsetY, lowHorizonCos1));
+        }
+
+        // .. and integrate cos(h - n) * |sin(h)| between the two horizons, clamped to the hemisphere ..
+        float h0 = -acosf(Clamp(horizonCos1, -1.0f, 1.0f));
+        float h1 = acosf(Clamp(horizonCos0, -1.0f, 1.0f));
+        h0 = angleNormal + Max(h0 - angleNormal, -HALF_PI);
+        h1 = angleNormal + Min(h1 - angleNormal, HALF_PI);
+        float sinNormal = sinf(angleNormal);
+        float arc0 = (cosNormal + 2.0f * h0 * sinNormal - cosf(2.0f * h0 - angleNormal)) * 0.25f;
+        float arc1 = (cosNormal + 2.0f * h1 * sinNormal - cosf(2.0f * h1 - angleNormal)) * 0.25f;
+        visibility += projectedLength * (arc0 + arc1);
+    }
+    return Clamp(visibility / settings.sliceCount, 0.0f, 1.0f);
+}
@@ -0,0 +1,70 @@
+#ifndef _GTAO_H_
+#define _GTAO_H_
+
+/* Ground truth ambient occlusion (Jimenez et al. 2016), the horizon based alternative to the hemisphere
+ * kernel of shaders/SSAOPS.hlsl and the CPU reference of shaders/GtaoPS.hlsl. Every pixel marches a few
+ * screen space slices through it, finds the highest horizon on both sides of each slice in the depth map
+ * and integrates the cosine weighted visibility between them analytically. A tap contributes a horizon
+ * instead of a single occluded/unoccluded bit, so far fewer taps give a smooth result.
+ *
+ * NOTE(pf): View space is left handed like the projection, +x right, +y up and +z into the screen. Slices
+ * are in pixels with +y down, a slice at angle phi moves along (cos, -sin) on screen and (cos, sin, 0) in
+ * view space.
+ */
+
+#include "Common.h"
+
+enum SSAO_ENGINE : uint32_t {
+    SSAO_ENGINE_HEMISPHERE, // SSAOPS, random points in the normal oriented hemisphere.
+    SSAO_ENGINE_GTAO,       // GtaoPS, horizon search along screen space slices.
+};
+
+enum GTAO_QUALITY : uint32_t {
+    GTAO_QUALITY_LOW,
+    GTAO_QUALITY_MEDIUM,
+    GTAO_QUALITY_HIGH,
+    GTAO_QUALITY_ULTRA,
+    GTAO_QUALITY_COUNT
+};
+
+// NOTE(pf): Every step reads two depths, one on each side of the pixel, so a pixel costs
+// 2 * sliceCount * stepCount taps. The hemisphere kernel takes 14.
+struct GtaoPreset {
+    const char *name;
+    uint32_t    sliceCount;
+    uint32_t    stepCount;
+};
+
+static constexpr GtaoPreset GTAO_PRESETS[GTAO_QUALITY_COUNT] = {
+    {"low", 1, 2},
+    {"medium", 2, 2},
+    {"high", 3, 3},
+    {"ultra", 9, 3},
+};
+
+// NOTE(pf): Same values DX12SSAOPass uploads to cbSsaoStatic, the slice and step counts go to cbSsaoPass.
+struct GtaoSettings {
+    float    radius = 0.5f;                  // View space.
+    float    falloffRange = 0.3f;            // Taps fade out over the last falloffRange of the radius.
+    float    sampleDistributionPower = 2.0f; // Steps bunch up close to the pixel where detail matters.
+    float    minStepPixels = 1.3f;           // The first step leaves the pixel's own texel.
+    uint32_t sliceCount = GTAO_PRESETS[GTAO_QUALITY_MEDIUM].sliceCount;
+    uint32_t stepCount = GTAO_PRESETS[GTAO_QUALITY_MEDIUM].stepCount;
+};
+
+// NOTE(pf): The depth buffer and view space normals the visibility is computed from. view depth is
+// projB / (ndc - projA) as in SSAOPS, proj00 and proj11 are the projection's x and y scale.
+struct GtaoView {
+    const float *ndcDepth;
+    const float *normals; // xyz per pixel.
+    uint32_t     width, height;
+    float        projA, projB;
+    float        proj00, proj11;
+};
+
+// NOTE(pf): Visibility of pixel (x, y) in [0, 1], 1 is unoccluded. The noise values in [0, 1) rotate the
+// slices and offset the steps, neighbouring pixels should get different ones.
+float GtaoVisibility(const GtaoView &view, const GtaoSettings &settings, uint32_t x, uint32_t y, float sliceNoise,
+                     float stepNoise);
+
+#endif //!_GTAO_H_
@@ -0,0 +1,160 @@
+#include "HotReload.h"
+#include "Platform.h"
+#include <algorithm>
+#include <string.h>
+
+void ParseShaderIncludes(const char *path, const char *source, size_t size, std::vector<std::string> &includes) {
+    const char       *directoryEnd = strrchr(path, '/');
+    const std::string directory(path, directoryEnd ? directoryEnd - path + 1 : 0);
+
+    const char *c = source;
+    const char *end = source + size;
+    bool        lineStart = true;
+    while (c < end) {
+        // .. comments, an include in one does not count ..
+        if (*c == '/' && c + 1 < end && c[1] == '/') {
+            while (c < end && *c != '\n')
+                c++;
+            continue;
+        }
+        if (*c == '/' && c + 1 < end && c[1] == '*') {
+            for (c += 2; c < end && !(*c == '*' && c + 1 < end && c[1] == '/'); ++c)
+                ;
+            c = c < end ? c + 2 : end;
+            continue;
+        }
+        if (*c == '\n') {
+            lineStart = true;
+            c++;
+            continue;
+        }
+        if (*c == ' ' || *c == '\t' || *c == '\r') {
+            c++;
+            continue;
+        }
+
+        // .. a directive has to be the first thing on its line ..
+        if (lineStart && *c == '#') {
+            const char *d = c + 1;
+            while (d < end && (*d == ' ' || *d == '\t'))
+                d++;
+            if (end - d > 7 && strncmp(d, "include", 7) == 0) {
+                d += 7;
+                while (d < end && (*d == ' ' || *d == '\t'))
+                    d++;
+                if (d < end && (*d == '"' || *d == '<')) {
+                    char        close = *d == '"' ? '"' : '>';
+                    const char *nameEnd = d + 1;
+                    while (nameEnd < end && *nameEnd != close && *nameEnd != '\n')
+                        nameEnd++;
+                    if (nameEnd < end && *nameEnd == close)
+                        includes.push_back(directory + std::string(d + 1, nameEnd));
+                }
+            }
+        }
+        lineStart = false;
+        c++;
+    }
+}
+
+uint32_t HotReloadTracker::AddFile(const char *name) {
+    uint32_t file = FindFile(name);
+    if (file != HOT_RELOAD_NONE)
+        return file;
+    files.emplace_back();
+    files.back().name = name;
+    return (uint32_t)files.size() - 1;
+}
+
+uint32_t HotReloadTracker::FindFile(const char *name) const {
+    for (uint32_t i = 0; i < (uint32_t)files.size(); ++i) {
+        if (files[i].name == name)
+            return i;
+    }
+    return HOT_RELOAD_NONE;
+}
+
+void HotReloadTracker::SetIncludes(uint32_t file, const std::vector<std::string> &includes) {
+    for (uint32_t included : files[file].includes) {
+        std::vector<uint32_t> &by = files[included].includedBy;
+        by.erase(std::remove(by.begin(), by.end(), file), by.end());
+    }
+    files[file].includes.clear();
+
+    for (const std::string &name : includes) {
+        uint32_t included = AddFile(name.c_str());
+        if (std::find(files[file].includes.begin(), files[file].includes.end(), included) != files[file].includes.end())
+            continue;
+        files[file].includes.push_back(included);
+        files[included].includedBy.push_back(file);
+    }
+}
+
+bool HotReloadTracker::ScanIncludes(uint32_t file) {
+    std::vector<uint8_t> source;
+    if (!PlatformReadFile(files[file].name.c_str(), source))
+        return false;
+    std::vector<std::string> includes;
+    ParseShaderIncludes(files[file].name.c_str(), (const char *)source.data(), source.size(), includes);
+    SetIncludes(file, includes);
+    return true;
+}
+
+uint32_t HotReloadTracker::AddTarget() {
+    return targetCount++;
+}
+
+void HotReloadTracker::AddDependency(uint32_t target, uint32_t file) {
+    std::vector<uint32_t> &targets = files[file].targets;
+    if (std::find(targets.begin(), targets.end(), target) == targets.end())
+        targets.push_back(target);
+}
+
+bool HotReloadTracker::FileChanged(const char *name, double timeMs) {
+    uint32_t file = FindFile(name);
+    if (file == HOT_RELOAD_NONE)
+        return false;
+    if (std::find(pending.begin(), pending.end(), file) == pending.end())
+        pending.push_back(file);
+    lastChangeMs = timeMs;
+    return true;
+}
+
+bool HotReloadTracker::Collect(double timeMs, HotReloadBatch &batch) {
+    batch.changed.clear();
+    batch.dirty.clear();
+    batch.targets.clear();
+    if (pending.empty() || timeMs - lastChangeMs < HOT_RELOAD_SETTLE_MS)
+        return false;
+
+    // .. walk up the includes from every changed file, the marks stop cycles ..
+    fileMarks.assign(files.size(), 0);
+    targetMarks.assign(targetCount, 0);
+    for (uint32_t file : pending) {
+        fileMarks[file] = 1;
+        batch.dirty.push_back(file);
+    }
+    for (size_t i = 0; i < batch.dirty.size(); ++i) {
+        for (uint32_t including : files[batch.dirty[i]].includedBy) {
+            if (!fileMarks[including]) {
+                fileMarks[including] = 1;
+                batch.dirty.push_back(including);
+            }
+        }
+    }
+    for (uint32_t file : batch.dirty) {
+        for (uint32_t target : files[file].targets) {
+            if (!targetMarks[target]) {
+                targetMarks[target] = 1;
+                batch.targets.push_back(target);
+            }
+        }
+    }
+
+    batch.changed.swap(pending);
+    pending.clear();
+    std::sort(batch.changed.begin(), batch.changed.end());
+    std::sort(batch.dirty.begin(), batch.dirty.end());
+    std::sort(batch.targets.begin(), batch.targets.end());
+    return true;
+}
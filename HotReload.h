@@ -0,0 +1,64 @@
+#ifndef _HOT_RELOAD_H_
+#define _HOT_RELOAD_H_
+
+/* What has to be rebuilt when asset files change, portable so HotReloadTool checks it headless. DX12 watches
+ * shaders/ and models/ with PlatformDirectoryWatch, reports every change here and rebuilds the targets of each
+ * batch: the pipelines of FramePasses.h and the meshes.
+ *
+ * NOTE(pf): Files are nodes and an include is an edge from the including file to the included one. A changed
+ * file dirties itself and every file that includes it, directly or through others, and a target is rebuilt when
+ * one of the files it depends on is dirty. Editing a file's includes only changes what it depends on, never what
+ * depends on it, so the includes of a batch's changed files are scanned again after it was collected. Editors
+ * save in several writes and often several files at once, a batch is only handed out once nothing changed for
+ * HOT_RELOAD_SETTLE_MS.
+ */
+
+#include "Common.h"
+#include <string>
+#include <vector>
+
+static constexpr double   HOT_RELOAD_SETTLE_MS = {100.0};
+static constexpr uint32_t HOT_RELOAD_NONE = {0xffffffffu};
+
+// NOTE(pf): Appends the files of every #include "file" or <file> outside of comments, relative to path's
+// directory like the compiler's default include handler resolves them.
+void ParseShaderIncludes(const char *path, const char *source, size_t size, std::vector<std::string> &includes);
+
+struct HotReloadBatch {
+    std::vector<uint32_t> changed; // Files, sorted.
+    std::vector<uint32_t> dirty;   // Files, the changed ones and everything including them, sorted.
+    std::vector<uint32_t> targets; // Sorted.
+};
+
+struct HotReloadTracker {
+    // NOTE(pf): Names are paths as the watcher reports them joined to their directory, "shaders/SSAOPS.hlsl".
+    uint32_t    AddFile(const char *name); // The existing id when it was added before.
+    uint32_t    FindFile(const char *name) const;
+    const char *FileName(uint32_t file) const { return files[file].name.c_str(); }
+    void        SetIncludes(uint32_t file, const std::vector<std::string> &includes); // Adds the files it does not know.
+    // NOTE(pf): Reads the file and sets the includes ParseShaderIncludes finds, false when it can not be read.
+    bool        ScanIncludes(uint32_t file);
+
+    uint32_t AddTarget();
+    void     AddDependency(uint32_t target, uint32_t file);
+
+    // NOTE(pf): Returns false for files that were never added, they are ignored.
+    bool FileChanged(const char *name, double timeMs);
+    // NOTE(pf): False while nothing changed or the changes are still settling.
+    bool Collect(double timeMs, HotReloadBatch &batch);
+
+    struct File {
+        std::string           name;
+        std::vector<uint32_t> includes;
+        std::vector<uint32_t> includedBy;
+        std::vector<uint32_t> targets;
+    };
+    std::vector<File>     files;
+    uint32_t              targetCount = {0};
+    std::vector<uint32_t> pending; // Changed files not collected yet.
+    double                lastChangeMs = {0.0};
+    std::vector<uint8_t>  fileMarks; // Scratch of Collect.
+    std::vector<uint8_t>  targetMarks;
+};
+
+#endif //!_HOT_RELOAD_H_
@@ -0,0 +1,200 @@
+/* Checks the hot reload bookkeeping of HotReload.h headless, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread HotReloadTool.cpp HotReload.cpp FramePasses.cpp Platform_Posix.cpp Timer.cpp
+ *       -o HotReloadTool
+ *   ./HotReloadTool [--shaders shaders] [--model models/skull.txt]
+ *
+ * The tracker is set up like DX12 sets it up with --hot-reload: the shaders of FramePasses.h, the includes of every
+ * file in the shader directory and a target per pipeline plus one for the skull. Every file is then changed on
+ * its own and the pipelines rebuilt are compared against the ones whose shaders reach the file through their
+ * includes, found by walking the includes down from each pipeline instead. Synthetic files check the include
+ * parser against comments, include cycles, edited includes and the settle time, and a directory watch on the
+ * working directory has to report files written and renamed into it. The rebuilds per file are printed as JSON,
+ * the exit code is 1 if a check fails.
+ */
+
+#include "FramePasses.h"
+#include "HotReload.h"
+#include "Platform.h"
+#include <stdio.h>
+#include <string.h>
+
+static constexpr uint32_t WATCH_TIMEOUT_MS = {2000};
+
+static uint32_t failures = 0;
+
+static void Check(bool condition, const char *what) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static bool WriteText(const char *path, const char *text) {
+    return PlatformWriteFile(path, text, strlen(text));
+}
+
+static void ReachableFiles(const HotReloadTracker &tracker, uint32_t file, std::vector<uint8_t> &reached) {
+    if (reached[file])
+        return;
+    reached[file] = 1;
+    for (uint32_t included : tracker.files[file].includes)
+        ReachableFiles(tracker, included, reached);
+}
+
+// .. changes one file at a time and compares the rebuilt pipelines against a walk down from every pipeline ..
+static void CheckFrameShaders(const char *shaderPath, const char *modelPath) {
+    std::vector<std::string> names;
+    Check(PlatformListDirectory(shaderPath, names), "the shader directory lists");
+
+    HotReloadTracker tracker;
+    for (const std::string &name : names)
+        tracker.AddFile((std::string(shaderPath) + "/" + name).c_str());
+    for (uint32_t file = 0; file < (uint32_t)tracker.files.size(); ++file)
+        Check(tracker.ScanIncludes(file), "every shader scans");
+    for (uint32_t p = 0; p < FRAME_PIPELINE_COUNT; ++p) {
+        uint32_t target = tracker.AddTarget();
+        for (uint32_t s = 0; s < FRAME_PIPELINES[p].shaderCount; ++s) {
+            std::string path = std::string(shaderPath) + "/" + FRAME_SHADERS[FRAME_PIPELINES[p].shaders[s]].file;
+            Check(tracker.FindFile(path.c_str()) != HOT_RELOAD_NONE, "every frame shader is in the shader directory");
+            tracker.AddDependency(target, tracker.AddFile(path.c_str()));
+        }
+    }
+    uint32_t meshTarget = tracker.AddTarget();
+    tracker.AddDependency(meshTarget, tracker.AddFile(modelPath));
+
+    std::vector<std::vector<uint8_t>> reachedBy(FRAME_PIPELINE_COUNT);
+    for (uint32_t p = 0; p < FRAME_PIPELINE_COUNT; ++p) {
+        reachedBy[p].assign(tracker.files.size(), 0);
+        for (uint32_t s = 0; s < FRAME_PIPELINES[p].shaderCount; ++s) {
+            std::string path = std::string(shaderPath) + "/" + FRAME_SHADERS[FRAME_PIPELINES[p].shaders[s]].file;
+            ReachableFiles(tracker, tracker.FindFile(path.c_str()), reachedBy[p]);
+        }
+    }
+
+    printf("{\"tool\": \"hot_reload\", \"files\": %zu, \"pipelines\": %u, \"rebuilds\": {", tracker.files.size(), FRAME_PIPELINE_COUNT);
+    HotReloadBatch batch;
+    double         timeMs = 0.0;
+    uint32_t       totalRebuilds = 0;
+    for (uint32_t file = 0; file < (uint32_t)tracker.files.size(); ++file) {
+        Check(tracker.FileChanged(tracker.FileName(file), timeMs), "a known file is tracked");
+        timeMs += HOT_RELOAD_SETTLE_MS;
+        Check(tracker.Collect(timeMs, batch) && batch.changed.size() == 1 && batch.changed[0] == file,
+              "a settled change is collected");
+
+        std::vector<uint32_t> expected;
+        for (uint32_t p = 0; p < FRAME_PIPELINE_COUNT; ++p) {
+            if (reachedBy[p][file])
+                expected.push_back(p);
+        }
+        if (file == tracker.FindFile(modelPath))
+            expected.push_back(meshTarget);
+        Check(batch.targets == expected, "exactly the pipelines reaching the file are rebuilt");
+        totalRebuilds += (uint32_t)batch.targets.size();
+
+        printf("%s\n  \"%s\": [", file == 0 ? "" : ",", tracker.FileName(file));
+        for (size_t t = 0; t < batch.targets.size(); ++t)
+            printf("%s\"%s\"", t == 0 ? "" : ", ", batch.targets[t] == meshTarget ? "Mesh" : FRAME_PIPELINES[batch.targets[t]].name);
+        printf("]");
+    }
+    printf("\n}, \"average_rebuilds\": %.2f, ", (double)totalRebuilds / tracker.files.size());
+}
+
+// .. the parser, cycles, edited includes and settling on files in the working directory ..
+static void CheckSynthetic() {
+    const char *sources[][2] = {
+        {"HotReloadTool_A.hlsl", "// #include \"HotReloadTool_X.hlsl\"\n#include \"HotReloadTool_B.hlsl\"\nfloat a;\n"},
+        {"HotReloadTool_B.hlsl", "  #  include <HotReloadTool_C.hlsl>\n/* #include \"HotReloadTool_X.hlsl\"\n*/ float b;\n"},
+        {"HotReloadTool_C.hlsl", "float c; // not #include \"HotReloadTool_X.hlsl\"\n#include \"HotReloadTool_A.hlsl\"\n"},
+    };
+    HotReloadTracker tracker;
+    for (const auto &source : sources) {
+        Check(WriteText(source[0], source[1]), "a synthetic file is written");
+        tracker.AddFile(source[0]);
+    }
+    for (uint32_t file = 0; file < 3; ++file)
+        Check(tracker.ScanIncludes(file), "a synthetic file scans");
+    for (uint32_t file = 0; file < 3; ++file)
+        Check(tracker.files[file].includes.size() == 1 && tracker.files[file].includes[0] == (file + 1) % 3,
+              "includes in comments are skipped, the others found");
+    Check(tracker.FindFile("HotReloadTool_X.hlsl") == HOT_RELOAD_NONE, "no file is added for a commented include");
+
+    uint32_t       targets[3];
+    HotReloadBatch batch;
+    for (uint32_t file = 0; file < 3; ++file) {
+        targets[file] = tracker.AddTarget();
+        tracker.AddDependency(targets[file], file);
+    }
+
+    // .. A includes B includes C includes A, any change rebuilds all three and terminates ..
+    tracker.FileChanged("HotReloadTool_C.hlsl", 0.0);
+    Check(tracker.Collect(HOT_RELOAD_SETTLE_MS, batch) && batch.dirty.size() == 3 && batch.targets.size() == 3, "a cycle dirties all of it");
+
+    // .. changes keep coming in, nothing is handed out until they settle, duplicates collapse ..
+    Check(!tracker.FileChanged("HotReloadTool_Unknown.hlsl", 0.0), "unknown files are ignored");
+    tracker.FileChanged("HotReloadTool_B.hlsl", 1000.0);
+    Check(!tracker.Collect(1000.0 + HOT_RELOAD_SETTLE_MS * 0.5, batch), "a change settles before it is collected");
+    tracker.FileChanged("HotReloadTool_B.hlsl", 1000.0 + HOT_RELOAD_SETTLE_MS * 0.75);
+    Check(!tracker.Collect(1000.0 + HOT_RELOAD_SETTLE_MS * 1.5, batch), "a later change restarts the settle time");
+    Check(tracker.Collect(1000.0 + HOT_RELOAD_SETTLE_MS * 2.0, batch) && batch.changed.size() == 1, "repeated changes collapse");
+    Check(!tracker.Collect(10000.0, batch), "a batch is handed out once");
+
+    // .. C stops including A, after the rescan a change to A only reaches A and whatever includes it ..
+    Check(WriteText("HotReloadTool_C.hlsl", "float c;\n"), "a synthetic file is rewritten");
+    Check(tracker.ScanIncludes(2), "the rewritten file scans");
+    tracker.FileChanged("HotReloadTool_A.hlsl", 20000.0);
+    Check(tracker.Collect(20000.0 + HOT_RELOAD_SETTLE_MS, batch) && batch.targets.size() == 1 && batch.targets[0] == targets[0],
+          "an include removed is no longer followed");
+    tracker.FileChanged("HotReloadTool_C.hlsl", 30000.0);
+    Check(tracker.Collect(30000.0 + HOT_RELOAD_SETTLE_MS, batch) && batch.targets.size() == 3, "the includes left are still followed");
+
+    for (const auto &source : sources)
+        remove(source[0]);
+}
+
+static bool WaitForChange(PlatformDirectoryWatch &watch, const char *name) {
+    std::vector<std::string> names;
+    for (uint32_t waitedMs = 0; waitedMs < WATCH_TIMEOUT_MS; waitedMs += 10) {
+        PlatformPollDirectoryWatch(watch, names);
+        for (const std::string &changed : names) {
+            if (changed == name)
+                return true;
+        }
+        PlatformSleep(10);
+    }
+    return false;
+}
+
+static bool CheckWatch() {
+    PlatformDirectoryWatch watch;
+    if (!PlatformWatchDirectory(".", watch)) {
+        Check(false, "the working directory can be watched");
+        return false;
+    }
+    bool written = WriteText("HotReloadTool_Watched.hlsl", "float w;\n") && WaitForChange(watch, "HotReloadTool_Watched.hlsl");
+    Check(written, "a written file is reported");
+    bool renamed = WriteText("HotReloadTool_Watched.tmp", "float w2;\n") &&
+                   rename("HotReloadTool_Watched.tmp", "HotReloadTool_Renamed.hlsl") == 0 &&
+                   WaitForChange(watch, "HotReloadTool_Renamed.hlsl");
+    Check(renamed, "a file renamed into the directory is reported");
+    PlatformCloseDirectoryWatch(watch);
+    remove("HotReloadTool_Watched.hlsl");
+    remove("HotReloadTool_Renamed.hlsl");
+    return written && renamed;
+}
+
+int main(int argc, char **argv) {
+    const char *shaderPath = "shaders";
+    const char *modelPath = "models/skull.txt";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--shaders") == 0 && i + 1 < argc)
+            shaderPath = argv[++i];
+        else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+    }
+
+    CheckFrameShaders(shaderPath, modelPath);
+    CheckSynthetic();
+    bool watched = CheckWatch();
+    printf("\"watch\": %s, \"failures\": %u}\n", watched ? "true" : "false", failures);
+    return failures ? 1 : 0;
+}
@@ -1,29 +1,140 @@
-#include "input.h"
-#include <cstring>
+#include "Input.h"
 
-Input *Input::Instance = nullptr;
+bool InputEventRing::Push(const InputEvent &event) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == INPUT_RING_CAPACITY)
+        return false;
+    events[h & (INPUT_RING_CAPACITY - 1)] = event;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+const InputEvent *InputEventRing::Peek() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+        return nullptr;
+    return &events[t & (INPUT_RING_CAPACITY - 1)];
+}
+
+void InputEventRing::Pop() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+uint32_t InputEventRing::Count() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
 
-void Input::Update() {
-    activeFrame = (activeFrame + 1) % FRAME_COUNT;
-    memcpy(keyStates[activeFrame],
-           keyStates[Wrap(activeFrame - 1, FRAME_COUNT)],
-           KEY_MAX_STATES * sizeof(Input::KeyState));
+bool Input::Push(const InputEvent &event) {
+    if (ring.Push(event))
+        return true;
+    droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
-void Input::UpdateKey(unsigned int keyCode, bool keyState) {
-    keyStates[activeFrame][keyCode].isDown = keyState;
+bool Input::PushKey(int64_t ticks, unsigned int keyCode, bool isDown) {
+    if (keyCode >= KEY_MAX_STATES)
+        return false;
+    return Push({ticks, INPUT_EVENT_KEY, keyCode, 0, 0, isDown});
 }
 
-bool Input::KeyPressed(unsigned int key) {
-    return (keyStates[Wrap(activeFrame, FRAME_COUNT)][key].isDown &&
-            !keyStates[Wrap(activeFrame - FRAME_PREVIOUS, FRAME_COUNT)][key].isDown);
+bool Input::PushMouseMove(int64_t ticks, int32_t x, int32_t y) {
+    return Push({ticks, INPUT_EVENT_MOUSE_MOVE, 0, x, y, false});
 }
 
-bool Input::KeyDown(unsigned int key) {
-    return keyStates[Wrap(activeFrame, FRAME_COUNT)][key].isDown;
+bool Input::PushMouseWheel(int64_t ticks, int32_t delta) {
+    return Push({ticks, INPUT_EVENT_MOUSE_WHEEL, 0, 0, delta, false});
 }
 
-bool Input::KeyReleased(unsigned int key) {
-    return (!keyStates[Wrap(activeFrame, FRAME_COUNT)][key].isDown &&
-            keyStates[Wrap(activeFrame - FRAME_PREVIOUS, FRAME_COUNT)][key].isDown);
-}
\ No newline at end of file
+InputKeyState &Input::Touch(unsigned int key) {
+    InputKeyState &state = keys[key];
+    if (state.update != updateIndex) {
+        state.pressCount = 0;
+        state.releaseCount = 0;
+        state.update = updateIndex;
+        state.firstPressTicks = INPUT_NO_TICKS;
+        state.heldTicks = 0;
+    }
+    return state;
+}
+
+void Input::Update(int64_t untilTicks) {
+    // NOTE(pf): Edges of the previous update go stale with the index, only the keys that change are touched.
+    updateIndex++;
+    updateBegin = updateEnd;
+    updateEnd = untilTicks;
+    mouse.deltaX = 0;
+    mouse.deltaY = 0;
+    mouse.wheel = 0;
+    eventsApplied = 0;
+
+    while (const InputEvent *event = ring.Peek()) {
+        if (event->ticks > untilTicks)
+            break;
+
+        switch (event->type) {
+        case INPUT_EVENT_KEY: {
+            InputKeyState &key = Touch(event->keyCode);
+            if (key.isDown == event->isDown)
+                break;
+            // .. events queued before this update began count from its start ..
+            int64_t ticks = event->ticks > updateBegin ? event->ticks : updateBegin;
+            if (event->isDown) {
+                key.pressCount += key.pressCount < 0xFF;
+                if (key.firstPressTicks == INPUT_NO_TICKS)
+                    key.firstPressTicks = ticks;
+                key.downTicks = ticks;
+            } else {
+                key.releaseCount += key.releaseCount < 0xFF;
+                key.heldTicks += ticks - (key.downTicks > updateBegin ? key.downTicks : updateBegin);
+            }
+            key.isDown = event->isDown;
+        } break;
+        case INPUT_EVENT_MOUSE_MOVE: {
+            if (mouse.hasPosition) {
+                mouse.deltaX += event->x - mouse.x;
+                mouse.deltaY += event->y - mouse.y;
+            }
+            mouse.x = event->x;
+            mouse.y = event->y;
+            mouse.hasPosition = true;
+        } break;
+        case INPUT_EVENT_MOUSE_WHEEL: {
+            mouse.wheel += event->y;
+        } break;
+        }
+
+        ring.Pop();
+        eventsApplied++;
+    }
+}
+
+bool Input::KeyPressed(unsigned int key) const {
+    return Edged(key) && keys[key].pressCount > 0;
+}
+
+bool Input::KeyDown(unsigned int key) const {
+    return keys[key].isDown;
+}
+
+bool Input::KeyReleased(unsigned int key) const {
+    return Edged(key) && keys[key].releaseCount > 0;
+}
+
+int Input::KeyPressCount(unsigned int key) const {
+    return Edged(key) ? keys[key].pressCount : 0;
+}
+
+int64_t Input::KeyPressTicks(unsigned int key) const {
+    return Edged(key) ? keys[key].firstPressTicks : INPUT_NO_TICKS;
+}
+
+float Input::KeyHeldFraction(unsigned int key) const {
+    const InputKeyState &state = keys[key];
+    int64_t              window = updateEnd - updateBegin;
+    if (window <= 0)
+        return state.isDown ? 1.0f : 0.0f;
+    int64_t held = Edged(key) ? state.heldTicks : 0;
+    if (state.isDown)
+        held += updateEnd - (state.downTicks > updateBegin ? state.downTicks : updateBegin);
+    return Clamp((float)((double)held / window), 0.0f, 1.0f);
+}
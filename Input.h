@@ -1,12 +1,23 @@
 #ifndef _INPUT_H_
 #define _INPUT_H_
 
+/* Event driven input. The platform thread pushes timestamped key and mouse events into a lock-free single
+ * producer, single consumer ring, the simulation drains it one fixed step at a time.
+ *
+ * NOTE(pf): Edges are counted from the events themselves, a key tapped and let go between two steps is both
+ * pressed and released in the step that drains it. Update only takes the events stamped up to the end of the
+ * step, later ones wait in the ring for the next step, so a step sees input at the time it simulates and
+ * KeyHeldFraction tells how much of the step a key was down for.
+ */
+
 #include "Common.h"
+#include <atomic>
 
 // NOTE(PF): These are based on Windows VKeyCodes.
 enum KEY {
     KEY_M1 = 1,
     KEY_M2 = 2,
+    KEY_M3 = 4,
     KEY_ARROW_LEFT = 0x25,
     KEY_ARROW_UP = 0x26,
     KEY_ARROW_RIGHT = 0x27,
@@ -80,29 +91,90 @@ enum KEY {
     KEY_MAX_STATES = 0xFF
 };
 
-// SINGLETON
+static constexpr uint32_t INPUT_RING_CAPACITY = {1024}; // Power of two.
+static constexpr int64_t  INPUT_NO_TICKS = {-1};
+
+enum INPUT_EVENT {
+    INPUT_EVENT_KEY = 0,
+    INPUT_EVENT_MOUSE_MOVE = 1,
+    INPUT_EVENT_MOUSE_WHEEL = 2,
+};
+
+struct InputEvent {
+    int64_t  ticks; // HiResPerformanceQuery time the platform saw the event.
+    uint32_t type;
+    uint32_t keyCode; // Mouse buttons are keys, KEY_M1 to KEY_M3.
+    int32_t  x;       // Cursor position in client pixels.
+    int32_t  y;       // Or the wheel delta, 120 per notch.
+    bool     isDown;
+};
+
+// NOTE(pf): Push is only called from one thread and Peek/Pop from one other, head and tail live on their own
+// cache lines so the two sides only share a line when the ring is nearly empty.
+struct InputEventRing {
+    bool              Push(const InputEvent &event); // False when full.
+    const InputEvent *Peek();                        // Null when empty.
+    void              Pop();
+    uint32_t          Count() const;
+
+    alignas(64) std::atomic<uint32_t> head = {0}; // Written by the producer.
+    alignas(64) std::atomic<uint32_t> tail = {0}; // Written by the consumer.
+    alignas(64) InputEvent events[INPUT_RING_CAPACITY];
+};
+
+struct InputKeyState {
+    bool     isDown;
+    uint8_t  pressCount; // Edges within the last Update, saturating.
+    uint8_t  releaseCount;
+    uint32_t update;          // Update that last touched the edges, older edges are stale.
+    int64_t  firstPressTicks; // Of the last Update or INPUT_NO_TICKS.
+    int64_t  downTicks;       // Start of the current press.
+    int64_t  heldTicks;       // Held within the last Update, up to the last release.
+};
+
+struct InputMouseState {
+    int32_t x;
+    int32_t y;
+    int32_t deltaX; // Movement and wheel within the last Update.
+    int32_t deltaY;
+    int32_t wheel;
+    bool    hasPosition; // No delta until the first move.
+};
+
 struct Input {
+    // .. producer, the platform thread ..
+    // NOTE(pf): A full ring drops the new event, the consumer owns everything already queued. A dropped release
+    // leaves its key down until the next release, droppedEvents counts them.
+    bool PushKey(int64_t ticks, unsigned int keyCode, bool isDown);
+    bool PushMouseMove(int64_t ticks, int32_t x, int32_t y);
+    bool PushMouseWheel(int64_t ticks, int32_t delta);
 
-    enum FRAME {
-        FRAME_CURRENT = 0,
-        FRAME_PREVIOUS = 1,
-        FRAME_COUNT,
-    };
+    // .. consumer, the simulation thread ..
+    // NOTE(pf): Applies every queued event stamped at or before untilTicks, the queries below describe
+    // [previous untilTicks, untilTicks].
+    void Update(int64_t untilTicks);
 
-    struct KeyState {
-        bool isDown;
-    };
+    bool    KeyPressed(unsigned int key) const;
+    bool    KeyDown(unsigned int key) const;
+    bool    KeyReleased(unsigned int key) const;
+    int     KeyPressCount(unsigned int key) const;
+    int64_t KeyPressTicks(unsigned int key) const; // First press of the last Update or INPUT_NO_TICKS.
+    float   KeyHeldFraction(unsigned int key) const;
 
-    void Update();
-    void UpdateKey(unsigned int keyCode, bool keyState);
+    InputEventRing        ring;
+    std::atomic<uint32_t> droppedEvents = {0};
 
-    bool KeyPressed(unsigned int key);
-    bool KeyDown(unsigned int key);
-    bool KeyReleased(unsigned int key);
+    InputKeyState   keys[KEY_MAX_STATES] = {};
+    InputMouseState mouse = {};
+    uint32_t        updateIndex = {1};
+    int64_t         updateBegin = {0};
+    int64_t         updateEnd = {0};
+    uint32_t        eventsApplied = {0}; // By the last Update.
 
-    KeyState      keyStates[FRAME_COUNT][KEY_MAX_STATES];
-    int           activeFrame;
-    static Input *Instance;
+  private:
+    bool           Push(const InputEvent &event);
+    InputKeyState &Touch(unsigned int key);
+    bool           Edged(unsigned int key) const { return keys[key].update == updateIndex; }
 };
 
-#endif //!_INPUT_H_
\ No newline at end of file
+#endif //!_INPUT_H_
@@ -0,0 +1,213 @@
+/* Synthetic event streams through Input's ring, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread InputBenchmark.cpp Input.cpp Timer.cpp -o InputBenchmark
+ *
+ * A producer thread pushes a random stream of key, button, move and wheel events with made up timestamps while
+ * the consumer updates in fixed windows, the way the simulation thread drains the platform thread's events.
+ * Every window's edges, held fractions and mouse deltas are checked against the same stream applied on one
+ * thread, a few hand written streams check tap and sub-step timing. The exit code is 1 if anything differs.
+ */
+
+#include "Input.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t STREAM_EVENTS = {2000000};
+static constexpr int64_t  STEP_TICKS = {1000};
+static constexpr uint32_t STREAM_KEYS[] = {KEY_M1, KEY_M2, KEY_M3, KEY_W, KEY_A, KEY_S, KEY_D, KEY_SPACE};
+
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// NOTE(pf): Ticks advance by 0 to 99 per event, so a step of 1000 ticks drains around 20 events.
+static void BuildStream(std::vector<InputEvent> &stream) {
+    uint32_t state = 1;
+    int64_t  ticks = 0;
+    bool     isDown[KEY_MAX_STATES] = {};
+    stream.resize(STREAM_EVENTS);
+    for (InputEvent &event : stream) {
+        ticks += (int64_t)(NextRandom(state) * 100.0f);
+        float kind = NextRandom(state);
+        if (kind < 0.5f) {
+            uint32_t key = STREAM_KEYS[(uint32_t)(NextRandom(state) * 8.0f) & 7];
+            isDown[key] = !isDown[key];
+            event = {ticks, INPUT_EVENT_KEY, key, 0, 0, isDown[key]};
+        } else if (kind < 0.95f) {
+            event = {ticks, INPUT_EVENT_MOUSE_MOVE, 0, (int32_t)(NextRandom(state) * 1200.0f),
+                     (int32_t)(NextRandom(state) * 720.0f), false};
+        } else {
+            event = {ticks, INPUT_EVENT_MOUSE_WHEEL, 0, 0, NextRandom(state) < 0.5f ? -120 : 120, false};
+        }
+    }
+}
+
+struct WindowResult {
+    uint32_t hash;
+    uint32_t events;
+};
+
+// .. everything a step could look at, folded into one number per window ..
+static uint32_t HashWindow(const Input &input) {
+    uint32_t hash = 2166136261u;
+    auto     mix = [&hash](uint32_t value) { hash = (hash ^ value) * 16777619u; };
+    for (uint32_t key : STREAM_KEYS) {
+        mix(input.KeyDown(key));
+        mix(input.KeyPressCount(key));
+        mix(input.KeyReleased(key));
+        mix((uint32_t)input.KeyPressTicks(key));
+        mix((uint32_t)(input.KeyHeldFraction(key) * 1e6f));
+    }
+    mix(input.mouse.x), mix(input.mouse.y);
+    mix(input.mouse.deltaX), mix(input.mouse.deltaY);
+    mix(input.mouse.wheel);
+    return hash;
+}
+
+static void PushEvent(Input &input, const InputEvent &event) {
+    if (event.type == INPUT_EVENT_KEY)
+        input.PushKey(event.ticks, event.keyCode, event.isDown);
+    else if (event.type == INPUT_EVENT_MOUSE_MOVE)
+        input.PushMouseMove(event.ticks, event.x, event.y);
+    else
+        input.PushMouseWheel(event.ticks, event.y);
+}
+
+// NOTE(pf): The reference pushes a window's worth at a time, the ring never fills.
+static void RunSerial(const std::vector<InputEvent> &stream, std::vector<WindowResult> &results) {
+    Input *input = new Input();
+    size_t next = 0;
+    for (int64_t until = STEP_TICKS; next < stream.size(); until += STEP_TICKS) {
+        while (next < stream.size() && stream[next].ticks <= until)
+            PushEvent(*input, stream[next++]);
+        input->Update(until);
+        results.push_back({HashWindow(*input), input->eventsApplied});
+    }
+    delete input;
+}
+
+// NOTE(pf): The producer publishes how far its timestamps got, the consumer only updates windows that are
+// complete so both sides see the same events per window no matter how the threads interleave.
+static void RunThreaded(const std::vector<InputEvent> &stream, std::vector<WindowResult> &results,
+                        uint32_t &ringFullRetries) {
+    Input               *input = new Input();
+    std::atomic<int64_t> pushedTicks = {-1};
+    std::thread          producer([&]() {
+        uint32_t retries = 0;
+        for (size_t i = 0; i < stream.size(); ++i) {
+            // .. a full ring drops the event, the stream retries instead so the checks stay exact ..
+            while (input->ring.Count() == INPUT_RING_CAPACITY) {
+                retries++;
+                std::this_thread::yield();
+            }
+            PushEvent(*input, stream[i]);
+            if (i + 1 == stream.size() || stream[i + 1].ticks != stream[i].ticks)
+                pushedTicks.store(stream[i].ticks, std::memory_order_release);
+        }
+        pushedTicks.store(INT64_MAX, std::memory_order_release);
+        ringFullRetries = retries;
+    });
+
+    int64_t lastTicks = stream.back().ticks;
+    for (int64_t until = STEP_TICKS; until - STEP_TICKS < lastTicks; until += STEP_TICKS) {
+        while (pushedTicks.load(std::memory_order_acquire) < until)
+            std::this_thread::yield();
+        input->Update(until);
+        results.push_back({HashWindow(*input), input->eventsApplied});
+    }
+    producer.join();
+    delete input;
+}
+
+static uint32_t CheckTaps() {
+    uint32_t failures = 0;
+    Input   *input = new Input();
+
+    // .. down and up between two updates is a press and a release, the old frame diff saw neither ..
+    input->Update(1000);
+    input->PushKey(1200, KEY_SPACE, true);
+    input->PushKey(1450, KEY_SPACE, false);
+    input->Update(2000);
+    failures += !input->KeyPressed(KEY_SPACE) || !input->KeyReleased(KEY_SPACE) || input->KeyDown(KEY_SPACE);
+    failures += input->KeyPressTicks(KEY_SPACE) != 1200;
+    failures += fabsf(input->KeyHeldFraction(KEY_SPACE) - 0.25f) > 1e-6f;
+    input->Update(3000);
+    failures += input->KeyPressed(KEY_SPACE) || input->KeyReleased(KEY_SPACE);
+
+    // .. an event past the step stays queued for the next one ..
+    input->PushKey(3500, KEY_W, true);
+    input->PushKey(4100, KEY_W, false);
+    input->Update(4000);
+    failures += !input->KeyPressed(KEY_W) || !input->KeyDown(KEY_W) || input->KeyReleased(KEY_W);
+    failures += fabsf(input->KeyHeldFraction(KEY_W) - 0.5f) > 1e-6f;
+    input->Update(5000);
+    failures += input->KeyPressed(KEY_W) || !input->KeyReleased(KEY_W);
+    failures += fabsf(input->KeyHeldFraction(KEY_W) - 0.1f) > 1e-6f;
+
+    // .. a key held across updates is down for all of them without further edges ..
+    input->PushKey(5000, KEY_M1, true);
+    input->Update(6000);
+    input->Update(7000);
+    failures += input->KeyPressed(KEY_M1) || !input->KeyDown(KEY_M1) || input->KeyHeldFraction(KEY_M1) != 1.0f;
+
+    // .. repeats and out of range codes are ignored, mouse deltas start at the first move ..
+    input->PushKey(7100, KEY_M1, true);
+    failures += input->PushKey(7200, KEY_MAX_STATES, true);
+    input->PushMouseMove(7300, 100, 100);
+    input->PushMouseMove(7400, 110, 95);
+    input->PushMouseWheel(7500, -120);
+    input->Update(8000);
+    failures += input->KeyPressed(KEY_M1) || input->mouse.deltaX != 10 || input->mouse.deltaY != -5;
+    failures += input->mouse.wheel != -120 || input->eventsApplied != 4;
+
+    // .. a full ring drops the newest events and counts them ..
+    for (uint32_t i = 0; i < INPUT_RING_CAPACITY + 3; ++i)
+        input->PushMouseWheel(8100, 120);
+    input->Update(9000);
+    failures += input->droppedEvents.load() != 3 || input->mouse.wheel != (int32_t)INPUT_RING_CAPACITY * 120;
+
+    delete input;
+    return failures;
+}
+
+int main() {
+    std::vector<InputEvent> stream;
+    BuildStream(stream);
+
+    std::vector<WindowResult> serial, threaded;
+    serial.reserve(stream.back().ticks / STEP_TICKS + 1);
+    threaded.reserve(serial.capacity());
+    uint32_t ringFullRetries = 0;
+
+    int64_t start = HiResPerformanceQuery();
+    RunSerial(stream, serial);
+    double serialMs = HiResMilliseconds(HiResPerformanceQuery() - start);
+    start = HiResPerformanceQuery();
+    RunThreaded(stream, threaded, ringFullRetries);
+    double threadedMs = HiResMilliseconds(HiResPerformanceQuery() - start);
+
+    uint32_t mismatches = serial.size() != threaded.size();
+    uint32_t applied = 0;
+    for (size_t i = 0; i < serial.size() && i < threaded.size(); ++i) {
+        mismatches += serial[i].hash != threaded[i].hash || serial[i].events != threaded[i].events;
+        applied += serial[i].events;
+    }
+    mismatches += applied != STREAM_EVENTS;
+    uint32_t tapFailures = CheckTaps();
+
+    printf("{\"benchmark\": \"input\", \"events\": %u, \"windows\": %zu, \"serial_ns_per_event\": %.2f, "
+           "\"threaded_ns_per_event\": %.2f, \"ring_full_retries\": %u, \"window_mismatches\": %u, "
+           "\"tap_failures\": %u}\n",
+           STREAM_EVENTS, serial.size(), serialMs * 1e6 / STREAM_EVENTS, threadedMs * 1e6 / STREAM_EVENTS,
+           ringFullRetries, mismatches, tapFailures);
+
+    if (mismatches || tapFailures) {
+        fprintf(stderr, "%u windows differ from the single threaded stream, %u tap checks failed\n", mismatches,
+                tapFailures);
+        return 1;
+    }
+    return 0;
+}
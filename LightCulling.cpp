@@ -0,0 +1,297 @@
+#include "LightCulling.h"
+#include "Profiler.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(SIMD_SSE2) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+void LightTileGrid::Initialize(uint32_t _width, uint32_t _height) {
+    width = _width;
+    height = _height;
+    tilesX = (width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+    tilesY = (height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+
+    size_t tileCount = (size_t)tilesX * tilesY;
+    minDepth.assign(tileCount, 0.0f);
+    maxDepth.assign(tileCount, FLT_MAX);
+    lists.assign(tileCount * LIGHT_TILE_STRIDE, 0);
+    leftPlanes.resize(tilesX * 2);
+    rightPlanes.resize(tilesX * 2);
+    topPlanes.resize(tilesY * 2);
+    bottomPlanes.resize(tilesY * 2);
+    rowOverflows.resize(tilesY);
+    lightTilePairs = 0;
+    overflowedTiles = 0;
+}
+
+void LightTileGrid::SetDepthBounds(const DepthPyramid &pyramid) {
+    // NOTE(pf): Texel (x, y) of level 4 covers exactly the pixels of tile (x, y). Without a matching level the
+    // tiles are unbounded in depth, which is still correct.
+    const DepthPyramidLevel &level = pyramid.layout.levels[LIGHT_TILE_LEVEL];
+    bool hasLevel = pyramid.layout.levelCount > LIGHT_TILE_LEVEL && level.width == tilesX && level.height == tilesY;
+    for (uint32_t y = 0; y < tilesY; ++y) {
+        for (uint32_t x = 0; x < tilesX; ++x) {
+            size_t tile = (size_t)y * tilesX + x;
+            minDepth[tile] = hasLevel ? pyramid.MinDepth(LIGHT_TILE_LEVEL, x, y) : 0.0f;
+            maxDepth[tile] = hasLevel ? pyramid.MaxDepth(LIGHT_TILE_LEVEL, x, y) : FLT_MAX;
+        }
+    }
+}
+
+static void NormalizeSidePlane(float a, float b, float *plane) {
+    float invLength = 1.0f / sqrtf(a * a + b * b);
+    plane[0] = a * invLength;
+    plane[1] = b * invLength;
+}
+
+// NOTE(pf): The side planes go through the eye, so they only need two coefficients: x * proj00 / z >= ndcX
+// is proj00 * x - ndcX * z >= 0, and likewise for y with ndc y pointing up.
+static void BuildTilePlanes(LightTileGrid &grid, float proj00, float proj11) {
+    for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+        uint32_t x0 = tx * LIGHT_TILE_SIZE;
+        uint32_t x1 = x0 + LIGHT_TILE_SIZE < grid.width ? x0 + LIGHT_TILE_SIZE : grid.width;
+        float    ndcX0 = 2.0f * x0 / grid.width - 1.0f;
+        float    ndcX1 = 2.0f * x1 / grid.width - 1.0f;
+        NormalizeSidePlane(proj00, -ndcX0, &grid.leftPlanes[tx * 2]);
+        NormalizeSidePlane(-proj00, ndcX1, &grid.rightPlanes[tx * 2]);
+    }
+    for (uint32_t ty = 0; ty < grid.tilesY; ++ty) {
+        uint32_t y0 = ty * LIGHT_TILE_SIZE;
+        uint32_t y1 = y0 + LIGHT_TILE_SIZE < grid.height ? y0 + LIGHT_TILE_SIZE : grid.height;
+        float    ndcY0 = 1.0f - 2.0f * y0 / grid.height;
+        float    ndcY1 = 1.0f - 2.0f * y1 / grid.height;
+        NormalizeSidePlane(-proj11, ndcY0, &grid.topPlanes[ty * 2]);
+        NormalizeSidePlane(proj11, -ndcY1, &grid.bottomPlanes[ty * 2]);
+    }
+}
+
+// NOTE(pf): The SIMD paths below do the same products and sums in the same order, so they agree bit for bit.
+static bool SphereInSlab(const float *lower, const float *upper, float u, float z, float radius) {
+    return lower[0] * u + lower[1] * z >= -radius && upper[0] * u + upper[1] * z >= -radius;
+}
+
+static bool SphereInDepthRange(float z, float radius, float minZ, float maxZ) {
+    return z + radius >= minZ && z - radius <= maxZ;
+}
+
+static void AppendLight(uint32_t *list, uint32_t &count, uint32_t light) {
+    if (count < LIGHT_TILE_MAX_LIGHTS)
+        list[1 + count] = light;
+    count++;
+}
+
+// .. stores the count, returns whether lights were dropped ..
+static bool FinishTile(uint32_t *list, uint32_t count) {
+    list[0] = count < LIGHT_TILE_MAX_LIGHTS ? count : LIGHT_TILE_MAX_LIGHTS;
+    return count > LIGHT_TILE_MAX_LIGHTS;
+}
+
+static void TallyLists(LightTileGrid &grid) {
+    grid.lightTilePairs = 0;
+    grid.overflowedTiles = 0;
+    for (size_t tile = 0; tile < (size_t)grid.tilesX * grid.tilesY; ++tile)
+        grid.lightTilePairs += grid.lists[tile * LIGHT_TILE_STRIDE];
+    for (uint32_t ty = 0; ty < grid.tilesY; ++ty)
+        grid.overflowedTiles += grid.rowOverflows[ty];
+}
+
+static void CullRow(LightTileGrid &grid, const CullSphereSoA &lights, uint32_t ty) {
+    size_t       count = lights.Count();
+    const float *x = lights.x.data();
+    const float *y = lights.y.data();
+    const float *z = lights.z.data();
+    const float *radius = lights.radius.data();
+    uint32_t    *rowLights = &grid.rowLights[ty * count];
+    float       *rowX = &grid.rowX[ty * count];
+    float       *rowZ = &grid.rowZ[ty * count];
+    float       *rowRadius = &grid.rowRadius[ty * count];
+    const float *top = &grid.topPlanes[ty * 2];
+    const float *bottom = &grid.bottomPlanes[ty * 2];
+
+    const float *tileMin = &grid.minDepth[(size_t)ty * grid.tilesX];
+    const float *tileMax = &grid.maxDepth[(size_t)ty * grid.tilesX];
+    float        rowMin = FLT_MAX, rowMax = -FLT_MAX;
+    for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+        rowMin = Min(rowMin, tileMin[tx]);
+        rowMax = Max(rowMax, tileMax[tx]);
+    }
+
+    // .. the row's slab and depth range, survivors compacted branchlessly like CullSpheres ..
+    size_t survivors = 0;
+    size_t i = 0;
+#if defined(SIMD_AVX2)
+    {
+        __m256 topA = _mm256_set1_ps(top[0]), topB = _mm256_set1_ps(top[1]);
+        __m256 bottomA = _mm256_set1_ps(bottom[0]), bottomB = _mm256_set1_ps(bottom[1]);
+        __m256 minZ = _mm256_set1_ps(rowMin), maxZ = _mm256_set1_ps(rowMax);
+        for (; i + 8 <= count; i += 8) {
+            __m256 ly = _mm256_loadu_ps(y + i);
+            __m256 lz = _mm256_loadu_ps(z + i);
+            __m256 r = _mm256_loadu_ps(radius + i);
+            __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), r);
+            __m256 inside = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(topA, ly), _mm256_mul_ps(topB, lz)), negR, _CMP_GE_OQ);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(bottomA, ly), _mm256_mul_ps(bottomB, lz)),
+                                                         negR, _CMP_GE_OQ));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(lz, r), minZ, _CMP_GE_OQ));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_sub_ps(lz, r), maxZ, _CMP_LE_OQ));
+            int mask = _mm256_movemask_ps(inside);
+            for (int k = 0; k < 8; ++k) {
+                rowLights[survivors] = (uint32_t)(i + k);
+                rowX[survivors] = x[i + k];
+                rowZ[survivors] = z[i + k];
+                rowRadius[survivors] = radius[i + k];
+                survivors += (mask >> k) & 1;
+            }
+        }
+    }
+#endif
+#if defined(SIMD_SSE2)
+    {
+        __m128 topA = _mm_set1_ps(top[0]), topB = _mm_set1_ps(top[1]);
+        __m128 bottomA = _mm_set1_ps(bottom[0]), bottomB = _mm_set1_ps(bottom[1]);
+        __m128 minZ = _mm_set1_ps(rowMin), maxZ = _mm_set1_ps(rowMax);
+        for (; i + 4 <= count; i += 4) {
+            __m128 ly = _mm_loadu_ps(y + i);
+            __m128 lz = _mm_loadu_ps(z + i);
+            __m128 r = _mm_loadu_ps(radius + i);
+            __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(topA, ly), _mm_mul_ps(topB, lz)), negR);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(bottomA, ly), _mm_mul_ps(bottomB, lz)), negR));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(lz, r), minZ));
+            inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_sub_ps(lz, r), maxZ));
+            int mask = _mm_movemask_ps(inside);
+            for (int k = 0; k < 4; ++k) {
+                rowLights[survivors] = (uint32_t)(i + k);
+                rowX[survivors] = x[i + k];
+                rowZ[survivors] = z[i + k];
+                rowRadius[survivors] = radius[i + k];
+                survivors += (mask >> k) & 1;
+            }
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        rowLights[survivors] = (uint32_t)i;
+        rowX[survivors] = x[i];
+        rowZ[survivors] = z[i];
+        rowRadius[survivors] = radius[i];
+        survivors += SphereInSlab(top, bottom, y[i], z[i], radius[i]) && SphereInDepthRange(z[i], radius[i], rowMin, rowMax);
+    }
+
+    // .. every tile of the row against the survivors, few lanes pass so appending branches on the mask ..
+    uint32_t overflows = 0;
+    for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+        uint32_t    *list = &grid.lists[((size_t)ty * grid.tilesX + tx) * LIGHT_TILE_STRIDE];
+        uint32_t     tileCount = 0;
+        const float *left = &grid.leftPlanes[tx * 2];
+        const float *right = &grid.rightPlanes[tx * 2];
+        size_t       j = 0;
+#if defined(SIMD_AVX2)
+        {
+            __m256 leftA = _mm256_set1_ps(left[0]), leftB = _mm256_set1_ps(left[1]);
+            __m256 rightA = _mm256_set1_ps(right[0]), rightB = _mm256_set1_ps(right[1]);
+            __m256 minZ = _mm256_set1_ps(tileMin[tx]), maxZ = _mm256_set1_ps(tileMax[tx]);
+            for (; j + 8 <= survivors; j += 8) {
+                __m256 lx = _mm256_loadu_ps(rowX + j);
+                __m256 lz = _mm256_loadu_ps(rowZ + j);
+                __m256 r = _mm256_loadu_ps(rowRadius + j);
+                __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), r);
+                __m256 inside = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(leftA, lx), _mm256_mul_ps(leftB, lz)), negR, _CMP_GE_OQ);
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(rightA, lx), _mm256_mul_ps(rightB, lz)),
+                                                             negR, _CMP_GE_OQ));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(lz, r), minZ, _CMP_GE_OQ));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_sub_ps(lz, r), maxZ, _CMP_LE_OQ));
+                int mask = _mm256_movemask_ps(inside);
+                if (mask == 0)
+                    continue;
+                for (int k = 0; k < 8; ++k) {
+                    if ((mask >> k) & 1)
+                        AppendLight(list, tileCount, rowLights[j + k]);
+                }
+            }
+        }
+#endif
+#if defined(SIMD_SSE2)
+        {
+            __m128 leftA = _mm_set1_ps(left[0]), leftB = _mm_set1_ps(left[1]);
+            __m128 rightA = _mm_set1_ps(right[0]), rightB = _mm_set1_ps(right[1]);
+            __m128 minZ = _mm_set1_ps(tileMin[tx]), maxZ = _mm_set1_ps(tileMax[tx]);
+            for (; j + 4 <= survivors; j += 4) {
+                __m128 lx = _mm_loadu_ps(rowX + j);
+                __m128 lz = _mm_loadu_ps(rowZ + j);
+                __m128 r = _mm_loadu_ps(rowRadius + j);
+                __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(leftA, lx), _mm_mul_ps(leftB, lz)), negR);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(rightA, lx), _mm_mul_ps(rightB, lz)), negR));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(lz, r), minZ));
+                inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_sub_ps(lz, r), maxZ));
+                int mask = _mm_movemask_ps(inside);
+                if (mask == 0)
+                    continue;
+                for (int k = 0; k < 4; ++k) {
+                    if ((mask >> k) & 1)
+                        AppendLight(list, tileCount, rowLights[j + k]);
+                }
+            }
+        }
+#endif
+        for (; j < survivors; ++j) {
+            if (SphereInSlab(left, right, rowX[j], rowZ[j], rowRadius[j]) &&
+                SphereInDepthRange(rowZ[j], rowRadius[j], tileMin[tx], tileMax[tx]))
+                AppendLight(list, tileCount, rowLights[j]);
+        }
+        overflows += FinishTile(list, tileCount);
+    }
+    grid.rowOverflows[ty] = overflows;
+}
+
+void CullLightsTiled(LightTileGrid &grid, const CullSphereSoA &lights, float proj00, float proj11, TaskPool *pool) {
+    PROFILE_FUNCTION();
+    BuildTilePlanes(grid, proj00, proj11);
+
+    size_t scratchSize = (size_t)grid.tilesY * lights.Count();
+    if (grid.rowLights.size() < scratchSize) {
+        grid.rowLights.resize(scratchSize);
+        grid.rowX.resize(scratchSize);
+        grid.rowZ.resize(scratchSize);
+        grid.rowRadius.resize(scratchSize);
+    }
+
+    auto cullRows = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t ty = begin; ty < end; ++ty)
+            CullRow(grid, lights, ty);
+    };
+    if (pool)
+        pool->ParallelFor(grid.tilesY, 1, cullRows);
+    else
+        cullRows(0, grid.tilesY);
+    TallyLists(grid);
+}
+
+void CullLightsTiledScalar(LightTileGrid &grid, const CullSphereSoA &lights, float proj00, float proj11) {
+    BuildTilePlanes(grid, proj00, proj11);
+
+    for (uint32_t ty = 0; ty < grid.tilesY; ++ty) {
+        const float *top = &grid.topPlanes[ty * 2];
+        const float *bottom = &grid.bottomPlanes[ty * 2];
+        uint32_t     overflows = 0;
+        for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+            size_t       tile = (size_t)ty * grid.tilesX + tx;
+            uint32_t    *list = &grid.lists[tile * LIGHT_TILE_STRIDE];
+            uint32_t     tileCount = 0;
+            const float *left = &grid.leftPlanes[tx * 2];
+            const float *right = &grid.rightPlanes[tx * 2];
+            for (size_t i = 0; i < lights.Count(); ++i) {
+                float x = lights.x[i], y = lights.y[i], z = lights.z[i], radius = lights.radius[i];
+                if (SphereInSlab(top, bottom, y, z, radius) && SphereInSlab(left, right, x, z, radius) &&
+                    SphereInDepthRange(z, radius, grid.minDepth[tile], grid.maxDepth[tile]))
+                    AppendLight(list, tileCount, (uint32_t)i);
+            }
+            overflows += FinishTile(list, tileCount);
+        }
+        grid.rowOverflows[ty] = overflows;
+    }
+    TallyLists(grid);
+}
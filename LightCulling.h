@@ -0,0 +1,75 @@
+#ifndef _LIGHT_CULLING_H_
+#define _LIGHT_CULLING_H_
+
+/* Tiled light culling for forward+ shading, the CPU reference of shaders/LightCullCS.hlsl.
+ *
+ * The rendered part of the targets is split into 16x16 pixel tiles. A tile is the frustum through the eye and
+ * its four edges, cut by the nearest and farthest view depth of its pixels: exactly the texel of DepthPyramid
+ * level 4 that covers it. A point light goes into the tile's list when its sphere is not completely outside
+ * any of those six planes, the forward pass then only loops over the list of its pixel's tile.
+ *
+ * NOTE(pf): Spheres against planes are conservative. A sphere just off a corner of the frustum is inside all
+ * six planes, and a tile on a silhouette spans from the foreground to the background, keeping every light in
+ * between. Both only cost shading time, a light that reaches a pixel is never dropped.
+ *
+ * CullLightsTiled tests every light against a whole row of tiles first, the row's top and bottom planes and
+ * its depth range, and compacts the survivors into SoA arrays. Each tile of the row then only tests those
+ * against its left and right planes and its own depth range, 8 or 4 lights at a time. Rows are independent
+ * and spread over the TaskPool. CullLightsTiledScalar tests every light against every tile, the lists of both
+ * have to be identical, indices in increasing order.
+ */
+
+#include "Culling.h"
+#include "DepthPyramid.h"
+#include "TaskPool.h"
+#include <vector>
+
+static constexpr uint32_t LIGHT_TILE_LEVEL = {4}; // DepthPyramid level whose texels are the tiles.
+static constexpr uint32_t LIGHT_TILE_SIZE = {1 << LIGHT_TILE_LEVEL};
+static constexpr uint32_t LIGHT_TILE_MAX_LIGHTS = {255};
+static constexpr uint32_t LIGHT_TILE_STRIDE = {LIGHT_TILE_MAX_LIGHTS + 1}; // Count followed by the indices.
+static constexpr uint32_t LIGHT_CULL_MAX_LIGHTS = {16384};                  // Capacity of DX12's light buffer.
+
+// NOTE(pf): StructuredBuffer<PointLight> in shaders/Lighting.hlsl, positions in view space for the culling
+// and shading passes. The light falls off to zero at radius, which is the sphere that is culled.
+struct PointLight {
+    float position[3];
+    float radius;
+    float color[3];
+    float intensity;
+};
+
+struct LightTileGrid {
+    // NOTE(pf): width x height is the rendered part, the tiles on the right and bottom edges may be partial.
+    void Initialize(uint32_t width, uint32_t height);
+    void SetDepthBounds(const DepthPyramid &pyramid);
+
+    uint32_t        LightCount(uint32_t x, uint32_t y) const { return lists[((size_t)y * tilesX + x) * LIGHT_TILE_STRIDE]; }
+    const uint32_t *Lights(uint32_t x, uint32_t y) const { return &lists[((size_t)y * tilesX + x) * LIGHT_TILE_STRIDE + 1]; }
+
+    uint32_t              width = 0, height = 0;
+    uint32_t              tilesX = 0, tilesY = 0;
+    std::vector<float>    minDepth; // View depth bounds per tile, row major.
+    std::vector<float>    maxDepth;
+    std::vector<uint32_t> lists; // LIGHT_TILE_STRIDE values per tile, LightCullCS writes the same layout.
+
+    // .. totals of the last cull, lights past LIGHT_TILE_MAX_LIGHTS are dropped and counted in overflowedTiles ..
+    uint64_t lightTilePairs = 0;
+    uint32_t overflowedTiles = 0;
+
+    // .. per column and row the normalized (a, b) of the side planes a * x + b * z or a * y + b * z ..
+    std::vector<float> leftPlanes, rightPlanes;
+    std::vector<float> topPlanes, bottomPlanes;
+
+    // .. scratch of CullLightsTiled, every row compacts its survivors into its own lightCount slice ..
+    std::vector<uint32_t> rowLights;
+    std::vector<float>    rowX, rowZ, rowRadius;
+    std::vector<uint32_t> rowOverflows;
+};
+
+// NOTE(pf): lights are view space spheres, proj00 and proj11 the projection's x and y scale. Depth bounds
+// must have been set for the current frame.
+void CullLightsTiled(LightTileGrid &grid, const CullSphereSoA &lights, float proj00, float proj11, TaskPool *pool);
+void CullLightsTiledScalar(LightTileGrid &grid, const CullSphereSoA &lights, float proj00, float proj11);
+
+#endif //!_LIGHT_CULLING_H_
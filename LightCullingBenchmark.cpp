@@ -0,0 +1,181 @@
+/* Checks and times the tiled light culling of LightCulling.h, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread -ffp-contract=off LightCullingBenchmark.cpp LightCulling.cpp DepthPyramid.cpp
+ *       SoftwareRenderer.cpp MeshData.cpp Culling.cpp TaskPool.cpp Platform_Posix.cpp Profiler.cpp Mat4.cpp Timer.cpp
+ *       -o LightCullingBenchmark
+ *   ./LightCullingBenchmark [--model models/skull.txt]
+ *
+ * The skull scene of Benchmark is rasterized at 720p and its depth pyramid gives the tiles' depth bounds, then
+ * 1k to 10k point lights scattered around it are culled by the scalar reference, the SIMD path on one thread
+ * and the SIMD path on the TaskPool. The lists of all three have to be identical, and one pixel per tile is
+ * checked against every light: a light whose sphere contains the pixel's view position has to be in the list
+ * of its tile unless the tile overflowed. The exit code is 1 if either check fails.
+ */
+
+#include "DepthPyramid.h"
+#include "LightCulling.h"
+#include "Mat4.h"
+#include "MeshData.h"
+#include "SoftwareRenderer.h"
+#include "TaskPool.h"
+#include "Timer.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t LIGHT_COUNTS[] = {1024, 4096, 10240};
+static constexpr uint32_t CULL_ITERATIONS = {20};
+static constexpr uint32_t SCALAR_ITERATIONS = {2};
+static constexpr float    LIGHT_AREA_HALF_SIZE = {30.0f}; // Lights are spread over a box around the skull..
+static constexpr float    LIGHT_AREA_HALF_HEIGHT = {10.0f};
+static constexpr float    LIGHT_MIN_RADIUS = {0.5f}; // .. with a radius in [min, max).
+static constexpr float    LIGHT_MAX_RADIUS = {3.0f};
+
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+static void BuildScene(double time, uint32_t width, uint32_t height, Mat4 &world, Mat4 &view, Mat4 &proj) {
+    float angle = ConvertToRadians(fmodf((float)(time * 90.0), 360.0f));
+    world = Mat4RotationAxis(0.0f, 1.0f, 1.0f, angle);
+
+    const float eye[3] = {0.0f, 5.0f, -25.0f};
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    view = Mat4LookAtLH(eye, focus, up);
+    proj = Mat4PerspectiveFovLH(ConvertToRadians(45.0f), width / (float)height, 1.0f, 1000.0f);
+}
+
+// .. world space lights in view space, like DX12 uploads them ..
+static void BuildLights(uint32_t count, uint32_t seed, const Mat4 &view, CullSphereSoA &lights) {
+    lights.Resize(count);
+    uint32_t state = seed;
+    for (uint32_t i = 0; i < count; ++i) {
+        lights.x[i] = (2.0f * NextRandom(state) - 1.0f) * LIGHT_AREA_HALF_SIZE;
+        lights.y[i] = (2.0f * NextRandom(state) - 1.0f) * LIGHT_AREA_HALF_HEIGHT;
+        lights.z[i] = (2.0f * NextRandom(state) - 1.0f) * LIGHT_AREA_HALF_SIZE;
+        lights.radius[i] = LIGHT_MIN_RADIUS + (LIGHT_MAX_RADIUS - LIGHT_MIN_RADIUS) * NextRandom(state);
+    }
+    TransformPointsSoA(view, lights.x.data(), lights.y.data(), lights.z.data(), count, lights.x.data(), lights.y.data(),
+                       lights.z.data());
+}
+
+// NOTE(pf): One pixel per tile, at an offset that changes from tile to tile so the edges are covered too.
+static uint32_t CountMissedLights(const LightTileGrid &grid, const CullSphereSoA &lights, const float *ndcDepth,
+                                  const Mat4 &proj, uint32_t &checked) {
+    uint32_t missed = 0;
+    checked = 0;
+    for (uint32_t ty = 0; ty < grid.tilesY; ++ty) {
+        for (uint32_t tx = 0; tx < grid.tilesX; ++tx) {
+            uint32_t px = tx * LIGHT_TILE_SIZE + (ty * 7 + tx * 3) % LIGHT_TILE_SIZE;
+            uint32_t py = ty * LIGHT_TILE_SIZE + (tx * 5 + ty * 11) % LIGHT_TILE_SIZE;
+            px = px < grid.width ? px : grid.width - 1;
+            py = py < grid.height ? py : grid.height - 1;
+
+            float ndcX = 2.0f * (px + 0.5f) / grid.width - 1.0f;
+            float ndcY = 1.0f - 2.0f * (py + 0.5f) / grid.height;
+            float z = proj.m[14] / (ndcDepth[(size_t)py * grid.width + px] - proj.m[10]);
+            float p[3] = {ndcX * z / proj.m[0], ndcY * z / proj.m[5], z};
+
+            uint32_t        count = grid.LightCount(tx, ty);
+            const uint32_t *list = grid.Lights(tx, ty);
+            if (count == LIGHT_TILE_MAX_LIGHTS)
+                continue; // Possibly overflowed, what was dropped is not known.
+            for (uint32_t i = 0; i < lights.Count(); ++i) {
+                float dx = p[0] - lights.x[i], dy = p[1] - lights.y[i], dz = p[2] - lights.z[i];
+                if (dx * dx + dy * dy + dz * dz < lights.radius[i] * lights.radius[i]) {
+                    checked++;
+                    missed += !std::binary_search(list, list + count, i);
+                }
+            }
+        }
+    }
+    return missed;
+}
+
+template <typename F> static double MeasureMs(uint32_t iterations, F run) {
+    int64_t start = HiResPerformanceQuery();
+    for (uint32_t i = 0; i < iterations; ++i)
+        run();
+    return HiResMilliseconds(HiResPerformanceQuery() - start) / iterations;
+}
+
+int main(int argc, char **argv) {
+    const char *modelPath = "models/skull.txt";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+    }
+
+    const uint32_t width = 1280, height = 720;
+    Mat4           world, view, proj;
+    BuildScene(0.0, width, height, world, view, proj);
+
+    SoftwareRenderer renderer;
+    renderer.Initialize(width, height);
+    renderer.BeginFrame();
+    MeshData mesh;
+    if (LoadTextMesh(modelPath, mesh))
+        renderer.DrawMeshInstances(mesh, &world, 1, view, proj);
+    else
+        fprintf(stderr, "Failed to load %s, culling against the cleared depth buffer\n", modelPath);
+
+    DepthPyramid pyramid;
+    pyramid.Initialize(width, height);
+    pyramid.Build(renderer.depth.data(), proj.m[10], proj.m[14]);
+
+    TaskPool pool;
+    pool.Initialize();
+
+    LightTileGrid reference, simd, unbounded;
+    reference.Initialize(width, height);
+    simd.Initialize(width, height);
+    unbounded.Initialize(width, height);
+    reference.SetDepthBounds(pyramid);
+    simd.SetDepthBounds(pyramid);
+
+    uint32_t failures = 0;
+    printf("{\"benchmark\": \"light_culling\", \"width\": %u, \"height\": %u, \"tiles\": [%u, %u], \"threads\": %u, "
+           "\"runs\": [",
+           width, height, simd.tilesX, simd.tilesY, pool.ThreadCount());
+    for (size_t c = 0; c < sizeof(LIGHT_COUNTS) / sizeof(LIGHT_COUNTS[0]); ++c) {
+        CullSphereSoA lights;
+        BuildLights(LIGHT_COUNTS[c], 1 + (uint32_t)c, view, lights);
+        float proj00 = proj.m[0], proj11 = proj.m[5];
+
+        double scalarMs = MeasureMs(SCALAR_ITERATIONS, [&]() { CullLightsTiledScalar(reference, lights, proj00, proj11); });
+        double simdMs = MeasureMs(CULL_ITERATIONS, [&]() { CullLightsTiled(simd, lights, proj00, proj11, nullptr); });
+        bool   identical = simd.lists == reference.lists;
+        double threadedMs = MeasureMs(CULL_ITERATIONS, [&]() { CullLightsTiled(simd, lights, proj00, proj11, &pool); });
+        identical = identical && simd.lists == reference.lists && simd.overflowedTiles == reference.overflowedTiles;
+        uint32_t checked = 0;
+        uint32_t missed = CountMissedLights(simd, lights, renderer.depth.data(), proj, checked);
+        failures += !identical + (missed > 0);
+
+        // .. what the depth bounds save, the same lights against tiles that span all depths ..
+        CullLightsTiled(unbounded, lights, proj00, proj11, &pool);
+
+        uint32_t maxLights = 0;
+        for (uint32_t ty = 0; ty < simd.tilesY; ++ty) {
+            for (uint32_t tx = 0; tx < simd.tilesX; ++tx)
+                maxLights = simd.LightCount(tx, ty) > maxLights ? simd.LightCount(tx, ty) : maxLights;
+        }
+        double tileCount = (double)simd.tilesX * simd.tilesY;
+        printf("%s\n  {\"lights\": %u, \"scalar_ms\": %.3f, \"simd_ms\": %.3f, \"simd_threaded_ms\": %.3f, "
+               "\"mean_lights_per_tile\": %.2f, \"max_lights_per_tile\": %u, \"overflowed_tiles\": %u, "
+               "\"mean_lights_per_tile_without_depth_bounds\": %.2f, \"identical\": %s, \"checked_lights\": %u, \"missed_lights\": %u}",
+               c == 0 ? "" : ",", LIGHT_COUNTS[c], scalarMs, simdMs, threadedMs, simd.lightTilePairs / tileCount, maxLights,
+               simd.overflowedTiles, unbounded.lightTilePairs / tileCount, identical ? "true" : "false", checked,
+               missed);
+    }
+    printf("\n]}\n");
+    pool.CleanUp();
+
+    if (failures) {
+        fprintf(stderr, "%u light counts gave lists that differ from the reference or miss lights\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include "MaskedOcclusionBuffer.h"
+#include <cmath>
+
+#if defined(SIMD_SSE2) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+static constexpr uint32_t FULL_TILE_MASK = {0xFFFFFFFF};
+
+struct ScreenVertex {
+    float x, y, z;
+};
+
+void MaskedOcclusionBuffer::Initialize(uint32_t w, uint32_t h) {
+    tilesX = (w + OCCLUSION_TILE_WIDTH - 1) / OCCLUSION_TILE_WIDTH;
+    tilesY = (h + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT;
+    width = tilesX * OCCLUSION_TILE_WIDTH;
+    height = tilesY * OCCLUSION_TILE_HEIGHT;
+    tiles.resize(tilesX * tilesY);
+    Clear();
+}
+
+void MaskedOcclusionBuffer::Clear() {
+    for (OcclusionTile &tile : tiles) {
+        tile.mask = 0;
+        tile.zFar0 = 1.0f;
+        tile.zFar1 = 0.0f;
+    }
+}
+
+static bool ProjectPoint(const float *p, const float m[16], float w, float h, ScreenVertex &result) {
+    float cx = p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12];
+    float cy = p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13];
+    float cz = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14];
+    float cw = p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + m[15];
+    if (cw <= 1e-5f)
+        return false;
+
+    float invW = 1.0f / cw;
+    result.x = (cx * invW * 0.5f + 0.5f) * w;
+    result.y = (0.5f - cy * invW * 0.5f) * h;
+    result.z = cz * invW;
+    return true;
+}
+
+// NOTE(pf): Coverage of 8 pixel centers starting at x0 on one row. Edge i is a[i] * x + rowBase[i].
+static uint32_t RowCoverage(const float a[3], const float rowBase[3], float x0) {
+#if defined(SIMD_AVX2)
+    __m256 xs = _mm256_add_ps(_mm256_set1_ps(x0), _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f));
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int e = 0; e < 3; ++e) {
+        __m256 v = _mm256_add_ps(_mm256_mul_ps(xs, _mm256_set1_ps(a[e])), _mm256_set1_ps(rowBase[e]));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    return (uint32_t)_mm256_movemask_ps(inside);
+#elif defined(SIMD_SSE2)
+    __m128 xs0 = _mm_add_ps(_mm_set1_ps(x0), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+    __m128 xs1 = _mm_add_ps(xs0, _mm_set1_ps(4.0f));
+    __m128 inside0 = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    __m128 inside1 = inside0;
+    for (int e = 0; e < 3; ++e) {
+        __m128 ae = _mm_set1_ps(a[e]);
+        __m128 be = _mm_set1_ps(rowBase[e]);
+        inside0 = _mm_and_ps(inside0, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(xs0, ae), be), _mm_setzero_ps()));
+        inside1 = _mm_and_ps(inside1, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(xs1, ae), be), _mm_setzero_ps()));
+    }
+    return (uint32_t)(_mm_movemask_ps(inside0) | (_mm_movemask_ps(inside1) << 4));
+#else
+    uint32_t result = 0;
+    for (uint32_t k = 0; k < OCCLUSION_TILE_WIDTH; ++k) {
+        float x = x0 + k + 0.5f;
+        bool  inside = true;
+        for (int e = 0; e < 3; ++e)
+            inside = inside && (a[e] * x + rowBase[e] >= 0.0f);
+        result |= (inside ? 1u : 0u) << k;
+    }
+    return result;
+#endif
+}
+
+static void UpdateTile(OcclusionTile &tile, uint32_t coverage, float zTriangle) {
+    // NOTE(pf): If the new triangle is much closer than the working layer, merging would push the
+    // working layer far back, so the paper's heuristic drops the working layer instead.
+    float distWorkingToTriangle = tile.zFar1 - zTriangle;
+    float distReferenceToWorking = tile.zFar0 - tile.zFar1;
+    if (tile.mask != 0 && distWorkingToTriangle > distReferenceToWorking) {
+        tile.mask = 0;
+        tile.zFar1 = 0.0f;
+    }
+
+    tile.zFar1 = Max(tile.zFar1, zTriangle);
+    tile.mask |= coverage;
+    if (tile.mask == FULL_TILE_MASK) {
+        tile.zFar0 = Min(tile.zFar0, tile.zFar1);
+        tile.mask = 0;
+        tile.zFar1 = 0.0f;
+    }
+}
+
+void MaskedOcclusionBuffer::RenderOccluder(const float *positions, size_t vertexStride, const uint32_t *indices, size_t indexCount,
+                                           const float modelViewProj[16]) {
+    for (size_t t = 0; t + 2 < indexCount; t += 3) {
+        ScreenVertex v[3];
+        bool         projected = true;
+        for (int k = 0; k < 3; ++k) {
+            const float *p = (const float *)((const uint8_t *)positions + vertexStride * indices[t + k]);
+            projected = projected && ProjectPoint(p, modelViewProj, (float)width, (float)height, v[k]);
+        }
+        if (!projected)
+            continue;
+
+        float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if (fabsf(area) < 1e-8f)
+            continue;
+        if (area < 0.0f) {
+            ScreenVertex tmp = v[1];
+            v[1] = v[2];
+            v[2] = tmp;
+        }
+
+        float zTriangle = Clamp(Max(Max(v[0].z, v[1].z), v[2].z), 0.0f, 1.0f);
+
+        float minX = Min(Min(v[0].x, v[1].x), v[2].x);
+        float maxX = Max(Max(v[0].x, v[1].x), v[2].x);
+        float minY = Min(Min(v[0].y, v[1].y), v[2].y);
+        float maxY = Max(Max(v[0].y, v[1].y), v[2].y);
+        if (maxX < 0.0f || maxY < 0.0f || minX >= (float)width || minY >= (float)height)
+            continue;
+
+        int tx0 = (int)Max(minX, 0.0f) / (int)OCCLUSION_TILE_WIDTH;
+        int ty0 = (int)Max(minY, 0.0f) / (int)OCCLUSION_TILE_HEIGHT;
+        int tx1 = (int)Min(maxX, (float)(width - 1)) / (int)OCCLUSION_TILE_WIDTH;
+        int ty1 = (int)Min(maxY, (float)(height - 1)) / (int)OCCLUSION_TILE_HEIGHT;
+
+        // Edge functions e(x, y) = a * x + b * y + c, positive inside.
+        float a[3], b[3], c[3];
+        for (int e = 0; e < 3; ++e) {
+            const ScreenVertex &p0 = v[e];
+            const ScreenVertex &p1 = v[(e + 1) % 3];
+            a[e] = p0.y - p1.y;
+            b[e] = p1.x - p0.x;
+            c[e] = -(a[e] * p0.x + b[e] * p0.y);
+        }
+
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                OcclusionTile &tile = tiles[ty * tilesX + tx];
+                if (zTriangle >= tile.zFar0)
+                    continue;
+
+                uint32_t coverage = 0;
+                for (uint32_t row = 0; row < OCCLUSION_TILE_HEIGHT; ++row) {
+                    float y = (float)(ty * OCCLUSION_TILE_HEIGHT + row) + 0.5f;
+                    float rowBase[3] = {b[0] * y + c[0], b[1] * y + c[1], b[2] * y + c[2]};
+                    coverage |= RowCoverage(a, rowBase, (float)(tx * OCCLUSION_TILE_WIDTH)) << (row * OCCLUSION_TILE_WIDTH);
+                }
+                if (coverage)
+                    UpdateTile(tile, coverage, zTriangle);
+            }
+        }
+    }
+}
+
+bool MaskedOcclusionBuffer::IsAabbVisible(const float aabbMin[3], const float aabbMax[3], const float viewProj[16]) const {
+    float minX = (float)width, minY = (float)height, zMin = 1.0f;
+    float maxX = 0.0f, maxY = 0.0f;
+    for (int corner = 0; corner < 8; ++corner) {
+        float p[3] = {(corner & 1) ? aabbMax[0] : aabbMin[0],
+                      (corner & 2) ? aabbMax[1] : aabbMin[1],
+                      (corner & 4) ? aabbMax[2] : aabbMin[2]};
+        ScreenVertex v;
+        if (!ProjectPoint(p, viewProj, (float)width, (float)height, v))
+            return true;
+        minX = Min(minX, v.x);
+        maxX = Max(maxX, v.x);
+        minY = Min(minY, v.y);
+        maxY = Max(maxY, v.y);
+        zMin = Min(zMin, v.z);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= (float)width || minY >= (float)height)
+        return false;
+
+    int tx0 = (int)Max(minX, 0.0f) / (int)OCCLUSION_TILE_WIDTH;
+    int ty0 = (int)Max(minY, 0.0f) / (int)OCCLUSION_TILE_HEIGHT;
+    int tx1 = (int)Min(maxX, (float)(width - 1)) / (int)OCCLUSION_TILE_WIDTH;
+    int ty1 = (int)Min(maxY, (float)(height - 1)) / (int)OCCLUSION_TILE_HEIGHT;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            if (zMin <= tiles[ty * tilesX + tx].zFar0)
+                return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,43 @@
+#ifndef _MASKED_OCCLUSION_BUFFER_H_
+#define _MASKED_OCCLUSION_BUFFER_H_
+
+/* Software occlusion buffer based on $SOURCE
+ * SOURCE: Andersson et al., "Masked Software Occlusion Culling", HPG 2016
+ *
+ * NOTE(pf): The screen is split into 8x4 pixel tiles. Each tile keeps a conservative far depth
+ * for the pixels fully covered so far (zFar0) and a working layer: a coverage mask with the
+ * farthest depth of the triangles that set it (zFar1). When the working layer covers the whole tile
+ * it is merged into zFar0. Depth is D3D style, 0 at the near and 1 at the far plane.
+ */
+
+#include "Common.h"
+#include <vector>
+
+static constexpr uint32_t OCCLUSION_TILE_WIDTH = {8};
+static constexpr uint32_t OCCLUSION_TILE_HEIGHT = {4};
+
+struct OcclusionTile {
+    uint32_t mask;
+    float    zFar0;
+    float    zFar1;
+};
+
+struct MaskedOcclusionBuffer {
+    void Initialize(uint32_t width, uint32_t height);
+    void Clear();
+
+    // NOTE(pf): Matrices are row-major with row vectors. Triangles crossing the near plane are skipped,
+    // which only makes the buffer less occluding, never wrong.
+    void RenderOccluder(const float *positions, size_t vertexStride, const uint32_t *indices, size_t indexCount,
+                        const float modelViewProj[16]);
+    // NOTE(pf): True unless every tile under the box's screen rectangle is known to be closer than the box.
+    bool IsAabbVisible(const float aabbMin[3], const float aabbMax[3], const float viewProj[16]) const;
+
+    uint32_t                   width = 0;
+    uint32_t                   height = 0;
+    uint32_t                   tilesX = 0;
+    uint32_t                   tilesY = 0;
+    std::vector<OcclusionTile> tiles;
+};
+
+#endif //!_MASKED_OCCLUSION_BUFFER_H_
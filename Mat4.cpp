@@ -0,0 +1,453 @@
+#include "Mat4.h"
+
+#if defined(SIMD_SSE2) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// .. 4 wide vector layer, the kernels below are written once against it for SSE2, NEON and plain C++ ..
+
+// NOTE(pf): Shuffle4<X, Y, Z, W>(a, b) is (a[X], a[Y], b[Z], b[W]) like _mm_shuffle_ps, the only
+// permutation the kernels use, so every backend has to provide just this one.
+#if defined(SIMD_SSE2)
+typedef __m128 Vec4;
+
+static inline Vec4  Load4(const float *p) { return _mm_loadu_ps(p); }
+static inline void  Store4(float *p, Vec4 a) { _mm_storeu_ps(p, a); }
+static inline Vec4  Set4(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+static inline Vec4  Splat4(float a) { return _mm_set1_ps(a); }
+static inline Vec4  Add4(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+static inline Vec4  Sub4(Vec4 a, Vec4 b) { return _mm_sub_ps(a, b); }
+static inline Vec4  Mul4(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+static inline Vec4  Div4(Vec4 a, Vec4 b) { return _mm_div_ps(a, b); }
+static inline Vec4  Max4(Vec4 a, Vec4 b) { return _mm_max_ps(a, b); }
+static inline Vec4  Sqrt4(Vec4 a) { return _mm_sqrt_ps(a); }
+static inline float Lane0(Vec4 a) { return _mm_cvtss_f32(a); }
+
+template <int X, int Y, int Z, int W> static inline Vec4 Shuffle4(Vec4 a, Vec4 b) {
+    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+}
+#elif defined(SIMD_NEON)
+typedef float32x4_t Vec4;
+
+static inline Vec4  Load4(const float *p) { return vld1q_f32(p); }
+static inline void  Store4(float *p, Vec4 a) { vst1q_f32(p, a); }
+static inline Vec4  Set4(float x, float y, float z, float w) { return (float32x4_t){x, y, z, w}; }
+static inline Vec4  Splat4(float a) { return vdupq_n_f32(a); }
+static inline Vec4  Add4(Vec4 a, Vec4 b) { return vaddq_f32(a, b); }
+static inline Vec4  Sub4(Vec4 a, Vec4 b) { return vsubq_f32(a, b); }
+static inline Vec4  Mul4(Vec4 a, Vec4 b) { return vmulq_f32(a, b); }
+static inline Vec4  Div4(Vec4 a, Vec4 b) { return vdivq_f32(a, b); }
+static inline Vec4  Max4(Vec4 a, Vec4 b) { return vmaxq_f32(a, b); }
+static inline Vec4  Sqrt4(Vec4 a) { return vsqrtq_f32(a); }
+static inline float Lane0(Vec4 a) { return vgetq_lane_f32(a, 0); }
+
+// NOTE(pf): Lane moves, the compiler turns the common patterns into zip/uzp/ext.
+template <int X, int Y, int Z, int W> static inline Vec4 Shuffle4(Vec4 a, Vec4 b) {
+    Vec4 result = vdupq_n_f32(vgetq_lane_f32(a, X));
+    result = vsetq_lane_f32(vgetq_lane_f32(a, Y), result, 1);
+    result = vsetq_lane_f32(vgetq_lane_f32(b, Z), result, 2);
+    result = vsetq_lane_f32(vgetq_lane_f32(b, W), result, 3);
+    return result;
+}
+#else
+struct Vec4 {
+    float v[4];
+};
+
+static inline Vec4 Load4(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+static inline void Store4(float *p, Vec4 a) {
+    for (int i = 0; i < 4; ++i)
+        p[i] = a.v[i];
+}
+static inline Vec4  Set4(float x, float y, float z, float w) { return {{x, y, z, w}}; }
+static inline Vec4  Splat4(float a) { return {{a, a, a, a}}; }
+static inline Vec4  Add4(Vec4 a, Vec4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+static inline Vec4  Sub4(Vec4 a, Vec4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+static inline Vec4  Mul4(Vec4 a, Vec4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+static inline Vec4  Div4(Vec4 a, Vec4 b) { return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}}; }
+static inline Vec4  Max4(Vec4 a, Vec4 b) { return {{Max(a.v[0], b.v[0]), Max(a.v[1], b.v[1]), Max(a.v[2], b.v[2]), Max(a.v[3], b.v[3])}}; }
+static inline Vec4  Sqrt4(Vec4 a) { return {{sqrtf(a.v[0]), sqrtf(a.v[1]), sqrtf(a.v[2]), sqrtf(a.v[3])}}; }
+static inline float Lane0(Vec4 a) { return a.v[0]; }
+
+template <int X, int Y, int Z, int W> static inline Vec4 Shuffle4(Vec4 a, Vec4 b) {
+    return {{a.v[X], a.v[Y], b.v[Z], b.v[W]}};
+}
+#endif
+
+template <int L> static inline Vec4 SplatLane(Vec4 a) {
+    return Shuffle4<L, L, L, L>(a, a);
+}
+
+static inline void Transpose4(Vec4 &r0, Vec4 &r1, Vec4 &r2, Vec4 &r3) {
+    Vec4 t0 = Shuffle4<0, 1, 0, 1>(r0, r1);
+    Vec4 t1 = Shuffle4<2, 3, 2, 3>(r0, r1);
+    Vec4 t2 = Shuffle4<0, 1, 0, 1>(r2, r3);
+    Vec4 t3 = Shuffle4<2, 3, 2, 3>(r2, r3);
+    r0 = Shuffle4<0, 2, 0, 2>(t0, t2);
+    r1 = Shuffle4<1, 3, 1, 3>(t0, t2);
+    r2 = Shuffle4<0, 2, 0, 2>(t1, t3);
+    r3 = Shuffle4<1, 3, 1, 3>(t1, t3);
+}
+
+// NOTE(pf): (x*b0 + z*b2) + (y*b1 + w*b3), the pairing XMMatrixMultiply uses.
+static inline Vec4 MultiplyRow(Vec4 row, Vec4 b0, Vec4 b1, Vec4 b2, Vec4 b3) {
+    Vec4 x = Mul4(SplatLane<0>(row), b0);
+    Vec4 y = Mul4(SplatLane<1>(row), b1);
+    Vec4 z = Mul4(SplatLane<2>(row), b2);
+    Vec4 w = Mul4(SplatLane<3>(row), b3);
+    return Add4(Add4(x, z), Add4(y, w));
+}
+
+// .. 3 vectors, evaluated like XMVector3Dot / Cross / Normalize ..
+
+static inline float Dot3(const float a[3], const float b[3]) {
+    return (a[0] * b[0] + a[1] * b[1]) + a[2] * b[2];
+}
+
+static inline void Cross3(const float a[3], const float b[3], float result[3]) {
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static inline void Normalize3(float v[3]) {
+    float length = sqrtf(Dot3(v, v));
+    v[0] /= length, v[1] /= length, v[2] /= length;
+}
+
+// NOTE(pf): x*r0 + (y*r1 + (z*r2 + r3)), the order of XMVector3Transform.
+static inline float TransformComponent(float x, float y, float z, float m0, float m1, float m2, float m3) {
+    return x * m0 + (y * m1 + (z * m2 + m3));
+}
+
+void ScalarSinCos(float *sinOut, float *cosOut, float value) {
+    // .. map value to y in [-pi, pi], x = 2*pi*quotient + remainder ..
+    float quotient = MATH_1DIV2PI * value;
+    if (value >= 0.0f)
+        quotient = (float)(int)(quotient + 0.5f);
+    else
+        quotient = (float)(int)(quotient - 0.5f);
+    float y = value - MATH_2PI * quotient;
+
+    // .. fold into [-pi/2, pi/2] with cos(y) = sign*cos(x) ..
+    float sign = 1.0f;
+    if (y > MATH_PIDIV2) {
+        y = MATH_PI - y;
+        sign = -1.0f;
+    } else if (y < -MATH_PIDIV2) {
+        y = -MATH_PI - y;
+        sign = -1.0f;
+    }
+
+    // NOTE(pf): 11 and 10 degree minimax polynomials, the coefficients of XMScalarSinCos.
+    float y2 = y * y;
+    *sinOut = (((((-2.3889859e-08f * y2 + 2.7525562e-06f) * y2 - 0.00019840874f) * y2 + 0.0083333310f) * y2 -
+                0.16666667f) * y2 + 1.0f) * y;
+    float p = ((((-2.6051615e-07f * y2 + 2.4760495e-05f) * y2 - 0.0013888378f) * y2 + 0.041666638f) * y2 - 0.5f) * y2 +
+              1.0f;
+    *cosOut = sign * p;
+}
+
+Mat4 Mat4Multiply(const Mat4 &a, const Mat4 &b) {
+    Vec4 b0 = Load4(b.m + 0), b1 = Load4(b.m + 4), b2 = Load4(b.m + 8), b3 = Load4(b.m + 12);
+    Mat4 result;
+    for (int r = 0; r < 4; ++r)
+        Store4(result.m + r * 4, MultiplyRow(Load4(a.m + r * 4), b0, b1, b2, b3));
+    return result;
+}
+
+Mat4 Mat4Transpose(const Mat4 &a) {
+    Vec4 r0 = Load4(a.m + 0), r1 = Load4(a.m + 4), r2 = Load4(a.m + 8), r3 = Load4(a.m + 12);
+    Transpose4(r0, r1, r2, r3);
+    Mat4 result;
+    Store4(result.m + 0, r0);
+    Store4(result.m + 4, r1);
+    Store4(result.m + 8, r2);
+    Store4(result.m + 12, r3);
+    return result;
+}
+
+Mat4 Mat4RotationAxis(float ax, float ay, float az, float angle) {
+    float n[3] = {ax, ay, az};
+    Normalize3(n);
+    float x = n[0], y = n[1], z = n[2];
+    float s, c;
+    ScalarSinCos(&s, &c, angle);
+    float t = 1.0f - c;
+
+    // NOTE(pf): XMMatrixRotationNormal shares (t*y)*z, (t*z)*x and (t*x)*y between the two triangles.
+    float yz = (t * y) * z, zx = (t * z) * x, xy = (t * x) * y;
+    Mat4  result = {{(t * x) * x + c, xy + s * z, zx - s * y, 0,
+                     xy - s * z, (t * y) * y + c, yz + s * x, 0,
+                     zx + s * y, yz - s * x, (t * z) * z + c, 0,
+                     0, 0, 0, 1}};
+    return result;
+}
+
+Mat4 Mat4LookAtLH(const float eye[3], const float focus[3], const float up[3]) {
+    float z[3] = {focus[0] - eye[0], focus[1] - eye[1], focus[2] - eye[2]};
+    Normalize3(z);
+    float x[3];
+    Cross3(up, z, x);
+    Normalize3(x);
+    float y[3];
+    Cross3(z, x, y);
+
+    Mat4 result = {{x[0], y[0], z[0], 0,
+                    x[1], y[1], z[1], 0,
+                    x[2], y[2], z[2], 0,
+                    -Dot3(x, eye), -Dot3(y, eye), -Dot3(z, eye), 1}};
+    return result;
+}
+
+Mat4 Mat4PerspectiveFovLH(float fovY, float aspectRatio, float nearZ, float farZ) {
+    float s, c;
+    ScalarSinCos(&s, &c, 0.5f * fovY);
+    float range = farZ / (farZ - nearZ);
+    float h = c / s;
+    float w = h / aspectRatio;
+
+    Mat4 result = {{w, 0, 0, 0,
+                    0, h, 0, 0,
+                    0, 0, range, 1,
+                    0, 0, -range * nearZ, 0}};
+    return result;
+}
+
+// .. 2x2 matrices packed row-major in one vector ..
+
+static inline Vec4 Mat2Mul(Vec4 a, Vec4 b) {
+    return Add4(Mul4(a, Shuffle4<0, 3, 0, 3>(b, b)), Mul4(Shuffle4<1, 0, 3, 2>(a, a), Shuffle4<2, 1, 2, 1>(b, b)));
+}
+
+// adj(a) * b
+static inline Vec4 Mat2AdjMul(Vec4 a, Vec4 b) {
+    return Sub4(Mul4(Shuffle4<3, 3, 0, 0>(a, a), b), Mul4(Shuffle4<1, 1, 2, 2>(a, a), Shuffle4<2, 3, 0, 1>(b, b)));
+}
+
+// a * adj(b)
+static inline Vec4 Mat2MulAdj(Vec4 a, Vec4 b) {
+    return Sub4(Mul4(a, Shuffle4<3, 0, 3, 0>(b, b)), Mul4(Shuffle4<1, 0, 3, 2>(a, a), Shuffle4<2, 1, 2, 1>(b, b)));
+}
+
+bool Mat4Inverse(const Mat4 &a, Mat4 &result) {
+    Vec4 r0 = Load4(a.m + 0), r1 = Load4(a.m + 4), r2 = Load4(a.m + 8), r3 = Load4(a.m + 12);
+
+    // .. M = |A B|, inverse(M) = 1/|M| |X Y| with the adjugates X, Y, Z, W of the blocks below ..
+    //        |C D|                     |Z W|
+    Vec4 A = Shuffle4<0, 1, 0, 1>(r0, r1);
+    Vec4 B = Shuffle4<2, 3, 2, 3>(r0, r1);
+    Vec4 C = Shuffle4<0, 1, 0, 1>(r2, r3);
+    Vec4 D = Shuffle4<2, 3, 2, 3>(r2, r3);
+
+    // (|A|, |B|, |C|, |D|)
+    Vec4 detSub = Sub4(Mul4(Shuffle4<0, 2, 0, 2>(r0, r2), Shuffle4<1, 3, 1, 3>(r1, r3)),
+                       Mul4(Shuffle4<1, 3, 1, 3>(r0, r2), Shuffle4<0, 2, 0, 2>(r1, r3)));
+    Vec4 detA = SplatLane<0>(detSub);
+    Vec4 detB = SplatLane<1>(detSub);
+    Vec4 detC = SplatLane<2>(detSub);
+    Vec4 detD = SplatLane<3>(detSub);
+
+    Vec4 DC = Mat2AdjMul(D, C);
+    Vec4 AB = Mat2AdjMul(A, B);
+    Vec4 X = Sub4(Mul4(detD, A), Mat2Mul(B, DC));
+    Vec4 W = Sub4(Mul4(detA, D), Mat2Mul(C, AB));
+    Vec4 Y = Sub4(Mul4(detB, C), Mat2MulAdj(D, AB));
+    Vec4 Z = Sub4(Mul4(detC, B), Mat2MulAdj(A, DC));
+
+    // .. |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C) ..
+    Vec4 tr = Mul4(AB, Shuffle4<0, 2, 1, 3>(DC, DC));
+    tr = Add4(tr, Shuffle4<1, 0, 3, 2>(tr, tr));
+    tr = Add4(tr, Shuffle4<2, 3, 0, 1>(tr, tr));
+    Vec4 detM = Sub4(Add4(Mul4(detA, detD), Mul4(detB, detC)), tr);
+    if (Lane0(detM) == 0.0f)
+        return false;
+
+    // NOTE(pf): The signs and the final adjugate shuffle of each block are folded into the stores.
+    Vec4 rDetM = Div4(Set4(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    X = Mul4(X, rDetM);
+    Y = Mul4(Y, rDetM);
+    Z = Mul4(Z, rDetM);
+    W = Mul4(W, rDetM);
+    Store4(result.m + 0, Shuffle4<3, 1, 3, 1>(X, Y));
+    Store4(result.m + 4, Shuffle4<2, 0, 2, 0>(X, Y));
+    Store4(result.m + 8, Shuffle4<3, 1, 3, 1>(Z, W));
+    Store4(result.m + 12, Shuffle4<2, 0, 2, 0>(Z, W));
+    return true;
+}
+
+// .. batch kernels ..
+
+void Mat4MultiplyBatch(const Mat4 *a, const Mat4 &b, Mat4 *result, size_t count) {
+#if defined(SIMD_AVX2)
+    // NOTE(pf): Two rows per register, the in-lane shuffles splat each row's elements within its half.
+    __m256 b0 = _mm256_broadcast_ps((const __m128 *)(b.m + 0));
+    __m256 b1 = _mm256_broadcast_ps((const __m128 *)(b.m + 4));
+    __m256 b2 = _mm256_broadcast_ps((const __m128 *)(b.m + 8));
+    __m256 b3 = _mm256_broadcast_ps((const __m128 *)(b.m + 12));
+    for (size_t i = 0; i < count; ++i) {
+        for (int half = 0; half < 2; ++half) {
+            __m256 rows = _mm256_loadu_ps(a[i].m + half * 8);
+            __m256 x = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+            __m256 y = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(1, 1, 1, 1)), b1);
+            __m256 z = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(2, 2, 2, 2)), b2);
+            __m256 w = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(3, 3, 3, 3)), b3);
+            _mm256_storeu_ps(result[i].m + half * 8, _mm256_add_ps(_mm256_add_ps(x, z), _mm256_add_ps(y, w)));
+        }
+    }
+#else
+    Vec4 b0 = Load4(b.m + 0), b1 = Load4(b.m + 4), b2 = Load4(b.m + 8), b3 = Load4(b.m + 12);
+    for (size_t i = 0; i < count; ++i) {
+        Vec4 r0 = Load4(a[i].m + 0), r1 = Load4(a[i].m + 4), r2 = Load4(a[i].m + 8), r3 = Load4(a[i].m + 12);
+        Store4(result[i].m + 0, MultiplyRow(r0, b0, b1, b2, b3));
+        Store4(result[i].m + 4, MultiplyRow(r1, b0, b1, b2, b3));
+        Store4(result[i].m + 8, MultiplyRow(r2, b0, b1, b2, b3));
+        Store4(result[i].m + 12, MultiplyRow(r3, b0, b1, b2, b3));
+    }
+#endif
+}
+
+void TransformPointsSoA(const Mat4 &m, const float *x, const float *y, const float *z, size_t count, float *outX,
+                        float *outY, float *outZ) {
+    // NOTE(pf): Points go across the lanes, column c of the matrix is splat once and gives component c.
+    const float *e = m.m;
+    float       *out[3] = {outX, outY, outZ};
+    size_t       i = 0;
+#if defined(SIMD_AVX2)
+    {
+        __m256 column[3][4];
+        for (int c = 0; c < 3; ++c) {
+            for (int k = 0; k < 4; ++k)
+                column[c][k] = _mm256_set1_ps(e[k * 4 + c]);
+        }
+        for (; i + 8 <= count; i += 8) {
+            __m256 px = _mm256_loadu_ps(x + i);
+            __m256 py = _mm256_loadu_ps(y + i);
+            __m256 pz = _mm256_loadu_ps(z + i);
+            for (int c = 0; c < 3; ++c) {
+                __m256 v = _mm256_add_ps(_mm256_mul_ps(pz, column[c][2]), column[c][3]);
+                v = _mm256_add_ps(_mm256_mul_ps(py, column[c][1]), v);
+                v = _mm256_add_ps(_mm256_mul_ps(px, column[c][0]), v);
+                _mm256_storeu_ps(out[c] + i, v);
+            }
+        }
+    }
+#endif
+    Vec4 column[3][4];
+    for (int c = 0; c < 3; ++c) {
+        for (int k = 0; k < 4; ++k)
+            column[c][k] = Splat4(e[k * 4 + c]);
+    }
+    for (; i + 4 <= count; i += 4) {
+        Vec4 px = Load4(x + i);
+        Vec4 py = Load4(y + i);
+        Vec4 pz = Load4(z + i);
+        for (int c = 0; c < 3; ++c) {
+            Vec4 v = Add4(Mul4(pz, column[c][2]), column[c][3]);
+            v = Add4(Mul4(py, column[c][1]), v);
+            v = Add4(Mul4(px, column[c][0]), v);
+            Store4(out[c] + i, v);
+        }
+    }
+    for (; i < count; ++i) {
+        float px = x[i], py = y[i], pz = z[i];
+        for (int c = 0; c < 3; ++c)
+            out[c][i] = TransformComponent(px, py, pz, e[c], e[4 + c], e[8 + c], e[12 + c]);
+    }
+}
+
+#if defined(SIMD_AVX2)
+// NOTE(pf): Row k of objects [0, 4) in the low halves and of [4, 8) in the high halves, transposed within each
+// half so that rows[c] holds element c of row k for all 8 objects.
+static inline void LoadTransposedRows8(const Mat4 *worlds, int k, __m256 rows[4]) {
+    for (int j = 0; j < 4; ++j) {
+        __m128 lo = _mm_loadu_ps(worlds[j].m + k * 4);
+        __m128 hi = _mm_loadu_ps(worlds[j + 4].m + k * 4);
+        rows[j] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+    }
+    __m256 t0 = _mm256_shuffle_ps(rows[0], rows[1], _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 t1 = _mm256_shuffle_ps(rows[0], rows[1], _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 t2 = _mm256_shuffle_ps(rows[2], rows[3], _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 t3 = _mm256_shuffle_ps(rows[2], rows[3], _MM_SHUFFLE(3, 2, 3, 2));
+    rows[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(2, 0, 2, 0));
+    rows[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 1, 3, 1));
+    rows[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(2, 0, 2, 0));
+    rows[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 1, 3, 1));
+}
+#endif
+
+static inline void LoadTransposedRows4(const Mat4 *worlds, int k, Vec4 rows[4]) {
+    rows[0] = Load4(worlds[0].m + k * 4);
+    rows[1] = Load4(worlds[1].m + k * 4);
+    rows[2] = Load4(worlds[2].m + k * 4);
+    rows[3] = Load4(worlds[3].m + k * 4);
+    Transpose4(rows[0], rows[1], rows[2], rows[3]);
+}
+
+void TransformBoundingSpheres(const Mat4 *worlds, size_t count, const float center[3], float radius, float *outX,
+                              float *outY, float *outZ, float *outRadius) {
+    // NOTE(pf): Objects go across the lanes, each matrix row is transposed in so the center is transformed and
+    // the axis lengths are summed exactly like the one object code in XMVector3Transform / XMVector3LengthSq.
+    size_t i = 0;
+#if defined(SIMD_AVX2)
+    {
+        __m256 c0 = _mm256_set1_ps(center[0]), c1 = _mm256_set1_ps(center[1]), c2 = _mm256_set1_ps(center[2]);
+        __m256 r = _mm256_set1_ps(radius);
+        for (; i + 8 <= count; i += 8) {
+            __m256 row0[4], row1[4], row2[4], row3[4];
+            LoadTransposedRows8(worlds + i, 0, row0);
+            LoadTransposedRows8(worlds + i, 1, row1);
+            LoadTransposedRows8(worlds + i, 2, row2);
+            LoadTransposedRows8(worlds + i, 3, row3);
+            for (int c = 0; c < 3; ++c) {
+                __m256 v = _mm256_add_ps(_mm256_mul_ps(c2, row2[c]), row3[c]);
+                v = _mm256_add_ps(_mm256_mul_ps(c1, row1[c]), v);
+                v = _mm256_add_ps(_mm256_mul_ps(c0, row0[c]), v);
+                _mm256_storeu_ps((c == 0 ? outX : c == 1 ? outY : outZ) + i, v);
+            }
+            __m256 *rows[3] = {row0, row1, row2};
+            __m256  scaleSq = _mm256_setzero_ps();
+            for (int k = 0; k < 3; ++k) {
+                __m256 *row = rows[k];
+                __m256  lengthSq = _mm256_add_ps(_mm256_mul_ps(row[0], row[0]), _mm256_mul_ps(row[1], row[1]));
+                lengthSq = _mm256_add_ps(lengthSq, _mm256_mul_ps(row[2], row[2]));
+                scaleSq = k == 0 ? lengthSq : _mm256_max_ps(scaleSq, lengthSq);
+            }
+            _mm256_storeu_ps(outRadius + i, _mm256_mul_ps(r, _mm256_sqrt_ps(scaleSq)));
+        }
+    }
+#endif
+    Vec4 c0 = Splat4(center[0]), c1 = Splat4(center[1]), c2 = Splat4(center[2]);
+    Vec4 r = Splat4(radius);
+    for (; i + 4 <= count; i += 4) {
+        Vec4 row0[4], row1[4], row2[4], row3[4];
+        LoadTransposedRows4(worlds + i, 0, row0);
+        LoadTransposedRows4(worlds + i, 1, row1);
+        LoadTransposedRows4(worlds + i, 2, row2);
+        LoadTransposedRows4(worlds + i, 3, row3);
+        for (int c = 0; c < 3; ++c) {
+            Vec4 v = Add4(Mul4(c2, row2[c]), row3[c]);
+            v = Add4(Mul4(c1, row1[c]), v);
+            v = Add4(Mul4(c0, row0[c]), v);
+            Store4((c == 0 ? outX : c == 1 ? outY : outZ) + i, v);
+        }
+        Vec4 *rows[3] = {row0, row1, row2};
+        Vec4  scaleSq = Splat4(0.0f);
+        for (int k = 0; k < 3; ++k) {
+            Vec4 *row = rows[k];
+            Vec4  lengthSq = Add4(Add4(Mul4(row[0], row[0]), Mul4(row[1], row[1])), Mul4(row[2], row[2]));
+            scaleSq = k == 0 ? lengthSq : Max4(scaleSq, lengthSq);
+        }
+        Store4(outRadius + i, Mul4(r, Sqrt4(scaleSq)));
+    }
+    for (; i < count; ++i) {
+        const float *w = worlds[i].m;
+        outX[i] = TransformComponent(center[0], center[1], center[2], w[0], w[4], w[8], w[12]);
+        outY[i] = TransformComponent(center[0], center[1], center[2], w[1], w[5], w[9], w[13]);
+        outZ[i] = TransformComponent(center[0], center[1], center[2], w[2], w[6], w[10], w[14]);
+        float scaleSq = Max(Max(Dot3(w + 0, w + 0), Dot3(w + 4, w + 4)), Dot3(w + 8, w + 8));
+        outRadius[i] = radius * sqrtf(scaleSq);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef _MAT4_H_
+#define _MAT4_H_
+
+/* Portable 4x4 matrix helpers for code that cannot use DirectXMath (software backend, benchmarks).
+ *
+ * NOTE(pf): Same conventions as DirectXMath and XMFLOAT4X4: row-major storage, row vectors (v * M),
+ * left-handed view space and D3D clip space with z in [0, 1].
+ */
+
+#include "Common.h"
+#include <cmath>
+
+// NOTE(pf): Layout compatible with XMFLOAT2 / XMFLOAT3 so vertex data can be shared with DirectXMath code.
+struct Float2 {
+    float x, y;
+};
+
+struct Float3 {
+    float x, y, z;
+};
+
+struct Mat4 {
+    float m[16];
+
+    float       &operator()(int row, int col) { return m[row * 4 + col]; }
+    const float &operator()(int row, int col) const { return m[row * 4 + col]; }
+};
+
+inline Mat4 Mat4Identity() {
+    Mat4 result = {{1, 0, 0, 0,
+                    0, 1, 0, 0,
+                    0, 0, 1, 0,
+                    0, 0, 0, 1}};
+    return result;
+}
+
+inline Mat4 Mat4Translation(float x, float y, float z) {
+    Mat4 result = Mat4Identity();
+    result.m[12] = x;
+    result.m[13] = y;
+    result.m[14] = z;
+    return result;
+}
+
+// NOTE(pf): The functions below are in Mat4.cpp, vectorized with SSE2/AVX2 or NEON. They evaluate in the same
+// order as DirectXMath's SSE path (XMMatrixMultiply, XMVector3Transform, XMScalarSinCos, ...), so on a
+// compiler that does not fuse multiply-adds they return bit identical results to it and to each other.
+// Mat4Inverse is the exception, it matches XMMatrixInverse to rounding only.
+
+static constexpr float MATH_PI = {3.141592654f};
+static constexpr float MATH_2PI = {6.283185307f};
+static constexpr float MATH_1DIV2PI = {0.159154943f};
+static constexpr float MATH_PIDIV2 = {1.570796327f};
+
+inline float ConvertToRadians(float degrees) {
+    return degrees * (MATH_PI / 180.0f);
+}
+
+// NOTE(pf): Polynomial approximation of XMScalarSinCos, not sinf/cosf, so projections match DirectXMath's.
+void ScalarSinCos(float *sinOut, float *cosOut, float value);
+
+Mat4 Mat4Multiply(const Mat4 &a, const Mat4 &b);
+Mat4 Mat4Transpose(const Mat4 &a);
+// NOTE(pf): Rotation of angle radians around axis, clockwise when looking down the axis (left-handed).
+Mat4 Mat4RotationAxis(float ax, float ay, float az, float angle);
+Mat4 Mat4LookAtLH(const float eye[3], const float focus[3], const float up[3]);
+Mat4 Mat4PerspectiveFovLH(float fovY, float aspectRatio, float nearZ, float farZ);
+// NOTE(pf): Block-wise inverse through 2x2 adjugates, returns false and leaves result untouched if singular.
+bool Mat4Inverse(const Mat4 &a, Mat4 &result);
+
+// .. batch kernels for thousands of objects, results equal the single versions element for element ..
+
+// result[i] = a[i] * b, result may alias a.
+void Mat4MultiplyBatch(const Mat4 *a, const Mat4 &b, Mat4 *result, size_t count);
+// (outX, outY, outZ)[i] = (x, y, z, 1)[i] * m, the w of the result is dropped. Outputs may alias the inputs.
+void TransformPointsSoA(const Mat4 &m, const float *x, const float *y, const float *z, size_t count, float *outX,
+                        float *outY, float *outZ);
+// NOTE(pf): World space bounding spheres of count instances of one local sphere, SoA output for the culler.
+// The radius is scaled by the longest axis of each world matrix.
+void TransformBoundingSpheres(const Mat4 *worlds, size_t count, const float center[3], float radius, float *outX,
+                              float *outY, float *outZ, float *outRadius);
+
+#endif //!_MAT4_H_
@@ -0,0 +1,351 @@
+/* Checks and times the Mat4 kernels, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -ffp-contract=off MathBenchmark.cpp Mat4.cpp Timer.cpp -o MathBenchmark
+ *
+ * The kernels are compared bit for bit against reference scalar loops written in DirectXMath's evaluation order,
+ * on random inputs and on the matrices App::RenderState builds. Where DirectXMath.h is on the include path, the
+ * Windows SDK or the header-only DirectXMath package elsewhere (see DIRECTXMATH_INCLUDE_DIR in CMakeLists.txt),
+ * Mat4Multiply, Mat4RotationAxis, Mat4LookAtLH and Mat4PerspectiveFovLH are also compared bit for bit against
+ * DirectXMath itself, "directxmath" in the JSON says whether they were. The inverse is compared against the
+ * cofactor expansion within a tolerance. Exits with 1 on a mismatch, otherwise prints JSON with ns per item for
+ * the kernels and the loops at 1k, 10k and 100k objects. MathBenchmark --print-scene dumps the scene matrices as
+ * hex so they can be diffed against a DirectXMath build.
+ */
+
+#include "Mat4.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if __has_include(<DirectXMath.h>)
+#include <DirectXMath.h>
+#define MATH_HAS_DIRECTXMATH 1
+#else
+#define MATH_HAS_DIRECTXMATH 0
+#endif
+
+static constexpr size_t ITEMS_PER_RUN = {4000000};
+static constexpr float  INVERSE_TOLERANCE = {1e-4f};
+
+static volatile float sink = 0.0f;
+
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+static float NextRandom(uint32_t &state, float lo, float hi) {
+    return lo + (hi - lo) * NextRandom(state);
+}
+
+// .. reference loops, one object at a time in DirectXMath's order ..
+
+static Mat4 ReferenceMultiply(const Mat4 &a, const Mat4 &b) {
+    Mat4 result;
+    for (int r = 0; r < 4; ++r) {
+        const float *row = &a.m[r * 4];
+        for (int c = 0; c < 4; ++c)
+            result.m[r * 4 + c] = (row[0] * b.m[c] + row[2] * b.m[8 + c]) + (row[1] * b.m[4 + c] + row[3] * b.m[12 + c]);
+    }
+    return result;
+}
+
+static void ReferenceTransformPoint(const Mat4 &m, const float p[3], float result[3]) {
+    for (int c = 0; c < 3; ++c)
+        result[c] = p[0] * m.m[c] + (p[1] * m.m[4 + c] + (p[2] * m.m[8 + c] + m.m[12 + c]));
+}
+
+static void ReferenceBoundingSphere(const Mat4 &world, const float center[3], float radius, float result[4]) {
+    ReferenceTransformPoint(world, center, result);
+    float scaleSq = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        const float *row = &world.m[k * 4];
+        float        lengthSq = (row[0] * row[0] + row[1] * row[1]) + row[2] * row[2];
+        scaleSq = k == 0 ? lengthSq : Max(scaleSq, lengthSq);
+    }
+    result[3] = radius * sqrtf(scaleSq);
+}
+
+// NOTE(pf): The cofactor expansion Mat4Inverse used before it was vectorized.
+static bool ReferenceInverse(const Mat4 &a, Mat4 &result) {
+    const float *m = a.m;
+    float        inv[16];
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f)
+        return false;
+
+    float invDet = 1.0f / det;
+    for (int i = 0; i < 16; ++i)
+        result.m[i] = inv[i] * invDet;
+    return true;
+}
+
+// .. inputs ..
+
+// NOTE(pf): Same scene as App::RenderState at the given angle, worlds of a grid of spinning skulls.
+static void BuildAppScene(float angleDegrees, int gridSize, std::vector<Mat4> &worlds, Mat4 &view, Mat4 &proj) {
+    const float instanceSpacing = 12.0f;
+    Mat4        model = Mat4RotationAxis(0.0f, 1.0f, 1.0f, ConvertToRadians(angleDegrees));
+    float       gridOffset = 0.5f * (gridSize - 1) * instanceSpacing;
+    worlds.resize(gridSize * gridSize);
+    for (int z = 0; z < gridSize; ++z) {
+        for (int x = 0; x < gridSize; ++x) {
+            Mat4 translation = Mat4Translation(x * instanceSpacing - gridOffset, 0.0f, z * instanceSpacing - gridOffset);
+            worlds[z * gridSize + x] = Mat4Multiply(model, translation);
+        }
+    }
+
+    const float eye[3] = {0.0f, 5.0f, -25.0f};
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    view = Mat4LookAtLH(eye, focus, up);
+    proj = Mat4PerspectiveFovLH(ConvertToRadians(45.0f), 1200.0f / 720.0f, 1.0f, 1000.0f);
+}
+
+// NOTE(pf): Rotation, non-uniform scale and translation, like the worlds of a scene graph.
+static void BuildRandomWorlds(uint32_t seed, size_t count, std::vector<Mat4> &worlds) {
+    uint32_t state = seed;
+    worlds.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        Mat4 rotation = Mat4RotationAxis(NextRandom(state, -1.0f, 1.0f), NextRandom(state, -1.0f, 1.0f),
+                                         NextRandom(state, 0.1f, 1.0f), NextRandom(state, -10.0f, 10.0f));
+        Mat4 scale = Mat4Identity();
+        scale.m[0] = NextRandom(state, 0.1f, 4.0f);
+        scale.m[5] = NextRandom(state, 0.1f, 4.0f);
+        scale.m[10] = NextRandom(state, 0.1f, 4.0f);
+        Mat4 translation = Mat4Translation(NextRandom(state, -500.0f, 500.0f), NextRandom(state, -50.0f, 50.0f),
+                                           NextRandom(state, -500.0f, 500.0f));
+        worlds[i] = Mat4Multiply(Mat4Multiply(scale, rotation), translation);
+    }
+}
+
+// .. checks ..
+
+static uint32_t failures = 0;
+
+static void ExpectBits(const char *what, size_t index, const float *actual, const float *expected, size_t count) {
+    if (memcmp(actual, expected, count * sizeof(float)) == 0)
+        return;
+    if (failures++ < 10)
+        fprintf(stderr, "%s differs at %zu\n", what, index);
+}
+
+static void CheckKernels(const std::vector<Mat4> &worlds, const Mat4 &viewProj) {
+    size_t count = worlds.size();
+
+    std::vector<Mat4> products(count);
+    Mat4MultiplyBatch(worlds.data(), viewProj, products.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        Mat4 expected = ReferenceMultiply(worlds[i], viewProj);
+        Mat4 single = Mat4Multiply(worlds[i], viewProj);
+        ExpectBits("Mat4MultiplyBatch", i, products[i].m, expected.m, 16);
+        ExpectBits("Mat4Multiply", i, single.m, expected.m, 16);
+    }
+
+    std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count);
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = worlds[i].m[12], y[i] = worlds[i].m[13], z[i] = worlds[i].m[14];
+    }
+    TransformPointsSoA(viewProj, x.data(), y.data(), z.data(), count, outX.data(), outY.data(), outZ.data());
+    for (size_t i = 0; i < count; ++i) {
+        float p[3] = {x[i], y[i], z[i]}, expected[3], actual[3] = {outX[i], outY[i], outZ[i]};
+        ReferenceTransformPoint(viewProj, p, expected);
+        ExpectBits("TransformPointsSoA", i, actual, expected, 3);
+    }
+
+    const float        center[3] = {0.25f, -1.5f, 3.0f};
+    const float        radius = 7.5f;
+    std::vector<float> outRadius(count);
+    TransformBoundingSpheres(worlds.data(), count, center, radius, outX.data(), outY.data(), outZ.data(),
+                             outRadius.data());
+    for (size_t i = 0; i < count; ++i) {
+        float expected[4], actual[4] = {outX[i], outY[i], outZ[i], outRadius[i]};
+        ReferenceBoundingSphere(worlds[i], center, radius, expected);
+        ExpectBits("TransformBoundingSpheres", i, actual, expected, 4);
+    }
+}
+
+#if MATH_HAS_DIRECTXMATH
+static Mat4 FromXM(DirectX::FXMMATRIX m) {
+    Mat4 result;
+    DirectX::XMStoreFloat4x4((DirectX::XMFLOAT4X4 *)result.m, m);
+    return result;
+}
+
+static DirectX::XMMATRIX ToXM(const Mat4 &m) {
+    return DirectX::XMLoadFloat4x4((const DirectX::XMFLOAT4X4 *)m.m);
+}
+
+// .. DirectXMath itself, on the App's camera at a few angles and on every world ..
+static void CheckDirectXMath(const std::vector<Mat4> &worlds, const Mat4 &viewProj) {
+    using namespace DirectX;
+    const float angles[] = {0.0f, 37.5f, 123.0f, 270.0f, 359.5f};
+    for (size_t i = 0; i < sizeof(angles) / sizeof(angles[0]); ++i) {
+        Mat4 expected = FromXM(XMMatrixRotationAxis(XMVectorSet(0.0f, 1.0f, 1.0f, 0.0f), XMConvertToRadians(angles[i])));
+        Mat4 actual = Mat4RotationAxis(0.0f, 1.0f, 1.0f, ConvertToRadians(angles[i]));
+        ExpectBits("Mat4RotationAxis against DirectXMath", i, actual.m, expected.m, 16);
+    }
+
+    const float eye[3] = {0.0f, 5.0f, -25.0f}, focus[3] = {0.0f, 0.0f, 0.0f}, up[3] = {0.0f, 1.0f, 0.0f};
+    Mat4 view = FromXM(XMMatrixLookAtLH(XMVectorSet(0, 5, -25, 1), XMVectorSet(0, 0, 0, 1), XMVectorSet(0, 1, 0, 0)));
+    ExpectBits("Mat4LookAtLH against DirectXMath", 0, Mat4LookAtLH(eye, focus, up).m, view.m, 16);
+    Mat4 proj = FromXM(XMMatrixPerspectiveFovLH(XMConvertToRadians(45.0f), 1200.0f / 720.0f, 1.0f, 1000.0f));
+    ExpectBits("Mat4PerspectiveFovLH against DirectXMath", 0,
+               Mat4PerspectiveFovLH(ConvertToRadians(45.0f), 1200.0f / 720.0f, 1.0f, 1000.0f).m, proj.m, 16);
+
+    for (size_t i = 0; i < worlds.size(); ++i) {
+        Mat4 expected = FromXM(XMMatrixMultiply(ToXM(worlds[i]), ToXM(viewProj)));
+        ExpectBits("Mat4Multiply against DirectXMath", i, Mat4Multiply(worlds[i], viewProj).m, expected.m, 16);
+    }
+}
+#endif
+
+static float MaxInverseError(const std::vector<Mat4> &matrices) {
+    float maxError = 0.0f;
+    for (size_t i = 0; i < matrices.size(); ++i) {
+        Mat4 actual, expected;
+        if (!Mat4Inverse(matrices[i], actual) || !ReferenceInverse(matrices[i], expected)) {
+            if (failures++ < 10)
+                fprintf(stderr, "Mat4Inverse found %zu singular\n", i);
+            continue;
+        }
+        for (int k = 0; k < 16; ++k) {
+            float error = fabsf(actual.m[k] - expected.m[k]) / Max(1.0f, fabsf(expected.m[k]));
+            maxError = Max(maxError, error);
+        }
+    }
+    return maxError;
+}
+
+static void PrintMatrixBits(const char *name, const Mat4 &m) {
+    printf("%s", name);
+    for (int i = 0; i < 16; ++i) {
+        uint32_t bits;
+        memcpy(&bits, &m.m[i], sizeof(bits));
+        printf("%s%08x", i % 4 == 0 ? "\n  " : " ", bits);
+    }
+    printf("\n");
+}
+
+// .. timing, ns per object over ITEMS_PER_RUN objects ..
+
+template <typename F> static double MeasureNs(size_t count, F run) {
+    size_t  runs = ITEMS_PER_RUN / count;
+    int64_t start = HiResPerformanceQuery();
+    for (size_t r = 0; r < runs; ++r)
+        run();
+    int64_t end = HiResPerformanceQuery();
+    return HiResMilliseconds(end - start) * 1e6 / (double)(runs * count);
+}
+
+int main(int argc, char **argv) {
+    std::vector<Mat4> worlds;
+    Mat4              view, proj;
+    BuildAppScene(123.0f, 10, worlds, view, proj);
+
+    if (argc > 1 && strcmp(argv[1], "--print-scene") == 0) {
+        PrintMatrixBits("world[0]", worlds[0]);
+        PrintMatrixBits("view", view);
+        PrintMatrixBits("proj", proj);
+        return 0;
+    }
+
+    // .. correctness, the App's scene and a random scene with a count that leaves a tail for every width ..
+    Mat4 viewProj = Mat4Multiply(view, proj);
+    CheckKernels(worlds, viewProj);
+    std::vector<Mat4> randomWorlds;
+    BuildRandomWorlds(1, 1003, randomWorlds);
+    CheckKernels(randomWorlds, viewProj);
+#if MATH_HAS_DIRECTXMATH
+    CheckDirectXMath(worlds, viewProj);
+    CheckDirectXMath(randomWorlds, viewProj);
+#endif
+
+    randomWorlds.push_back(view);
+    randomWorlds.push_back(proj);
+    randomWorlds.push_back(viewProj);
+    float inverseError = MaxInverseError(randomWorlds);
+    if (inverseError > INVERSE_TOLERANCE) {
+        fprintf(stderr, "Mat4Inverse relative error %g over %g\n", inverseError, INVERSE_TOLERANCE);
+        failures++;
+    }
+    if (failures) {
+        fprintf(stderr, "%u mismatches\n", failures);
+        return 1;
+    }
+
+    // .. throughput ..
+    const size_t counts[] = {1000, 10000, 100000};
+    printf("{\"benchmark\": \"mat4\", \"directxmath\": %s, \"inverse_max_relative_error\": %g, \"runs\": [",
+           MATH_HAS_DIRECTXMATH ? "true" : "false", inverseError);
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        size_t count = counts[c];
+        BuildRandomWorlds(2, count, randomWorlds);
+        std::vector<Mat4>  products(count);
+        std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count), outRadius(count);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = randomWorlds[i].m[12], y[i] = randomWorlds[i].m[13], z[i] = randomWorlds[i].m[14];
+        }
+        const float center[3] = {0.25f, -1.5f, 3.0f};
+
+        double multiplyScalar = MeasureNs(count, [&]() {
+            for (size_t i = 0; i < count; ++i)
+                products[i] = ReferenceMultiply(randomWorlds[i], viewProj);
+            sink = sink + products[count - 1].m[0];
+        });
+        double multiplyBatch = MeasureNs(count, [&]() {
+            Mat4MultiplyBatch(randomWorlds.data(), viewProj, products.data(), count);
+            sink = sink + products[count - 1].m[0];
+        });
+        double pointsScalar = MeasureNs(count, [&]() {
+            for (size_t i = 0; i < count; ++i) {
+                float p[3] = {x[i], y[i], z[i]}, result[3];
+                ReferenceTransformPoint(viewProj, p, result);
+                outX[i] = result[0], outY[i] = result[1], outZ[i] = result[2];
+            }
+            sink = sink + outX[count - 1];
+        });
+        double pointsSoA = MeasureNs(count, [&]() {
+            TransformPointsSoA(viewProj, x.data(), y.data(), z.data(), count, outX.data(), outY.data(), outZ.data());
+            sink = sink + outX[count - 1];
+        });
+        double spheresScalar = MeasureNs(count, [&]() {
+            for (size_t i = 0; i < count; ++i) {
+                float result[4];
+                ReferenceBoundingSphere(randomWorlds[i], center, 7.5f, result);
+                outX[i] = result[0], outY[i] = result[1], outZ[i] = result[2], outRadius[i] = result[3];
+            }
+            sink = sink + outRadius[count - 1];
+        });
+        double spheresSoA = MeasureNs(count, [&]() {
+            TransformBoundingSpheres(randomWorlds.data(), count, center, 7.5f, outX.data(), outY.data(), outZ.data(),
+                                     outRadius.data());
+            sink = sink + outRadius[count - 1];
+        });
+
+        printf("%s\n  {\"count\": %zu, \"multiply_scalar_ns\": %.2f, \"multiply_batch_ns\": %.2f, "
+               "\"points_scalar_ns\": %.2f, \"points_soa_ns\": %.2f, \"spheres_scalar_ns\": %.2f, "
+               "\"spheres_soa_ns\": %.2f}",
+               c == 0 ? "" : ",", count, multiplyScalar, multiplyBatch, pointsScalar, pointsSoA, spheresScalar,
+               spheresSoA);
+    }
+    printf("\n]}\n");
+    return 0;
+}
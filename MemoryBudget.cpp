@@ -0,0 +1,184 @@
+#include "MemoryBudget.h"
+#include <algorithm>
+
+enum MEMORY_POLICY : uint8_t {
+    MEMORY_POLICY_PINNED,
+    MEMORY_POLICY_RELEASE_AFTER_FENCE,
+    MEMORY_POLICY_EVICT,
+    MEMORY_POLICY_DROP,
+};
+
+struct MemoryCategoryInfo {
+    const char    *name;
+    MEMORY_SEGMENT segment;
+    MEMORY_POLICY  policy;
+};
+
+static const MemoryCategoryInfo categoryInfos[MEMORY_CATEGORY_COUNT] = {
+    {"render_target", MEMORY_SEGMENT_LOCAL, MEMORY_POLICY_PINNED},
+    {"gpu_buffer", MEMORY_SEGMENT_LOCAL, MEMORY_POLICY_PINNED},
+    {"mesh", MEMORY_SEGMENT_LOCAL, MEMORY_POLICY_EVICT},
+    {"texture", MEMORY_SEGMENT_LOCAL, MEMORY_POLICY_EVICT},
+    {"staging", MEMORY_SEGMENT_NON_LOCAL, MEMORY_POLICY_RELEASE_AFTER_FENCE},
+    {"upload", MEMORY_SEGMENT_NON_LOCAL, MEMORY_POLICY_PINNED},
+    {"readback", MEMORY_SEGMENT_NON_LOCAL, MEMORY_POLICY_PINNED},
+    {"cpu_shadow", MEMORY_SEGMENT_CPU, MEMORY_POLICY_DROP},
+};
+
+static const char *segmentNames[MEMORY_SEGMENT_COUNT] = {"local", "non_local", "cpu"};
+
+MEMORY_SEGMENT MemoryCategorySegment(MEMORY_CATEGORY category) {
+    return categoryInfos[category].segment;
+}
+
+const char *MemoryCategoryName(MEMORY_CATEGORY category) {
+    return categoryInfos[category].name;
+}
+
+const char *MemorySegmentName(MEMORY_SEGMENT segment) {
+    return segmentNames[segment];
+}
+
+void MemoryBudget::Initialize(const MemoryBudgetSettings &_settings) {
+    settings = _settings;
+    for (uint32_t s = 0; s < MEMORY_SEGMENT_COUNT; ++s)
+        osBudgets[s] = 0;
+    allocations.clear();
+    freeIds.clear();
+    stats = {};
+}
+
+void MemoryBudget::AddResident(const MemoryAllocation &allocation) {
+    MEMORY_SEGMENT segment = MemoryCategorySegment(allocation.category);
+    stats.current[allocation.category] += allocation.bytes;
+    stats.peak[allocation.category] = std::max(stats.peak[allocation.category], stats.current[allocation.category]);
+    stats.resident[segment] += allocation.bytes;
+    stats.peakResident[segment] = std::max(stats.peakResident[segment], stats.resident[segment]);
+}
+
+void MemoryBudget::RemoveResident(const MemoryAllocation &allocation) {
+    stats.current[allocation.category] -= allocation.bytes;
+    stats.resident[MemoryCategorySegment(allocation.category)] -= allocation.bytes;
+}
+
+uint32_t MemoryBudget::Track(const char *name, MEMORY_CATEGORY category, uint64_t bytes, void *owner, uint64_t fence) {
+    uint32_t id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        allocations.push_back({});
+        id = (uint32_t)allocations.size();
+    }
+
+    MemoryAllocation &allocation = allocations[id - 1];
+    allocation.name = name;
+    allocation.owner = owner;
+    allocation.bytes = bytes;
+    allocation.lastUseFence = fence;
+    allocation.category = category;
+    allocation.resident = true;
+    allocation.live = true;
+    AddResident(allocation);
+    return id;
+}
+
+void MemoryBudget::Untrack(uint32_t id) {
+    if (!IsLive(id))
+        return;
+    MemoryAllocation &allocation = allocations[id - 1];
+    if (allocation.resident)
+        RemoveResident(allocation);
+    else
+        stats.evicted[MemoryCategorySegment(allocation.category)] -= allocation.bytes;
+    allocation.live = false;
+    freeIds.push_back(id);
+}
+
+bool MemoryBudget::Use(uint32_t id, uint64_t fence) {
+    if (!IsLive(id))
+        return false;
+    MemoryAllocation &allocation = allocations[id - 1];
+    allocation.lastUseFence = std::max(allocation.lastUseFence, fence);
+    if (allocation.resident)
+        return false;
+
+    allocation.resident = true;
+    stats.evicted[MemoryCategorySegment(allocation.category)] -= allocation.bytes;
+    AddResident(allocation);
+    stats.restores++;
+    return true;
+}
+
+bool MemoryBudget::IsLive(uint32_t id) const {
+    return id > 0 && id <= allocations.size() && allocations[id - 1].live;
+}
+
+bool MemoryBudget::IsResident(uint32_t id) const {
+    return IsLive(id) && allocations[id - 1].resident;
+}
+
+void MemoryBudget::SetOsBudget(MEMORY_SEGMENT segment, uint64_t bytes) {
+    osBudgets[segment] = bytes;
+}
+
+uint64_t MemoryBudget::Budget(MEMORY_SEGMENT segment) const {
+    uint64_t configured = settings.budgets[segment];
+    uint64_t os = osBudgets[segment];
+    if (configured == 0 || os == 0)
+        return configured | os;
+    return std::min(configured, os);
+}
+
+void MemoryBudget::Update(uint64_t completedFence, std::vector<MemoryAction> &actions) {
+    // .. staging is garbage once its copy has run ..
+    for (uint32_t i = 0; i < allocations.size(); ++i) {
+        MemoryAllocation &allocation = allocations[i];
+        if (allocation.live && categoryInfos[allocation.category].policy == MEMORY_POLICY_RELEASE_AFTER_FENCE &&
+            allocation.lastUseFence <= completedFence) {
+            actions.push_back({MEMORY_ACTION_RELEASE, allocation.category, i + 1, allocation.owner});
+            Untrack(i + 1);
+            stats.releases++;
+        }
+    }
+
+    for (uint32_t s = 0; s < MEMORY_SEGMENT_COUNT; ++s) {
+        uint64_t budget = Budget((MEMORY_SEGMENT)s);
+        if (budget == 0 || stats.resident[s] <= budget)
+            continue;
+
+        // .. least recently used first. Cpu copies are only read while recording, which never overlaps Update ..
+        candidates.clear();
+        for (uint32_t i = 0; i < allocations.size(); ++i) {
+            const MemoryAllocation &allocation = allocations[i];
+            MEMORY_POLICY           policy = categoryInfos[allocation.category].policy;
+            if (!allocation.live || !allocation.resident || MemoryCategorySegment(allocation.category) != s)
+                continue;
+            if (policy == MEMORY_POLICY_DROP || (policy == MEMORY_POLICY_EVICT && allocation.lastUseFence <= completedFence))
+                candidates.push_back(i);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [this](uint32_t l, uint32_t r) {
+            return allocations[l].lastUseFence < allocations[r].lastUseFence;
+        });
+
+        uint64_t target = (uint64_t)(budget * (1.0 - settings.headroom));
+        for (uint32_t i : candidates) {
+            if (stats.resident[s] <= target)
+                break;
+            MemoryAllocation &allocation = allocations[i];
+            if (categoryInfos[allocation.category].policy == MEMORY_POLICY_DROP) {
+                actions.push_back({MEMORY_ACTION_RELEASE, allocation.category, i + 1, allocation.owner});
+                Untrack(i + 1);
+                stats.releases++;
+            } else {
+                actions.push_back({MEMORY_ACTION_EVICT, allocation.category, i + 1, allocation.owner});
+                RemoveResident(allocation);
+                allocation.resident = false;
+                stats.evicted[s] += allocation.bytes;
+                stats.evictions++;
+            }
+        }
+        if (stats.resident[s] > budget)
+            stats.overBudgetUpdates++;
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef _MEMORY_BUDGET_H_
+#define _MEMORY_BUDGET_H_
+
+/* Accounts every gpu resource and cpu copy the renderer keeps, by category, and keeps what is resident within
+ * a budget per memory segment.
+ *
+ * NOTE(pf): The category of an allocation decides its segment and what the budget may do with it. Staging
+ * uploads are released as soon as the fence of their copy has passed. Over budget, meshes and read only
+ * textures are evicted and cpu shadow copies dropped, least recently used first. Every use is stamped with the
+ * fence value of the submission that reads it and nothing the gpu may still read is evicted. The budget only
+ * emits actions and the renderer carries them out (Release, ID3D12Device::Evict), so the policy runs without a
+ * device, see MemoryBudgetTool.
+ */
+
+#include "Common.h"
+#include <vector>
+
+enum MEMORY_SEGMENT : uint8_t {
+    MEMORY_SEGMENT_LOCAL,     // Video memory, DXGI_MEMORY_SEGMENT_GROUP_LOCAL.
+    MEMORY_SEGMENT_NON_LOCAL, // System memory the gpu reads, upload and readback heaps.
+    MEMORY_SEGMENT_CPU,       // Copies only the cpu reads.
+    MEMORY_SEGMENT_COUNT,
+};
+
+enum MEMORY_CATEGORY : uint8_t {
+    MEMORY_RENDER_TARGET, // Back buffers, depth and the passes' targets. Pinned.
+    MEMORY_GPU_BUFFER,    // Buffers the gpu writes, tile lists and the depth pyramid. Pinned.
+    MEMORY_MESH,          // Vertex and index buffers. Evicted.
+    MEMORY_TEXTURE,       // Read only textures. Evicted.
+    MEMORY_STAGING,       // Upload heap of a one off copy. Released once the copy completed.
+    MEMORY_UPLOAD,        // Per frame upload buffers and constants. Pinned.
+    MEMORY_READBACK,      // Pinned.
+    MEMORY_CPU_SHADOW,    // Cpu copies of gpu data. Dropped.
+    MEMORY_CATEGORY_COUNT,
+};
+
+enum MEMORY_ACTION_TYPE : uint8_t {
+    MEMORY_ACTION_RELEASE, // Free it, the id is no longer valid.
+    MEMORY_ACTION_EVICT,   // Page it out, the next Use asks for it to be made resident again.
+};
+
+struct MemoryAction {
+    MEMORY_ACTION_TYPE type;
+    MEMORY_CATEGORY    category;
+    uint32_t           id;
+    void              *owner;
+};
+
+struct MemoryBudgetSettings {
+    uint64_t budgets[MEMORY_SEGMENT_COUNT] = {}; // Bytes, 0 for no budget.
+    double   headroom = {0.05};                  // Once over a budget, evict down to this fraction below it.
+};
+
+struct MemoryAllocation {
+    const char     *name;
+    void           *owner; // Handed back with the allocation's actions.
+    uint64_t        bytes;
+    uint64_t        lastUseFence;
+    MEMORY_CATEGORY category;
+    bool            resident;
+    bool            live;
+};
+
+struct MemoryBudgetStats {
+    uint64_t current[MEMORY_CATEGORY_COUNT]; // Resident bytes.
+    uint64_t peak[MEMORY_CATEGORY_COUNT];
+    uint64_t resident[MEMORY_SEGMENT_COUNT];
+    uint64_t peakResident[MEMORY_SEGMENT_COUNT];
+    uint64_t evicted[MEMORY_SEGMENT_COUNT]; // Bytes paged out right now.
+    uint32_t releases;
+    uint32_t evictions;
+    uint32_t restores;
+    uint32_t overBudgetUpdates; // Updates that left a segment over its budget, everything left was pinned or in flight.
+};
+
+struct MemoryBudget {
+    void Initialize(const MemoryBudgetSettings &settings);
+
+    // NOTE(pf): fence is the submission that fills the allocation, only staging waits for it. Ids start at 1.
+    uint32_t Track(const char *name, MEMORY_CATEGORY category, uint64_t bytes, void *owner, uint64_t fence = 0);
+    void     Untrack(uint32_t id);
+    // NOTE(pf): Stamps the allocation with the fence value of the submission that reads it. Returns true when it
+    // was evicted and has to be made resident before that submission, false for released ids.
+    bool     Use(uint32_t id, uint64_t fence);
+    bool     IsLive(uint32_t id) const;
+    bool     IsResident(uint32_t id) const;
+
+    // NOTE(pf): What the OS grants the process, DXGI_QUERY_VIDEO_MEMORY_INFO::Budget. The smaller of it and the
+    // configured budget applies, 0 for none.
+    void     SetOsBudget(MEMORY_SEGMENT segment, uint64_t bytes);
+    uint64_t Budget(MEMORY_SEGMENT segment) const;
+
+    // NOTE(pf): Appends the actions that release finished staging and bring every segment within its budget. The
+    // accounting already reflects them when this returns. Use the frame's gpu working set before, with the fence
+    // of the frame, or what it draws with can be evicted and made resident again every frame.
+    void Update(uint64_t completedFence, std::vector<MemoryAction> &actions);
+
+    void AddResident(const MemoryAllocation &allocation);
+    void RemoveResident(const MemoryAllocation &allocation);
+
+    MemoryBudgetSettings          settings;
+    uint64_t                      osBudgets[MEMORY_SEGMENT_COUNT] = {};
+    std::vector<MemoryAllocation> allocations; // Indexed by id - 1.
+    std::vector<uint32_t>         freeIds;
+    std::vector<uint32_t>         candidates;
+    MemoryBudgetStats             stats = {};
+};
+
+MEMORY_SEGMENT MemoryCategorySegment(MEMORY_CATEGORY category);
+const char    *MemoryCategoryName(MEMORY_CATEGORY category);
+const char    *MemorySegmentName(MEMORY_SEGMENT segment);
+
+#endif //!_MEMORY_BUDGET_H_
@@ -0,0 +1,285 @@
+/* Runs the memory budget's accounting and eviction policy against the renderer's allocations and synthetic mesh
+ * streaming, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 MemoryBudgetTool.cpp MemoryBudget.cpp -o MemoryBudgetTool
+ *   ./MemoryBudgetTool
+ *
+ * Every scenario tracks what DX12::Initialize creates at 1200x720, uploaded by fence 1, and optionally a set of
+ * streamed meshes that are drawn through a window sliding over them. Frame f submits fence f + 2 and the gpu
+ * completes fences MEMTOOL_LATENCY_FRAMES behind it, or every earlier one for an idle gpu. As in
+ * DX12::UpdateAndRender, the gpu allocations a frame draws with are used before the budget updates. The tool keeps
+ * its own copy of every allocation's state and checks each action and the accounting against it: nothing pinned,
+ * in flight or read by the frame is touched, staging goes as soon as its copy completed, the stats match and a
+ * segment only stays over budget when everything left in it is pinned or in flight. The exit code is 1 on any
+ * violation, or when a scenario stays over budget more often than it allows.
+ */
+
+#include "MemoryBudget.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t MEMTOOL_FRAMES = {1200};
+static constexpr uint32_t MEMTOOL_LATENCY_FRAMES = {3}; // NUM_FRAMES in DX12.h.
+static constexpr uint64_t MEMTOOL_MB = {1024 * 1024};
+static constexpr uint64_t MEMTOOL_PAGE = {64 * 1024}; // D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT.
+
+struct MemtoolScenario {
+    const char *name;
+    uint64_t    localBudgetMb; // 0 for none.
+    uint64_t    cpuBudgetMb;
+    uint32_t    meshCount; // Streamed meshes on top of the renderer's own.
+    uint32_t    meshMinMb;
+    uint32_t    meshMaxMb;
+    uint32_t    window;        // Streamed meshes drawn every frame.
+    uint32_t    framesPerStep; // Frames before the window moves on by one mesh, it wraps around.
+    bool        shadows;       // Streamed meshes keep a cpu copy that is read while they are drawn.
+    bool        idleGpu;       // The gpu has finished every earlier frame when the next one starts.
+    uint32_t    maxOverBudgetUpdates;
+};
+
+static const MemtoolScenario scenarios[] = {
+    {"app", 0, 0, 0, 0, 0, 0, 1, false, false, 0},
+    {"streaming", 384, 0, 96, 2, 12, 12, 8, false, false, 0},
+    {"cpu_shadows", 0, 48, 64, 2, 6, 6, 4, true, false, 0},
+    {"oversubscribed", 128, 0, 48, 4, 12, 24, 8, false, false, MEMTOOL_FRAMES},
+    {"idle_gpu", 24, 0, 16, 2, 4, 4, 8, false, true, MEMTOOL_FRAMES}, // Below what is pinned, only in flight is safe.
+};
+
+struct ModelAllocation {
+    const char     *name;
+    MEMORY_CATEGORY category;
+    uint64_t        bytes;
+    uint64_t        lastUse;
+    uint32_t        id;
+    bool            resident;
+    bool            live;
+    bool            perFrame; // Read by every frame.
+};
+
+struct MemtoolResult {
+    uint64_t peakResident[MEMORY_SEGMENT_COUNT];
+    uint32_t releases;
+    uint32_t evictions;
+    uint32_t restores;
+    uint32_t overBudgetUpdates;
+    uint32_t shadowRefetches; // Cpu copies read again after they were dropped.
+    int      stagingFreeFrame;
+    uint32_t violations;
+};
+
+static uint32_t NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static uint64_t AlignPage(uint64_t bytes) {
+    return (bytes + MEMTOOL_PAGE - 1) / MEMTOOL_PAGE * MEMTOOL_PAGE;
+}
+
+static void Violation(MemtoolResult &result, const char *scenario, uint32_t frame, const char *what, const char *name) {
+    if (result.violations++ < 8)
+        fprintf(stderr, "%s: frame %u, %s (%s)\n", scenario, frame, what, name);
+}
+
+static bool IsEvictable(MEMORY_CATEGORY category) {
+    return category == MEMORY_MESH || category == MEMORY_TEXTURE || category == MEMORY_CPU_SHADOW;
+}
+
+// NOTE(pf): Sizes follow the formats DX12::Initialize and the passes create, the depth pyramid atlas is taken as
+// half the targets in RG32F.
+static void AddRendererAllocations(std::vector<ModelAllocation> &model) {
+    const uint64_t w = 1200, h = 720;
+    const uint64_t tiles = ((w + 15) / 16) * ((h + 15) / 16);
+    const uint64_t skullVertices = 31076 * 44, skullIndices = 60339 * 3 * 4 * 2; // LODs follow LOD 0.
+    const struct {
+        const char     *name;
+        MEMORY_CATEGORY category;
+        uint64_t        bytes;
+        uint32_t        count;
+        bool            perFrame;
+    } entries[] = {
+        {"BackBuffer", MEMORY_RENDER_TARGET, w * h * 4, 3, false},
+        {"DepthBuffer", MEMORY_RENDER_TARGET, w * h * 4, 1, false},
+        {"NormalMap", MEMORY_RENDER_TARGET, w * h * 8, 1, false},
+        {"AmbientMap", MEMORY_RENDER_TARGET, w * h * 2, 1, false},
+        {"LitColor", MEMORY_RENDER_TARGET, w * h * 8, 1, false},
+        {"DepthPyramid", MEMORY_GPU_BUFFER, w * h / 4 * 8, 1, false},
+        {"DepthPyramidScratch", MEMORY_GPU_BUFFER, 4096, 1, false},
+        {"TileLights", MEMORY_GPU_BUFFER, tiles * 256 * 4, 1, false},
+        {"RandomVectorMap", MEMORY_TEXTURE, 256 * 256 * 4, 1, true},
+        {"RandomVectorMapUpload", MEMORY_STAGING, 256 * 256 * 4, 1, false},
+        {"SkullVertices", MEMORY_MESH, skullVertices, 1, true},
+        {"SkullIndices", MEMORY_MESH, skullIndices, 1, true},
+        {"SkullVerticesUpload", MEMORY_STAGING, skullVertices, 1, false},
+        {"SkullIndicesUpload", MEMORY_STAGING, skullIndices, 1, false},
+        {"SkullVerticesCPU", MEMORY_CPU_SHADOW, skullVertices, 1, true},
+        {"SkullIndicesCPU", MEMORY_CPU_SHADOW, skullIndices, 1, true},
+        {"InstanceUpload", MEMORY_UPLOAD, 16384 * 48, 3, false},
+        {"IndirectArgsUpload", MEMORY_UPLOAD, 4096, 3, false},
+        {"LightUpload", MEMORY_UPLOAD, 16384 * 32, 3, false},
+        {"Constants", MEMORY_UPLOAD, 4096, 4, false},
+        {"TimestampReadback", MEMORY_READBACK, 4096, 1, false},
+    };
+    for (const auto &entry : entries) {
+        for (uint32_t i = 0; i < entry.count; ++i)
+            model.push_back({entry.name, entry.category, AlignPage(entry.bytes), 1, 0, true, true, entry.perFrame});
+    }
+}
+
+static void Use(MemoryBudget &budget, std::vector<ModelAllocation> &model, size_t index, uint64_t fence,
+                MemtoolResult &result, const char *scenario, uint32_t frame) {
+    ModelAllocation &allocation = model[index];
+    if (!allocation.live) {
+        // .. a dropped cpu copy is read back from the mesh file ..
+        allocation.id = budget.Track(allocation.name, allocation.category, allocation.bytes, (void *)index, fence);
+        allocation.live = true;
+        allocation.resident = true;
+        allocation.lastUse = fence;
+        result.shadowRefetches++;
+        return;
+    }
+    bool restore = budget.Use(allocation.id, fence);
+    if (restore == allocation.resident)
+        Violation(result, scenario, frame, restore ? "restored a resident allocation" : "used an evicted allocation", allocation.name);
+    allocation.resident = true;
+    allocation.lastUse = fence > allocation.lastUse ? fence : allocation.lastUse;
+}
+
+static MemtoolResult Simulate(const MemtoolScenario &scenario) {
+    MemtoolResult        result = {};
+    MemoryBudgetSettings settings;
+    settings.budgets[MEMORY_SEGMENT_LOCAL] = scenario.localBudgetMb * MEMTOOL_MB;
+    settings.budgets[MEMORY_SEGMENT_CPU] = scenario.cpuBudgetMb * MEMTOOL_MB;
+    MemoryBudget budget;
+    budget.Initialize(settings);
+
+    std::vector<ModelAllocation> model;
+    AddRendererAllocations(model);
+    size_t   firstStreamed = model.size();
+    uint32_t state = 1;
+    for (uint32_t i = 0; i < scenario.meshCount; ++i) {
+        uint64_t bytes = (scenario.meshMinMb + NextRandom(state) % (scenario.meshMaxMb - scenario.meshMinMb + 1)) * MEMTOOL_MB;
+        model.push_back({"StreamedMesh", MEMORY_MESH, bytes, 1, 0, true, true, false});
+        model.push_back({"StreamedMeshUpload", MEMORY_STAGING, bytes, 1, 0, true, true, false});
+        if (scenario.shadows)
+            model.push_back({"StreamedMeshCPU", MEMORY_CPU_SHADOW, bytes, 1, 0, true, true, false});
+    }
+    uint32_t perMesh = scenario.shadows ? 3 : 2;
+    for (size_t i = 0; i < model.size(); ++i)
+        model[i].id = budget.Track(model[i].name, model[i].category, model[i].bytes, (void *)i, model[i].lastUse);
+
+    std::vector<MemoryAction> actions;
+    result.stagingFreeFrame = -1;
+    for (uint32_t frame = 0; frame < MEMTOOL_FRAMES; ++frame) {
+        uint64_t fence = frame + 2;
+        uint64_t completed = scenario.idleGpu ? fence - 1 : fence > MEMTOOL_LATENCY_FRAMES + 1 ? fence - MEMTOOL_LATENCY_FRAMES : 1;
+
+        // .. the frame's gpu working set is marked before the update, as DX12::UpdateAndRender does ..
+        for (size_t i = 0; i < firstStreamed; ++i) {
+            if (model[i].perFrame && model[i].category != MEMORY_CPU_SHADOW)
+                Use(budget, model, i, fence, result, scenario.name, frame);
+        }
+        uint32_t first = frame / scenario.framesPerStep;
+        for (uint32_t w = 0; w < scenario.window; ++w)
+            Use(budget, model, firstStreamed + (size_t)((first + w) % scenario.meshCount) * perMesh, fence, result,
+                scenario.name, frame);
+
+        actions.clear();
+        budget.Update(completed, actions);
+        for (const MemoryAction &action : actions) {
+            ModelAllocation &allocation = model[(size_t)action.owner];
+            if (!allocation.live || allocation.id != action.id || allocation.category != action.category) {
+                Violation(result, scenario.name, frame, "action on a stale allocation", allocation.name);
+                continue;
+            }
+            if (action.type == MEMORY_ACTION_RELEASE) {
+                if (action.category != MEMORY_STAGING && action.category != MEMORY_CPU_SHADOW)
+                    Violation(result, scenario.name, frame, "released a pinned allocation", allocation.name);
+                if (action.category == MEMORY_STAGING && allocation.lastUse > completed)
+                    Violation(result, scenario.name, frame, "released staging before its copy", allocation.name);
+                if (action.category == MEMORY_CPU_SHADOW && frame > 0 && allocation.lastUse + 1 == fence)
+                    Violation(result, scenario.name, frame, "dropped a cpu copy the last frame read", allocation.name);
+                allocation.live = false;
+                allocation.resident = false;
+            } else {
+                if (action.category != MEMORY_MESH && action.category != MEMORY_TEXTURE)
+                    Violation(result, scenario.name, frame, "evicted a pinned allocation", allocation.name);
+                if (allocation.perFrame || allocation.lastUse == fence)
+                    Violation(result, scenario.name, frame, "evicted an allocation the frame reads", allocation.name);
+                else if (allocation.lastUse > completed)
+                    Violation(result, scenario.name, frame, "evicted an allocation in flight", allocation.name);
+                if (!allocation.resident)
+                    Violation(result, scenario.name, frame, "evicted twice", allocation.name);
+                allocation.resident = false;
+            }
+        }
+
+        // .. the accounting matches, and whatever is over budget could not have been evicted ..
+        uint64_t resident[MEMORY_SEGMENT_COUNT] = {};
+        bool     evictable[MEMORY_SEGMENT_COUNT] = {};
+        bool     staging = false;
+        for (const ModelAllocation &allocation : model) {
+            MEMORY_SEGMENT segment = MemoryCategorySegment(allocation.category);
+            staging |= allocation.live && allocation.category == MEMORY_STAGING;
+            if (!allocation.live || !allocation.resident)
+                continue;
+            resident[segment] += allocation.bytes;
+            evictable[segment] |= IsEvictable(allocation.category) &&
+                                  (allocation.category == MEMORY_CPU_SHADOW || allocation.lastUse <= completed);
+        }
+        for (uint32_t s = 0; s < MEMORY_SEGMENT_COUNT; ++s) {
+            if (resident[s] != budget.stats.resident[s])
+                Violation(result, scenario.name, frame, "accounting differs", MemorySegmentName((MEMORY_SEGMENT)s));
+            uint64_t limit = budget.Budget((MEMORY_SEGMENT)s);
+            if (limit && resident[s] > limit && evictable[s])
+                Violation(result, scenario.name, frame, "over budget with evictable allocations", MemorySegmentName((MEMORY_SEGMENT)s));
+        }
+        if (!staging && result.stagingFreeFrame < 0)
+            result.stagingFreeFrame = (int)frame;
+
+        // .. record the frame, the cpu copies are read while it is recorded ..
+        for (size_t i = 0; i < firstStreamed; ++i) {
+            if (model[i].perFrame && model[i].category == MEMORY_CPU_SHADOW)
+                Use(budget, model, i, fence, result, scenario.name, frame);
+        }
+        for (uint32_t w = 0; w < scenario.window && scenario.shadows; ++w)
+            Use(budget, model, firstStreamed + (size_t)((first + w) % scenario.meshCount) * perMesh + 2, fence, result,
+                scenario.name, frame);
+    }
+
+    for (uint32_t s = 0; s < MEMORY_SEGMENT_COUNT; ++s)
+        result.peakResident[s] = budget.stats.peakResident[s];
+    result.releases = budget.stats.releases;
+    result.evictions = budget.stats.evictions;
+    result.restores = budget.stats.restores;
+    result.overBudgetUpdates = budget.stats.overBudgetUpdates;
+    return result;
+}
+
+int main() {
+    uint32_t failures = 0;
+    printf("{\"benchmark\": \"memory_budget\", \"scenarios\": [");
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); ++s) {
+        const MemtoolScenario &scenario = scenarios[s];
+        MemtoolResult          result = Simulate(scenario);
+        printf("%s\n  {\"name\": \"%s\", \"local_budget_mb\": %llu, \"cpu_budget_mb\": %llu, "
+               "\"peak_local_mb\": %.1f, \"peak_non_local_mb\": %.1f, \"peak_cpu_mb\": %.1f, \"releases\": %u, "
+               "\"evictions\": %u, \"restores\": %u, \"shadow_refetches\": %u, \"over_budget_updates\": %u, "
+               "\"staging_free_frame\": %d, \"violations\": %u}",
+               s == 0 ? "" : ",", scenario.name, (unsigned long long)scenario.localBudgetMb,
+               (unsigned long long)scenario.cpuBudgetMb, result.peakResident[MEMORY_SEGMENT_LOCAL] / (double)MEMTOOL_MB,
+               result.peakResident[MEMORY_SEGMENT_NON_LOCAL] / (double)MEMTOOL_MB,
+               result.peakResident[MEMORY_SEGMENT_CPU] / (double)MEMTOOL_MB, result.releases, result.evictions,
+               result.restores, result.shadowRefetches, result.overBudgetUpdates, result.stagingFreeFrame,
+               result.violations);
+
+        if (result.violations || result.overBudgetUpdates > scenario.maxOverBudgetUpdates ||
+            result.stagingFreeFrame < 0 || result.stagingFreeFrame > (int)MEMTOOL_LATENCY_FRAMES) {
+            fprintf(stderr, "%s: %u violations, %u updates over budget, staging freed at frame %d\n", scenario.name,
+                    result.violations, result.overBudgetUpdates, result.stagingFreeFrame);
+            failures++;
+        }
+    }
+    printf("\n]}\n");
+    return failures ? 1 : 0;
+}
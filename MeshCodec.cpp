@@ -0,0 +1,534 @@
+#include "MeshCodec.h"
+#include "SsaoNormals.h"
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <string.h>
+
+#if defined(SIMD_SSE2) || defined(SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(MeshVertex) == 6 * sizeof(float), "The decoders store vertices as six floats.");
+
+static constexpr uint32_t BYTE_GROUP_SIZE = {16};
+static constexpr uint32_t BYTE_GROUP_PAYLOAD[4] = {0, 4, 8, 16}; // Bytes of a group of 0, 2, 4 and 8 bit values.
+static constexpr uint32_t VERTEX_COMPONENTS = {5};                // Position xyz, octahedral normal xy.
+
+static uint16_t ZigZag16(uint16_t delta) {
+    return (uint16_t)((uint16_t)(delta << 1) ^ (uint16_t)((int16_t)delta >> 15));
+}
+
+static uint16_t UnZigZag16(uint16_t v) {
+    return (uint16_t)((v >> 1) ^ (uint16_t)(0u - (v & 1u)));
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Encoding
+
+static void EncodeByteGroups(const uint8_t *bytes, uint32_t count, std::vector<uint8_t> &out) {
+    uint32_t groupCount = (count + BYTE_GROUP_SIZE - 1) / BYTE_GROUP_SIZE;
+    size_t   header = out.size();
+    out.resize(header + (groupCount + 3) / 4, 0);
+
+    for (uint32_t g = 0; g < groupCount; ++g) {
+        uint8_t  group[BYTE_GROUP_SIZE] = {};
+        uint32_t first = g * BYTE_GROUP_SIZE;
+        memcpy(group, bytes + first, std::min(BYTE_GROUP_SIZE, count - first));
+        uint8_t largest = 0;
+        for (uint32_t k = 0; k < BYTE_GROUP_SIZE; ++k)
+            largest = std::max(largest, group[k]);
+
+        uint32_t mode = largest == 0 ? 0 : largest < 4 ? 1 : largest < 16 ? 2 : 3;
+        out[header + g / 4] |= (uint8_t)(mode << ((g % 4) * 2));
+        if (mode == 1) {
+            // .. value k in bits 2 * (k / 4) of byte k % 4 ..
+            uint8_t payload[4] = {};
+            for (uint32_t k = 0; k < BYTE_GROUP_SIZE; ++k)
+                payload[k % 4] |= (uint8_t)(group[k] << (2 * (k / 4)));
+            out.insert(out.end(), payload, payload + 4);
+        } else if (mode == 2) {
+            // .. value k in the low nibble of byte k, value k + 8 in its high one ..
+            uint8_t payload[8];
+            for (uint32_t k = 0; k < 8; ++k)
+                payload[k] = (uint8_t)(group[k] | (group[k + 8] << 4));
+            out.insert(out.end(), payload, payload + 8);
+        } else if (mode == 3) {
+            out.insert(out.end(), group, group + BYTE_GROUP_SIZE);
+        }
+    }
+}
+
+void EncodeMesh(const MeshData &mesh, const MeshCodecSettings &settings, std::vector<uint8_t> &out) {
+    // .. vertices in the order of their first use ..
+    std::vector<uint32_t> remap(mesh.vertices.size(), ~0u);
+    std::vector<uint32_t> order;
+    order.reserve(mesh.vertices.size());
+    for (uint32_t index : mesh.indices) {
+        if (remap[index] == ~0u) {
+            remap[index] = (uint32_t)order.size();
+            order.push_back(index);
+        }
+    }
+    const uint32_t vertexCount = (uint32_t)order.size();
+    const uint32_t indexCount = (uint32_t)mesh.indices.size();
+
+    MeshCodecHeader header = {};
+    header.magic = MESH_CODEC_MAGIC;
+    header.version = MESH_CODEC_VERSION;
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.vertexChunkCount = (vertexCount + MESH_CODEC_VERTEX_CHUNK - 1) / MESH_CODEC_VERTEX_CHUNK;
+    header.indexChunkCount = (indexCount + MESH_CODEC_INDEX_CHUNK - 1) / MESH_CODEC_INDEX_CHUNK;
+    header.normalBits = settings.normalBits;
+    header.lodCount = mesh.lodCount;
+    memcpy(header.lods, mesh.lods, sizeof(header.lods));
+
+    // .. quantize, positions against their box ..
+    const uint32_t positionMax = (1u << settings.positionBits) - 1;
+    const uint32_t normalShift = 16 - settings.normalBits;
+    float          boxMin[3] = {0.0f, 0.0f, 0.0f}, boxMax[3] = {0.0f, 0.0f, 0.0f};
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            float p = mesh.vertices[order[i]].position[c];
+            boxMin[c] = i == 0 ? p : Min(boxMin[c], p);
+            boxMax[c] = i == 0 ? p : Max(boxMax[c], p);
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        header.positionMin[c] = boxMin[c];
+        header.positionScale[c] = (boxMax[c] - boxMin[c]) / positionMax;
+    }
+
+    std::vector<uint16_t> quantized[VERTEX_COMPONENTS];
+    for (uint32_t c = 0; c < VERTEX_COMPONENTS; ++c)
+        quantized[c].resize(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        const MeshVertex &v = mesh.vertices[order[i]];
+        for (int c = 0; c < 3; ++c) {
+            float q = header.positionScale[c] > 0.0f ? (v.position[c] - boxMin[c]) / header.positionScale[c] : 0.0f;
+            quantized[c][i] = (uint16_t)std::min((uint32_t)lrintf(Clamp(q, 0.0f, (float)positionMax)), positionMax);
+        }
+        // NOTE(pf): Arithmetic shifts, so a component keeps its sign and small deltas around 0.
+        uint32_t packed = PackOctahedralSnorm16(v.normal);
+        for (int c = 0; c < 2; ++c) {
+            int32_t s = (int16_t)(packed >> (16 * c));
+            if (normalShift > 0)
+                s = std::min(s + (1 << (normalShift - 1)), 32767) >> normalShift;
+            quantized[3 + c][i] = (uint16_t)s;
+        }
+    }
+
+    // .. the bounds have to hold the dequantized positions, which are up to half a step off ..
+    header.bounds = mesh.bounds;
+    float halfStep[3];
+    for (int c = 0; c < 3; ++c) {
+        halfStep[c] = 0.5f * header.positionScale[c];
+        header.bounds.aabbMin[c] -= halfStep[c];
+        header.bounds.aabbMax[c] += halfStep[c];
+    }
+    header.bounds.radius += sqrtf(halfStep[0] * halfStep[0] + halfStep[1] * halfStep[1] + halfStep[2] * halfStep[2]);
+
+    const uint32_t chunkCount = header.vertexChunkCount + header.indexChunkCount;
+    std::vector<MeshCodecChunk> chunks(chunkCount);
+    out.clear();
+    out.resize(sizeof(MeshCodecHeader) + chunkCount * sizeof(MeshCodecChunk));
+
+    // .. vertex chunks, per component a low and a high byte plane of the zigzagged deltas ..
+    std::vector<uint8_t> low(MESH_CODEC_VERTEX_CHUNK), high(MESH_CODEC_VERTEX_CHUNK);
+    for (uint32_t chunk = 0; chunk < header.vertexChunkCount; ++chunk) {
+        MeshCodecChunk &info = chunks[chunk];
+        info.offset = (uint32_t)out.size();
+        info.first = chunk * MESH_CODEC_VERTEX_CHUNK;
+        info.count = std::min(MESH_CODEC_VERTEX_CHUNK, vertexCount - info.first);
+        for (uint32_t c = 0; c < VERTEX_COMPONENTS; ++c) {
+            uint16_t previous = 0;
+            for (uint32_t i = 0; i < info.count; ++i) {
+                uint16_t q = quantized[c][info.first + i];
+                uint16_t zigzag = ZigZag16((uint16_t)(q - previous));
+                low[i] = (uint8_t)zigzag;
+                high[i] = (uint8_t)(zigzag >> 8);
+                previous = q;
+            }
+            EncodeByteGroups(low.data(), info.count, out);
+            EncodeByteGroups(high.data(), info.count, out);
+        }
+        info.size = (uint32_t)out.size() - info.offset;
+    }
+
+    // .. index chunks, four byte planes of the distances below the next unused vertex ..
+    std::vector<uint8_t> planes[4];
+    for (std::vector<uint8_t> &plane : planes)
+        plane.resize(MESH_CODEC_INDEX_CHUNK);
+    uint32_t next = 0;
+    for (uint32_t chunk = 0; chunk < header.indexChunkCount; ++chunk) {
+        MeshCodecChunk &info = chunks[header.vertexChunkCount + chunk];
+        info.offset = (uint32_t)out.size();
+        info.first = chunk * MESH_CODEC_INDEX_CHUNK;
+        info.count = std::min(MESH_CODEC_INDEX_CHUNK, indexCount - info.first);
+        info.base = next;
+        for (uint32_t i = 0; i < info.count; ++i) {
+            uint32_t index = remap[mesh.indices[info.first + i]];
+            uint32_t code = next - index;
+            next += code == 0;
+            for (int b = 0; b < 4; ++b)
+                planes[b][i] = (uint8_t)(code >> (8 * b));
+        }
+        for (int b = 0; b < 4; ++b)
+            EncodeByteGroups(planes[b].data(), info.count, out);
+        info.size = (uint32_t)out.size() - info.offset;
+    }
+
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + sizeof(header), chunks.data(), chunkCount * sizeof(MeshCodecChunk));
+}
+
+// ---------------------------------------------------------------------------------------------------------------
+// Decoding
+
+#if defined(SIMD_SSE2)
+static inline __m128i DecodeByteGroupSSE2(const uint8_t *src, uint32_t mode) {
+    switch (mode) {
+    case 0:
+        return _mm_setzero_si128();
+    case 1: {
+        int32_t packed;
+        memcpy(&packed, src, sizeof(packed));
+        __m128i x = _mm_cvtsi32_si128(packed);
+        __m128i mask = _mm_set1_epi8(3);
+        __m128i v0 = _mm_and_si128(x, mask);
+        __m128i v1 = _mm_and_si128(_mm_srli_epi16(x, 2), mask);
+        __m128i v2 = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+        __m128i v3 = _mm_and_si128(_mm_srli_epi16(x, 6), mask);
+        return _mm_unpacklo_epi64(_mm_unpacklo_epi32(v0, v1), _mm_unpacklo_epi32(v2, v3));
+    }
+    case 2: {
+        __m128i x = _mm_loadl_epi64((const __m128i *)src);
+        __m128i mask = _mm_set1_epi8(15);
+        return _mm_unpacklo_epi64(_mm_and_si128(x, mask), _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+    }
+    default:
+        return _mm_loadu_si128((const __m128i *)src);
+    }
+}
+#endif
+
+// NOTE(pf): Writes whole groups, out has to hold count rounded up to BYTE_GROUP_SIZE. Returns the end of the
+// groups or null when they run past end.
+static const uint8_t *DecodeByteGroups(const uint8_t *src, const uint8_t *end, uint32_t count, uint8_t *out, bool simd) {
+    uint32_t       groupCount = (count + BYTE_GROUP_SIZE - 1) / BYTE_GROUP_SIZE;
+    const uint8_t *header = src;
+    if ((size_t)(end - src) < (groupCount + 3) / 4)
+        return nullptr;
+    src += (groupCount + 3) / 4;
+
+    for (uint32_t g = 0; g < groupCount; ++g) {
+        uint32_t mode = (header[g / 4] >> ((g % 4) * 2)) & 3;
+        uint32_t size = BYTE_GROUP_PAYLOAD[mode];
+        if ((size_t)(end - src) < size)
+            return nullptr;
+        uint8_t *dst = out + g * BYTE_GROUP_SIZE;
+#if defined(SIMD_SSE2)
+        if (simd) {
+            _mm_storeu_si128((__m128i *)dst, DecodeByteGroupSSE2(src, mode));
+            src += size;
+            continue;
+        }
+#endif
+        for (uint32_t k = 0; k < BYTE_GROUP_SIZE; ++k) {
+            if (mode == 0)
+                dst[k] = 0;
+            else if (mode == 1)
+                dst[k] = (src[k % 4] >> (2 * (k / 4))) & 3;
+            else if (mode == 2)
+                dst[k] = k < 8 ? src[k] & 15 : src[k - 8] >> 4;
+            else
+                dst[k] = src[k];
+        }
+        src += size;
+    }
+    return src;
+}
+
+// .. low and high byte planes of zigzagged deltas back to the quantized values, count rounded up to 16 ..
+static void UndeltaComponent(const uint8_t *low, const uint8_t *high, uint32_t count, uint16_t *out, bool simd) {
+    uint32_t i = 0;
+#if defined(SIMD_SSE2)
+    if (simd) {
+        const __m128i one = _mm_set1_epi16(1);
+        __m128i       carry = _mm_setzero_si128();
+        for (; i < count; i += 16) {
+            __m128i l = _mm_loadu_si128((const __m128i *)(low + i));
+            __m128i h = _mm_loadu_si128((const __m128i *)(high + i));
+            __m128i values[2] = {_mm_unpacklo_epi8(l, h), _mm_unpackhi_epi8(l, h)};
+            for (int k = 0; k < 2; ++k) {
+                __m128i v = values[k];
+                __m128i d = _mm_xor_si128(_mm_srli_epi16(v, 1), _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(v, one)));
+                // .. inclusive prefix sum over the 8 lanes, plus the last value of the previous 8 ..
+                d = _mm_add_epi16(d, _mm_slli_si128(d, 2));
+                d = _mm_add_epi16(d, _mm_slli_si128(d, 4));
+                d = _mm_add_epi16(d, _mm_slli_si128(d, 8));
+                d = _mm_add_epi16(d, carry);
+                _mm_storeu_si128((__m128i *)(out + i + 8 * k), d);
+                carry = _mm_shufflehi_epi16(d, 0xFF);
+                carry = _mm_unpackhi_epi64(carry, carry);
+            }
+        }
+        return;
+    }
+#endif
+    uint16_t previous = 0;
+    for (; i < count; ++i) {
+        previous = (uint16_t)(previous + UnZigZag16((uint16_t)(low[i] | (high[i] << 8))));
+        out[i] = previous;
+    }
+}
+
+#if defined(SIMD_SSE2)
+// .. four vertices from SoA registers to six floats each ..
+static inline void StoreVertices4(MeshVertex *out, __m128 px, __m128 py, __m128 pz, __m128 nx, __m128 ny, __m128 nz) {
+    _MM_TRANSPOSE4_PS(px, py, pz, nx);
+    __m128 t0 = _mm_unpacklo_ps(ny, nz);
+    __m128 t1 = _mm_unpackhi_ps(ny, nz);
+    float *dst = out->position;
+    _mm_storeu_ps(dst + 0, px);
+    _mm_storeu_ps(dst + 4, _mm_movelh_ps(t0, py));
+    _mm_storeu_ps(dst + 8, _mm_shuffle_ps(py, t0, _MM_SHUFFLE(3, 2, 3, 2)));
+    _mm_storeu_ps(dst + 12, pz);
+    _mm_storeu_ps(dst + 16, _mm_movelh_ps(t1, nx));
+    _mm_storeu_ps(dst + 20, _mm_shuffle_ps(nx, t1, _MM_SHUFFLE(3, 2, 3, 2)));
+}
+
+// NOTE(pf): The same operations in the same order as UnpackOctahedralSnorm16, so the results are identical.
+static inline void OctahedralDecodeSSE2(__m128 &x, __m128 &y, __m128 &z) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    x = _mm_max_ps(_mm_div_ps(x, _mm_set1_ps(32767.0f)), _mm_set1_ps(-1.0f));
+    y = _mm_max_ps(_mm_div_ps(y, _mm_set1_ps(32767.0f)), _mm_set1_ps(-1.0f));
+    z = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(sign, x)), _mm_andnot_ps(sign, y));
+    __m128 t = _mm_min_ps(_mm_max_ps(_mm_xor_ps(z, sign), zero), one);
+    x = _mm_add_ps(x, _mm_xor_ps(t, _mm_and_ps(_mm_cmpge_ps(x, zero), sign)));
+    y = _mm_add_ps(y, _mm_xor_ps(t, _mm_and_ps(_mm_cmpge_ps(y, zero), sign)));
+    __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+    __m128 invLength = _mm_and_ps(_mm_cmpgt_ps(length, zero), _mm_div_ps(one, length));
+    x = _mm_mul_ps(x, invLength);
+    y = _mm_mul_ps(y, invLength);
+    z = _mm_mul_ps(z, invLength);
+}
+#endif
+
+#if defined(SIMD_AVX2)
+static inline void OctahedralDecodeAVX2(__m256 &x, __m256 &y, __m256 &z) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    x = _mm256_max_ps(_mm256_div_ps(x, _mm256_set1_ps(32767.0f)), _mm256_set1_ps(-1.0f));
+    y = _mm256_max_ps(_mm256_div_ps(y, _mm256_set1_ps(32767.0f)), _mm256_set1_ps(-1.0f));
+    z = _mm256_sub_ps(_mm256_sub_ps(one, _mm256_andnot_ps(sign, x)), _mm256_andnot_ps(sign, y));
+    __m256 t = _mm256_min_ps(_mm256_max_ps(_mm256_xor_ps(z, sign), zero), one);
+    x = _mm256_add_ps(x, _mm256_xor_ps(t, _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), sign)));
+    y = _mm256_add_ps(y, _mm256_xor_ps(t, _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), sign)));
+    __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+    __m256 invLength = _mm256_and_ps(_mm256_cmp_ps(length, zero, _CMP_GT_OQ), _mm256_div_ps(one, length));
+    x = _mm256_mul_ps(x, invLength);
+    y = _mm256_mul_ps(y, invLength);
+    z = _mm256_mul_ps(z, invLength);
+}
+#endif
+
+static void DequantizeVertices(const MeshCodecHeader &header, uint16_t *const quantized[VERTEX_COMPONENTS], uint32_t count,
+                               MeshVertex *out, bool simd) {
+    const uint32_t normalShift = 16 - header.normalBits;
+    uint32_t       i = 0;
+#if defined(SIMD_AVX2)
+    if (simd) {
+        __m256  positionMin[3], positionScale[3];
+        __m128i shift = _mm_cvtsi32_si128((int)normalShift);
+        for (int c = 0; c < 3; ++c) {
+            positionMin[c] = _mm256_set1_ps(header.positionMin[c]);
+            positionScale[c] = _mm256_set1_ps(header.positionScale[c]);
+        }
+        for (; i + 8 <= count; i += 8) {
+            __m256 p[3];
+            for (int c = 0; c < 3; ++c) {
+                __m256 q = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(quantized[c] + i))));
+                p[c] = _mm256_add_ps(positionMin[c], _mm256_mul_ps(q, positionScale[c]));
+            }
+            __m128i sx = _mm_sll_epi16(_mm_loadu_si128((const __m128i *)(quantized[3] + i)), shift);
+            __m128i sy = _mm_sll_epi16(_mm_loadu_si128((const __m128i *)(quantized[4] + i)), shift);
+            __m256  nx = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(sx));
+            __m256  ny = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(sy));
+            __m256  nz;
+            OctahedralDecodeAVX2(nx, ny, nz);
+            StoreVertices4(out + i, _mm256_castps256_ps128(p[0]), _mm256_castps256_ps128(p[1]), _mm256_castps256_ps128(p[2]),
+                           _mm256_castps256_ps128(nx), _mm256_castps256_ps128(ny), _mm256_castps256_ps128(nz));
+            StoreVertices4(out + i + 4, _mm256_extractf128_ps(p[0], 1), _mm256_extractf128_ps(p[1], 1), _mm256_extractf128_ps(p[2], 1),
+                           _mm256_extractf128_ps(nx, 1), _mm256_extractf128_ps(ny, 1), _mm256_extractf128_ps(nz, 1));
+        }
+    }
+#endif
+#if defined(SIMD_SSE2)
+    if (simd) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128        positionMin[3], positionScale[3];
+        __m128i       shift = _mm_cvtsi32_si128((int)normalShift);
+        for (int c = 0; c < 3; ++c) {
+            positionMin[c] = _mm_set1_ps(header.positionMin[c]);
+            positionScale[c] = _mm_set1_ps(header.positionScale[c]);
+        }
+        for (; i + 4 <= count; i += 4) {
+            __m128 p[3];
+            for (int c = 0; c < 3; ++c) {
+                __m128 q = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(quantized[c] + i)), zero));
+                p[c] = _mm_add_ps(positionMin[c], _mm_mul_ps(q, positionScale[c]));
+            }
+            // .. sign extended by moving the 16 bits to the top and shifting them back ..
+            __m128i sx = _mm_sll_epi16(_mm_loadl_epi64((const __m128i *)(quantized[3] + i)), shift);
+            __m128i sy = _mm_sll_epi16(_mm_loadl_epi64((const __m128i *)(quantized[4] + i)), shift);
+            __m128  nx = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(sx, sx), 16));
+            __m128  ny = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(sy, sy), 16));
+            __m128  nz;
+            OctahedralDecodeSSE2(nx, ny, nz);
+            StoreVertices4(out + i, p[0], p[1], p[2], nx, ny, nz);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        MeshVertex &v = out[i];
+        for (int c = 0; c < 3; ++c)
+            v.position[c] = header.positionMin[c] + (float)quantized[c][i] * header.positionScale[c];
+        uint32_t packed = (uint16_t)(quantized[3][i] << normalShift) | ((uint32_t)(uint16_t)(quantized[4][i] << normalShift) << 16);
+        UnpackOctahedralSnorm16(packed, v.normal);
+    }
+}
+
+static bool DecodeVertexChunk(const MeshCodecHeader &header, const uint8_t *src, const uint8_t *end, const MeshCodecChunk &chunk,
+                              MeshVertex *out, bool simd) {
+    alignas(16) uint8_t  low[MESH_CODEC_VERTEX_CHUNK], high[MESH_CODEC_VERTEX_CHUNK];
+    alignas(16) uint16_t quantized[VERTEX_COMPONENTS][MESH_CODEC_VERTEX_CHUNK];
+    uint32_t             padded = (chunk.count + BYTE_GROUP_SIZE - 1) & ~(BYTE_GROUP_SIZE - 1);
+    for (uint32_t c = 0; c < VERTEX_COMPONENTS; ++c) {
+        src = DecodeByteGroups(src, end, chunk.count, low, simd);
+        src = src ? DecodeByteGroups(src, end, chunk.count, high, simd) : nullptr;
+        if (!src)
+            return false;
+        UndeltaComponent(low, high, padded, quantized[c], simd);
+    }
+    uint16_t *components[VERTEX_COMPONENTS] = {quantized[0], quantized[1], quantized[2], quantized[3], quantized[4]};
+    DequantizeVertices(header, components, chunk.count, out, simd);
+    return true;
+}
+
+static bool DecodeIndexChunk(const MeshCodecHeader &header, const uint8_t *src, const uint8_t *end, const MeshCodecChunk &chunk,
+                             uint32_t *out, bool simd) {
+    alignas(16) uint8_t planes[4][MESH_CODEC_INDEX_CHUNK];
+    for (int b = 0; b < 4; ++b) {
+        src = DecodeByteGroups(src, end, chunk.count, planes[b], simd);
+        if (!src)
+            return false;
+    }
+
+    uint32_t next = chunk.base;
+    uint32_t i = 0;
+    bool     valid = true;
+#if defined(SIMD_SSE2)
+    if (simd) {
+        // .. index = next unused vertex before it - code, next counts the zero codes ..
+        const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+        const __m128i limit = _mm_xor_si128(_mm_set1_epi32((int)(header.vertexCount - 1)), bias);
+        __m128i       nextv = _mm_set1_epi32((int)next);
+        __m128i       outOfRange = _mm_setzero_si128();
+        for (; i + 16 <= chunk.count; i += 16) {
+            __m128i b0 = _mm_load_si128((const __m128i *)(planes[0] + i));
+            __m128i b1 = _mm_load_si128((const __m128i *)(planes[1] + i));
+            __m128i b2 = _mm_load_si128((const __m128i *)(planes[2] + i));
+            __m128i b3 = _mm_load_si128((const __m128i *)(planes[3] + i));
+            __m128i low01 = _mm_unpacklo_epi8(b0, b1), high01 = _mm_unpackhi_epi8(b0, b1);
+            __m128i low23 = _mm_unpacklo_epi8(b2, b3), high23 = _mm_unpackhi_epi8(b2, b3);
+            __m128i codes[4] = {_mm_unpacklo_epi16(low01, low23), _mm_unpackhi_epi16(low01, low23),
+                                _mm_unpacklo_epi16(high01, high23), _mm_unpackhi_epi16(high01, high23)};
+            for (int k = 0; k < 4; ++k) {
+                __m128i isNew = _mm_srli_epi32(_mm_cmpeq_epi32(codes[k], _mm_setzero_si128()), 31);
+                __m128i count = _mm_add_epi32(isNew, _mm_slli_si128(isNew, 4));
+                count = _mm_add_epi32(count, _mm_slli_si128(count, 8));
+                __m128i index = _mm_sub_epi32(_mm_add_epi32(nextv, _mm_sub_epi32(count, isNew)), codes[k]);
+                outOfRange = _mm_or_si128(outOfRange, _mm_cmpgt_epi32(_mm_xor_si128(index, bias), limit));
+                _mm_storeu_si128((__m128i *)(out + i + 4 * k), index);
+                nextv = _mm_add_epi32(nextv, _mm_shuffle_epi32(count, 0xFF));
+            }
+        }
+        next = (uint32_t)_mm_cvtsi128_si32(nextv);
+        valid = _mm_movemask_epi8(outOfRange) == 0;
+    }
+#endif
+    for (; i < chunk.count; ++i) {
+        uint32_t code = planes[0][i] | (planes[1][i] << 8) | (planes[2][i] << 16) | ((uint32_t)planes[3][i] << 24);
+        out[i] = next - code;
+        valid = valid && out[i] < header.vertexCount;
+        next += code == 0;
+    }
+    return valid;
+}
+
+static bool DecodeMeshInternal(const uint8_t *data, size_t size, MeshData &mesh, TaskPool *pool, bool simd) {
+    MeshCodecHeader header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != MESH_CODEC_MAGIC || header.version != MESH_CODEC_VERSION || header.normalBits < 1 ||
+        header.normalBits > 16 || header.lodCount > MESH_MAX_LODS || (header.indexCount > 0 && header.vertexCount == 0) ||
+        header.vertexChunkCount != (header.vertexCount + MESH_CODEC_VERTEX_CHUNK - 1) / MESH_CODEC_VERTEX_CHUNK ||
+        header.indexChunkCount != (header.indexCount + MESH_CODEC_INDEX_CHUNK - 1) / MESH_CODEC_INDEX_CHUNK)
+        return false;
+    const uint32_t chunkCount = header.vertexChunkCount + header.indexChunkCount;
+    if ((size - sizeof(header)) / sizeof(MeshCodecChunk) < chunkCount)
+        return false;
+    const MeshCodecChunk *chunks = (const MeshCodecChunk *)(data + sizeof(header));
+    for (uint32_t c = 0; c < chunkCount; ++c) {
+        const MeshCodecChunk &chunk = chunks[c];
+        bool                  isVertex = c < header.vertexChunkCount;
+        uint32_t              first = (isVertex ? c : c - header.vertexChunkCount) * (isVertex ? MESH_CODEC_VERTEX_CHUNK : MESH_CODEC_INDEX_CHUNK);
+        uint32_t              total = isVertex ? header.vertexCount : header.indexCount;
+        uint32_t              chunkSize = isVertex ? MESH_CODEC_VERTEX_CHUNK : MESH_CODEC_INDEX_CHUNK;
+        if ((uint64_t)chunk.offset + chunk.size > size || chunk.first != first || chunk.count != std::min(chunkSize, total - first))
+            return false;
+    }
+
+    mesh.vertices.resize(header.vertexCount);
+    mesh.indices.resize(header.indexCount);
+    mesh.lodCount = header.lodCount;
+    memcpy(mesh.lods, header.lods, sizeof(mesh.lods));
+    mesh.bounds = header.bounds;
+
+    std::atomic<bool> valid = {true};
+    auto              decodeChunks = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t c = begin; c < end; ++c) {
+            const MeshCodecChunk &chunk = chunks[c];
+            const uint8_t        *src = data + chunk.offset;
+            bool                  decoded = c < header.vertexChunkCount
+                                                ? DecodeVertexChunk(header, src, src + chunk.size, chunk, &mesh.vertices[chunk.first], simd)
+                                                : DecodeIndexChunk(header, src, src + chunk.size, chunk, &mesh.indices[chunk.first], simd);
+            if (!decoded)
+                valid = false;
+        }
+    };
+    if (pool)
+        pool->ParallelFor(chunkCount, 1, decodeChunks);
+    else
+        decodeChunks(0, chunkCount);
+    return valid;
+}
+
+bool DecodeMesh(const uint8_t *data, size_t size, MeshData &mesh, TaskPool *pool) {
+    return DecodeMeshInternal(data, size, mesh, pool, true);
+}
+
+bool DecodeMeshScalar(const uint8_t *data, size_t size, MeshData &mesh) {
+    return DecodeMeshInternal(data, size, mesh, nullptr, false);
+}
+
+bool LoadCompressedMesh(const char *path, MeshData &mesh, TaskPool *pool) {
+    std::vector<uint8_t> data;
+    return PlatformReadFile(path, data) && DecodeMesh(data.data(), data.size(), mesh, pool);
+}
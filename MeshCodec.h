@@ -0,0 +1,71 @@
+#ifndef _MESH_CODEC_H_
+#define _MESH_CODEC_H_
+
+/* Compressed meshes, what the tools and the asset pipeline store instead of the text format of models/skull.txt.
+ *
+ * Vertices are reordered by their first use in the index buffer, so the vertex streams follow the order the
+ * triangles are drawn in. Positions are quantized to positionBits against the mesh's box and normals packed
+ * octahedral like the SSAO normal target, rounded to normalBits of snorm16. Each of the five components is a
+ * stream of zigzagged deltas to the previous vertex. An index is coded as its distance below the next vertex
+ * not used yet: a vertex used for the first time is 0, one of the last few triangles' a small number, and
+ * decoding is a prefix count of the zeros. Every stream is split into byte planes and the planes into groups
+ * of 16 bytes, each stored with the fewest of 0, 2, 4 or 8 bits that hold its largest byte, behind a 2 bit
+ * header per group.
+ *
+ * NOTE(pf): There is no entropy coder past the byte groups. Huffman or ANS would shave off more but not decode
+ * at several GB/s, and the output stays byte aligned for a general purpose compressor on top.
+ *
+ * Vertices and indices are cut into chunks that decode independently. DecodeMesh spreads them over the
+ * TaskPool and decodes each with SSE2, dequantizing with AVX2 where it is compiled in. DecodeMeshScalar is the
+ * reference, both have to produce identical meshes. The format is little endian.
+ */
+
+#include "MeshData.h"
+#include "TaskPool.h"
+#include <vector>
+
+static constexpr uint32_t MESH_CODEC_MAGIC = {0x48534d45}; // "EMSH"
+static constexpr uint32_t MESH_CODEC_VERSION = {1};
+static constexpr uint32_t MESH_CODEC_VERTEX_CHUNK = {1024}; // Vertices per chunk, a multiple of 16.
+static constexpr uint32_t MESH_CODEC_INDEX_CHUNK = {3072};  // Indices per chunk, a multiple of 16.
+
+struct MeshCodecSettings {
+    uint32_t positionBits = 16; // 1 to 16.
+    uint32_t normalBits = 16;   // 1 to 16.
+};
+
+// NOTE(pf): Followed by the vertex chunks' MeshCodecChunk and the index chunks', then their data. bounds
+// already covers the quantized positions, lods are those of the input, only the vertex order changed.
+struct MeshCodecHeader {
+    uint32_t   magic;
+    uint32_t   version;
+    uint32_t   vertexCount;
+    uint32_t   indexCount;
+    uint32_t   vertexChunkCount;
+    uint32_t   indexChunkCount;
+    uint32_t   normalBits;
+    uint32_t   lodCount;
+    float      positionMin[3];
+    float      positionScale[3]; // position = positionMin + quantized * positionScale.
+    CullBounds bounds;
+    MeshLod    lods[MESH_MAX_LODS];
+};
+
+struct MeshCodecChunk {
+    uint32_t offset; // Bytes from the start of the header.
+    uint32_t size;
+    uint32_t first; // Vertex or index.
+    uint32_t count;
+    uint32_t base; // Index chunks, the next unused vertex at their first index.
+};
+
+// NOTE(pf): Vertices no index refers to are dropped.
+void EncodeMesh(const MeshData &mesh, const MeshCodecSettings &settings, std::vector<uint8_t> &out);
+
+// NOTE(pf): Return false for data that is not a mesh of this version, truncated or refers to vertices it does
+// not have, mesh is left in an unspecified state then. pool may be null.
+bool DecodeMesh(const uint8_t *data, size_t size, MeshData &mesh, TaskPool *pool);
+bool DecodeMeshScalar(const uint8_t *data, size_t size, MeshData &mesh);
+bool LoadCompressedMesh(const char *path, MeshData &mesh, TaskPool *pool);
+
+#endif //!_MESH_CODEC_H_
@@ -0,0 +1,167 @@
+/* Measures the mesh codec of MeshCodec.h on the skull, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread -ffp-contract=off MeshCodecBenchmark.cpp MeshCodec.cpp MeshData.cpp MeshSimplifier.cpp
+ *       Culling.cpp SsaoNormals.cpp TaskPool.cpp Platform_Posix.cpp Profiler.cpp Timer.cpp -o MeshCodecBenchmark
+ *   ./MeshCodecBenchmark [--model models/skull.txt] [--write models/skull.mesh]
+ *
+ * The skull is encoded at a few quantization settings. For each the compression ratio against the text file and
+ * against raw floats and 32 bit indices is reported, with the largest position and normal error of the decoded
+ * triangles, and the decode time of the scalar reference, the SIMD path on one thread and on the TaskPool. The
+ * SIMD meshes have to be identical to the reference, every position within half a quantization step, the bounds
+ * have to hold the decoded positions and truncated data has to be rejected. The exit code is 1 if a check fails.
+ */
+
+#include "MeshCodec.h"
+#include "TaskPool.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr MeshCodecSettings SETTINGS[] = {{16, 16}, {14, 12}, {12, 10}};
+static constexpr uint32_t          DECODE_ITERATIONS = {50};
+static constexpr uint32_t          SCALAR_ITERATIONS = {10};
+
+template <typename F> static double MeasureMs(uint32_t iterations, F run) {
+    int64_t start = HiResPerformanceQuery();
+    for (uint32_t i = 0; i < iterations; ++i)
+        run();
+    return HiResMilliseconds(HiResPerformanceQuery() - start) / iterations;
+}
+
+static long FileSize(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static bool SameMesh(const MeshData &a, const MeshData &b) {
+    return a.vertices.size() == b.vertices.size() && a.indices == b.indices &&
+           memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(MeshVertex)) == 0;
+}
+
+// .. compares the triangles, the decoded vertices are in another order ..
+static bool MeasureErrors(const MeshData &original, const MeshData &decoded, const float halfStep[3],
+                          float &maxPositionError, float &maxNormalDegrees) {
+    bool withinBounds = original.indices.size() == decoded.indices.size();
+    maxPositionError = 0.0f;
+    maxNormalDegrees = 0.0f;
+    for (size_t i = 0; withinBounds && i < original.indices.size(); ++i) {
+        const MeshVertex &a = original.vertices[original.indices[i]];
+        const MeshVertex &b = decoded.vertices[decoded.indices[i]];
+        float             dot = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+            float error = fabsf(a.position[c] - b.position[c]);
+            maxPositionError = Max(maxPositionError, error);
+            withinBounds = withinBounds && error <= halfStep[c] * 1.001f + 1e-6f;
+            dot += a.normal[c] * b.normal[c];
+        }
+        float length = sqrtf(a.normal[0] * a.normal[0] + a.normal[1] * a.normal[1] + a.normal[2] * a.normal[2]);
+        maxNormalDegrees = Max(maxNormalDegrees, acosf(Clamp(dot / length, -1.0f, 1.0f)) * 57.2957795f);
+    }
+    return withinBounds;
+}
+
+static bool BoundsHoldPositions(const MeshData &mesh) {
+    const CullBounds &b = mesh.bounds;
+    for (const MeshVertex &v : mesh.vertices) {
+        float d2 = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+            if (v.position[c] < b.aabbMin[c] || v.position[c] > b.aabbMax[c])
+                return false;
+            d2 += (v.position[c] - b.center[c]) * (v.position[c] - b.center[c]);
+        }
+        if (sqrtf(d2) > b.radius * 1.0001f)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *modelPath = "models/skull.txt";
+    const char *writePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+        else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc)
+            writePath = argv[++i];
+    }
+
+    MeshData mesh;
+    int64_t  loadStart = HiResPerformanceQuery();
+    if (!LoadTextMesh(modelPath, mesh)) {
+        fprintf(stderr, "Failed to load %s\n", modelPath);
+        return 1;
+    }
+    double textLoadMs = HiResMilliseconds(HiResPerformanceQuery() - loadStart);
+
+    TaskPool pool;
+    pool.Initialize();
+
+    const long   textBytes = FileSize(modelPath);
+    const size_t rawBytes = mesh.vertices.size() * sizeof(MeshVertex) + mesh.indices.size() * sizeof(uint32_t);
+    uint32_t     failures = 0;
+    printf("{\"benchmark\": \"mesh_codec\", \"vertices\": %zu, \"indices\": %zu, \"lods\": %u, \"text_bytes\": %ld, "
+           "\"raw_bytes\": %zu, \"text_load_ms\": %.3f, \"threads\": %u, \"runs\": [",
+           mesh.vertices.size(), mesh.indices.size(), mesh.lodCount, textBytes, rawBytes, textLoadMs, pool.ThreadCount());
+    for (size_t s = 0; s < sizeof(SETTINGS) / sizeof(SETTINGS[0]); ++s) {
+        const MeshCodecSettings &settings = SETTINGS[s];
+        std::vector<uint8_t>     encoded;
+        double                   encodeMs = MeasureMs(1, [&]() { EncodeMesh(mesh, settings, encoded); });
+
+        MeshData reference, simd, threaded;
+        bool     decoded = DecodeMeshScalar(encoded.data(), encoded.size(), reference);
+        double   scalarMs = MeasureMs(SCALAR_ITERATIONS, [&]() { DecodeMeshScalar(encoded.data(), encoded.size(), reference); });
+        decoded = decoded && DecodeMesh(encoded.data(), encoded.size(), simd, nullptr);
+        double simdMs = MeasureMs(DECODE_ITERATIONS, [&]() { DecodeMesh(encoded.data(), encoded.size(), simd, nullptr); });
+        decoded = decoded && DecodeMesh(encoded.data(), encoded.size(), threaded, &pool);
+        double threadedMs = MeasureMs(DECODE_ITERATIONS, [&]() { DecodeMesh(encoded.data(), encoded.size(), threaded, &pool); });
+        bool   identical = decoded && SameMesh(reference, simd) && SameMesh(reference, threaded);
+
+        MeshCodecHeader header;
+        memcpy(&header, encoded.data(), sizeof(header));
+        float halfStep[3] = {0.5f * header.positionScale[0], 0.5f * header.positionScale[1], 0.5f * header.positionScale[2]};
+        float maxPositionError = 0.0f, maxNormalDegrees = 0.0f;
+        bool  withinStep = decoded && MeasureErrors(mesh, reference, halfStep, maxPositionError, maxNormalDegrees);
+        bool  lodsKept = reference.lodCount == mesh.lodCount && memcmp(reference.lods, mesh.lods, sizeof(mesh.lods)) == 0;
+        bool  boundsHold = BoundsHoldPositions(reference);
+
+        // .. anything cut short has to be rejected, not read past its end ..
+        bool         rejectsTruncated = true;
+        const size_t truncatedSizes[] = {0, sizeof(MeshCodecHeader) - 1, encoded.size() / 2, encoded.size() - 1};
+        for (size_t size : truncatedSizes) {
+            MeshData truncated;
+            rejectsTruncated = rejectsTruncated && !DecodeMesh(encoded.data(), size, truncated, nullptr);
+        }
+
+        failures += !identical + !withinStep + !lodsKept + !boundsHold + !rejectsTruncated;
+        double gb = rawBytes / 1e9;
+        printf("%s\n  {\"position_bits\": %u, \"normal_bits\": %u, \"bytes\": %zu, \"ratio_vs_text\": %.2f, "
+               "\"ratio_vs_raw\": %.2f, \"bits_per_vertex\": %.2f, \"encode_ms\": %.3f, \"max_position_error\": %.6f, "
+               "\"max_normal_error_degrees\": %.4f, \"scalar_ms\": %.3f, \"simd_ms\": %.3f, \"simd_threaded_ms\": %.3f, "
+               "\"scalar_gb_per_s\": %.2f, \"simd_gb_per_s\": %.2f, \"simd_threaded_gb_per_s\": %.2f, \"identical\": %s, "
+               "\"within_half_step\": %s, \"lods_kept\": %s, \"bounds_hold\": %s, \"rejects_truncated\": %s}",
+               s == 0 ? "" : ",", settings.positionBits, settings.normalBits, encoded.size(), (double)textBytes / encoded.size(),
+               (double)rawBytes / encoded.size(), 8.0 * encoded.size() / mesh.vertices.size(), encodeMs, maxPositionError,
+               maxNormalDegrees, scalarMs, simdMs, threadedMs, gb / (scalarMs * 1e-3), gb / (simdMs * 1e-3),
+               gb / (threadedMs * 1e-3), identical ? "true" : "false", withinStep ? "true" : "false",
+               lodsKept ? "true" : "false", boundsHold ? "true" : "false", rejectsTruncated ? "true" : "false");
+
+        if (s == 0 && writePath && !PlatformWriteFile(writePath, encoded.data(), encoded.size())) {
+            fprintf(stderr, "Failed to write %s\n", writePath);
+            failures++;
+        }
+    }
+    printf("\n]}\n");
+    pool.CleanUp();
+
+    if (failures) {
+        fprintf(stderr, "%u checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
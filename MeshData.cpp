@@ -0,0 +1,49 @@
+#include "MeshData.h"
+#include <stdio.h>
+
+bool LoadTextMesh(const char *path, MeshData &mesh) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    unsigned int vertexCount = 0, triangleCount = 0;
+    bool         valid = fscanf(file, " VertexCount: %u TriangleCount: %u VertexList (pos, normal) {", &vertexCount, &triangleCount) == 2;
+
+    mesh.vertices.resize(valid ? vertexCount : 0);
+    for (unsigned int i = 0; valid && i < vertexCount; ++i) {
+        MeshVertex &v = mesh.vertices[i];
+        valid = fscanf(file, "%f %f %f %f %f %f", &v.position[0], &v.position[1], &v.position[2],
+                       &v.normal[0], &v.normal[1], &v.normal[2]) == 6;
+    }
+
+    valid = valid && fscanf(file, " } TriangleList {") == 0;
+    mesh.indices.resize(valid ? triangleCount * 3 : 0);
+    for (unsigned int i = 0; valid && i < triangleCount; ++i) {
+        valid = fscanf(file, "%u %u %u", &mesh.indices[i * 3 + 0], &mesh.indices[i * 3 + 1], &mesh.indices[i * 3 + 2]) == 3;
+        for (int k = 0; valid && k < 3; ++k)
+            valid = mesh.indices[i * 3 + k] < vertexCount;
+    }
+    fclose(file);
+
+    if (!valid) {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        return false;
+    }
+
+    BuildMeshBoundsAndLods(mesh);
+    return true;
+}
+
+void BuildMeshBoundsAndLods(MeshData &mesh) {
+    ComputeCullBounds(mesh.vertices[0].position, sizeof(MeshVertex), nullptr, mesh.vertices.size(), mesh.bounds);
+
+    MeshSimplifyInput simplifyInput = {};
+    simplifyInput.positions = mesh.vertices[0].position;
+    simplifyInput.normals = mesh.vertices[0].normal;
+    simplifyInput.vertexStride = sizeof(MeshVertex);
+    simplifyInput.vertexCount = mesh.vertices.size();
+    simplifyInput.indices = mesh.indices.data();
+    simplifyInput.indexCount = mesh.indices.size();
+    mesh.lodCount = BuildMeshLodChain(simplifyInput, mesh.indices, mesh.lods);
+}
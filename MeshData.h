@@ -0,0 +1,27 @@
+#ifndef _MESH_DATA_H_
+#define _MESH_DATA_H_
+
+#include "Common.h"
+#include "Culling.h"
+#include "MeshSimplifier.h"
+#include <vector>
+
+// NOTE(pf): Api independent copy of a render mesh, used by the software backend and the tools.
+struct MeshVertex {
+    float position[3];
+    float normal[3];
+};
+
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t>   indices; // LOD 0 followed by the rest of the LOD chain.
+    MeshLod                 lods[MESH_MAX_LODS] = {};
+    uint32_t                lodCount = 0;
+    CullBounds              bounds = {};
+};
+
+// NOTE(pf): Reads the text format of models/skull.txt and builds bounds and the LOD chain.
+bool LoadTextMesh(const char *path, MeshData &mesh);
+void BuildMeshBoundsAndLods(MeshData &mesh);
+
+#endif //!_MESH_DATA_H_
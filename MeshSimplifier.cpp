@@ -0,0 +1,420 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+static constexpr int      ATTRIBUTE_COUNT = 6;
+static constexpr uint32_t CLUSTER_END = {0xFFFFFFFF};
+
+static const float *StridedFloat3(const float *base, size_t stride, size_t index) {
+    return (const float *)((const uint8_t *)base + stride * index);
+}
+
+static void QuadricAdd(MeshQuadric &q, const MeshQuadric &r) {
+    for (int i = 0; i < 21; ++i)
+        q.a[i] += r.a[i];
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i)
+        q.b[i] += r.b[i];
+    q.c += r.c;
+}
+
+// v^T A v + 2 b.v + c
+static float QuadricError(const MeshQuadric &q, const MeshQuadric &r, const float *v) {
+    float result = q.c + r.c;
+    int   k = 0;
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i) {
+        result += (q.a[k] + r.a[k]) * v[i] * v[i];
+        ++k;
+        for (int j = i + 1; j < ATTRIBUTE_COUNT; ++j, ++k) {
+            result += 2.0f * (q.a[k] + r.a[k]) * v[i] * v[j];
+        }
+        result += 2.0f * (q.b[i] + r.b[i]) * v[i];
+    }
+    return Max(result, 0.0f);
+}
+
+static float Dot(const float *a, const float *b) {
+    float result = 0.0f;
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i)
+        result += a[i] * b[i];
+    return result;
+}
+
+// NOTE(pf): Generalized plane quadric for the triangle (p, q, r) in attribute space: squared
+// distance to the 2D plane spanned by the triangle, weighted by its positional area.
+static bool TriangleQuadric(const float *p, const float *q, const float *r, MeshQuadric &result) {
+    float e1[ATTRIBUTE_COUNT];
+    float e2[ATTRIBUTE_COUNT];
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i) {
+        e1[i] = q[i] - p[i];
+        e2[i] = r[i] - p[i];
+    }
+
+    float ux = e1[1] * e2[2] - e1[2] * e2[1];
+    float uy = e1[2] * e2[0] - e1[0] * e2[2];
+    float uz = e1[0] * e2[1] - e1[1] * e2[0];
+    float area = 0.5f * sqrtf(ux * ux + uy * uy + uz * uz);
+
+    float len1 = sqrtf(Dot(e1, e1));
+    if (len1 < 1e-12f || area < 1e-12f)
+        return false;
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i)
+        e1[i] /= len1;
+
+    float d = Dot(e1, e2);
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i)
+        e2[i] -= d * e1[i];
+    float len2 = sqrtf(Dot(e2, e2));
+    if (len2 < 1e-12f)
+        return false;
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i)
+        e2[i] /= len2;
+
+    float pe1 = Dot(p, e1);
+    float pe2 = Dot(p, e2);
+
+    int k = 0;
+    for (int i = 0; i < ATTRIBUTE_COUNT; ++i) {
+        for (int j = i; j < ATTRIBUTE_COUNT; ++j, ++k) {
+            float identity = (i == j) ? 1.0f : 0.0f;
+            result.a[k] = area * (identity - e1[i] * e1[j] - e2[i] * e2[j]);
+        }
+        result.b[i] = area * (pe1 * e1[i] + pe2 * e2[i] - p[i]);
+    }
+    result.c = area * (Dot(p, p) - pe1 * pe1 - pe2 * pe2);
+    return true;
+}
+
+static float Dot3(const float *a, const float *b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// NOTE(pf): After Ericson, Real-Time Collision Detection 5.1.5.
+float MeshPointTriangleDistanceSq(const float *p, const float *a, const float *b, const float *c) {
+    float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    float ap[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+    float d1 = Dot3(ab, ap);
+    float d2 = Dot3(ac, ap);
+    float v = 0.0f, w = 0.0f;
+    if (d1 > 0.0f || d2 > 0.0f) {
+        float bp[3] = {p[0] - b[0], p[1] - b[1], p[2] - b[2]};
+        float cp[3] = {p[0] - c[0], p[1] - c[1], p[2] - c[2]};
+        float d3 = Dot3(ab, bp), d4 = Dot3(ac, bp);
+        float d5 = Dot3(ab, cp), d6 = Dot3(ac, cp);
+        float va = d3 * d6 - d5 * d4, vb = d5 * d2 - d1 * d6, vc = d1 * d4 - d3 * d2;
+        if (d3 >= 0.0f && d4 <= d3) {
+            v = 1.0f;
+        } else if (d6 >= 0.0f && d5 <= d6) {
+            w = 1.0f;
+        } else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+            v = d1 / (d1 - d3);
+        } else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+            w = d2 / (d2 - d6);
+        } else if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+            w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            v = 1.0f - w;
+        } else {
+            float denom = 1.0f / (va + vb + vc);
+            v = vb * denom;
+            w = vc * denom;
+        }
+    }
+    float offset[3];
+    for (int k = 0; k < 3; ++k)
+        offset[k] = a[k] + ab[k] * v + ac[k] * w - p[k];
+    return Dot3(offset, offset);
+}
+
+static void TriangleNormal(const float *a, const float *b, const float *c, float *n) {
+    float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+void MeshSimplifier::Initialize(const MeshSimplifyInput &input) {
+    vertexCount = input.vertexCount;
+    indices.assign(input.indices, input.indices + input.indexCount);
+    error = 0.0f;
+
+    float vMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float vMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const float *p = StridedFloat3(input.positions, input.vertexStride, i);
+        for (int k = 0; k < 3; ++k) {
+            vMin[k] = p[k] < vMin[k] ? p[k] : vMin[k];
+            vMax[k] = p[k] > vMax[k] ? p[k] : vMax[k];
+        }
+    }
+    scale = Max(Max(vMax[0] - vMin[0], vMax[1] - vMin[1]), vMax[2] - vMin[2]);
+    scale = scale > 0.0f ? scale : 1.0f;
+    // NOTE(pf): Same sphere as ComputeCullBounds, around the box center out to the farthest vertex.
+    float boundsRadiusSq = 0.0f;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const float *p = StridedFloat3(input.positions, input.vertexStride, i);
+        float        d[3] = {p[0] - 0.5f * (vMin[0] + vMax[0]), p[1] - 0.5f * (vMin[1] + vMax[1]),
+                             p[2] - 0.5f * (vMin[2] + vMax[2])};
+        boundsRadiusSq = Max(boundsRadiusSq, Dot3(d, d));
+    }
+    boundsRadius = sqrtf(boundsRadiusSq);
+    float invScale = 1.0f / scale;
+
+    attributes.resize(vertexCount * ATTRIBUTE_COUNT);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const float *p = StridedFloat3(input.positions, input.vertexStride, i);
+        const float *n = StridedFloat3(input.normals, input.vertexStride, i);
+        float       *v = &attributes[i * ATTRIBUTE_COUNT];
+        for (int k = 0; k < 3; ++k) {
+            v[k] = (p[k] - vMin[k]) * invScale;
+            v[3 + k] = n[k] * input.normalWeight;
+        }
+    }
+
+    quadrics.assign(vertexCount, MeshQuadric{});
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        MeshQuadric q;
+        if (!TriangleQuadric(&attributes[indices[t + 0] * ATTRIBUTE_COUNT],
+                             &attributes[indices[t + 1] * ATTRIBUTE_COUNT],
+                             &attributes[indices[t + 2] * ATTRIBUTE_COUNT], q)) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k)
+            QuadricAdd(quadrics[indices[t + k]], q);
+    }
+
+    locked.assign(vertexCount, 0);
+    touched.assign(vertexCount, 0);
+    remap.resize(vertexCount);
+    clusterNext.assign(vertexCount, CLUSTER_END);
+}
+
+void MeshSimplifier::BuildAdjacency() {
+    adjacencyOffsets.assign(vertexCount + 1, 0);
+    for (uint32_t index : indices)
+        ++adjacencyOffsets[index + 1];
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    adjacency.resize(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+        adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+}
+
+// NOTE(pf): Squared distance of the original vertex to the nearest triangle around vertex, with from standing in
+// for to when to is set. Triangles that the collapse makes degenerate are skipped.
+float MeshSimplifier::RingDistanceSq(uint32_t original, uint32_t vertex, uint32_t from, uint32_t to) const {
+    const float *p = &attributes[original * ATTRIBUTE_COUNT];
+    float        bestSq = FLT_MAX;
+    for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i) {
+        const uint32_t *tri = &indices[adjacency[i] * 3];
+        uint32_t        corners[3];
+        for (int k = 0; k < 3; ++k)
+            corners[k] = tri[k] == from ? to : tri[k];
+        if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+            continue;
+        bestSq = Min(bestSq, MeshPointTriangleDistanceSq(p, &attributes[corners[0] * ATTRIBUTE_COUNT],
+                                                         &attributes[corners[1] * ATTRIBUTE_COUNT],
+                                                         &attributes[corners[2] * ATTRIBUTE_COUNT]));
+    }
+    return bestSq;
+}
+
+// .. the farthest original vertex collapsed into from would be from the triangles around to ..
+float MeshSimplifier::CollapseErrorSq(uint32_t from, uint32_t to) const {
+    float errorSq = 0.0f;
+    for (uint32_t original = from; original != CLUSTER_END; original = clusterNext[original]) {
+        float distanceSq = Min(RingDistanceSq(original, from, from, to), RingDistanceSq(original, to, from, to));
+        errorSq = Max(errorSq, distanceSq);
+    }
+    return errorSq;
+}
+
+// NOTE(pf): Searches the triangles around the vertex an original vertex was collapsed into and, when they are
+// not close enough to rule it out as the farthest, the triangles around their corners too.
+float MeshSimplifier::MeasureErrorSq() const {
+    float errorSq = 0.0f;
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        if (adjacencyOffsets[v] == adjacencyOffsets[v + 1])
+            continue;
+        for (uint32_t original = clusterNext[v]; original != CLUSTER_END; original = clusterNext[original]) {
+            float distanceSq = RingDistanceSq(original, v, CLUSTER_END, CLUSTER_END);
+            for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v + 1] && distanceSq > errorSq; ++i) {
+                const uint32_t *tri = &indices[adjacency[i] * 3];
+                for (int k = 0; k < 3; ++k) {
+                    if (tri[k] != v)
+                        distanceSq = Min(distanceSq, RingDistanceSq(original, tri[k], CLUSTER_END, CLUSTER_END));
+                }
+            }
+            errorSq = Max(errorSq, distanceSq);
+        }
+    }
+    return errorSq;
+}
+
+struct EdgeCollapse {
+    float    cost;
+    uint32_t from;
+    uint32_t to;
+};
+
+float MeshSimplifier::Simplify(size_t targetIndexCount, float maxError) {
+    float                     maxErrorSq = maxError < FLT_MAX ? (maxError / scale) * (maxError / scale) : FLT_MAX;
+    std::vector<uint64_t>     edges;
+    std::vector<EdgeCollapse> collapses;
+
+    while (indices.size() > targetIndexCount) {
+        size_t triangleCount = indices.size() / 3;
+        size_t targetTriangles = targetIndexCount / 3;
+
+        // .. unique edges, an edge used by a single triangle is a border and its vertices stay put ..
+        edges.clear();
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            for (int k = 0; k < 3; ++k) {
+                uint64_t a = indices[t + k];
+                uint64_t b = indices[t + (k + 1) % 3];
+                edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        std::fill(locked.begin(), locked.end(), (uint8_t)0);
+        size_t uniqueCount = 0;
+        for (size_t i = 0; i < edges.size();) {
+            size_t j = i + 1;
+            while (j < edges.size() && edges[j] == edges[i])
+                ++j;
+            if (j - i == 1) {
+                locked[(uint32_t)(edges[i] >> 32)] = 1;
+                locked[(uint32_t)(edges[i] & 0xFFFFFFFF)] = 1;
+            }
+            edges[uniqueCount++] = edges[i];
+            i = j;
+        }
+        edges.resize(uniqueCount);
+
+        BuildAdjacency();
+
+        // .. cheapest direction of every edge ..
+        collapses.clear();
+        for (uint64_t edge : edges) {
+            uint32_t a = (uint32_t)(edge >> 32);
+            uint32_t b = (uint32_t)(edge & 0xFFFFFFFF);
+            if (locked[a] && locked[b])
+                continue;
+
+            float costAB = locked[a] ? FLT_MAX : QuadricError(quadrics[a], quadrics[b], &attributes[b * ATTRIBUTE_COUNT]);
+            float costBA = locked[b] ? FLT_MAX : QuadricError(quadrics[a], quadrics[b], &attributes[a * ATTRIBUTE_COUNT]);
+            EdgeCollapse collapse = costAB <= costBA ? EdgeCollapse{costAB, a, b} : EdgeCollapse{costBA, b, a};
+            if (collapse.cost < FLT_MAX)
+                collapses.push_back(collapse);
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const EdgeCollapse &l, const EdgeCollapse &r) { return l.cost < r.cost; });
+
+        // .. greedily collapse, a collapse locks the one-rings of both endpoints for this pass ..
+        for (size_t v = 0; v < vertexCount; ++v)
+            remap[v] = (uint32_t)v;
+        std::fill(touched.begin(), touched.end(), (uint8_t)0);
+
+        size_t removed = 0;
+        size_t collapsed = 0;
+        for (const EdgeCollapse &collapse : collapses) {
+            if (triangleCount - removed <= targetTriangles)
+                break;
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // NOTE(pf): Reject collapses that flip any surviving triangle around the removed vertex.
+            bool         flips = false;
+            size_t       edgeTriangles = 0;
+            const float *pTo = &attributes[collapse.to * ATTRIBUTE_COUNT];
+            for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1] && !flips; ++i) {
+                const uint32_t *tri = &indices[adjacency[i] * 3];
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+                    ++edgeTriangles;
+                    continue;
+                }
+
+                const float *p[3];
+                const float *q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = &attributes[tri[k] * ATTRIBUTE_COUNT];
+                    q[k] = tri[k] == collapse.from ? pTo : p[k];
+                }
+                float n0[3], n1[3];
+                TriangleNormal(p[0], p[1], p[2], n0);
+                TriangleNormal(q[0], q[1], q[2], n1);
+                flips = (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2]) <= 0.0f;
+            }
+            if (flips)
+                continue;
+            if (maxErrorSq < FLT_MAX && CollapseErrorSq(collapse.from, collapse.to) > maxErrorSq)
+                continue;
+
+            // .. from's cluster joins to's, right after to ..
+            uint32_t tail = collapse.from;
+            while (clusterNext[tail] != CLUSTER_END)
+                tail = clusterNext[tail];
+            clusterNext[tail] = clusterNext[collapse.to];
+            clusterNext[collapse.to] = collapse.from;
+
+            remap[collapse.from] = collapse.to;
+            QuadricAdd(quadrics[collapse.to], quadrics[collapse.from]);
+            removed += edgeTriangles;
+            ++collapsed;
+
+            uint32_t ends[2] = {collapse.from, collapse.to};
+            for (uint32_t v : ends) {
+                for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v + 1]; ++i) {
+                    const uint32_t *tri = &indices[adjacency[i] * 3];
+                    touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+                }
+            }
+        }
+
+        if (collapsed == 0)
+            break;
+
+        // .. rewrite the index list, dropping triangles that became degenerate ..
+        size_t writeIndex = 0;
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            uint32_t a = remap[indices[t + 0]];
+            uint32_t b = remap[indices[t + 1]];
+            uint32_t c = remap[indices[t + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            indices[writeIndex++] = a;
+            indices[writeIndex++] = b;
+            indices[writeIndex++] = c;
+        }
+        indices.resize(writeIndex);
+    }
+
+    // NOTE(pf): The quadrics only order the collapses, they sum area weighted squares over attributes and are
+    // no distance. The error is measured on the result instead, against every original vertex.
+    BuildAdjacency();
+    error = Max(error, sqrtf(MeasureErrorSq()) * scale);
+    return error;
+}
+
+uint32_t BuildMeshLodChain(const MeshSimplifyInput &input, std::vector<uint32_t> &indices, MeshLod lods[MESH_MAX_LODS]) {
+    lods[0] = {(uint32_t)input.indexCount, 0, 0.0f};
+    uint32_t lodCount = 1;
+
+    MeshSimplifier simplifier;
+    simplifier.Initialize(input);
+    float maxError = MESH_LOD_MAX_ERROR_RATIO * simplifier.boundsRadius;
+    for (int lod = 1; lod < MESH_MAX_LODS; ++lod) {
+        uint32_t previousCount = lods[lod - 1].indexCount;
+        float    lodError = simplifier.Simplify((previousCount / 6) * 3, maxError);
+        if (simplifier.indices.size() >= previousCount || lodError > maxError)
+            break;
+
+        lods[lod] = {(uint32_t)simplifier.indices.size(), (uint32_t)indices.size(), lodError};
+        lodCount++;
+        indices.insert(indices.end(), simplifier.indices.begin(), simplifier.indices.end());
+    }
+    return lodCount;
+}
@@ -0,0 +1,103 @@
+#ifndef _MESH_SIMPLIFIER_H_
+#define _MESH_SIMPLIFIER_H_
+
+/* Quadric error metric edge-collapse simplifier, based on $SOURCE
+ * SOURCE: Garland & Heckbert, "Simplifying Surfaces with Color and Texture using Quadric Error Metrics"
+ *
+ * NOTE(pf): Collapses snap one endpoint onto the other (half-edge collapse), vertices are never
+ * moved or created. Every LOD therefore indexes into the original vertex buffer and the whole
+ * chain can be appended to a single index buffer.
+ */
+
+#include "Common.h"
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+static constexpr int   MESH_MAX_LODS = 6;
+static constexpr float MESH_LOD_MAX_ERROR_RATIO = 0.25f; // Of the bounds radius, no LOD is coarser than that.
+
+struct MeshSimplifyInput {
+    const float    *positions = nullptr; // xyz, vertexStride bytes apart.
+    const float    *normals = nullptr;   // xyz, vertexStride bytes apart.
+    size_t          vertexStride = 0;
+    size_t          vertexCount = 0;
+    const uint32_t *indices = nullptr;
+    size_t          indexCount = 0;
+    // NOTE(pf): How much a unit change in normal costs relative to moving across the whole mesh.
+    float normalWeight = 0.1f;
+};
+
+struct MeshQuadric {
+    // Symmetric 6x6 matrix stored as its upper triangle, row by row.
+    float a[21];
+    float b[6];
+    float c;
+};
+
+struct MeshSimplifier {
+    void Initialize(const MeshSimplifyInput &input);
+
+    // NOTE(pf): Continues from the current state, so successive calls with decreasing targets
+    // produce an LOD chain where the error accumulates correctly. Returns the object space error: how far
+    // the farthest original vertex is from the triangles near the vertex it was collapsed into, which
+    // bounds its distance to the simplified surface. Collapses that would take an original vertex further
+    // than maxError from the triangles around it are skipped.
+    float Simplify(size_t targetIndexCount, float maxError = FLT_MAX);
+
+    std::vector<uint32_t> indices;
+    float                 error = 0.0f;
+
+    // NOTE(pf): Attribute vectors are (x, y, z, nx, ny, nz), positions normalized to the unit box.
+    std::vector<float>       attributes;
+    std::vector<MeshQuadric> quadrics;
+    std::vector<uint8_t>     locked;
+    std::vector<uint8_t>     touched;
+    std::vector<uint32_t>    remap;
+    std::vector<uint32_t>    adjacencyOffsets;
+    std::vector<uint32_t>    adjacency;
+    std::vector<uint32_t>    clusterNext; // Original vertices collapsed into a vertex, listed after it.
+    size_t                   vertexCount = 0;
+    float                    scale = 1.0f;
+    float                    boundsRadius = 0.0f; // Object space, the farthest vertex from the center of the bounds.
+
+  private:
+    void  BuildAdjacency();
+    float RingDistanceSq(uint32_t original, uint32_t vertex, uint32_t from, uint32_t to) const;
+    float CollapseErrorSq(uint32_t from, uint32_t to) const;
+    float MeasureErrorSq() const;
+};
+
+// NOTE(pf): Squared distance from p to the closest point of the triangle abc, only xyz are read.
+float MeshPointTriangleDistanceSq(const float *p, const float *a, const float *b, const float *c);
+
+// NOTE(pf): Size in pixels of an object space error seen at distance with a vertical fov in radians.
+inline float ProjectedMeshError(float error, float distance, float fovY, float viewportHeight) {
+    float pixelsPerUnit = viewportHeight / (2.0f * tanf(0.5f * fovY));
+    return error * pixelsPerUnit / Max(distance, 1e-6f);
+}
+
+struct MeshLod {
+    uint32_t indexCount;
+    uint32_t startIndexLoc;
+    float    error; // Object space, see MeshSimplifier.
+};
+
+// NOTE(pf): LOD 0 is the input, every further level halves the triangle count of the previous one and is
+// appended to indices, until a level's error would pass MESH_LOD_MAX_ERROR_RATIO of the bounds radius.
+// input.indices may point into indices, it is read before anything is appended. Returns the number of LODs.
+uint32_t BuildMeshLodChain(const MeshSimplifyInput &input, std::vector<uint32_t> &indices, MeshLod lods[MESH_MAX_LODS]);
+
+// NOTE(pf): Picks the coarsest LOD whose error projects to at most pixelThreshold pixels.
+inline uint32_t SelectMeshLod(const MeshLod *lods, uint32_t lodCount, float distance, float fovY, float viewportHeight,
+                              float pixelThreshold = 1.0f) {
+    uint32_t result = 0;
+    for (uint32_t i = 1; i < lodCount; ++i) {
+        if (ProjectedMeshError(lods[i].error, distance, fovY, viewportHeight) > pixelThreshold)
+            break;
+        result = i;
+    }
+    return result;
+}
+
+#endif //!_MESH_SIMPLIFIER_H_
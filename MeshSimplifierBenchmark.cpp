@@ -0,0 +1,168 @@
+/* Measures the LOD chain of MeshSimplifier.h on the skull, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -ffp-contract=off MeshSimplifierBenchmark.cpp MeshSimplifier.cpp MeshData.cpp Culling.cpp
+ *       Timer.cpp Platform_Posix.cpp -o MeshSimplifierBenchmark
+ *   ./MeshSimplifierBenchmark [--model models/skull.txt]
+ *
+ * The chain is built a few times and timed in input triangles per second. For every LOD the error the simplifier
+ * reports is compared against the distance of every original vertex to the nearest of all the LOD's triangles,
+ * searched for over a grid of them: the reported error must not be below it, or LOD selection would show
+ * more than its pixel threshold, nor far above it, or the LODs would be picked later than they could be, and the
+ * last LOD has to stay clear of the bounds radius. Prints JSON, the exit code is 1 if a check fails.
+ */
+
+#include "MeshData.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t CHAIN_ITERATIONS = {3};
+static constexpr uint32_t GRID_CELLS = {32}; // Per axis, of the grid the measured distances search.
+static constexpr float    ERROR_SLACK = {1e-5f};    // Float noise of the distances, relative to the bounds radius.
+static constexpr float    MAX_OVERESTIMATE = {2.0f}; // How much larger than measured the reported error may be.
+
+static uint32_t        failures = 0;
+static volatile size_t sink = 0;
+
+static void Check(bool condition, const char *what) {
+    if (!condition) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// .. triangles binned into every cell their bounds overlap, points search outwards ring by ring ..
+struct TriangleGrid {
+    void Build(const MeshData &mesh, const uint32_t *indices, uint32_t indexCount) {
+        vertices = &mesh.vertices;
+        tris = indices;
+        for (int k = 0; k < 3; ++k) {
+            origin[k] = mesh.bounds.aabbMin[k];
+            extent = Max(extent, mesh.bounds.aabbMax[k] - mesh.bounds.aabbMin[k]);
+        }
+        cellSize = extent / GRID_CELLS * 1.0001f;
+        std::vector<std::vector<uint32_t>> cells(GRID_CELLS * GRID_CELLS * GRID_CELLS);
+        for (uint32_t t = 0; t + 2 < indexCount; t += 3) {
+            int lo[3], hi[3];
+            for (int k = 0; k < 3; ++k) {
+                float a = Position(indices[t])[k], b = Position(indices[t + 1])[k], c = Position(indices[t + 2])[k];
+                lo[k] = Cell(Min(Min(a, b), c), k);
+                hi[k] = Cell(Max(Max(a, b), c), k);
+            }
+            for (int z = lo[2]; z <= hi[2]; ++z)
+                for (int y = lo[1]; y <= hi[1]; ++y)
+                    for (int x = lo[0]; x <= hi[0]; ++x)
+                        cells[(z * GRID_CELLS + y) * GRID_CELLS + x].push_back(t);
+        }
+        cellOffsets.assign(cells.size() + 1, 0);
+        cellTriangles.clear();
+        for (size_t c = 0; c < cells.size(); ++c) {
+            cellTriangles.insert(cellTriangles.end(), cells[c].begin(), cells[c].end());
+            cellOffsets[c + 1] = (uint32_t)cellTriangles.size();
+        }
+    }
+
+    const float *Position(uint32_t index) const { return (*vertices)[index].position; }
+    int          Cell(float value, int axis) const {
+        int cell = (int)((value - origin[axis]) / cellSize);
+        return cell < 0 ? 0 : cell >= (int)GRID_CELLS ? (int)GRID_CELLS - 1 : cell;
+    }
+
+    float Distance(const float *p) const {
+        int   center[3] = {Cell(p[0], 0), Cell(p[1], 1), Cell(p[2], 2)};
+        float bestSq = FLT_MAX;
+        for (int ring = 0; ring < (int)GRID_CELLS; ++ring) {
+            // NOTE(pf): Everything in ring r is at least (r - 1) cells away, stop once that cannot win.
+            float reach = (ring - 1) * cellSize;
+            if (ring > 1 && reach * reach > bestSq)
+                break;
+            for (int z = center[2] - ring; z <= center[2] + ring; ++z) {
+                for (int y = center[1] - ring; y <= center[1] + ring; ++y) {
+                    for (int x = center[0] - ring; x <= center[0] + ring; ++x) {
+                        bool shell = abs(x - center[0]) == ring || abs(y - center[1]) == ring || abs(z - center[2]) == ring;
+                        if (!shell || x < 0 || y < 0 || z < 0 || x >= (int)GRID_CELLS || y >= (int)GRID_CELLS ||
+                            z >= (int)GRID_CELLS)
+                            continue;
+                        uint32_t cell = (z * GRID_CELLS + y) * GRID_CELLS + x;
+                        for (uint32_t i = cellOffsets[cell]; i < cellOffsets[cell + 1]; ++i) {
+                            const uint32_t *tri = &tris[cellTriangles[i]];
+                            bestSq = Min(bestSq, MeshPointTriangleDistanceSq(p, Position(tri[0]), Position(tri[1]),
+                                                                             Position(tri[2])));
+                        }
+                    }
+                }
+            }
+        }
+        return sqrtf(bestSq);
+    }
+
+    const std::vector<MeshVertex> *vertices = nullptr;
+    const uint32_t                *tris = nullptr;
+    float                          origin[3] = {};
+    float                          extent = 0.0f;
+    float                          cellSize = 1.0f;
+    std::vector<uint32_t>          cellOffsets;
+    std::vector<uint32_t>          cellTriangles;
+};
+
+int main(int argc, char **argv) {
+    const char *modelPath = "models/skull.txt";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+    }
+
+    MeshData mesh;
+    if (!LoadTextMesh(modelPath, mesh)) {
+        fprintf(stderr, "Failed to load %s\n", modelPath);
+        return 1;
+    }
+
+    // .. the chain as loading builds it, from the LOD 0 indices ..
+    MeshSimplifyInput input = {};
+    input.positions = mesh.vertices[0].position;
+    input.normals = mesh.vertices[0].normal;
+    input.vertexStride = sizeof(MeshVertex);
+    input.vertexCount = mesh.vertices.size();
+    input.indexCount = mesh.lods[0].indexCount;
+    std::vector<uint32_t> lod0(mesh.indices.begin(), mesh.indices.begin() + mesh.lods[0].indexCount);
+    input.indices = lod0.data();
+
+    std::vector<uint32_t> indices;
+    MeshLod               lods[MESH_MAX_LODS];
+    uint32_t              lodCount = 0;
+    int64_t               start = HiResPerformanceQuery();
+    for (uint32_t i = 0; i < CHAIN_ITERATIONS; ++i) {
+        indices = lod0;
+        lodCount = BuildMeshLodChain(input, indices, lods);
+        sink = sink + indices.size();
+    }
+    double seconds = HiResSeconds(HiResPerformanceQuery() - start) / CHAIN_ITERATIONS;
+    uint32_t triangles = mesh.lods[0].indexCount / 3;
+
+    printf("{\"benchmark\": \"mesh_simplifier\", \"model\": \"%s\", \"vertices\": %zu, \"triangles\": %u, "
+           "\"bounds_radius\": %.4f, \"chain_ms\": %.2f, \"triangles_per_second\": %.0f, \"lods\": [",
+           modelPath, mesh.vertices.size(), triangles, mesh.bounds.radius, seconds * 1000.0, triangles / seconds);
+    float previousError = 0.0f;
+    for (uint32_t lod = 0; lod < lodCount; ++lod) {
+        TriangleGrid grid;
+        grid.Build(mesh, indices.data() + lods[lod].startIndexLoc, lods[lod].indexCount);
+        float measured = 0.0f;
+        for (const MeshVertex &vertex : mesh.vertices)
+            measured = Max(measured, grid.Distance(vertex.position));
+
+        printf("%s\n  {\"lod\": %u, \"triangles\": %u, \"reported_error\": %.5f, \"measured_error\": %.5f, "
+               "\"error_to_radius\": %.4f}",
+               lod == 0 ? "" : ",", lod, lods[lod].indexCount / 3, lods[lod].error, measured,
+               lods[lod].error / mesh.bounds.radius);
+        Check(lods[lod].error + ERROR_SLACK * mesh.bounds.radius >= measured, "the reported error covers every original vertex");
+        Check(lods[lod].error <= Max(measured * MAX_OVERESTIMATE, 1e-6f), "the reported error tracks the measured one");
+        Check(lods[lod].error >= previousError, "errors grow along the chain");
+        previousError = lods[lod].error;
+    }
+    Check(lods[lodCount - 1].error <= MESH_LOD_MAX_ERROR_RATIO * mesh.bounds.radius,
+          "the chain stops before the error is comparable to the bounds");
+    printf("\n], \"failures\": %u}\n", failures);
+    return failures ? 1 : 0;
+}
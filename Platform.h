@@ -0,0 +1,90 @@
+#ifndef _PLATFORM_H_
+#define _PLATFORM_H_
+
+/* Platform layer, everything the engine needs from the OS behind one interface. Platform_Win32.cpp is the
+ * real implementation, Platform_Posix.cpp lets the core build and run headless on Linux: it has no window
+ * and never produces window events.
+ */
+
+#include "Common.h"
+#include "Timer.h"
+#include <string>
+#include <vector>
+
+// .. window and event pump ..
+struct PlatformWindow {
+    void    *nativeHandle = nullptr; // HWND on Windows, null when headless.
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+enum PLATFORM_WINDOW_EVENT {
+    PLATFORM_WINDOW_EVENT_QUIT = 0,
+    PLATFORM_WINDOW_EVENT_KEY = 1, // Mouse buttons too, as KEY_M1 to KEY_M3.
+    PLATFORM_WINDOW_EVENT_MOUSE_MOVE = 2,
+    PLATFORM_WINDOW_EVENT_MOUSE_WHEEL = 3,
+};
+
+struct PlatformWindowEvent {
+    PLATFORM_WINDOW_EVENT type;
+    uint32_t              keyCode; // See KEY in Input.h.
+    bool                  isDown;
+    int32_t               x; // Client pixels, or the wheel delta in y.
+    int32_t               y;
+    int64_t               ticks; // HiResPerformanceQuery time the event was taken off the OS queue.
+};
+
+bool PlatformCreateWindow(const char *title, uint32_t width, uint32_t height, PlatformWindow &window);
+void PlatformDestroyWindow(PlatformWindow &window);
+// NOTE(pf): Drains pending OS messages, returns how many events were written. Key repeats are filtered out.
+uint32_t PlatformPollEvents(PlatformWindow &window, PlatformWindowEvent *events, uint32_t maxEvents);
+
+// .. file I/O ..
+bool PlatformReadFile(const char *path, std::vector<uint8_t> &data);
+bool PlatformWriteFile(const char *path, const void *data, size_t size);
+bool PlatformFileExists(const char *path);
+// NOTE(pf): Read only view of a whole file, valid until PlatformUnmapFile. Empty files fail to map.
+struct PlatformFileMapping {
+    const uint8_t *data = nullptr;
+    size_t         size = 0;
+};
+bool PlatformMapFile(const char *path, PlatformFileMapping &mapping);
+void PlatformUnmapFile(PlatformFileMapping &mapping);
+// NOTE(pf): Regular files directly in path, sorted, without the directory.
+bool PlatformListDirectory(const char *path, std::vector<std::string> &names);
+// NOTE(pf): With a trailing separator, empty when unknown.
+std::string PlatformExecutableDirectory();
+// NOTE(pf): Asks the OS to forget the file's cached pages so the next read comes from the disk, for cold load
+// measurements. False where that is not possible without privileges.
+bool PlatformDropFileCache(const char *path);
+
+// NOTE(pf): Files directly in a directory that were written or renamed into it. Polling never blocks and
+// appends the names of the files that changed since the last poll, a file saved in several writes may repeat.
+struct PlatformDirectoryWatch {
+    void *handle = nullptr;
+};
+
+bool PlatformWatchDirectory(const char *path, PlatformDirectoryWatch &watch);
+void PlatformCloseDirectoryWatch(PlatformDirectoryWatch &watch);
+void PlatformPollDirectoryWatch(PlatformDirectoryWatch &watch, std::vector<std::string> &names);
+
+// .. threading ..
+// NOTE(pf): Auto-reset event, a signal wakes one waiter or is kept until someone waits.
+struct PlatformEvent {
+    void *handle = nullptr;
+};
+
+bool     PlatformCreateEvent(PlatformEvent &event);
+void     PlatformDestroyEvent(PlatformEvent &event);
+void     PlatformSignalEvent(PlatformEvent &event);
+bool     PlatformWaitEvent(PlatformEvent &event, uint32_t timeoutMs); // False on timeout.
+void     PlatformSetThreadName(const char *name);
+void     PlatformSleep(uint32_t milliseconds);
+uint32_t PlatformProcessorCount();
+
+// .. error reporting ..
+// NOTE(pf): Message box on Windows, stderr elsewhere. Never exits, the caller decides what is fatal.
+void PlatformReportError(const char *format, ...);
+void PlatformReportError(const wchar_t *message);
+
+#endif //!_PLATFORM_H_
@@ -0,0 +1,236 @@
+#if !defined(_WIN32)
+#include "Platform.h"
+#include <algorithm>
+#include <condition_variable>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <wchar.h>
+
+bool PlatformCreateWindow(const char *title, uint32_t width, uint32_t height, PlatformWindow &window) {
+    (void)title;
+    window.nativeHandle = nullptr;
+    window.width = width;
+    window.height = height;
+    return true;
+}
+
+void PlatformDestroyWindow(PlatformWindow &window) {
+    window.nativeHandle = nullptr;
+}
+
+uint32_t PlatformPollEvents(PlatformWindow &window, PlatformWindowEvent *events, uint32_t maxEvents) {
+    (void)window, (void)events, (void)maxEvents;
+    return 0;
+}
+
+bool PlatformReadFile(const char *path, std::vector<uint8_t> &data) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data.resize(size > 0 ? (size_t)size : 0);
+    bool result = size >= 0 && fread(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    return result;
+}
+
+bool PlatformWriteFile(const char *path, const void *data, size_t size) {
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    bool result = fwrite(data, 1, size, file) == size;
+    result = fclose(file) == 0 && result;
+    return result;
+}
+
+bool PlatformFileExists(const char *path) {
+    struct stat info;
+    return stat(path, &info) == 0;
+}
+
+bool PlatformMapFile(const char *path, PlatformFileMapping &mapping) {
+    mapping = PlatformFileMapping();
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    void       *data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+        data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+        return false;
+
+    mapping.data = (const uint8_t *)data;
+    mapping.size = (size_t)info.st_size;
+    return true;
+}
+
+void PlatformUnmapFile(PlatformFileMapping &mapping) {
+    if (mapping.data)
+        munmap((void *)mapping.data, mapping.size);
+    mapping = PlatformFileMapping();
+}
+
+bool PlatformListDirectory(const char *path, std::vector<std::string> &names) {
+    names.clear();
+    DIR *dir = opendir(path);
+    if (!dir)
+        return false;
+
+    std::string prefix = std::string(path) + "/";
+    while (dirent *entry = readdir(dir)) {
+        struct stat info;
+        if (stat((prefix + entry->d_name).c_str(), &info) == 0 && S_ISREG(info.st_mode))
+            names.push_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    return true;
+}
+
+std::string PlatformExecutableDirectory() {
+    char    path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0)
+        return std::string();
+    std::string result(path, (size_t)length);
+    return result.substr(0, result.find_last_of('/') + 1);
+}
+
+bool PlatformDropFileCache(const char *path) {
+    // NOTE(pf): Only clean pages are dropped, a file that was just written is synced first.
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+    bool result = fdatasync(file) == 0 && posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(file);
+    return result;
+}
+
+struct PosixDirectoryWatch {
+    int     file;
+    alignas(inotify_event) uint8_t events[4096];
+};
+
+bool PlatformWatchDirectory(const char *path, PlatformDirectoryWatch &watch) {
+    int file = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (file < 0)
+        return false;
+    // NOTE(pf): Close after write rather than every write, an editor's save is then one event.
+    if (inotify_add_watch(file, path, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(file);
+        return false;
+    }
+    PosixDirectoryWatch *w = new PosixDirectoryWatch();
+    w->file = file;
+    watch.handle = w;
+    return true;
+}
+
+void PlatformCloseDirectoryWatch(PlatformDirectoryWatch &watch) {
+    PosixDirectoryWatch *w = (PosixDirectoryWatch *)watch.handle;
+    if (w) {
+        close(w->file);
+        delete w;
+    }
+    watch.handle = nullptr;
+}
+
+void PlatformPollDirectoryWatch(PlatformDirectoryWatch &watch, std::vector<std::string> &names) {
+    PosixDirectoryWatch *w = (PosixDirectoryWatch *)watch.handle;
+    if (!w)
+        return;
+
+    ssize_t length;
+    while ((length = read(w->file, w->events, sizeof(w->events))) > 0) {
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event *event = (const inotify_event *)(w->events + offset);
+            if (event->len > 0 && !(event->mask & IN_ISDIR))
+                names.push_back(event->name);
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+
+struct PosixEvent {
+    std::mutex              mutex;
+    std::condition_variable condition;
+    bool                    signaled = false;
+};
+
+bool PlatformCreateEvent(PlatformEvent &event) {
+    event.handle = new PosixEvent();
+    return true;
+}
+
+void PlatformDestroyEvent(PlatformEvent &event) {
+    delete (PosixEvent *)event.handle;
+    event.handle = nullptr;
+}
+
+void PlatformSignalEvent(PlatformEvent &event) {
+    PosixEvent *e = (PosixEvent *)event.handle;
+    {
+        std::lock_guard<std::mutex> lock(e->mutex);
+        e->signaled = true;
+    }
+    e->condition.notify_one();
+}
+
+bool PlatformWaitEvent(PlatformEvent &event, uint32_t timeoutMs) {
+    PosixEvent                  *e = (PosixEvent *)event.handle;
+    std::unique_lock<std::mutex> lock(e->mutex);
+    if (!e->condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [e]() { return e->signaled; }))
+        return false;
+    e->signaled = false;
+    return true;
+}
+
+void PlatformSetThreadName(const char *name) {
+#if defined(__linux__)
+    // NOTE(pf): Linux limits thread names to 15 characters.
+    char truncated[16];
+    snprintf(truncated, sizeof(truncated), "%s", name);
+    pthread_setname_np(pthread_self(), truncated);
+#else
+    (void)name;
+#endif
+}
+
+void PlatformSleep(uint32_t milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+uint32_t PlatformProcessorCount() {
+    uint32_t result = std::thread::hardware_concurrency();
+    return result ? result : 1;
+}
+
+void PlatformReportError(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "Error: ");
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+void PlatformReportError(const wchar_t *message) {
+    fprintf(stderr, "Error: %ls\n", message);
+}
+#endif
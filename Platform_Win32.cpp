@@ -0,0 +1,353 @@
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <windowsx.h>
+
+#include "Platform.h"
+#include <algorithm>
+#include <stdarg.h>
+#include <stdio.h>
+
+static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    if (uMsg == WM_DESTROY) {
+        PostQuitMessage(0);
+        return 0;
+    }
+    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
+
+bool PlatformCreateWindow(const char *title, uint32_t width, uint32_t height, PlatformWindow &window) {
+    WNDCLASSEXA wc = {0};
+    HINSTANCE   hinstance = GetModuleHandle(NULL);
+
+    wc.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
+    wc.lpfnWndProc = WindowProc;
+    wc.cbClsExtra = 0;
+    wc.cbWndExtra = 0;
+    wc.hInstance = hinstance;
+    wc.hIcon = LoadIcon(NULL, IDC_ARROW);
+    wc.hIconSm = wc.hIcon;
+    wc.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
+    wc.lpszMenuName = NULL;
+    wc.lpszClassName = title;
+    wc.cbSize = sizeof(WNDCLASSEXA);
+
+    RegisterClassExA(&wc);
+
+    RECT rect = {0};
+    rect.top = 50;
+    rect.left = 50;
+    rect.bottom = 0 + height;
+    rect.right = 0 + width;
+    DWORD windowStyles = WS_OVERLAPPEDWINDOW | WS_CLIPSIBLINGS | WS_CLIPCHILDREN | WS_POPUP;
+    AdjustWindowRect(&rect, windowStyles, true);
+    HWND hwnd = CreateWindowExA(WS_EX_APPWINDOW, title, title,
+                                windowStyles,
+                                rect.left, rect.top, rect.right + 8, rect.bottom + 32,
+                                NULL, NULL, hinstance, NULL);
+    if (!hwnd)
+        return false;
+
+    ShowWindow(hwnd, SW_SHOW);
+    SetForegroundWindow(hwnd);
+    SetFocus(hwnd);
+
+    window.nativeHandle = hwnd;
+    window.width = width;
+    window.height = height;
+    return true;
+}
+
+void PlatformDestroyWindow(PlatformWindow &window) {
+    if (window.nativeHandle && IsWindow((HWND)window.nativeHandle))
+        DestroyWindow((HWND)window.nativeHandle);
+    window.nativeHandle = nullptr;
+}
+
+uint32_t PlatformPollEvents(PlatformWindow &window, PlatformWindowEvent *events, uint32_t maxEvents) {
+    (void)window;
+    uint32_t eventCount = 0;
+    MSG      msg;
+    while (eventCount < maxEvents && PeekMessage(&msg, 0, 0, 0, PM_REMOVE)) {
+        int64_t ticks = HiResPerformanceQuery();
+        switch (msg.message) {
+        case WM_QUIT: {
+            events[eventCount++] = {PLATFORM_WINDOW_EVENT_QUIT, 0, false, 0, 0, ticks};
+        } break;
+        case WM_SYSKEYDOWN:
+        case WM_SYSKEYUP:
+        case WM_KEYDOWN:
+        case WM_KEYUP: {
+            unsigned int vkCode = (unsigned int)msg.wParam;
+            bool         WasDown = ((msg.lParam & (1 << 30)) != 0);
+            bool         isDown = ((msg.lParam & (1 << 31L)) == 0);
+            if (WasDown != isDown) {
+                events[eventCount++] = {PLATFORM_WINDOW_EVENT_KEY, vkCode, isDown, 0, 0, ticks};
+            }
+
+            bool altKeyWasDown = (msg.lParam & (1 << 29));
+            if ((vkCode == VK_F4) && altKeyWasDown && eventCount < maxEvents) {
+                events[eventCount++] = {PLATFORM_WINDOW_EVENT_QUIT, 0, false, 0, 0, ticks};
+            }
+        } break;
+        case WM_MOUSEMOVE: {
+            events[eventCount++] = {PLATFORM_WINDOW_EVENT_MOUSE_MOVE, 0, false, GET_X_LPARAM(msg.lParam),
+                                    GET_Y_LPARAM(msg.lParam), ticks};
+        } break;
+        case WM_MOUSEWHEEL: {
+            events[eventCount++] = {PLATFORM_WINDOW_EVENT_MOUSE_WHEEL, 0, false, 0,
+                                    GET_WHEEL_DELTA_WPARAM(msg.wParam), ticks};
+        } break;
+        case WM_LBUTTONDOWN:
+        case WM_LBUTTONUP:
+        case WM_RBUTTONDOWN:
+        case WM_RBUTTONUP:
+        case WM_MBUTTONDOWN:
+        case WM_MBUTTONUP: {
+            bool isDown = msg.message == WM_LBUTTONDOWN || msg.message == WM_RBUTTONDOWN ||
+                          msg.message == WM_MBUTTONDOWN;
+            unsigned int vkCode = msg.message <= WM_LBUTTONUP   ? VK_LBUTTON
+                                  : msg.message <= WM_RBUTTONUP ? VK_RBUTTON
+                                                                : VK_MBUTTON;
+            // NOTE(pf): Capture while a button is held, or a release outside the window never arrives.
+            if (isDown)
+                SetCapture(msg.hwnd);
+            else if (!(msg.wParam & (MK_LBUTTON | MK_RBUTTON | MK_MBUTTON)))
+                ReleaseCapture();
+            events[eventCount++] = {PLATFORM_WINDOW_EVENT_KEY, vkCode, isDown, GET_X_LPARAM(msg.lParam),
+                                    GET_Y_LPARAM(msg.lParam), ticks};
+        } break;
+
+        default: {
+            TranslateMessage(&msg);
+            DispatchMessageA(&msg);
+        } break;
+        }
+    }
+    return eventCount;
+}
+
+bool PlatformReadFile(const char *path, std::vector<uint8_t> &data) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    bool          result = GetFileSizeEx(file, &size) != 0;
+    data.resize(result ? (size_t)size.QuadPart : 0);
+
+    // NOTE(pf): ReadFile takes a DWORD, large files are read in chunks.
+    size_t offset = 0;
+    while (result && offset < data.size()) {
+        size_t remaining = data.size() - offset;
+        DWORD  chunk = (DWORD)(remaining < (1u << 30) ? remaining : (1u << 30));
+        DWORD bytesRead = 0;
+        result = ReadFile(file, data.data() + offset, chunk, &bytesRead, NULL) && bytesRead == chunk;
+        offset += bytesRead;
+    }
+    CloseHandle(file);
+    return result;
+}
+
+bool PlatformWriteFile(const char *path, const void *data, size_t size) {
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    bool   result = true;
+    size_t offset = 0;
+    while (result && offset < size) {
+        size_t remaining = size - offset;
+        DWORD  chunk = (DWORD)(remaining < (1u << 30) ? remaining : (1u << 30));
+        DWORD bytesWritten = 0;
+        result = WriteFile(file, (const uint8_t *)data + offset, chunk, &bytesWritten, NULL) && bytesWritten == chunk;
+        offset += bytesWritten;
+    }
+    CloseHandle(file);
+    return result;
+}
+
+bool PlatformFileExists(const char *path) {
+    return GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+bool PlatformMapFile(const char *path, PlatformFileMapping &mapping) {
+    mapping = PlatformFileMapping();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    // NOTE(pf): The view keeps the file mapped, both handles can go right away.
+    LARGE_INTEGER size;
+    HANDLE        fileMapping = NULL;
+    const void   *data = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (fileMapping) {
+        data = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(fileMapping);
+    }
+    CloseHandle(file);
+    if (!data)
+        return false;
+
+    mapping.data = (const uint8_t *)data;
+    mapping.size = (size_t)size.QuadPart;
+    return true;
+}
+
+void PlatformUnmapFile(PlatformFileMapping &mapping) {
+    if (mapping.data)
+        UnmapViewOfFile(mapping.data);
+    mapping = PlatformFileMapping();
+}
+
+bool PlatformListDirectory(const char *path, std::vector<std::string> &names) {
+    names.clear();
+    WIN32_FIND_DATAA found;
+    HANDLE           find = FindFirstFileA((std::string(path) + "\\*").c_str(), &found);
+    if (find == INVALID_HANDLE_VALUE)
+        return false;
+
+    do {
+        if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            names.push_back(found.cFileName);
+    } while (FindNextFileA(find, &found));
+    FindClose(find);
+    std::sort(names.begin(), names.end());
+    return true;
+}
+
+std::string PlatformExecutableDirectory() {
+    char  path[MAX_PATH];
+    DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+    if (length == 0 || length == MAX_PATH)
+        return std::string();
+    std::string result(path, length);
+    return result.substr(0, result.find_last_of("\\/") + 1);
+}
+
+bool PlatformDropFileCache(const char *path) {
+    // NOTE(pf): Windows drops a file's cached pages only for unbuffered handles or with admin rights.
+    (void)path;
+    return false;
+}
+
+struct Win32DirectoryWatch {
+    HANDLE     directory;
+    OVERLAPPED overlapped;
+    DWORD      changes[4096]; // FILE_NOTIFY_INFORMATION records, DWORD aligned.
+};
+
+static bool ReadDirectoryChanges(Win32DirectoryWatch *w) {
+    return ReadDirectoryChangesW(w->directory, w->changes, sizeof(w->changes), FALSE,
+                                 FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE, NULL, &w->overlapped, NULL) != 0;
+}
+
+bool PlatformWatchDirectory(const char *path, PlatformDirectoryWatch &watch) {
+    HANDLE directory = CreateFileA(path, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                   OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (directory == INVALID_HANDLE_VALUE)
+        return false;
+
+    Win32DirectoryWatch *w = new Win32DirectoryWatch();
+    w->directory = directory;
+    w->overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (!w->overlapped.hEvent || !ReadDirectoryChanges(w)) {
+        if (w->overlapped.hEvent)
+            CloseHandle(w->overlapped.hEvent);
+        CloseHandle(directory);
+        delete w;
+        return false;
+    }
+    watch.handle = w;
+    return true;
+}
+
+void PlatformCloseDirectoryWatch(PlatformDirectoryWatch &watch) {
+    Win32DirectoryWatch *w = (Win32DirectoryWatch *)watch.handle;
+    if (w) {
+        // NOTE(pf): The read in flight writes into w until it is cancelled.
+        DWORD bytes;
+        CancelIo(w->directory);
+        GetOverlappedResult(w->directory, &w->overlapped, &bytes, TRUE);
+        CloseHandle(w->overlapped.hEvent);
+        CloseHandle(w->directory);
+        delete w;
+    }
+    watch.handle = nullptr;
+}
+
+void PlatformPollDirectoryWatch(PlatformDirectoryWatch &watch, std::vector<std::string> &names) {
+    Win32DirectoryWatch *w = (Win32DirectoryWatch *)watch.handle;
+    DWORD                bytes = 0;
+    if (!w || !GetOverlappedResult(w->directory, &w->overlapped, &bytes, FALSE))
+        return;
+
+    // .. a read that overflowed its buffer completes with 0 bytes, the changes it lost are dropped ..
+    for (DWORD offset = 0; bytes > 0;) {
+        const FILE_NOTIFY_INFORMATION *change = (const FILE_NOTIFY_INFORMATION *)((const BYTE *)w->changes + offset);
+        if (change->Action == FILE_ACTION_ADDED || change->Action == FILE_ACTION_MODIFIED ||
+            change->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+            char name[MAX_PATH];
+            int  length = WideCharToMultiByte(CP_UTF8, 0, change->FileName, change->FileNameLength / sizeof(WCHAR), name,
+                                              sizeof(name), NULL, NULL);
+            if (length > 0)
+                names.push_back(std::string(name, length));
+        }
+        if (change->NextEntryOffset == 0)
+            break;
+        offset += change->NextEntryOffset;
+    }
+    ResetEvent(w->overlapped.hEvent);
+    ReadDirectoryChanges(w);
+}
+
+bool PlatformCreateEvent(PlatformEvent &event) {
+    event.handle = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+    return event.handle != nullptr;
+}
+
+void PlatformDestroyEvent(PlatformEvent &event) {
+    if (event.handle)
+        ::CloseHandle((HANDLE)event.handle);
+    event.handle = nullptr;
+}
+
+void PlatformSignalEvent(PlatformEvent &event) {
+    ::SetEvent((HANDLE)event.handle);
+}
+
+bool PlatformWaitEvent(PlatformEvent &event, uint32_t timeoutMs) {
+    return ::WaitForSingleObject((HANDLE)event.handle, timeoutMs) == WAIT_OBJECT_0;
+}
+
+void PlatformSetThreadName(const char *name) {
+    wchar_t wideName[64];
+    if (MultiByteToWideChar(CP_UTF8, 0, name, -1, wideName, 64) > 0)
+        SetThreadDescription(GetCurrentThread(), wideName);
+}
+
+void PlatformSleep(uint32_t milliseconds) {
+    Sleep(milliseconds);
+}
+
+uint32_t PlatformProcessorCount() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+}
+
+void PlatformReportError(const char *format, ...) {
+    char    message[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    MessageBoxA(0, message, "Error", MB_OK);
+}
+
+void PlatformReportError(const wchar_t *message) {
+    MessageBoxW(0, message, L"Error", MB_OK);
+}
+#endif
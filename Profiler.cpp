@@ -0,0 +1,140 @@
+#include "Profiler.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <string.h>
+
+std::atomic<bool> profilerEnabled = {false};
+
+static std::atomic<ProfileThreadBuffer *> profilerBuffers = {nullptr};
+static std::atomic<uint32_t>              profilerNextId = {1};
+static thread_local ProfileThreadBuffer  *profilerThreadBuffer = nullptr;
+
+static void CopyName(char *dst, const char *src) {
+    strncpy(dst, src, PROFILER_NAME_LENGTH - 1);
+    dst[PROFILER_NAME_LENGTH - 1] = '\0';
+}
+
+ProfileThreadBuffer *ProfilerRegisterTrack(const char *name) {
+    // NOTE(pf): Buffers are never freed, threads come and go rarely and their events stay exportable.
+    ProfileThreadBuffer *buffer = new ProfileThreadBuffer();
+    buffer->id = profilerNextId.fetch_add(1, std::memory_order_relaxed);
+    CopyName(buffer->name, name);
+
+    ProfileThreadBuffer *head = profilerBuffers.load(std::memory_order_relaxed);
+    do {
+        buffer->next = head;
+    } while (!profilerBuffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+    return buffer;
+}
+
+ProfileThreadBuffer *ProfilerThreadBuffer() {
+    if (!profilerThreadBuffer) {
+        char name[PROFILER_NAME_LENGTH];
+        snprintf(name, sizeof(name), "Thread %u", profilerNextId.load(std::memory_order_relaxed));
+        profilerThreadBuffer = ProfilerRegisterTrack(name);
+    }
+    return profilerThreadBuffer;
+}
+
+void ProfilerSetThreadName(const char *name) {
+    CopyName(ProfilerThreadBuffer()->name, name);
+}
+
+void ProfilerSetEnabled(bool enabled) {
+    profilerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool ProfilerIsEnabled() {
+    return profilerEnabled.load(std::memory_order_relaxed);
+}
+
+void ProfilerReset() {
+    for (ProfileThreadBuffer *buffer = profilerBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        buffer->count.store(0, std::memory_order_release);
+        buffer->depth = 0;
+    }
+}
+
+void ProfilerBeginZone(const char *name) {
+    ProfileThreadBuffer *buffer = ProfilerThreadBuffer();
+    if (buffer->depth < PROFILER_MAX_DEPTH) {
+        buffer->openNames[buffer->depth] = name;
+        buffer->openBegins[buffer->depth] = HiResPerformanceQuery();
+    }
+    buffer->depth++;
+}
+
+void ProfilerEndZone() {
+    ProfileThreadBuffer *buffer = ProfilerThreadBuffer();
+    if (buffer->depth == 0)
+        return;
+    buffer->depth--;
+    if (buffer->depth < PROFILER_MAX_DEPTH) {
+        uint32_t depth = buffer->depth;
+        ProfilerRecord(buffer, buffer->openNames[depth], buffer->openBegins[depth], HiResPerformanceQuery(), depth);
+    }
+}
+
+void ProfilerRecord(ProfileThreadBuffer *buffer, const char *name, int64_t begin, int64_t end, uint32_t depth) {
+    uint64_t      count = buffer->count.load(std::memory_order_relaxed);
+    ProfileEvent &event = buffer->events[count & (PROFILER_MAX_EVENTS - 1)];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    event.depth = depth;
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+static void WriteJsonString(FILE *file, const char *s) {
+    fputc('"', file);
+    for (; s && *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            fputc('\\', file);
+        if ((unsigned char)*s >= 0x20)
+            fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+bool ProfilerExportChromeTrace(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    // NOTE(pf): Timestamps are microseconds relative to the earliest recorded event.
+    int64_t origin = INT64_MAX;
+    for (ProfileThreadBuffer *buffer = profilerBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        uint64_t first = count > PROFILER_MAX_EVENTS ? count - PROFILER_MAX_EVENTS : 0;
+        for (uint64_t i = first; i < count; ++i) {
+            int64_t begin = buffer->events[i & (PROFILER_MAX_EVENTS - 1)].begin;
+            origin = begin < origin ? begin : origin;
+        }
+    }
+    origin = origin == INT64_MAX ? 0 : origin;
+    double ticksToUs = 1000000.0 / (double)HiResPerformanceFreq();
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool firstEvent = true;
+    for (ProfileThreadBuffer *buffer = profilerBuffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ",
+                firstEvent ? "" : ",\n", buffer->id);
+        WriteJsonString(file, buffer->name);
+        fprintf(file, "}}");
+        firstEvent = false;
+
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        uint64_t first = count > PROFILER_MAX_EVENTS ? count - PROFILER_MAX_EVENTS : 0;
+        for (uint64_t i = first; i < count; ++i) {
+            const ProfileEvent &event = buffer->events[i & (PROFILER_MAX_EVENTS - 1)];
+            fprintf(file, ",\n{\"name\": ");
+            WriteJsonString(file, event.name);
+            fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, \"args\": {\"depth\": %u}}",
+                    buffer->id, (event.begin - origin) * ticksToUs, (event.end - event.begin) * ticksToUs, event.depth);
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    fclose(file);
+    return true;
+}
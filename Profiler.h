@@ -0,0 +1,79 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+/* Scoped CPU profiler with Chrome trace export, the format is described in $SOURCE
+ * SOURCE: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ *
+ * NOTE(pf): Every thread records into its own ring of events, the owning thread is the only writer so
+ * recording is a couple of plain stores and one release store, no locks or atomics RMW. Threads register
+ * their buffer once by pushing it onto a lock-free list. Zones nest by time, depth is kept for summaries.
+ * Export is meant to run while the recording threads are quiet (end of capture), events that are being
+ * overwritten during an export may come out torn.
+ */
+
+#include "Common.h"
+#include <atomic>
+
+static constexpr uint32_t PROFILER_MAX_EVENTS = {1 << 16}; // Per thread, must be a power of two.
+static constexpr uint32_t PROFILER_MAX_DEPTH = {32};
+static constexpr uint32_t PROFILER_NAME_LENGTH = {32};
+
+struct ProfileEvent {
+    const char *name; // Must outlive the profiler, string literals in practice.
+    int64_t     begin;
+    int64_t     end;
+    uint32_t    depth;
+};
+
+struct ProfileThreadBuffer {
+    ProfileEvent          events[PROFILER_MAX_EVENTS];
+    std::atomic<uint64_t> count = {0};
+    const char           *openNames[PROFILER_MAX_DEPTH] = {};
+    int64_t               openBegins[PROFILER_MAX_DEPTH] = {};
+    uint32_t              depth = 0;
+    uint32_t              id = 0;
+    char                  name[PROFILER_NAME_LENGTH] = {};
+    ProfileThreadBuffer  *next = nullptr;
+};
+
+// NOTE(pf): Tracks are buffers that do not belong to a thread, the gpu timeline is one. Whoever records
+// into a track must be its only writer.
+ProfileThreadBuffer *ProfilerRegisterTrack(const char *name);
+ProfileThreadBuffer *ProfilerThreadBuffer();
+void                 ProfilerSetThreadName(const char *name);
+
+void ProfilerSetEnabled(bool enabled);
+bool ProfilerIsEnabled();
+void ProfilerReset(); // Drops every recorded event, the caller makes sure no thread is recording.
+
+void ProfilerBeginZone(const char *name);
+void ProfilerEndZone();
+void ProfilerRecord(ProfileThreadBuffer *buffer, const char *name, int64_t begin, int64_t end, uint32_t depth);
+
+// NOTE(pf): Chrome trace event JSON, opens in chrome://tracing and ui.perfetto.dev.
+bool ProfilerExportChromeTrace(const char *path);
+
+extern std::atomic<bool> profilerEnabled;
+
+struct ProfileZone {
+    explicit ProfileZone(const char *name) : active(profilerEnabled.load(std::memory_order_relaxed)) {
+        if (active)
+            ProfilerBeginZone(name);
+    }
+    ~ProfileZone() {
+        if (active)
+            ProfilerEndZone();
+    }
+    bool active;
+};
+
+#if defined(PROFILER_DISABLED)
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#endif
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+
+#endif //!_PROFILER_H_
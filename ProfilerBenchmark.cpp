@@ -0,0 +1,78 @@
+/* Overhead of the cpu profiler, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 -pthread ProfilerBenchmark.cpp Profiler.cpp Timer.cpp -o ProfilerBenchmark
+ * Reports nanoseconds per zone with the profiler off, on, and on from several threads at once.
+ */
+
+#include "Profiler.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t ZONES_PER_RUN = {1000000};
+
+static volatile uint32_t sink = 0;
+
+static double MeasureZones(uint32_t zoneCount) {
+    int64_t start = HiResPerformanceQuery();
+    for (uint32_t i = 0; i < zoneCount; ++i) {
+        PROFILE_ZONE("Outer");
+        {
+            PROFILE_ZONE("Inner");
+            sink = sink + i;
+        }
+    }
+    int64_t end = HiResPerformanceQuery();
+    return HiResMilliseconds(end - start) * 1e6 / (zoneCount * 2.0);
+}
+
+static double MeasureEmptyLoop(uint32_t count) {
+    int64_t start = HiResPerformanceQuery();
+    for (uint32_t i = 0; i < count; ++i)
+        sink = sink + i;
+    int64_t end = HiResPerformanceQuery();
+    return HiResMilliseconds(end - start) * 1e6 / (count * 2.0);
+}
+
+int main(int argc, char **argv) {
+    const char *tracePath = argc > 1 ? argv[1] : nullptr;
+    ProfilerSetThreadName("Main");
+
+    double baseline = MeasureEmptyLoop(ZONES_PER_RUN);
+
+    ProfilerSetEnabled(false);
+    double disabled = MeasureZones(ZONES_PER_RUN);
+
+    ProfilerSetEnabled(true);
+    MeasureZones(1000); // Warm up, registers the thread buffer.
+    double enabled = MeasureZones(ZONES_PER_RUN);
+
+    // NOTE(pf): Threads never share a buffer, so the cost per zone should not change with the thread count.
+    uint32_t            threadCount = std::thread::hardware_concurrency();
+    threadCount = threadCount < 2 ? 2 : (threadCount > 8 ? 8 : threadCount);
+    std::vector<double> threadResults(threadCount);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([t, &threadResults]() {
+            char name[PROFILER_NAME_LENGTH];
+            snprintf(name, sizeof(name), "Worker %u", t);
+            ProfilerSetThreadName(name);
+            threadResults[t] = MeasureZones(ZONES_PER_RUN);
+        });
+    }
+    double threaded = 0.0;
+    for (uint32_t t = 0; t < threadCount; ++t) {
+        threads[t].join();
+        threaded += threadResults[t] / threadCount;
+    }
+
+    printf("{\"benchmark\": \"profiler_overhead\", \"zones\": %u, \"loop_ns\": %.2f, \"disabled_ns_per_zone\": %.2f, "
+           "\"enabled_ns_per_zone\": %.2f, \"threads\": %u, \"threaded_ns_per_zone\": %.2f}\n",
+           ZONES_PER_RUN * 2, baseline, disabled - baseline, enabled - baseline, threadCount, threaded - baseline);
+
+    if (tracePath && !ProfilerExportChromeTrace(tracePath)) {
+        printf("Failed to write trace to %s\n", tracePath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include "Scene.h"
+#include "Profiler.h"
+#include <string.h>
+
+const SceneDrawBatch *SceneDrawList::FindBatch(uint32_t mesh) const {
+    for (const SceneDrawBatch &batch : batches) {
+        if (batch.mesh == mesh)
+            return &batch;
+    }
+    return nullptr;
+}
+
+SceneEntity Scene::CreateEntity(SceneEntity parent, const Mat4 &local, uint32_t mesh) {
+    assert((parent == SCENE_NO_ENTITY || IsAlive(parent)) && "Parent entity does not exist.");
+    SceneEntity entity;
+    if (!freeEntities.empty()) {
+        entity = freeEntities.back();
+        freeEntities.pop_back();
+    } else {
+        entity = (SceneEntity)denseIndices.size();
+        denseIndices.push_back(SCENE_NO_ENTITY);
+    }
+
+    // NOTE(pf): Appending keeps parents before children, only the levels are stale until Reorder.
+    denseIndices[entity] = (uint32_t)entities.size();
+    parents.push_back(parent == SCENE_NO_ENTITY ? SCENE_NO_PARENT : denseIndices[parent]);
+    locals.push_back(local);
+    worlds.push_back(local);
+    meshes.push_back(mesh);
+    localDirty.push_back(1);
+    worldDirty.push_back(0);
+    entities.push_back(entity);
+    orderStale = true;
+    return entity;
+}
+
+void Scene::DestroyEntity(SceneEntity entity) {
+    assert(IsAlive(entity) && "Entity does not exist.");
+
+    // .. parents come first, so one pass from the entity on finds its whole subtree ..
+    uint32_t              first = denseIndices[entity];
+    uint32_t              count = (uint32_t)entities.size();
+    std::vector<uint8_t>  destroyed(count, 0);
+    std::vector<uint32_t> remap(count, SCENE_NO_PARENT);
+    destroyed[first] = 1;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (i > first && parents[i] != SCENE_NO_PARENT && destroyed[parents[i]])
+            destroyed[i] = 1;
+    }
+
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (destroyed[i]) {
+            denseIndices[entities[i]] = SCENE_NO_ENTITY;
+            freeEntities.push_back(entities[i]);
+            continue;
+        }
+        remap[i] = kept;
+        parents[kept] = parents[i] == SCENE_NO_PARENT ? SCENE_NO_PARENT : remap[parents[i]];
+        locals[kept] = locals[i];
+        worlds[kept] = worlds[i];
+        meshes[kept] = meshes[i];
+        localDirty[kept] = localDirty[i];
+        worldDirty[kept] = worldDirty[i];
+        entities[kept] = entities[i];
+        denseIndices[entities[i]] = kept;
+        kept++;
+    }
+    parents.resize(kept);
+    locals.resize(kept);
+    worlds.resize(kept);
+    meshes.resize(kept);
+    localDirty.resize(kept);
+    worldDirty.resize(kept);
+    entities.resize(kept);
+    orderStale = true;
+}
+
+bool Scene::IsAlive(SceneEntity entity) const {
+    return entity < denseIndices.size() && denseIndices[entity] != SCENE_NO_ENTITY;
+}
+
+void Scene::SetLocal(SceneEntity entity, const Mat4 &local) {
+    assert(IsAlive(entity) && "Entity does not exist.");
+    uint32_t index = denseIndices[entity];
+    locals[index] = local;
+    localDirty[index] = 1;
+}
+
+void Scene::SetMesh(SceneEntity entity, uint32_t mesh) {
+    assert(IsAlive(entity) && "Entity does not exist.");
+    meshes[denseIndices[entity]] = mesh;
+}
+
+const Mat4 &Scene::Local(SceneEntity entity) const {
+    assert(IsAlive(entity) && "Entity does not exist.");
+    return locals[denseIndices[entity]];
+}
+
+const Mat4 &Scene::World(SceneEntity entity) const {
+    assert(IsAlive(entity) && "Entity does not exist.");
+    return worlds[denseIndices[entity]];
+}
+
+void Scene::Reorder() {
+    PROFILE_FUNCTION();
+    uint32_t count = (uint32_t)entities.size();
+
+    // .. children of every entity, in dense order so siblings keep their relative order ..
+    std::vector<uint32_t> childStarts(count + 1, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (parents[i] != SCENE_NO_PARENT)
+            childStarts[parents[i] + 1]++;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        childStarts[i + 1] += childStarts[i];
+    }
+    std::vector<uint32_t> children(childStarts[count]);
+    std::vector<uint32_t> cursors(childStarts.begin(), childStarts.end() - 1);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (parents[i] != SCENE_NO_PARENT)
+            children[cursors[parents[i]]++] = i;
+    }
+
+    // .. breadth first from the roots, a level ends where the previous level's children end ..
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (parents[i] == SCENE_NO_PARENT)
+            order.push_back(i);
+    }
+    levelStarts.clear();
+    uint32_t levelBegin = 0;
+    while (levelBegin < order.size()) {
+        levelStarts.push_back(levelBegin);
+        uint32_t levelEnd = (uint32_t)order.size();
+        for (uint32_t k = levelBegin; k < levelEnd; ++k) {
+            uint32_t parent = order[k];
+            for (uint32_t c = childStarts[parent]; c < childStarts[parent + 1]; ++c)
+                order.push_back(children[c]);
+        }
+        levelBegin = levelEnd;
+    }
+    levelStarts.push_back(count);
+    assert(order.size() == count && "Scene hierarchy has a cycle.");
+
+    std::vector<uint32_t> newIndices(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        newIndices[order[i]] = i;
+    }
+
+    std::vector<uint32_t>    newParents(count);
+    std::vector<Mat4>        newLocals(count), newWorlds(count);
+    std::vector<uint32_t>    newMeshes(count);
+    std::vector<uint8_t>     newLocalDirty(count), newWorldDirty(count);
+    std::vector<SceneEntity> newEntities(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t old = order[i];
+        newParents[i] = parents[old] == SCENE_NO_PARENT ? SCENE_NO_PARENT : newIndices[parents[old]];
+        newLocals[i] = locals[old];
+        newWorlds[i] = worlds[old];
+        newMeshes[i] = meshes[old];
+        newLocalDirty[i] = localDirty[old];
+        newWorldDirty[i] = worldDirty[old];
+        newEntities[i] = entities[old];
+        denseIndices[entities[old]] = i;
+    }
+    parents.swap(newParents);
+    locals.swap(newLocals);
+    worlds.swap(newWorlds);
+    meshes.swap(newMeshes);
+    localDirty.swap(newLocalDirty);
+    worldDirty.swap(newWorldDirty);
+    entities.swap(newEntities);
+    orderStale = false;
+    stats.reorders++;
+}
+
+void Scene::UpdateRange(uint32_t begin, uint32_t end) {
+    // .. a world changes with its local or with its parent's world, parents are a level up and already done ..
+    for (uint32_t i = begin; i < end; ++i) {
+        uint32_t parent = parents[i];
+        worldDirty[i] = localDirty[i] | (parent != SCENE_NO_PARENT ? worldDirty[parent] : 0);
+        localDirty[i] = 0;
+    }
+
+    // NOTE(pf): Dirty siblings are contiguous, each run is one batch multiply by their parent's world.
+    uint32_t updated = 0;
+    for (uint32_t i = begin; i < end;) {
+        if (!worldDirty[i]) {
+            ++i;
+            continue;
+        }
+        uint32_t parent = parents[i];
+        uint32_t runEnd = i + 1;
+        while (runEnd < end && worldDirty[runEnd] && parents[runEnd] == parent)
+            ++runEnd;
+        if (parent == SCENE_NO_PARENT)
+            memcpy(&worlds[i], &locals[i], (runEnd - i) * sizeof(Mat4));
+        else
+            Mat4MultiplyBatch(&locals[i], worlds[parent], &worlds[i], runEnd - i);
+        updated += runEnd - i;
+        i = runEnd;
+    }
+    worldsUpdated.fetch_add(updated, std::memory_order_relaxed);
+}
+
+void Scene::UpdateWorlds(TaskPool *pool) {
+    PROFILE_FUNCTION();
+    if (orderStale)
+        Reorder();
+
+    worldsUpdated.store(0, std::memory_order_relaxed);
+    for (size_t level = 0; level + 1 < levelStarts.size(); ++level) {
+        uint32_t begin = levelStarts[level];
+        uint32_t end = levelStarts[level + 1];
+        if (pool)
+            pool->ParallelFor(end - begin, SCENE_UPDATE_CHUNK_SIZE,
+                              [this, begin](uint32_t b, uint32_t e) { UpdateRange(begin + b, begin + e); });
+        else
+            UpdateRange(begin, end);
+    }
+
+    stats.entities = (uint32_t)entities.size();
+    stats.levels = levelStarts.empty() ? 0 : (uint32_t)levelStarts.size() - 1;
+    stats.worldsUpdated = worldsUpdated.load(std::memory_order_relaxed);
+}
+
+void Scene::ExtractDrawList(SceneDrawList &drawList) const {
+    PROFILE_FUNCTION();
+    // NOTE(pf): Counting sort by mesh, the batches are indexed by mesh id until the empty ones are dropped.
+    uint32_t meshCount = 0;
+    for (uint32_t mesh : meshes) {
+        if (mesh != SCENE_NO_MESH && mesh + 1 > meshCount)
+            meshCount = mesh + 1;
+    }
+    drawList.batches.assign(meshCount, SceneDrawBatch{});
+    for (uint32_t mesh : meshes) {
+        if (mesh != SCENE_NO_MESH)
+            drawList.batches[mesh].instanceCount++;
+    }
+    uint32_t instanceCount = 0;
+    for (uint32_t mesh = 0; mesh < meshCount; ++mesh) {
+        SceneDrawBatch &batch = drawList.batches[mesh];
+        batch.mesh = mesh;
+        batch.firstInstance = instanceCount;
+        instanceCount += batch.instanceCount;
+        batch.instanceCount = 0;
+    }
+
+    drawList.worlds.resize(instanceCount);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (meshes[i] == SCENE_NO_MESH)
+            continue;
+        SceneDrawBatch &batch = drawList.batches[meshes[i]];
+        drawList.worlds[batch.firstInstance + batch.instanceCount++] = worlds[i];
+    }
+
+    uint32_t kept = 0;
+    for (const SceneDrawBatch &batch : drawList.batches) {
+        if (batch.instanceCount)
+            drawList.batches[kept++] = batch;
+    }
+    drawList.batches.resize(kept);
+}
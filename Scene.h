@@ -0,0 +1,82 @@
+#ifndef _SCENE_H_
+#define _SCENE_H_
+
+/* Entities with a transform hierarchy and an optional mesh, stored as dense structure-of-arrays.
+ *
+ * NOTE(pf): Entities are stable handles, the dense arrays behind them are kept in level order: roots first,
+ * then their children, then grandchildren and so on, with siblings next to each other. Every parent comes
+ * before its children, so worlds are updated one level at a time and each level splits into independent
+ * chunks for the task pool. Only entities whose local transform changed, and everything below them, are
+ * multiplied again. Creating or destroying entities marks the order stale, it is rebuilt by the next update.
+ */
+
+#include "Mat4.h"
+#include "TaskPool.h"
+#include <atomic>
+#include <vector>
+
+typedef uint32_t SceneEntity;
+
+static constexpr SceneEntity SCENE_NO_ENTITY = {0xffffffffu};
+static constexpr uint32_t    SCENE_NO_PARENT = {0xffffffffu};
+static constexpr uint32_t    SCENE_NO_MESH = {0xffffffffu};
+static constexpr uint32_t    SCENE_UPDATE_CHUNK_SIZE = {1024};
+
+// NOTE(pf): Instances of one mesh are contiguous, worlds are in the order the scene stores them.
+struct SceneDrawBatch {
+    uint32_t mesh;
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+};
+
+struct SceneDrawList {
+    std::vector<SceneDrawBatch> batches;
+    std::vector<Mat4>           worlds;
+
+    const SceneDrawBatch *FindBatch(uint32_t mesh) const;
+};
+
+struct SceneStats {
+    uint32_t entities;
+    uint32_t levels;
+    uint32_t worldsUpdated; // By the last UpdateWorlds.
+    uint32_t reorders;
+};
+
+struct Scene {
+    SceneEntity CreateEntity(SceneEntity parent, const Mat4 &local, uint32_t mesh = SCENE_NO_MESH);
+    // NOTE(pf): Destroys the entity and everything below it.
+    void        DestroyEntity(SceneEntity entity);
+    bool        IsAlive(SceneEntity entity) const;
+    void        SetLocal(SceneEntity entity, const Mat4 &local);
+    void        SetMesh(SceneEntity entity, uint32_t mesh);
+    const Mat4 &Local(SceneEntity entity) const;
+    const Mat4 &World(SceneEntity entity) const; // As of the last UpdateWorlds.
+
+    // NOTE(pf): pool may be null, the levels are then updated on the calling thread.
+    void UpdateWorlds(TaskPool *pool);
+    void ExtractDrawList(SceneDrawList &drawList) const;
+
+    SceneStats stats = {};
+
+    // .. dense, level order ..
+    std::vector<uint32_t>    parents; // Dense index of the parent or SCENE_NO_PARENT.
+    std::vector<Mat4>        locals;
+    std::vector<Mat4>        worlds;
+    std::vector<uint32_t>    meshes;
+    std::vector<uint8_t>     localDirty;
+    std::vector<uint8_t>     worldDirty; // Set for the worlds the last update changed.
+    std::vector<SceneEntity> entities;
+    std::vector<uint32_t>    levelStarts; // Dense range of level i is [levelStarts[i], levelStarts[i + 1]).
+
+  private:
+    void Reorder();
+    void UpdateRange(uint32_t begin, uint32_t end);
+
+    std::vector<uint32_t>    denseIndices; // Per entity, SCENE_NO_ENTITY when free.
+    std::vector<SceneEntity> freeEntities;
+    bool                     orderStale = {false};
+    std::atomic<uint32_t>    worldsUpdated = {0};
+};
+
+#endif //!_SCENE_H_
@@ -0,0 +1,343 @@
+#include "SoftwareRenderer.h"
+#include <cmath>
+
+// NOTE(pf): Small deterministic generator so the reference output does not depend on the C runtime's rand().
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+static void Normalize3(float v[3]) {
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+    v[0] *= invLength;
+    v[1] *= invLength;
+    v[2] *= invLength;
+}
+
+static float Dot3(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+void SoftwareRenderer::Initialize(uint32_t _width, uint32_t _height, uint32_t seed) {
+    width = _width;
+    height = _height;
+    depth.resize(width * height);
+    normals.resize(width * height * 3);
+    ambient.resize(width * height);
+    color.resize(width * height);
+    depthPyramid.Initialize(width, height);
+
+    // .. offset vectors, same construction as DX12SSAOPass::BuildOffsetVectors ..
+    static const float directions[SSAO_SAMPLE_COUNT][3] = {
+        {+1.0f, +1.0f, +1.0f}, {-1.0f, -1.0f, -1.0f}, {-1.0f, +1.0f, +1.0f}, {+1.0f, -1.0f, -1.0f},
+        {+1.0f, +1.0f, -1.0f}, {-1.0f, -1.0f, +1.0f}, {-1.0f, +1.0f, -1.0f}, {+1.0f, -1.0f, +1.0f},
+        {-1.0f, 0.0f, 0.0f}, {+1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, +1.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f}, {0.0f, 0.0f, +1.0f}};
+    uint32_t state = seed;
+    for (int i = 0; i < SSAO_SAMPLE_COUNT; ++i) {
+        float s = 0.25f + NextRandom(state) * 0.75f;
+        float v[3] = {directions[i][0], directions[i][1], directions[i][2]};
+        Normalize3(v);
+        ssaoOffsets[i][0] = s * v[0];
+        ssaoOffsets[i][1] = s * v[1];
+        ssaoOffsets[i][2] = s * v[2];
+    }
+
+    // .. random vectors, stored already mapped from [0, 1] to [-1, 1] ..
+    ssaoRandomVectors.resize(SSAO_RANDOM_MAP_SIZE * SSAO_RANDOM_MAP_SIZE * 3);
+    for (float &value : ssaoRandomVectors)
+        value = 2.0f * NextRandom(state) - 1.0f;
+}
+
+void SoftwareRenderer::BeginFrame() {
+    for (uint32_t i = 0; i < width * height; ++i) {
+        depth[i] = 1.0f;
+        normals[i * 3 + 0] = 0.0f;
+        normals[i * 3 + 1] = 0.0f;
+        normals[i * 3 + 2] = 1.0f;
+    }
+    trianglesDrawn = 0;
+    instancesDrawn = 0;
+}
+
+uint32_t SoftwareRenderer::DrawMeshInstances(const MeshData &mesh, const Mat4 *instanceWorlds, uint32_t instanceCount,
+                                             const Mat4 &view, const Mat4 &proj) {
+    Mat4        viewProj = Mat4Multiply(view, proj);
+    CullFrustum frustum;
+    BuildCullFrustum(viewProj.m, frustum);
+
+    // .. world space bounding spheres, same as CullAndUploadInstances ..
+    instanceSpheres.Resize(instanceCount);
+    TransformBoundingSpheres(instanceWorlds, instanceCount, mesh.bounds.center, mesh.bounds.radius,
+                             instanceSpheres.x.data(), instanceSpheres.y.data(), instanceSpheres.z.data(),
+                             instanceSpheres.radius.data());
+    visibleInstances.resize(instanceCount);
+    size_t visibleCount = CullSpheres(frustum, instanceSpheres, visibleInstances.data());
+
+    float fovY = 2.0f * atanf(1.0f / proj.m[5]);
+    if (transformedVertices.size() < mesh.vertices.size()) {
+        transformedVertices.resize(mesh.vertices.size());
+        transformedStamps.assign(mesh.vertices.size(), 0);
+        transformStamp = 0;
+    }
+
+    for (size_t v = 0; v < visibleCount; ++v) {
+        uint32_t instance = visibleInstances[v];
+        float    viewZ = instanceSpheres.x[instance] * view.m[2] + instanceSpheres.y[instance] * view.m[6] +
+                         instanceSpheres.z[instance] * view.m[10] + view.m[14];
+        float    distance = Max(viewZ - instanceSpheres.radius[instance], 1e-3f);
+        uint32_t lod = SelectMeshLod(mesh.lods, mesh.lodCount, distance, fovY, (float)height);
+
+        const Mat4 &world = instanceWorlds[instance];
+        Mat4        worldViewProj = Mat4Multiply(world, viewProj);
+        Mat4        worldView = Mat4Multiply(world, view);
+
+        // NOTE(pf): Vertices are transformed on first use, coarse LODs only touch a fraction of them.
+        if (++transformStamp == 0) {
+            transformedStamps.assign(transformedStamps.size(), 0);
+            transformStamp = 1;
+        }
+
+        const uint32_t *indices = mesh.indices.data() + mesh.lods[lod].startIndexLoc;
+        uint32_t        indexCount = mesh.lods[lod].indexCount;
+        for (uint32_t i = 0; i < indexCount; i += 3) {
+            bool behindNear = false;
+            for (int k = 0; k < 3; ++k) {
+                uint32_t index = indices[i + k];
+                if (transformedStamps[index] == transformStamp) {
+                    behindNear = behindNear || transformedVertices[index].invW <= 0.0f;
+                    continue;
+                }
+                transformedStamps[index] = transformStamp;
+
+                const float          *p = mesh.vertices[index].position;
+                const float          *n = mesh.vertices[index].normal;
+                const float          *m = worldViewProj.m;
+                SoftwareRasterVertex &out = transformedVertices[index];
+                float                 cx = p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12];
+                float                 cy = p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13];
+                float                 cz = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14];
+                float                 cw = p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + m[15];
+                if (cw <= 1e-5f) {
+                    out.invW = 0.0f;
+                    behindNear = true;
+                    continue;
+                }
+                out.invW = 1.0f / cw;
+                out.x = (cx * out.invW * 0.5f + 0.5f) * width;
+                out.y = (0.5f - cy * out.invW * 0.5f) * height;
+                out.z = cz * out.invW;
+
+                // NOTE(pf): NormalsVS/PS rotate into world space, normalize and rotate into view space.
+                const float *wv = worldView.m;
+                float        normalV[3] = {n[0] * wv[0] + n[1] * wv[4] + n[2] * wv[8],
+                                           n[0] * wv[1] + n[1] * wv[5] + n[2] * wv[9],
+                                           n[0] * wv[2] + n[1] * wv[6] + n[2] * wv[10]};
+                Normalize3(normalV);
+                out.normalOverW[0] = normalV[0] * out.invW;
+                out.normalOverW[1] = normalV[1] * out.invW;
+                out.normalOverW[2] = normalV[2] * out.invW;
+            }
+            if (behindNear)
+                continue;
+
+            RasterizeTriangle(transformedVertices[indices[i]], transformedVertices[indices[i + 1]], transformedVertices[indices[i + 2]]);
+        }
+        trianglesDrawn += indexCount / 3;
+    }
+    instancesDrawn += visibleCount;
+    return (uint32_t)visibleCount;
+}
+
+void SoftwareRenderer::RasterizeTriangle(const SoftwareRasterVertex &v0, const SoftwareRasterVertex &v1, const SoftwareRasterVertex &v2) {
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (fabsf(area) < 1e-12f)
+        return;
+
+    int minX = (int)Max(floorf(Min(Min(v0.x, v1.x), v2.x)), 0.0f);
+    int minY = (int)Max(floorf(Min(Min(v0.y, v1.y), v2.y)), 0.0f);
+    int maxX = (int)Min(ceilf(Max(Max(v0.x, v1.x), v2.x)), (float)width - 1.0f);
+    int maxY = (int)Min(ceilf(Max(Max(v0.y, v1.y), v2.y)), (float)height - 1.0f);
+    if (minX > maxX || minY > maxY)
+        return;
+
+    // NOTE(pf): Culling is off in the normal pass, flip the edge functions of back facing triangles.
+    float invArea = 1.0f / area;
+    float a0 = (v1.y - v2.y) * invArea, b0 = (v2.x - v1.x) * invArea, c0 = (v1.x * v2.y - v2.x * v1.y) * invArea;
+    float a1 = (v2.y - v0.y) * invArea, b1 = (v0.x - v2.x) * invArea, c1 = (v2.x * v0.y - v0.x * v2.y) * invArea;
+
+    for (int y = minY; y <= maxY; ++y) {
+        float py = y + 0.5f;
+        float px = minX + 0.5f;
+        float w0 = a0 * px + b0 * py + c0;
+        float w1 = a1 * px + b1 * py + c1;
+        for (int x = minX; x <= maxX; ++x, w0 += a0, w1 += a1) {
+            float w2 = 1.0f - w0 - w1;
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                continue;
+
+            uint32_t pixel = y * width + x;
+            float    z = w0 * v0.z + w1 * v1.z + w2 * v2.z;
+            if (z >= depth[pixel] || z < 0.0f)
+                continue;
+            depth[pixel] = z;
+
+            float invW = 1.0f / (w0 * v0.invW + w1 * v1.invW + w2 * v2.invW);
+            float normal[3];
+            for (int k = 0; k < 3; ++k)
+                normal[k] = (w0 * v0.normalOverW[k] + w1 * v1.normalOverW[k] + w2 * v2.normalOverW[k]) * invW;
+            Normalize3(normal);
+            normals[pixel * 3 + 0] = normal[0];
+            normals[pixel * 3 + 1] = normal[1];
+            normals[pixel * 3 + 2] = normal[2];
+        }
+    }
+}
+
+void SoftwareRenderer::ComputeSsao(const Mat4 &proj) {
+    if (ssaoSettings.engine == SSAO_ENGINE_GTAO) {
+        ComputeGtao(proj);
+        return;
+    }
+
+    Mat4 invProj;
+    if (!Mat4Inverse(proj, invProj))
+        return;
+
+    // NOTE(pf): ProjTex = proj * T, T maps NDC [-1, 1]^2 to texture space [0, 1]^2.
+    Mat4 toTexture = {{0.5f, 0.0f, 0.0f, 0.0f,
+                       0.0f, -0.5f, 0.0f, 0.0f,
+                       0.0f, 0.0f, 1.0f, 0.0f,
+                       0.5f, 0.5f, 0.0f, 1.0f}};
+    Mat4 projTex = Mat4Multiply(proj, toTexture);
+    const float *pt = projTex.m;
+
+    // z_ndc = A + B / viewZ, with A = proj[2][2] and B = proj[3][2].
+    float projA = proj.m[10];
+    float projB = proj.m[14];
+    const SoftwareSsaoSettings &settings = ssaoSettings;
+    if (settings.useDepthPyramid)
+        depthPyramid.Build(depth.data(), projA, projB);
+
+    // .. point sampled like SSAOPS, taps that moved far from their pixel read the nearest depth of a coarser level ..
+    uint32_t atlasAddress = width * height * 4;
+    auto     SampleViewDepth = [&](float u, float v, float pixelX, float pixelY) {
+        float tapX = Clamp(u * width, 0.0f, (float)width - 1.0f);
+        float tapY = Clamp(v * height, 0.0f, (float)height - 1.0f);
+        int   x = (int)tapX;
+        int   y = (int)tapY;
+        if (settings.useDepthPyramid) {
+            float    dx = tapX - pixelX, dy = tapY - pixelY;
+            uint32_t level = depthPyramid.layout.LevelForDistance(sqrtf(dx * dx + dy * dy), settings.pyramidMipBias);
+            if (level > 0) {
+                const DepthPyramidLevel &rect = depthPyramid.layout.levels[level];
+                uint32_t                 texelX = (uint32_t)x >> level, texelY = (uint32_t)y >> level;
+                if (ssaoDepthReads)
+                    ssaoDepthReads->push_back(atlasAddress + ((rect.y + texelY) * depthPyramid.layout.width + rect.x + texelX) * 8);
+                return depthPyramid.MinDepth(level, texelX, texelY);
+            }
+        }
+        if (ssaoDepthReads)
+            ssaoDepthReads->push_back((y * width + x) * 4);
+        return projB / (depth[y * width + x] - projA);
+    };
+
+    const float *ssaoNormalData = ResolveSsaoNormals(proj);
+    float        fadeLength = settings.occlusionFadeEnd - settings.occlusionFadeStart;
+    int          sampleCount = settings.sampleCount < (uint32_t)SSAO_SAMPLE_COUNT ? (int)settings.sampleCount : SSAO_SAMPLE_COUNT;
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t pixel = y * width + x;
+            float    u = (x + 0.5f) / width;
+            float    v = (y + 0.5f) / height;
+
+            // .. view space position on the near plane through this pixel, what SSAOVS interpolates ..
+            float ndcX = 2.0f * u - 1.0f, ndcY = 1.0f - 2.0f * v;
+            float nearW = ndcX * invProj.m[3] + ndcY * invProj.m[7] + invProj.m[15];
+            float posV[3] = {(ndcX * invProj.m[0] + ndcY * invProj.m[4] + invProj.m[12]) / nearW,
+                             (ndcX * invProj.m[1] + ndcY * invProj.m[5] + invProj.m[13]) / nearW,
+                             (ndcX * invProj.m[2] + ndcY * invProj.m[6] + invProj.m[14]) / nearW};
+
+            float n[3] = {ssaoNormalData[pixel * 3 + 0], ssaoNormalData[pixel * 3 + 1], ssaoNormalData[pixel * 3 + 2]};
+            Normalize3(n);
+            if (ssaoDepthReads)
+                ssaoDepthReads->push_back(pixel * 4);
+            float pz = projB / (depth[pixel] - projA);
+            float p[3] = {pz / posV[2] * posV[0], pz / posV[2] * posV[1], pz};
+
+            uint32_t     randomX = (uint32_t)(4.0f * u * SSAO_RANDOM_MAP_SIZE) % SSAO_RANDOM_MAP_SIZE;
+            uint32_t     randomY = (uint32_t)(4.0f * v * SSAO_RANDOM_MAP_SIZE) % SSAO_RANDOM_MAP_SIZE;
+            const float *randVec = &ssaoRandomVectors[(randomY * SSAO_RANDOM_MAP_SIZE + randomX) * 3];
+
+            float occlusionSum = 0.0f;
+            for (int i = 0; i < sampleCount; ++i) {
+                // reflect(offset, randVec) and flip it into the hemisphere around n.
+                const float *o = ssaoOffsets[i];
+                float        d = 2.0f * Dot3(o, randVec);
+                float        offset[3] = {o[0] - d * randVec[0], o[1] - d * randVec[1], o[2] - d * randVec[2]};
+                float        dotOffset = Dot3(offset, n);
+                float        flip = dotOffset > 0.0f ? 1.0f : (dotOffset < 0.0f ? -1.0f : 0.0f);
+                float        q[3] = {p[0] + flip * settings.occlusionRadius * offset[0],
+                                     p[1] + flip * settings.occlusionRadius * offset[1],
+                                     p[2] + flip * settings.occlusionRadius * offset[2]};
+
+                float qw = q[0] * pt[3] + q[1] * pt[7] + q[2] * pt[11] + pt[15];
+                float qu = (q[0] * pt[0] + q[1] * pt[4] + q[2] * pt[8] + pt[12]) / qw;
+                float qv = (q[0] * pt[1] + q[1] * pt[5] + q[2] * pt[9] + pt[13]) / qw;
+                float rz = SampleViewDepth(qu, qv, x + 0.5f, y + 0.5f);
+                float r[3] = {rz / q[2] * q[0], rz / q[2] * q[1], rz};
+
+                float distZ = p[2] - r[2];
+                float toR[3] = {r[0] - p[0], r[1] - p[1], r[2] - p[2]};
+                Normalize3(toR);
+                float dp = Max(Dot3(n, toR), 0.0f);
+
+                float occlusion = 0.0f;
+                if (distZ > settings.surfaceEpsilon)
+                    occlusion = Clamp((settings.occlusionFadeEnd - distZ) / fadeLength, 0.0f, 1.0f);
+                occlusionSum += dp * occlusion;
+            }
+            ambient[pixel] = 1.0f - occlusionSum / sampleCount;
+        }
+    }
+}
+
+void SoftwareRenderer::ComputeGtao(const Mat4 &proj) {
+    GtaoView view = {depth.data(), ResolveSsaoNormals(proj), width, height, proj.m[10], proj.m[14], proj.m[0], proj.m[5]};
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            // .. slice and step noise from one texel of the random vector map per pixel, as GtaoPS loads it ..
+            uint32_t     randomIndex = (y % SSAO_RANDOM_MAP_SIZE) * SSAO_RANDOM_MAP_SIZE + x % SSAO_RANDOM_MAP_SIZE;
+            const float *randVec = &ssaoRandomVectors[randomIndex * 3];
+            ambient[y * width + x] = GtaoVisibility(view, ssaoSettings.gtao, x, y, 0.5f * randVec[0] + 0.5f,
+                                                    0.5f * randVec[1] + 0.5f);
+        }
+    }
+}
+
+const float *SoftwareRenderer::ResolveSsaoNormals(const Mat4 &proj) {
+    if (ssaoSettings.normalSource == SSAO_NORMALS_FLOAT)
+        return normals.data();
+
+    ssaoNormals.resize(width * height * 3);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t pixel = y * width + x;
+            float   *out = &ssaoNormals[pixel * 3];
+            if (ssaoSettings.normalSource == SSAO_NORMALS_OCTAHEDRAL)
+                UnpackOctahedralSnorm16(PackOctahedralSnorm16(&normals[pixel * 3]), out);
+            else
+                ReconstructViewNormal(depth.data(), width, height, proj.m[10], proj.m[14], proj.m[0], proj.m[5], x, y, out);
+        }
+    }
+    return ssaoNormals.data();
+}
+
+void SoftwareRenderer::Composite(bool useSsao) {
+    for (uint32_t i = 0; i < width * height; ++i) {
+        float    access = useSsao ? ambient[i] : 1.0f;
+        uint32_t c = (uint32_t)(Clamp(access, 0.0f, 1.0f) * 255.0f + 0.5f);
+        color[i] = c | (c << 8) | (c << 16) | 0xFF000000u;
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef _SOFTWARE_RENDERER_H_
+#define _SOFTWARE_RENDERER_H_
+
+/* CPU backend of the frame in DX12::UpdateAndRender: the normal pass (depth + view space normals), SSAO as
+ * in shaders/SSAOPS.hlsl or shaders/GtaoPS.hlsl and the composite of DrawSSAOPS. It exists so the pipeline
+ * can be benchmarked and used as a reference on machines without a D3D12 device.
+ *
+ * NOTE(pf): Deliberate differences from the gpu path, all cheap to keep in mind when comparing images:
+ *  - Triangles with a vertex behind the near plane are dropped instead of clipped.
+ *  - No top-left fill rule, pixels on shared edges are depth tested twice.
+ *  - The random vector map is point sampled and generated from a fixed seed instead of rand().
+ *  - SSAOPS currently returns the raw depth for debugging, this runs the full occlusion loop after it.
+ */
+
+#include "Common.h"
+#include "Culling.h"
+#include "DepthPyramid.h"
+#include "Gtao.h"
+#include "Mat4.h"
+#include "MeshData.h"
+#include "SsaoNormals.h"
+#include <vector>
+
+static constexpr int      SSAO_SAMPLE_COUNT = {14};
+static constexpr uint32_t SSAO_RANDOM_MAP_SIZE = {256};
+
+// NOTE(pf): Same values DX12SSAOPass::UploadConstants uploads.
+struct SoftwareSsaoSettings {
+    float occlusionRadius = 0.5f;
+    float occlusionFadeStart = 0.2f;
+    float occlusionFadeEnd = 1.0f;
+    float surfaceEpsilon = 0.05f;
+    // NOTE(pf): gSampleCount, 1 to SSAO_SAMPLE_COUNT, the first sampleCount offset vectors are tapped.
+    uint32_t sampleCount = SSAO_SAMPLE_COUNT;
+
+    // NOTE(pf): Taps further out read the nearest depth of a coarser DepthPyramid level, as SSAOPS does.
+    bool     useDepthPyramid = true;
+    uint32_t pyramidMipBias = DEPTH_PYRAMID_MIP_BIAS;
+
+    // NOTE(pf): GTAO only reads the depth map itself, the settings above are the hemisphere kernel's.
+    SSAO_ENGINE  engine = SSAO_ENGINE_HEMISPHERE;
+    GtaoSettings gtao;
+
+    // NOTE(pf): Both engines read the normals through the target DX12 would have, see SsaoNormals.h.
+    SSAO_NORMAL_SOURCE normalSource = SSAO_NORMALS_FLOAT;
+};
+
+struct SoftwareRasterVertex {
+    float x, y, z; // Pixels and NDC depth.
+    float invW;
+    float normalOverW[3];
+};
+
+struct SoftwareRenderer {
+    void Initialize(uint32_t width, uint32_t height, uint32_t seed = 1);
+    void BeginFrame();
+
+    // NOTE(pf): Frustum culls the instances, picks a LOD per instance like CullAndUploadInstances and
+    // rasterizes them. Returns the number of instances drawn.
+    uint32_t DrawMeshInstances(const MeshData &mesh, const Mat4 *instanceWorlds, uint32_t instanceCount,
+                               const Mat4 &view, const Mat4 &proj);
+    void     ComputeSsao(const Mat4 &proj);
+    void     ComputeGtao(const Mat4 &proj);
+    // NOTE(pf): The normals the SSAO shaders would read for ssaoSettings.normalSource.
+    const float *ResolveSsaoNormals(const Mat4 &proj);
+    void     Composite(bool useSsao);
+
+    void RasterizeTriangle(const SoftwareRasterVertex &v0, const SoftwareRasterVertex &v1, const SoftwareRasterVertex &v2);
+
+    uint32_t              width = 0;
+    uint32_t              height = 0;
+    std::vector<float>    depth;   // NDC depth, cleared to 1.
+    std::vector<float>    normals; // View space xyz per pixel, cleared to (0, 0, 1) like the normal map.
+    std::vector<float>    ambient; // Accessibility in [0, 1].
+    std::vector<uint32_t> color;   // RGBA8 result of the composite.
+
+    SoftwareSsaoSettings ssaoSettings;
+    float                ssaoOffsets[SSAO_SAMPLE_COUNT][3];
+    std::vector<float>   ssaoRandomVectors; // SSAO_RANDOM_MAP_SIZE^2 xyz in [-1, 1].
+    std::vector<float>   ssaoNormals;       // Decoded or reconstructed normals, unused for SSAO_NORMALS_FLOAT.
+    DepthPyramid         depthPyramid;
+
+    // NOTE(pf): When set, ComputeSsao appends the byte address of every depth it reads. Addresses are into the
+    // depth buffer at 4 bytes a pixel followed by the pyramid's atlas at 8 bytes a texel, like the gpu's.
+    std::vector<uint32_t> *ssaoDepthReads = nullptr;
+
+    CullSphereSoA                     instanceSpheres;
+    std::vector<uint32_t>             visibleInstances;
+    std::vector<SoftwareRasterVertex> transformedVertices;
+    std::vector<uint32_t>             transformedStamps;
+    uint32_t                          transformStamp = 0;
+
+    uint64_t trianglesDrawn = 0;
+    uint64_t instancesDrawn = 0;
+};
+
+#endif //!_SOFTWARE_RENDERER_H_
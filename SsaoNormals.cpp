@@ -0,0 +1,110 @@
+#include "SsaoNormals.h"
+#include <cmath>
+
+static float SignNotZero(float v) {
+    return v >= 0.0f ? 1.0f : -1.0f;
+}
+
+static void Normalize3(float v[3]) {
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+    v[0] *= invLength;
+    v[1] *= invLength;
+    v[2] *= invLength;
+}
+
+void OctahedralEncode(const float n[3], float out[2]) {
+    float invL1 = 1.0f / (fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]));
+    float x = n[0] * invL1, y = n[1] * invL1;
+    if (n[2] < 0.0f) {
+        // .. the lower half is folded over the diagonals onto the corners of the square ..
+        float foldedX = (1.0f - fabsf(y)) * SignNotZero(x);
+        float foldedY = (1.0f - fabsf(x)) * SignNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+    out[0] = x;
+    out[1] = y;
+}
+
+void OctahedralDecode(const float e[2], float out[3]) {
+    out[0] = e[0];
+    out[1] = e[1];
+    out[2] = 1.0f - fabsf(e[0]) - fabsf(e[1]);
+    float t = Clamp(-out[2], 0.0f, 1.0f);
+    out[0] += out[0] >= 0.0f ? -t : t;
+    out[1] += out[1] >= 0.0f ? -t : t;
+    Normalize3(out);
+}
+
+uint32_t PackOctahedralSnorm16(const float n[3]) {
+    float e[2];
+    OctahedralEncode(n, e);
+    int32_t x = (int32_t)lrintf(Clamp(e[0], -1.0f, 1.0f) * 32767.0f);
+    int32_t y = (int32_t)lrintf(Clamp(e[1], -1.0f, 1.0f) * 32767.0f);
+    return ((uint32_t)x & 0xFFFFu) | (((uint32_t)y & 0xFFFFu) << 16);
+}
+
+void UnpackOctahedralSnorm16(uint32_t packed, float out[3]) {
+    // NOTE(pf): D3D snorm, -32768 and -32767 both map to -1.
+    float e[2] = {Max((int16_t)(packed & 0xFFFFu) / 32767.0f, -1.0f), Max((int16_t)(packed >> 16) / 32767.0f, -1.0f)};
+    OctahedralDecode(e, out);
+}
+
+void ReconstructViewNormal(const float *ndcDepth, uint32_t width, uint32_t height, float projA, float projB,
+                           float proj00, float proj11, uint32_t x, uint32_t y, float out[3]) {
+    out[0] = 0.0f;
+    out[1] = 0.0f;
+    out[2] = 1.0f;
+    float center = ndcDepth[y * width + x];
+    if (center >= 1.0f || width < 2 || height < 2)
+        return;
+
+    auto Position = [&](uint32_t tx, uint32_t ty, float p[3]) {
+        float ndcX = 2.0f * (tx + 0.5f) / width - 1.0f;
+        float ndcY = 1.0f - 2.0f * (ty + 0.5f) / height;
+        float z = projB / (ndcDepth[ty * width + tx] - projA);
+        p[0] = ndcX * z / proj00;
+        p[1] = ndcY * z / proj11;
+        p[2] = z;
+    };
+    // .. how far the two texels on one side miss the pixel's depth when extrapolated, missing texels never win ..
+    auto ExtrapolationError = [&](int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+        if (x1 < 0 || y1 < 0 || x1 >= (int32_t)width || y1 >= (int32_t)height)
+            return INFINITY;
+        float d1 = ndcDepth[y1 * width + x1];
+        if (x2 < 0 || y2 < 0 || x2 >= (int32_t)width || y2 >= (int32_t)height)
+            return fabsf(d1 - center) + 1.0f; // Only the near neighbour, still better than nothing.
+        return fabsf(2.0f * d1 - ndcDepth[y2 * width + x2] - center);
+    };
+
+    float   p[3], q[3];
+    int32_t ix = (int32_t)x, iy = (int32_t)y;
+    Position(x, y, p);
+
+    // .. screen right ..
+    float dx[3];
+    bool  useLeft = ExtrapolationError(ix - 1, iy, ix - 2, iy) < ExtrapolationError(ix + 1, iy, ix + 2, iy);
+    Position(useLeft ? x - 1 : x + 1, y, q);
+    float sx = useLeft ? -1.0f : 1.0f;
+    dx[0] = sx * (q[0] - p[0]);
+    dx[1] = sx * (q[1] - p[1]);
+    dx[2] = sx * (q[2] - p[2]);
+
+    // .. screen down ..
+    float dy[3];
+    bool  useUp = ExtrapolationError(ix, iy - 1, ix, iy - 2) < ExtrapolationError(ix, iy + 1, ix, iy + 2);
+    Position(x, useUp ? y - 1 : y + 1, q);
+    float sy = useUp ? -1.0f : 1.0f;
+    dy[0] = sy * (q[0] - p[0]);
+    dy[1] = sy * (q[1] - p[1]);
+    dy[2] = sy * (q[2] - p[2]);
+
+    // NOTE(pf): Left handed, right x down is towards the viewer.
+    out[0] = dx[1] * dy[2] - dx[2] * dy[1];
+    out[1] = dx[2] * dy[0] - dx[0] * dy[2];
+    out[2] = dx[0] * dy[1] - dx[1] * dy[0];
+    Normalize3(out);
+    if (out[0] == 0.0f && out[1] == 0.0f && out[2] == 0.0f)
+        out[2] = 1.0f;
+}
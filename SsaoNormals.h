@@ -0,0 +1,45 @@
+#ifndef _SSAO_NORMALS_H_
+#define _SSAO_NORMALS_H_
+
+/* Where SSAO gets its view space normals from, the CPU reference of shaders/NormalEncoding.hlsl and of
+ * LoadViewNormal in shaders/CommonSSAO.hlsl.
+ *
+ * The normal pass used to render the scene a second time only to write an R16G16B16A16_FLOAT target, 8 bytes
+ * a pixel written and read back. Octahedral packing keeps the pass but halves the target: the unit vector is
+ * folded onto the octahedron |x| + |y| + |z| = 1 and the octahedron unfolded into the [-1, 1] square, two
+ * snorm16 channels. Reconstruction drops the target and the pass' color writes altogether, the normal is the
+ * cross product of the view space positions of neighbouring depth texels.
+ *
+ * NOTE(pf): Differencing the nearest neighbours alone puts silhouettes in the normal, a pixel on the skull
+ * next to the background gets a normal pointing along the depth discontinuity. NDC depth is linear in screen
+ * space on any plane, so per axis the side whose two neighbours extrapolate best to the pixel's own depth is
+ * on the pixel's surface and the difference is taken on that side (Wu, "Accurate Normal Reconstruction from
+ * Depth Buffer"). What remains are faceted normals where the gbuffer has interpolated ones.
+ */
+
+#include "Common.h"
+
+// NOTE(pf): Picked when DX12 is initialized, the normal target's format and the shaders depend on it.
+enum SSAO_NORMAL_SOURCE : uint32_t {
+    SSAO_NORMALS_FLOAT,      // R16G16B16A16_FLOAT target written by NormalsPS, 8 bytes a pixel.
+    SSAO_NORMALS_OCTAHEDRAL, // R16G16_SNORM octahedral target written by NormalsPS, 4 bytes a pixel.
+    SSAO_NORMALS_FROM_DEPTH, // No target, reconstructed from the depth buffer by the SSAO shaders.
+    SSAO_NORMAL_SOURCE_COUNT
+};
+
+static constexpr uint32_t SSAO_NORMAL_BYTES_PER_PIXEL[SSAO_NORMAL_SOURCE_COUNT] = {8, 4, 0};
+
+// NOTE(pf): Encode maps a unit vector to [-1, 1]^2, Decode returns a unit vector. The packed variants round
+// to the snorm16 channels of the target, x in the low 16 bits.
+void     OctahedralEncode(const float n[3], float out[2]);
+void     OctahedralDecode(const float e[2], float out[3]);
+uint32_t PackOctahedralSnorm16(const float n[3]);
+void     UnpackOctahedralSnorm16(uint32_t packed, float out[3]);
+
+// NOTE(pf): View space normal of texel (x, y) of a width x height NDC depth buffer, view depth is
+// projB / (ndc - projA) and proj00, proj11 the projection's x and y scale like GtaoView. Cleared texels and
+// buffers too small to difference get (0, 0, 1), the normal target's clear value.
+void ReconstructViewNormal(const float *ndcDepth, uint32_t width, uint32_t height, float projA, float projB,
+                           float proj00, float proj11, uint32_t x, uint32_t y, float out[3]);
+
+#endif //!_SSAO_NORMALS_H_
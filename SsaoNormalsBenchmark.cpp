@@ -0,0 +1,214 @@
+/* Error metrics of the SSAO normal sources in SsaoNormals.h, portable so it runs on the Linux build farm:
+ *   g++ -O2 -std=c++17 SsaoNormalsBenchmark.cpp SsaoNormals.cpp Gtao.cpp DepthPyramid.cpp SoftwareRenderer.cpp
+ *       MeshData.cpp Culling.cpp Mat4.cpp Timer.cpp -o SsaoNormalsBenchmark
+ *   ./SsaoNormalsBenchmark [--model models/skull.txt]
+ *
+ * Octahedral snorm16 is round tripped on random unit vectors next to plain xyz in R10G10B10A2 for scale. On
+ * the skull scene of Benchmark the normals reconstructed from depth are compared against the rasterized ones,
+ * along with the nearest neighbour differences the edge aware reconstruction replaces, and both SSAO engines
+ * are run on every source to see what the error costs in accessibility.
+ * The exit code is 1 if the octahedral error exceeds its bound or the reconstruction does worse than nearest
+ * neighbour differencing.
+ */
+
+#include "Mat4.h"
+#include "MeshData.h"
+#include "SoftwareRenderer.h"
+#include "SsaoNormals.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t NORMAL_RANDOM_VECTORS = {1 << 20};
+static constexpr uint32_t NORMAL_SCENE_FRAMES = {4};
+static constexpr double   OCTAHEDRAL_MAX_ERROR_DEGREES = {0.02};
+static constexpr double   NORMAL_OUTLIER_DEGREES = {30.0};
+
+static const char *sourceNames[SSAO_NORMAL_SOURCE_COUNT] = {"float", "octahedral", "from_depth"};
+
+struct AngleStats {
+    double sum = 0.0;
+    double max = 0.0;
+    double outliers = 0.0;
+    double count = 0.0;
+
+    void Add(const float a[3], const float b[3]) {
+        // NOTE(pf): atan2 of the cross and dot products, acos loses everything below ~0.02 degrees in rounding.
+        double cx = (double)a[1] * b[2] - (double)a[2] * b[1];
+        double cy = (double)a[2] * b[0] - (double)a[0] * b[2];
+        double cz = (double)a[0] * b[1] - (double)a[1] * b[0];
+        double d = (double)a[0] * b[0] + (double)a[1] * b[1] + (double)a[2] * b[2];
+        double degrees = atan2(sqrt(cx * cx + cy * cy + cz * cz), d) * (180.0 / 3.14159265358979);
+        sum += degrees;
+        max = degrees > max ? degrees : max;
+        outliers += degrees > NORMAL_OUTLIER_DEGREES;
+        count += 1.0;
+    }
+    double Mean() const { return count > 0.0 ? sum / count : 0.0; }
+};
+
+static float NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+static void Normalize3(float v[3]) {
+    float invLength = 1.0f / sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    v[0] *= invLength;
+    v[1] *= invLength;
+    v[2] *= invLength;
+}
+
+// .. xyz * 0.5 + 0.5 in three 10 bit unorm channels, renormalized when read ..
+static void RoundTripUnorm10(const float n[3], float out[3]) {
+    for (int k = 0; k < 3; ++k) {
+        float quantized = floorf((n[k] * 0.5f + 0.5f) * 1023.0f + 0.5f) / 1023.0f;
+        out[k] = quantized * 2.0f - 1.0f;
+    }
+    Normalize3(out);
+}
+
+// NOTE(pf): What ddx/ddy of the view position would give, always the right and lower neighbour.
+static void NearestDifferenceNormal(const SoftwareRenderer &renderer, const Mat4 &proj, uint32_t x, uint32_t y, float out[3]) {
+    auto Position = [&](uint32_t tx, uint32_t ty, float p[3]) {
+        float ndcX = 2.0f * (tx + 0.5f) / renderer.width - 1.0f;
+        float ndcY = 1.0f - 2.0f * (ty + 0.5f) / renderer.height;
+        float z = proj.m[14] / (renderer.depth[ty * renderer.width + tx] - proj.m[10]);
+        p[0] = ndcX * z / proj.m[0];
+        p[1] = ndcY * z / proj.m[5];
+        p[2] = z;
+    };
+    float p[3], right[3], down[3];
+    Position(x, y, p);
+    Position(x + 1, y, right);
+    Position(x, y + 1, down);
+    float dx[3] = {right[0] - p[0], right[1] - p[1], right[2] - p[2]};
+    float dy[3] = {down[0] - p[0], down[1] - p[1], down[2] - p[2]};
+    out[0] = dx[1] * dy[2] - dx[2] * dy[1];
+    out[1] = dx[2] * dy[0] - dx[0] * dy[2];
+    out[2] = dx[0] * dy[1] - dx[1] * dy[0];
+    Normalize3(out);
+}
+
+static void BuildScene(double time, uint32_t width, uint32_t height, Mat4 &world, Mat4 &view, Mat4 &proj) {
+    float angle = ConvertToRadians(fmodf((float)(time * 90.0), 360.0f));
+    world = Mat4RotationAxis(0.0f, 1.0f, 1.0f, angle);
+
+    const float eye[3] = {0.0f, 5.0f, -25.0f};
+    const float focus[3] = {0.0f, 0.0f, 0.0f};
+    const float up[3] = {0.0f, 1.0f, 0.0f};
+    view = Mat4LookAtLH(eye, focus, up);
+    proj = Mat4PerspectiveFovLH(ConvertToRadians(45.0f), width / (float)height, 1.0f, 1000.0f);
+}
+
+int main(int argc, char **argv) {
+    const char *modelPath = "models/skull.txt";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+    }
+
+    // .. encodings on uniformly distributed unit vectors ..
+    AngleStats octahedral, unorm10;
+    uint32_t   state = 1;
+    for (uint32_t i = 0; i < NORMAL_RANDOM_VECTORS; ++i) {
+        float z = 2.0f * NextRandom(state) - 1.0f;
+        float phi = 6.28318531f * NextRandom(state);
+        float r = sqrtf(Max(1.0f - z * z, 0.0f));
+        float n[3] = {r * cosf(phi), r * sinf(phi), z};
+        Normalize3(n);
+
+        float decoded[3];
+        UnpackOctahedralSnorm16(PackOctahedralSnorm16(n), decoded);
+        octahedral.Add(n, decoded);
+        RoundTripUnorm10(n, decoded);
+        unorm10.Add(n, decoded);
+    }
+    printf("{\"benchmark\": \"ssao_normals\",\n  \"encodings\": [\n");
+    printf("    {\"encoding\": \"octahedral_r16g16_snorm\", \"bytes\": 4, \"mean_degrees\": %.5f, \"max_degrees\": %.5f},\n",
+           octahedral.Mean(), octahedral.max);
+    printf("    {\"encoding\": \"xyz_r10g10b10a2_unorm\", \"bytes\": 4, \"mean_degrees\": %.5f, \"max_degrees\": %.5f}\n  ]",
+           unorm10.Mean(), unorm10.max);
+
+    bool     reconstructionWorse = false;
+    MeshData mesh;
+    if (LoadTextMesh(modelPath, mesh)) {
+        const uint32_t width = 1280, height = 720;
+        SoftwareRenderer renderer;
+        renderer.Initialize(width, height);
+
+        AngleStats         reconstructed, nearest;
+        double             reconstructMs = 0.0, coveredPixels = 0.0;
+        double             ambientError[2][SSAO_NORMAL_SOURCE_COUNT] = {}; // Hemisphere and GTAO.
+        std::vector<float> floatAmbient;
+        for (uint32_t frame = 0; frame < NORMAL_SCENE_FRAMES; ++frame) {
+            Mat4 world, view, proj;
+            BuildScene(frame * 0.25, width, height, world, view, proj);
+            renderer.BeginFrame();
+            renderer.DrawMeshInstances(mesh, &world, 1, view, proj);
+
+            renderer.ssaoSettings.normalSource = SSAO_NORMALS_FROM_DEPTH;
+            int64_t      start = HiResPerformanceQuery();
+            const float *fromDepth = renderer.ResolveSsaoNormals(proj);
+            reconstructMs += HiResMilliseconds(HiResPerformanceQuery() - start) / NORMAL_SCENE_FRAMES;
+            for (uint32_t y = 0; y + 1 < height; ++y) {
+                for (uint32_t x = 0; x + 1 < width; ++x) {
+                    uint32_t pixel = y * width + x;
+                    if (renderer.depth[pixel] >= 1.0f)
+                        continue;
+                    float naive[3];
+                    NearestDifferenceNormal(renderer, proj, x, y, naive);
+                    reconstructed.Add(&renderer.normals[pixel * 3], &fromDepth[pixel * 3]);
+                    nearest.Add(&renderer.normals[pixel * 3], naive);
+                    coveredPixels += 1.0;
+                }
+            }
+
+            // .. accessibility with every source against the float target's ..
+            for (int engine = 0; engine < 2; ++engine) {
+                renderer.ssaoSettings.engine = engine ? SSAO_ENGINE_GTAO : SSAO_ENGINE_HEMISPHERE;
+                for (uint32_t source = 0; source < SSAO_NORMAL_SOURCE_COUNT; ++source) {
+                    renderer.ssaoSettings.normalSource = (SSAO_NORMAL_SOURCE)source;
+                    renderer.ComputeSsao(proj);
+                    if (source == SSAO_NORMALS_FLOAT) {
+                        floatAmbient = renderer.ambient;
+                        continue;
+                    }
+                    for (uint32_t i = 0; i < width * height; ++i) {
+                        if (renderer.depth[i] < 1.0f)
+                            ambientError[engine][source] += fabs((double)renderer.ambient[i] - floatAmbient[i]);
+                    }
+                }
+            }
+        }
+
+        printf(",\n  \"scene\": {\"width\": %u, \"height\": %u, \"frames\": %u, \"reconstruct_ms\": %.3f,\n", width, height,
+               NORMAL_SCENE_FRAMES, reconstructMs);
+        printf("    \"from_depth\": {\"mean_degrees\": %.3f, \"over_%.0f_degrees\": %.5f},\n", reconstructed.Mean(),
+               NORMAL_OUTLIER_DEGREES, reconstructed.outliers / reconstructed.count);
+        printf("    \"nearest_difference\": {\"mean_degrees\": %.3f, \"over_%.0f_degrees\": %.5f},\n", nearest.Mean(),
+               NORMAL_OUTLIER_DEGREES, nearest.outliers / nearest.count);
+        printf("    \"sources\": [");
+        for (uint32_t source = 0; source < SSAO_NORMAL_SOURCE_COUNT; ++source) {
+            printf("%s\n      {\"source\": \"%s\", \"target_bytes_per_pixel\": %u, \"hemisphere_ambient_error\": %.6f, "
+                   "\"gtao_ambient_error\": %.6f}",
+                   source == 0 ? "" : ",", sourceNames[source], SSAO_NORMAL_BYTES_PER_PIXEL[source],
+                   ambientError[0][source] / coveredPixels, ambientError[1][source] / coveredPixels);
+        }
+        printf("\n    ]}");
+        reconstructionWorse = !(reconstructed.Mean() <= nearest.Mean());
+    } else {
+        fprintf(stderr, "Failed to load %s, skipping the scene\n", modelPath);
+    }
+    printf("\n}\n");
+
+    bool octahedralTooCoarse = !(octahedral.max <= OCTAHEDRAL_MAX_ERROR_DEGREES);
+    if (octahedralTooCoarse || reconstructionWorse) {
+        fprintf(stderr, "%s\n", octahedralTooCoarse ? "Octahedral normals exceed their error bound"
+                                                    : "Reconstructed normals are worse than nearest neighbour differences");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "TaskPool.h"
+#include "Profiler.h"
+#include <stdio.h>
+
+void TaskPool::Initialize(uint32_t workerCount) {
+    if (workerCount == 0)
+        workerCount = PlatformProcessorCount() - 1;
+    quit.store(false);
+    wakeEvents.resize(workerCount);
+    PlatformCreateEvent(doneEvent);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        PlatformCreateEvent(wakeEvents[i]);
+    }
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&TaskPool::WorkerThread, this, i);
+    }
+}
+
+void TaskPool::CleanUp() {
+    quit.store(true, std::memory_order_release);
+    for (PlatformEvent &event : wakeEvents) {
+        PlatformSignalEvent(event);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    for (PlatformEvent &event : wakeEvents) {
+        PlatformDestroyEvent(event);
+    }
+    if (doneEvent.handle)
+        PlatformDestroyEvent(doneEvent);
+    workers.clear();
+    wakeEvents.clear();
+}
+
+void TaskPool::RunChunks() {
+    for (;;) {
+        uint32_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= chunkCount)
+            return;
+        uint32_t begin = chunk * chunkSize;
+        uint32_t end = count - begin < chunkSize ? count : begin + chunkSize;
+        function(context, begin, end);
+    }
+}
+
+void TaskPool::Run(uint32_t _count, uint32_t _chunkSize, TaskFunction *_function, void *_context) {
+    _chunkSize = _chunkSize ? _chunkSize : 1;
+    uint32_t _chunkCount = (_count + _chunkSize - 1) / _chunkSize;
+    if (_chunkCount <= 1 || workers.empty()) {
+        for (uint32_t begin = 0; begin < _count; begin += _chunkSize)
+            _function(_context, begin, _count - begin < _chunkSize ? _count : begin + _chunkSize);
+        return;
+    }
+
+    function = _function;
+    context = _context;
+    count = _count;
+    chunkSize = _chunkSize;
+    chunkCount = _chunkCount;
+    nextChunk.store(0, std::memory_order_relaxed);
+
+    // NOTE(pf): Only wake as many workers as there are chunks besides the caller's first one.
+    uint32_t wakeCount = (uint32_t)workers.size() < _chunkCount - 1 ? (uint32_t)workers.size() : _chunkCount - 1;
+    busyWorkers.store(wakeCount, std::memory_order_release);
+    for (uint32_t i = 0; i < wakeCount; ++i) {
+        PlatformSignalEvent(wakeEvents[i]);
+    }
+
+    RunChunks();
+    // .. a worker may still be inside its last chunk, the loop's state has to outlive it ..
+    while (busyWorkers.load(std::memory_order_acquire) != 0) {
+        PlatformWaitEvent(doneEvent, TASK_POOL_IDLE_WAIT_MS);
+    }
+}
+
+void TaskPool::WorkerThread(uint32_t index) {
+    char name[32];
+    snprintf(name, sizeof(name), "Task worker %u", index);
+    ProfilerSetThreadName(name);
+    PlatformSetThreadName(name);
+
+    for (;;) {
+        if (!PlatformWaitEvent(wakeEvents[index], TASK_POOL_IDLE_WAIT_MS))
+            continue;
+        if (quit.load(std::memory_order_acquire))
+            return;
+        RunChunks();
+        if (busyWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            PlatformSignalEvent(doneEvent);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef _TASK_POOL_H_
+#define _TASK_POOL_H_
+
+/* Worker threads for data parallel loops over the engine's SoA arrays.
+ *
+ * NOTE(pf): ParallelFor splits [0, count) into chunks that the workers and the calling thread pull from a shared
+ * counter and returns once every chunk is done. One loop runs at a time, so call it from one thread only and
+ * never from inside a task.
+ */
+
+#include "Platform.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t TASK_POOL_IDLE_WAIT_MS = {100};
+
+typedef void TaskFunction(void *context, uint32_t begin, uint32_t end);
+
+struct TaskPool {
+    // NOTE(pf): workerCount 0 starts one worker per processor besides the calling thread.
+    void     Initialize(uint32_t workerCount = 0);
+    void     CleanUp();
+    void     Run(uint32_t count, uint32_t chunkSize, TaskFunction *function, void *context);
+    uint32_t ThreadCount() const { return (uint32_t)workers.size() + 1; }
+
+    // task(begin, end) for every chunk of at most chunkSize.
+    template <typename F> void ParallelFor(uint32_t count, uint32_t chunkSize, const F &task) {
+        Run(count, chunkSize, [](void *context, uint32_t begin, uint32_t end) { (*(const F *)context)(begin, end); },
+            (void *)&task);
+    }
+
+  private:
+    void WorkerThread(uint32_t index);
+    void RunChunks();
+
+    std::vector<std::thread>   workers;
+    std::vector<PlatformEvent> wakeEvents;
+    PlatformEvent              doneEvent;
+    std::atomic<bool>          quit = {false};
+
+    // .. the loop in flight, written before the workers are woken ..
+    TaskFunction         *function = {nullptr};
+    void                 *context = {nullptr};
+    uint32_t              count = {0};
+    uint32_t              chunkSize = {1};
+    uint32_t              chunkCount = {0};
+    std::atomic<uint32_t> nextChunk = {0};
+    std::atomic<uint32_t> busyWorkers = {0};
+};
+
+#endif //!_TASK_POOL_H_
@@ -0,0 +1,39 @@
+#include "Timer.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+static int64_t QueryPerformanceFreq() {
+    LARGE_INTEGER countsPerSec;
+    QueryPerformanceFrequency(&countsPerSec);
+    int64_t result = countsPerSec.QuadPart;
+    return result;
+}
+
+int64_t HiResPerformanceFreq() {
+    // NOTE(pf): Fixed at boot, so it is only queried once.
+    static const int64_t frequency = QueryPerformanceFreq();
+    return frequency;
+}
+
+int64_t HiResPerformanceQuery() {
+    LARGE_INTEGER currentTime;
+    QueryPerformanceCounter(&currentTime);
+    int64_t result = currentTime.QuadPart;
+    return result;
+}
+#else
+#include <time.h>
+
+int64_t HiResPerformanceFreq() {
+    return 1000000000LL;
+}
+
+int64_t HiResPerformanceQuery() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t result = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    return result;
+}
+#endif
@@ -0,0 +1,19 @@
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+#include "Common.h"
+
+// NOTE(pf): Monotonic high resolution clock. QueryPerformanceCounter on Windows, clock_gettime(CLOCK_MONOTONIC)
+// elsewhere, in which case a tick is a nanosecond.
+int64_t HiResPerformanceFreq();
+int64_t HiResPerformanceQuery();
+
+inline double HiResSeconds(int64_t ticks) {
+    return ticks / (double)HiResPerformanceFreq();
+}
+
+inline double HiResMilliseconds(int64_t ticks) {
+    return ticks * 1000.0 / (double)HiResPerformanceFreq();
+}
+
+#endif //!_TIMER_H_
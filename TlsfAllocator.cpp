@@ -0,0 +1,250 @@
+#include "TlsfAllocator.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static uint32_t LowestBit(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+static uint32_t HighestBit(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, v);
+    return (uint32_t)index;
+#else
+    return 31u - (uint32_t)__builtin_clz(v);
+#endif
+}
+
+// .. the bin a block of size belongs to, its size rounded down ..
+static void BinOf(uint32_t size, uint32_t &fl, uint32_t &sl) {
+    if (size < TLSF_SL_COUNT) {
+        fl = 0;
+        sl = size;
+    } else {
+        uint32_t msb = HighestBit(size);
+        fl = msb - TLSF_SL_LOG2 + 1;
+        sl = (size >> (msb - TLSF_SL_LOG2)) - TLSF_SL_COUNT;
+    }
+}
+
+void TlsfAllocator::Initialize(uint32_t _size, uint32_t maxAllocations) {
+    size = _size;
+    freeUnits = _size;
+    allocationCount = 0;
+    flBitmap = 0;
+    for (uint32_t fl = 0; fl < TLSF_FL_COUNT; ++fl) {
+        slBitmaps[fl] = 0;
+        for (uint32_t sl = 0; sl < TLSF_SL_COUNT; ++sl)
+            bins[fl][sl] = TLSF_NONE;
+    }
+
+    nodes.assign(2 * (size_t)maxAllocations + 1, TlsfNode{});
+    spareNodes = TLSF_NONE;
+    for (uint32_t i = (uint32_t)nodes.size(); i-- > 0;)
+        ReleaseNode(i);
+
+    firstPhysical = TLSF_NONE;
+    if (_size > 0) {
+        firstPhysical = TakeSpareNode();
+        TlsfNode &node = nodes[firstPhysical];
+        node.offset = 0;
+        node.size = _size;
+        node.prevPhysical = TLSF_NONE;
+        node.nextPhysical = TLSF_NONE;
+        node.used = false;
+        InsertFree(firstPhysical);
+    }
+}
+
+uint32_t TlsfAllocator::TakeSpareNode() {
+    uint32_t node = spareNodes;
+    if (node != TLSF_NONE)
+        spareNodes = nodes[node].nextFree;
+    return node;
+}
+
+void TlsfAllocator::ReleaseNode(uint32_t node) {
+    nodes[node].nextFree = spareNodes;
+    nodes[node].used = false;
+    spareNodes = node;
+}
+
+void TlsfAllocator::InsertFree(uint32_t node) {
+    uint32_t fl, sl;
+    BinOf(nodes[node].size, fl, sl);
+    uint32_t head = bins[fl][sl];
+    nodes[node].prevFree = TLSF_NONE;
+    nodes[node].nextFree = head;
+    if (head != TLSF_NONE)
+        nodes[head].prevFree = node;
+    bins[fl][sl] = node;
+    flBitmap |= 1u << fl;
+    slBitmaps[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t node) {
+    const TlsfNode &n = nodes[node];
+    if (n.prevFree != TLSF_NONE) {
+        nodes[n.prevFree].nextFree = n.nextFree;
+    } else {
+        uint32_t fl, sl;
+        BinOf(n.size, fl, sl);
+        bins[fl][sl] = n.nextFree;
+        if (n.nextFree == TLSF_NONE) {
+            slBitmaps[fl] &= ~(1u << sl);
+            if (slBitmaps[fl] == 0)
+                flBitmap &= ~(1u << fl);
+        }
+    }
+    if (n.nextFree != TLSF_NONE)
+        nodes[n.nextFree].prevFree = n.prevFree;
+}
+
+uint32_t TlsfAllocator::Allocate(uint32_t request) {
+    if (request == 0 || request > freeUnits)
+        return TLSF_NONE;
+
+    // .. round up to the next bin, every block in it or above fits ..
+    uint64_t rounded = request;
+    if (request >= TLSF_SL_COUNT)
+        rounded += (1ull << (HighestBit(request) - TLSF_SL_LOG2)) - 1;
+    if (rounded > 0xffffffffull)
+        return TLSF_NONE;
+    uint32_t fl, sl;
+    BinOf((uint32_t)rounded, fl, sl);
+
+    uint32_t slMap = slBitmaps[fl] & (~0u << sl);
+    if (slMap == 0) {
+        uint32_t flMap = fl + 1 < 32 ? flBitmap & (~0u << (fl + 1)) : 0;
+        if (flMap == 0)
+            return TLSF_NONE;
+        fl = LowestBit(flMap);
+        slMap = slBitmaps[fl];
+    }
+    sl = LowestBit(slMap);
+
+    uint32_t  block = bins[fl][sl];
+    TlsfNode &node = nodes[block];
+    RemoveFree(block);
+
+    // .. split the rest off, without a spare node the whole block goes ..
+    if (node.size > request && spareNodes != TLSF_NONE) {
+        uint32_t  rest = TakeSpareNode();
+        TlsfNode &restNode = nodes[rest];
+        restNode.offset = node.offset + request;
+        restNode.size = node.size - request;
+        restNode.prevPhysical = block;
+        restNode.nextPhysical = node.nextPhysical;
+        restNode.used = false;
+        if (node.nextPhysical != TLSF_NONE)
+            nodes[node.nextPhysical].prevPhysical = rest;
+        node.nextPhysical = rest;
+        node.size = request;
+        InsertFree(rest);
+    }
+
+    node.used = true;
+    freeUnits -= node.size;
+    allocationCount++;
+    return block;
+}
+
+void TlsfAllocator::Free(uint32_t allocation) {
+    assert(allocation < nodes.size() && nodes[allocation].used);
+    uint32_t block = allocation;
+    nodes[block].used = false;
+    freeUnits += nodes[block].size;
+    allocationCount--;
+
+    // .. merge with the free neighbours, the block stays in address order ..
+    uint32_t next = nodes[block].nextPhysical;
+    if (next != TLSF_NONE && !nodes[next].used) {
+        RemoveFree(next);
+        nodes[block].size += nodes[next].size;
+        nodes[block].nextPhysical = nodes[next].nextPhysical;
+        if (nodes[next].nextPhysical != TLSF_NONE)
+            nodes[nodes[next].nextPhysical].prevPhysical = block;
+        ReleaseNode(next);
+    }
+    uint32_t prev = nodes[block].prevPhysical;
+    if (prev != TLSF_NONE && !nodes[prev].used) {
+        RemoveFree(prev);
+        nodes[prev].size += nodes[block].size;
+        nodes[prev].nextPhysical = nodes[block].nextPhysical;
+        if (nodes[block].nextPhysical != TLSF_NONE)
+            nodes[nodes[block].nextPhysical].prevPhysical = prev;
+        ReleaseNode(block);
+        block = prev;
+    }
+    InsertFree(block);
+}
+
+uint32_t TlsfAllocator::LargestFree() const {
+    if (flBitmap == 0)
+        return 0;
+    uint32_t fl = HighestBit(flBitmap);
+    uint32_t sl = HighestBit(slBitmaps[fl]);
+    uint32_t result = 0;
+    for (uint32_t n = bins[fl][sl]; n != TLSF_NONE; n = nodes[n].nextFree)
+        result = nodes[n].size > result ? nodes[n].size : result;
+    return result;
+}
+
+uint32_t TlsfAllocator::Defragment(uint32_t maxUnits, std::vector<TlsfMove> &moves) {
+    uint32_t moved = 0;
+    uint32_t block = firstPhysical;
+    while (block != TLSF_NONE) {
+        if (nodes[block].used) {
+            block = nodes[block].nextPhysical;
+            continue;
+        }
+
+        // .. free blocks are merged, so the next one is an allocation ..
+        uint32_t next = nodes[block].nextPhysical;
+        if (next == TLSF_NONE)
+            break;
+        TlsfNode &hole = nodes[block];
+        TlsfNode &allocation = nodes[next];
+        if (moved > 0 && moved + allocation.size > maxUnits)
+            break;
+        moves.push_back({next, allocation.offset, hole.offset, allocation.size});
+        moved += allocation.size;
+
+        // .. swap the two in address order, the hole then merges with a free block after it ..
+        RemoveFree(block);
+        uint32_t prev = hole.prevPhysical;
+        uint32_t after = allocation.nextPhysical;
+        allocation.offset = hole.offset;
+        hole.offset = allocation.offset + allocation.size;
+        allocation.prevPhysical = prev;
+        allocation.nextPhysical = block;
+        hole.prevPhysical = next;
+        hole.nextPhysical = after;
+        if (prev != TLSF_NONE)
+            nodes[prev].nextPhysical = next;
+        else
+            firstPhysical = next;
+        if (after != TLSF_NONE)
+            nodes[after].prevPhysical = block;
+
+        if (after != TLSF_NONE && !nodes[after].used) {
+            RemoveFree(after);
+            hole.size += nodes[after].size;
+            hole.nextPhysical = nodes[after].nextPhysical;
+            if (hole.nextPhysical != TLSF_NONE)
+                nodes[hole.nextPhysical].prevPhysical = block;
+            ReleaseNode(after);
+        }
+        InsertFree(block);
+    }
+    return moved;
+}
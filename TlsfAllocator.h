@@ -0,0 +1,76 @@
+#ifndef _TLSF_ALLOCATOR_H_
+#define _TLSF_ALLOCATOR_H_
+
+/* Two level segregated fit allocator over a range of units. It only hands out offsets and never touches the
+ * memory, so it sub-allocates gpu buffers as well, see DX12GeometryBuffer.
+ *
+ * NOTE(pf): Free blocks are binned by size, the first level by their power of two and the second splits every
+ * power into TLSF_SL_COUNT linear steps. A bitmap per level finds the first non-empty bin whose blocks all fit
+ * a request, the search rounds the request up to the next bin, so allocation takes the head of that bin and
+ * splits the rest off. Freeing merges the block with its free neighbours in address order. Both are O(1).
+ * Allocations are ids into a fixed pool of nodes, Defragment slides them towards offset 0 and only their
+ * offsets change.
+ */
+
+#include "Common.h"
+#include <vector>
+
+static constexpr uint32_t TLSF_SL_LOG2 = {4};
+static constexpr uint32_t TLSF_SL_COUNT = {1u << TLSF_SL_LOG2};
+static constexpr uint32_t TLSF_FL_COUNT = {32 - TLSF_SL_LOG2 + 1}; // Sizes up to 2^32 - 1, sizes below TLSF_SL_COUNT share the first.
+static constexpr uint32_t TLSF_NONE = {0xffffffffu};
+
+struct TlsfNode {
+    uint32_t offset;
+    uint32_t size;
+    uint32_t prevPhysical; // Neighbours in address order.
+    uint32_t nextPhysical;
+    uint32_t prevFree; // Bin list of a free block, nextFree also links the spare nodes.
+    uint32_t nextFree;
+    bool     used;
+};
+
+// NOTE(pf): from and to may overlap, the contents have to move as if through a copy.
+struct TlsfMove {
+    uint32_t allocation;
+    uint32_t from;
+    uint32_t to;
+    uint32_t size;
+};
+
+struct TlsfAllocator {
+    // NOTE(pf): maxAllocations live at once, every one of them can leave a free block behind.
+    void Initialize(uint32_t size, uint32_t maxAllocations);
+
+    // NOTE(pf): Returns the allocation's id, TLSF_NONE when no free block fits or the nodes ran out.
+    uint32_t Allocate(uint32_t size);
+    void     Free(uint32_t allocation);
+    uint32_t Offset(uint32_t allocation) const { return nodes[allocation].offset; }
+    uint32_t Size(uint32_t allocation) const { return nodes[allocation].size; }
+
+    uint32_t FreeUnits() const { return freeUnits; }
+    uint32_t LargestFree() const;
+    uint32_t AllocationCount() const { return allocationCount; }
+
+    // NOTE(pf): Slides allocations down over the free blocks before them in address order, appending every move,
+    // until more than maxUnits would have moved. The first move is always made. Returns the units moved, 0 once
+    // all free space is at the end.
+    uint32_t Defragment(uint32_t maxUnits, std::vector<TlsfMove> &moves);
+
+    void     InsertFree(uint32_t node);
+    void     RemoveFree(uint32_t node);
+    uint32_t TakeSpareNode();
+    void     ReleaseNode(uint32_t node);
+
+    std::vector<TlsfNode> nodes;
+    uint32_t              spareNodes = {TLSF_NONE};
+    uint32_t              firstPhysical = {TLSF_NONE};
+    uint32_t              flBitmap = {0};
+    uint32_t              slBitmaps[TLSF_FL_COUNT] = {};
+    uint32_t              bins[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    uint32_t              size = {0};
+    uint32_t              freeUnits = {0};
+    uint32_t              allocationCount = {0};
+};
+
+#endif //!_TLSF_ALLOCATOR_H_
@@ -0,0 +1,282 @@
+/* Checks and times the TLSF allocator DX12GeometryBuffer sub-allocates meshes with, portable so it runs on the
+ * Linux build farm:
+ *   g++ -O2 -std=c++17 TlsfBenchmark.cpp TlsfAllocator.cpp Timer.cpp Platform_Posix.cpp -o TlsfBenchmark
+ *   ./TlsfBenchmark
+ *
+ * The arena is sized in vertices and meshes draw their vertex counts log-uniformly, like a scene of props and
+ * LODs. It is filled to TLSF_BENCH_FILL and then churned, every step frees a random mesh or allocates a new one
+ * to hold the fill. The same stream runs through TLSF and through a best fit reference over ordered maps, both
+ * report the time per operation, how many allocations failed although enough units were free and the mean
+ * fragmentation (1 - largest free block / free units). Then the TLSF arena is defragmented in steps of
+ * TLSF_BENCH_DEFRAG_UNITS, with the contents moved along, until all free space is one block.
+ *
+ * Every allocation's units hold its id, so moves that lose or overlap data are caught, and the block list and
+ * bins are checked after every phase. The exit code is 1 if a check fails or defragmentation does not end in a
+ * single free block.
+ */
+
+#include "Timer.h"
+#include "TlsfAllocator.h"
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static constexpr uint32_t TLSF_BENCH_UNITS = {1u << 24};
+static constexpr uint32_t TLSF_BENCH_MAX_ALLOCATIONS = {1u << 16};
+static constexpr uint32_t TLSF_BENCH_MIN_SIZE = {64};
+static constexpr uint32_t TLSF_BENCH_MAX_SIZE = {65536};
+static constexpr double   TLSF_BENCH_FILL = {0.85};
+static constexpr uint32_t TLSF_BENCH_CHURN = {400000};
+static constexpr uint32_t TLSF_BENCH_DEFRAG_UNITS = {1u << 20}; // Per step, 44 MB of Vertex.
+
+static uint32_t NextRandom(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static uint32_t RandomSize(uint32_t &state) {
+    double t = (NextRandom(state) & 0xffff) / 65536.0;
+    return (uint32_t)(TLSF_BENCH_MIN_SIZE * pow((double)TLSF_BENCH_MAX_SIZE / TLSF_BENCH_MIN_SIZE, t));
+}
+
+// NOTE(pf): Best fit over a size ordered and an address ordered map, freeing merges with the neighbours.
+struct BestFitReference {
+    void Initialize(uint32_t size) {
+        bySize.clear();
+        byOffset.clear();
+        Insert(0, size);
+    }
+    void Insert(uint32_t offset, uint32_t size) {
+        byOffset[offset] = size;
+        bySize.insert({size, offset});
+    }
+    void Erase(std::map<uint32_t, uint32_t>::iterator it) {
+        auto range = bySize.equal_range(it->second);
+        for (auto s = range.first; s != range.second; ++s) {
+            if (s->second == it->first) {
+                bySize.erase(s);
+                break;
+            }
+        }
+        byOffset.erase(it);
+    }
+    uint32_t Allocate(uint32_t size) {
+        auto best = bySize.lower_bound(size);
+        if (best == bySize.end())
+            return TLSF_NONE;
+        uint32_t offset = best->second, blockSize = best->first;
+        Erase(byOffset.find(offset));
+        if (blockSize > size)
+            Insert(offset + size, blockSize - size);
+        return offset;
+    }
+    void Free(uint32_t offset, uint32_t size) {
+        auto next = byOffset.lower_bound(offset);
+        if (next != byOffset.end() && next->first == offset + size) {
+            size += next->second;
+            Erase(next);
+        }
+        auto prev = byOffset.lower_bound(offset);
+        if (prev != byOffset.begin()) {
+            --prev;
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                size += prev->second;
+                Erase(prev);
+            }
+        }
+        Insert(offset, size);
+    }
+    uint32_t LargestFree() const { return bySize.empty() ? 0 : bySize.rbegin()->first; }
+
+    std::multimap<uint32_t, uint32_t> bySize;
+    std::map<uint32_t, uint32_t>      byOffset;
+};
+
+struct ChurnResult {
+    double   nsPerOp;
+    uint32_t operations;
+    uint32_t failures; // Allocations that failed with enough free units.
+    double   fragmentation;
+};
+
+// .. the block list covers the arena in order, free blocks are merged and every one is in its bin ..
+static bool ValidateTlsf(const TlsfAllocator &tlsf) {
+    uint32_t offset = 0, freeUnits = 0, freeBlocks = 0, used = 0;
+    uint32_t prev = TLSF_NONE;
+    for (uint32_t n = tlsf.firstPhysical; n != TLSF_NONE; n = tlsf.nodes[n].nextPhysical) {
+        const TlsfNode &node = tlsf.nodes[n];
+        if (node.offset != offset || node.prevPhysical != prev || node.size == 0)
+            return false;
+        if (!node.used) {
+            if (prev != TLSF_NONE && !tlsf.nodes[prev].used)
+                return false;
+            freeUnits += node.size;
+            freeBlocks++;
+        } else {
+            used++;
+        }
+        offset += node.size;
+        prev = n;
+    }
+    uint32_t binned = 0;
+    for (uint32_t fl = 0; fl < TLSF_FL_COUNT; ++fl) {
+        for (uint32_t sl = 0; sl < TLSF_SL_COUNT; ++sl) {
+            bool hasBlocks = tlsf.bins[fl][sl] != TLSF_NONE;
+            if (hasBlocks != ((tlsf.slBitmaps[fl] >> sl) & 1) || (hasBlocks && !((tlsf.flBitmap >> fl) & 1)))
+                return false;
+            for (uint32_t n = tlsf.bins[fl][sl]; n != TLSF_NONE; n = tlsf.nodes[n].nextFree) {
+                if (tlsf.nodes[n].used)
+                    return false;
+                binned++;
+            }
+        }
+    }
+    return offset == tlsf.size && freeUnits == tlsf.FreeUnits() && binned == freeBlocks && used == tlsf.AllocationCount();
+}
+
+static bool CheckContents(const std::vector<uint32_t> &memory, const TlsfAllocator &tlsf, const std::vector<uint32_t> &live) {
+    for (uint32_t allocation : live) {
+        uint32_t offset = tlsf.Offset(allocation), size = tlsf.Size(allocation);
+        for (uint32_t i = 0; i < size; ++i) {
+            if (memory[offset + i] != allocation)
+                return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    uint32_t failures = 0;
+
+    // .. TLSF, filling every allocation with its id ..
+    TlsfAllocator tlsf;
+    tlsf.Initialize(TLSF_BENCH_UNITS, TLSF_BENCH_MAX_ALLOCATIONS);
+    std::vector<uint32_t> memory(TLSF_BENCH_UNITS, TLSF_NONE);
+    std::vector<uint32_t> live;
+    ChurnResult           tlsfResult = {};
+    {
+        uint32_t state = 1;
+        uint32_t target = (uint32_t)(TLSF_BENCH_UNITS * TLSF_BENCH_FILL);
+        double   fragmentation = 0.0;
+        int64_t  ticks = 0;
+        for (uint32_t step = 0; step < TLSF_BENCH_CHURN; ++step) {
+            bool     allocate = TLSF_BENCH_UNITS - tlsf.FreeUnits() < target;
+            uint32_t size = RandomSize(state);
+            uint32_t pick = NextRandom(state);
+            if (allocate) {
+                int64_t  start = HiResPerformanceQuery();
+                uint32_t allocation = tlsf.Allocate(size);
+                ticks += HiResPerformanceQuery() - start;
+                if (allocation == TLSF_NONE) {
+                    tlsfResult.failures += tlsf.FreeUnits() >= size;
+                } else {
+                    live.push_back(allocation);
+                    for (uint32_t i = 0; i < size; ++i)
+                        memory[tlsf.Offset(allocation) + i] = allocation;
+                }
+            } else if (!live.empty()) {
+                uint32_t index = pick % live.size();
+                uint32_t allocation = live[index];
+                live[index] = live.back();
+                live.pop_back();
+                int64_t start = HiResPerformanceQuery();
+                tlsf.Free(allocation);
+                ticks += HiResPerformanceQuery() - start;
+            }
+            tlsfResult.operations++;
+            if (tlsf.FreeUnits() > 0)
+                fragmentation += 1.0 - tlsf.LargestFree() / (double)tlsf.FreeUnits();
+        }
+        tlsfResult.nsPerOp = HiResMilliseconds(ticks) * 1e6 / tlsfResult.operations;
+        tlsfResult.fragmentation = fragmentation / tlsfResult.operations;
+    }
+    bool churnValid = ValidateTlsf(tlsf) && CheckContents(memory, tlsf, live);
+
+    // .. the same stream through best fit ..
+    ChurnResult reference = {};
+    {
+        BestFitReference                                 bestFit;
+        std::vector<std::pair<uint32_t, uint32_t>>       allocations;
+        uint32_t                                         state = 1;
+        uint32_t                                         target = (uint32_t)(TLSF_BENCH_UNITS * TLSF_BENCH_FILL);
+        uint32_t                                         usedUnits = 0;
+        double                                           fragmentation = 0.0;
+        int64_t                                          ticks = 0;
+        bestFit.Initialize(TLSF_BENCH_UNITS);
+        for (uint32_t step = 0; step < TLSF_BENCH_CHURN; ++step) {
+            bool     allocate = usedUnits < target;
+            uint32_t size = RandomSize(state);
+            uint32_t pick = NextRandom(state);
+            if (allocate) {
+                int64_t  start = HiResPerformanceQuery();
+                uint32_t offset = bestFit.Allocate(size);
+                ticks += HiResPerformanceQuery() - start;
+                if (offset == TLSF_NONE) {
+                    reference.failures += TLSF_BENCH_UNITS - usedUnits >= size;
+                } else {
+                    allocations.push_back({offset, size});
+                    usedUnits += size;
+                }
+            } else if (!allocations.empty()) {
+                uint32_t                      index = pick % allocations.size();
+                std::pair<uint32_t, uint32_t> allocation = allocations[index];
+                allocations[index] = allocations.back();
+                allocations.pop_back();
+                int64_t start = HiResPerformanceQuery();
+                bestFit.Free(allocation.first, allocation.second);
+                ticks += HiResPerformanceQuery() - start;
+                usedUnits -= allocation.second;
+            }
+            reference.operations++;
+            uint32_t freeUnits = TLSF_BENCH_UNITS - usedUnits;
+            if (freeUnits > 0)
+                fragmentation += 1.0 - bestFit.LargestFree() / (double)freeUnits;
+        }
+        reference.nsPerOp = HiResMilliseconds(ticks) * 1e6 / reference.operations;
+        reference.fragmentation = fragmentation / reference.operations;
+    }
+
+    // .. defragment in steps, moving the contents like the gpu copy through a scratch buffer ..
+    std::vector<TlsfMove> moves;
+    uint32_t              defragSteps = 0;
+    uint64_t              movedUnits = 0;
+    double                defragMs = 0.0;
+    double                fragmentationBefore = tlsf.FreeUnits() ? 1.0 - tlsf.LargestFree() / (double)tlsf.FreeUnits() : 0.0;
+    for (;;) {
+        moves.clear();
+        int64_t  start = HiResPerformanceQuery();
+        uint32_t moved = tlsf.Defragment(TLSF_BENCH_DEFRAG_UNITS, moves);
+        defragMs += HiResMilliseconds(HiResPerformanceQuery() - start);
+        if (moved == 0)
+            break;
+        for (const TlsfMove &move : moves)
+            memmove(&memory[move.to], &memory[move.from], move.size * sizeof(uint32_t));
+        movedUnits += moved;
+        defragSteps++;
+    }
+    bool defragValid = ValidateTlsf(tlsf) && CheckContents(memory, tlsf, live) && tlsf.LargestFree() == tlsf.FreeUnits();
+
+    printf("{\"benchmark\": \"tlsf\", \"units\": %u, \"fill\": %.2f, \"churn\": %u, \"live\": %zu,\n", TLSF_BENCH_UNITS,
+           TLSF_BENCH_FILL, TLSF_BENCH_CHURN, live.size());
+    printf("  \"tlsf\": {\"ns_per_op\": %.1f, \"failures\": %u, \"fragmentation\": %.4f},\n", tlsfResult.nsPerOp,
+           tlsfResult.failures, tlsfResult.fragmentation);
+    printf("  \"best_fit\": {\"ns_per_op\": %.1f, \"failures\": %u, \"fragmentation\": %.4f},\n", reference.nsPerOp,
+           reference.failures, reference.fragmentation);
+    printf("  \"defragment\": {\"fragmentation_before\": %.4f, \"steps\": %u, \"moved_units\": %llu, \"ms\": %.3f, "
+           "\"valid\": %s},\n",
+           fragmentationBefore, defragSteps, (unsigned long long)movedUnits, defragMs, defragValid ? "true" : "false");
+    printf("  \"churn_valid\": %s}\n", churnValid ? "true" : "false");
+
+    if (!churnValid) {
+        fprintf(stderr, "TLSF block list, bins or contents are broken after the churn\n");
+        failures++;
+    }
+    if (!defragValid) {
+        fprintf(stderr, "TLSF defragmentation lost contents or left more than one free block\n");
+        failures++;
+    }
+    return failures ? 1 : 0;
+}
@@ -1,128 +1,197 @@
-
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "App.h"
 #include "Common.h"
-#include "Input.h"
-
-int64_t HiResPerformanceFreq() {
-    LARGE_INTEGER countsPerSec;
-    QueryPerformanceFrequency(&countsPerSec);
-    int64_t result = countsPerSec.QuadPart;
-    return result;
-}
+#include "FrameLoop.h"
+#include "FrameStats.h"
+#include "Platform.h"
+#include "Profiler.h"
 
-int64_t HiResPerformanceQuery() {
-    LARGE_INTEGER currentTime;
-    QueryPerformanceCounter(&currentTime);
-    int64_t result = currentTime.QuadPart;
-    return result;
-}
+static constexpr uint32_t MAX_WINDOW_EVENTS = {256};
 
-LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+static int64_t QueryFrameClock(void *) {
+    return HiResPerformanceQuery();
 }
 
 int main(int argc, char **argv) {
 
     // NOTE(pf): Window setup.
-    const wchar_t *appName = L"DX12";
-    int            screenW = 1200;
-    int            screenH = 720;
-
-    WNDCLASSEX wc = {0};
-    HINSTANCE  hinstance = GetModuleHandle(NULL);
-
-    wc.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
-    wc.lpfnWndProc = WindowProc;
-    wc.cbClsExtra = 0;
-    wc.cbWndExtra = 0;
-    wc.hInstance = hinstance;
-    wc.hIcon = LoadIcon(NULL, IDC_ARROW);
-    wc.hIconSm = wc.hIcon;
-    wc.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
-    wc.lpszMenuName = NULL;
-    wc.lpszClassName = appName;
-    wc.cbSize = sizeof(WNDCLASSEX);
-
-    RegisterClassEx(&wc);
-
-    RECT rect = {0};
-    rect.top = 50;
-    rect.left = 50;
-    rect.bottom = 0 + screenH;
-    rect.right = 0 + screenW;
-    DWORD windowStyles = WS_OVERLAPPEDWINDOW | WS_CLIPSIBLINGS | WS_CLIPCHILDREN | WS_POPUP;
-    AdjustWindowRect(&rect, windowStyles, true);
-    HWND hwnd = CreateWindowEx(WS_EX_APPWINDOW, appName, appName,
-                               windowStyles,
-                               rect.left, rect.top, rect.right + 8, rect.bottom + 32,
-                               NULL, NULL, hinstance, NULL);
-
-    ShowWindow(hwnd, SW_SHOW);
-    SetForegroundWindow(hwnd);
-    SetFocus(hwnd);
+    uint32_t       screenW = 1200;
+    uint32_t       screenH = 720;
+    PlatformWindow window;
+    if (!PlatformCreateWindow("DX12", screenW, screenH, window)) {
+        PlatformReportError("Failed to create window.");
+        return 1;
+    }
 
+    // NOTE(pf): DX12 keeps a reference to the handle, it has to outlive app.
+    HWND hwnd = (HWND)window.nativeHandle;
     App app(hwnd, screenW, screenH);
-    app.Init();
 
     // NOTE(pf): State setup:
-    double totalTime = 0.0f;
-    double prevTotalTime = 0.0f;
-    double deltaTime = 0.0f;
-    bool   isRunning = true;
+    const double       fixedStep = 1.0 / 120.0;
+    double             prevTotalTime = 0.0;
+    bool               isRunning = true;
+    bool               threadedSimulation = false;
+    bool               dynamicResolution = true;
+    const char        *statsCsvPath = nullptr;
+    const char        *statsJsonPath = nullptr;
+    const char        *tracePath = nullptr;
+    const char        *commandCapturePath = nullptr;
+    int                lightCount = -1;
+    int                instanceCount = -1;
+    uint32_t           localBudgetMb = 0;
+    uint32_t           cpuBudgetMb = 0;
+    bool               hotReload = false;
+    SSAO_ENGINE        ssaoEngine = SSAO_ENGINE_HEMISPHERE;
+    GTAO_QUALITY       gtaoQuality = GTAO_QUALITY_MEDIUM;
+    SSAO_NORMAL_SOURCE normalSource = SSAO_NORMALS_FLOAT;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--threaded") == 0)
+            threadedSimulation = true;
+        else if (strcmp(argv[i], "--fixed-resolution") == 0)
+            dynamicResolution = false;
+        else if (strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc)
+            statsCsvPath = argv[++i];
+        else if (strcmp(argv[i], "--stats-json") == 0 && i + 1 < argc)
+            statsJsonPath = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (strcmp(argv[i], "--capture-commands") == 0 && i + 1 < argc)
+            commandCapturePath = argv[++i];
+        else if (strcmp(argv[i], "--lights") == 0 && i + 1 < argc)
+            lightCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+            instanceCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc)
+            localBudgetMb = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cpu-budget") == 0 && i + 1 < argc)
+            cpuBudgetMb = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--hot-reload") == 0)
+            hotReload = true;
+        else if (strcmp(argv[i], "--ssao-engine") == 0 && i + 1 < argc)
+            ssaoEngine = strcmp(argv[++i], "gtao") == 0 ? SSAO_ENGINE_GTAO : SSAO_ENGINE_HEMISPHERE;
+        else if (strcmp(argv[i], "--gtao-quality") == 0 && i + 1 < argc) {
+            // NOTE(pf): low, medium, high or ultra, see GTAO_PRESETS.
+            const char *name = argv[++i];
+            for (uint32_t q = 0; q < GTAO_QUALITY_COUNT; ++q) {
+                if (strcmp(name, GTAO_PRESETS[q].name) == 0)
+                    gtaoQuality = (GTAO_QUALITY)q;
+            }
+        } else if (strcmp(argv[i], "--normals") == 0 && i + 1 < argc) {
+            // NOTE(pf): Same names as CommandStreamTool, see SsaoNormals.h.
+            const char *source = argv[++i];
+            normalSource = strcmp(source, "octahedral") == 0 ? SSAO_NORMALS_OCTAHEDRAL
+                           : strcmp(source, "depth") == 0    ? SSAO_NORMALS_FROM_DEPTH
+                                                             : SSAO_NORMALS_FLOAT;
+        }
+    }
+
+    // NOTE(pf): The renderer builds its normal target and shaders for the normal source in Init, the scene
+    // creates its skulls there.
+    app.SetSsaoNormalSource(normalSource);
+    if (instanceCount >= 0)
+        app.SetInstanceCount((uint32_t)instanceCount);
+    app.Init();
+
+    // NOTE(pf): The profiler keeps the last PROFILER_MAX_EVENTS zones per thread, written out on exit.
+    ProfilerSetThreadName("Main");
+    ProfilerSetEnabled(tracePath != nullptr);
+    if (commandCapturePath)
+        app.CaptureNextFrame();
+    app.SetDynamicResolution(dynamicResolution);
+    if (lightCount >= 0)
+        app.SetLightCount((uint32_t)lightCount);
+    app.SetMemoryBudget(localBudgetMb, cpuBudgetMb);
+    app.SetHotReload(hotReload);
+    app.SetSsaoEngine(ssaoEngine, gtaoQuality);
+
+    // NOTE(pf): Heap allocated, the sample window is too large to live on the stack comfortably.
+    FrameStats *frameStats = new FrameStats();
+
+    // NOTE(pf): The frame time is measured from one BeginFrame to the next, so the present wait of the
+    // previous frame is part of it. The simulation advances in fixed steps and rendering interpolates.
+    FrameClock clock;
+    clock.query = QueryFrameClock;
+    clock.frequency = HiResPerformanceFreq();
+    FixedStepLoop loop;
+    loop.Initialize(clock, fixedStep);
+    int64_t startTicks = loop.lastTicks;
+    if (threadedSimulation)
+        app.StartSimulationThread(clock, fixedStep);
 
-    Input input = {0};
-    input.Instance = &input;
     while (isRunning) {
-        int64_t startTime = HiResPerformanceQuery();
-        MSG     msg;
-        while (PeekMessage(&msg, 0, 0, 0, PM_REMOVE)) {
-            switch (msg.message) {
-            case WM_QUIT: {
+        // NOTE(pf): Events are pumped before the frame starts so they are stamped before the steps they belong to.
+        PlatformWindowEvent events[MAX_WINDOW_EVENTS];
+        uint32_t            eventCount = PlatformPollEvents(window, events, MAX_WINDOW_EVENTS);
+        for (uint32_t i = 0; i < eventCount; ++i) {
+            if (events[i].type == PLATFORM_WINDOW_EVENT_QUIT)
                 isRunning = false;
-            } break;
-            case WM_SYSKEYDOWN:
-            case WM_SYSKEYUP:
-            case WM_KEYDOWN:
-            case WM_KEYUP: {
-                unsigned int vkCode = (unsigned int)msg.wParam;
-                bool         WasDown = ((msg.lParam & (1 << 30)) != 0);
-                bool         isDown = ((msg.lParam & (1 << 31L)) == 0);
-                if (WasDown != isDown) {
-                    Input::Instance->UpdateKey(vkCode, isDown);
-                }
-
-                bool altKeyWasDown = (msg.lParam & (1 << 29));
-                if ((vkCode == VK_F4) && altKeyWasDown) {
-                    isRunning = false;
-                }
-            } break;
-
-            default: {
-                TranslateMessage(&msg);
-                DispatchMessageA(&msg);
-            } break;
-            }
+            else
+                app.PushInput(events[i]);
+        }
+
+        int steps = loop.BeginFrame();
+
+        // NOTE(pf): The frame time measured by BeginFrame belongs to the previous frame, as do the present
+        // wait and gpu time reported by the renderer, the very first BeginFrame has nothing to measure.
+        if (loop.frameIndex > 1) {
+            FrameTiming timing = {};
+            timing.ms[FRAME_STAT_TOTAL] = loop.frameTime * 1000.0;
+            timing.ms[FRAME_STAT_PRESENT_WAIT] = app.PresentWaitMs();
+            timing.ms[FRAME_STAT_CPU] = Max(timing.ms[FRAME_STAT_TOTAL] - timing.ms[FRAME_STAT_PRESENT_WAIT], 0.0);
+            timing.ms[FRAME_STAT_GPU] = app.GpuFrameMs();
+            frameStats->AddFrame(timing);
         }
 
-        isRunning = app.Update(deltaTime, totalTime);
+        PROFILE_ZONE("Frame");
 
-        Input::Instance->Update();
-        int64_t endTime = HiResPerformanceQuery();
-        deltaTime = (float)Max(((endTime - startTime) / (double)HiResPerformanceFreq()), (int64_t)0);
-        totalTime += deltaTime;
-        deltaTime = (float)deltaTime;
+        if (threadedSimulation) {
+            isRunning = isRunning && app.IsSimulationRunning();
+            app.RenderLatest();
+        } else {
+            for (int i = 0; i < steps && isRunning; ++i)
+                isRunning = app.Step(loop.fixedStep, loop.StepEndTicks(i, steps));
+            app.Render(loop.Alpha());
+        }
 
-        if ((totalTime - prevTotalTime) >= 0.5f) {
-            printf("FPS: %ld, Delta(ms): %lf Elapsed Time: %ld\n", (long)(1.0f / deltaTime), deltaTime * 1000.0f, (long)totalTime);
+        double totalTime = (loop.lastTicks - startTicks) / (double)clock.frequency;
+        if ((totalTime - prevTotalTime) >= 0.5f && frameStats->SampleCount() > 0) {
+            FrameStatSummary total = frameStats->Summarize(FRAME_STAT_TOTAL);
+            FrameStatSummary cpu = frameStats->Summarize(FRAME_STAT_CPU);
+            FrameStatSummary gpu = frameStats->Summarize(FRAME_STAT_GPU);
+            FrameStatSummary presentWait = frameStats->Summarize(FRAME_STAT_PRESENT_WAIT);
+            printf("FPS: %ld, Frame(ms) p50: %.2lf p95: %.2lf p99: %.2lf max: %.2lf, CPU: %.2lf GPU: %.2lf Present: %.2lf, Scale: %.2f, VRAM(MB): %.1lf, Elapsed Time: %ld\n",
+                   (long)(1000.0 / Max(total.mean, 0.001)), total.p50, total.p95, total.p99, total.max,
+                   cpu.p50, gpu.p50, presentWait.p50, app.RenderScale(),
+                   app.MemoryStats().resident[MEMORY_SEGMENT_LOCAL] / (1024.0 * 1024.0), (long)totalTime);
             prevTotalTime = totalTime;
         }
     }
+    app.StopSimulationThread();
+
+    // NOTE(pf): Peaks per category, what the memory budget released and evicted on the way.
+    const MemoryBudgetStats &memory = app.MemoryStats();
+    for (uint32_t c = 0; c < MEMORY_CATEGORY_COUNT; ++c)
+        printf("Memory %s: %.1lf MB, peak %.1lf MB\n", MemoryCategoryName((MEMORY_CATEGORY)c),
+               memory.current[c] / (1024.0 * 1024.0), memory.peak[c] / (1024.0 * 1024.0));
+    printf("Memory releases: %u, evictions: %u, restores: %u, updates over budget: %u\n", memory.releases,
+           memory.evictions, memory.restores, memory.overBudgetUpdates);
+    if (commandCapturePath && !app.WriteCommandCapture(commandCapturePath))
+        printf("Failed to write command capture to %s\n", commandCapturePath);
     app.CleanUp();
+    PlatformDestroyWindow(window);
+
+    if (statsCsvPath && !frameStats->ExportCsv(statsCsvPath))
+        printf("Failed to write frame stats to %s\n", statsCsvPath);
+    if (statsJsonPath && !frameStats->ExportJson(statsJsonPath))
+        printf("Failed to write frame stats to %s\n", statsJsonPath);
+    delete frameStats;
+    if (tracePath && !ProfilerExportChromeTrace(tracePath))
+        printf("Failed to write trace to %s\n", tracePath);
 
     return 0;
 }
\ No newline at end of file
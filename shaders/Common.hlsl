@@ -1,10 +1,28 @@
-cbuffer cb : register(b0)
+// Per frame, only rewritten when the camera moves.
+cbuffer cbFrame : register(b0)
 {
-    float4x4 world;
     float4x4 view;
     float4x4 viewProj;
+    // xy is the part of the render targets the scene was rendered to, zw the largest uv the composite samples.
+    float4 renderScale;
 };
 
+// Per draw, set by the command signature of every indirect draw.
+cbuffer cbDraw : register(b1)
+{
+    uint instanceOffset;
+};
+
+// Affine world matrix, the first three columns stored as rows.
+struct InstanceData
+{
+    float4 world0;
+    float4 world1;
+    float4 world2;
+};
+
+StructuredBuffer<InstanceData> instances : register(t0, space1);
+
 Texture2D ssaoTex : register(t0);
 SamplerState linearSamp : register(s0);
 
@@ -1,28 +1,112 @@
+#include "NormalEncoding.hlsl"
 
-cbuffer cbSsao : register(b0)
+// Rewritten only when the projection or the render size changes.
+cbuffer cbSsaoPass : register(b0)
 {
     float4x4 gProj;
     float4x4 gInvProj;
     float4x4 gProjTex;
-    float4 gOffsetVectors[14];
     float2 gInvRenderTargetSize;
+    float2 gRenderScale; // Part of the targets rendered to.
+    // Rectangles of the depth pyramid levels in its atlas, level 0 is the rendered part of the depth map.
+    uint4 gPyramidLevels[13];
+    uint gPyramidLevelCount;
+    uint gPyramidMipBias;
+    // Quality preset of GtaoPS, see GTAO_PRESETS in Gtao.h.
+    uint gGtaoSliceCount;
+    uint gGtaoStepCount;
+};
+
+// Written once when the pass is initialized.
+cbuffer cbSsaoStatic : register(b1)
+{
+    float4 gOffsetVectors[14];
     // Coordinates given in view space.
     float gOcclusionRadius;
     float gOcclusionFadeStart;
     float gOcclusionFadeEnd;
     float gSurfaceEpsilon;
+    // GtaoPS, see GtaoSettings in Gtao.h.
+    float gGtaoRadius;
+    float gGtaoFalloffRange;
+    float gGtaoSampleDistributionPower;
+    float gGtaoMinStepPixels;
 };
 
 // Nonnumeric values cannot be added to a cbuffer.
 Texture2D gNormalMap : register(t0);
 Texture2D gDepthMap : register(t1);
 Texture2D gRandomVecMap : register(t2);
+Texture2D<float2> gDepthPyramid : register(t3); // Nearest and farthest view depth, see DepthPyramid.h.
 
 SamplerState gsamPointClamp : register(s0);
 SamplerState gsamDepthMap : register(s1);
 SamplerState gsamLinearWrap : register(s2);
 
 static const int gSampleCount = 14;
+
+float NdcDepthToViewDepth(float z_ndc)
+{
+    // z_ndc = A + B/viewZ, where gProj[2,2]=A and gProj[3,2]=B.
+    float viewZ = gProj[3][2] / (z_ndc - gProj[2][2]);
+    return viewZ;
+}
+
+// View position of the center of a rendered texel, reads past the rendered part are clamped to its edge.
+float3 TexelViewPosition(int2 texel)
+{
+    int2 renderSize = (int2)gPyramidLevels[0].zw;
+    texel = clamp(texel, 0, renderSize - 1);
+    float2 ndc = float2(2.0f, -2.0f) * (texel + 0.5f) / renderSize + float2(-1.0f, 1.0f);
+    float z = NdcDepthToViewDepth(gDepthMap.Load(int3(texel, 0)).r);
+    return float3(ndc.x * z / gProj[0][0], ndc.y * z / gProj[1][1], z);
+}
+
+// How far the two texels on one side miss the pixel's NDC depth when extrapolated, missing texels never win.
+float ExtrapolationError(int2 texel, int2 side, float center)
+{
+    int2 renderSize = (int2)gPyramidLevels[0].zw;
+    int2 t1 = texel + side;
+    int2 t2 = texel + 2 * side;
+    if (any(t1 < 0) || any(t1 >= renderSize))
+        return 1e30f;
+    float d1 = gDepthMap.Load(int3(t1, 0)).r;
+    if (any(t2 < 0) || any(t2 >= renderSize))
+        return abs(d1 - center) + 1.0f;
+    return abs(2.0f * d1 - gDepthMap.Load(int3(t2, 0)).r - center);
+}
+
+// Differences the view position on the side of each axis that continues the pixel's surface, see
+// ReconstructViewNormal in SsaoNormals.h. Cleared texels get the normal target's clear value.
+float3 ReconstructViewNormal(int2 texel)
+{
+    float center = gDepthMap.Load(int3(texel, 0)).r;
+    if (center >= 1.0f || any(gPyramidLevels[0].zw < 2))
+        return float3(0.0f, 0.0f, 1.0f);
+
+    float3 p = TexelViewPosition(texel);
+    int2 sideX = ExtrapolationError(texel, int2(-1, 0), center) < ExtrapolationError(texel, int2(1, 0), center) ? int2(-1, 0) : int2(1, 0);
+    int2 sideY = ExtrapolationError(texel, int2(0, -1), center) < ExtrapolationError(texel, int2(0, 1), center) ? int2(0, -1) : int2(0, 1);
+    float3 dx = (TexelViewPosition(texel + sideX) - p) * sideX.x;
+    float3 dy = (TexelViewPosition(texel + sideY) - p) * sideY.y;
+
+    // Left handed, right x down is towards the viewer.
+    float3 n = cross(dx, dy);
+    float len = length(n);
+    return len > 0.0f ? n / len : float3(0.0f, 0.0f, 1.0f);
+}
+
+// The view space normal of a rendered texel from whichever source the shader was compiled for.
+float3 LoadViewNormal(int2 texel)
+{
+#if SSAO_NORMAL_SOURCE == SSAO_NORMALS_FROM_DEPTH
+    return ReconstructViewNormal(texel);
+#elif SSAO_NORMAL_SOURCE == SSAO_NORMALS_OCTAHEDRAL
+    return OctahedralDecode(gNormalMap.Load(int3(texel, 0)).xy);
+#else
+    return normalize(gNormalMap.Load(int3(texel, 0)).xyz);
+#endif
+}
  
 static const float2 gTexCoords[6] =
 {
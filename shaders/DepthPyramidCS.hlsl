@@ -0,0 +1,163 @@
+// Reduces the depth map into the min/max view depth atlas of DepthPyramid.h in a single dispatch, the CPU
+// reference is DepthPyramid::BuildScalar. Every group reduces a 64x64 pixel tile down to level 6, one texel,
+// and stores that texel in the scratch buffer. The last group to finish reduces those into the levels above.
+#include "CommonSSAO.hlsl"
+
+RWTexture2D<float2> gPyramid : register(u0);
+// Group counter, padding and then the level 6 texel of every group, see DEPTH_PYRAMID_SCRATCH_HEADER.
+globallycoherent RWByteAddressBuffer gScratch : register(u1);
+
+static const uint gTileLevels = 6;
+static const uint gScratchTexels = 16; // Bytes before the first level 6 texel.
+static const uint gTopTexels = 32;     // Level 7 of the largest supported depth map is 32x32.
+
+groupshared float2 gsTile[16][16];
+groupshared float2 gsTop[gTopTexels * gTopTexels];
+groupshared uint gsIsLastGroup;
+
+float2 Reduce(float2 a, float2 b, float2 c, float2 d)
+{
+    return float2(min(min(a.x, b.x), min(c.x, d.x)), max(max(a.y, b.y), max(c.y, d.y)));
+}
+
+void StoreTexel(uint level, uint2 texel, float2 value)
+{
+    uint4 rect = gPyramidLevels[level];
+    if (level < gPyramidLevelCount && texel.x < rect.z && texel.y < rect.w)
+        gPyramid[rect.xy + texel] = value;
+}
+
+// Reads past the end of a level repeat its last texel, which is part of the same footprint.
+uint2 ClampTexel(uint level, uint2 texel)
+{
+    return min(texel, max(gPyramidLevels[level].zw, 1) - 1);
+}
+
+// Same clamp for child d of texel in the level below, as an offset from its first child so it stays in the tile.
+uint2 ChildOffset(uint level, uint2 texel, uint2 d)
+{
+    return (2 * texel + d < gPyramidLevels[level].zw) ? d : 0;
+}
+
+// Min and max NDC depth of the 2x2 pixels, linearized afterwards. The mapping is monotonic.
+float2 LinearizeTexel(uint2 texel)
+{
+    float d0 = gDepthMap.Load(int3(ClampTexel(0, 2 * texel + uint2(0, 0)), 0)).r;
+    float d1 = gDepthMap.Load(int3(ClampTexel(0, 2 * texel + uint2(1, 0)), 0)).r;
+    float d2 = gDepthMap.Load(int3(ClampTexel(0, 2 * texel + uint2(0, 1)), 0)).r;
+    float d3 = gDepthMap.Load(int3(ClampTexel(0, 2 * texel + uint2(1, 1)), 0)).r;
+    float z0 = NdcDepthToViewDepth(min(min(d0, d1), min(d2, d3)));
+    float z1 = NdcDepthToViewDepth(max(max(d0, d1), max(d2, d3)));
+    return float2(min(z0, z1), max(z0, z1));
+}
+
+float2 LoadScratchTexel(uint2 texel, uint width)
+{
+    return asfloat(gScratch.Load2(gScratchTexels + 8 * (texel.y * width + texel.x)));
+}
+
+[numthreads(256, 1, 1)]
+void main(uint3 groupId : SV_GroupID, uint threadIndex : SV_GroupIndex)
+{
+    uint2 groups = (gPyramidLevels[0].zw + 63) >> gTileLevels;
+    uint2 local = uint2(threadIndex % 16, threadIndex / 16);
+
+    // .. every thread reduces 4x4 pixels into 2x2 texels of level 1 and one of level 2 ..
+    uint2 texel2 = groupId.xy * 16 + local;
+    float2 level1[4];
+    [unroll]
+    for (uint i = 0; i < 4; ++i)
+    {
+        uint2 texel1 = 2 * texel2 + uint2(i & 1, i >> 1);
+        level1[i] = LinearizeTexel(texel1);
+        StoreTexel(1, texel1, level1[i]);
+    }
+    uint2 c0 = ChildOffset(1, texel2, uint2(0, 0));
+    uint2 c1 = ChildOffset(1, texel2, uint2(1, 0));
+    uint2 c2 = ChildOffset(1, texel2, uint2(0, 1));
+    uint2 c3 = ChildOffset(1, texel2, uint2(1, 1));
+    float2 value = Reduce(level1[c0.y * 2 + c0.x], level1[c1.y * 2 + c1.x], level1[c2.y * 2 + c2.x], level1[c3.y * 2 + c3.x]);
+    StoreTexel(2, texel2, value);
+    gsTile[local.y][local.x] = value;
+    GroupMemoryBarrierWithGroupSync();
+
+    // .. then levels 3 to 6 in groupshared memory, children are read before anything is overwritten ..
+    [unroll]
+    for (uint level = 3; level <= gTileLevels; ++level)
+    {
+        uint size = 16 >> (level - 2);
+        bool active = local.x < size && local.y < size;
+        uint2 texel = groupId.xy * size + local;
+        if (active)
+        {
+            c0 = 2 * local + ChildOffset(level - 1, texel, uint2(0, 0));
+            c1 = 2 * local + ChildOffset(level - 1, texel, uint2(1, 0));
+            c2 = 2 * local + ChildOffset(level - 1, texel, uint2(0, 1));
+            c3 = 2 * local + ChildOffset(level - 1, texel, uint2(1, 1));
+            value = Reduce(gsTile[c0.y][c0.x], gsTile[c1.y][c1.x], gsTile[c2.y][c2.x], gsTile[c3.y][c3.x]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+        if (active)
+        {
+            StoreTexel(level, texel, value);
+            gsTile[local.y][local.x] = value;
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // .. publish the tile's texel, the group that increments the counter last continues ..
+    if (threadIndex == 0)
+    {
+        gScratch.Store2(gScratchTexels + 8 * (groupId.y * groups.x + groupId.x), asuint(gsTile[0][0]));
+        DeviceMemoryBarrier();
+        uint previous;
+        gScratch.InterlockedAdd(0, 1, previous);
+        gsIsLastGroup = previous == groups.x * groups.y - 1;
+    }
+    GroupMemoryBarrierWithGroupSync();
+    if (!gsIsLastGroup)
+        return;
+    DeviceMemoryBarrier();
+
+    // NOTE(pf): Every texel of level 6 is now in the scratch buffer. Level 7 is read from there, the levels
+    // above it in place in gsTop like the tile levels. The counter is reset for the next frame.
+    if (threadIndex == 0)
+        gScratch.Store(0, 0);
+
+    uint2 size7 = (groups + 1) >> 1;
+    for (uint index = threadIndex; index < size7.x * size7.y; index += 256)
+    {
+        uint2 texel = uint2(index % size7.x, index / size7.x);
+        float2 t0 = LoadScratchTexel(ClampTexel(gTileLevels, 2 * texel + uint2(0, 0)), groups.x);
+        float2 t1 = LoadScratchTexel(ClampTexel(gTileLevels, 2 * texel + uint2(1, 0)), groups.x);
+        float2 t2 = LoadScratchTexel(ClampTexel(gTileLevels, 2 * texel + uint2(0, 1)), groups.x);
+        float2 t3 = LoadScratchTexel(ClampTexel(gTileLevels, 2 * texel + uint2(1, 1)), groups.x);
+        value = Reduce(t0, t1, t2, t3);
+        StoreTexel(gTileLevels + 1, texel, value);
+        gsTop[texel.y * gTopTexels + texel.x] = value;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint topLevel = gTileLevels + 2; topLevel < gPyramidLevelCount; ++topLevel)
+    {
+        uint2 size = gPyramidLevels[topLevel].zw;
+        bool active = threadIndex < size.x * size.y;
+        uint2 texel = uint2(threadIndex % max(size.x, 1), threadIndex / max(size.x, 1));
+        if (active)
+        {
+            c0 = ClampTexel(topLevel - 1, 2 * texel + uint2(0, 0));
+            c1 = ClampTexel(topLevel - 1, 2 * texel + uint2(1, 0));
+            c2 = ClampTexel(topLevel - 1, 2 * texel + uint2(0, 1));
+            c3 = ClampTexel(topLevel - 1, 2 * texel + uint2(1, 1));
+            value = Reduce(gsTop[c0.y * gTopTexels + c0.x], gsTop[c1.y * gTopTexels + c1.x],
+                           gsTop[c2.y * gTopTexels + c2.x], gsTop[c3.y * gTopTexels + c3.x]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+        if (active)
+        {
+            StoreTexel(topLevel, texel, value);
+            gsTop[texel.y * gTopTexels + texel.x] = value;
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "Common.hlsl"
+
+struct VertexOut
+{
+    float4 PosH : SV_POSITION;
+    float2 TexC : TEXCOORD;
+};
+
+Texture2D litTex : register(t1);
+
+static const float3 gSkyColor = float3(0.4f, 0.6f, 0.9f);
+
+float4 main(VertexOut pin) : SV_Target
+{
+    // Upscale like DrawSSAOPS, the lit color is linear HDR with alpha 0 where nothing was drawn.
+    float2 uv = min(pin.TexC * renderScale.xy, renderScale.zw);
+    float4 lit = litTex.Sample(linearSamp, uv);
+    float3 mapped = pow(lit.rgb / (1.0f + lit.rgb), 1.0f / 2.2f);
+    return float4(lerp(gSkyColor, mapped, lit.a), 1.0f);
+}
\ No newline at end of file
@@ -9,7 +9,9 @@ struct VertexOut
 float4 main(VertexOut pin) : SV_Target
 {
     //return float4(1.0f, 0.0f, 0.0f, 1.0f);
-    return float4(ssaoTex.Sample(linearSamp, pin.TexC).rrr, 1.0f);
+    // Upscale, the clamp keeps the bilinear footprint inside the rendered part.
+    float2 uv = min(pin.TexC * renderScale.xy, renderScale.zw);
+    return float4(ssaoTex.Sample(linearSamp, uv).rrr, 1.0f);
 }
 
 
@@ -0,0 +1,39 @@
+#include "Common.hlsl"
+#include "Lighting.hlsl"
+
+struct VertexOut
+{
+    float4 PosH : SV_POSITION;
+    float3 PosV : POSITION;
+    float3 NormalV : NORMAL;
+};
+
+ByteAddressBuffer gTileLights : register(t2, space1);
+
+static const float3 gAlbedo = float3(0.85f, 0.8f, 0.7f);
+static const float3 gAmbientLight = float3(0.25f, 0.3f, 0.4f);
+
+float4 main(VertexOut pin) : SV_Target
+{
+    float3 normalV = normalize(pin.NormalV);
+
+    // The ambient map is rendered at the same resolution, its pixel is this one.
+    int2 pixel = int2(pin.PosH.xy);
+    float ambientAccess = ssaoTex.Load(int3(pixel, 0)).r;
+    float3 lit = gAmbientLight * ambientAccess;
+
+    // .. only the lights LightCullCS found for this pixel's tile ..
+    uint2 tile = uint2(pixel) / gTileSize;
+    uint tileOffset = 4 * gTileStride * (tile.y * gTilesX + tile.x);
+    uint count = gTileLights.Load(tileOffset);
+    for (uint i = 0; i < count; ++i)
+    {
+        PointLight light = gLights[gTileLights.Load(tileOffset + 4 * (1 + i))];
+        float3 toLight = light.position - pin.PosV;
+        float lightDistance = length(toLight);
+        float lambert = saturate(dot(normalV, toLight / max(lightDistance, 1e-4f)));
+        lit += light.color * (light.intensity * lambert * LightFalloff(lightDistance, light.radius));
+    }
+
+    return float4(gAlbedo * lit, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "Common.hlsl"
+
+struct VertexIn
+{
+    float3 PosL : POSITION;
+    float3 NormalL : NORMAL;
+    float3 TangentU : TANGENT;
+};
+
+struct VertexOut
+{
+    float4 PosH : SV_POSITION;
+    float3 PosV : POSITION;
+    float3 NormalV : NORMAL;
+};
+
+// Same transform as NormalsVS, so the depth test against the prepass passes on equal depth.
+VertexOut main(VertexIn vin, uint instanceID : SV_InstanceID)
+{
+    VertexOut vout = (VertexOut) 0.0f;
+    InstanceData instance = instances[instanceOffset + instanceID];
+    float3x4 instanceWorld = float3x4(instance.world0, instance.world1, instance.world2);
+    float3 normalW = mul((float3x3) instanceWorld, vin.NormalL);
+    vout.NormalV = mul(normalW, (float3x3) view);
+
+    float4 posW = float4(mul(instanceWorld, float4(vin.PosL, 1.0f)), 1.0f);
+    vout.PosV = mul(posW, view).xyz;
+    vout.PosH = mul(posW, viewProj);
+
+    return vout;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+// Ground truth ambient occlusion, see Gtao.h. GtaoVisibility is the CPU reference and follows this step by step.
+#include "CommonSSAO.hlsl"
+
+static const float gPi = 3.14159265f;
+static const float gHalfPi = 0.5f * gPi;
+
+// Cosine of the angle between the view vector and the direction to the tap, faded out towards the radius.
+float HorizonCos(float3 p, float3 viewVec, float2 tap, float lowHorizonCos)
+{
+    float3 delta = TexelViewPosition((int2)floor(tap)) - p;
+    float tapDistance = length(delta);
+    if (tapDistance <= 0.0f)
+        return lowHorizonCos;
+
+    float cosine = dot(delta, viewVec) / tapDistance;
+    float weight = saturate((gGtaoRadius - tapDistance) / (gGtaoFalloffRange * gGtaoRadius));
+    return lerp(lowHorizonCos, cosine, weight);
+}
+
+float4 main(VertexOut pin) : SV_Target
+{
+    int2 pixel = (int2)pin.PosH.xy;
+    float3 p = TexelViewPosition(pixel);
+
+    // A pixel whose radius covers less than a texel has nothing to search.
+    float radiusPixels = gGtaoRadius * gProj[1][1] * 0.5f * gPyramidLevels[0].w / p.z;
+    if (radiusPixels < 1.0f)
+        return 1.0f;
+    float minStep = gGtaoMinStepPixels / radiusPixels;
+
+    float3 n = LoadViewNormal(pixel);
+    float3 viewVec = normalize(-p);
+
+    // Slice and step noise from one texel of the random vector map per pixel.
+    float2 noise = gRandomVecMap.Load(int3(pixel & 255, 0)).xy;
+
+    float visibility = 0.0f;
+    [loop]
+    for (uint slice = 0; slice < gGtaoSliceCount; ++slice)
+    {
+        float phi = (slice + noise.x) / gGtaoSliceCount * gPi;
+        float2 omega = float2(cos(phi), -sin(phi));
+
+        // Project the normal into the slice plane, angleNormal is its angle from the view vector.
+        float3 direction = float3(omega.x, -omega.y, 0.0f);
+        float3 orthoDirection = direction - dot(direction, viewVec) * viewVec;
+        float3 axis = cross(orthoDirection, viewVec);
+        float axisLength = length(axis);
+        if (axisLength <= 0.0f)
+            continue;
+        float3 projectedNormal = n - axis * (dot(n, axis) / (axisLength * axisLength));
+        float projectedLength = length(projectedNormal);
+        if (projectedLength <= 0.0f)
+            continue;
+        float signNormal = dot(orthoDirection, projectedNormal) < 0.0f ? -1.0f : 1.0f;
+        float cosNormal = saturate(dot(projectedNormal, viewVec) / projectedLength);
+        float angleNormal = signNormal * acos(cosNormal);
+
+        // The tangent plane is the lowest each horizon can be, march both sides for anything higher.
+        float lowHorizonCos0 = cos(angleNormal + gHalfPi);
+        float lowHorizonCos1 = cos(angleNormal - gHalfPi);
+        float horizonCos0 = lowHorizonCos0;
+        float horizonCos1 = lowHorizonCos1;
+        [loop]
+        for (uint stepIndex = 0; stepIndex < gGtaoStepCount; ++stepIndex)
+        {
+            float s = (stepIndex + noise.y) / gGtaoStepCount;
+            s = pow(s, gGtaoSampleDistributionPower) + minStep;
+            float2 offset = s * radiusPixels * omega;
+
+            float2 pixelPos = pixel + 0.5f;
+            horizonCos0 = max(horizonCos0, HorizonCos(p, viewVec, pixelPos + offset, lowHorizonCos0));
+            horizonCos1 = max(horizonCos1, HorizonCos(p, viewVec, pixelPos - offset, lowHorizonCos1));
+        }
+
+        // Integrate cos(h - n) * |sin(h)| between the two horizons, clamped to the hemisphere.
+        float h0 = -acos(clamp(horizonCos1, -1.0f, 1.0f));
+        float h1 = acos(clamp(horizonCos0, -1.0f, 1.0f));
+        h0 = angleNormal + max(h0 - angleNormal, -gHalfPi);
+        h1 = angleNormal + min(h1 - angleNormal, gHalfPi);
+        float sinNormal = sin(angleNormal);
+        float arc0 = (cosNormal + 2.0f * h0 * sinNormal - cos(2.0f * h0 - angleNormal)) * 0.25f;
+        float arc1 = (cosNormal + 2.0f * h1 * sinNormal - cos(2.0f * h1 - angleNormal)) * 0.25f;
+        visibility += projectedLength * (arc0 + arc1);
+    }
+
+    float access = saturate(visibility / gGtaoSliceCount);
+    return access;
+}
\ No newline at end of file
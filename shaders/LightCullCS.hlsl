@@ -0,0 +1,82 @@
+// Culls the lights against 16x16 pixel tiles of the depth map, one group per tile. CullLightsTiled in
+// LightCulling.cpp is the CPU reference: the same tile frustums and tests, so both find the same lights, but
+// the threads here append in whatever order they finish and the list is not sorted.
+#include "Lighting.hlsl"
+
+Texture2D gDepthMap : register(t0);
+RWByteAddressBuffer gTileLights : register(u0);
+
+groupshared uint gsMinDepth;
+groupshared uint gsMaxDepth;
+groupshared uint gsLightCount;
+groupshared uint gsLights[gTileMaxLights];
+
+// Side plane through the eye, (a, b) of a * u + b * z normalized like NormalizeSidePlane.
+float2 SidePlane(float a, float b)
+{
+    return float2(a, b) * rsqrt(a * a + b * b);
+}
+
+bool SphereInSlab(float2 lower, float2 upper, float u, float z, float radius)
+{
+    return dot(lower, float2(u, z)) >= -radius && dot(upper, float2(u, z)) >= -radius;
+}
+
+[numthreads(16, 16, 1)]
+void main(uint3 groupId : SV_GroupID, uint3 pixel : SV_DispatchThreadID, uint threadIndex : SV_GroupIndex)
+{
+    if (threadIndex == 0)
+    {
+        gsMinDepth = 0x7f7fffff; // FLT_MAX
+        gsMaxDepth = 0;
+        gsLightCount = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // .. view depth bounds of the tile, cleared pixels included like DepthPyramid level 4. Positive floats
+    // order like their bits ..
+    if (all(pixel.xy < gRenderSize))
+    {
+        float z = LightingViewDepth(gDepthMap.Load(int3(pixel.xy, 0)).r);
+        InterlockedMin(gsMinDepth, asuint(z));
+        InterlockedMax(gsMaxDepth, asuint(z));
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    float minZ = asfloat(gsMinDepth);
+    float maxZ = asfloat(gsMaxDepth);
+    uint2 tileMin = groupId.xy * gTileSize;
+    uint2 tileMax = min(tileMin + gTileSize, gRenderSize);
+    float2 ndcMin = float2(2.0f * tileMin.x / gRenderSize.x - 1.0f, 1.0f - 2.0f * tileMin.y / gRenderSize.y);
+    float2 ndcMax = float2(2.0f * tileMax.x / gRenderSize.x - 1.0f, 1.0f - 2.0f * tileMax.y / gRenderSize.y);
+    float2 leftPlane = SidePlane(gProj00, -ndcMin.x);
+    float2 rightPlane = SidePlane(-gProj00, ndcMax.x);
+    float2 topPlane = SidePlane(-gProj11, ndcMin.y);
+    float2 bottomPlane = SidePlane(gProj11, -ndcMax.y);
+
+    // .. every thread tests every 256th light ..
+    for (uint i = threadIndex; i < gLightCount; i += gTileSize * gTileSize)
+    {
+        PointLight light = gLights[i];
+        float3 p = light.position;
+        bool inside = SphereInSlab(leftPlane, rightPlane, p.x, p.z, light.radius) &&
+                      SphereInSlab(topPlane, bottomPlane, p.y, p.z, light.radius) &&
+                      p.z + light.radius >= minZ && p.z - light.radius <= maxZ;
+        if (inside)
+        {
+            uint slot;
+            InterlockedAdd(gsLightCount, 1, slot);
+            if (slot < gTileMaxLights)
+                gsLights[slot] = i;
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // .. the count followed by the indices, past gTileMaxLights they are dropped like on the CPU.
+    uint tileOffset = 4 * gTileStride * (groupId.y * gTilesX + groupId.x);
+    uint count = min(gsLightCount, gTileMaxLights);
+    if (threadIndex == 0)
+        gTileLights.Store(tileOffset, count);
+    for (uint j = threadIndex; j < count; j += gTileSize * gTileSize)
+        gTileLights.Store(tileOffset + 4 * (1 + j), gsLights[j]);
+}
\ No newline at end of file
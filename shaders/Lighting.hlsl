@@ -0,0 +1,44 @@
+// Tiled forward+ lighting, shared by LightCullCS and ForwardPS. The C++ side is LightCulling.h, whose
+// CullLightsTiled is the CPU reference of the culling.
+
+// Per frame, LightingConstants in DX12LightingPass.h.
+cbuffer cbLighting : register(b2)
+{
+    uint gLightCount;
+    uint gTilesX;
+    uint gTilesY;
+    uint gLightingPad0;
+    uint2 gRenderSize;  // Rendered part of the targets, the tiles cover it.
+    uint2 gLightingPad1;
+    float gProj00;      // Projection x and y scale for the tile planes.
+    float gProj11;
+    float gProjA;       // NDC depth to view depth, z = gProjB / (ndc - gProjA).
+    float gProjB;
+};
+
+// View space, the light falls off to zero at radius.
+struct PointLight
+{
+    float3 position;
+    float radius;
+    float3 color;
+    float intensity;
+};
+
+StructuredBuffer<PointLight> gLights : register(t1, space1);
+
+static const uint gTileSize = 16;        // LIGHT_TILE_SIZE
+static const uint gTileMaxLights = 255;  // LIGHT_TILE_MAX_LIGHTS
+static const uint gTileStride = 256;     // LIGHT_TILE_STRIDE, the count followed by the indices.
+
+float LightingViewDepth(float ndcDepth)
+{
+    return gProjB / (ndcDepth - gProjA);
+}
+
+// Smooth window, 1 at the light and 0 from radius on.
+float LightFalloff(float lightDistance, float radius)
+{
+    float ratio = saturate(1.0f - pow(lightDistance / radius, 4.0f));
+    return ratio * ratio / (lightDistance * lightDistance + 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+// Normal sources of SsaoNormals.h, DX12 compiles NormalsPS and the SSAO shaders with SSAO_NORMAL_SOURCE set.
+#define SSAO_NORMALS_FLOAT 0
+#define SSAO_NORMALS_OCTAHEDRAL 1
+#define SSAO_NORMALS_FROM_DEPTH 2
+#ifndef SSAO_NORMAL_SOURCE
+#define SSAO_NORMAL_SOURCE SSAO_NORMALS_FLOAT
+#endif
+
+float2 SignNotZero(float2 v)
+{
+    return float2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+// Unit vector to [-1, 1]^2, the lower half is folded over the diagonals onto the corners of the square.
+float2 OctahedralEncode(float3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0f ? n.xy : (1.0f - abs(n.yx)) * SignNotZero(n.xy);
+}
+
+float3 OctahedralDecode(float2 e)
+{
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += float2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+    return normalize(n);
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Common.hlsl"
+#include "NormalEncoding.hlsl"
 
 struct VertexOut
 {
@@ -11,5 +12,9 @@ float4 main(VertexOut pin) : SV_Target
 {
     pin.NormalW = normalize(pin.NormalW);
     float3 normalV = mul(pin.NormalW, (float3x3) view);
+#if SSAO_NORMAL_SOURCE == SSAO_NORMALS_OCTAHEDRAL
+    return float4(OctahedralEncode(normalize(normalV)), 0.0f, 0.0f);
+#else
     return float4(normalV, 0.0f);
+#endif
 }
\ No newline at end of file
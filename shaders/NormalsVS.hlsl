@@ -14,13 +14,16 @@ struct VertexOut
 };
 
 
-VertexOut main(VertexIn vin)
+VertexOut main(VertexIn vin, uint instanceID : SV_InstanceID)
 {
     VertexOut vout = (VertexOut) 0.0f;
-    vout.NormalW = mul(vin.NormalL, (float3x3) world);
+    // SV_InstanceID starts at 0 for every draw, the batch's first instance comes from cbDraw.
+    InstanceData instance = instances[instanceOffset + instanceID];
+    float3x4 instanceWorld = float3x4(instance.world0, instance.world1, instance.world2);
+    vout.NormalW = mul((float3x3) instanceWorld, vin.NormalL);
 
     // Transform to homogeneous clip space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), world);
+    float4 posW = float4(mul(instanceWorld, float4(vin.PosL, 1.0f)), 1.0f);
     vout.PosH = mul(posW, viewProj);
 
     return vout;
@@ -12,16 +12,24 @@ float OcclusionFunction(float distZ)
     return occlusion;
 }
 
-float NdcDepthToViewDepth(float z_ndc)
+// Taps that moved 2^(bias + 1) pixels or more from their pixel read the nearest depth of a coarser pyramid
+// level, so the taps of neighbouring pixels share texels. SoftwareRenderer::ComputeSsao does the same.
+float TapViewDepth(float2 texC, float2 pixelPos)
 {
-    // z_ndc = A + B/viewZ, where gProj[2,2]=A and gProj[3,2]=B.
-    float viewZ = gProj[3][2] / (z_ndc - gProj[2][2]);
-    return viewZ;
+    float2 tap = texC / gInvRenderTargetSize;
+    uint distance = (uint)min(length(tap - pixelPos), 65535.0f);
+    int level = clamp((int)firstbithigh(distance) - (int)gPyramidMipBias, 0, (int)gPyramidLevelCount - 1);
+    if (level == 0)
+        return NdcDepthToViewDepth(gDepthMap.SampleLevel(gsamDepthMap, texC, 0.0f).r);
+
+    uint4 rect = gPyramidLevels[level];
+    uint2 texel = min((uint2)tap >> level, rect.zw - 1);
+    return gDepthPyramid.Load(int3(rect.xy + texel, 0)).x;
 }
  
 float4 main(VertexOut pin) : SV_Target
 {
-    float3 n = normalize(gNormalMap.SampleLevel(gsamPointClamp, pin.TexC, 0.0f).xyz);
+    float3 n = LoadViewNormal((int2)pin.PosH.xy);
     float pz = gDepthMap.SampleLevel(gsamDepthMap, pin.TexC, 0.0f).r;
     return float4(pz, 0, 0, 1.0);
 
@@ -47,8 +55,8 @@ float4 main(VertexOut pin) : SV_Target
 		// Project q and generate projective tex-coords.  
         float4 projQ = mul(float4(q, 1.0f), gProjTex);
         projQ /= projQ.w;
-        float rz = gDepthMap.SampleLevel(gsamDepthMap, projQ.xy, 0.0f).r;
-        rz = NdcDepthToViewDepth(rz);
+        projQ.xy = clamp(projQ.xy, 0.0f, gRenderScale - 0.5f * gInvRenderTargetSize);
+        float rz = TapViewDepth(projQ.xy, pin.PosH.xy);
         float3 r = (rz / q.z) * q;
         float distZ = p.z - r.z;
         float dp = max(dot(n, normalize(r - p)), 0.0f);
@@ -4,10 +4,11 @@ VertexOut main(uint vid : SV_VertexID)
 {
     VertexOut vout;
 
-    vout.TexC = gTexCoords[vid];
+    float2 texC = gTexCoords[vid];
+    vout.TexC = texC * gRenderScale;
 
-    // Quad covering screen in NDC space.
-    vout.PosH = float4(2.0f * vout.TexC.x - 1.0f, 1.0f - 2.0f * vout.TexC.y, 0.0f, 1.0f);
+    // Quad covering the viewport in NDC space.
+    vout.PosH = float4(2.0f * texC.x - 1.0f, 1.0f - 2.0f * texC.y, 0.0f, 1.0f);
  
     // Transform quad corners to view space near plane.
     float4 ph = mul(vout.PosH, gInvProj);